@@ -2,7 +2,8 @@
 // SPDX-License-Identifier: MIT
 //
 // Minimal mbedtls configuration for embedded (P2/RTL872x).
-// Only includes AES-CBC and AES-CMAC needed for NTAG424 authentication.
+// AES-CBC and AES-CMAC for NTAG424 authentication, plus a TLS 1.2 client
+// (ECDHE key exchange, AES-GCM) for pb::socket::TlsSocket.
 //
 // Based on Device OS configuration but stripped down to essentials.
 
@@ -26,6 +27,10 @@
 // No standard library dependencies we can't provide
 #define MBEDTLS_PLATFORM_NO_STD_FUNCTIONS
 
+// Cortex-M33 assembly for bignum multiplication - by far the largest part of
+// a full TLS handshake
+#define MBEDTLS_HAVE_ASM
+
 // =============================================================================
 // Cipher Configuration
 // =============================================================================
@@ -42,30 +47,74 @@
 // Cipher abstraction layer (required for CMAC)
 #define MBEDTLS_CIPHER_C
 
+// AES-GCM for the TLS record layer
+#define MBEDTLS_GCM_C
+
 // =============================================================================
-// Disabled Features
+// TLS Client (pb::socket::TlsSocket)
 // =============================================================================
 
-// We don't need entropy/DRBG - we use HAL_RNG directly
-// #define MBEDTLS_ENTROPY_C
-// #define MBEDTLS_CTR_DRBG_C
+#define MBEDTLS_SSL_TLS_C
+#define MBEDTLS_SSL_CLI_C
+#define MBEDTLS_SSL_PROTO_TLS1_2
+#define MBEDTLS_SSL_SERVER_NAME_INDICATION
+
+// Resume sessions on reconnect instead of a full handshake
+#define MBEDTLS_SSL_SESSION_TICKETS
+
+// Servers may send full 16 KiB records, but what we send is small
+#define MBEDTLS_SSL_IN_CONTENT_LEN 16384
+#define MBEDTLS_SSL_OUT_CONTENT_LEN 4096
+
+// Only forward-secret AEAD suites
+#define MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED
+#define MBEDTLS_KEY_EXCHANGE_ECDHE_RSA_ENABLED
+#define MBEDTLS_SSL_CIPHERSUITES                       \
+  MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256,     \
+      MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256,   \
+      MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384, \
+      MBEDTLS_TLS_ECDHE_RSA_WITH_AES_256_GCM_SHA384
+
+// Hashes (SHA-384 comes with SHA-512)
+#define MBEDTLS_MD_C
+#define MBEDTLS_SHA256_C
+#define MBEDTLS_SHA512_C
+
+// Public key crypto
+#define MBEDTLS_BIGNUM_C
+#define MBEDTLS_ECP_C
+#define MBEDTLS_ECP_DP_SECP256R1_ENABLED
+#define MBEDTLS_ECP_DP_SECP384R1_ENABLED
+#define MBEDTLS_ECP_NIST_OPTIM
+#define MBEDTLS_ECDH_C
+#define MBEDTLS_ECDSA_C
+#define MBEDTLS_RSA_C
+#define MBEDTLS_PKCS1_V15
+#define MBEDTLS_PK_C
+#define MBEDTLS_PK_PARSE_C
+
+// X.509 server certificate verification (PEM or DER CA certificates).
+// Validity dates aren't checked: there is no MBEDTLS_HAVE_TIME_DATE.
+#define MBEDTLS_X509_USE_C
+#define MBEDTLS_X509_CRT_PARSE_C
+#define MBEDTLS_ASN1_PARSE_C
+#define MBEDTLS_ASN1_WRITE_C
+#define MBEDTLS_OID_C
+#define MBEDTLS_PEM_PARSE_C
+#define MBEDTLS_BASE64_C
+
+// Entropy is fed from HAL_RNG_GetRandomNumber by TlsSocket
+#define MBEDTLS_ENTROPY_C
+#define MBEDTLS_ENTROPY_FORCE_SHA256
+#define MBEDTLS_CTR_DRBG_C
 
-// We don't need hashing (NTAG424 uses CMAC not HMAC)
-// #define MBEDTLS_SHA256_C
-// #define MBEDTLS_MD_C
-
-// We don't need public key crypto
-// #define MBEDTLS_RSA_C
-// #define MBEDTLS_ECP_C
-// #define MBEDTLS_ECDSA_C
+// =============================================================================
+// Disabled Features
+// =============================================================================
 
-// We don't need TLS
-// #define MBEDTLS_SSL_CLI_C
+// We don't need a TLS server
 // #define MBEDTLS_SSL_SRV_C
 
-// We don't need X.509
-// #define MBEDTLS_X509_CRT_PARSE_C
-
 // =============================================================================
 // Platform Abstraction
 // =============================================================================
@@ -80,6 +129,10 @@
 #define mbedtls_calloc    calloc
 #define mbedtls_free      free
 
+// Used by X.509 to format names
+#include <stdio.h>
+#define mbedtls_snprintf  snprintf
+
 // Prevent use of deprecated functions
 #define MBEDTLS_DEPRECATED_REMOVED
 
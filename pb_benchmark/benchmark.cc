@@ -0,0 +1,101 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_benchmark/benchmark.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "pw_string/string_builder.h"
+
+namespace pb::benchmark {
+namespace {
+
+// Runs of back-to-back counter reads; the cheapest is the read overhead
+constexpr int kOverheadSamples = 16;
+
+uint32_t ReadOverhead(CycleCounter counter) {
+  uint32_t overhead = std::numeric_limits<uint32_t>::max();
+  for (int i = 0; i < kOverheadSamples; ++i) {
+    const uint32_t start = counter();
+    const uint32_t end = counter();
+    overhead = std::min(overhead, end - start);
+  }
+  return overhead;
+}
+
+}  // namespace
+
+Benchmark::Benchmark(const char* name,
+                     Body body,
+                     uint32_t warmup,
+                     uint32_t iterations)
+    : name_(name), body_(body), warmup_(warmup), iterations_(iterations) {
+  if (last_ == nullptr) {
+    first_ = this;
+  } else {
+    last_->next_ = this;
+  }
+  last_ = this;
+}
+
+Result Run(const Benchmark& benchmark, CycleCounter counter) {
+  Result result;
+  result.name = benchmark.name();
+  result.warmup = benchmark.warmup();
+  result.iterations = benchmark.iterations();
+
+  for (uint32_t i = 0; i < benchmark.warmup(); ++i) {
+    benchmark.Run();
+  }
+
+  const uint32_t overhead = ReadOverhead(counter);
+  result.min_cycles = std::numeric_limits<uint32_t>::max();
+  for (uint32_t i = 0; i < benchmark.iterations(); ++i) {
+    const uint32_t start = counter();
+    benchmark.Run();
+    const uint32_t elapsed = counter() - start;
+    const uint32_t cycles = elapsed > overhead ? elapsed - overhead : 0;
+    result.min_cycles = std::min(result.min_cycles, cycles);
+    result.max_cycles = std::max(result.max_cycles, cycles);
+    result.total_cycles += cycles;
+  }
+  if (result.iterations == 0) {
+    result.min_cycles = 0;
+  }
+  return result;
+}
+
+size_t RunAll(CycleCounter counter,
+              const pw::Function<void(const Result&)>& on_result) {
+  size_t count = 0;
+  for (const Benchmark* benchmark = Benchmark::first(); benchmark != nullptr;
+       benchmark = benchmark->next()) {
+    on_result(Run(*benchmark, counter));
+    ++count;
+  }
+  return count;
+}
+
+pw::StatusWithSize FormatResult(const Result& result,
+                                uint32_t cpu_hz,
+                                pw::span<char> out) {
+  const uint64_t mean_ns =
+      cpu_hz == 0 ? 0 : uint64_t{result.mean_cycles()} * 1'000'000'000 / cpu_hz;
+  pw::StringBuilder line(out);
+  line.Format(
+      "%s{\"name\":\"%s\",\"warmup\":%u,\"iterations\":%u,"
+      "\"min_cycles\":%u,\"mean_cycles\":%u,\"max_cycles\":%u,"
+      "\"mean_ns\":%u}",
+      kResultPrefix,
+      result.name,
+      static_cast<unsigned>(result.warmup),
+      static_cast<unsigned>(result.iterations),
+      static_cast<unsigned>(result.min_cycles),
+      static_cast<unsigned>(result.mean_cycles()),
+      static_cast<unsigned>(result.max_cycles),
+      static_cast<unsigned>(mean_ns));
+  return pw::StatusWithSize(line.status(), line.size());
+}
+
+}  // namespace pb::benchmark
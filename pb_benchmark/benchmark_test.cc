@@ -0,0 +1,94 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_benchmark/benchmark.h"
+
+#include <array>
+#include <cstring>
+#include <string_view>
+
+#include "pw_unit_test/framework.h"
+
+namespace {
+
+// Fake cycle counter: only the benchmark bodies advance it
+uint32_t fake_cycles = 0;
+uint32_t ReadFakeCycles() { return fake_cycles; }
+
+int first_runs = 0;
+
+PB_BENCHMARK_WITH_ITERATIONS(Fake, First, 2, 5) {
+  ++first_runs;
+  fake_cycles += 100 + static_cast<uint32_t>(first_runs) * 10;
+}
+
+PB_BENCHMARK(Fake, Second) { fake_cycles += 7; }
+
+TEST(Benchmark, RegistersInOrder) {
+  const pb::benchmark::Benchmark* first = pb::benchmark::Benchmark::first();
+  ASSERT_NE(first, nullptr);
+  EXPECT_STREQ(first->name(), "Fake.First");
+  ASSERT_NE(first->next(), nullptr);
+  EXPECT_STREQ(first->next()->name(), "Fake.Second");
+  EXPECT_EQ(first->next()->iterations(),
+            pb::benchmark::config::kDefaultIterations);
+  EXPECT_EQ(first->next()->next(), nullptr);
+}
+
+TEST(Benchmark, RunTimesIterationsAfterWarmup) {
+  first_runs = 0;
+  const pb::benchmark::Result result =
+      pb::benchmark::Run(*pb::benchmark::Benchmark::first(), ReadFakeCycles);
+
+  EXPECT_EQ(first_runs, 7);
+  EXPECT_EQ(result.iterations, 5u);
+  // Timed runs 3..7 take 130..170 cycles
+  EXPECT_EQ(result.min_cycles, 130u);
+  EXPECT_EQ(result.max_cycles, 170u);
+  EXPECT_EQ(result.mean_cycles(), 150u);
+}
+
+TEST(Benchmark, CounterWrapIsHandled) {
+  fake_cycles = 0xFFFFFFF0u;
+  const pb::benchmark::Result result = pb::benchmark::Run(
+      *pb::benchmark::Benchmark::first()->next(), ReadFakeCycles);
+  EXPECT_EQ(result.min_cycles, 7u);
+  EXPECT_EQ(result.max_cycles, 7u);
+}
+
+TEST(Benchmark, RunAllReportsEveryBenchmark) {
+  int results = 0;
+  const size_t count = pb::benchmark::RunAll(
+      ReadFakeCycles, [&results](const pb::benchmark::Result&) { ++results; });
+  EXPECT_EQ(count, 2u);
+  EXPECT_EQ(results, 2);
+}
+
+TEST(Benchmark, FormatResult) {
+  pb::benchmark::Result result;
+  result.name = "Fake.First";
+  result.warmup = 2;
+  result.iterations = 4;
+  result.min_cycles = 100;
+  result.max_cycles = 300;
+  result.total_cycles = 800;
+
+  std::array<char, 256> buffer;
+  const pw::StatusWithSize formatted =
+      pb::benchmark::FormatResult(result, 200'000'000, buffer);
+  ASSERT_TRUE(formatted.ok());
+  EXPECT_EQ(std::string_view(buffer.data(), formatted.size()),
+            "PB_BENCH {\"name\":\"Fake.First\",\"warmup\":2,\"iterations\":4,"
+            "\"min_cycles\":100,\"mean_cycles\":200,\"max_cycles\":300,"
+            "\"mean_ns\":1000}");
+}
+
+TEST(Benchmark, FormatResultTooSmall) {
+  pb::benchmark::Result result;
+  result.name = "Fake.First";
+  std::array<char, 16> buffer;
+  EXPECT_EQ(pb::benchmark::FormatResult(result, 200'000'000, buffer).status(),
+            pw::Status::ResourceExhausted());
+}
+
+}  // namespace
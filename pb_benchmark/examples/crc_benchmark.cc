@@ -0,0 +1,27 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+// The CRC example of docs.rst, built by //pb_benchmark:crc_benchmark so the
+// particle_benchmark rule is exercised in-tree.
+
+#include <array>
+#include <cstddef>
+
+#include "pb_benchmark/benchmark.h"
+#include "pw_checksum/crc32.h"
+
+namespace {
+
+constexpr std::array<std::byte, 1024> kData = [] {
+  std::array<std::byte, 1024> data{};
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<std::byte>(i * 31);
+  }
+  return data;
+}();
+
+PB_BENCHMARK(Crc, Crc32Of1k) {
+  pb::benchmark::DoNotOptimize(pw::checksum::Crc32::Calculate(kData));
+}
+
+}  // namespace
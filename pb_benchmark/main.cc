@@ -0,0 +1,57 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Benchmark runner main. Called via pigweed_entry.cc like the unit test main
+// (pw_unit_test_particle/main.cc): waits for USB serial, runs every
+// registered benchmark, prints one PB_BENCH line per result and a final
+// PB_BENCH_DONE line, then idles.
+
+#include <array>
+
+#include "pb_benchmark/benchmark.h"
+#include "pw_chrono_particle/cycle_clock.h"
+#include "pw_string/string_builder.h"
+#include "pw_sys_io/sys_io.h"
+
+// Particle HAL includes (exported via dynalib)
+#include "delay_hal.h"
+#include "usb_hal.h"
+
+namespace {
+
+constexpr HAL_USB_USART_Serial kSerial = HAL_USB_USART_SERIAL;
+
+// Longest result line: prefix, JSON keys, a benchmark name and 7 numbers
+std::array<char, 256> line_buffer;
+
+}  // namespace
+
+// Called by pigweed_entry.cc from setup()
+int main() {
+  while (!HAL_USB_USART_Is_Connected(kSerial)) {
+    HAL_Delay_Milliseconds(100);
+  }
+  // Brief delay for terminal to stabilize
+  HAL_Delay_Milliseconds(500);
+
+  pw::chrono::particle::EnableCycleCounter();
+  const size_t count = pb::benchmark::RunAll(
+      pw::chrono::particle::ReadCycles, [](const pb::benchmark::Result& r) {
+        const pw::StatusWithSize formatted = pb::benchmark::FormatResult(
+            r, PW_CHRONO_PARTICLE_CPU_HZ, line_buffer);
+        pw::sys_io::WriteLine(
+            std::string_view(line_buffer.data(), formatted.size()))
+            .IgnoreError();
+      });
+
+  pw::StringBuilder done(line_buffer);
+  done.Format("PB_BENCH_DONE {\"count\":%u}", static_cast<unsigned>(count));
+  pw::sys_io::WriteLine(done.view()).IgnoreError();
+
+  // Idle forever; the harness reads the results and reflashes as needed
+  while (true) {
+    HAL_Delay_Milliseconds(1000);
+  }
+
+  return 0;
+}
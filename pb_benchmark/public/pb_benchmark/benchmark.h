@@ -0,0 +1,131 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file benchmark.h
+/// @brief Registered microbenchmarks, timed in CPU cycles.
+///
+/// A benchmark body runs once per iteration; the runner times each run with
+/// a cycle counter and reports min, mean and max:
+///
+/// @code
+///   PB_BENCHMARK(Crc, Crc32Of1k) {
+///     pb::benchmark::DoNotOptimize(Crc32(kData));
+///   }
+///
+///   PB_BENCHMARK_WITH_ITERATIONS(Spi, WriteRead4k, 2, 20) {
+///     PW_CHECK_OK(spi.WriteRead(tx, rx));
+///   }
+/// @endcode
+///
+/// particle_benchmark() in rules/particle_benchmark.bzl builds registered
+/// benchmarks into firmware whose main() runs them all and streams one
+/// PB_BENCH line per result over USB serial.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pb_benchmark/config.h"
+#include "pw_function/function.h"
+#include "pw_span/span.h"
+#include "pw_status/status_with_size.h"
+
+namespace pb::benchmark {
+
+/// Reads a free-running 32-bit cycle counter. Differences of two reads must
+/// be correct across one wrap.
+using CycleCounter = uint32_t (*)();
+
+/// A registered benchmark. Created by the PB_BENCHMARK macros as a static;
+/// registration appends to a global list in construction order.
+class Benchmark {
+ public:
+  using Body = void (*)();
+
+  Benchmark(const char* name, Body body, uint32_t warmup, uint32_t iterations);
+
+  Benchmark(const Benchmark&) = delete;
+  Benchmark& operator=(const Benchmark&) = delete;
+
+  const char* name() const { return name_; }
+  uint32_t warmup() const { return warmup_; }
+  uint32_t iterations() const { return iterations_; }
+  void Run() const { body_(); }
+
+  const Benchmark* next() const { return next_; }
+
+  /// First registered benchmark, or nullptr if none.
+  static const Benchmark* first() { return first_; }
+
+ private:
+  const char* name_;
+  Body body_;
+  uint32_t warmup_;
+  uint32_t iterations_;
+  Benchmark* next_ = nullptr;
+
+  static inline Benchmark* first_ = nullptr;
+  static inline Benchmark* last_ = nullptr;
+};
+
+/// Timing of one benchmark. Cycles exclude the cost of reading the counter.
+struct Result {
+  const char* name = "";
+  uint32_t warmup = 0;
+  uint32_t iterations = 0;
+  uint32_t min_cycles = 0;
+  uint32_t max_cycles = 0;
+  uint64_t total_cycles = 0;
+
+  uint32_t mean_cycles() const {
+    return iterations == 0
+               ? 0
+               : static_cast<uint32_t>(total_cycles / iterations);
+  }
+};
+
+/// Run `benchmark`: its warmup runs, then its timed iterations.
+Result Run(const Benchmark& benchmark, CycleCounter counter);
+
+/// Run every registered benchmark in registration order, passing each
+/// result to `on_result`. Returns the number run.
+size_t RunAll(CycleCounter counter,
+              const pw::Function<void(const Result&)>& on_result);
+
+/// Line prefix of formatted results.
+inline constexpr const char* kResultPrefix = "PB_BENCH ";
+
+/// Format `result` as one line: kResultPrefix followed by a JSON object
+/// with the name, counts, cycle statistics and the mean in nanoseconds at
+/// `cpu_hz`. ResourceExhausted if `out` is too small.
+pw::StatusWithSize FormatResult(const Result& result,
+                                uint32_t cpu_hz,
+                                pw::span<char> out);
+
+/// Keep the compiler from discarding a computed value.
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+}  // namespace pb::benchmark
+
+/// Register a benchmark named "group.name" with the default warmup and
+/// iteration counts (config.h). The braces that follow are its body.
+#define PB_BENCHMARK(group, name)                  \
+  PB_BENCHMARK_WITH_ITERATIONS(                    \
+      group,                                       \
+      name,                                        \
+      ::pb::benchmark::config::kDefaultWarmup,     \
+      ::pb::benchmark::config::kDefaultIterations)
+
+/// Register a benchmark with explicit warmup and iteration counts.
+#define PB_BENCHMARK_WITH_ITERATIONS(group, name, warmup, iterations) \
+  static void PbBenchmark_##group##_##name();                         \
+  static ::pb::benchmark::Benchmark pb_benchmark_##group##_##name(    \
+      #group "." #name,                                               \
+      PbBenchmark_##group##_##name,                                   \
+      warmup,                                                         \
+      iterations);                                                    \
+  static void PbBenchmark_##group##_##name()
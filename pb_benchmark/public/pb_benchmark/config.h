@@ -0,0 +1,25 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstdint>
+
+// Configuration options for pb_benchmark
+
+// Untimed runs before measuring, to warm caches and lazy initialization.
+#ifndef PB_BENCHMARK_DEFAULT_WARMUP
+#define PB_BENCHMARK_DEFAULT_WARMUP 8
+#endif
+
+// Timed runs per benchmark registered with PB_BENCHMARK().
+#ifndef PB_BENCHMARK_DEFAULT_ITERATIONS
+#define PB_BENCHMARK_DEFAULT_ITERATIONS 100
+#endif
+
+namespace pb::benchmark::config {
+
+inline constexpr uint32_t kDefaultWarmup = PB_BENCHMARK_DEFAULT_WARMUP;
+inline constexpr uint32_t kDefaultIterations = PB_BENCHMARK_DEFAULT_ITERATIONS;
+
+}  // namespace pb::benchmark::config
@@ -0,0 +1,47 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#define PW_LOG_MODULE_NAME "pb_boot"
+
+#include "pb_boot/boot_timeline.h"
+
+#include "pb_boot/timeline.h"
+#include "pw_log/log.h"
+#include "timer_hal.h"
+
+namespace pb::boot {
+namespace {
+
+// Constant-initialized, so marks from module_user_init_hook (before
+// C++ static constructors run) are safe
+constinit Timeline<PB_BOOT_MAX_MILESTONES> g_timeline;
+
+}  // namespace
+
+void MarkBootMilestone(const char* name) {
+  g_timeline.Mark(name, HAL_Timer_Get_Micro_Seconds());
+}
+
+void ForEachBootMilestone(
+    const pw::Function<void(const char* name, uint32_t time_us)>& visit) {
+  g_timeline.ForEach(visit);
+}
+
+void LogBootTimeline() {
+  uint32_t previous_us = 0;
+  g_timeline.ForEach([&previous_us](const char* name, uint32_t time_us) {
+    PW_LOG_INFO("boot %-24s %7u.%03u ms  +%u.%03u ms",
+                name,
+                static_cast<unsigned>(time_us / 1000),
+                static_cast<unsigned>(time_us % 1000),
+                static_cast<unsigned>((time_us - previous_us) / 1000),
+                static_cast<unsigned>((time_us - previous_us) % 1000));
+    previous_us = time_us;
+  });
+  if (g_timeline.dropped() > 0) {
+    PW_LOG_WARN("boot timeline full, %u milestones dropped",
+                static_cast<unsigned>(g_timeline.dropped()));
+  }
+}
+
+}  // namespace pb::boot
@@ -0,0 +1,39 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Startup timeline: timestamped milestones from reset to "ready".
+//
+// pigweed_entry.cc marks the Device OS entry points; applications add their
+// own (pw_system start, first RPC, first cloud publish, ...):
+//
+//   pb::boot::MarkBootMilestone("cloud_connected");
+//   ...
+//   pb::boot::LogBootTimeline();
+
+#pragma once
+
+#include <cstdint>
+
+#include "pw_function/function.h"
+
+// Maximum number of milestones recorded per boot.
+#ifndef PB_BOOT_MAX_MILESTONES
+#define PB_BOOT_MAX_MILESTONES 32
+#endif
+
+namespace pb::boot {
+
+// Record `name` (a string literal) at the current time. Safe from any
+// thread and from interrupts.
+void MarkBootMilestone(const char* name);
+
+// Pass each milestone to `visit`, in marking order. `time_us` is the
+// microsecond timer, which starts with the Device OS HAL shortly after
+// reset.
+void ForEachBootMilestone(
+    const pw::Function<void(const char* name, uint32_t time_us)>& visit);
+
+// Log every milestone with its time and the delta to the previous one.
+void LogBootTimeline();
+
+}  // namespace pb::boot
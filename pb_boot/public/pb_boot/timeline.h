@@ -0,0 +1,68 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file timeline.h
+/// @brief Fixed-size list of timestamped milestones.
+///
+/// Mark() claims a slot with one atomic increment and publishes it with one
+/// release store, so any thread or interrupt can mark without a lock. Marks
+/// beyond kMaxMilestones are dropped and counted.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace pb::boot {
+
+template <size_t kMaxMilestones>
+class Timeline {
+ public:
+  /// Record `name` at `time_us`. `name` must be a string literal (or
+  /// otherwise outlive the timeline).
+  ///
+  /// @return False if the timeline is full
+  bool Mark(const char* name, uint32_t time_us) {
+    const size_t index = next_.fetch_add(1, std::memory_order_relaxed);
+    if (index >= kMaxMilestones) {
+      next_.store(kMaxMilestones, std::memory_order_relaxed);
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    milestones_[index].time_us = time_us;
+    milestones_[index].name.store(name, std::memory_order_release);
+    return true;
+  }
+
+  /// Pass each published milestone to `visit(name, time_us)` in the order
+  /// the slots were claimed.
+  template <typename Visit>
+  void ForEach(Visit&& visit) const {
+    const size_t count =
+        std::min(next_.load(std::memory_order_relaxed), kMaxMilestones);
+    for (size_t i = 0; i < count; ++i) {
+      const char* name = milestones_[i].name.load(std::memory_order_acquire);
+      if (name != nullptr) {
+        visit(name, milestones_[i].time_us);
+      }
+    }
+  }
+
+  /// Marks dropped because the timeline was full.
+  uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Milestone {
+    std::atomic<const char*> name{nullptr};
+    uint32_t time_us = 0;
+  };
+
+  std::array<Milestone, kMaxMilestones> milestones_;
+  std::atomic<size_t> next_{0};
+  std::atomic<uint32_t> dropped_{0};
+};
+
+}  // namespace pb::boot
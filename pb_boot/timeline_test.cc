@@ -0,0 +1,49 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_boot/timeline.h"
+
+#include <string_view>
+
+#include "pw_unit_test/framework.h"
+
+namespace pb::boot {
+namespace {
+
+TEST(Timeline, KeepsMarkingOrder) {
+  Timeline<4> timeline;
+  EXPECT_TRUE(timeline.Mark("setup", 100));
+  EXPECT_TRUE(timeline.Mark("main", 250));
+
+  std::string_view names[2];
+  uint32_t times[2] = {};
+  size_t count = 0;
+  timeline.ForEach([&](const char* name, uint32_t time_us) {
+    names[count] = name;
+    times[count] = time_us;
+    ++count;
+  });
+
+  ASSERT_EQ(count, 2u);
+  EXPECT_EQ(names[0], "setup");
+  EXPECT_EQ(times[0], 100u);
+  EXPECT_EQ(names[1], "main");
+  EXPECT_EQ(times[1], 250u);
+  EXPECT_EQ(timeline.dropped(), 0u);
+}
+
+TEST(Timeline, DropsMarksWhenFull) {
+  Timeline<2> timeline;
+  EXPECT_TRUE(timeline.Mark("a", 1));
+  EXPECT_TRUE(timeline.Mark("b", 2));
+  EXPECT_FALSE(timeline.Mark("c", 3));
+  EXPECT_FALSE(timeline.Mark("d", 4));
+
+  size_t count = 0;
+  timeline.ForEach([&](const char*, uint32_t) { ++count; });
+  EXPECT_EQ(count, 2u);
+  EXPECT_EQ(timeline.dropped(), 2u);
+}
+
+}  // namespace
+}  // namespace pb::boot
@@ -0,0 +1,117 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_cloud/batching_publisher.h"
+
+#include <algorithm>
+
+#include "pb_cloud/cbor.h"
+
+namespace pb::cloud {
+
+using pw::chrono::SystemClock;
+
+BatchingPublisher::BatchingPublisher(CloudBackend& cloud,
+                                     std::string_view name,
+                                     const BatchingOptions& options)
+    : cloud_(cloud), name_(name), options_(options) {
+  options_.max_batch_bytes =
+      std::min(options_.max_batch_bytes, kMaxEventDataSize);
+}
+
+pw::Status BatchingPublisher::Add(pw::ConstByteSpan entry) {
+  const size_t entry_size = cbor::Encoder::HeaderSize(entry.size()) +
+                            entry.size();
+  if (cbor::Encoder::HeaderSize(1) + entry_size > options_.max_batch_bytes) {
+    return pw::Status::InvalidArgument();
+  }
+
+  const size_t size_with_entry =
+      cbor::Encoder::HeaderSize(entry_count_ + 1) + entries_size_ + entry_size;
+  if (size_with_entry > options_.max_batch_bytes) {
+    if (in_flight_.has_value()) {
+      // Publish the full batch as soon as the one in flight completes
+      flush_requested_ = true;
+      return pw::Status::ResourceExhausted();
+    }
+    StartPublish();
+  }
+
+  cbor::Encoder encoder(
+      pw::ByteSpan(buffer_).subspan(kHeaderReserve + entries_size_));
+  if (pw::Status status = encoder.WriteBytes(entry); !status.ok()) {
+    return status;
+  }
+  if (entry_count_ == 0) {
+    oldest_entry_time_ = SystemClock::now();
+  }
+  entries_size_ += encoder.size();
+  ++entry_count_;
+  return pw::OkStatus();
+}
+
+pw::Status BatchingPublisher::Flush() {
+  if (entry_count_ == 0) {
+    return pw::OkStatus();
+  }
+  if (in_flight_.has_value()) {
+    flush_requested_ = true;
+    return pw::Status::Unavailable();
+  }
+  StartPublish();
+  return pw::OkStatus();
+}
+
+pw::async2::Poll<pw::Status> BatchingPublisher::Pend(
+    pw::async2::Context& cx) {
+  while (true) {
+    if (!in_flight_.has_value()) {
+      if (!FlushDue()) {
+        return pw::async2::Ready(last_status_);
+      }
+      StartPublish();
+    }
+
+    pw::async2::Poll<pw::Status> poll = in_flight_->Pend(cx);
+    if (poll.IsPending()) {
+      return pw::async2::Pending();
+    }
+    last_status_ = poll.value();
+    in_flight_.reset();
+  }
+}
+
+size_t BatchingPublisher::batch_size() const {
+  return entry_count_ == 0
+             ? 0
+             : cbor::Encoder::HeaderSize(entry_count_) + entries_size_;
+}
+
+bool BatchingPublisher::FlushDue() const {
+  if (entry_count_ == 0) {
+    return false;
+  }
+  return flush_requested_ ||
+         SystemClock::now() - oldest_entry_time_ >= options_.max_age;
+}
+
+void BatchingPublisher::StartPublish() {
+  const size_t header_size = cbor::Encoder::HeaderSize(entry_count_);
+  const size_t start = kHeaderReserve - header_size;
+  cbor::Encoder header(pw::ByteSpan(buffer_).subspan(start, header_size));
+  // Can't fail, the header is sized for exactly this count
+  header.BeginArray(entry_count_).IgnoreError();
+
+  // The backend copies the data, so the buffer can take new entries
+  in_flight_ = cloud_.Publish(
+      name_,
+      pw::ConstByteSpan(buffer_).subspan(start, header_size + entries_size_),
+      options_.publish);
+  ++batch_count_;
+
+  entries_size_ = 0;
+  entry_count_ = 0;
+  flush_requested_ = false;
+}
+
+}  // namespace pb::cloud
@@ -0,0 +1,103 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_cloud/batching_publisher.h"
+
+#include <array>
+#include <cstddef>
+
+#include "mock_cloud_backend.h"
+#include "pb_cloud/cbor.h"
+#include "pw_unit_test/framework.h"
+
+namespace pb::cloud {
+namespace {
+
+constexpr auto kEntryA = std::array<std::byte, 2>{std::byte{0x01},
+                                                  std::byte{0x02}};
+constexpr auto kEntryB = std::array<std::byte, 1>{std::byte{0x03}};
+
+pw::ConstByteSpan PublishedData(const MockCloudBackend& mock) {
+  return pw::ConstByteSpan(mock.last_published().data.data(),
+                           mock.last_published().data.size());
+}
+
+class BatchingPublisherTest : public ::testing::Test {
+ protected:
+  MockCloudBackend mock_;
+};
+
+TEST_F(BatchingPublisherTest, FlushPublishesEntriesAsCborArray) {
+  BatchingPublisher publisher(mock_, "status");
+  ASSERT_EQ(publisher.Add(kEntryA), pw::OkStatus());
+  ASSERT_EQ(publisher.Add(kEntryB), pw::OkStatus());
+  EXPECT_EQ(publisher.entry_count(), 2u);
+  EXPECT_EQ(publisher.batch_size(), 6u);
+
+  ASSERT_EQ(publisher.Flush(), pw::OkStatus());
+
+  // 82 42 0102 41 03: array(2), bytes(2), bytes(1)
+  constexpr auto kExpected = std::array<std::byte, 6>{
+      std::byte{0x82}, std::byte{0x42}, std::byte{0x01},
+      std::byte{0x02}, std::byte{0x41}, std::byte{0x03}};
+  pw::ConstByteSpan data = PublishedData(mock_);
+  ASSERT_EQ(data.size(), kExpected.size());
+  for (size_t i = 0; i < kExpected.size(); ++i) {
+    EXPECT_EQ(data[i], kExpected[i]);
+  }
+  EXPECT_EQ(mock_.last_published().name, "status");
+  EXPECT_EQ(mock_.last_published().options.content_type,
+            ContentType::kStructured);
+  EXPECT_EQ(publisher.entry_count(), 0u);
+  EXPECT_EQ(publisher.batch_count(), 1u);
+  EXPECT_TRUE(publisher.publish_in_flight());
+}
+
+TEST_F(BatchingPublisherTest, EmptyFlushDoesNotPublish) {
+  BatchingPublisher publisher(mock_, "status");
+  EXPECT_EQ(publisher.Flush(), pw::OkStatus());
+  EXPECT_EQ(mock_.publish_count(), 0u);
+}
+
+TEST_F(BatchingPublisherTest, FullBatchIsPublishedBeforeNextEntry) {
+  // Room for the header and two 2-byte entries (3 bytes each)
+  BatchingPublisher publisher(mock_, "status", {.max_batch_bytes = 7});
+  ASSERT_EQ(publisher.Add(kEntryA), pw::OkStatus());
+  ASSERT_EQ(publisher.Add(kEntryA), pw::OkStatus());
+  EXPECT_EQ(mock_.publish_count(), 0u);
+
+  ASSERT_EQ(publisher.Add(kEntryA), pw::OkStatus());
+
+  EXPECT_EQ(mock_.publish_count(), 1u);
+  EXPECT_EQ(mock_.last_published().data.size(), 7u);
+  EXPECT_EQ(publisher.entry_count(), 1u);
+}
+
+TEST_F(BatchingPublisherTest, AddReportsBackPressureWhileBatchInFlight) {
+  BatchingPublisher publisher(mock_, "status", {.max_batch_bytes = 7});
+  ASSERT_EQ(publisher.Add(kEntryA), pw::OkStatus());
+  ASSERT_EQ(publisher.Flush(), pw::OkStatus());
+  ASSERT_EQ(publisher.Add(kEntryA), pw::OkStatus());
+  ASSERT_EQ(publisher.Add(kEntryA), pw::OkStatus());
+
+  EXPECT_EQ(publisher.Add(kEntryA), pw::Status::ResourceExhausted());
+  EXPECT_EQ(publisher.Flush(), pw::Status::Unavailable());
+  EXPECT_EQ(mock_.publish_count(), 1u);
+  EXPECT_EQ(publisher.entry_count(), 2u);
+}
+
+TEST_F(BatchingPublisherTest, RejectsEntryLargerThanBatch) {
+  BatchingPublisher publisher(mock_, "status", {.max_batch_bytes = 3});
+  EXPECT_EQ(publisher.Add(kEntryA), pw::Status::InvalidArgument());
+  EXPECT_EQ(publisher.Add(kEntryB), pw::OkStatus());
+}
+
+TEST_F(BatchingPublisherTest, BatchSizeIsCappedAtEventLimit) {
+  BatchingPublisher publisher(mock_, "status",
+                              {.max_batch_bytes = 4 * kMaxEventDataSize});
+  std::array<std::byte, kMaxEventDataSize> too_large{};
+  EXPECT_EQ(publisher.Add(too_large), pw::Status::InvalidArgument());
+}
+
+}  // namespace
+}  // namespace pb::cloud
@@ -3,22 +3,355 @@
 
 #include "pb_cloud/cbor.h"
 
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
 #include <cstring>
 
+#include "pb_ramfunc/ramfunc.h"
+#include "pw_bytes/endian.h"
 #include "pw_status/try.h"
 
 namespace pb::cloud::cbor {
+namespace {
+
+// Additional info for indefinite-length items, and the break ending them
+constexpr uint8_t kIndefiniteInfo = 31;
+constexpr uint8_t kBreak = 0xff;
+
+// Header argument the decoders use for an indefinite length
+constexpr uint64_t kIndefiniteArgument = UINT64_MAX;
+
+bool AllowsIndefinite(MajorType type) {
+  return type == MajorType::kByteString || type == MajorType::kTextString ||
+         type == MajorType::kArray || type == MajorType::kMap;
+}
+
+/// Store `value` in `order` with one (byte-swapping) word write.
+template <typename T>
+void Store(std::byte* out, T value, pw::endian order) {
+  const auto bytes = pw::bytes::CopyInOrder(order, value);
+  std::memcpy(out, bytes.data(), bytes.size());
+}
+
+/// Store a 1, 2, 4 or 8 byte big-endian header argument.
+void StoreArgument(std::byte* out, uint64_t value, size_t len) {
+  switch (len) {
+    case 1:
+      out[0] = static_cast<std::byte>(value);
+      break;
+    case 2:
+      Store(out, static_cast<uint16_t>(value), pw::endian::big);
+      break;
+    case 4:
+      Store(out, static_cast<uint32_t>(value), pw::endian::big);
+      break;
+    default:
+      Store(out, value, pw::endian::big);
+      break;
+  }
+}
+
+/// Load a 1, 2, 4 or 8 byte big-endian header argument.
+uint64_t LoadArgument(const std::byte* in, size_t len) {
+  switch (len) {
+    case 1:
+      return static_cast<uint8_t>(in[0]);
+    case 2:
+      return pw::bytes::ReadInOrder<uint16_t>(pw::endian::big, in);
+    case 4:
+      return pw::bytes::ReadInOrder<uint32_t>(pw::endian::big, in);
+    default:
+      return pw::bytes::ReadInOrder<uint64_t>(pw::endian::big, in);
+  }
+}
+
+/// A parsed item header.
+struct Header {
+  MajorType type;
+  uint64_t argument;
+  size_t size;  // Initial byte plus argument bytes
+};
+
+/// Parse the header at data[pos], known to be well-formed (validated).
+Header ParseValidatedHeader(pw::ConstByteSpan data, size_t pos) {
+  const uint8_t initial = static_cast<uint8_t>(data[pos]);
+  const MajorType type = static_cast<MajorType>(initial >> 5);
+  const uint8_t additional = initial & 0x1f;
+  if (additional < 24) {
+    return Header{type, additional, 1};
+  }
+  if (additional == kIndefiniteInfo) {
+    return Header{type, kIndefiniteArgument, 1};
+  }
+  const size_t len = size_t{1} << (additional - 24);
+  return Header{type, LoadArgument(&data[pos + 1], len), len + 1};
+}
+
+/// Parse the header at data[pos] with a single bounds check.
+PB_RAMFUNC pw::Result<Header> ParseHeader(pw::ConstByteSpan data,
+                                          size_t pos) {
+  if (pos >= data.size()) {
+    return pw::Status::DataLoss();
+  }
+  const uint8_t initial = static_cast<uint8_t>(data[pos]);
+  const MajorType type = static_cast<MajorType>(initial >> 5);
+  const uint8_t additional = initial & 0x1f;
+
+  if (additional < 24) {
+    return Header{type, additional, 1};
+  }
+  if (additional == kIndefiniteInfo && AllowsIndefinite(type)) {
+    return Header{type, kIndefiniteArgument, 1};
+  }
+  if (additional > 27) {
+    // Reserved (28-30) or a break outside an indefinite-length item
+    return pw::Status::Unimplemented();
+  }
+  // 24..27 are followed by a 1, 2, 4 or 8 byte big-endian argument
+  const size_t len = size_t{1} << (additional - 24);
+  if (data.size() - pos - 1 < len) {
+    return pw::Status::DataLoss();
+  }
+  return Header{type, LoadArgument(&data[pos + 1], len), len + 1};
+}
+
+/// Float16 bits for `value`, if it converts without loss.
+bool ToHalf(float value, uint16_t& half) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+  const int exponent = static_cast<int>((bits >> 23) & 0xff) - 127;
+  const uint32_t mantissa = bits & 0x7fffff;
+
+  if (exponent == 128) {  // Infinity (NaN is handled by the caller)
+    half = sign | 0x7c00;
+    return mantissa == 0;
+  }
+  if (exponent == -127) {  // Zero; float subnormals are below float16 range
+    half = sign;
+    return mantissa == 0;
+  }
+  if (exponent >= -14 && exponent <= 15) {  // float16 normal
+    half = static_cast<uint16_t>(sign | ((exponent + 15) << 10) |
+                                 (mantissa >> 13));
+    return (mantissa & 0x1fff) == 0;
+  }
+  if (exponent >= -24 && exponent < -14) {  // float16 subnormal
+    const uint32_t significand = mantissa | 0x800000;
+    const int shift = -1 - exponent;
+    half = static_cast<uint16_t>(sign | (significand >> shift));
+    return (significand & ((1u << shift) - 1)) == 0;
+  }
+  return false;
+}
+
+/// Decode float16 bits (RFC 8949 Appendix D).
+double HalfToDouble(uint16_t half) {
+  const int exponent = (half >> 10) & 0x1f;
+  const int mantissa = half & 0x3ff;
+  double value;
+  if (exponent == 0) {
+    value = std::ldexp(mantissa, -24);
+  } else if (exponent != 31) {
+    value = std::ldexp(mantissa + 1024, exponent - 25);
+  } else {
+    value = mantissa == 0 ? INFINITY : NAN;
+  }
+  return (half & 0x8000) != 0 ? -value : value;
+}
+
+/// Decode the payload of a float16/32/64 item (additional info 25..27).
+double DecodeFloat(uint8_t additional, uint64_t bits) {
+  if (additional == static_cast<uint8_t>(SimpleValue::kFloat16)) {
+    return HalfToDouble(static_cast<uint16_t>(bits));
+  }
+  if (additional == static_cast<uint8_t>(SimpleValue::kFloat32)) {
+    const auto single_bits = static_cast<uint32_t>(bits);
+    float value;
+    std::memcpy(&value, &single_bits, sizeof(value));
+    return value;
+  }
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+bool IsFloat(uint8_t initial) {
+  const uint8_t additional = initial & 0x1f;
+  return static_cast<MajorType>(initial >> 5) == MajorType::kSimpleFloat &&
+         additional >= static_cast<uint8_t>(SimpleValue::kFloat16) &&
+         additional <= static_cast<uint8_t>(SimpleValue::kFloat64);
+}
+
+// Largest header (or float) item: initial byte + 8-byte argument
+constexpr size_t kMaxHeaderSize = 9;
+
+/// Encode a type header into `out` (kMaxHeaderSize bytes available).
+///
+/// @return Bytes written, Encoder::HeaderSize(argument)
+PB_RAMFUNC size_t EncodeHeader(MajorType type, uint64_t argument,
+                               std::byte* out) {
+  const uint8_t major = static_cast<uint8_t>(type) << 5;
+  if (argument < 24) {
+    // Encode in initial byte
+    out[0] = static_cast<std::byte>(major | argument);
+    return 1;
+  }
+  // 1, 2, 4 or 8 byte big-endian argument after additional info 24..27
+  const size_t len = Encoder::HeaderSize(argument) - 1;
+  const uint8_t additional = len == 1 ? 24 : len == 2 ? 25 : len == 4 ? 26 : 27;
+  out[0] = static_cast<std::byte>(major | additional);
+  StoreArgument(out + 1, argument, len);
+  return len + 1;
+}
+
+/// Encode a float64 item (9 bytes) into `out`.
+size_t EncodeDouble(double value, std::byte* out) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  out[0] = static_cast<std::byte>(0xfb);
+  Store(out + 1, bits, pw::endian::big);
+  return 9;
+}
+
+/// Encode `value` as the shortest float item that represents it exactly.
+///
+/// @return Bytes written (3, 5 or 9)
+size_t EncodeFloat(double value, std::byte* out) {
+  uint16_t half = 0x7e00;  // Canonical NaN
+  bool use_half = std::isnan(value);
+  bool use_single = false;
+  float single = 0;
+  if (!use_half && (std::isinf(value) || std::fabs(value) <= FLT_MAX)) {
+    single = static_cast<float>(value);
+    use_single = static_cast<double>(single) == value;
+    use_half = use_single && ToHalf(single, half);
+  }
+
+  if (use_half) {
+    out[0] = static_cast<std::byte>(0xf9);
+    Store(out + 1, half, pw::endian::big);
+    return 3;
+  }
+  if (use_single) {
+    uint32_t bits;
+    std::memcpy(&bits, &single, sizeof(bits));
+    out[0] = static_cast<std::byte>(0xfa);
+    Store(out + 1, bits, pw::endian::big);
+    return 5;
+  }
+  return EncodeDouble(value, out);
+}
+
+}  // namespace
 
 // -- Encoder Implementation --
 
 Encoder::Encoder(pw::ByteSpan buffer) : buffer_(buffer) {}
 
 pw::Status Encoder::BeginMap(size_t count) {
-  return WriteHeader(MajorType::kMap, count);
+  return BeginContainer(MajorType::kMap, count);
+}
+
+pw::Status Encoder::BeginArray(size_t count) {
+  return BeginContainer(MajorType::kArray, count);
+}
+
+pw::Status Encoder::BeginMap(std::string_view key, size_t count) {
+  PW_TRY(WriteKey(key));
+  return BeginMap(count);
+}
+
+pw::Status Encoder::BeginArray(std::string_view key, size_t count) {
+  PW_TRY(WriteKey(key));
+  return BeginArray(count);
+}
+
+pw::Status Encoder::End() {
+  if (open_indefinite_ == 0) {
+    return pw::Status::FailedPrecondition();
+  }
+  if (remaining() < 1) {
+    return pw::Status::ResourceExhausted();
+  }
+  buffer_[pos_++] = static_cast<std::byte>(kBreak);
+  --open_indefinite_;
+  return pw::OkStatus();
+}
+
+pw::Status Encoder::BeginContainer(MajorType type, size_t count) {
+  if (count != kIndefiniteLength) {
+    return WriteHeader(type, count);
+  }
+  if (remaining() < 1) {
+    return pw::Status::ResourceExhausted();
+  }
+  buffer_[pos_++] = static_cast<std::byte>(
+      (static_cast<uint8_t>(type) << 5) | kIndefiniteInfo);
+  ++open_indefinite_;
+  return pw::OkStatus();
 }
 
 pw::Status Encoder::WriteNull(std::string_view key) {
   PW_TRY(WriteKey(key));
+  return WriteNull();
+}
+
+pw::Status Encoder::WriteBool(std::string_view key, bool value) {
+  PW_TRY(WriteKey(key));
+  return WriteBool(value);
+}
+
+pw::Status Encoder::WriteInt(std::string_view key, int64_t value) {
+  PW_TRY(WriteKey(key));
+  return WriteInt(value);
+}
+
+pw::Status Encoder::WriteUint(std::string_view key, uint64_t value) {
+  PW_TRY(WriteKey(key));
+  return WriteUint(value);
+}
+
+pw::Status Encoder::WriteDouble(std::string_view key, double value) {
+  PW_TRY(WriteKey(key));
+  return WriteDouble(value);
+}
+
+pw::Status Encoder::WriteFloat(std::string_view key, double value) {
+  PW_TRY(WriteKey(key));
+  return WriteFloat(value);
+}
+
+pw::Status Encoder::WriteInt16Array(std::string_view key,
+                                    pw::span<const int16_t> values) {
+  PW_TRY(WriteKey(key));
+  return WriteInt16Array(values);
+}
+
+pw::Status Encoder::WriteFloat32Array(std::string_view key,
+                                      pw::span<const float> values) {
+  PW_TRY(WriteKey(key));
+  return WriteFloat32Array(values);
+}
+
+pw::Status Encoder::WriteString(std::string_view key, std::string_view value) {
+  PW_TRY(WriteKey(key));
+  return WriteString(value);
+}
+
+pw::Status Encoder::WriteBytes(std::string_view key, pw::ConstByteSpan value) {
+  PW_TRY(WriteKey(key));
+  return WriteBytes(value);
+}
+
+pw::Status Encoder::WriteBytes(pw::ConstByteSpan value) {
+  PW_TRY(WriteHeader(MajorType::kByteString, value.size()));
+  return WriteRaw(value.data(), value.size());
+}
+
+pw::Status Encoder::WriteNull() {
   // null is simple value 22 (0xf6)
   if (remaining() < 1) {
     return pw::Status::ResourceExhausted();
@@ -27,8 +360,7 @@ pw::Status Encoder::WriteNull(std::string_view key) {
   return pw::OkStatus();
 }
 
-pw::Status Encoder::WriteBool(std::string_view key, bool value) {
-  PW_TRY(WriteKey(key));
+pw::Status Encoder::WriteBool(bool value) {
   if (remaining() < 1) {
     return pw::Status::ResourceExhausted();
   }
@@ -38,8 +370,7 @@ pw::Status Encoder::WriteBool(std::string_view key, bool value) {
   return pw::OkStatus();
 }
 
-pw::Status Encoder::WriteInt(std::string_view key, int64_t value) {
-  PW_TRY(WriteKey(key));
+pw::Status Encoder::WriteInt(int64_t value) {
   if (value >= 0) {
     return WriteHeader(MajorType::kUnsignedInt, static_cast<uint64_t>(value));
   }
@@ -47,127 +378,442 @@ pw::Status Encoder::WriteInt(std::string_view key, int64_t value) {
   return WriteHeader(MajorType::kNegativeInt, static_cast<uint64_t>(-1 - value));
 }
 
-pw::Status Encoder::WriteUint(std::string_view key, uint64_t value) {
-  PW_TRY(WriteKey(key));
+pw::Status Encoder::WriteUint(uint64_t value) {
   return WriteHeader(MajorType::kUnsignedInt, value);
 }
 
-pw::Status Encoder::WriteDouble(std::string_view key, double value) {
-  PW_TRY(WriteKey(key));
+pw::Status Encoder::WriteDouble(double value) {
   // Always use 8-byte float (0xfb)
   if (remaining() < 9) {
     return pw::Status::ResourceExhausted();
   }
-  buffer_[pos_++] = static_cast<std::byte>(0xfb);
+  pos_ += EncodeDouble(value, &buffer_[pos_]);
+  return pw::OkStatus();
+}
 
-  // Write IEEE 754 double in big-endian
-  uint64_t bits;
-  std::memcpy(&bits, &value, sizeof(bits));
-  for (int i = 7; i >= 0; --i) {
-    buffer_[pos_++] = static_cast<std::byte>((bits >> (i * 8)) & 0xff);
+pw::Status Encoder::WriteFloat(double value) {
+  std::array<std::byte, kMaxHeaderSize> encoded;
+  return WriteRaw(encoded.data(), EncodeFloat(value, encoded.data()));
+}
+
+pw::Status Encoder::WriteInt16Array(pw::span<const int16_t> values) {
+  PW_TRY(BeginTypedArray(TypedArrayTag::kInt16LittleEndian,
+                         values.size_bytes()));
+  for (int16_t value : values) {
+    Store(&buffer_[pos_], static_cast<uint16_t>(value), pw::endian::little);
+    pos_ += 2;
   }
   return pw::OkStatus();
 }
 
-pw::Status Encoder::WriteString(std::string_view key, std::string_view value) {
-  PW_TRY(WriteKey(key));
+pw::Status Encoder::WriteFloat32Array(pw::span<const float> values) {
+  PW_TRY(BeginTypedArray(TypedArrayTag::kFloat32LittleEndian,
+                         values.size_bytes()));
+  for (float value : values) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    Store(&buffer_[pos_], bits, pw::endian::little);
+    pos_ += 4;
+  }
+  return pw::OkStatus();
+}
+
+pw::Status Encoder::BeginTypedArray(TypedArrayTag tag, size_t size) {
+  PW_TRY(WriteHeader(MajorType::kTag, static_cast<uint8_t>(tag)));
+  PW_TRY(WriteHeader(MajorType::kByteString, size));
+  if (remaining() < size) {
+    return pw::Status::ResourceExhausted();
+  }
+  return pw::OkStatus();
+}
+
+pw::Status Encoder::WriteString(std::string_view value) {
   PW_TRY(WriteHeader(MajorType::kTextString, value.size()));
   return WriteRaw(value.data(), value.size());
 }
 
-pw::Status Encoder::WriteBytes(std::string_view key, pw::ConstByteSpan value) {
+pw::Status Encoder::WriteHeader(MajorType type, uint64_t argument) {
+  if (remaining() < HeaderSize(argument)) {
+    return pw::Status::ResourceExhausted();
+  }
+  pos_ += EncodeHeader(type, argument, &buffer_[pos_]);
+  return pw::OkStatus();
+}
+
+pw::Status Encoder::WriteKey(std::string_view key) {
+  PW_TRY(WriteHeader(MajorType::kTextString, key.size()));
+  return WriteRaw(key.data(), key.size());
+}
+
+pw::Status Encoder::WriteRaw(const void* data, size_t len) {
+  if (remaining() < len) {
+    return pw::Status::ResourceExhausted();
+  }
+  std::memcpy(buffer_.data() + pos_, data, len);
+  pos_ += len;
+  return pw::OkStatus();
+}
+
+// -- StreamEncoder Implementation --
+
+StreamEncoder::StreamEncoder(pw::stream::Writer& writer, pw::ByteSpan window)
+    : writer_(writer), window_(window) {}
+
+pw::Status StreamEncoder::BeginMap(size_t count) {
+  return BeginContainer(MajorType::kMap, count);
+}
+
+pw::Status StreamEncoder::BeginArray(size_t count) {
+  return BeginContainer(MajorType::kArray, count);
+}
+
+pw::Status StreamEncoder::BeginMap(std::string_view key, size_t count) {
+  PW_TRY(WriteKey(key));
+  return BeginMap(count);
+}
+
+pw::Status StreamEncoder::BeginArray(std::string_view key, size_t count) {
+  PW_TRY(WriteKey(key));
+  return BeginArray(count);
+}
+
+pw::Status StreamEncoder::End() {
+  if (open_indefinite_ == 0) {
+    return pw::Status::FailedPrecondition();
+  }
+  const auto brk = static_cast<std::byte>(kBreak);
+  PW_TRY(Put(&brk, 1));
+  --open_indefinite_;
+  return pw::OkStatus();
+}
+
+pw::Status StreamEncoder::WriteNull(std::string_view key) {
   PW_TRY(WriteKey(key));
+  return WriteNull();
+}
+
+pw::Status StreamEncoder::WriteBool(std::string_view key, bool value) {
+  PW_TRY(WriteKey(key));
+  return WriteBool(value);
+}
+
+pw::Status StreamEncoder::WriteInt(std::string_view key, int64_t value) {
+  PW_TRY(WriteKey(key));
+  return WriteInt(value);
+}
+
+pw::Status StreamEncoder::WriteUint(std::string_view key, uint64_t value) {
+  PW_TRY(WriteKey(key));
+  return WriteUint(value);
+}
+
+pw::Status StreamEncoder::WriteDouble(std::string_view key, double value) {
+  PW_TRY(WriteKey(key));
+  return WriteDouble(value);
+}
+
+pw::Status StreamEncoder::WriteFloat(std::string_view key, double value) {
+  PW_TRY(WriteKey(key));
+  return WriteFloat(value);
+}
+
+pw::Status StreamEncoder::WriteString(std::string_view key,
+                                      std::string_view value) {
+  PW_TRY(WriteKey(key));
+  return WriteString(value);
+}
+
+pw::Status StreamEncoder::WriteBytes(std::string_view key,
+                                     pw::ConstByteSpan value) {
+  PW_TRY(WriteKey(key));
+  return WriteBytes(value);
+}
+
+pw::Status StreamEncoder::WriteInt16Array(std::string_view key,
+                                          pw::span<const int16_t> values) {
+  PW_TRY(WriteKey(key));
+  return WriteInt16Array(values);
+}
+
+pw::Status StreamEncoder::WriteFloat32Array(std::string_view key,
+                                            pw::span<const float> values) {
+  PW_TRY(WriteKey(key));
+  return WriteFloat32Array(values);
+}
+
+pw::Status StreamEncoder::WriteNull() {
+  const auto null = static_cast<std::byte>(
+      0xe0 | static_cast<uint8_t>(SimpleValue::kNull));
+  return Put(&null, 1);
+}
+
+pw::Status StreamEncoder::WriteBool(bool value) {
+  const auto simple = value ? SimpleValue::kTrue : SimpleValue::kFalse;
+  const auto byte =
+      static_cast<std::byte>(0xe0 | static_cast<uint8_t>(simple));
+  return Put(&byte, 1);
+}
+
+pw::Status StreamEncoder::WriteInt(int64_t value) {
+  if (value >= 0) {
+    return WriteHeader(MajorType::kUnsignedInt, static_cast<uint64_t>(value));
+  }
+  return WriteHeader(MajorType::kNegativeInt,
+                     static_cast<uint64_t>(-1 - value));
+}
+
+pw::Status StreamEncoder::WriteUint(uint64_t value) {
+  return WriteHeader(MajorType::kUnsignedInt, value);
+}
+
+pw::Status StreamEncoder::WriteDouble(double value) {
+  std::array<std::byte, kMaxHeaderSize> encoded;
+  return Put(encoded.data(), EncodeDouble(value, encoded.data()));
+}
+
+pw::Status StreamEncoder::WriteFloat(double value) {
+  std::array<std::byte, kMaxHeaderSize> encoded;
+  return Put(encoded.data(), EncodeFloat(value, encoded.data()));
+}
+
+pw::Status StreamEncoder::WriteString(std::string_view value) {
+  PW_TRY(WriteHeader(MajorType::kTextString, value.size()));
+  return Put(value.data(), value.size());
+}
+
+pw::Status StreamEncoder::WriteBytes(pw::ConstByteSpan value) {
   PW_TRY(WriteHeader(MajorType::kByteString, value.size()));
-  return WriteRaw(value.data(), value.size());
+  return Put(value.data(), value.size());
 }
 
-pw::Status Encoder::WriteHeader(MajorType type, uint64_t argument) {
-  uint8_t major = static_cast<uint8_t>(type) << 5;
+pw::Status StreamEncoder::WriteInt16Array(pw::span<const int16_t> values) {
+  PW_TRY(WriteHeader(MajorType::kTag,
+                     static_cast<uint8_t>(TypedArrayTag::kInt16LittleEndian)));
+  PW_TRY(WriteHeader(MajorType::kByteString, values.size_bytes()));
+  for (int16_t value : values) {
+    std::array<std::byte, sizeof(int16_t)> packed;
+    Store(packed.data(), static_cast<uint16_t>(value), pw::endian::little);
+    PW_TRY(Put(packed.data(), packed.size()));
+  }
+  return pw::OkStatus();
+}
 
-  if (argument < 24) {
-    // Encode in initial byte
-    if (remaining() < 1) {
-      return pw::Status::ResourceExhausted();
+pw::Status StreamEncoder::WriteFloat32Array(pw::span<const float> values) {
+  PW_TRY(WriteHeader(
+      MajorType::kTag,
+      static_cast<uint8_t>(TypedArrayTag::kFloat32LittleEndian)));
+  PW_TRY(WriteHeader(MajorType::kByteString, values.size_bytes()));
+  for (float value : values) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    std::array<std::byte, sizeof(float)> packed;
+    Store(packed.data(), bits, pw::endian::little);
+    PW_TRY(Put(packed.data(), packed.size()));
+  }
+  return pw::OkStatus();
+}
+
+pw::Status StreamEncoder::Flush() {
+  if (pos_ == 0) {
+    return pw::OkStatus();
+  }
+  PW_TRY(writer_.Write(window_.first(pos_)));
+  flushed_ += pos_;
+  pos_ = 0;
+  return pw::OkStatus();
+}
+
+pw::Status StreamEncoder::WriteHeader(MajorType type, uint64_t argument) {
+  std::array<std::byte, kMaxHeaderSize> header;
+  return Put(header.data(), EncodeHeader(type, argument, header.data()));
+}
+
+pw::Status StreamEncoder::WriteKey(std::string_view key) {
+  return WriteString(key);
+}
+
+pw::Status StreamEncoder::BeginContainer(MajorType type, size_t count) {
+  if (count != kIndefiniteLength) {
+    return WriteHeader(type, count);
+  }
+  const auto initial = static_cast<std::byte>(
+      (static_cast<uint8_t>(type) << 5) | kIndefiniteInfo);
+  PW_TRY(Put(&initial, 1));
+  ++open_indefinite_;
+  return pw::OkStatus();
+}
+
+pw::Status StreamEncoder::Put(const void* data, size_t len) {
+  if (len == 0) {
+    return pw::OkStatus();
+  }
+  if (len > window_.size() - pos_) {
+    PW_TRY(Flush());
+  }
+  if (len > window_.size()) {
+    // Larger than the window - write straight through
+    PW_TRY(writer_.Write(
+        pw::ConstByteSpan(static_cast<const std::byte*>(data), len)));
+    flushed_ += len;
+    return pw::OkStatus();
+  }
+  std::memcpy(window_.data() + pos_, data, len);
+  pos_ += len;
+  return pw::OkStatus();
+}
+
+// -- Decoder Implementation --
+
+Decoder::Decoder(pw::ConstByteSpan data) : data_(data) {}
+
+pw::Status Decoder::Validate() {
+  // Open containers: items still expected, or indefinite until a break
+  struct Level {
+    uint64_t remaining;
+    bool indefinite;
+    bool map;
+    bool chunks;  // Indefinite string: only definite chunks of chunk_type
+    MajorType chunk_type;
+    uint64_t items;
+  };
+  std::array<Level, kMaxValidationDepth> stack;
+  size_t depth = 0;
+
+  // Count one finished item in the enclosing levels
+  auto complete = [&]() {
+    while (depth > 0) {
+      Level& level = stack[depth - 1];
+      ++level.items;
+      if (level.indefinite || --level.remaining > 0) {
+        return;
+      }
+      --depth;  // Container complete - it is an item of its parent
     }
-    buffer_[pos_++] = static_cast<std::byte>(major | argument);
-  } else if (argument <= 0xff) {
-    // 1-byte argument
-    if (remaining() < 2) {
-      return pw::Status::ResourceExhausted();
+  };
+  auto push = [&](Level level) {
+    if (depth >= stack.size()) {
+      return false;
     }
-    buffer_[pos_++] = static_cast<std::byte>(major | 24);
-    buffer_[pos_++] = static_cast<std::byte>(argument);
-  } else if (argument <= 0xffff) {
-    // 2-byte argument
-    if (remaining() < 3) {
-      return pw::Status::ResourceExhausted();
+    stack[depth++] = level;
+    return true;
+  };
+
+  size_t pos = pos_;
+  while (pos < data_.size() || depth > 0) {
+    if (pos >= data_.size()) {
+      return pw::Status::DataLoss();  // Unterminated container
     }
-    buffer_[pos_++] = static_cast<std::byte>(major | 25);
-    buffer_[pos_++] = static_cast<std::byte>(argument >> 8);
-    buffer_[pos_++] = static_cast<std::byte>(argument);
-  } else if (argument <= 0xffffffff) {
-    // 4-byte argument
-    if (remaining() < 5) {
-      return pw::Status::ResourceExhausted();
+    if (static_cast<uint8_t>(data_[pos]) == kBreak) {
+      if (depth == 0 || !stack[depth - 1].indefinite ||
+          (stack[depth - 1].map && stack[depth - 1].items % 2 != 0)) {
+        return pw::Status::DataLoss();
+      }
+      ++pos;
+      --depth;
+      complete();
+      continue;
+    }
+
+    PW_TRY_ASSIGN(const Header header, ParseHeader(data_, pos));
+    pos += header.size;
+    const bool indefinite = header.argument == kIndefiniteArgument &&
+                            AllowsIndefinite(header.type);
+    if (depth > 0 && stack[depth - 1].chunks &&
+        (header.type != stack[depth - 1].chunk_type || indefinite)) {
+      return pw::Status::DataLoss();
+    }
+
+    bool pushed = true;
+    switch (header.type) {
+      case MajorType::kByteString:
+      case MajorType::kTextString:
+        if (indefinite) {
+          pushed = push({0, true, false, true, header.type, 0});
+          break;
+        }
+        if (header.argument > data_.size() - pos) {
+          return pw::Status::DataLoss();
+        }
+        pos += static_cast<size_t>(header.argument);
+        complete();
+        break;
+
+      case MajorType::kArray:
+      case MajorType::kMap: {
+        const bool map = header.type == MajorType::kMap;
+        if (indefinite) {
+          pushed = push({0, true, map, false, header.type, 0});
+          break;
+        }
+        // Every item takes at least one byte
+        const uint64_t items = header.argument * (map ? 2 : 1);
+        if (header.argument > data_.size() - pos || items > data_.size()) {
+          return pw::Status::DataLoss();
+        }
+        if (items == 0) {
+          complete();
+        } else {
+          pushed = push({items, false, map, false, header.type, 0});
+        }
+        break;
+      }
+
+      case MajorType::kTag:
+        pushed = push({1, false, false, false, header.type, 0});
+        break;
+
+      default:
+        complete();
+        break;
     }
-    buffer_[pos_++] = static_cast<std::byte>(major | 26);
-    buffer_[pos_++] = static_cast<std::byte>(argument >> 24);
-    buffer_[pos_++] = static_cast<std::byte>(argument >> 16);
-    buffer_[pos_++] = static_cast<std::byte>(argument >> 8);
-    buffer_[pos_++] = static_cast<std::byte>(argument);
-  } else {
-    // 8-byte argument
-    if (remaining() < 9) {
+    if (!pushed) {
       return pw::Status::ResourceExhausted();
     }
-    buffer_[pos_++] = static_cast<std::byte>(major | 27);
-    for (int i = 7; i >= 0; --i) {
-      buffer_[pos_++] = static_cast<std::byte>(argument >> (i * 8));
-    }
   }
+
+  validated_ = true;
   return pw::OkStatus();
 }
 
-pw::Status Encoder::WriteKey(std::string_view key) {
-  PW_TRY(WriteHeader(MajorType::kTextString, key.size()));
-  return WriteRaw(key.data(), key.size());
+Decoder Decoder::At(size_t offset) const {
+  Decoder decoder(data_.subspan(offset));
+  decoder.validated_ = validated_;
+  return decoder;
 }
 
-pw::Status Encoder::WriteRaw(const void* data, size_t len) {
-  if (remaining() < len) {
-    return pw::Status::ResourceExhausted();
-  }
-  std::memcpy(buffer_.data() + pos_, data, len);
-  pos_ += len;
-  return pw::OkStatus();
+pw::Result<size_t> Decoder::ReadMapHeader() {
+  return ReadContainerHeader(MajorType::kMap);
 }
 
-// -- Decoder Implementation --
+pw::Result<size_t> Decoder::ReadArrayHeader() {
+  return ReadContainerHeader(MajorType::kArray);
+}
 
-Decoder::Decoder(pw::ConstByteSpan data) : data_(data) {}
+bool Decoder::AtBreak() const {
+  return pos_ < data_.size() && static_cast<uint8_t>(data_[pos_]) == kBreak;
+}
 
-pw::Result<size_t> Decoder::ReadMapHeader() {
-  auto result = ReadHeader(MajorType::kMap);
-  if (!result.ok()) {
-    return result.status();
+pw::Status Decoder::ReadBreak() {
+  if (!AtBreak()) {
+    return pw::Status::DataLoss();
   }
-  return static_cast<size_t>(result.value());
+  ++pos_;
+  return pw::OkStatus();
 }
 
 pw::Result<std::string_view> Decoder::ReadKey(pw::ByteSpan key_buffer) {
-  auto len_result = ReadHeader(MajorType::kTextString);
-  if (!len_result.ok()) {
-    return len_result.status();
-  }
-  size_t len = static_cast<size_t>(len_result.value());
-
-  if (len > key_buffer.size()) {
+  PW_TRY_ASSIGN(const std::string_view key, ReadKeyView());
+  if (key.size() > key_buffer.size()) {
     return pw::Status::ResourceExhausted();
   }
-
-  PW_TRY(ReadRaw(key_buffer.data(), len));
+  std::memcpy(key_buffer.data(), key.data(), key.size());
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-  return std::string_view(reinterpret_cast<const char*>(key_buffer.data()), len);
+  return std::string_view(reinterpret_cast<const char*>(key_buffer.data()),
+                          key.size());
+}
+
+pw::Result<std::string_view> Decoder::ReadKeyView() {
+  return ReadStringView();
 }
 
 pw::Result<MajorType> Decoder::PeekType() const {
@@ -248,59 +894,81 @@ pw::Result<double> Decoder::ReadDouble() {
     return static_cast<double>(int_result.value());
   }
 
-  // Must be float type
-  if (initial != 0xfb) {  // 8-byte float
-    // Could support 0xf9 (half), 0xfa (float), but Particle uses 0xfb
+  if (!IsFloat(initial)) {
     return pw::Status::DataLoss();
   }
+  // ReadHeaderAny() returns the float's bits as the argument
+  PW_TRY_ASSIGN(const auto header, ReadHeaderAny());
+  return DecodeFloat(initial & 0x1f, header.second);
+}
 
-  ++pos_;  // Consume the 0xfb byte
-
-  if (data_.size() - pos_ < 8) {
-    return pw::Status::DataLoss();
+pw::Result<size_t> Decoder::ReadInt16Array(pw::span<int16_t> values) {
+  PW_TRY_ASSIGN(const auto array,
+                ReadTypedArray(TypedArrayTag::kInt16BigEndian,
+                               TypedArrayTag::kInt16LittleEndian,
+                               sizeof(int16_t), values.size()));
+  const auto [packed, big_endian] = array;
+  const size_t count = packed.size() / sizeof(int16_t);
+  for (size_t i = 0; i < count; ++i) {
+    values[i] = static_cast<int16_t>(pw::bytes::ReadInOrder<uint16_t>(
+        big_endian ? pw::endian::big : pw::endian::little,
+        &packed[i * sizeof(int16_t)]));
   }
+  return count;
+}
 
-  uint64_t bits = 0;
-  for (int i = 0; i < 8; ++i) {
-    bits = (bits << 8) | static_cast<uint8_t>(data_[pos_++]);
+pw::Result<size_t> Decoder::ReadFloat32Array(pw::span<float> values) {
+  PW_TRY_ASSIGN(const auto array,
+                ReadTypedArray(TypedArrayTag::kFloat32BigEndian,
+                               TypedArrayTag::kFloat32LittleEndian,
+                               sizeof(float), values.size()));
+  const auto [packed, big_endian] = array;
+  const size_t count = packed.size() / sizeof(float);
+  for (size_t i = 0; i < count; ++i) {
+    const auto bits = pw::bytes::ReadInOrder<uint32_t>(
+        big_endian ? pw::endian::big : pw::endian::little,
+        &packed[i * sizeof(float)]);
+    std::memcpy(&values[i], &bits, sizeof(float));
   }
-
-  double value;
-  std::memcpy(&value, &bits, sizeof(value));
-  return value;
+  return count;
 }
 
 pw::Result<size_t> Decoder::ReadString(pw::ByteSpan buffer) {
-  auto len_result = ReadHeader(MajorType::kTextString);
-  if (!len_result.ok()) {
-    return len_result.status();
-  }
-  size_t len = static_cast<size_t>(len_result.value());
-
-  if (len > buffer.size()) {
+  PW_TRY_ASSIGN(const pw::ConstByteSpan content,
+                ReadStringContent(MajorType::kTextString));
+  if (content.size() > buffer.size()) {
     return pw::Status::ResourceExhausted();
   }
-
-  PW_TRY(ReadRaw(buffer.data(), len));
-  return len;
+  std::memcpy(buffer.data(), content.data(), content.size());
+  return content.size();
 }
 
 pw::Result<size_t> Decoder::ReadBytes(pw::ByteSpan buffer) {
-  auto len_result = ReadHeader(MajorType::kByteString);
-  if (!len_result.ok()) {
-    return len_result.status();
-  }
-  size_t len = static_cast<size_t>(len_result.value());
-
-  if (len > buffer.size()) {
+  PW_TRY_ASSIGN(const pw::ConstByteSpan content,
+                ReadStringContent(MajorType::kByteString));
+  if (content.size() > buffer.size()) {
     return pw::Status::ResourceExhausted();
   }
+  std::memcpy(buffer.data(), content.data(), content.size());
+  return content.size();
+}
+
+pw::Result<std::string_view> Decoder::ReadStringView() {
+  PW_TRY_ASSIGN(const pw::ConstByteSpan content,
+                ReadStringContent(MajorType::kTextString));
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return std::string_view(reinterpret_cast<const char*>(content.data()),
+                          content.size());
+}
 
-  PW_TRY(ReadRaw(buffer.data(), len));
-  return len;
+pw::Result<pw::ConstByteSpan> Decoder::ReadBytesView() {
+  return ReadStringContent(MajorType::kByteString);
 }
 
 pw::Status Decoder::SkipValue() {
+  if (validated_) {
+    return SkipValidated();
+  }
   auto result = ReadHeaderAny();
   if (!result.ok()) {
     return result.status();
@@ -308,6 +976,14 @@ pw::Status Decoder::SkipValue() {
 
   auto [type, argument] = result.value();
 
+  if (argument == kIndefiniteArgument && AllowsIndefinite(type)) {
+    // Entries (or string chunks) until the break
+    while (!AtBreak()) {
+      PW_TRY(SkipValue());
+    }
+    return ReadBreak();
+  }
+
   switch (type) {
     case MajorType::kUnsignedInt:
     case MajorType::kNegativeInt:
@@ -338,47 +1014,10 @@ pw::Status Decoder::SkipValue() {
       }
       return pw::OkStatus();
 
-    case MajorType::kSimpleFloat: {
-      // Handle special simple values and floats
-      // argument here is the additional info (5 bits)
-      if (argument <= 23) {
-        // Simple value in initial byte, already consumed
-        return pw::OkStatus();
-      }
-      if (argument == 24) {
-        // Simple value in next byte
-        if (pos_ >= data_.size()) {
-          return pw::Status::DataLoss();
-        }
-        ++pos_;
-        return pw::OkStatus();
-      }
-      if (argument == 25) {
-        // Half-precision float (2 bytes)
-        if (data_.size() - pos_ < 2) {
-          return pw::Status::DataLoss();
-        }
-        pos_ += 2;
-        return pw::OkStatus();
-      }
-      if (argument == 26) {
-        // Single-precision float (4 bytes)
-        if (data_.size() - pos_ < 4) {
-          return pw::Status::DataLoss();
-        }
-        pos_ += 4;
-        return pw::OkStatus();
-      }
-      if (argument == 27) {
-        // Double-precision float (8 bytes)
-        if (data_.size() - pos_ < 8) {
-          return pw::Status::DataLoss();
-        }
-        pos_ += 8;
-        return pw::OkStatus();
-      }
-      return pw::Status::DataLoss();  // Invalid simple value
-    }
+    case MajorType::kSimpleFloat:
+      // ReadHeaderAny() already consumed the payload of simple values and
+      // floats, as it does for integer arguments
+      return pw::OkStatus();
 
     case MajorType::kTag:
       // Skip the tag and its content
@@ -388,6 +1027,44 @@ pw::Status Decoder::SkipValue() {
   return pw::Status::DataLoss();
 }
 
+pw::Status Decoder::SkipValidated() {
+  if (pos_ >= data_.size() || static_cast<uint8_t>(data_[pos_]) == kBreak) {
+    return pw::Status::DataLoss();
+  }
+  uint64_t pending = 1;
+  while (pending > 0) {
+    const Header header = ParseValidatedHeader(data_, pos_);
+    pos_ += header.size;
+    --pending;
+    if (header.argument == kIndefiniteArgument &&
+        AllowsIndefinite(header.type)) {
+      while (!AtBreak()) {
+        PW_TRY(SkipValidated());
+      }
+      ++pos_;
+      continue;
+    }
+    switch (header.type) {
+      case MajorType::kByteString:
+      case MajorType::kTextString:
+        pos_ += static_cast<size_t>(header.argument);
+        break;
+      case MajorType::kArray:
+        pending += header.argument;
+        break;
+      case MajorType::kMap:
+        pending += header.argument * 2;
+        break;
+      case MajorType::kTag:
+        pending += 1;
+        break;
+      default:
+        break;  // Argument was the whole payload
+    }
+  }
+  return pw::OkStatus();
+}
+
 pw::Result<uint64_t> Decoder::ReadHeader(MajorType expected_type) {
   auto result = ReadHeaderAny();
   if (!result.ok()) {
@@ -400,61 +1077,61 @@ pw::Result<uint64_t> Decoder::ReadHeader(MajorType expected_type) {
 }
 
 pw::Result<std::pair<MajorType, uint64_t>> Decoder::ReadHeaderAny() {
-  if (pos_ >= data_.size()) {
-    return pw::Status::DataLoss();
-  }
-
-  uint8_t initial = static_cast<uint8_t>(data_[pos_++]);
-  MajorType type = static_cast<MajorType>(initial >> 5);
-  uint8_t additional = initial & 0x1f;
-
-  uint64_t argument;
-
-  if (additional < 24) {
-    argument = additional;
-  } else if (additional == 24) {
-    if (pos_ >= data_.size()) {
-      return pw::Status::DataLoss();
-    }
-    argument = static_cast<uint8_t>(data_[pos_++]);
-  } else if (additional == 25) {
-    if (data_.size() - pos_ < 2) {
-      return pw::Status::DataLoss();
-    }
-    argument = (static_cast<uint64_t>(static_cast<uint8_t>(data_[pos_])) << 8) |
-               static_cast<uint64_t>(static_cast<uint8_t>(data_[pos_ + 1]));
-    pos_ += 2;
-  } else if (additional == 26) {
-    if (data_.size() - pos_ < 4) {
-      return pw::Status::DataLoss();
-    }
-    argument = 0;
-    for (int i = 0; i < 4; ++i) {
-      argument = (argument << 8) | static_cast<uint8_t>(data_[pos_++]);
-    }
-  } else if (additional == 27) {
-    if (data_.size() - pos_ < 8) {
+  if (validated_) {
+    if (pos_ >= data_.size() ||
+        static_cast<uint8_t>(data_[pos_]) == kBreak) {
       return pw::Status::DataLoss();
     }
-    argument = 0;
-    for (int i = 0; i < 8; ++i) {
-      argument = (argument << 8) | static_cast<uint8_t>(data_[pos_++]);
-    }
-  } else {
-    // Indefinite length (28-30) or break (31) - not supported
-    return pw::Status::Unimplemented();
+    const Header header = ParseValidatedHeader(data_, pos_);
+    pos_ += header.size;
+    return std::make_pair(header.type, header.argument);
   }
+  PW_TRY_ASSIGN(const Header header, ParseHeader(data_, pos_));
+  pos_ += header.size;
+  return std::make_pair(header.type, header.argument);
+}
 
-  return std::make_pair(type, argument);
+pw::Result<size_t> Decoder::ReadContainerHeader(MajorType type) {
+  PW_TRY_ASSIGN(const uint64_t count, ReadHeader(type));
+  if (count == kIndefiniteArgument) {
+    return kIndefiniteLength;
+  }
+  return static_cast<size_t>(count);
 }
 
-pw::Status Decoder::ReadRaw(void* data, size_t len) {
-  if (data_.size() - pos_ < len) {
+pw::Result<pw::ConstByteSpan> Decoder::ReadStringContent(MajorType type) {
+  PW_TRY_ASSIGN(const uint64_t len, ReadHeader(type));
+  if (len == kIndefiniteArgument) {
+    return pw::Status::Unimplemented();  // Chunked strings are only skipped
+  }
+  if (!validated_ && len > data_.size() - pos_) {
     return pw::Status::DataLoss();
   }
-  std::memcpy(data, data_.data() + pos_, len);
-  pos_ += len;
-  return pw::OkStatus();
+  const pw::ConstByteSpan content =
+      data_.subspan(pos_, static_cast<size_t>(len));
+  pos_ += content.size();
+  return content;
+}
+
+pw::Result<std::pair<pw::ConstByteSpan, bool>> Decoder::ReadTypedArray(
+    TypedArrayTag big_endian,
+    TypedArrayTag little_endian,
+    size_t element_size,
+    size_t capacity) {
+  PW_TRY_ASSIGN(const uint64_t tag, ReadHeader(MajorType::kTag));
+  if (tag != static_cast<uint8_t>(big_endian) &&
+      tag != static_cast<uint8_t>(little_endian)) {
+    return pw::Status::DataLoss();
+  }
+  PW_TRY_ASSIGN(const pw::ConstByteSpan packed,
+                ReadStringContent(MajorType::kByteString));
+  if (packed.size() % element_size != 0) {
+    return pw::Status::DataLoss();
+  }
+  if (packed.size() / element_size > capacity) {
+    return pw::Status::ResourceExhausted();
+  }
+  return std::make_pair(packed, tag == static_cast<uint8_t>(big_endian));
 }
 
 pw::Result<uint8_t> Decoder::PeekByte() const {
@@ -469,53 +1146,331 @@ pw::Result<size_t> Decoder::PeekStringLength() const {
     return pw::Status::DataLoss();
   }
 
-  uint8_t initial = static_cast<uint8_t>(data_[pos_]);
-  MajorType type = static_cast<MajorType>(initial >> 5);
-
   // Must be byte string or text string
+  const MajorType type =
+      static_cast<MajorType>(static_cast<uint8_t>(data_[pos_]) >> 5);
   if (type != MajorType::kByteString && type != MajorType::kTextString) {
     return pw::Status::FailedPrecondition();
   }
 
-  uint8_t additional = initial & 0x1f;
-  size_t header_pos = pos_ + 1;
+  PW_TRY_ASSIGN(const Header header, ParseHeader(data_, pos_));
+  if (header.argument == kIndefiniteArgument) {
+    // Indefinite length not supported
+    return pw::Status::Unimplemented();
+  }
+  return static_cast<size_t>(header.argument);
+}
 
-  uint64_t length;
-  if (additional < 24) {
-    length = additional;
-  } else if (additional == 24) {
-    if (header_pos >= data_.size()) {
-      return pw::Status::DataLoss();
-    }
-    length = static_cast<uint8_t>(data_[header_pos]);
-  } else if (additional == 25) {
-    if (data_.size() - header_pos < 2) {
-      return pw::Status::DataLoss();
+// -- StreamDecoder Implementation --
+
+StreamDecoder::StreamDecoder(pw::stream::Reader& reader, pw::ByteSpan window)
+    : reader_(reader), window_(window) {}
+
+pw::Result<size_t> StreamDecoder::ReadMapHeader() {
+  return ReadContainerHeader(MajorType::kMap);
+}
+
+pw::Result<size_t> StreamDecoder::ReadArrayHeader() {
+  return ReadContainerHeader(MajorType::kArray);
+}
+
+bool StreamDecoder::AtBreak() {
+  auto byte = PeekByte();
+  return byte.ok() && byte.value() == kBreak;
+}
+
+pw::Status StreamDecoder::ReadBreak() {
+  if (!AtBreak()) {
+    return pw::Status::DataLoss();
+  }
+  ++pos_;
+  return pw::OkStatus();
+}
+
+pw::Result<std::string_view> StreamDecoder::ReadKey(pw::ByteSpan key_buffer) {
+  PW_TRY_ASSIGN(const size_t len,
+                ReadStringContent(MajorType::kTextString, key_buffer));
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return std::string_view(reinterpret_cast<const char*>(key_buffer.data()), len);
+}
+
+pw::Result<MajorType> StreamDecoder::PeekType() {
+  PW_TRY_ASSIGN(const uint8_t byte, PeekByte());
+  return static_cast<MajorType>(byte >> 5);
+}
+
+pw::Result<bool> StreamDecoder::ReadBool() {
+  PW_TRY_ASSIGN(const uint8_t byte, PeekByte());
+  if (byte != 0xf4 && byte != 0xf5) {
+    return pw::Status::DataLoss();  // Type mismatch
+  }
+  ++pos_;
+  return byte == 0xf5;
+}
+
+pw::Result<int64_t> StreamDecoder::ReadInt() {
+  PW_TRY_ASSIGN(const auto header, ReadHeaderAny());
+  const auto [type, value] = header;
+  if (type != MajorType::kUnsignedInt && type != MajorType::kNegativeInt) {
+    return pw::Status::DataLoss();  // Type mismatch
+  }
+  if (value > static_cast<uint64_t>(INT64_MAX)) {
+    return pw::Status::OutOfRange();
+  }
+  return type == MajorType::kUnsignedInt ? static_cast<int64_t>(value)
+                                         : -1 - static_cast<int64_t>(value);
+}
+
+pw::Result<uint64_t> StreamDecoder::ReadUint() {
+  return ReadHeader(MajorType::kUnsignedInt);
+}
+
+pw::Result<double> StreamDecoder::ReadDouble() {
+  PW_TRY_ASSIGN(const uint8_t initial, PeekByte());
+  const MajorType type = static_cast<MajorType>(initial >> 5);
+  if (type == MajorType::kUnsignedInt || type == MajorType::kNegativeInt) {
+    PW_TRY_ASSIGN(const int64_t value, ReadInt());
+    return static_cast<double>(value);
+  }
+  if (!IsFloat(initial)) {
+    return pw::Status::DataLoss();
+  }
+  PW_TRY_ASSIGN(const auto header, ReadHeaderAny());
+  return DecodeFloat(initial & 0x1f, header.second);
+}
+
+pw::Result<size_t> StreamDecoder::ReadString(pw::ByteSpan buffer) {
+  return ReadStringContent(MajorType::kTextString, buffer);
+}
+
+pw::Result<size_t> StreamDecoder::ReadBytes(pw::ByteSpan buffer) {
+  return ReadStringContent(MajorType::kByteString, buffer);
+}
+
+pw::Status StreamDecoder::SkipValue() {
+  PW_TRY_ASSIGN(const auto header, ReadHeaderAny());
+  const auto [type, argument] = header;
+
+  if (argument == kIndefiniteArgument && AllowsIndefinite(type)) {
+    while (!AtBreak()) {
+      PW_TRY(SkipValue());
     }
-    length = (static_cast<uint64_t>(static_cast<uint8_t>(data_[header_pos])) << 8) |
-             static_cast<uint64_t>(static_cast<uint8_t>(data_[header_pos + 1]));
-  } else if (additional == 26) {
-    if (data_.size() - header_pos < 4) {
-      return pw::Status::DataLoss();
+    return ReadBreak();
+  }
+
+  switch (type) {
+    case MajorType::kUnsignedInt:
+    case MajorType::kNegativeInt:
+      return pw::OkStatus();
+
+    case MajorType::kByteString:
+    case MajorType::kTextString:
+      return Skip(argument);
+
+    case MajorType::kArray:
+      for (uint64_t i = 0; i < argument; ++i) {
+        PW_TRY(SkipValue());
+      }
+      return pw::OkStatus();
+
+    case MajorType::kMap:
+      for (uint64_t i = 0; i < argument; ++i) {
+        PW_TRY(SkipValue());  // key
+        PW_TRY(SkipValue());  // value
+      }
+      return pw::OkStatus();
+
+    case MajorType::kSimpleFloat:
+      // ReadHeaderAny() already consumed the payload of simple values and
+      // floats, as it does for integer arguments
+      return pw::OkStatus();
+
+    case MajorType::kTag:
+      return SkipValue();
+  }
+  return pw::Status::DataLoss();
+}
+
+pw::Status StreamDecoder::Fill() {
+  if (pos_ < end_) {
+    return pw::OkStatus();
+  }
+  consumed_ += end_;
+  pos_ = 0;
+  end_ = 0;
+  auto result = reader_.Read(window_);
+  if (!result.ok() || result.value().empty()) {
+    return pw::Status::DataLoss();
+  }
+  end_ = result.value().size();
+  return pw::OkStatus();
+}
+
+pw::Result<uint8_t> StreamDecoder::PeekByte() {
+  PW_TRY(Fill());
+  return static_cast<uint8_t>(window_[pos_]);
+}
+
+pw::Result<uint64_t> StreamDecoder::ReadHeader(MajorType expected_type) {
+  PW_TRY_ASSIGN(const auto header, ReadHeaderAny());
+  if (header.first != expected_type) {
+    return pw::Status::DataLoss();  // Type mismatch
+  }
+  return header.second;
+}
+
+pw::Result<std::pair<MajorType, uint64_t>> StreamDecoder::ReadHeaderAny() {
+  PW_TRY(Fill());
+  auto parsed = ParseHeader(window_.first(end_), pos_);
+  if (parsed.ok()) {
+    pos_ += parsed.value().size;
+    return std::make_pair(parsed.value().type, parsed.value().argument);
+  }
+  if (parsed.status() != pw::Status::DataLoss()) {
+    return parsed.status();
+  }
+
+  // The header continues past the end of the window
+  PW_TRY_ASSIGN(const uint8_t initial, PeekByte());
+  ++pos_;
+  const MajorType type = static_cast<MajorType>(initial >> 5);
+  const uint8_t additional = initial & 0x1f;
+
+  if (additional < 24) {
+    return std::make_pair(type, static_cast<uint64_t>(additional));
+  }
+  if (additional == kIndefiniteInfo && AllowsIndefinite(type)) {
+    return std::make_pair(type, kIndefiniteArgument);
+  }
+  if (additional > 27) {
+    // Reserved (28-30) or a break outside an indefinite-length item
+    return pw::Status::Unimplemented();
+  }
+  // 24..27 are followed by a 1, 2, 4 or 8 byte big-endian argument
+  const size_t len = size_t{1} << (additional - 24);
+  std::array<std::byte, 8> raw;
+  PW_TRY(ReadRaw(raw.data(), len));
+  return std::make_pair(type, LoadArgument(raw.data(), len));
+}
+
+pw::Result<size_t> StreamDecoder::ReadContainerHeader(MajorType type) {
+  PW_TRY_ASSIGN(const uint64_t count, ReadHeader(type));
+  if (count == kIndefiniteArgument) {
+    return kIndefiniteLength;
+  }
+  return static_cast<size_t>(count);
+}
+
+pw::Result<size_t> StreamDecoder::ReadStringContent(MajorType type,
+                                                    pw::ByteSpan buffer) {
+  PW_TRY_ASSIGN(const uint64_t len, ReadHeader(type));
+  if (len == kIndefiniteArgument) {
+    return pw::Status::Unimplemented();  // Chunked strings are only skipped
+  }
+  if (len > buffer.size()) {
+    return pw::Status::ResourceExhausted();
+  }
+  PW_TRY(ReadRaw(buffer.data(), static_cast<size_t>(len)));
+  return static_cast<size_t>(len);
+}
+
+pw::Status StreamDecoder::ReadRaw(void* data, size_t len) {
+  auto* out = static_cast<std::byte*>(data);
+  while (len > 0) {
+    PW_TRY(Fill());
+    const size_t chunk = std::min(len, end_ - pos_);
+    std::memcpy(out, window_.data() + pos_, chunk);
+    out += chunk;
+    pos_ += chunk;
+    len -= chunk;
+  }
+  return pw::OkStatus();
+}
+
+pw::Status StreamDecoder::Skip(uint64_t len) {
+  while (len > 0) {
+    PW_TRY(Fill());
+    const size_t chunk =
+        static_cast<size_t>(std::min<uint64_t>(len, end_ - pos_));
+    pos_ += chunk;
+    len -= chunk;
+  }
+  return pw::OkStatus();
+}
+
+// -- MapIndex Implementation --
+
+pw::Status MapIndex::Build(pw::ConstByteSpan data) {
+  data_ = data;
+  count_ = 0;
+  if (slots_.empty()) {
+    return pw::Status::ResourceExhausted();
+  }
+  for (MapIndexEntry& slot : slots_) {
+    slot.value_offset = 0;
+  }
+
+  Decoder decoder(data);
+  PW_TRY_ASSIGN(const size_t count, decoder.ReadMapHeader());
+  for (size_t i = 0; count == kIndefiniteLength || i < count; ++i) {
+    if (count == kIndefiniteLength && decoder.AtBreak()) {
+      break;
     }
-    length = 0;
-    for (int i = 0; i < 4; ++i) {
-      length = (length << 8) | static_cast<uint8_t>(data_[header_pos + i]);
+    PW_TRY_ASSIGN(const std::string_view key, decoder.ReadKeyView());
+    const uint32_t hash = HashKey(key);
+    const size_t value_offset = decoder.position();
+
+    size_t slot = hash % slots_.size();
+    while (slots_[slot].value_offset != 0 &&
+           !(slots_[slot].key_hash == hash && KeyAt(slots_[slot]) == key)) {
+      slot = (slot + 1) % slots_.size();
     }
-  } else if (additional == 27) {
-    if (data_.size() - header_pos < 8) {
-      return pw::Status::DataLoss();
+    if (slots_[slot].value_offset == 0) {
+      // Keep one slot free so lookups of missing keys terminate
+      if (count_ + 1 >= slots_.size()) {
+        count_ = 0;
+        return pw::Status::ResourceExhausted();
+      }
+      slots_[slot] = MapIndexEntry{
+          .key_hash = hash,
+          .key_offset = static_cast<uint32_t>(value_offset - key.size()),
+          .value_offset = static_cast<uint32_t>(value_offset),
+          .key_size = static_cast<uint32_t>(key.size()),
+      };
+      ++count_;
     }
-    length = 0;
-    for (int i = 0; i < 8; ++i) {
-      length = (length << 8) | static_cast<uint8_t>(data_[header_pos + i]);
+    PW_TRY(decoder.SkipValue());
+  }
+  return pw::OkStatus();
+}
+
+pw::Result<Decoder> MapIndex::Find(std::string_view key) const {
+  const MapIndexEntry* entry = Lookup(key);
+  if (entry == nullptr) {
+    return pw::Status::NotFound();
+  }
+  return Decoder(data_.subspan(entry->value_offset));
+}
+
+const MapIndexEntry* MapIndex::Lookup(std::string_view key) const {
+  if (count_ == 0) {
+    return nullptr;
+  }
+  const uint32_t hash = HashKey(key);
+  for (size_t slot = hash % slots_.size(); slots_[slot].value_offset != 0;
+       slot = (slot + 1) % slots_.size()) {
+    if (slots_[slot].key_hash == hash && KeyAt(slots_[slot]) == key) {
+      return &slots_[slot];
     }
-  } else {
-    // Indefinite length not supported
-    return pw::Status::Unimplemented();
   }
+  return nullptr;
+}
 
-  return static_cast<size_t>(length);
+std::string_view MapIndex::KeyAt(const MapIndexEntry& entry) const {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return std::string_view(
+      reinterpret_cast<const char*>(data_.data()) + entry.key_offset,
+      entry.key_size);
 }
 
 }  // namespace pb::cloud::cbor
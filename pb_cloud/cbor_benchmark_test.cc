@@ -0,0 +1,160 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+/// @file cbor_benchmark_test.cc
+/// @brief Host encode/decode throughput for cbor::Encoder and Decoder.
+///
+/// Each test checks the round trip and logs the average time per document,
+/// for comparing changes to the header and float paths. Timings are not
+/// asserted.
+
+#define PW_LOG_MODULE_NAME "cbor_bench"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "pb_cloud/cbor.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_status/try.h"
+#include "pw_unit_test/framework.h"
+
+namespace pb::cloud::cbor {
+namespace {
+
+using pw::chrono::SystemClock;
+
+constexpr int kIterations = 20000;
+constexpr size_t kEntries = 32;
+
+void LogRate(const char* name, SystemClock::time_point start, size_t bytes) {
+  const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           SystemClock::now() - start)
+                           .count();
+  const auto per_doc = static_cast<unsigned long>(elapsed / kIterations);
+  PW_LOG_INFO("%-16s %5u bytes  %7lu ns/doc", name,
+              static_cast<unsigned>(bytes), per_doc);
+}
+
+// Telemetry-like document: mixed-width integers, doubles and strings
+pw::Result<size_t> EncodeScalars(pw::ByteSpan buffer) {
+  Encoder encoder(buffer);
+  PW_TRY(encoder.BeginMap(kEntries));
+  for (size_t i = 0; i < kEntries; ++i) {
+    const char key[] = {'k', static_cast<char>('a' + i % 26),
+                        static_cast<char>('0' + i / 26), '\0'};
+    switch (i % 4) {
+      case 0:
+        PW_TRY(encoder.WriteUint(key, i * 1000003u));
+        break;
+      case 1:
+        PW_TRY(encoder.WriteInt(key, -static_cast<int64_t>(i) * 70001));
+        break;
+      case 2:
+        PW_TRY(encoder.WriteDouble(key, static_cast<double>(i) / 3));
+        break;
+      default:
+        PW_TRY(encoder.WriteString(key, "value"));
+        break;
+    }
+  }
+  return encoder.size();
+}
+
+pw::Status DecodeScalars(pw::ConstByteSpan data, uint64_t& checksum) {
+  Decoder decoder(data);
+  PW_TRY_ASSIGN(const size_t count, decoder.ReadMapHeader());
+  for (size_t i = 0; i < count; ++i) {
+    PW_TRY(decoder.ReadKeyView().status());
+    switch (i % 4) {
+      case 0: {
+        PW_TRY_ASSIGN(const uint64_t value, decoder.ReadUint());
+        checksum += value;
+        break;
+      }
+      case 1: {
+        PW_TRY_ASSIGN(const int64_t value, decoder.ReadInt());
+        checksum += static_cast<uint64_t>(value);
+        break;
+      }
+      case 2: {
+        PW_TRY_ASSIGN(const double value, decoder.ReadDouble());
+        checksum += static_cast<uint64_t>(value);
+        break;
+      }
+      default: {
+        PW_TRY_ASSIGN(const std::string_view value, decoder.ReadStringView());
+        checksum += value.size();
+        break;
+      }
+    }
+  }
+  return pw::OkStatus();
+}
+
+TEST(CborBenchmark, EncodeScalars) {
+  std::array<std::byte, 512> buffer;
+  size_t size = 0;
+  const auto start = SystemClock::now();
+  for (int i = 0; i < kIterations; ++i) {
+    auto result = EncodeScalars(buffer);
+    ASSERT_TRUE(result.ok());
+    size = result.value();
+  }
+  LogRate("encode scalars", start, size);
+}
+
+TEST(CborBenchmark, DecodeScalars) {
+  std::array<std::byte, 512> buffer;
+  auto size = EncodeScalars(buffer);
+  ASSERT_TRUE(size.ok());
+  const pw::ConstByteSpan data(buffer.data(), size.value());
+
+  uint64_t checksum = 0;
+  const auto start = SystemClock::now();
+  for (int i = 0; i < kIterations; ++i) {
+    ASSERT_EQ(DecodeScalars(data, checksum), pw::OkStatus());
+  }
+  LogRate("decode scalars", start, data.size());
+  EXPECT_NE(checksum, 0u);
+}
+
+TEST(CborBenchmark, SkipValues) {
+  std::array<std::byte, 512> buffer;
+  auto size = EncodeScalars(buffer);
+  ASSERT_TRUE(size.ok());
+  const pw::ConstByteSpan data(buffer.data(), size.value());
+
+  const auto start = SystemClock::now();
+  for (int i = 0; i < kIterations; ++i) {
+    Decoder decoder(data);
+    ASSERT_TRUE(decoder.SkipValue().ok());
+    ASSERT_FALSE(decoder.HasNext());
+  }
+  LogRate("skip map", start, data.size());
+}
+
+TEST(CborBenchmark, TypedArrayRoundTrip) {
+  std::array<int16_t, 256> samples;
+  for (size_t i = 0; i < samples.size(); ++i) {
+    samples[i] = static_cast<int16_t>(i * 37 - 4000);
+  }
+  std::array<std::byte, 1024> buffer;
+  std::array<int16_t, 256> decoded{};
+  size_t size = 0;
+
+  const auto start = SystemClock::now();
+  for (int i = 0; i < kIterations; ++i) {
+    Encoder encoder(buffer);
+    ASSERT_TRUE(encoder.WriteInt16Array(samples).ok());
+    size = encoder.size();
+    Decoder decoder(pw::ConstByteSpan(buffer.data(), size));
+    ASSERT_EQ(decoder.ReadInt16Array(decoded).value(), samples.size());
+  }
+  LogRate("int16 array", start, size);
+  EXPECT_EQ(decoded, samples);
+}
+
+}  // namespace
+}  // namespace pb::cloud::cbor
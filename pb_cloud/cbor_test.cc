@@ -5,7 +5,11 @@
 
 #include <array>
 #include <cmath>
+#include <cstring>
+#include <string_view>
 
+#include "pw_status/try.h"
+#include "pw_stream/memory_stream.h"
 #include "pw_unit_test/framework.h"
 
 namespace pb::cloud::cbor {
@@ -307,6 +311,50 @@ TEST(CborDecoder, Bytes) {
   EXPECT_EQ(value_buf[3], std::byte{0xEF});
 }
 
+TEST(CborDecoder, ViewsPointIntoData) {
+  // {"msg": "hi", "raw": h'BEEF'}
+  std::byte data[] = {
+      std::byte{0xa2},  // map(2)
+      std::byte{0x63},  // text(3)
+      std::byte{'m'}, std::byte{'s'}, std::byte{'g'},
+      std::byte{0x62},  // text(2)
+      std::byte{'h'}, std::byte{'i'},
+      std::byte{0x63},  // text(3)
+      std::byte{'r'}, std::byte{'a'}, std::byte{'w'},
+      std::byte{0x42},  // bytes(2)
+      std::byte{0xBE}, std::byte{0xEF},
+  };
+  Decoder decoder(data);
+  ASSERT_TRUE(decoder.ReadMapHeader().ok());
+
+  auto key = decoder.ReadKeyView();
+  ASSERT_TRUE(key.ok());
+  EXPECT_EQ(key.value(), "msg");
+  EXPECT_EQ(static_cast<const void*>(key.value().data()), &data[2]);
+
+  auto str = decoder.ReadStringView();
+  ASSERT_TRUE(str.ok());
+  EXPECT_EQ(str.value(), "hi");
+
+  ASSERT_TRUE(decoder.ReadKeyView().ok());
+  auto bytes = decoder.ReadBytesView();
+  ASSERT_TRUE(bytes.ok());
+  ASSERT_EQ(bytes.value().size(), 2u);
+  EXPECT_EQ(bytes.value().data(), &data[13]);
+  EXPECT_FALSE(decoder.HasNext());
+}
+
+TEST(CborDecoder, ViewsRejectTruncatedAndMismatchedData) {
+  // text(5) with only 2 bytes of content
+  std::byte truncated[] = {std::byte{0x65}, std::byte{'h'}, std::byte{'i'}};
+  Decoder decoder(truncated);
+  EXPECT_EQ(decoder.ReadStringView().status(), pw::Status::DataLoss());
+
+  std::byte integer[] = {std::byte{0x01}};
+  Decoder int_decoder(integer);
+  EXPECT_EQ(int_decoder.ReadBytesView().status(), pw::Status::DataLoss());
+}
+
 TEST(CborDecoder, SkipValue) {
   // {"skip": "ignored", "want": 42}
   std::byte data[] = {
@@ -557,5 +605,515 @@ TEST(CborDecoder, PeekStringLengthNotString) {
   EXPECT_EQ(len.status().code(), pw::Status::FailedPrecondition().code());
 }
 
+// -- Compact Numeric Tests --
+
+TEST(CborEncoder, FloatUsesShortestExactEncoding) {
+  struct Case {
+    double value;
+    size_t size;
+    uint8_t initial;
+  };
+  constexpr Case kCases[] = {
+      {1.5, 3, 0xf9},        // Exact in float16
+      {-0.0, 3, 0xf9},
+      {65504.0, 3, 0xf9},    // Largest float16
+      {5.960464477539063e-8, 3, 0xf9},  // Smallest float16 subnormal
+      {100000.0, 5, 0xfa},   // Beyond float16 range
+      {3.25e-10, 9, 0xfb},   // Float32 would round
+      {0.1, 9, 0xfb},
+      {INFINITY, 3, 0xf9},
+      {NAN, 3, 0xf9},
+  };
+  for (const Case& test : kCases) {
+    std::array<std::byte, 16> buffer{};
+    Encoder encoder(buffer);
+    ASSERT_TRUE(encoder.WriteFloat(test.value).ok());
+    EXPECT_EQ(encoder.size(), test.size);
+    EXPECT_EQ(buffer[0], std::byte{test.initial});
+
+    Decoder decoder(pw::ConstByteSpan(buffer.data(), encoder.size()));
+    auto decoded = decoder.ReadDouble();
+    ASSERT_TRUE(decoded.ok());
+    if (std::isnan(test.value)) {
+      EXPECT_TRUE(std::isnan(decoded.value()));
+    } else {
+      EXPECT_EQ(decoded.value(), test.value);
+      EXPECT_EQ(std::signbit(decoded.value()), std::signbit(test.value));
+    }
+  }
+}
+
+TEST(CborEncoder, FloatHalfEncoding) {
+  std::array<std::byte, 4> buffer{};
+  Encoder encoder(buffer);
+  ASSERT_TRUE(encoder.WriteFloat(1.5).ok());
+  // f9 3e00
+  EXPECT_EQ(buffer[1], std::byte{0x3e});
+  EXPECT_EQ(buffer[2], std::byte{0x00});
+}
+
+TEST(CborRoundTrip, TypedArrays) {
+  constexpr std::array<int16_t, 3> kSamples = {-2, 300, 32767};
+  constexpr std::array<float, 2> kReadings = {1.25f, -3.5e7f};
+  std::array<std::byte, 64> buffer{};
+  Encoder encoder(buffer);
+  ASSERT_TRUE(encoder.BeginMap(2).ok());
+  ASSERT_TRUE(encoder.WriteInt16Array("s", kSamples).ok());
+  ASSERT_TRUE(encoder.WriteFloat32Array("f", kReadings).ok());
+  // Map header, then per array: key (2) + tag (2) + bytes header (1) +
+  // packed samples
+  EXPECT_EQ(encoder.size(), 1u + (5u + 6u) + (5u + 8u));
+
+  Decoder decoder(pw::ConstByteSpan(buffer.data(), encoder.size()));
+  ASSERT_TRUE(decoder.ReadMapHeader().ok());
+  ASSERT_TRUE(decoder.ReadKeyView().ok());
+  EXPECT_EQ(decoder.PeekType().value(), MajorType::kTag);
+  std::array<int16_t, 4> samples{};
+  auto count = decoder.ReadInt16Array(samples);
+  ASSERT_TRUE(count.ok());
+  ASSERT_EQ(count.value(), kSamples.size());
+  for (size_t i = 0; i < kSamples.size(); ++i) {
+    EXPECT_EQ(samples[i], kSamples[i]);
+  }
+
+  ASSERT_TRUE(decoder.ReadKeyView().ok());
+  std::array<float, 1> too_small{};
+  Decoder copy = decoder;
+  EXPECT_EQ(copy.ReadFloat32Array(too_small).status(),
+            pw::Status::ResourceExhausted());
+  std::array<float, 2> readings{};
+  ASSERT_EQ(decoder.ReadFloat32Array(readings).value(), 2u);
+  EXPECT_EQ(readings[0], kReadings[0]);
+  EXPECT_EQ(readings[1], kReadings[1]);
+}
+
+TEST(CborDecoder, BigEndianTypedArray) {
+  // tag(73) h'0001FFFE' = int16 big-endian [1, -2]
+  std::byte data[] = {std::byte{0xd8}, std::byte{73},   std::byte{0x44},
+                      std::byte{0x00}, std::byte{0x01}, std::byte{0xff},
+                      std::byte{0xfe}};
+  Decoder decoder(data);
+  std::array<int16_t, 2> values{};
+  ASSERT_EQ(decoder.ReadInt16Array(values).value(), 2u);
+  EXPECT_EQ(values[0], 1);
+  EXPECT_EQ(values[1], -2);
+
+  Decoder wrong_type(data);
+  std::array<float, 2> floats{};
+  EXPECT_EQ(wrong_type.ReadFloat32Array(floats).status(),
+            pw::Status::DataLoss());
+}
+
+// -- Nested Container Tests --
+
+TEST(CborRoundTrip, NestedDefiniteContainers) {
+  std::array<std::byte, 64> buffer{};
+  Encoder encoder(buffer);
+  ASSERT_TRUE(encoder.BeginMap(2).ok());
+  ASSERT_TRUE(encoder.BeginMap("pos", 2).ok());
+  ASSERT_TRUE(encoder.WriteDouble("lat", 47.2).ok());
+  ASSERT_TRUE(encoder.WriteDouble("lon", 8.6).ok());
+  ASSERT_TRUE(encoder.BeginArray("temp", 3).ok());
+  for (int64_t value : {21, -3, 300}) {
+    ASSERT_TRUE(encoder.WriteInt(value).ok());
+  }
+  EXPECT_EQ(encoder.End(), pw::Status::FailedPrecondition());
+
+  Decoder decoder(pw::ConstByteSpan(buffer.data(), encoder.size()));
+  EXPECT_EQ(decoder.ReadMapHeader().value(), 2u);
+  EXPECT_EQ(decoder.ReadKeyView().value(), "pos");
+  ASSERT_TRUE(decoder.SkipValue().ok());  // Nested map with doubles
+  EXPECT_EQ(decoder.ReadKeyView().value(), "temp");
+  EXPECT_EQ(decoder.ReadArrayHeader().value(), 3u);
+  EXPECT_EQ(decoder.ReadInt().value(), 21);
+  EXPECT_EQ(decoder.ReadInt().value(), -3);
+  EXPECT_EQ(decoder.ReadInt().value(), 300);
+  EXPECT_FALSE(decoder.HasNext());
+}
+
+TEST(CborRoundTrip, IndefiniteContainers) {
+  std::array<std::byte, 32> buffer{};
+  Encoder encoder(buffer);
+  ASSERT_TRUE(encoder.BeginMap(kIndefiniteLength).ok());
+  ASSERT_TRUE(encoder.BeginArray("s", kIndefiniteLength).ok());
+  ASSERT_TRUE(encoder.WriteInt(1).ok());
+  ASSERT_TRUE(encoder.WriteInt(2).ok());
+  ASSERT_TRUE(encoder.End().ok());
+  ASSERT_TRUE(encoder.WriteBool("ok", true).ok());
+  ASSERT_TRUE(encoder.End().ok());
+
+  // bf 61 73 9f 01 02 ff 62 6f6b f5 ff
+  ASSERT_EQ(encoder.size(), 12u);
+  EXPECT_EQ(buffer[0], std::byte{0xbf});
+  EXPECT_EQ(buffer[3], std::byte{0x9f});
+  EXPECT_EQ(buffer[6], std::byte{0xff});
+  EXPECT_EQ(buffer[11], std::byte{0xff});
+
+  Decoder decoder(pw::ConstByteSpan(buffer.data(), encoder.size()));
+  EXPECT_EQ(decoder.ReadMapHeader().value(), kIndefiniteLength);
+  EXPECT_EQ(decoder.ReadKeyView().value(), "s");
+  EXPECT_EQ(decoder.ReadArrayHeader().value(), kIndefiniteLength);
+  int64_t sum = 0;
+  while (!decoder.AtBreak()) {
+    auto value = decoder.ReadInt();
+    ASSERT_TRUE(value.ok());
+    sum += value.value();
+  }
+  EXPECT_EQ(sum, 3);
+  ASSERT_TRUE(decoder.ReadBreak().ok());
+  EXPECT_EQ(decoder.ReadKeyView().value(), "ok");
+  EXPECT_TRUE(decoder.ReadBool().value());
+  ASSERT_TRUE(decoder.ReadBreak().ok());
+  EXPECT_FALSE(decoder.HasNext());
+
+  Decoder skipper(pw::ConstByteSpan(buffer.data(), encoder.size()));
+  ASSERT_TRUE(skipper.SkipValue().ok());
+  EXPECT_FALSE(skipper.HasNext());
+}
+
+// -- Validation Tests --
+
+TEST(CborDecoder, ValidateAcceptsWellFormedData) {
+  std::array<std::byte, 64> buffer{};
+  Encoder encoder(buffer);
+  ASSERT_TRUE(encoder.BeginMap(3).ok());
+  ASSERT_TRUE(encoder.BeginArray("list", kIndefiniteLength).ok());
+  ASSERT_TRUE(encoder.WriteInt(-5).ok());
+  ASSERT_TRUE(encoder.WriteFloat(0.5).ok());
+  ASSERT_TRUE(encoder.End().ok());
+  ASSERT_TRUE(encoder.BeginMap("empty", 0).ok());
+  const std::array<int16_t, 2> samples = {1, 2};
+  ASSERT_TRUE(encoder.WriteInt16Array("s", samples).ok());
+  const pw::ConstByteSpan data(buffer.data(), encoder.size());
+
+  Decoder decoder(data);
+  ASSERT_EQ(decoder.Validate(), pw::OkStatus());
+  EXPECT_TRUE(decoder.validated());
+
+  // Reads behave the same on the fast paths
+  EXPECT_EQ(decoder.ReadMapHeader().value(), 3u);
+  EXPECT_EQ(decoder.ReadKeyView().value(), "list");
+  const size_t list_offset = decoder.position();
+  ASSERT_TRUE(decoder.SkipValue().ok());
+  EXPECT_EQ(decoder.ReadKeyView().value(), "empty");
+  ASSERT_TRUE(decoder.SkipValue().ok());
+  EXPECT_EQ(decoder.ReadKeyView().value(), "s");
+  ASSERT_TRUE(decoder.SkipValue().ok());
+  EXPECT_FALSE(decoder.HasNext());
+  EXPECT_EQ(decoder.SkipValue(), pw::Status::DataLoss());
+
+  Decoder list = decoder.At(list_offset);
+  EXPECT_TRUE(list.validated());
+  EXPECT_EQ(list.ReadArrayHeader().value(), kIndefiniteLength);
+  EXPECT_EQ(list.ReadInt().value(), -5);
+  EXPECT_EQ(list.ReadDouble().value(), 0.5);
+  EXPECT_EQ(list.ReadInt().status(), pw::Status::DataLoss());  // At break
+  EXPECT_TRUE(list.ReadBreak().ok());
+}
+
+TEST(CborDecoder, ValidateRejectsMalformedData) {
+  // map(2) with one entry
+  std::byte short_map[] = {std::byte{0xa2}, std::byte{0x61}, std::byte{'a'},
+                           std::byte{0x01}};
+  EXPECT_EQ(Decoder(short_map).Validate(), pw::Status::DataLoss());
+
+  // text(5) with 1 byte
+  std::byte short_string[] = {std::byte{0x65}, std::byte{'a'}};
+  EXPECT_EQ(Decoder(short_string).Validate(), pw::Status::DataLoss());
+
+  // Break outside an indefinite container
+  std::byte stray_break[] = {std::byte{0x01}, std::byte{0xff}};
+  EXPECT_EQ(Decoder(stray_break).Validate(), pw::Status::DataLoss());
+
+  // Indefinite map with a key but no value
+  std::byte odd_map[] = {std::byte{0xbf}, std::byte{0x01}, std::byte{0xff}};
+  EXPECT_EQ(Decoder(odd_map).Validate(), pw::Status::DataLoss());
+
+  // Reserved additional info
+  std::byte reserved[] = {std::byte{0x1c}};
+  EXPECT_EQ(Decoder(reserved).Validate(), pw::Status::Unimplemented());
+
+  // Nested deeper than kMaxValidationDepth
+  std::array<std::byte, kMaxValidationDepth + 2> deep;
+  deep.fill(std::byte{0x81});  // array(1)
+  deep.back() = std::byte{0x00};
+  Decoder deep_decoder(deep);
+  EXPECT_EQ(deep_decoder.Validate(), pw::Status::ResourceExhausted());
+  EXPECT_FALSE(deep_decoder.validated());
+}
+
+// -- Compile-Time Encoding Tests --
+
+constexpr EncodedKey kTemperatureKey("temperature");
+static_assert(kTemperatureKey.size() == 12);
+
+constexpr auto kDefaultConfig = [] {
+  StaticDocument<64> doc;
+  doc.BeginMap(4);
+  doc.WriteBool("enabled", true);
+  doc.WriteInt("offset", -300);
+  doc.WriteDouble("gain", 1.25);
+  doc.BeginArray("modes", 2);
+  doc.WriteString("eco");
+  doc.WriteNull();
+  return doc;
+}();
+static_assert(kDefaultConfig.ok());
+
+TEST(CborStaticDocument, MatchesRuntimeEncoder) {
+  std::array<std::byte, 64> buffer{};
+  Encoder encoder(buffer);
+  ASSERT_TRUE(encoder.BeginMap(4).ok());
+  ASSERT_TRUE(encoder.WriteBool("enabled", true).ok());
+  ASSERT_TRUE(encoder.WriteInt("offset", -300).ok());
+  ASSERT_TRUE(encoder.WriteDouble("gain", 1.25).ok());
+  ASSERT_TRUE(encoder.BeginArray("modes", 2).ok());
+  ASSERT_TRUE(encoder.WriteString("eco").ok());
+  ASSERT_TRUE(encoder.WriteNull().ok());
+
+  ASSERT_EQ(kDefaultConfig.size(), encoder.size());
+  EXPECT_EQ(std::memcmp(kDefaultConfig.bytes().data(), buffer.data(),
+                        encoder.size()),
+            0);
+}
+
+TEST(CborStaticDocument, ReportsOverflow) {
+  constexpr auto kTooLarge = [] {
+    StaticDocument<4> doc;
+    doc.BeginMap(1);
+    doc.WriteString("key", "value");
+    return doc;
+  }();
+  static_assert(!kTooLarge.ok());
+  EXPECT_LE(kTooLarge.size(), 4u);
+}
+
+TEST(CborEncodedKey, WritesPrecomputedKey) {
+  std::array<std::byte, 32> expected{};
+  Encoder reference(expected);
+  ASSERT_TRUE(reference.WriteDouble("temperature", 21.5).ok());
+
+  std::array<std::byte, 32> buffer{};
+  Encoder encoder(buffer);
+  ASSERT_TRUE(encoder.WriteKey(kTemperatureKey).ok());
+  ASSERT_TRUE(encoder.WriteDouble(21.5).ok());
+  ASSERT_EQ(encoder.size(), reference.size());
+  EXPECT_EQ(std::memcmp(buffer.data(), expected.data(), encoder.size()), 0);
+
+  std::array<std::byte, 32> output{};
+  pw::stream::MemoryWriter writer(output);
+  StreamEncoder stream(writer, pw::ByteSpan());
+  ASSERT_TRUE(stream.WriteKey(kTemperatureKey).ok());
+  EXPECT_EQ(writer.bytes_written(), kTemperatureKey.size());
+}
+
+// -- MapIndex Tests --
+
+TEST(CborMapIndex, FindsValuesWithoutRescanning) {
+  std::array<std::byte, 128> buffer{};
+  Encoder encoder(buffer);
+  ASSERT_TRUE(encoder.BeginMap(5).ok());
+  ASSERT_TRUE(encoder.WriteInt("a", 1).ok());
+  ASSERT_TRUE(encoder.BeginArray("list", 2).ok());
+  ASSERT_TRUE(encoder.WriteInt(7).ok());
+  ASSERT_TRUE(encoder.WriteInt(8).ok());
+  ASSERT_TRUE(encoder.WriteString("name", "sensor").ok());
+  ASSERT_TRUE(encoder.WriteDouble("pi", 3.5).ok());
+  ASSERT_TRUE(encoder.WriteInt("a", 2).ok());  // Duplicate: first wins
+  const pw::ConstByteSpan data(buffer.data(), encoder.size());
+
+  std::array<MapIndexEntry, 8> slots;
+  MapIndex index(slots);
+  ASSERT_TRUE(index.Build(data).ok());
+  EXPECT_EQ(index.size(), 4u);
+
+  EXPECT_TRUE(index.Contains("name"));
+  EXPECT_FALSE(index.Contains("missing"));
+  EXPECT_EQ(index.Find("missing").status(), pw::Status::NotFound());
+
+  EXPECT_EQ(index.Find("a").value().ReadInt().value(), 1);
+  EXPECT_EQ(index.Find("pi").value().ReadDouble().value(), 3.5);
+  EXPECT_EQ(index.Find("name").value().ReadStringView().value(), "sensor");
+  auto list = index.Find("list");
+  ASSERT_TRUE(list.ok());
+  EXPECT_EQ(list.value().ReadArrayHeader().value(), 2u);
+  EXPECT_EQ(list.value().ReadInt().value(), 7);
+}
+
+TEST(CborMapIndex, IndexesIndefiniteMap) {
+  std::array<std::byte, 32> buffer{};
+  Encoder encoder(buffer);
+  ASSERT_TRUE(encoder.BeginMap(kIndefiniteLength).ok());
+  ASSERT_TRUE(encoder.WriteBool("on", true).ok());
+  ASSERT_TRUE(encoder.End().ok());
+
+  std::array<MapIndexEntry, 2> slots;
+  MapIndex index(slots);
+  ASSERT_TRUE(
+      index.Build(pw::ConstByteSpan(buffer.data(), encoder.size())).ok());
+  EXPECT_TRUE(index.Find("on").value().ReadBool().value());
+}
+
+TEST(CborMapIndex, RejectsTooManyKeys) {
+  std::array<std::byte, 32> buffer{};
+  Encoder encoder(buffer);
+  ASSERT_TRUE(encoder.BeginMap(2).ok());
+  ASSERT_TRUE(encoder.WriteInt("a", 1).ok());
+  ASSERT_TRUE(encoder.WriteInt("b", 2).ok());
+
+  std::array<MapIndexEntry, 2> slots;
+  MapIndex index(slots);
+  EXPECT_EQ(index.Build(pw::ConstByteSpan(buffer.data(), encoder.size())),
+            pw::Status::ResourceExhausted());
+  EXPECT_FALSE(index.Contains("a"));
+}
+
+// -- StreamEncoder Tests --
+
+template <typename E>
+pw::Status EncodeSample(E& encoder) {
+  constexpr std::array<int16_t, 3> kSamples = {1, -2, 3};
+  constexpr std::string_view kLong = "a string longer than the window";
+  PW_TRY(encoder.BeginMap(kIndefiniteLength));
+  PW_TRY(encoder.WriteNull("n"));
+  PW_TRY(encoder.WriteBool("b", true));
+  PW_TRY(encoder.WriteInt("i", -100000));
+  PW_TRY(encoder.WriteUint("u", 0x123456789aULL));
+  PW_TRY(encoder.WriteDouble("d", 0.1));
+  PW_TRY(encoder.WriteFloat("f", 1.5));
+  PW_TRY(encoder.WriteString("s", kLong));
+  PW_TRY(encoder.WriteBytes("e", pw::ConstByteSpan()));
+  PW_TRY(encoder.BeginArray("a", 1));
+  PW_TRY(encoder.WriteInt16Array(kSamples));
+  return encoder.End();
+}
+
+TEST(CborStreamEncoder, MatchesBufferEncoder) {
+  std::array<std::byte, 128> expected{};
+  Encoder reference(expected);
+  ASSERT_TRUE(EncodeSample(reference).ok());
+
+  for (size_t window_size : {0, 1, 8, 64}) {
+    std::array<std::byte, 128> output{};
+    pw::stream::MemoryWriter writer(output);
+    std::array<std::byte, 64> window_buffer;
+    StreamEncoder encoder(writer,
+                          pw::ByteSpan(window_buffer).first(window_size));
+    ASSERT_TRUE(EncodeSample(encoder).ok());
+    EXPECT_EQ(encoder.size(), reference.size());
+    ASSERT_TRUE(encoder.Flush().ok());
+    ASSERT_EQ(writer.bytes_written(), reference.size());
+    EXPECT_EQ(std::memcmp(output.data(), expected.data(), reference.size()),
+              0);
+  }
+}
+
+TEST(CborStreamEncoder, ReportsWriterErrors) {
+  std::array<std::byte, 4> output{};
+  pw::stream::MemoryWriter writer(output);
+  std::array<std::byte, 4> window;
+  StreamEncoder encoder(writer, window);
+  ASSERT_TRUE(encoder.BeginMap(1).ok());
+  EXPECT_EQ(encoder.WriteString("key", "value"),
+            pw::Status::ResourceExhausted());
+  EXPECT_EQ(encoder.End(), pw::Status::FailedPrecondition());
+}
+
+// -- StreamDecoder Tests --
+
+TEST(CborStreamDecoder, SkipsIndefiniteContainers) {
+  std::array<std::byte, 64> buffer{};
+  Encoder encoder(buffer);
+  ASSERT_TRUE(encoder.BeginMap(2).ok());
+  ASSERT_TRUE(encoder.BeginMap("nested", kIndefiniteLength).ok());
+  ASSERT_TRUE(encoder.WriteDouble("x", 1.5).ok());
+  ASSERT_TRUE(encoder.BeginArray("list", kIndefiniteLength).ok());
+  ASSERT_TRUE(encoder.WriteString("abc").ok());
+  ASSERT_TRUE(encoder.End().ok());
+  ASSERT_TRUE(encoder.End().ok());
+  ASSERT_TRUE(encoder.WriteUint("after", 7).ok());
+
+  pw::stream::MemoryReader reader(
+      pw::ConstByteSpan(buffer.data(), encoder.size()));
+  std::array<std::byte, 3> window;
+  StreamDecoder decoder(reader, window);
+
+  ASSERT_TRUE(decoder.ReadMapHeader().ok());
+  std::array<std::byte, 16> key_buf{};
+  ASSERT_TRUE(decoder.ReadKey(key_buf).ok());
+  ASSERT_TRUE(decoder.SkipValue().ok());
+  EXPECT_EQ(decoder.ReadKey(key_buf).value(), "after");
+  EXPECT_EQ(decoder.ReadUint().value(), 7u);
+  EXPECT_EQ(decoder.position(), encoder.size());
+}
+
+TEST(CborStreamDecoder, ReadsAcrossWindowRefills) {
+  constexpr std::string_view kLong = "a string longer than the window";
+  std::array<std::byte, 128> buffer{};
+  Encoder encoder(buffer);
+  ASSERT_TRUE(encoder.BeginMap(5).ok());
+  ASSERT_TRUE(encoder.WriteString("skip", kLong).ok());
+  ASSERT_TRUE(encoder.WriteUint("big", 0x123456789aULL).ok());
+  ASSERT_TRUE(encoder.WriteInt("neg", -1000).ok());
+  ASSERT_TRUE(encoder.WriteDouble("pi", 3.14159).ok());
+  ASSERT_TRUE(encoder.WriteString("text", kLong).ok());
+
+  pw::stream::MemoryReader reader(
+      pw::ConstByteSpan(buffer.data(), encoder.size()));
+  std::array<std::byte, 4> window;
+  StreamDecoder decoder(reader, window);
+
+  auto count = decoder.ReadMapHeader();
+  ASSERT_TRUE(count.ok());
+  EXPECT_EQ(count.value(), 5u);
+
+  std::array<std::byte, 16> key_buf{};
+  ASSERT_TRUE(decoder.ReadKey(key_buf).ok());
+  ASSERT_TRUE(decoder.SkipValue().ok());
+
+  auto key = decoder.ReadKey(key_buf);
+  ASSERT_TRUE(key.ok());
+  EXPECT_EQ(key.value(), "big");
+  auto big = decoder.ReadUint();
+  ASSERT_TRUE(big.ok());
+  EXPECT_EQ(big.value(), 0x123456789aULL);
+
+  ASSERT_TRUE(decoder.ReadKey(key_buf).ok());
+  auto neg = decoder.ReadInt();
+  ASSERT_TRUE(neg.ok());
+  EXPECT_EQ(neg.value(), -1000);
+
+  ASSERT_TRUE(decoder.ReadKey(key_buf).ok());
+  auto pi = decoder.ReadDouble();
+  ASSERT_TRUE(pi.ok());
+  EXPECT_EQ(pi.value(), 3.14159);
+
+  ASSERT_TRUE(decoder.ReadKey(key_buf).ok());
+  EXPECT_EQ(decoder.PeekType().value(), MajorType::kTextString);
+  std::array<char, 64> text{};
+  auto len = decoder.ReadString(pw::as_writable_bytes(pw::span(text)));
+  ASSERT_TRUE(len.ok());
+  EXPECT_EQ(std::string_view(text.data(), len.value()), kLong);
+  EXPECT_EQ(decoder.position(), encoder.size());
+}
+
+TEST(CborStreamDecoder, TruncatedStreamIsDataLoss) {
+  std::array<std::byte, 32> buffer{};
+  Encoder encoder(buffer);
+  ASSERT_TRUE(encoder.BeginMap(1).ok());
+  ASSERT_TRUE(encoder.WriteString("key", "value").ok());
+
+  pw::stream::MemoryReader reader(
+      pw::ConstByteSpan(buffer.data(), encoder.size() - 2));
+  std::array<std::byte, 8> window;
+  StreamDecoder decoder(reader, window);
+
+  ASSERT_TRUE(decoder.ReadMapHeader().ok());
+  std::array<std::byte, 8> key_buf{};
+  ASSERT_TRUE(decoder.ReadKey(key_buf).ok());
+  std::array<std::byte, 8> value_buf{};
+  EXPECT_EQ(decoder.ReadString(value_buf).status(), pw::Status::DataLoss());
+}
+
 }  // namespace
 }  // namespace pb::cloud::cbor
@@ -0,0 +1,246 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+/// @file cloud_load_benchmark_test.cc
+/// @brief Host load test of pb_cloud consumers at production event rates.
+///
+/// Drives BatchingPublisher, a subscription and the ledger editor against
+/// the mock backends with load profiles (ack latency and jitter, failures,
+/// rate limit, event bursts, sync latency). Traffic runs in simulated time,
+/// so hours of it take milliseconds and the measured CPU time is that of
+/// the pb_cloud code: channels, CBOR and the editor. Run it under a
+/// profiler (e.g. perf record) to find the hot paths on a workstation.
+///
+/// Each test checks that every operation is accounted for and logs the
+/// CPU time per operation and the backend counters. Timings are not
+/// asserted.
+
+#define PW_LOG_MODULE_NAME "cloud_load"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "mock_cloud_backend.h"
+#include "mock_ledger_backend.h"
+#include "pb_cloud/batching_publisher.h"
+#include "pb_cloud/cbor.h"
+#include "pw_async2/basic_dispatcher.h"
+#include "pw_async2/pend_func_task.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_result/result.h"
+#include "pw_status/try.h"
+#include "pw_unit_test/framework.h"
+
+namespace pb::cloud {
+namespace {
+
+using pw::chrono::SystemClock;
+
+constexpr uint32_t kSecondMs = 1000;
+constexpr uint32_t kMinuteMs = 60 * kSecondMs;
+constexpr uint32_t kHourMs = 60 * kMinuteMs;
+
+// Cellular-like publish acks, 1% failures, Particle's publish rate limit
+constexpr MockCloudLoadProfile kCloudProfile = {
+    .ack_latency_ms = 300,
+    .ack_jitter_ms = 700,
+    .ack_failure_per_mille = 10,
+    .rate_limit_per_s = 1,
+    .rate_limit_burst = 4,
+};
+
+uint64_t ElapsedNs(SystemClock::time_point start) {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(SystemClock::now() -
+                                                           start)
+          .count());
+}
+
+void LogCloudStats(const CloudStats& stats) {
+  PW_LOG_INFO(
+      "  publishes=%u acks=%u errors=%u unavailable=%u busy=%u "
+      "latency_max_ms=%u",
+      static_cast<unsigned>(stats.publishes),
+      static_cast<unsigned>(stats.publish_acks),
+      static_cast<unsigned>(stats.publish_errors),
+      static_cast<unsigned>(stats.publish_unavailable),
+      static_cast<unsigned>(stats.publish_busy),
+      static_cast<unsigned>(stats.publish_latency_max_ms));
+}
+
+// Small telemetry record as a sensor task would produce it
+pw::Result<size_t> EncodeSample(uint32_t sequence, pw::ByteSpan buffer) {
+  cbor::Encoder encoder(buffer);
+  PW_TRY(encoder.BeginMap(3));
+  PW_TRY(encoder.WriteUint("n", sequence));
+  PW_TRY(encoder.WriteDouble("t", 20.0 + (sequence % 100) / 10.0));
+  PW_TRY(encoder.WriteString("s", "ok"));
+  return encoder.size();
+}
+
+class CloudLoadBenchmark : public ::testing::Test {
+ protected:
+  // Calls publisher.Pend() once from a task.
+  void Drive(BatchingPublisher& publisher) {
+    pw::async2::PendFuncTask task(
+        [&publisher](pw::async2::Context& cx) -> pw::async2::Poll<> {
+          static_cast<void>(publisher.Pend(cx));
+          return pw::async2::Ready();
+        });
+    dispatcher_.Post(task);
+    dispatcher_.RunUntilStalled();
+  }
+
+  pw::async2::BasicDispatcher dispatcher_;
+  MockCloudBackend cloud_;
+  MockLedgerBackend ledger_;
+};
+
+// One hour of 10 Hz samples, batched and flushed every 10 s
+TEST_F(CloudLoadBenchmark, BatchedTelemetry) {
+  constexpr uint32_t kTickMs = 100;
+  constexpr uint32_t kFlushMs = 10 * kSecondMs;
+  cloud_.SetLoadProfile(kCloudProfile);
+  // Flushes are driven in simulated time below
+  BatchingPublisher publisher(
+      cloud_, "telemetry",
+      {.max_age = SystemClock::for_at_least(std::chrono::hours(24))});
+
+  std::array<std::byte, 32> sample;
+  uint32_t samples = 0;
+  uint32_t back_pressure = 0;
+  const auto start = SystemClock::now();
+  for (uint32_t now = 0; now < kHourMs; now += kTickMs) {
+    auto size = EncodeSample(samples, sample);
+    ASSERT_TRUE(size.ok());
+    if (publisher.Add(pw::ConstByteSpan(sample.data(), size.value()))
+            .IsResourceExhausted()) {
+      ++back_pressure;
+    }
+    ++samples;
+    if ((now + kTickMs) % kFlushMs == 0) {
+      static_cast<void>(publisher.Flush());
+    }
+    cloud_.AdvanceTime(kTickMs);
+    Drive(publisher);
+  }
+  const uint64_t elapsed = ElapsedNs(start);
+
+  PW_LOG_INFO("batched telemetry: %u samples, %u batches, %u ns/sample, "
+              "back_pressure=%u rate_limited=%u",
+              static_cast<unsigned>(samples),
+              static_cast<unsigned>(publisher.batch_count()),
+              static_cast<unsigned>(elapsed / samples),
+              static_cast<unsigned>(back_pressure),
+              static_cast<unsigned>(cloud_.rate_limited_count()));
+  const CloudStats stats = cloud_.stats();
+  LogCloudStats(stats);
+
+  EXPECT_EQ(stats.publishes, publisher.batch_count());
+  EXPECT_EQ(stats.publishes, stats.publish_acks + stats.publish_errors +
+                                 stats.publish_unavailable +
+                                 stats.publish_busy +
+                                 cloud_.pending_publish_count());
+  EXPECT_GT(stats.publish_acks, 0u);
+}
+
+// Bursts of commands after reconnects, drained by the consumer task
+TEST_F(CloudLoadBenchmark, EventBursts) {
+  constexpr size_t kBursts = 1000;
+  constexpr size_t kBurstSize = 32;
+  EventReceiver receiver = cloud_.Subscribe("cmd/");
+
+  std::array<std::byte, 32> payload;
+  auto size = EncodeSample(42, payload);
+  ASSERT_TRUE(size.ok());
+  const pw::ConstByteSpan data(payload.data(), size.value());
+
+  uint32_t dropped = 0;
+  uint32_t delivered = 0;
+  uint64_t checksum = 0;
+  const auto start = SystemClock::now();
+  for (size_t burst = 0; burst < kBursts; ++burst) {
+    dropped += cloud_.SimulateEventBurst("cmd/set", data, kBurstSize,
+                                         ContentType::kStructured);
+    while (true) {
+      auto event = receiver.TryReceive();
+      if (!event.ok()) {
+        break;
+      }
+      cbor::Decoder decoder(pw::ConstByteSpan(event->data));
+      auto count = decoder.ReadMapHeader();
+      ASSERT_TRUE(count.ok());
+      ASSERT_TRUE(decoder.ReadKeyView().ok());
+      auto sequence = decoder.ReadUint();
+      ASSERT_TRUE(sequence.ok());
+      checksum += sequence.value();
+      ++delivered;
+    }
+  }
+  const uint64_t elapsed = ElapsedNs(start);
+
+  PW_LOG_INFO("event bursts: %u events, %u ns/event, delivered=%u "
+              "dropped=%u",
+              static_cast<unsigned>(kBursts * kBurstSize),
+              static_cast<unsigned>(elapsed / (kBursts * kBurstSize)),
+              static_cast<unsigned>(delivered),
+              static_cast<unsigned>(dropped));
+
+  EXPECT_EQ(delivered + dropped, kBursts * kBurstSize);
+  EXPECT_EQ(delivered, kBursts * kMockEventChannelCapacity);
+  EXPECT_EQ(checksum, uint64_t{42} * delivered);
+}
+
+// A day of once-a-minute configuration updates with slow syncs
+TEST_F(CloudLoadBenchmark, LedgerUpdates) {
+  constexpr uint32_t kUpdates = 24 * 60;
+  ledger_.SetLoadProfile({.sync_latency_ms = 2 * kSecondMs,
+                          .sync_jitter_ms = 3 * kSecondMs,
+                          .write_failure_per_mille = 5});
+  auto handle = ledger_.GetLedger("device-state");
+  ASSERT_TRUE(handle.ok());
+  SyncEventReceiver syncs = ledger_.SubscribeToSync("device-state");
+
+  std::array<std::byte, 512> buffer;
+  uint32_t committed = 0;
+  uint32_t failed = 0;
+  uint32_t synced = 0;
+  const auto start = SystemClock::now();
+  for (uint32_t update = 0; update < kUpdates; ++update) {
+    auto editor = handle->Edit(buffer);
+    ASSERT_TRUE(editor.ok());
+    ASSERT_EQ(editor->SetUint("sequence", update), pw::OkStatus());
+    ASSERT_EQ(editor->SetDouble("temperature", 20.0 + update % 50),
+              pw::OkStatus());
+    ASSERT_EQ(editor->SetString("mode", update % 2 ? "auto" : "manual"),
+              pw::OkStatus());
+    ASSERT_EQ(editor->SetBool("door_open", update % 7 == 0), pw::OkStatus());
+    if (editor->Commit().ok()) {
+      ++committed;
+    } else {
+      ++failed;
+    }
+    ledger_.AdvanceTime(kMinuteMs);
+    while (syncs.TryReceive().ok()) {
+      ++synced;
+    }
+  }
+  const uint64_t elapsed = ElapsedNs(start);
+
+  PW_LOG_INFO("ledger updates: %u commits, %u ns/update, failed=%u "
+              "synced=%u",
+              static_cast<unsigned>(kUpdates),
+              static_cast<unsigned>(elapsed / kUpdates),
+              static_cast<unsigned>(failed),
+              static_cast<unsigned>(synced));
+
+  EXPECT_EQ(failed, ledger_.write_failure_count());
+  EXPECT_EQ(committed, ledger_.write_count());
+  // Syncs complete well within a minute, so each committed write syncs
+  EXPECT_EQ(synced, committed);
+}
+
+}  // namespace
+}  // namespace pb::cloud
@@ -0,0 +1,136 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_cloud/event_arena.h"
+
+#include <cstring>
+
+namespace pb::cloud {
+
+namespace {
+
+// Record header layout (little endian):
+//   [0..1] record size   [2] name length   [3] flags
+//   [4..5] data length   [6..7] content type
+constexpr uint8_t kFlagReleased = 0x01;
+
+void PutU16(std::byte* dest, uint32_t value) {
+  dest[0] = static_cast<std::byte>(value & 0xff);
+  dest[1] = static_cast<std::byte>((value >> 8) & 0xff);
+}
+
+uint16_t GetU16(const std::byte* src) {
+  return static_cast<uint16_t>(static_cast<uint16_t>(src[0]) |
+                               (static_cast<uint16_t>(src[1]) << 8));
+}
+
+size_t RecordSize(const std::byte* record) { return GetU16(record); }
+
+}  // namespace
+
+std::string_view CompactEvent::name() const {
+  if (record_ == nullptr) {
+    return {};
+  }
+  return std::string_view(
+      reinterpret_cast<const char*>(record_ + EventArena::kEventHeaderSize),
+      static_cast<uint8_t>(record_[2]));
+}
+
+pw::ConstByteSpan CompactEvent::data() const {
+  if (record_ == nullptr) {
+    return {};
+  }
+  const size_t name_len = static_cast<uint8_t>(record_[2]);
+  return pw::ConstByteSpan(record_ + EventArena::kEventHeaderSize + name_len,
+                           GetU16(record_ + 4));
+}
+
+ContentType CompactEvent::content_type() const {
+  if (record_ == nullptr) {
+    return ContentType::kText;
+  }
+  return static_cast<ContentType>(GetU16(record_ + 6));
+}
+
+void CompactEvent::Release() {
+  if (record_ != nullptr) {
+    arena_->Release(record_);
+    arena_ = nullptr;
+    record_ = nullptr;
+  }
+}
+
+EventArena::EventArena(pw::ByteSpan buffer) : buffer_(buffer) {}
+
+pw::Result<CompactEvent> EventArena::Store(std::string_view name,
+                                           pw::ConstByteSpan data,
+                                           ContentType content_type) {
+  if (name.size() > kMaxEventNameSize || data.size() > kMaxEventDataSize) {
+    return pw::Status::InvalidArgument();
+  }
+  const size_t size = EventSize(name.size(), data.size());
+
+  size_t offset = 0;
+  if (event_count_ == 0) {
+    head_ = 0;
+    tail_ = 0;
+    wrapped_ = false;
+    if (size > buffer_.size()) {
+      return pw::Status::ResourceExhausted();
+    }
+  } else if (!wrapped_) {
+    if (buffer_.size() - head_ >= size) {
+      offset = head_;
+    } else if (tail_ >= size) {
+      // Not enough room at the end; continue at the start
+      wrap_ = head_;
+      wrapped_ = true;
+    } else {
+      return pw::Status::ResourceExhausted();
+    }
+  } else if (tail_ - head_ >= size) {
+    offset = head_;
+  } else {
+    return pw::Status::ResourceExhausted();
+  }
+
+  std::byte* record = buffer_.data() + offset;
+  PutU16(record, static_cast<uint32_t>(size));
+  record[2] = static_cast<std::byte>(name.size());
+  record[3] = std::byte{0};
+  PutU16(record + 4, static_cast<uint32_t>(data.size()));
+  PutU16(record + 6, static_cast<uint32_t>(content_type));
+  std::memcpy(record + kEventHeaderSize, name.data(), name.size());
+  if (!data.empty()) {
+    std::memcpy(record + kEventHeaderSize + name.size(), data.data(),
+                data.size());
+  }
+  head_ = offset + size;
+  ++event_count_;
+  return CompactEvent(*this, record);
+}
+
+void EventArena::Release(std::byte* record) {
+  record[3] |= static_cast<std::byte>(kFlagReleased);
+
+  while (event_count_ > 0) {
+    std::byte* oldest = buffer_.data() + tail_;
+    if ((oldest[3] & static_cast<std::byte>(kFlagReleased)) == std::byte{0}) {
+      break;
+    }
+    tail_ += RecordSize(oldest);
+    --event_count_;
+    if (wrapped_ && tail_ == wrap_) {
+      tail_ = 0;
+      wrapped_ = false;
+    }
+  }
+  if (event_count_ == 0) {
+    head_ = 0;
+    tail_ = 0;
+    wrapped_ = false;
+  }
+}
+
+}  // namespace pb::cloud
@@ -0,0 +1,116 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_cloud/event_arena.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <utility>
+
+#include "pw_unit_test/framework.h"
+
+namespace pb::cloud {
+namespace {
+
+constexpr auto kData = std::array<std::byte, 3>{
+    std::byte{0x01}, std::byte{0x00}, std::byte{0x03}};
+
+// An event of kData with a one-character name
+constexpr size_t kEventSize = EventArena::EventSize(1, kData.size());
+
+TEST(EventArenaTest, StoresEventWithItsSize) {
+  std::array<std::byte, 64> buffer;
+  EventArena arena(buffer);
+
+  auto event = arena.Store("a", kData, ContentType::kBinary);
+  ASSERT_TRUE(event.ok());
+  EXPECT_EQ(event->name(), "a");
+  EXPECT_EQ(event->content_type(), ContentType::kBinary);
+  ASSERT_EQ(event->data().size(), kData.size());
+  EXPECT_TRUE(std::equal(kData.begin(), kData.end(), event->data().begin()));
+  EXPECT_EQ(arena.event_count(), 1u);
+}
+
+TEST(EventArenaTest, ReleasingLastEventFreesArena) {
+  std::array<std::byte, kEventSize> buffer;
+  EventArena arena(buffer);
+
+  {
+    auto event = arena.Store("a", kData, ContentType::kText);
+    ASSERT_TRUE(event.ok());
+    EXPECT_EQ(arena.Store("b", kData, ContentType::kText).status(),
+              pw::Status::ResourceExhausted());
+  }
+  EXPECT_EQ(arena.event_count(), 0u);
+  EXPECT_TRUE(arena.Store("b", kData, ContentType::kText).ok());
+}
+
+TEST(EventArenaTest, MovedEventKeepsItsSpace) {
+  std::array<std::byte, kEventSize> buffer;
+  EventArena arena(buffer);
+
+  auto stored = arena.Store("a", kData, ContentType::kText);
+  ASSERT_TRUE(stored.ok());
+  CompactEvent event = std::move(*stored);
+  EXPECT_FALSE(stored->has_value());
+  EXPECT_EQ(event.name(), "a");
+  EXPECT_EQ(arena.event_count(), 1u);
+
+  event.Release();
+  EXPECT_FALSE(event.has_value());
+  EXPECT_EQ(arena.event_count(), 0u);
+}
+
+TEST(EventArenaTest, OutOfOrderReleaseWaitsForOlderEvents) {
+  std::array<std::byte, 2 * kEventSize> buffer;
+  EventArena arena(buffer);
+
+  auto first = arena.Store("a", kData, ContentType::kText);
+  auto second = arena.Store("b", kData, ContentType::kText);
+  ASSERT_TRUE(first.ok());
+  ASSERT_TRUE(second.ok());
+
+  second->Release();
+  EXPECT_EQ(arena.event_count(), 2u);
+  EXPECT_FALSE(arena.Store("c", kData, ContentType::kText).ok());
+
+  first->Release();
+  EXPECT_EQ(arena.event_count(), 0u);
+}
+
+TEST(EventArenaTest, WrapsAroundWhenEndIsFull) {
+  std::array<std::byte, 2 * kEventSize + 2> buffer;
+  EventArena arena(buffer);
+
+  auto first = arena.Store("a", kData, ContentType::kText);
+  auto second = arena.Store("b", kData, ContentType::kText);
+  // Too large for the space left at the end
+  auto large = arena.Store("c", std::array<std::byte, kData.size() + 1>{},
+                           ContentType::kText);
+  EXPECT_EQ(large.status(), pw::Status::ResourceExhausted());
+
+  // Continues at the start once the oldest event is released
+  first->Release();
+  auto third = arena.Store("c", kData, ContentType::kText);
+  ASSERT_TRUE(third.ok());
+  EXPECT_EQ(third->name(), "c");
+  EXPECT_EQ(second->name(), "b");
+  EXPECT_EQ(arena.event_count(), 2u);
+
+  second->Release();
+  third->Release();
+  EXPECT_EQ(arena.event_count(), 0u);
+}
+
+TEST(EventArenaTest, RejectsOversizedEvent) {
+  std::array<std::byte, 64> buffer;
+  EventArena arena(buffer);
+
+  std::array<std::byte, kMaxEventDataSize + 1> data{};
+  EXPECT_EQ(arena.Store("a", data, ContentType::kText).status(),
+            pw::Status::InvalidArgument());
+}
+
+}  // namespace
+}  // namespace pb::cloud
@@ -219,10 +219,12 @@ TEST_F(PbCloudIntegrationTest, ManualVerification) {
       auto result = g_event_receiver->TryReceive();
       if (result.ok()) {
         auto& event = result.value();
-        PW_LOG_INFO("Received event: name=%s, data_size=%u",
-                    event.name.c_str(), static_cast<unsigned>(event.data.size()));
+        PW_LOG_INFO("Received event: name=%s, data_size=%u, content_type=%d",
+                    event.name.c_str(), static_cast<unsigned>(event.data.size()),
+                    static_cast<int>(event.content_type));
         // Log data as string if it's text
-        if (!event.data.empty()) {
+        if (!event.data.empty() &&
+            event.content_type == pb::cloud::ContentType::kText) {
           pw::InlineString<256> data_str(
               reinterpret_cast<const char*>(event.data.data()),
               event.data.size());
@@ -0,0 +1,151 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#define PW_LOG_MODULE_NAME "ledger_bench"
+
+#include "ledger_benchmark.h"
+
+#include <chrono>
+#include <cstdio>
+
+#include "pb_cloud/cbor.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_status/try.h"
+
+namespace pb::cloud::benchmark {
+namespace {
+
+using pw::chrono::SystemClock;
+
+uint32_t ElapsedUs(SystemClock::time_point start) {
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          SystemClock::now() - start)
+          .count());
+}
+
+/// Encode a one-property map of exactly `data_size` bytes, with the value
+/// taken from `fill`.
+pw::Result<size_t> EncodeBlob(size_t data_size,
+                              pw::ConstByteSpan fill,
+                              pw::ByteSpan out) {
+  constexpr std::string_view kKey = "blob";
+  // Map header + key header + key
+  constexpr size_t kOverhead = 1 + 1 + kKey.size();
+  if (data_size <= kOverhead + 1 || data_size > out.size() ||
+      data_size > fill.size()) {
+    return pw::Status::InvalidArgument();
+  }
+  size_t length = data_size - kOverhead - 1;
+  while (kOverhead + cbor::Encoder::HeaderSize(length) + length > data_size) {
+    --length;
+  }
+  cbor::Encoder encoder(out);
+  PW_TRY(encoder.BeginMap(1));
+  PW_TRY(encoder.WriteBytes(kKey, fill.first(length)));
+  return encoder.size();
+}
+
+}  // namespace
+
+pw::Result<IoSample> MeasureReadWrite(LedgerBackend& backend,
+                                      std::string_view ledger,
+                                      size_t data_size,
+                                      Scratch& scratch) {
+  // First half holds the data to write, second half receives reads
+  const pw::ByteSpan data = pw::ByteSpan(scratch.buffer).first(
+      scratch.buffer.size() / 2);
+  const pw::ByteSpan read_buffer = pw::ByteSpan(scratch.buffer).subspan(
+      scratch.buffer.size() / 2);
+  PW_TRY_ASSIGN(const size_t size, EncodeBlob(data_size, read_buffer, data));
+
+  PW_TRY_ASSIGN(LedgerHandle handle, backend.GetLedger(ledger));
+  IoSample sample{.data_size = size};
+  uint64_t write_total = 0;
+  uint64_t read_total = 0;
+  for (int i = 0; i < kIterations; ++i) {
+    auto start = SystemClock::now();
+    PW_TRY(handle.Write(data.first(size)));
+    write_total += ElapsedUs(start);
+
+    start = SystemClock::now();
+    PW_TRY_ASSIGN(const size_t read, handle.Read(read_buffer));
+    read_total += ElapsedUs(start);
+    if (read != size) {
+      return pw::Status::DataLoss();
+    }
+  }
+  sample.write_us = static_cast<uint32_t>(write_total / kIterations);
+  sample.read_us = static_cast<uint32_t>(read_total / kIterations);
+  return sample;
+}
+
+pw::Result<CommitSample> MeasureSingleKeyCommit(LedgerBackend& backend,
+                                                std::string_view ledger,
+                                                size_t property_count,
+                                                Scratch& scratch) {
+  if (property_count == 0 || property_count > scratch.properties.size()) {
+    return pw::Status::InvalidArgument();
+  }
+  PW_TRY_ASSIGN(LedgerHandle handle, backend.GetLedger(ledger));
+
+  // Start from a ledger with exactly `property_count` properties
+  constexpr std::array<std::byte, 1> kEmptyMap = {std::byte{0xa0}};
+  PW_TRY(handle.Write(kEmptyMap));
+  {
+    PW_TRY_ASSIGN(LedgerEditor editor,
+                  handle.Edit(scratch.buffer, scratch.properties));
+    for (size_t i = 0; i < property_count; ++i) {
+      std::array<char, 8> key{};
+      std::snprintf(key.data(), key.size(), "p%u", static_cast<unsigned>(i));
+      PW_TRY(editor.SetInt(key.data(), 0));
+    }
+    PW_TRY(editor.Commit());
+  }
+
+  CommitSample sample{.property_count = property_count};
+  uint64_t total = 0;
+  for (int i = 0; i < kIterations; ++i) {
+    const auto start = SystemClock::now();
+    PW_TRY_ASSIGN(LedgerEditor editor,
+                  handle.Edit(scratch.buffer, scratch.properties));
+    PW_TRY(editor.SetInt("p0", i + 1));
+    PW_TRY(editor.Commit());
+    total += ElapsedUs(start);
+  }
+  sample.commit_us = static_cast<uint32_t>(total / kIterations);
+
+  PW_TRY_ASSIGN(const LedgerInfo info, handle.GetInfo());
+  sample.bytes_rewritten = info.data_size;
+  return sample;
+}
+
+pw::Status RunAndLog(LedgerBackend& backend,
+                     std::string_view ledger,
+                     Scratch& scratch) {
+  PW_LOG_INFO("Ledger '%.*s', %d iterations per sample",
+              static_cast<int>(ledger.size()), ledger.data(), kIterations);
+
+  PW_LOG_INFO("  size    read_us  write_us");
+  for (size_t data_size : kDataSizes) {
+    PW_TRY_ASSIGN(const IoSample io,
+                  MeasureReadWrite(backend, ledger, data_size, scratch));
+    PW_LOG_INFO("  %-6u  %-7u  %u", static_cast<unsigned>(io.data_size),
+                static_cast<unsigned>(io.read_us),
+                static_cast<unsigned>(io.write_us));
+  }
+
+  PW_LOG_INFO("  props   commit_us  bytes_per_update");
+  for (size_t count : kPropertyCounts) {
+    PW_TRY_ASSIGN(const CommitSample commit,
+                  MeasureSingleKeyCommit(backend, ledger, count, scratch));
+    PW_LOG_INFO("  %-6u  %-9u  %u",
+                static_cast<unsigned>(commit.property_count),
+                static_cast<unsigned>(commit.commit_us),
+                static_cast<unsigned>(commit.bytes_rewritten));
+  }
+  return pw::OkStatus();
+}
+
+}  // namespace pb::cloud::benchmark
@@ -0,0 +1,78 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file ledger_benchmark.h
+/// @brief Ledger latency and flash-wear measurements for any LedgerBackend.
+///
+/// Shared by ledger_benchmark_test (host, MockLedgerBackend, for regression
+/// tracking of the bytes written) and ledger_benchmark_device_test (P2,
+/// ParticleLedgerBackend, for the timings).
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "pb_cloud/ledger_backend.h"
+#include "pb_cloud/ledger_editor.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+
+namespace pb::cloud::benchmark {
+
+/// Ledger data sizes for the read/write latency sweep.
+inline constexpr std::array<size_t, 4> kDataSizes = {64, 512, 2048, 8192};
+
+/// Property counts for the editor commit sweep.
+inline constexpr std::array<size_t, 3> kPropertyCounts = {4, 16, 64};
+
+/// Repetitions averaged per sample.
+inline constexpr int kIterations = 5;
+
+/// Working memory for the benchmarks. Too large for a thread stack on
+/// device; make it static.
+struct Scratch {
+  std::array<std::byte, 2 * kDataSizes.back()> buffer;
+  std::array<PropertyEntry, kPropertyCounts.back()> properties;
+};
+
+/// Read and write latency for one ledger size.
+struct IoSample {
+  size_t data_size = 0;
+  uint32_t read_us = 0;   // Average LedgerHandle::Read()
+  uint32_t write_us = 0;  // Average LedgerHandle::Write()
+};
+
+/// Cost of changing one key with LedgerEditor.
+struct CommitSample {
+  size_t property_count = 0;
+  uint32_t commit_us = 0;      // Average Edit() + Set + Commit()
+  size_t bytes_rewritten = 0;  // Ledger bytes written per commit
+};
+
+/// Measure Read() and Write() of a `data_size` byte ledger.
+pw::Result<IoSample> MeasureReadWrite(LedgerBackend& backend,
+                                      std::string_view ledger,
+                                      size_t data_size,
+                                      Scratch& scratch);
+
+/// Measure a single-key update of a ledger with `property_count` integer
+/// properties.
+///
+/// Every ledger write replaces the whole blob, so `bytes_rewritten` is the
+/// data size the ledger reports after the commit.
+pw::Result<CommitSample> MeasureSingleKeyCommit(LedgerBackend& backend,
+                                                std::string_view ledger,
+                                                size_t property_count,
+                                                Scratch& scratch);
+
+/// Run both sweeps and log a report.
+///
+/// @return OkStatus, or the first measurement error
+pw::Status RunAndLog(LedgerBackend& backend,
+                     std::string_view ledger,
+                     Scratch& scratch);
+
+}  // namespace pb::cloud::benchmark
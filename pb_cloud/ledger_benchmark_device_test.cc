@@ -0,0 +1,57 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+/// @file ledger_benchmark_device_test.cc
+/// @brief Ledger latency and flash-wear report on P2.
+///
+/// Flash this to a P2 device and read the tables from the serial console.
+/// The benchmark overwrites the contents of "test-ledger".
+///
+/// Prerequisites:
+/// - Configure a device-to-cloud ledger "test-ledger" in Particle Console
+
+#include <chrono>
+
+#include "ledger_benchmark.h"
+#include "pb_cloud/particle_ledger_backend.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_unit_test/framework.h"
+
+// Particle system cloud header for spark_process()
+#include "system_cloud.h"
+
+// Thread yield for cooperative multitasking
+#include "concurrent_hal.h"
+
+#define PW_LOG_MODULE_NAME "ledger_bench"
+
+#include "pw_log/log.h"
+
+namespace {
+
+constexpr const char* kTestLedgerName = "test-ledger";
+
+// Too large for the test thread's stack
+pb::cloud::benchmark::Scratch scratch;
+
+TEST(LedgerBenchmarkDevice, Report) {
+  PW_LOG_INFO("Waiting for cloud connection...");
+  while (!spark_cloud_flag_connected()) {
+    spark_process();
+    os_thread_yield();
+  }
+
+  // Ledger configuration arrives shortly after connecting
+  auto wait_start = pw::chrono::SystemClock::now();
+  while (pw::chrono::SystemClock::now() - wait_start <
+         pw::chrono::SystemClock::for_at_least(std::chrono::seconds(10))) {
+    spark_process();
+    os_thread_yield();
+  }
+
+  auto& backend = pb::cloud::ParticleLedgerBackend::Instance();
+  EXPECT_EQ(pb::cloud::benchmark::RunAndLog(backend, kTestLedgerName, scratch),
+            pw::OkStatus());
+}
+
+}  // namespace
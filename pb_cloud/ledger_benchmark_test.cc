@@ -0,0 +1,54 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "ledger_benchmark.h"
+
+#include "mock_ledger_backend.h"
+#include "pw_unit_test/framework.h"
+
+namespace pb::cloud::benchmark {
+namespace {
+
+Scratch scratch;
+
+TEST(LedgerBenchmark, ReadWriteUsesRequestedSize) {
+  MockLedgerBackend backend;
+  for (size_t data_size : kDataSizes) {
+    auto sample = MeasureReadWrite(backend, "bench", data_size, scratch);
+    ASSERT_TRUE(sample.ok());
+    EXPECT_EQ(sample.value().data_size, data_size);
+  }
+}
+
+TEST(LedgerBenchmark, SingleKeyCommitRewritesWholeLedger) {
+  MockLedgerBackend backend;
+  size_t previous = 0;
+  for (size_t count : kPropertyCounts) {
+    const size_t writes_before = backend.write_count();
+    auto sample = MeasureSingleKeyCommit(backend, "bench", count, scratch);
+    ASSERT_TRUE(sample.ok());
+    EXPECT_EQ(sample.value().property_count, count);
+    EXPECT_GT(sample.value().bytes_rewritten, previous);
+    previous = sample.value().bytes_rewritten;
+
+    // Setup write + populate commit + one commit per iteration
+    EXPECT_EQ(backend.write_count() - writes_before,
+              2u + static_cast<size_t>(kIterations));
+  }
+}
+
+TEST(LedgerBenchmark, RejectsTooManyProperties) {
+  MockLedgerBackend backend;
+  EXPECT_EQ(MeasureSingleKeyCommit(
+                backend, "bench", scratch.properties.size() + 1, scratch)
+                .status(),
+            pw::Status::InvalidArgument());
+}
+
+TEST(LedgerBenchmark, RunAndLog) {
+  MockLedgerBackend backend;
+  EXPECT_EQ(RunAndLog(backend, "bench", scratch), pw::OkStatus());
+}
+
+}  // namespace
+}  // namespace pb::cloud::benchmark
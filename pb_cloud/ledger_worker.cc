@@ -0,0 +1,189 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#define PW_LOG_MODULE_NAME "pb_ledger"
+#define PW_LOG_LEVEL PB_CLOUD_LOG_LEVEL
+
+#include "pb_cloud/ledger_worker.h"
+
+#include <mutex>
+#include <utility>
+
+#include "pw_log/log.h"
+
+namespace pb::cloud {
+
+LedgerWorker::~LedgerWorker() {
+  Stop();
+  CancelQueued();  // If never started
+}
+
+pw::Status LedgerWorker::Start(const pw::thread::Options& options) {
+  if (started_) {
+    return pw::Status::FailedPrecondition();
+  }
+  {
+    std::lock_guard lock(lock_);
+    stop_ = false;
+  }
+  thread_ = pw::Thread(options, [this]() { Run(); });
+  started_ = true;
+  return pw::OkStatus();
+}
+
+void LedgerWorker::Stop() {
+  if (!started_) {
+    return;
+  }
+  {
+    std::lock_guard lock(lock_);
+    stop_ = true;
+  }
+  notification_.release();
+  thread_.join();
+  started_ = false;
+  CancelQueued();
+}
+
+LedgerReadFuture LedgerWorker::ReadAsync(std::string_view name,
+                                         pw::ByteSpan buffer) {
+  LedgerReadFuture future;
+  {
+    std::lock_guard lock(lock_);
+    Request* request = Enqueue();
+    if (request == nullptr) {
+      return LedgerReadFuture::Resolved(pw::Status::ResourceExhausted());
+    }
+    request->op = Op::kRead;
+    request->name = pw::InlineString<kMaxLedgerNameSize>(name);
+    request->buffer = buffer;
+    future = request->read_provider.Get();
+  }
+  notification_.release();
+  return future;
+}
+
+LedgerStatusFuture LedgerWorker::WriteAsync(std::string_view name,
+                                            pw::ConstByteSpan data) {
+  LedgerStatusFuture future;
+  {
+    std::lock_guard lock(lock_);
+    Request* request = Enqueue();
+    if (request == nullptr) {
+      return LedgerStatusFuture::Resolved(pw::Status::ResourceExhausted());
+    }
+    request->op = Op::kWrite;
+    request->name = pw::InlineString<kMaxLedgerNameSize>(name);
+    request->data = data;
+    future = request->status_provider.Get();
+  }
+  notification_.release();
+  return future;
+}
+
+LedgerStatusFuture LedgerWorker::CommitAsync(LedgerEditor& editor) {
+  LedgerStatusFuture future;
+  {
+    std::lock_guard lock(lock_);
+    Request* request = Enqueue();
+    if (request == nullptr) {
+      return LedgerStatusFuture::Resolved(pw::Status::ResourceExhausted());
+    }
+    request->op = Op::kCommit;
+    request->editor = &editor;
+    future = request->status_provider.Get();
+  }
+  notification_.release();
+  return future;
+}
+
+size_t LedgerWorker::RunPending() {
+  size_t ran = 0;
+  while (true) {
+    Request* request = nullptr;
+    {
+      std::lock_guard lock(lock_);
+      if (count_ == 0 || stop_) {
+        break;
+      }
+      request = &queue_[head_];
+    }
+
+    // The slot stays reserved while the flash access runs unlocked
+    Execute(*request);
+    ++ran;
+
+    std::lock_guard lock(lock_);
+    head_ = (head_ + 1) % queue_.size();
+    --count_;
+  }
+  return ran;
+}
+
+LedgerWorker::Request* LedgerWorker::Enqueue() {
+  if (count_ >= queue_.size()) {
+    PW_LOG_WARN("LedgerWorker: queue full");
+    return nullptr;
+  }
+  Request& request = queue_[(head_ + count_) % queue_.size()];
+  request.name.clear();
+  request.buffer = {};
+  request.data = {};
+  request.editor = nullptr;
+  ++count_;
+  return &request;
+}
+
+void LedgerWorker::Execute(Request& request) {
+  if (request.op == Op::kCommit) {
+    request.status_provider.Resolve(request.editor->Commit());
+    return;
+  }
+
+  auto handle = backend_.GetLedger(request.name);
+  if (!handle.ok()) {
+    Cancel(request, handle.status());
+    return;
+  }
+  if (request.op == Op::kRead) {
+    request.read_provider.Resolve(handle.value().Read(request.buffer));
+  } else {
+    request.status_provider.Resolve(handle.value().Write(request.data));
+  }
+}
+
+void LedgerWorker::Cancel(Request& request, pw::Status status) {
+  if (request.op == Op::kRead) {
+    request.read_provider.Resolve(status);
+  } else {
+    request.status_provider.Resolve(status);
+  }
+}
+
+void LedgerWorker::CancelQueued() {
+  std::lock_guard lock(lock_);
+  while (count_ > 0) {
+    Cancel(queue_[head_], pw::Status::Cancelled());
+    head_ = (head_ + 1) % queue_.size();
+    --count_;
+  }
+}
+
+void LedgerWorker::Run() {
+  PW_LOG_INFO("LedgerWorker: started");
+  while (true) {
+    {
+      std::lock_guard lock(lock_);
+      if (stop_) {
+        break;
+      }
+    }
+    if (RunPending() == 0) {
+      // Nothing queued - sleep until an operation is added or Stop()
+      notification_.acquire();
+    }
+  }
+  PW_LOG_INFO("LedgerWorker: stopped");
+}
+
+}  // namespace pb::cloud
@@ -0,0 +1,78 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_cloud/ledger_worker.h"
+
+#include <array>
+#include <cstring>
+
+#include "mock_ledger_backend.h"
+#include "pw_unit_test/framework.h"
+
+namespace pb::cloud {
+namespace {
+
+constexpr std::array<std::byte, 4> kData = {
+    std::byte{0xa1}, std::byte{0x61}, std::byte{'a'}, std::byte{0x01}};
+
+TEST(LedgerWorker, WriteRunsOnWorker) {
+  MockLedgerBackend backend;
+  LedgerWorker worker(backend);
+
+  auto future = worker.WriteAsync("test", kData);
+  EXPECT_EQ(backend.write_count(), 0u);
+
+  EXPECT_EQ(worker.RunPending(), 1u);
+  EXPECT_EQ(backend.write_count(), 1u);
+  EXPECT_EQ(backend.GetPropertyInt("test", "a", 0), 1);
+}
+
+TEST(LedgerWorker, OperationsRunInOrder) {
+  MockLedgerBackend backend;
+  LedgerWorker worker(backend);
+
+  std::array<std::byte, 16> buffer{};
+  auto write = worker.WriteAsync("test", kData);
+  auto read = worker.ReadAsync("test", buffer);
+
+  EXPECT_EQ(worker.RunPending(), 2u);
+  EXPECT_EQ(std::memcmp(buffer.data(), kData.data(), kData.size()), 0);
+  EXPECT_EQ(worker.RunPending(), 0u);
+}
+
+TEST(LedgerWorker, CommitsEditor) {
+  MockLedgerBackend backend;
+  LedgerWorker worker(backend);
+
+  auto handle = backend.GetLedger("test");
+  ASSERT_TRUE(handle.ok());
+  std::array<std::byte, 256> buffer{};
+  auto editor = handle.value().Edit(buffer);
+  ASSERT_TRUE(editor.ok());
+  ASSERT_TRUE(editor.value().SetInt("count", 7).ok());
+
+  auto future = worker.CommitAsync(editor.value());
+  EXPECT_EQ(backend.GetPropertyInt("test", "count", 0), 0);
+
+  EXPECT_EQ(worker.RunPending(), 1u);
+  EXPECT_EQ(backend.GetPropertyInt("test", "count", 0), 7);
+}
+
+TEST(LedgerWorker, RejectsOperationsWhenQueueFull) {
+  MockLedgerBackend backend;
+  LedgerWorker worker(backend);
+
+  std::array<LedgerStatusFuture, kMaxPendingLedgerOps> futures;
+  for (auto& future : futures) {
+    future = worker.WriteAsync("test", kData);
+  }
+  auto rejected = worker.WriteAsync("test", kData);
+
+  EXPECT_EQ(worker.RunPending(), kMaxPendingLedgerOps);
+  // Rewrites of the same data are skipped
+  EXPECT_EQ(backend.write_count(), 1u);
+  EXPECT_EQ(backend.skipped_write_count(), kMaxPendingLedgerOps - 1);
+}
+
+}  // namespace
+}  // namespace pb::cloud
@@ -0,0 +1,319 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_cloud/ledger_write_back.h"
+
+#include <algorithm>
+
+#include "pw_status/try.h"
+
+namespace pb::cloud {
+
+using pw::chrono::SystemClock;
+
+LedgerWriteBack::LedgerWriteBack(LedgerBackend& backend,
+                                 std::string_view ledger,
+                                 pw::ByteSpan edit_buffer,
+                                 const LedgerWriteBackOptions& options)
+    : backend_(backend),
+      ledger_(ledger),
+      edit_buffer_(edit_buffer),
+      options_(options) {
+  options_.max_dirty =
+      std::clamp(options_.max_dirty, size_t{1}, kMaxWriteBackEntries);
+}
+
+pw::Status LedgerWriteBack::SetBool(std::string_view key,
+                                    bool value,
+                                    Durability durability) {
+  if (key.size() > kMaxWriteBackKeySize) {
+    return pw::Status::InvalidArgument();
+  }
+  Entry entry;
+  entry.key = key;
+  entry.type = Type::kBool;
+  entry.bool_value = value;
+  return Stage(entry, durability);
+}
+
+pw::Status LedgerWriteBack::SetInt(std::string_view key,
+                                   int64_t value,
+                                   Durability durability) {
+  if (key.size() > kMaxWriteBackKeySize) {
+    return pw::Status::InvalidArgument();
+  }
+  Entry entry;
+  entry.key = key;
+  entry.type = Type::kInt;
+  entry.int_value = value;
+  return Stage(entry, durability);
+}
+
+pw::Status LedgerWriteBack::SetUint(std::string_view key,
+                                    uint64_t value,
+                                    Durability durability) {
+  if (key.size() > kMaxWriteBackKeySize) {
+    return pw::Status::InvalidArgument();
+  }
+  Entry entry;
+  entry.key = key;
+  entry.type = Type::kUint;
+  entry.uint_value = value;
+  return Stage(entry, durability);
+}
+
+pw::Status LedgerWriteBack::SetDouble(std::string_view key,
+                                      double value,
+                                      Durability durability) {
+  if (key.size() > kMaxWriteBackKeySize) {
+    return pw::Status::InvalidArgument();
+  }
+  Entry entry;
+  entry.key = key;
+  entry.type = Type::kDouble;
+  entry.double_value = value;
+  return Stage(entry, durability);
+}
+
+pw::Status LedgerWriteBack::SetString(std::string_view key,
+                                      std::string_view value,
+                                      Durability durability) {
+  if (key.size() > kMaxWriteBackKeySize ||
+      value.size() > kMaxWriteBackStringSize) {
+    return pw::Status::InvalidArgument();
+  }
+  Entry entry;
+  entry.type = Type::kString;
+  entry.key = key;
+  entry.string_value = value;
+  return Stage(entry, durability);
+}
+
+bool LedgerWriteBack::GetBool(std::string_view key, bool default_value) {
+  if (const Entry* entry = Find(key);
+      entry != nullptr && entry->type == Type::kBool) {
+    return entry->bool_value;
+  }
+  auto handle = backend_.GetLedger(std::string_view(ledger_));
+  return handle.ok() ? handle->GetBool(key, default_value) : default_value;
+}
+
+int64_t LedgerWriteBack::GetInt(std::string_view key, int64_t default_value) {
+  if (const Entry* entry = Find(key);
+      entry != nullptr && entry->type == Type::kInt) {
+    return entry->int_value;
+  }
+  auto handle = backend_.GetLedger(std::string_view(ledger_));
+  return handle.ok() ? handle->GetInt64(key, default_value) : default_value;
+}
+
+uint64_t LedgerWriteBack::GetUint(std::string_view key,
+                                  uint64_t default_value) {
+  if (const Entry* entry = Find(key);
+      entry != nullptr && entry->type == Type::kUint) {
+    return entry->uint_value;
+  }
+  auto handle = backend_.GetLedger(std::string_view(ledger_));
+  return handle.ok() ? handle->GetUint64(key, default_value) : default_value;
+}
+
+double LedgerWriteBack::GetDouble(std::string_view key, double default_value) {
+  if (const Entry* entry = Find(key);
+      entry != nullptr && entry->type == Type::kDouble) {
+    return entry->double_value;
+  }
+  auto handle = backend_.GetLedger(std::string_view(ledger_));
+  return handle.ok() ? handle->GetDouble(key, default_value) : default_value;
+}
+
+pw::Status LedgerWriteBack::Service(SystemClock::time_point now) {
+  if (dirty_count_ == 0 || next_commit() > now) {
+    return pw::OkStatus();
+  }
+  return Commit();
+}
+
+pw::Status LedgerWriteBack::Flush() {
+  if (dirty_count_ == 0) {
+    return pw::OkStatus();
+  }
+  return Commit();
+}
+
+SystemClock::time_point LedgerWriteBack::next_commit() const {
+  SystemClock::time_point next = SystemClock::time_point::max();
+  for (size_t i = 0; i < entry_count_; ++i) {
+    if (entries_[i].dirty) {
+      next = std::min(next, entries_[i].due);
+    }
+  }
+  return next;
+}
+
+pw::Status LedgerWriteBack::Stage(const Entry& value, Durability durability) {
+  Entry* entry = Find(std::string_view(value.key));
+  if (entry == nullptr) {
+    entry = Allocate();
+    if (entry == nullptr) {
+      // Every entry is pending: make room by committing them
+      if (!Commit().ok()) {
+        return pw::Status::ResourceExhausted();
+      }
+      entry = Allocate();
+    }
+    entry->key = value.key;
+    entry->type = value.type;
+    entry->dirty = false;
+  } else {
+    bool same = entry->type == value.type;
+    if (same) {
+      switch (value.type) {
+        case Type::kBool:
+          same = entry->bool_value == value.bool_value;
+          break;
+        case Type::kInt:
+          same = entry->int_value == value.int_value;
+          break;
+        case Type::kUint:
+          same = entry->uint_value == value.uint_value;
+          break;
+        case Type::kDouble:
+          same = entry->double_value == value.double_value;
+          break;
+        case Type::kString:
+          same = entry->string_value == value.string_value;
+          break;
+      }
+    }
+    if (same) {
+      // Nothing new to store; kImmediate still needs a pending value saved
+      if (durability == Durability::kImmediate && entry->dirty) {
+        return Commit();
+      }
+      return pw::OkStatus();
+    }
+  }
+
+  ++stats_.updates;
+  if (entry->dirty) {
+    ++stats_.absorbed;
+  }
+  entry->type = value.type;
+  entry->string_value = value.string_value;
+  switch (value.type) {
+    case Type::kBool:
+      entry->bool_value = value.bool_value;
+      break;
+    case Type::kInt:
+      entry->int_value = value.int_value;
+      break;
+    case Type::kUint:
+      entry->uint_value = value.uint_value;
+      break;
+    case Type::kDouble:
+      entry->double_value = value.double_value;
+      break;
+    case Type::kString:
+      break;
+  }
+
+  // The first unsaved update sets the deadline; later ones only shorten it
+  const SystemClock::time_point now = SystemClock::now();
+  SystemClock::time_point due = now;
+  if (durability == Durability::kDebounced) {
+    due = now + options_.debounce;
+  } else if (durability == Durability::kRelaxed) {
+    due = now + options_.max_delay;
+  }
+  if (!entry->dirty) {
+    entry->dirty = true;
+    entry->due = due;
+    ++dirty_count_;
+  } else {
+    entry->due = std::min(entry->due, due);
+  }
+
+  if (durability == Durability::kImmediate) {
+    return Commit();
+  }
+  if (dirty_count_ >= options_.max_dirty) {
+    // Failures are counted and retried by Service()
+    (void)Commit();
+  }
+  return pw::OkStatus();
+}
+
+LedgerWriteBack::Entry* LedgerWriteBack::Find(std::string_view key) {
+  for (size_t i = 0; i < entry_count_; ++i) {
+    if (std::string_view(entries_[i].key) == key) {
+      return &entries_[i];
+    }
+  }
+  return nullptr;
+}
+
+LedgerWriteBack::Entry* LedgerWriteBack::Allocate() {
+  if (entry_count_ < entries_.size()) {
+    return &entries_[entry_count_++];
+  }
+  for (Entry& entry : entries_) {
+    if (!entry.dirty) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+pw::Status LedgerWriteBack::Commit() {
+  const pw::Status status = CommitEntries();
+  if (status.ok()) {
+    for (size_t i = 0; i < entry_count_; ++i) {
+      entries_[i].dirty = false;
+    }
+    dirty_count_ = 0;
+    ++stats_.commits;
+    return pw::OkStatus();
+  }
+
+  ++stats_.failures;
+  const SystemClock::time_point retry = SystemClock::now() + options_.debounce;
+  for (size_t i = 0; i < entry_count_; ++i) {
+    if (entries_[i].dirty) {
+      entries_[i].due = std::max(entries_[i].due, retry);
+    }
+  }
+  return status;
+}
+
+pw::Status LedgerWriteBack::CommitEntries() {
+  PW_TRY_ASSIGN(LedgerHandle handle,
+                backend_.GetLedger(std::string_view(ledger_)));
+  PW_TRY_ASSIGN(auto editor, handle.Edit(edit_buffer_));
+  for (size_t i = 0; i < entry_count_; ++i) {
+    const Entry& entry = entries_[i];
+    if (!entry.dirty) {
+      continue;
+    }
+    const std::string_view key(entry.key);
+    switch (entry.type) {
+      case Type::kBool:
+        PW_TRY(editor.SetBool(key, entry.bool_value));
+        break;
+      case Type::kInt:
+        PW_TRY(editor.SetInt(key, entry.int_value));
+        break;
+      case Type::kUint:
+        PW_TRY(editor.SetUint(key, entry.uint_value));
+        break;
+      case Type::kDouble:
+        PW_TRY(editor.SetDouble(key, entry.double_value));
+        break;
+      case Type::kString:
+        PW_TRY(editor.SetString(key, std::string_view(entry.string_value)));
+        break;
+    }
+  }
+  return editor.Commit();
+}
+
+}  // namespace pb::cloud
@@ -0,0 +1,123 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_cloud/ledger_write_back.h"
+
+#include <array>
+
+#include "mock_ledger_backend.h"
+#include "pw_unit_test/framework.h"
+
+namespace pb::cloud {
+namespace {
+
+using pw::chrono::SystemClock;
+
+constexpr LedgerWriteBackOptions kOptions{
+    .debounce = SystemClock::for_at_least(std::chrono::seconds(10)),
+    .max_delay = SystemClock::for_at_least(std::chrono::minutes(15)),
+    .max_dirty = 4,
+};
+
+class LedgerWriteBackTest : public ::testing::Test {
+ protected:
+  MockLedgerBackend backend_;
+  std::array<std::byte, 512> buffer_{};
+  LedgerWriteBack state_{backend_, "state", buffer_, kOptions};
+};
+
+TEST_F(LedgerWriteBackTest, DebouncedUpdatesShareOneCommit) {
+  for (uint64_t i = 1; i <= 100; ++i) {
+    ASSERT_EQ(state_.SetUint("cycles", i), pw::OkStatus());
+  }
+  EXPECT_EQ(state_.Service(), pw::OkStatus());
+  EXPECT_EQ(backend_.write_count(), 0u);
+  EXPECT_EQ(state_.dirty_count(), 1u);
+
+  EXPECT_EQ(state_.Service(SystemClock::now() + kOptions.debounce),
+            pw::OkStatus());
+  EXPECT_EQ(backend_.write_count(), 1u);
+  EXPECT_EQ(backend_.GetPropertyUint("state", "cycles", 0), 100u);
+  EXPECT_EQ(state_.dirty_count(), 0u);
+
+  const LedgerWriteBackStats& stats = state_.stats();
+  EXPECT_EQ(stats.updates, 100u);
+  EXPECT_EQ(stats.absorbed, 99u);
+  EXPECT_EQ(stats.commits, 1u);
+}
+
+TEST_F(LedgerWriteBackTest, ImmediateCommitsEverythingPending) {
+  ASSERT_EQ(state_.SetUint("cycles", 7), pw::OkStatus());
+  ASSERT_EQ(state_.SetString("mode", "service", Durability::kImmediate),
+            pw::OkStatus());
+
+  EXPECT_EQ(backend_.write_count(), 1u);
+  EXPECT_EQ(backend_.GetPropertyUint("state", "cycles", 0), 7u);
+  EXPECT_EQ(state_.dirty_count(), 0u);
+}
+
+TEST_F(LedgerWriteBackTest, RelaxedWaitsForMaxDelay) {
+  ASSERT_EQ(state_.SetDouble("temperature", 21.5, Durability::kRelaxed),
+            pw::OkStatus());
+  EXPECT_EQ(state_.Service(SystemClock::now() + kOptions.debounce),
+            pw::OkStatus());
+  EXPECT_EQ(backend_.write_count(), 0u);
+
+  EXPECT_EQ(state_.Service(state_.next_commit()), pw::OkStatus());
+  EXPECT_EQ(backend_.write_count(), 1u);
+  EXPECT_EQ(state_.next_commit(), SystemClock::time_point::max());
+}
+
+TEST_F(LedgerWriteBackTest, DirtyThresholdCommits) {
+  ASSERT_EQ(state_.SetInt("a", 1, Durability::kRelaxed), pw::OkStatus());
+  ASSERT_EQ(state_.SetInt("b", 2, Durability::kRelaxed), pw::OkStatus());
+  ASSERT_EQ(state_.SetInt("c", 3, Durability::kRelaxed), pw::OkStatus());
+  EXPECT_EQ(backend_.write_count(), 0u);
+
+  ASSERT_EQ(state_.SetInt("d", 4, Durability::kRelaxed), pw::OkStatus());
+  EXPECT_EQ(backend_.write_count(), 1u);
+  EXPECT_EQ(backend_.GetPropertyInt("state", "d", 0), 4);
+}
+
+TEST_F(LedgerWriteBackTest, UnchangedValueIsNotAnUpdate) {
+  ASSERT_EQ(state_.SetBool("door_open", true), pw::OkStatus());
+  ASSERT_EQ(state_.Flush(), pw::OkStatus());
+  ASSERT_EQ(state_.SetBool("door_open", true), pw::OkStatus());
+
+  EXPECT_EQ(state_.dirty_count(), 0u);
+  EXPECT_EQ(state_.stats().updates, 1u);
+}
+
+TEST_F(LedgerWriteBackTest, ReadsPendingValuesFirst) {
+  backend_.SetProperty("state", "cycles", uint64_t{5});
+  backend_.SetProperty("state", "boots", uint64_t{2});
+
+  ASSERT_EQ(state_.SetUint("cycles", 6), pw::OkStatus());
+  EXPECT_EQ(state_.GetUint("cycles"), 6u);
+  EXPECT_EQ(state_.GetUint("boots"), 2u);
+  EXPECT_EQ(backend_.GetPropertyUint("state", "cycles", 0), 5u);
+}
+
+TEST_F(LedgerWriteBackTest, FailedCommitStaysPending) {
+  backend_.SetLoadProfile({.write_failure_per_mille = 1000});
+  ASSERT_EQ(state_.SetUint("cycles", 1), pw::OkStatus());
+  EXPECT_FALSE(state_.Flush().ok());
+  EXPECT_EQ(state_.dirty_count(), 1u);
+  EXPECT_EQ(state_.stats().failures, 1u);
+
+  backend_.SetLoadProfile({});
+  EXPECT_EQ(state_.Flush(), pw::OkStatus());
+  EXPECT_EQ(backend_.GetPropertyUint("state", "cycles", 0), 1u);
+}
+
+TEST_F(LedgerWriteBackTest, RejectsOversizedValues) {
+  EXPECT_EQ(state_.SetString("mode", std::string_view(
+                                         "a string longer than the limit of "
+                                         "the write-back table")),
+            pw::Status::InvalidArgument());
+  EXPECT_EQ(state_.SetInt("a_key_that_is_longer_than_32_bytes", 1),
+            pw::Status::InvalidArgument());
+}
+
+}  // namespace
+}  // namespace pb::cloud
@@ -0,0 +1,293 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_cloud/lz.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "pw_status/try.h"
+
+namespace pb::cloud {
+namespace {
+
+constexpr uint8_t kHeaderMagic = 0xB0;
+constexpr uint8_t kHeaderMagicMask = 0xF0;
+constexpr uint8_t kMaxDictionaryId = 0x0F;
+
+constexpr size_t kMinMatch = 3;
+constexpr size_t kMaxMatch = kMinMatch + 63;  // 6 length bits
+constexpr int kLengthBits = 6;
+
+// The part of the dictionary a back-reference can reach
+std::string_view ReachableDictionary(const LzDictionary& dictionary) {
+  const std::string_view data = dictionary.data;
+  return data.substr(data.size() - std::min(data.size(), kLzWindowSize));
+}
+
+// Checks the header byte against the expected dictionary.
+pw::Status CheckHeader(std::byte header, const LzDictionary& dictionary) {
+  const auto value = static_cast<uint8_t>(header);
+  if ((value & kHeaderMagicMask) != kHeaderMagic) {
+    return pw::Status::DataLoss();
+  }
+  if ((value & kMaxDictionaryId) != dictionary.id) {
+    return pw::Status::InvalidArgument();
+  }
+  return pw::OkStatus();
+}
+
+// The dictionary followed by the input, as one sequence for the match
+// search
+class Source {
+ public:
+  Source(std::string_view dictionary, pw::ConstByteSpan input)
+      : dictionary_(dictionary), input_(input) {}
+
+  size_t start() const { return dictionary_.size(); }
+  size_t end() const { return dictionary_.size() + input_.size(); }
+
+  std::byte operator[](size_t index) const {
+    return index < dictionary_.size()
+               ? static_cast<std::byte>(dictionary_[index])
+               : input_[index - dictionary_.size()];
+  }
+
+ private:
+  std::string_view dictionary_;
+  pw::ConstByteSpan input_;
+};
+
+}  // namespace
+
+pw::Result<size_t> LzCompress(pw::ConstByteSpan input,
+                              pw::ByteSpan output,
+                              const LzDictionary& dictionary) {
+  if (dictionary.id > kMaxDictionaryId) {
+    return pw::Status::InvalidArgument();
+  }
+  if (output.empty()) {
+    return pw::Status::ResourceExhausted();
+  }
+  output[0] = static_cast<std::byte>(kHeaderMagic | dictionary.id);
+  size_t out = 1;
+
+  const Source source(ReachableDictionary(dictionary), input);
+  size_t flags_at = 0;
+  int flag_bit = 8;  // Items in the current flag byte
+  size_t pos = source.start();
+  while (pos < source.end()) {
+    // Longest match, nearest first. Matches may overlap the current
+    // position (runs), since the decoder copies byte by byte.
+    size_t best_length = 0;
+    size_t best_distance = 0;
+    const size_t max_length = std::min(kMaxMatch, source.end() - pos);
+    if (max_length >= kMinMatch) {
+      const std::byte first = source[pos];
+      const size_t window_start = pos - std::min(pos, kLzWindowSize);
+      for (size_t candidate = pos; candidate-- > window_start;) {
+        if (source[candidate] != first ||
+            source[candidate + best_length] != source[pos + best_length]) {
+          continue;
+        }
+        size_t length = 1;
+        while (length < max_length &&
+               source[candidate + length] == source[pos + length]) {
+          ++length;
+        }
+        if (length > best_length) {
+          best_length = length;
+          best_distance = pos - candidate;
+          if (length == max_length) {
+            break;
+          }
+        }
+      }
+    }
+
+    const bool match = best_length >= kMinMatch;
+    const size_t item_size = match ? 2 : 1;
+    if (flag_bit == 8) {
+      if (out == output.size()) {
+        return pw::Status::ResourceExhausted();
+      }
+      flags_at = out++;
+      output[flags_at] = std::byte{0};
+      flag_bit = 0;
+    }
+    if (output.size() - out < item_size) {
+      return pw::Status::ResourceExhausted();
+    }
+    if (match) {
+      output[flags_at] |= static_cast<std::byte>(1u << flag_bit);
+      const auto token = static_cast<uint16_t>(
+          (best_distance - 1) << kLengthBits | (best_length - kMinMatch));
+      output[out++] = static_cast<std::byte>(token >> 8);
+      output[out++] = static_cast<std::byte>(token & 0xFF);
+      pos += best_length;
+    } else {
+      output[out++] = source[pos++];
+    }
+    ++flag_bit;
+  }
+  return out;
+}
+
+pw::Result<size_t> LzDecompress(pw::ConstByteSpan input,
+                                pw::ByteSpan output,
+                                const LzDictionary& dictionary) {
+  if (input.empty()) {
+    return pw::Status::DataLoss();
+  }
+  if (pw::Status status = CheckHeader(input[0], dictionary); !status.ok()) {
+    return status;
+  }
+  const std::string_view dict = ReachableDictionary(dictionary);
+
+  size_t in = 1;
+  size_t out = 0;
+  while (in < input.size()) {
+    const auto flags = static_cast<uint8_t>(input[in++]);
+    for (int bit = 0; bit < 8 && in < input.size(); ++bit) {
+      if ((flags & (1u << bit)) == 0) {
+        if (out == output.size()) {
+          return pw::Status::ResourceExhausted();
+        }
+        output[out++] = input[in++];
+        continue;
+      }
+      if (input.size() - in < 2) {
+        return pw::Status::DataLoss();
+      }
+      const auto token = static_cast<uint16_t>(
+          static_cast<uint16_t>(input[in]) << 8 |
+          static_cast<uint16_t>(input[in + 1]));
+      in += 2;
+      const size_t distance = (token >> kLengthBits) + 1u;
+      const size_t length = (token & ((1u << kLengthBits) - 1)) + kMinMatch;
+      if (distance > out + dict.size()) {
+        return pw::Status::DataLoss();
+      }
+      if (output.size() - out < length) {
+        return pw::Status::ResourceExhausted();
+      }
+      for (size_t i = 0; i < length; ++i, ++out) {
+        output[out] = distance > out ? static_cast<std::byte>(
+                                           dict[dict.size() - (distance - out)])
+                                     : output[out - distance];
+      }
+    }
+  }
+  return out;
+}
+
+// ---------------------------------------------------------------------------
+// LzDecoder
+// ---------------------------------------------------------------------------
+
+LzDecoder::LzDecoder(const LzDictionary& dictionary)
+    : dictionary_(dictionary) {
+  Reset();
+}
+
+void LzDecoder::Reset() {
+  const std::string_view dict = ReachableDictionary(dictionary_);
+  std::memcpy(window_.data(), dict.data(), dict.size());
+  history_ = dict.size();
+  position_ = dict.size() % kLzWindowSize;
+  bytes_written_ = 0;
+  state_ = State::kHeader;
+  items_left_ = 0;
+  pending_size_ = 0;
+}
+
+pw::Status LzDecoder::Write(pw::ConstByteSpan input,
+                            pw::stream::Writer& output) {
+  for (std::byte byte : input) {
+    switch (state_) {
+      case State::kError:
+        return pw::Status::FailedPrecondition();
+
+      case State::kHeader:
+        if (pw::Status status = CheckHeader(byte, dictionary_); !status.ok()) {
+          state_ = State::kError;
+          return status;
+        }
+        state_ = State::kFlags;
+        break;
+
+      case State::kFlags:
+        flags_ = static_cast<uint8_t>(byte);
+        items_left_ = 8;
+        state_ = State::kItem;
+        break;
+
+      case State::kItem:
+        if ((flags_ & 1u) == 0) {
+          PW_TRY(Put(byte, output));
+          state_ = --items_left_ == 0 ? State::kFlags : State::kItem;
+          flags_ >>= 1;
+        } else {
+          match_high_ = static_cast<uint8_t>(byte);
+          state_ = State::kMatch;
+        }
+        break;
+
+      case State::kMatch: {
+        const auto token = static_cast<uint16_t>(
+            match_high_ << 8 | static_cast<uint8_t>(byte));
+        const size_t distance = (token >> kLengthBits) + 1u;
+        const size_t length = (token & ((1u << kLengthBits) - 1)) + kMinMatch;
+        if (distance > history_) {
+          state_ = State::kError;
+          return pw::Status::DataLoss();
+        }
+        for (size_t i = 0; i < length; ++i) {
+          PW_TRY(Put(window_[(position_ + kLzWindowSize - distance) %
+                             kLzWindowSize],
+                     output));
+        }
+        state_ = --items_left_ == 0 ? State::kFlags : State::kItem;
+        flags_ >>= 1;
+        break;
+      }
+    }
+  }
+  return FlushPending(output);
+}
+
+pw::Status LzDecoder::Finish() const {
+  if (state_ == State::kHeader || state_ == State::kMatch ||
+      state_ == State::kError) {
+    return pw::Status::DataLoss();
+  }
+  return pw::OkStatus();
+}
+
+pw::Status LzDecoder::Put(std::byte byte, pw::stream::Writer& output) {
+  window_[position_] = byte;
+  position_ = (position_ + 1) % kLzWindowSize;
+  history_ = std::min(history_ + 1, kLzWindowSize);
+  ++bytes_written_;
+
+  pending_[pending_size_++] = byte;
+  if (pending_size_ == pending_.size()) {
+    return FlushPending(output);
+  }
+  return pw::OkStatus();
+}
+
+pw::Status LzDecoder::FlushPending(pw::stream::Writer& output) {
+  if (pending_size_ == 0) {
+    return pw::OkStatus();
+  }
+  pw::Status status =
+      output.Write(pw::ConstByteSpan(pending_.data(), pending_size_));
+  pending_size_ = 0;
+  if (!status.ok()) {
+    state_ = State::kError;
+  }
+  return status;
+}
+
+}  // namespace pb::cloud
@@ -0,0 +1,252 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_cloud/lz.h"
+
+#include <array>
+#include <cstring>
+#include <string_view>
+
+#include "pb_cloud/cbor.h"
+#include "pb_cloud/compressed_serializer.h"
+#include "pw_log/log.h"
+#include "pw_stream/memory_stream.h"
+#include "pw_string/string.h"
+#include "pw_unit_test/framework.h"
+
+namespace pb::cloud {
+namespace {
+
+constexpr std::string_view kTelemetry =
+    R"({"temperature":21.5,"humidity":45,"pressure_pa":96512,)"
+    R"("battery_mv":3912,"readings":[{"temperature":21.4,"humidity":44},)"
+    R"({"temperature":21.5,"humidity":45},)"
+    R"({"temperature":21.5,"humidity":46}]})";
+
+inline constexpr LzDictionary kTelemetryKeys{
+    .id = 1,
+    .data = R"("pressure_pa":"battery_mv":"readings":[{"temperature":)"
+            R"(,"humidity":)"};
+
+pw::ConstByteSpan Bytes(std::string_view text) {
+  return pw::as_bytes(pw::span(text.data(), text.size()));
+}
+
+std::string_view Text(pw::ConstByteSpan bytes) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return std::string_view(reinterpret_cast<const char*>(bytes.data()),
+                          bytes.size());
+}
+
+// Compresses and decompresses `input`, returns the compressed size
+size_t RoundTrip(std::string_view input,
+                 const LzDictionary& dictionary = kNoLzDictionary) {
+  std::array<std::byte, LzMaxCompressedSize(1024)> compressed;
+  auto size = LzCompress(Bytes(input), compressed, dictionary);
+  EXPECT_EQ(size.status(), pw::OkStatus());
+  if (!size.ok()) {
+    return 0;
+  }
+  EXPECT_LE(size.value(), LzMaxCompressedSize(input.size()));
+
+  std::array<std::byte, 1024> output;
+  auto restored = LzDecompress(
+      pw::ConstByteSpan(compressed).first(size.value()), output, dictionary);
+  EXPECT_EQ(restored.status(), pw::OkStatus());
+  if (restored.ok()) {
+    EXPECT_EQ(Text(pw::ConstByteSpan(output).first(restored.value())), input);
+  }
+  return size.value();
+}
+
+TEST(Lz, RoundTrips) {
+  EXPECT_EQ(RoundTrip(""), 1u);  // Header only
+  EXPECT_GT(RoundTrip("a"), 0u);
+  EXPECT_GT(RoundTrip("abcabcabcabcabcabc"), 0u);
+  EXPECT_LT(RoundTrip(std::string_view(
+                "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx"
+                "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx")),
+            10u);
+
+  const size_t compressed = RoundTrip(kTelemetry);
+  PW_LOG_INFO("Telemetry JSON: %u -> %u bytes",
+              static_cast<unsigned>(kTelemetry.size()),
+              static_cast<unsigned>(compressed));
+  EXPECT_LT(compressed, kTelemetry.size());
+}
+
+TEST(Lz, DictionaryShrinksSmallPayloads) {
+  constexpr std::string_view kSmall =
+      R"({"temperature":21.5,"humidity":45,"battery_mv":3912})";
+  const size_t plain = RoundTrip(kSmall);
+  const size_t with_dictionary = RoundTrip(kSmall, kTelemetryKeys);
+  PW_LOG_INFO("%u bytes: %u without, %u with dictionary",
+              static_cast<unsigned>(kSmall.size()),
+              static_cast<unsigned>(plain),
+              static_cast<unsigned>(with_dictionary));
+  EXPECT_GE(plain, kSmall.size());  // Too short to repeat itself
+  EXPECT_LT(with_dictionary, kSmall.size() / 2);
+}
+
+TEST(Lz, IncompressibleDataStaysWithinBound) {
+  std::array<std::byte, 256> input;
+  uint32_t state = 12345;
+  for (std::byte& b : input) {
+    state = state * 1103515245u + 12345u;
+    b = static_cast<std::byte>(state >> 16);
+  }
+  std::array<std::byte, LzMaxCompressedSize(256)> compressed;
+  auto size = LzCompress(input, compressed);
+  ASSERT_EQ(size.status(), pw::OkStatus());
+  EXPECT_LE(size.value(), compressed.size());
+
+  std::array<std::byte, LzMaxCompressedSize(256) - 40> too_small;
+  EXPECT_EQ(LzCompress(input, too_small).status(),
+            pw::Status::ResourceExhausted());
+}
+
+TEST(Lz, RejectsCorruptData) {
+  std::array<std::byte, 128> compressed;
+  auto size = LzCompress(Bytes(kTelemetry.substr(0, 100)), compressed);
+  ASSERT_EQ(size.status(), pw::OkStatus());
+  std::array<std::byte, 128> output;
+
+  // Bad header
+  std::array<std::byte, 128> corrupt = compressed;
+  corrupt[0] = std::byte{0x00};
+  EXPECT_EQ(LzDecompress(pw::ConstByteSpan(corrupt).first(size.value()), output)
+                .status(),
+            pw::Status::DataLoss());
+
+  // A match reaching before the start of the data
+  constexpr std::array<std::byte, 4> kBadMatch = {
+      std::byte{0xB0}, std::byte{0x01}, std::byte{0xFF}, std::byte{0xC0}};
+  EXPECT_EQ(LzDecompress(kBadMatch, output).status(), pw::Status::DataLoss());
+
+  // Truncated in the middle of a match
+  EXPECT_EQ(LzDecompress(pw::ConstByteSpan(kBadMatch).first(3), output)
+                .status(),
+            pw::Status::DataLoss());
+
+  // Output too small
+  EXPECT_EQ(LzDecompress(pw::ConstByteSpan(compressed).first(size.value()),
+                         pw::ByteSpan(output).first(50))
+                .status(),
+            pw::Status::ResourceExhausted());
+}
+
+TEST(Lz, DetectsDictionaryMismatch) {
+  std::array<std::byte, 128> compressed;
+  auto size = LzCompress(Bytes(R"({"humidity":45})"), compressed,
+                         kTelemetryKeys);
+  ASSERT_EQ(size.status(), pw::OkStatus());
+  std::array<std::byte, 128> output;
+  EXPECT_EQ(
+      LzDecompress(pw::ConstByteSpan(compressed).first(size.value()), output)
+          .status(),
+      pw::Status::InvalidArgument());
+
+  constexpr LzDictionary kBadId{.id = 16, .data = "x"};
+  EXPECT_EQ(LzCompress(Bytes("x"), compressed, kBadId).status(),
+            pw::Status::InvalidArgument());
+}
+
+TEST(LzDecoder, DecodesByteByByte) {
+  std::array<std::byte, LzMaxCompressedSize(512)> compressed;
+  auto size = LzCompress(Bytes(kTelemetry), compressed, kTelemetryKeys);
+  ASSERT_EQ(size.status(), pw::OkStatus());
+
+  std::array<std::byte, 512> output;
+  pw::stream::MemoryWriter writer(output);
+  LzDecoder decoder(kTelemetryKeys);
+  for (std::byte b : pw::ConstByteSpan(compressed).first(size.value())) {
+    ASSERT_EQ(decoder.Write(pw::ConstByteSpan(&b, 1), writer), pw::OkStatus());
+  }
+  EXPECT_EQ(decoder.Finish(), pw::OkStatus());
+  EXPECT_EQ(decoder.bytes_written(), kTelemetry.size());
+  EXPECT_EQ(Text(writer.WrittenData()), kTelemetry);
+
+  // Reusable after Reset()
+  decoder.Reset();
+  writer.clear();
+  ASSERT_EQ(decoder.Write(pw::ConstByteSpan(compressed).first(size.value()),
+                          writer),
+            pw::OkStatus());
+  EXPECT_EQ(Text(writer.WrittenData()), kTelemetry);
+}
+
+TEST(LzDecoder, FinishDetectsTruncation) {
+  std::array<std::byte, 16> output;
+  pw::stream::MemoryWriter writer(output);
+  LzDecoder decoder;
+  EXPECT_EQ(decoder.Finish(), pw::Status::DataLoss());  // No header
+
+  constexpr std::array<std::byte, 3> kHalfMatch = {
+      std::byte{0xB0}, std::byte{0x01}, std::byte{0x00}};
+  ASSERT_EQ(decoder.Write(kHalfMatch, writer), pw::OkStatus());
+  EXPECT_EQ(decoder.Finish(), pw::Status::DataLoss());
+}
+
+// Test payload that owns its text, as CompressedSerializer requires
+using Text256 = pw::InlineString<256>;
+
+struct TextSerializer {
+  static pw::Result<size_t> Serialize(const Text256& value,
+                                      pw::ByteSpan buffer) {
+    if (buffer.size() < value.size()) {
+      return pw::Status::ResourceExhausted();
+    }
+    std::memcpy(buffer.data(), value.data(), value.size());
+    return value.size();
+  }
+
+  static pw::Result<Text256> Deserialize(pw::ConstByteSpan data) {
+    if (data.size() > Text256::max_size()) {
+      return pw::Status::ResourceExhausted();
+    }
+    return Text256(Text(data));
+  }
+
+  static constexpr ContentType kContentType = ContentType::kText;
+};
+
+TEST(CompressedSerializer, RoundTrip) {
+  using Ser = CompressedSerializer<TextSerializer, kTelemetryKeys, 256>;
+  const Text256 value(kTelemetry);
+
+  std::array<std::byte, 256> buffer;
+  auto size = Ser::Serialize(value, buffer);
+  ASSERT_EQ(size.status(), pw::OkStatus());
+  EXPECT_LT(size.value(), kTelemetry.size());
+  EXPECT_EQ(Ser::kContentType, ContentType::kBinary);
+
+  auto restored =
+      Ser::Deserialize(pw::ConstByteSpan(buffer).first(size.value()));
+  ASSERT_EQ(restored.status(), pw::OkStatus());
+  EXPECT_EQ(std::string_view(restored.value()), kTelemetry);
+}
+
+TEST(CompressedLedgerSerializer, StoresCborMap) {
+  using Ser = CompressedLedgerSerializer<TextSerializer, kTelemetryKeys, 256>;
+  const Text256 value(kTelemetry);
+
+  std::array<std::byte, 256> buffer;
+  auto size = Ser::Serialize(value, buffer);
+  ASSERT_EQ(size.status(), pw::OkStatus());
+
+  cbor::Decoder decoder(pw::ConstByteSpan(buffer).first(size.value()));
+  ASSERT_EQ(decoder.Validate(), pw::OkStatus());
+  EXPECT_EQ(decoder.ReadMapHeader().value(), 1u);
+  EXPECT_EQ(decoder.ReadKeyView().value(), "lz");
+  auto bytes = decoder.ReadBytesView();
+  ASSERT_EQ(bytes.status(), pw::OkStatus());
+  EXPECT_FALSE(decoder.HasNext());
+
+  auto restored =
+      Ser::Deserialize(pw::ConstByteSpan(buffer).first(size.value()));
+  ASSERT_EQ(restored.status(), pw::OkStatus());
+  EXPECT_EQ(std::string_view(restored.value()), kTelemetry);
+}
+
+}  // namespace
+}  // namespace pb::cloud
@@ -27,18 +27,50 @@
 /// EXPECT_EQ(mock.last_published().name, "test");
 /// mock.SimulatePublishSuccess();
 /// @endcode
+///
+/// Load tests: with a MockCloudLoadProfile the mock acks publishes by itself
+/// after a simulated latency, fails a share of them and enforces a publish
+/// rate limit. Time is simulated and advanced by the test, so an hour of
+/// traffic runs in milliseconds and only the code under test costs CPU:
+/// @code
+/// mock.SetLoadProfile({.ack_latency_ms = 300, .ack_jitter_ms = 200,
+///                      .ack_failure_per_mille = 10,
+///                      .rate_limit_per_s = 1, .rate_limit_burst = 4});
+/// auto future = mock.Publish("test", data, {});
+/// mock.AdvanceTime(1000);  // Acks every publish that is due
+/// @endcode
 
+#include <algorithm>
 #include <array>
 #include <cstring>
+#include <optional>
 
+#include "mock_load.h"
 #include "pb_cloud/cloud_backend.h"
 #include "pw_assert/check.h"
+#include "pw_status/try.h"
 
 namespace pb::cloud {
 
 /// Default channel capacity for mock event buffering.
 inline constexpr uint16_t kMockEventChannelCapacity = 8;
 
+/// Simulated network behaviour of MockCloudBackend::SetLoadProfile().
+struct MockCloudLoadProfile {
+  uint32_t ack_latency_ms = 0;  ///< Time from Publish() to its ack
+  uint32_t ack_jitter_ms = 0;   ///< Uniform extra latency in [0, jitter]
+  uint32_t ack_failure_per_mille = 0;  ///< Share of publishes that fail
+  pw::Status ack_failure = pw::Status::Unknown();  ///< Their status
+
+  /// Publishes per second before Publish() resolves Unavailable (like a
+  /// publish Device OS can't start); 0 for no limit. Particle allows one
+  /// per second on average.
+  uint32_t rate_limit_per_s = 0;
+  uint32_t rate_limit_burst = 1;  ///< Publishes allowed back to back
+
+  uint32_t seed = 1;  ///< Seed of jitter and failures
+};
+
 /// Mock cloud backend for testing.
 ///
 /// Follows the MockNfcReader pattern with:
@@ -51,6 +83,14 @@ class MockCloudBackend : public CloudBackend {
 
   // -- CloudBackend Interface --
 
+  bool IsConnected() const override { return connected_; }
+
+  /// Counters as the Particle backend keeps them. Publish latency is in
+  /// simulated time and only recorded with a load profile; function time
+  /// isn't measured.
+  CloudStats stats() const override { return stats_; }
+  void ResetStats() override { stats_ = {}; }
+
   PublishFuture Publish(std::string_view name,
                         pw::ConstByteSpan data,
                         const PublishOptions& options) override {
@@ -61,14 +101,59 @@ class MockCloudBackend : public CloudBackend {
     std::memcpy(last_published_.data.data(), data.data(), copy_len);
     last_published_.options = options;
     ++publish_count_;
-
-    return publish_provider_.Get();
+    ++stats_.publishes;
+
+    // Like the Particle backend, a publish takes a slot until it completes,
+    // and the last kHighPriorityPublishSlots are kept for kHigh
+    auto slot = std::find_if(publish_slots_.begin(), publish_slots_.end(),
+                             [](const PublishSlot& s) { return !s.in_flight; });
+    if (slot == publish_slots_.end() ||
+        (options.priority != PublishPriority::kHigh &&
+         kMaxPendingPublishes - pending_publish_count() <=
+             kHighPriorityPublishSlots)) {
+      ++stats_.publish_busy;
+      return PublishFuture::Resolved(pw::Status::ResourceExhausted());
+    }
+    if (load_profile_.has_value() && !TakeRateToken()) {
+      ++stats_.publish_unavailable;
+      ++rate_limited_count_;
+      return PublishFuture::Resolved(pw::Status::Unavailable());
+    }
+    slot->in_flight = true;
+    slot->sequence = ++publish_sequence_;
+    slot->timed = load_profile_.has_value();
+    if (slot->timed) {
+      slot->start_ms = now_ms_;
+      slot->due_ms = now_ms_ + load_profile_->ack_latency_ms +
+                     random_.UpTo(load_profile_->ack_jitter_ms);
+      slot->outcome = random_.Chance(load_profile_->ack_failure_per_mille)
+                          ? load_profile_->ack_failure
+                          : pw::OkStatus();
+    }
+    return slot->provider.Get();
   }
+  using CloudBackend::Publish;
 
+  /// Replaces the previous Subscribe(prefix) subscription, like the
+  /// Particle backend.
   EventReceiver Subscribe(std::string_view prefix) override {
-    subscription_prefix_ = pw::InlineString<kMaxEventNameSize>(prefix);
-    return CreateSubscriptionReceiver();
+    for (Subscription& sub : subscriptions_) {
+      if (sub.uses_default_storage) {
+        EndSubscription(sub);
+      }
+    }
+    auto [handle, sender, receiver] =
+        pw::async2::CreateSpscChannel<ReceivedEvent>(event_channel_storage_);
+    if (Subscription* sub = AddSubscription(prefix); sub != nullptr) {
+      sub->handle = std::move(handle);
+      sub->sender = std::move(sender);
+      sub->uses_default_storage = true;
+    } else {
+      sender.Disconnect();
+    }
+    return std::move(receiver);
   }
+  using CloudBackend::Subscribe;
 
   pw::Status RegisterFunction(std::string_view name,
                               CloudFunction&& handler) override {
@@ -83,16 +168,60 @@ class MockCloudBackend : public CloudBackend {
 
   // -- Simulation Helpers --
 
-  /// Complete the pending publish with success.
-  void SimulatePublishSuccess() { publish_provider_.Resolve(pw::OkStatus()); }
+  /// Ack publishes automatically in simulated time (see AdvanceTime()).
+  /// Publishes in flight keep waiting for SimulatePublish*().
+  void SetLoadProfile(const MockCloudLoadProfile& profile) {
+    load_profile_ = profile;
+    random_ = MockLoadRandom(profile.seed);
+    rate_tokens_milli_ = profile.rate_limit_burst * 1000;
+    rate_updated_ms_ = now_ms_;
+  }
 
-  /// Complete the pending publish with error.
+  /// Advance simulated time, completing the publishes that fall due in
+  /// order of their due time.
+  void AdvanceTime(uint32_t ms) {
+    const uint32_t end = now_ms_ + ms;
+    while (load_profile_.has_value()) {
+      PublishSlot* next = nullptr;
+      for (PublishSlot& slot : publish_slots_) {
+        if (slot.in_flight && slot.timed && slot.due_ms <= end &&
+            (next == nullptr || slot.due_ms < next->due_ms)) {
+          next = &slot;
+        }
+      }
+      if (next == nullptr) {
+        break;
+      }
+      now_ms_ = std::max(now_ms_, next->due_ms);
+      CompletePublish(*next, next->outcome);
+    }
+    now_ms_ = end;
+  }
+
+  /// Simulated time in milliseconds (advanced by AdvanceTime()).
+  uint32_t now_ms() const { return now_ms_; }
+
+  /// Set the connection state reported by IsConnected() (default true).
+  void SimulateConnected(bool connected) { connected_ = connected; }
+
+  /// Complete the oldest pending publish with success.
+  void SimulatePublishSuccess() { CompleteOldestPublish(pw::OkStatus()); }
+
+  /// Complete the oldest pending publish with error.
   void SimulatePublishFailure(pw::Status error) {
-    publish_provider_.Resolve(error);
+    CompleteOldestPublish(error);
+  }
+
+  /// Number of publishes that were not completed yet.
+  size_t pending_publish_count() const {
+    return static_cast<size_t>(
+        std::count_if(publish_slots_.begin(), publish_slots_.end(),
+                      [](const PublishSlot& s) { return s.in_flight; }));
   }
 
-  /// Inject a received event into the subscription channel.
-  /// Event is buffered and delivered when consumer polls.
+  /// Inject a received event into the channel of every subscription whose
+  /// prefix matches. Event is buffered and delivered when consumer polls;
+  /// it is dropped for subscriptions whose channel (or arena) is full.
   void SimulateEventReceived(std::string_view name,
                              pw::ConstByteSpan data,
                              ContentType type = ContentType::kText) {
@@ -103,14 +232,53 @@ class MockCloudBackend : public CloudBackend {
     std::memcpy(event.data.data(), data.data(), copy_len);
     event.content_type = type;
 
-    // Send via the sender (will be buffered in channel)
-    if (event_sender_.is_open()) {
-      (void)event_sender_.TrySend(std::move(event));
+    for (Subscription& sub : subscriptions_) {
+      if (!sub.is_open() || !name.starts_with(std::string_view(sub.prefix))) {
+        continue;
+      }
+      ++stats_.events_received;
+      if (sub.arena != nullptr) {
+        pw::Result<CompactEvent> compact =
+            sub.arena->Store(std::string_view(event.name),
+                             pw::ConstByteSpan(event.data), type);
+        if (!compact.ok() ||
+            !sub.compact_sender.TrySend(std::move(*compact)).ok()) {
+          ++stats_.events_dropped;
+        }
+        continue;
+      }
+      // Send via the sender (will be buffered in channel)
+      if (!sub.sender.TrySend(event).ok()) {
+        ++stats_.events_dropped;
+      }
+    }
+  }
+
+  /// Inject `count` events back to back, as after a reconnect or a fleet
+  /// broadcast.
+  /// @return Events dropped because a subscription's channel was full
+  uint32_t SimulateEventBurst(std::string_view name,
+                              pw::ConstByteSpan data,
+                              size_t count,
+                              ContentType type = ContentType::kText) {
+    const uint32_t dropped_before = stats_.events_dropped;
+    for (size_t i = 0; i < count; ++i) {
+      SimulateEventReceived(name, data, type);
     }
+    return stats_.events_dropped - dropped_before;
   }
 
-  /// Close the subscription channel (simulates disconnect).
-  void CloseSubscription() { event_sender_.Disconnect(); }
+  /// Close all subscription channels (simulates disconnect).
+  void CloseSubscription() {
+    for (Subscription& sub : subscriptions_) {
+      if (sub.sender.is_open()) {
+        sub.sender.Disconnect();
+      }
+      if (sub.compact_sender.is_open()) {
+        sub.compact_sender.Disconnect();
+      }
+    }
+  }
 
   /// Call a registered function (simulates cloud invocation).
   /// @param name Function name
@@ -120,6 +288,7 @@ class MockCloudBackend : public CloudBackend {
     for (size_t i = 0; i < function_count_; ++i) {
       if (std::string_view(functions_[i].name) == name &&
           functions_[i].handler) {
+        ++stats_.function_calls;
         return functions_[i].handler(arg);
       }
     }
@@ -141,20 +310,52 @@ class MockCloudBackend : public CloudBackend {
   /// Get the count of publish calls.
   size_t publish_count() const { return publish_count_; }
 
-  /// Get the current subscription prefix.
+  /// Get the prefix of the most recent subscription.
   std::string_view subscription_prefix() const {
     return std::string_view(subscription_prefix_);
   }
 
+  /// Number of subscriptions whose receiver is still open.
+  size_t subscription_count() const {
+    size_t count = 0;
+    for (const Subscription& sub : subscriptions_) {
+      if (sub.is_open()) {
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  /// Events dropped because a subscription's channel was full.
+  uint32_t dropped_event_count() const { return stats_.events_dropped; }
+
+  /// Publishes rejected by the load profile's rate limit.
+  size_t rate_limited_count() const { return rate_limited_count_; }
+
   /// Registered variable details.
   struct RegisteredVariable {
     pw::InlineString<kMaxEventNameSize> name;
     const void* data;
     VariableType type;
+    ComputedVariable* computed;  ///< Set for computed variables
 
-    RegisteredVariable() : data(nullptr), type(VariableType::kInt) {}
+    RegisteredVariable()
+        : data(nullptr), type(VariableType::kInt), computed(nullptr) {}
   };
 
+  /// Simulate a cloud read of a variable, computing it if it is computed.
+  /// @return Pointer to the value in the Particle representation, or
+  ///         nullptr if no variable of that name is registered
+  const void* ReadVariable(std::string_view name) {
+    for (size_t i = 0; i < variable_count_; ++i) {
+      RegisteredVariable& var = variables_[i];
+      if (std::string_view(var.name) == name) {
+        return var.computed != nullptr ? var.computed->Read() : var.data;
+      }
+    }
+    return nullptr;
+  }
+
   /// Get the last registered variable.
   const RegisteredVariable& last_variable() const {
     return variable_count_ > 0 ? variables_[variable_count_ - 1]
@@ -185,6 +386,13 @@ class MockCloudBackend : public CloudBackend {
     last_published_.data.clear();
     last_published_.options = PublishOptions{};
     publish_count_ = 0;
+    connected_ = true;
+    for (PublishSlot& slot : publish_slots_) {
+      if (slot.in_flight) {
+        slot.in_flight = false;
+        slot.provider.Resolve(pw::Status::Cancelled());
+      }
+    }
     subscription_prefix_.clear();
 
     // Clear variables
@@ -192,6 +400,7 @@ class MockCloudBackend : public CloudBackend {
       variables_[i].name.clear();
       variables_[i].data = nullptr;
       variables_[i].type = VariableType::kInt;
+      variables_[i].computed = nullptr;
       variable_storage_[i].reset();
     }
     variable_count_ = 0;
@@ -203,11 +412,15 @@ class MockCloudBackend : public CloudBackend {
     }
     function_count_ = 0;
 
-    // Reset channel
-    if (event_sender_.is_open()) {
-      event_sender_.Disconnect();
+    // Reset channels
+    for (Subscription& sub : subscriptions_) {
+      EndSubscription(sub);
     }
-    event_channel_handle_ = {};
+    stats_ = {};
+
+    load_profile_.reset();
+    now_ms_ = 0;
+    rate_limited_count_ = 0;
   }
 
  protected:
@@ -215,7 +428,7 @@ class MockCloudBackend : public CloudBackend {
       std::string_view name,
       const void* data,
       VariableType type,
-      std::unique_ptr<void, VariableDeleter> storage) override {
+      VariableStorage storage) override {
     if (variable_count_ >= kMaxCloudVariables) {
       return pw::Status::ResourceExhausted();
     }
@@ -223,35 +436,177 @@ class MockCloudBackend : public CloudBackend {
     variables_[variable_count_].name = pw::InlineString<kMaxEventNameSize>(name);
     variables_[variable_count_].data = data;
     variables_[variable_count_].type = type;
-    // Convert unique_ptr to shared_ptr for easier storage
-    variable_storage_[variable_count_] =
-        std::shared_ptr<void>(storage.release(), storage.get_deleter());
+    variable_storage_[variable_count_] = std::move(storage);
     ++variable_count_;
     return pw::OkStatus();
   }
 
+  pw::Status DoRegisterComputedVariable(
+      std::string_view name,
+      ComputedVariable& variable,
+      VariableStorage storage) override {
+    PW_TRY(DoRegisterVariable(name, nullptr, variable.type(),
+                              std::move(storage)));
+    variables_[variable_count_ - 1].computed = &variable;
+    return pw::OkStatus();
+  }
+
+  pw::Status DoSubscribe(std::string_view prefix,
+                         pw::async2::SpscChannelHandle<ReceivedEvent>& handle,
+                         EventSender& sender) override {
+    Subscription* sub = AddSubscription(prefix);
+    if (sub == nullptr) {
+      return pw::Status::ResourceExhausted();
+    }
+    sub->handle = std::move(handle);
+    sub->sender = std::move(sender);
+    return pw::OkStatus();
+  }
+
+  pw::Status DoSubscribe(std::string_view prefix,
+                         pw::async2::SpscChannelHandle<CompactEvent>& handle,
+                         CompactEventSender& sender,
+                         EventArena& arena) override {
+    Subscription* sub = AddSubscription(prefix);
+    if (sub == nullptr) {
+      return pw::Status::ResourceExhausted();
+    }
+    sub->compact_handle = std::move(handle);
+    sub->compact_sender = std::move(sender);
+    sub->arena = &arena;
+    return pw::OkStatus();
+  }
+
  private:
-  EventReceiver CreateSubscriptionReceiver() {
-    // Release any existing channel by resetting the handle first
-    if (event_sender_.is_open()) {
-      event_sender_.Disconnect();
+  struct Subscription {
+    pw::InlineString<kMaxEventNameSize> prefix;
+    pw::async2::SpscChannelHandle<ReceivedEvent> handle;
+    EventSender sender;
+    // Used instead of handle and sender for subscriptions with an arena
+    pw::async2::SpscChannelHandle<CompactEvent> compact_handle;
+    CompactEventSender compact_sender;
+    EventArena* arena = nullptr;
+    bool uses_default_storage = false;
+
+    bool is_open() const {
+      return sender.is_open() || compact_sender.is_open();
+    }
+  };
+  // Takes a slot whose receiver is gone; nullptr if all are in use. The
+  // caller attaches the channel.
+  Subscription* AddSubscription(std::string_view prefix) {
+    for (Subscription& sub : subscriptions_) {
+      if (sub.is_open()) {
+        continue;
+      }
+      EndSubscription(sub);
+      sub.prefix = pw::InlineString<kMaxEventNameSize>(prefix);
+      subscription_prefix_ = sub.prefix;
+      return &sub;
     }
-    event_channel_handle_ = {};  // Destroy old handle to release storage
+    return nullptr;
+  }
 
-    auto [handle, sender, receiver] =
-        pw::async2::CreateSpscChannel<ReceivedEvent>(event_channel_storage_);
-    event_channel_handle_ = std::move(handle);
-    event_sender_ = std::move(sender);
-    return std::move(receiver);
+  static void EndSubscription(Subscription& sub) {
+    if (sub.sender.is_open()) {
+      sub.sender.Disconnect();
+    }
+    if (sub.compact_sender.is_open()) {
+      sub.compact_sender.Disconnect();
+    }
+    // Release the channel storage
+    sub.handle = {};
+    sub.compact_handle = {};
+    sub.arena = nullptr;
+    sub.prefix.clear();
+    sub.uses_default_storage = false;
+  }
+
+  struct PublishSlot {
+    pw::async2::ValueProvider<pw::Status> provider;
+    bool in_flight = false;
+    uint32_t sequence = 0;  // Order of the publishes in flight
+
+    // Load profile: when and how the publish completes
+    bool timed = false;
+    uint32_t start_ms = 0;
+    uint32_t due_ms = 0;
+    pw::Status outcome;
+  };
+
+  void CompleteOldestPublish(pw::Status status) {
+    PublishSlot* oldest = nullptr;
+    for (PublishSlot& slot : publish_slots_) {
+      if (slot.in_flight &&
+          (oldest == nullptr || slot.sequence < oldest->sequence)) {
+        oldest = &slot;
+      }
+    }
+    if (oldest != nullptr) {
+      CompletePublish(*oldest, status);
+    }
   }
 
-  pw::async2::ValueProvider<pw::Status> publish_provider_;
+  void CompletePublish(PublishSlot& slot, pw::Status status) {
+    if (status.ok()) {
+      ++stats_.publish_acks;
+    } else {
+      ++stats_.publish_errors;
+    }
+    if (slot.timed) {
+      RecordPublishLatency(now_ms_ - slot.start_ms);
+    }
+    slot.in_flight = false;
+    slot.provider.Resolve(status);
+  }
+
+  // Same buckets as the Particle backend
+  void RecordPublishLatency(uint32_t ms) {
+    constexpr std::array<uint32_t, kCloudLatencyBuckets - 1> kBounds = {
+        100, 250, 500, 1000, 5000};
+    size_t bucket = 0;
+    while (bucket < kBounds.size() && ms >= kBounds[bucket]) {
+      ++bucket;
+    }
+    ++stats_.publish_latency_ms[bucket];
+    stats_.publish_latency_max_ms =
+        std::max(stats_.publish_latency_max_ms, ms);
+  }
+
+  // Token bucket in thousandths of a publish, refilled in simulated time
+  bool TakeRateToken() {
+    if (load_profile_->rate_limit_per_s == 0) {
+      return true;
+    }
+    const uint32_t capacity = load_profile_->rate_limit_burst * 1000;
+    const uint64_t refill = uint64_t{now_ms_ - rate_updated_ms_} *
+                            load_profile_->rate_limit_per_s;
+    rate_tokens_milli_ = static_cast<uint32_t>(
+        std::min<uint64_t>(capacity, rate_tokens_milli_ + refill));
+    rate_updated_ms_ = now_ms_;
+    if (rate_tokens_milli_ < 1000) {
+      return false;
+    }
+    rate_tokens_milli_ -= 1000;
+    return true;
+  }
+
+  bool connected_ = true;
+  std::array<PublishSlot, kMaxPendingPublishes> publish_slots_{};
+  uint32_t publish_sequence_ = 0;
+
+  // Load simulation
+  std::optional<MockCloudLoadProfile> load_profile_;
+  MockLoadRandom random_;
+  uint32_t now_ms_ = 0;
+  uint32_t rate_tokens_milli_ = 0;
+  uint32_t rate_updated_ms_ = 0;
+  size_t rate_limited_count_ = 0;
 
-  // Event channel for subscription
-  pw::async2::ChannelStorage<ReceivedEvent, kMockEventChannelCapacity>
-      event_channel_storage_;
-  pw::async2::SpscChannelHandle<ReceivedEvent> event_channel_handle_;
-  pw::async2::Sender<ReceivedEvent> event_sender_;
+  // Channel storage of Subscribe(prefix)
+  EventChannelStorage<kMockEventChannelCapacity> event_channel_storage_;
+  std::array<Subscription, kMaxEventSubscriptions> subscriptions_{};
+  CloudStats stats_;
 
   PublishedEvent last_published_;
   size_t publish_count_ = 0;
@@ -259,9 +614,7 @@ class MockCloudBackend : public CloudBackend {
 
   // Variable storage
   std::array<RegisteredVariable, kMaxCloudVariables> variables_{};
-  // Use shared_ptr instead of unique_ptr<void, fn_ptr> to avoid
-  // initialization issues with function pointer deleters
-  std::array<std::shared_ptr<void>, kMaxCloudVariables> variable_storage_{};
+  std::array<VariableStorage, kMaxCloudVariables> variable_storage_{};
   size_t variable_count_ = 0;
   static inline RegisteredVariable empty_variable_{};
 
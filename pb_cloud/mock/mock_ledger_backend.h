@@ -29,18 +29,36 @@
 /// auto receiver = mock.SubscribeToSync("my-ledger");
 /// mock.SimulateSyncComplete("my-ledger");
 /// @endcode
+///
+/// Load tests: with a MockLedgerLoadProfile writes fail at a configurable
+/// rate and sync on their own after a simulated latency; AdvanceTime()
+/// delivers the sync events that are due.
 
+#include <algorithm>
 #include <array>
 #include <cstring>
+#include <optional>
 
+#include "mock_load.h"
 #include "pb_cloud/cbor.h"
 #include "pb_cloud/ledger_backend.h"
 #include "pw_assert/check.h"
+#include "pw_status/try.h"
 
 namespace pb::cloud {
 
-/// Default channel capacity for mock sync event buffering.
-inline constexpr uint16_t kMockSyncChannelCapacity = 4;
+/// Channel capacity for mock sync event buffering (coalesces like the
+/// Particle backend).
+inline constexpr uint16_t kMockSyncChannelCapacity = 1;
+
+/// Simulated cloud behaviour of MockLedgerBackend::SetLoadProfile().
+struct MockLedgerLoadProfile {
+  uint32_t sync_latency_ms = 0;  ///< Time from a write to its sync event
+  uint32_t sync_jitter_ms = 0;   ///< Uniform extra latency in [0, jitter]
+  uint32_t write_failure_per_mille = 0;  ///< Share of writes that fail
+  pw::Status write_failure = pw::Status::Internal();  ///< Their status
+  uint32_t seed = 1;  ///< Seed of jitter and failures
+};
 
 /// Mock ledger backend for testing.
 ///
@@ -104,18 +122,54 @@ class MockLedgerBackend : public LedgerBackend {
       return pw::Status::NotFound();
     }
     ledgers_[slot].data_size = 0;
+    ++ledgers_[slot].revision;
     return pw::OkStatus();
   }
 
   pw::Status PurgeAll() override {
     for (size_t i = 0; i < ledger_count_; ++i) {
       ledgers_[i].data_size = 0;
+      ++ledgers_[i].revision;
     }
     return pw::OkStatus();
   }
 
   // -- Simulation Helpers --
 
+  /// Fail writes and sync them automatically in simulated time (see
+  /// AdvanceTime()).
+  void SetLoadProfile(const MockLedgerLoadProfile& profile) {
+    load_profile_ = profile;
+    random_ = MockLoadRandom(profile.seed);
+  }
+
+  /// Advance simulated time, completing the syncs that fall due in order
+  /// of their due time. A ledger written again before its sync is due
+  /// syncs once, after the last write.
+  void AdvanceTime(uint32_t ms) {
+    const uint32_t end = now_ms_ + ms;
+    while (true) {
+      LedgerSlot* next = nullptr;
+      for (size_t i = 0; i < ledger_count_; ++i) {
+        LedgerSlot& ledger = ledgers_[i];
+        if (ledger.sync_scheduled && ledger.sync_due_ms <= end &&
+            (next == nullptr || ledger.sync_due_ms < next->sync_due_ms)) {
+          next = &ledger;
+        }
+      }
+      if (next == nullptr) {
+        break;
+      }
+      now_ms_ = std::max(now_ms_, next->sync_due_ms);
+      next->sync_scheduled = false;
+      SimulateSyncComplete(std::string_view(next->name));
+    }
+    now_ms_ = end;
+  }
+
+  /// Simulated time in milliseconds (advanced by AdvanceTime()).
+  uint32_t now_ms() const { return now_ms_; }
+
   /// Set the data for a ledger (creates ledger if needed).
   void SetLedgerData(std::string_view name, pw::ConstByteSpan data) {
     size_t slot = FindOrCreateLedger(name);
@@ -126,6 +180,7 @@ class MockLedgerBackend : public LedgerBackend {
     ledgers_[slot].data_size = data.size();
     ledgers_[slot].info.data_size = data.size();
     ledgers_[slot].info.last_updated = 1000;  // Arbitrary timestamp
+    ++ledgers_[slot].revision;
   }
 
   // -- Property Helpers (CBOR encoding/decoding) --
@@ -254,6 +309,7 @@ class MockLedgerBackend : public LedgerBackend {
 
     ledgers_[slot].info.last_synced = 2000;  // Arbitrary timestamp
     ledgers_[slot].info.sync_pending = false;
+    ++ledgers_[slot].revision;
   }
 
   // -- Test Inspection --
@@ -271,18 +327,39 @@ class MockLedgerBackend : public LedgerBackend {
   /// Get the current ledger count.
   size_t ledger_count() const { return ledger_count_; }
 
+  /// Number of DoRead() and stream read calls across all ledgers.
+  size_t read_count() const { return read_count_; }
+
+  /// Number of committed writes (DoWrite() or stream commit).
+  size_t write_count() const { return write_count_; }
+
+  /// Largest chunk passed to a stream read or write.
+  size_t max_stream_chunk() const { return max_stream_chunk_; }
+
+  /// Writes failed by the load profile.
+  size_t write_failure_count() const { return write_failure_count_; }
+
   /// Reset all state (for test isolation).
   void Reset() {
     for (size_t i = 0; i < ledger_count_; ++i) {
       ledgers_[i].name.clear();
       ledgers_[i].data_size = 0;
       ledgers_[i].info = LedgerInfo{};
+      ++ledgers_[i].revision;  // Slot may be reused for another ledger
       if (ledgers_[i].sync_sender.is_open()) {
         ledgers_[i].sync_sender.Disconnect();
       }
       ledgers_[i].sync_channel_handle = {};
+      ledgers_[i].sync_scheduled = false;
     }
     ledger_count_ = 0;
+    read_count_ = 0;
+    write_count_ = 0;
+    max_stream_chunk_ = 0;
+    stream_ = MockStream{};
+    load_profile_.reset();
+    now_ms_ = 0;
+    write_failure_count_ = 0;
   }
 
  protected:
@@ -305,6 +382,7 @@ class MockLedgerBackend : public LedgerBackend {
     if (slot >= kMaxLedgerCount || slot >= ledger_count_) {
       return pw::Status::InvalidArgument();
     }
+    ++read_count_;
 
     size_t copy_size = std::min(buffer.size(), ledgers_[slot].data_size);
     std::memcpy(buffer.data(), ledgers_[slot].data.data(), copy_size);
@@ -321,15 +399,97 @@ class MockLedgerBackend : public LedgerBackend {
     if (data.size() > kMaxLedgerDataSize) {
       return pw::Status::ResourceExhausted();
     }
+    if (pw::Status failure = InjectedWriteFailure(); !failure.ok()) {
+      return failure;
+    }
 
     std::memcpy(ledgers_[slot].data.data(), data.data(), data.size());
     ledgers_[slot].data_size = data.size();
     ledgers_[slot].info.data_size = data.size();
     ledgers_[slot].info.last_updated = 3000;  // Arbitrary timestamp
     ledgers_[slot].info.sync_pending = true;
+    ++ledgers_[slot].revision;
+    ++write_count_;
+    ScheduleSync(ledgers_[slot]);
+    return pw::OkStatus();
+  }
+
+  pw::Result<internal::LedgerStream*> DoOpenStream(
+      internal::LedgerInstance* instance, LedgerStreamMode mode) override {
+    size_t slot = InstanceToSlot(instance);
+    if (slot >= kMaxLedgerCount || slot >= ledger_count_) {
+      return pw::Status::InvalidArgument();
+    }
+    if (stream_.open) {
+      return pw::Status::Unavailable();  // One open stream at a time
+    }
+    stream_ = MockStream{};
+    stream_.open = true;
+    stream_.slot = slot;
+    stream_.mode = mode;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    return reinterpret_cast<internal::LedgerStream*>(&stream_);
+  }
+
+  pw::StatusWithSize DoReadStream(internal::LedgerStream* /*stream*/,
+                                  pw::ByteSpan buffer) override {
+    if (!stream_.open || stream_.mode != LedgerStreamMode::kRead) {
+      return pw::StatusWithSize::FailedPrecondition();
+    }
+    ++read_count_;
+    const LedgerSlot& ledger = ledgers_[stream_.slot];
+    size_t copy_size =
+        std::min(buffer.size(), ledger.data_size - stream_.offset);
+    std::memcpy(buffer.data(), ledger.data.data() + stream_.offset, copy_size);
+    stream_.offset += copy_size;
+    max_stream_chunk_ = std::max(max_stream_chunk_, buffer.size());
+    return pw::StatusWithSize(copy_size);
+  }
+
+  pw::Status DoWriteStream(internal::LedgerStream* /*stream*/,
+                           pw::ConstByteSpan data) override {
+    if (!stream_.open || stream_.mode != LedgerStreamMode::kWrite) {
+      return pw::Status::FailedPrecondition();
+    }
+    if (data.size() > kMaxLedgerDataSize - stream_.offset) {
+      return pw::Status::ResourceExhausted();
+    }
+    std::memcpy(stream_data_.data() + stream_.offset, data.data(),
+                data.size());
+    stream_.offset += data.size();
+    max_stream_chunk_ = std::max(max_stream_chunk_, data.size());
     return pw::OkStatus();
   }
 
+  pw::Status DoCloseStream(internal::LedgerStream* /*stream*/,
+                           bool commit) override {
+    if (!stream_.open) {
+      return pw::Status::FailedPrecondition();
+    }
+    stream_.open = false;
+    if (commit && stream_.mode == LedgerStreamMode::kWrite) {
+      PW_TRY(InjectedWriteFailure());
+      LedgerSlot& ledger = ledgers_[stream_.slot];
+      std::memcpy(ledger.data.data(), stream_data_.data(), stream_.offset);
+      ledger.data_size = stream_.offset;
+      ledger.info.data_size = stream_.offset;
+      ledger.info.last_updated = 3000;  // Arbitrary timestamp
+      ledger.info.sync_pending = true;
+      ++ledger.revision;
+      ++write_count_;
+      ScheduleSync(ledger);
+    }
+    return pw::OkStatus();
+  }
+
+  uint32_t DoGetRevision(internal::LedgerInstance* instance) override {
+    size_t slot = InstanceToSlot(instance);
+    if (slot >= kMaxLedgerCount || slot >= ledger_count_) {
+      return 0;
+    }
+    return ledgers_[slot].revision;
+  }
+
  private:
   /// Convert instance pointer back to slot index.
   static size_t InstanceToSlot(internal::LedgerInstance* instance) {
@@ -372,16 +532,60 @@ class MockLedgerBackend : public LedgerBackend {
     std::array<std::byte, kMaxLedgerDataSize> data{};
     size_t data_size = 0;
     LedgerInfo info{};
+    uint32_t revision = 0;  // Bumped on every data change
 
     // Sync event channel
     pw::async2::ChannelStorage<SyncEvent, kMockSyncChannelCapacity>
         sync_storage;
     pw::async2::SpscChannelHandle<SyncEvent> sync_channel_handle;
     pw::async2::Sender<SyncEvent> sync_sender;
+
+    // Load profile: sync of the last write
+    bool sync_scheduled = false;
+    uint32_t sync_due_ms = 0;
+  };
+
+  /// Load profile failure for the next write, or OkStatus.
+  pw::Status InjectedWriteFailure() {
+    if (!load_profile_.has_value() ||
+        !random_.Chance(load_profile_->write_failure_per_mille)) {
+      return pw::OkStatus();
+    }
+    ++write_failure_count_;
+    return load_profile_->write_failure;
+  }
+
+  void ScheduleSync(LedgerSlot& ledger) {
+    if (!load_profile_.has_value()) {
+      return;
+    }
+    ledger.sync_scheduled = true;
+    ledger.sync_due_ms = now_ms_ + load_profile_->sync_latency_ms +
+                         random_.UpTo(load_profile_->sync_jitter_ms);
+  }
+
+  /// The open ledger stream, if any.
+  struct MockStream {
+    bool open = false;
+    size_t slot = 0;
+    LedgerStreamMode mode = LedgerStreamMode::kRead;
+    size_t offset = 0;  // Read position, or bytes staged for writing
   };
 
   std::array<LedgerSlot, kMaxLedgerCount> ledgers_{};
   size_t ledger_count_ = 0;
+  size_t read_count_ = 0;
+  size_t write_count_ = 0;
+
+  MockStream stream_;
+  std::array<std::byte, kMaxLedgerDataSize> stream_data_{};  // Staged write
+  size_t max_stream_chunk_ = 0;
+
+  // Load simulation
+  std::optional<MockLedgerLoadProfile> load_profile_;
+  MockLoadRandom random_;
+  uint32_t now_ms_ = 0;
+  size_t write_failure_count_ = 0;
 };
 
 }  // namespace pb::cloud
@@ -0,0 +1,43 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file mock_load.h
+/// @brief Deterministic randomness for the mock backends' load simulation.
+///
+/// MockCloudBackend::SetLoadProfile() and MockLedgerBackend::SetLoadProfile()
+/// draw latency jitter and injected failures from this generator, so a load
+/// test with the same seed sees the same sequence on every run.
+
+#include <cstdint>
+
+namespace pb::cloud {
+
+/// xorshift32 pseudo-random numbers.
+class MockLoadRandom {
+ public:
+  explicit MockLoadRandom(uint32_t seed = 1) : state_(seed != 0 ? seed : 1) {}
+
+  uint32_t Next() {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 17;
+    state_ ^= state_ << 5;
+    return state_;
+  }
+
+  /// Uniform in [0, max].
+  uint32_t UpTo(uint32_t max) {
+    return max == 0 ? 0 : Next() % (max + 1);
+  }
+
+  /// True with probability per_mille / 1000.
+  bool Chance(uint32_t per_mille) {
+    return per_mille != 0 && Next() % 1000 < per_mille;
+  }
+
+ private:
+  uint32_t state_;
+};
+
+}  // namespace pb::cloud
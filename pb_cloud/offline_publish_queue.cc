@@ -0,0 +1,304 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#define PW_LOG_MODULE_NAME "pb_cloud"
+#define PW_LOG_LEVEL PB_CLOUD_LOG_LEVEL
+
+#include "pb_cloud/offline_publish_queue.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "pb_cloud/config.h"
+#include "pw_log/log.h"
+
+namespace pb::cloud {
+
+namespace {
+
+using pw::chrono::SystemClock;
+
+// Record flags
+constexpr uint8_t kFlagPublic = 0x01;
+constexpr uint8_t kFlagWithAck = 0x02;
+constexpr uint8_t kFlagHighPriority = 0x04;
+
+void PutU16(pw::ByteSpan dest, size_t offset, uint32_t value) {
+  dest[offset] = static_cast<std::byte>(value & 0xff);
+  dest[offset + 1] = static_cast<std::byte>((value >> 8) & 0xff);
+}
+
+uint16_t GetU16(pw::ConstByteSpan src, size_t offset) {
+  return static_cast<uint16_t>(static_cast<uint16_t>(src[offset]) |
+                               (static_cast<uint16_t>(src[offset + 1]) << 8));
+}
+
+// A decoded record, pointing into the record bytes.
+struct RecordView {
+  std::string_view name;
+  pw::ConstByteSpan data;
+  PublishOptions options;
+  size_t size = 0;  // Whole record
+};
+
+// Decodes the record at the start of `src`; `src` may continue with more
+// records.
+std::optional<RecordView> DecodeRecord(pw::ConstByteSpan src) {
+  if (src.size() < kQueuedRecordHeaderSize) {
+    return std::nullopt;
+  }
+  const size_t name_len = static_cast<uint8_t>(src[0]);
+  const size_t data_len = GetU16(src, 6);
+  const size_t size = kQueuedRecordHeaderSize + name_len + data_len;
+  if (name_len > kMaxEventNameSize || data_len > kMaxEventDataSize ||
+      size > src.size()) {
+    return std::nullopt;
+  }
+
+  RecordView record;
+  const uint8_t flags = static_cast<uint8_t>(src[1]);
+  record.options.scope =
+      (flags & kFlagPublic) != 0 ? EventScope::kPublic : EventScope::kPrivate;
+  record.options.ack =
+      (flags & kFlagWithAck) != 0 ? AckMode::kWithAck : AckMode::kNoAck;
+  record.options.priority = (flags & kFlagHighPriority) != 0
+                                ? PublishPriority::kHigh
+                                : PublishPriority::kNormal;
+  record.options.content_type = static_cast<ContentType>(GetU16(src, 2));
+  record.options.ttl_seconds = GetU16(src, 4);
+  record.name = std::string_view(
+      reinterpret_cast<const char*>(src.data() + kQueuedRecordHeaderSize),
+      name_len);
+  record.data = src.subspan(kQueuedRecordHeaderSize + name_len, data_len);
+  record.size = size;
+  return record;
+}
+
+}  // namespace
+
+OfflinePublishQueue::OfflinePublishQueue(CloudBackend& cloud,
+                                         pw::ByteSpan storage,
+                                         const OfflineQueueOptions& options)
+    : cloud_(cloud), storage_(storage), options_(options) {}
+
+pw::StatusWithSize OfflinePublishQueue::EncodeRecord(
+    std::string_view name,
+    pw::ConstByteSpan data,
+    const PublishOptions& options,
+    pw::ByteSpan dest) {
+  const size_t size = kQueuedRecordHeaderSize + name.size() + data.size();
+  if (size > dest.size()) {
+    return pw::StatusWithSize::ResourceExhausted();
+  }
+
+  uint8_t flags = 0;
+  if (options.scope == EventScope::kPublic) {
+    flags |= kFlagPublic;
+  }
+  if (options.ack == AckMode::kWithAck) {
+    flags |= kFlagWithAck;
+  }
+  if (options.priority == PublishPriority::kHigh) {
+    flags |= kFlagHighPriority;
+  }
+  dest[0] = static_cast<std::byte>(name.size());
+  dest[1] = static_cast<std::byte>(flags);
+  PutU16(dest, 2, static_cast<uint32_t>(options.content_type));
+  PutU16(dest, 4, static_cast<uint32_t>(std::clamp(options.ttl_seconds, 0,
+                                                   0xffff)));
+  PutU16(dest, 6, static_cast<uint32_t>(data.size()));
+  std::memcpy(dest.data() + kQueuedRecordHeaderSize, name.data(), name.size());
+  std::memcpy(dest.data() + kQueuedRecordHeaderSize + name.size(),
+              data.data(), data.size());
+  return pw::StatusWithSize(size);
+}
+
+pw::Status OfflinePublishQueue::Enqueue(std::string_view name,
+                                        pw::ConstByteSpan data,
+                                        const PublishOptions& options) {
+  if (name.size() > kMaxEventNameSize || data.size() > kMaxEventDataSize) {
+    return pw::Status::InvalidArgument();
+  }
+
+  PublishSpillover* spillover = options_.spillover;
+  const bool high = options.priority == PublishPriority::kHigh;
+  // kHigh events skip the spillover FIFO while the RAM buffer has room
+  const bool to_spillover = !high && spillover != nullptr &&
+                            (options_.persist_all || !spillover->empty());
+
+  if (!to_spillover) {
+    pw::StatusWithSize encoded =
+        EncodeRecord(name, data, options, storage_.subspan(ram_used_));
+    if (encoded.ok()) {
+      if (high) {
+        MoveAheadOfNormal(ram_used_, encoded.size());
+      }
+      ram_used_ += encoded.size();
+      ++ram_count_;
+      ++stats_.enqueued;
+      return pw::OkStatus();
+    }
+    if (spillover == nullptr) {
+      ++stats_.dropped;
+      return pw::Status::ResourceExhausted();
+    }
+  }
+
+  // scratch_ is free: the backend copied the record in flight, if any
+  pw::StatusWithSize encoded = EncodeRecord(name, data, options, scratch_);
+  pw::Status status = encoded.status();
+  if (status.ok()) {
+    status = spillover->Push(pw::ConstByteSpan(scratch_).first(encoded.size()));
+  }
+  if (!status.ok()) {
+    ++stats_.dropped;
+    return pw::Status::ResourceExhausted();
+  }
+  ++stats_.spilled;
+  ++stats_.enqueued;
+  return pw::OkStatus();
+}
+
+pw::async2::Poll<> OfflinePublishQueue::Pend(pw::async2::Context& cx) {
+  if (!in_flight_.has_value()) {
+    if (empty() || !cloud_.IsConnected() ||
+        (SystemClock::now() < next_publish_time_ && !HighPriorityFront())) {
+      return pw::async2::Ready();
+    }
+    if (!PublishFront().ok()) {
+      return pw::async2::Ready();
+    }
+  }
+
+  pw::async2::Poll<pw::Status> poll = in_flight_->Pend(cx);
+  if (poll.IsPending()) {
+    return pw::async2::Pending();
+  }
+  const pw::Status status = poll.value();
+  in_flight_.reset();
+
+  const SystemClock::time_point now = SystemClock::now();
+  if (status.ok()) {
+    ++stats_.published;
+    PopFront();
+    next_publish_time_ = now + options_.min_interval;
+  } else if (options_.max_attempts != 0 &&
+             attempts_ >= options_.max_attempts) {
+    PW_LOG_WARN("Offline queue: dropping event after %u attempts",
+                static_cast<unsigned>(attempts_));
+    ++stats_.dropped;
+    PopFront();
+    next_publish_time_ = now + options_.min_interval;
+  } else {
+    ++stats_.retries;
+    next_publish_time_ = now + options_.retry_interval;
+  }
+  return pw::async2::Ready();
+}
+
+bool OfflinePublishQueue::empty() const {
+  return ram_count_ == 0 &&
+         (options_.spillover == nullptr || options_.spillover->empty());
+}
+
+pw::Status OfflinePublishQueue::PublishFront() {
+  // RAM records are older than spilled ones or kHigh. A retry stays with
+  // the record that failed.
+  if (attempts_ == 0) {
+    in_flight_from_ram_ = ram_count_ > 0;
+  }
+  pw::ConstByteSpan bytes;
+  if (in_flight_from_ram_) {
+    bytes = pw::ConstByteSpan(storage_).first(ram_used_);
+  } else {
+    pw::StatusWithSize peeked = options_.spillover->Peek(scratch_);
+    if (!peeked.ok()) {
+      PW_LOG_ERROR("Offline queue: can't read spilled event (%d)",
+                   static_cast<int>(peeked.status().code()));
+      if (!peeked.status().IsNotFound()) {
+        ++stats_.dropped;
+        PopFront();  // Skip the unreadable record
+      }
+      return peeked.status();
+    }
+    bytes = pw::ConstByteSpan(scratch_).first(peeked.size());
+  }
+
+  std::optional<RecordView> record = DecodeRecord(bytes);
+  if (!record.has_value()) {
+    PW_LOG_ERROR("Offline queue: dropping corrupt event");
+    ++stats_.dropped;
+    if (in_flight_from_ram_) {
+      // Nothing after a corrupt RAM record can be trusted
+      ram_used_ = 0;
+      ram_count_ = 0;
+    } else {
+      PopFront();
+    }
+    return pw::Status::DataLoss();
+  }
+
+  ++attempts_;
+  in_flight_ = cloud_.Publish(record->name, record->data, record->options);
+  return pw::OkStatus();
+}
+
+void OfflinePublishQueue::PopFront() {
+  attempts_ = 0;
+  if (!in_flight_from_ram_) {
+    options_.spillover->Pop().IgnoreError();
+    return;
+  }
+  std::optional<RecordView> record =
+      DecodeRecord(pw::ConstByteSpan(storage_).first(ram_used_));
+  if (!record.has_value()) {
+    ram_used_ = 0;
+    ram_count_ = 0;
+    return;
+  }
+  std::memmove(storage_.data(), storage_.data() + record->size,
+               ram_used_ - record->size);
+  ram_used_ -= record->size;
+  --ram_count_;
+}
+
+bool OfflinePublishQueue::HighPriorityFront() const {
+  if (attempts_ != 0 || ram_count_ == 0) {
+    return false;
+  }
+  std::optional<RecordView> record =
+      DecodeRecord(pw::ConstByteSpan(storage_).first(ram_used_));
+  return record.has_value() &&
+         record->options.priority == PublishPriority::kHigh;
+}
+
+void OfflinePublishQueue::MoveAheadOfNormal(size_t offset, size_t size) {
+  // The record in flight or being retried keeps the front
+  size_t position = 0;
+  const bool front_busy =
+      in_flight_from_ram_ && (in_flight_.has_value() || attempts_ > 0);
+  bool first = true;
+  while (position < offset) {
+    std::optional<RecordView> record = DecodeRecord(
+        pw::ConstByteSpan(storage_).subspan(position, offset - position));
+    if (!record.has_value()) {
+      return;  // PublishFront() drops the corrupt records
+    }
+    if (!(first && front_busy) &&
+        record->options.priority != PublishPriority::kHigh) {
+      break;
+    }
+    position += record->size;
+    first = false;
+  }
+  if (position == offset) {
+    return;
+  }
+
+  // Rotate [position, offset + size) so the new record comes first
+  std::rotate(storage_.begin() + position,
+              storage_.begin() + offset,
+              storage_.begin() + offset + size);
+}
+
+}  // namespace pb::cloud
@@ -0,0 +1,283 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_cloud/offline_publish_queue.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include "mock_cloud_backend.h"
+#include "pw_async2/basic_dispatcher.h"
+#include "pw_async2/pend_func_task.h"
+#include "pw_unit_test/framework.h"
+
+namespace pb::cloud {
+namespace {
+
+constexpr auto kData = std::array<std::byte, 3>{
+    std::byte{0x01}, std::byte{0x02}, std::byte{0x03}};
+
+// One record of kData with a one-character name
+constexpr size_t kRecordSize = kQueuedRecordHeaderSize + 1 + kData.size();
+
+constexpr OfflineQueueOptions kNoDelays = {
+    .min_interval = pw::chrono::SystemClock::duration::zero(),
+    .retry_interval = pw::chrono::SystemClock::duration::zero(),
+};
+
+// Spillover storage in RAM.
+class FakeSpillover : public PublishSpillover {
+ public:
+  pw::Status Push(pw::ConstByteSpan record) override {
+    if (records_.size() >= capacity_) {
+      return pw::Status::ResourceExhausted();
+    }
+    records_.emplace_back(record.begin(), record.end());
+    return pw::OkStatus();
+  }
+
+  pw::StatusWithSize Peek(pw::ByteSpan dest) override {
+    if (records_.empty()) {
+      return pw::StatusWithSize::NotFound();
+    }
+    const std::vector<std::byte>& front = records_.front();
+    std::copy(front.begin(), front.end(), dest.begin());
+    return pw::StatusWithSize(front.size());
+  }
+
+  pw::Status Pop() override {
+    records_.pop_front();
+    return pw::OkStatus();
+  }
+
+  bool empty() const override { return records_.empty(); }
+
+  size_t size() const { return records_.size(); }
+  void set_capacity(size_t capacity) { capacity_ = capacity; }
+
+ private:
+  std::deque<std::vector<std::byte>> records_;
+  size_t capacity_ = 16;
+};
+
+class OfflinePublishQueueTest : public ::testing::Test {
+ protected:
+  // Calls queue.Pend() once from a task.
+  void Drive(OfflinePublishQueue& queue) {
+    pw::async2::PendFuncTask task(
+        [&queue](pw::async2::Context& cx) -> pw::async2::Poll<> {
+          static_cast<void>(queue.Pend(cx));
+          return pw::async2::Ready();
+        });
+    dispatcher_.Post(task);
+    dispatcher_.RunUntilStalled();
+  }
+
+  // Publishes the next queued event and acknowledges it.
+  void DeliverNext(OfflinePublishQueue& queue) {
+    Drive(queue);
+    mock_.SimulatePublishSuccess();
+    Drive(queue);
+  }
+
+  pw::async2::BasicDispatcher dispatcher_;
+  MockCloudBackend mock_;
+  std::array<std::byte, 4 * kRecordSize> storage_{};
+};
+
+TEST_F(OfflinePublishQueueTest, HoldsEventsWhileDisconnected) {
+  OfflinePublishQueue queue(mock_, storage_, kNoDelays);
+  mock_.SimulateConnected(false);
+
+  ASSERT_EQ(queue.Enqueue("a", kData, {}), pw::OkStatus());
+  Drive(queue);
+
+  EXPECT_EQ(mock_.publish_count(), 0u);
+  EXPECT_EQ(queue.ram_count(), 1u);
+}
+
+TEST_F(OfflinePublishQueueTest, ReplaysInOrderAfterReconnect) {
+  OfflinePublishQueue queue(mock_, storage_, kNoDelays);
+  mock_.SimulateConnected(false);
+  PublishOptions options;
+  options.content_type = ContentType::kBinary;
+  options.ttl_seconds = 300;
+  ASSERT_EQ(queue.Enqueue("a", kData, options), pw::OkStatus());
+  ASSERT_EQ(queue.Enqueue("b", kData, {}), pw::OkStatus());
+
+  mock_.SimulateConnected(true);
+  Drive(queue);
+  EXPECT_EQ(mock_.publish_count(), 1u);
+  EXPECT_EQ(mock_.last_published().name, "a");
+  EXPECT_EQ(mock_.last_published().data.size(), kData.size());
+  EXPECT_EQ(mock_.last_published().options.content_type,
+            ContentType::kBinary);
+  EXPECT_EQ(mock_.last_published().options.ttl_seconds, 300);
+
+  // Nothing else goes out until the first one is acknowledged
+  Drive(queue);
+  EXPECT_EQ(mock_.publish_count(), 1u);
+
+  mock_.SimulatePublishSuccess();
+  Drive(queue);
+  DeliverNext(queue);
+  EXPECT_EQ(mock_.last_published().name, "b");
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(queue.stats().published, 2u);
+}
+
+TEST_F(OfflinePublishQueueTest, RateLimitsReplay) {
+  OfflineQueueOptions options = kNoDelays;
+  options.min_interval =
+      pw::chrono::SystemClock::for_at_least(std::chrono::hours(1));
+  OfflinePublishQueue queue(mock_, storage_, options);
+  ASSERT_EQ(queue.Enqueue("a", kData, {}), pw::OkStatus());
+  ASSERT_EQ(queue.Enqueue("b", kData, {}), pw::OkStatus());
+
+  DeliverNext(queue);
+  Drive(queue);
+
+  EXPECT_EQ(mock_.publish_count(), 1u);
+  EXPECT_EQ(queue.ram_count(), 1u);
+}
+
+TEST_F(OfflinePublishQueueTest, RetriesThenDropsFailedEvent) {
+  OfflineQueueOptions options = kNoDelays;
+  options.max_attempts = 2;
+  OfflinePublishQueue queue(mock_, storage_, options);
+  ASSERT_EQ(queue.Enqueue("a", kData, {}), pw::OkStatus());
+
+  for (int i = 0; i < 2; ++i) {
+    Drive(queue);
+    mock_.SimulatePublishFailure(pw::Status::Unavailable());
+    Drive(queue);
+  }
+
+  EXPECT_EQ(mock_.publish_count(), 2u);
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(queue.stats().retries, 1u);
+  EXPECT_EQ(queue.stats().dropped, 1u);
+}
+
+TEST_F(OfflinePublishQueueTest, RejectsEventsWhenFull) {
+  OfflinePublishQueue queue(mock_, storage_, kNoDelays);
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(queue.Enqueue("a", kData, {}), pw::OkStatus());
+  }
+
+  EXPECT_EQ(queue.Enqueue("a", kData, {}), pw::Status::ResourceExhausted());
+  EXPECT_EQ(queue.stats().dropped, 1u);
+}
+
+TEST_F(OfflinePublishQueueTest, RejectsOversizedEvents) {
+  OfflinePublishQueue queue(mock_, storage_, kNoDelays);
+  std::array<std::byte, kMaxEventDataSize + 1> too_large{};
+  EXPECT_EQ(queue.Enqueue("a", too_large, {}),
+            pw::Status::InvalidArgument());
+}
+
+TEST_F(OfflinePublishQueueTest, SpillsOverAndKeepsOrder) {
+  FakeSpillover spillover;
+  OfflineQueueOptions options = kNoDelays;
+  options.spillover = &spillover;
+  std::array<std::byte, kRecordSize> small_storage{};
+  OfflinePublishQueue queue(mock_, small_storage, options);
+  mock_.SimulateConnected(false);
+
+  ASSERT_EQ(queue.Enqueue("a", kData, {}), pw::OkStatus());
+  ASSERT_EQ(queue.Enqueue("b", kData, {}), pw::OkStatus());
+  ASSERT_EQ(queue.Enqueue("c", kData, {}), pw::OkStatus());
+  EXPECT_EQ(queue.ram_count(), 1u);
+  EXPECT_EQ(spillover.size(), 2u);
+  EXPECT_EQ(queue.stats().spilled, 2u);
+
+  mock_.SimulateConnected(true);
+  DeliverNext(queue);
+  EXPECT_EQ(mock_.last_published().name, "a");
+
+  // RAM has room again, but "d" must not overtake the spilled events
+  ASSERT_EQ(queue.Enqueue("d", kData, {}), pw::OkStatus());
+  EXPECT_EQ(queue.ram_count(), 0u);
+
+  DeliverNext(queue);
+  EXPECT_EQ(mock_.last_published().name, "b");
+  DeliverNext(queue);
+  EXPECT_EQ(mock_.last_published().name, "c");
+  DeliverNext(queue);
+  EXPECT_EQ(mock_.last_published().name, "d");
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(OfflinePublishQueueTest, PersistAllWritesThrough) {
+  FakeSpillover spillover;
+  OfflineQueueOptions options = kNoDelays;
+  options.spillover = &spillover;
+  options.persist_all = true;
+  OfflinePublishQueue queue(mock_, storage_, options);
+
+  ASSERT_EQ(queue.Enqueue("a", kData, {}), pw::OkStatus());
+  EXPECT_EQ(queue.ram_count(), 0u);
+  EXPECT_EQ(spillover.size(), 1u);
+
+  DeliverNext(queue);
+  EXPECT_EQ(mock_.last_published().name, "a");
+  EXPECT_TRUE(spillover.empty());
+}
+
+TEST_F(OfflinePublishQueueTest, HighPriorityOvertakesQueuedEvents) {
+  OfflineQueueOptions options = kNoDelays;
+  options.min_interval =
+      pw::chrono::SystemClock::for_at_least(std::chrono::hours(1));
+  OfflinePublishQueue queue(mock_, storage_, options);
+  ASSERT_EQ(queue.Enqueue("a", kData, {}), pw::OkStatus());
+  ASSERT_EQ(queue.Enqueue("b", kData, {}), pw::OkStatus());
+  Drive(queue);
+  EXPECT_EQ(mock_.last_published().name, "a");
+
+  // "x" waits for "a" in flight, then skips the rate limit and "b"
+  ASSERT_EQ(queue.Enqueue("x", kData, {.priority = PublishPriority::kHigh}),
+            pw::OkStatus());
+  mock_.SimulatePublishSuccess();
+  Drive(queue);
+  Drive(queue);
+  EXPECT_EQ(mock_.publish_count(), 2u);
+  EXPECT_EQ(mock_.last_published().name, "x");
+  EXPECT_EQ(mock_.last_published().options.priority, PublishPriority::kHigh);
+
+  mock_.SimulatePublishSuccess();
+  Drive(queue);
+  Drive(queue);
+  EXPECT_EQ(mock_.publish_count(), 2u);
+  EXPECT_EQ(queue.ram_count(), 1u);
+}
+
+TEST_F(OfflinePublishQueueTest, HighPriorityKeepsOrderAmongItself) {
+  FakeSpillover spillover;
+  OfflineQueueOptions options = kNoDelays;
+  options.spillover = &spillover;
+  options.persist_all = true;
+  OfflinePublishQueue queue(mock_, storage_, options);
+  mock_.SimulateConnected(false);
+
+  const PublishOptions high{.priority = PublishPriority::kHigh};
+  ASSERT_EQ(queue.Enqueue("a", kData, {}), pw::OkStatus());
+  ASSERT_EQ(queue.Enqueue("x", kData, high), pw::OkStatus());
+  ASSERT_EQ(queue.Enqueue("y", kData, high), pw::OkStatus());
+  EXPECT_EQ(queue.ram_count(), 2u);
+  EXPECT_EQ(spillover.size(), 1u);
+
+  mock_.SimulateConnected(true);
+  DeliverNext(queue);
+  EXPECT_EQ(mock_.last_published().name, "x");
+  DeliverNext(queue);
+  EXPECT_EQ(mock_.last_published().name, "y");
+  DeliverNext(queue);
+  EXPECT_EQ(mock_.last_published().name, "a");
+  EXPECT_TRUE(queue.empty());
+}
+
+}  // namespace
+}  // namespace pb::cloud
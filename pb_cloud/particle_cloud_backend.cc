@@ -1,17 +1,22 @@
 // Copyright Offene Werkstatt Wädenswil
 // SPDX-License-Identifier: MIT
 
+#define PW_LOG_MODULE_NAME "pb_cloud"
+#define PW_LOG_LEVEL PB_CLOUD_LOG_LEVEL
+
 #include "pb_cloud/particle_cloud_backend.h"
 
+#include <algorithm>
 #include <cstring>
+#include <string_view>
 
+#include "pb_cloud/config.h"
 #include "pw_assert/check.h"
-#include "spark_wiring_string.h"
-#include "system_cloud.h"
-
-#define PW_LOG_MODULE_NAME "pb_cloud"
-
 #include "pw_log/log.h"
+#include "pw_metric/metric.h"
+#include "pw_status/try.h"
+#include "system_cloud.h"
+#include "timer_hal.h"
 
 namespace pb::cloud {
 namespace {
@@ -22,59 +27,74 @@ namespace {
 // cloud function invocations are serialized with application code.
 // No synchronization is needed for accessing shared state.
 
-/// Instance pointer for trampoline access.
-/// Set when Instance() is first called, never cleared (singleton lives forever).
-ParticleCloudBackend* g_instance = nullptr;
-
-// -- Static Function Trampolines --
-// Particle requires raw C function pointers. We use 15 static trampolines
-// that dispatch to pw::Function handlers stored in the backend instance.
-
-/// Static trampoline for slot N - dispatches to instance handler.
-/// Note: Particle cloud functions receive a String object (not const char*).
-#define DEFINE_TRAMPOLINE(N)                                               \
-  int FunctionTrampoline##N(String arg) {                                  \
-    const char* arg_cstr = arg.c_str();                                    \
-    PW_LOG_INFO("Trampoline%d called, arg=%s", N,                          \
-                arg_cstr ? arg_cstr : "(null)");                           \
-    if (!g_instance || !g_instance->GetHandler(N)) {                       \
-      PW_LOG_ERROR("Trampoline%d: handler is null!", N);                   \
-      return -1;                                                           \
-    }                                                                      \
-    int result = g_instance->GetHandler(N)(                                \
-        std::string_view(arg_cstr, arg.length()));                         \
-    PW_LOG_INFO("Trampoline%d returned %d", N, result);                    \
-    return result;                                                         \
+/// Counters behind ParticleCloudBackend::stats(). Only the system thread
+/// updates them.
+struct CloudCounters {
+  PW_METRIC_GROUP(group, "cloud");
+  PW_METRIC(group, publishes, "publishes", 0u);
+  PW_METRIC(group, publish_acks, "publish_acks", 0u);
+  PW_METRIC(group, publish_errors, "publish_errors", 0u);
+  PW_METRIC(group, publish_unavailable, "publish_unavailable", 0u);
+  PW_METRIC(group, publish_busy, "publish_busy", 0u);
+  PW_METRIC(group, publish_latency_max_ms, "publish_latency_max_ms", 0u);
+  PW_METRIC(group, publish_lt_100ms, "publish_lt_100ms", 0u);
+  PW_METRIC(group, publish_lt_250ms, "publish_lt_250ms", 0u);
+  PW_METRIC(group, publish_lt_500ms, "publish_lt_500ms", 0u);
+  PW_METRIC(group, publish_lt_1s, "publish_lt_1s", 0u);
+  PW_METRIC(group, publish_lt_5s, "publish_lt_5s", 0u);
+  PW_METRIC(group, publish_ge_5s, "publish_ge_5s", 0u);
+  PW_METRIC(group, events_received, "events_received", 0u);
+  PW_METRIC(group, events_dropped, "events_dropped", 0u);
+  PW_METRIC(group, function_calls, "function_calls", 0u);
+  PW_METRIC(group, function_time_max_us, "function_time_max_us", 0u);
+  PW_METRIC(group, function_time_total_us, "function_time_total_us", 0u);
+
+  std::array<pw::metric::TypedMetric<uint32_t>*, kCloudLatencyBuckets>
+      publish_latency{&publish_lt_100ms, &publish_lt_250ms, &publish_lt_500ms,
+                      &publish_lt_1s,    &publish_lt_5s,    &publish_ge_5s};
+};
+
+CloudCounters g_counters;
+
+uint32_t NowMicros() {
+  return static_cast<uint32_t>(HAL_Timer_Get_Micro_Seconds());
+}
+
+/// Counts a publish latency in its histogram bucket and tracks the maximum.
+void RecordPublishLatency(uint32_t ms) {
+  constexpr std::array<uint32_t, kCloudLatencyBuckets - 1> kBounds = {
+      100, 250, 500, 1000, 5000};
+  size_t bucket = 0;
+  while (bucket < kBounds.size() && ms >= kBounds[bucket]) {
+    ++bucket;
+  }
+  g_counters.publish_latency[bucket]->Increment();
+  if (ms > g_counters.publish_latency_max_ms.value()) {
+    g_counters.publish_latency_max_ms.Set(ms);
   }
+}
 
-DEFINE_TRAMPOLINE(0)
-DEFINE_TRAMPOLINE(1)
-DEFINE_TRAMPOLINE(2)
-DEFINE_TRAMPOLINE(3)
-DEFINE_TRAMPOLINE(4)
-DEFINE_TRAMPOLINE(5)
-DEFINE_TRAMPOLINE(6)
-DEFINE_TRAMPOLINE(7)
-DEFINE_TRAMPOLINE(8)
-DEFINE_TRAMPOLINE(9)
-DEFINE_TRAMPOLINE(10)
-DEFINE_TRAMPOLINE(11)
-DEFINE_TRAMPOLINE(12)
-DEFINE_TRAMPOLINE(13)
-DEFINE_TRAMPOLINE(14)
-
-#undef DEFINE_TRAMPOLINE
-
-/// Array of trampoline function pointers for registration with Particle.
-/// Type matches user_function_int_str_t: int(String)
-constexpr std::array<user_function_int_str_t*, kMaxCloudFunctions>
-    kTrampolines = {
-        FunctionTrampoline0,  FunctionTrampoline1,  FunctionTrampoline2,
-        FunctionTrampoline3,  FunctionTrampoline4,  FunctionTrampoline5,
-        FunctionTrampoline6,  FunctionTrampoline7,  FunctionTrampoline8,
-        FunctionTrampoline9,  FunctionTrampoline10, FunctionTrampoline11,
-        FunctionTrampoline12, FunctionTrampoline13, FunctionTrampoline14,
-};
+// Maps a Device OS content type to ContentType; unknown types are treated as
+// opaque binary data.
+ContentType ToContentType(int content_type) {
+  switch (content_type) {
+    case static_cast<int>(ContentType::kText):
+      return ContentType::kText;
+    case static_cast<int>(ContentType::kStructured):
+      return ContentType::kStructured;
+    default:
+      return ContentType::kBinary;
+  }
+}
+
+// Update callback of computed variables: computes the value of the
+// ComputedVariable registered as `var` for a cloud read.
+const void* OnVariableRead(const char* /*name*/,
+                           Spark_Data_TypeDef /*type*/,
+                           const void* var,
+                           void* /*reserved*/) {
+  return static_cast<ComputedVariable*>(const_cast<void*>(var))->Read();
+}
 
 }  // namespace
 
@@ -88,25 +108,23 @@ ParticleCloudBackend& ParticleCloudBackend::Instance() {
 // -- ParticleCloudBackend Implementation --
 
 ParticleCloudBackend::ParticleCloudBackend() {
-  g_instance = this;
-  PW_LOG_INFO("ParticleCloudBackend constructed at %p",
-              static_cast<void*>(this));
-
-  // Log trampoline addresses for debugging
-  PW_LOG_INFO("Trampoline array:");
-  for (int i = 0; i < 3; ++i) {
-    PW_LOG_INFO("  kTrampolines[%d] = 0x%08x", i,
-                reinterpret_cast<unsigned int>(kTrampolines[i]));
-  }
+  PW_LOG_DEBUG("ParticleCloudBackend constructed at %p",
+               static_cast<void*>(this));
 }
 
 ParticleCloudBackend::~ParticleCloudBackend() {
-  PW_LOG_INFO("ParticleCloudBackend destructing");
+  PW_LOG_DEBUG("ParticleCloudBackend destructing");
+}
+
+bool ParticleCloudBackend::IsConnected() const {
+  return spark_cloud_flag_connected();
 }
 
 PublishFuture ParticleCloudBackend::Publish(std::string_view name,
                                             pw::ConstByteSpan data,
                                             const PublishOptions& options) {
+  g_counters.publishes.Increment();
+
   // Build flags
   uint32_t flags = 0;
   if (options.scope == EventScope::kPrivate) {
@@ -116,6 +134,18 @@ PublishFuture ParticleCloudBackend::Publish(std::string_view name,
     flags |= PUBLISH_EVENT_FLAG_WITH_ACK;
   }
 
+  auto slot = std::find_if(publish_slots_.begin(), publish_slots_.end(),
+                           [](const PublishSlot& s) { return !s.in_flight; });
+  if (slot == publish_slots_.end() ||
+      (options.priority != PublishPriority::kHigh &&
+       kMaxPendingPublishes - pending_publish_count() <=
+           kHighPriorityPublishSlots)) {
+    g_counters.publish_busy.Increment();
+    PW_LOG_DEBUG("Publish: no free publish slot of %d",
+                 static_cast<int>(kMaxPendingPublishes));
+    return PublishFuture::Resolved(pw::Status::ResourceExhausted());
+  }
+
   // Copy name to null-terminated string
   pw::InlineString<kMaxEventNameSize> name_str(name);
 
@@ -125,10 +155,12 @@ PublishFuture ParticleCloudBackend::Publish(std::string_view name,
   extra.data_size = data.size();
   extra.content_type = static_cast<int>(options.content_type);
   extra.handler_callback = &OnPublishComplete;
-  extra.handler_data = &publish_provider_;
+  extra.handler_data = &*slot;
 
-  PW_LOG_INFO("Publish: name=%s, data_size=%zu, flags=0x%x", name_str.c_str(),
-              data.size(), static_cast<unsigned>(flags));
+  // Take the future first: the ack may arrive before spark_send_event returns
+  PublishFuture future = slot->provider.Get();
+  slot->in_flight = true;
+  slot->started_us = NowMicros();
 
   // Start the publish
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
@@ -136,44 +168,163 @@ PublishFuture ParticleCloudBackend::Publish(std::string_view name,
                                   reinterpret_cast<const char*>(data.data()),
                                   options.ttl_seconds, flags, &extra);
 
-  PW_LOG_INFO("Publish: spark_send_event returned %s",
-              started ? "true" : "false");
+  PW_LOG_DEBUG("Publish: name=%s, size=%u, flags=0x%x, slot=%d, started=%d",
+               name_str.c_str(), static_cast<unsigned>(data.size()),
+               static_cast<unsigned>(flags),
+               static_cast<int>(slot - publish_slots_.begin()),
+               static_cast<int>(started));
 
-  if (!started) {
+  if (!started && slot->in_flight) {
     // Publish failed to start (e.g., not connected)
-    publish_provider_.Resolve(pw::Status::Unavailable());
+    g_counters.publish_unavailable.Increment();
+    slot->in_flight = false;
+    slot->provider.Resolve(pw::Status::Unavailable());
   }
 
-  return publish_provider_.Get();
+  return future;
 }
 
-EventReceiver ParticleCloudBackend::Subscribe(std::string_view prefix) {
-  // Copy prefix for subscription
-  subscription_prefix_ = pw::InlineString<kMaxEventNameSize>(prefix);
+CloudStats ParticleCloudBackend::stats() const {
+  CloudStats stats{
+      .publishes = g_counters.publishes.value(),
+      .publish_acks = g_counters.publish_acks.value(),
+      .publish_errors = g_counters.publish_errors.value(),
+      .publish_unavailable = g_counters.publish_unavailable.value(),
+      .publish_busy = g_counters.publish_busy.value(),
+      .publish_latency_max_ms = g_counters.publish_latency_max_ms.value(),
+      .events_received = g_counters.events_received.value(),
+      .events_dropped = g_counters.events_dropped.value(),
+      .function_calls = g_counters.function_calls.value(),
+      .function_time_max_us = g_counters.function_time_max_us.value(),
+      .function_time_total_us = g_counters.function_time_total_us.value(),
+  };
+  for (size_t i = 0; i < kCloudLatencyBuckets; ++i) {
+    stats.publish_latency_ms[i] = g_counters.publish_latency[i]->value();
+  }
+  return stats;
+}
+
+void ParticleCloudBackend::ResetStats() {
+  g_counters.publishes.Set(0);
+  g_counters.publish_acks.Set(0);
+  g_counters.publish_errors.Set(0);
+  g_counters.publish_unavailable.Set(0);
+  g_counters.publish_busy.Set(0);
+  g_counters.publish_latency_max_ms.Set(0);
+  for (auto* bucket : g_counters.publish_latency) {
+    bucket->Set(0);
+  }
+  g_counters.events_received.Set(0);
+  g_counters.events_dropped.Set(0);
+  g_counters.function_calls.Set(0);
+  g_counters.function_time_max_us.Set(0);
+  g_counters.function_time_total_us.Set(0);
+}
+
+pw::metric::Group& ParticleCloudBackend::metrics() { return g_counters.group; }
 
-  // Check cloud connection status
-  bool connected = spark_cloud_flag_connected();
-  PW_LOG_INFO("Subscribe: cloud_connected=%s", connected ? "true" : "false");
+uint32_t ParticleCloudBackend::dropped_event_count() const {
+  return g_counters.events_dropped.value();
+}
 
-  PW_LOG_INFO("Subscribe: prefix='%s', handler=%p", subscription_prefix_.c_str(),
-              reinterpret_cast<void*>(&OnEventReceived));
+size_t ParticleCloudBackend::pending_publish_count() const {
+  return static_cast<size_t>(
+      std::count_if(publish_slots_.begin(), publish_slots_.end(),
+                    [](const PublishSlot& s) { return s.in_flight; }));
+}
 
-  // Use simplest form: no handler_data, no extra params
-  bool success = spark_subscribe(subscription_prefix_.c_str(), &OnEventReceived,
-                                 nullptr,     // handler_data
-                                 MY_DEVICES,  // deprecated, ignored
-                                 nullptr,     // deprecated, ignored
-                                 nullptr);    // no extra params
+EventReceiver ParticleCloudBackend::Subscribe(std::string_view prefix) {
+  // The default storage serves one subscription at a time
+  for (Subscription& sub : subscriptions_) {
+    if (sub.uses_default_storage) {
+      EndSubscription(sub);
+    }
+  }
 
-  PW_LOG_INFO("Subscribe: spark_subscribe returned %s",
-              success ? "true" : "false");
+  auto [handle, sender, receiver] =
+      pw::async2::CreateSpscChannel<ReceivedEvent>(event_channel_storage_);
+  pw::Result<Subscription*> sub = AddSubscription(prefix);
+  if (sub.ok()) {
+    sub.value()->handle = std::move(handle);
+    sub.value()->sender = std::move(sender);
+    sub.value()->uses_default_storage = true;
+  } else {
+    sender.Disconnect();
+  }
+  return std::move(receiver);
+}
 
-  if (!success) {
-    PW_LOG_ERROR("Failed to subscribe to %s", subscription_prefix_.c_str());
+pw::Status ParticleCloudBackend::DoSubscribe(
+    std::string_view prefix,
+    pw::async2::SpscChannelHandle<ReceivedEvent>& handle,
+    EventSender& sender) {
+  PW_TRY_ASSIGN(Subscription * sub, AddSubscription(prefix));
+  sub->handle = std::move(handle);
+  sub->sender = std::move(sender);
+  return pw::OkStatus();
+}
+
+pw::Status ParticleCloudBackend::DoSubscribe(
+    std::string_view prefix,
+    pw::async2::SpscChannelHandle<CompactEvent>& handle,
+    CompactEventSender& sender,
+    EventArena& arena) {
+  PW_TRY_ASSIGN(Subscription * sub, AddSubscription(prefix));
+  sub->compact_handle = std::move(handle);
+  sub->compact_sender = std::move(sender);
+  sub->arena = &arena;
+  return pw::OkStatus();
+}
+
+pw::Result<ParticleCloudBackend::Subscription*>
+ParticleCloudBackend::AddSubscription(std::string_view prefix) {
+  // A slot is free once its receiver is gone
+  Subscription* slot = nullptr;
+  for (Subscription& sub : subscriptions_) {
+    if (!sub.is_open()) {
+      EndSubscription(sub);
+      // Prefer the slot still registered for this prefix
+      if (slot == nullptr ||
+          std::string_view(sub.registered_prefix) == prefix) {
+        slot = &sub;
+      }
+    }
+  }
+  if (slot == nullptr) {
+    PW_LOG_ERROR("Subscribe: all %d subscriptions in use",
+                 static_cast<int>(kMaxEventSubscriptions));
+    return pw::Status::ResourceExhausted();
   }
 
-  // Recreate channel to get a fresh receiver
-  return CreateSubscriptionReceiver();
+  slot->prefix = pw::InlineString<kMaxEventNameSize>(prefix);
+  PW_LOG_INFO("Subscribe: prefix='%s', slot=%d, cloud_connected=%s",
+              slot->prefix.c_str(),
+              static_cast<int>(slot - subscriptions_.data()),
+              spark_cloud_flag_connected() ? "true" : "false");
+
+  if (slot->registered_prefix != slot->prefix) {
+    // With handler data and SUBSCRIBE_FLAG_BINARY_DATA, Device OS calls the
+    // handler as void(const void* handler_data, const char* name,
+    // const char* data, size_t data_size, int content_type), so payloads
+    // with zero bytes arrive intact.
+    spark_subscribe_param param = {};
+    param.size = sizeof(param);
+    param.flags = SUBSCRIBE_FLAG_BINARY_DATA;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    bool success = spark_subscribe(
+        slot->prefix.c_str(), reinterpret_cast<EventHandler>(&OnEventReceived),
+        slot,
+        MY_DEVICES,  // deprecated, ignored
+        nullptr,     // deprecated, ignored
+        &param);
+    if (!success) {
+      PW_LOG_ERROR("Failed to subscribe to %s", slot->prefix.c_str());
+      slot->prefix.clear();
+      return pw::Status::Internal();
+    }
+    slot->registered_prefix = slot->prefix;
+  }
+  return slot;
 }
 
 pw::Status ParticleCloudBackend::RegisterFunction(std::string_view name,
@@ -189,27 +340,20 @@ pw::Status ParticleCloudBackend::RegisterFunction(std::string_view name,
   // Copy name to null-terminated string
   pw::InlineString<64> name_str(name);
 
-  // Get the trampoline function pointer
-  auto trampoline_fn = kTrampolines[slot];
-
   PW_LOG_INFO("RegisterFunction: name=%s, slot=%d", name_str.c_str(),
               static_cast<int>(slot));
-  PW_LOG_INFO("RegisterFunction: trampoline addr=0x%08x",
-              reinterpret_cast<unsigned int>(trampoline_fn));
-  PW_LOG_INFO("RegisterFunction: handler_set=%s",
-              function_handlers_[slot] ? "true" : "false");
-
-  // Verify trampoline is not null
-  if (trampoline_fn == nullptr) {
-    PW_LOG_ERROR("RegisterFunction: trampoline is NULL!");
-    return pw::Status::Internal();
-  }
-
-  // Register trampoline with Particle
-  bool success = spark_function(name_str.c_str(), trampoline_fn, nullptr);
 
-  PW_LOG_INFO("RegisterFunction: spark_function returned %s",
-              success ? "true" : "false");
+  // With a null name, Device OS reads the function argument as a
+  // descriptor and calls fn with its data, so one dispatcher serves every
+  // slot. The key is copied.
+  cloud_function_descriptor desc = {};
+  desc.size = sizeof(desc);
+  desc.funcKey = name_str.c_str();
+  desc.fn = &OnFunctionCall;
+  desc.data = &function_handlers_[slot];
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  bool success = spark_function(
+      nullptr, reinterpret_cast<user_function_int_str_t*>(&desc), nullptr);
 
   if (!success) {
     PW_LOG_ERROR("Failed to register function %s", name_str.c_str());
@@ -226,7 +370,29 @@ pw::Status ParticleCloudBackend::DoRegisterVariable(
     std::string_view name,
     const void* data,
     VariableType type,
-    std::unique_ptr<void, VariableDeleter> storage) {
+    VariableStorage storage) {
+  return RegisterSparkVariable(name, data, type, nullptr, std::move(storage));
+}
+
+pw::Status ParticleCloudBackend::DoRegisterComputedVariable(
+    std::string_view name,
+    ComputedVariable& variable,
+    VariableStorage storage) {
+  // With an update callback, Device OS calls it on each read with the
+  // registered pointer and sends the value it returns
+  spark_variable_t extra = {};
+  extra.size = sizeof(extra);
+  extra.update = &OnVariableRead;
+  return RegisterSparkVariable(name, &variable, variable.type(), &extra,
+                               std::move(storage));
+}
+
+pw::Status ParticleCloudBackend::RegisterSparkVariable(
+    std::string_view name,
+    const void* data,
+    VariableType type,
+    void* extra,
+    VariableStorage storage) {
   if (variable_count_ >= kMaxCloudVariables) {
     PW_LOG_ERROR("Max cloud variables reached (%zu)", kMaxCloudVariables);
     return pw::Status::ResourceExhausted();
@@ -254,20 +420,11 @@ pw::Status ParticleCloudBackend::DoRegisterVariable(
       return pw::Status::InvalidArgument();
   }
 
-  PW_LOG_INFO("RegisterVariable: name=%s, data=%p, type=%d, spark_type=%d",
-              name_str.c_str(), data, static_cast<int>(type),
-              static_cast<int>(spark_type));
-
-  // Log the actual value for debugging (assuming int for now)
-  if (type == VariableType::kInt) {
-    PW_LOG_INFO("RegisterVariable: int value = %d",
-                *static_cast<const int*>(data));
-  }
-
-  bool success = spark_variable(name_str.c_str(), data, spark_type, nullptr);
+  PW_LOG_INFO("RegisterVariable: name=%s, type=%d", name_str.c_str(),
+              static_cast<int>(type));
 
-  PW_LOG_INFO("RegisterVariable: spark_variable returned %s",
-              success ? "true" : "false");
+  bool success = spark_variable(name_str.c_str(), data, spark_type,
+                                static_cast<spark_variable_t*>(extra));
 
   if (!success) {
     PW_LOG_ERROR("Failed to register variable %s", name_str.c_str());
@@ -275,75 +432,133 @@ pw::Status ParticleCloudBackend::DoRegisterVariable(
   }
 
   // Store ownership of the variable container
-  variable_storage_[variable_count_] =
-      std::shared_ptr<void>(storage.release(), storage.get_deleter());
+  variable_storage_[variable_count_] = std::move(storage);
   ++variable_count_;
-
-  PW_LOG_INFO("RegisterVariable: success, variable_count=%d",
-              static_cast<int>(variable_count_));
   return pw::OkStatus();
 }
 
-EventReceiver ParticleCloudBackend::CreateSubscriptionReceiver() {
-  // Release any existing channel by resetting the handle first
-  if (event_sender_.is_open()) {
-    event_sender_.Disconnect();
+void ParticleCloudBackend::EndSubscription(Subscription& sub) {
+  if (sub.sender.is_open()) {
+    sub.sender.Disconnect();
+  }
+  if (sub.compact_sender.is_open()) {
+    sub.compact_sender.Disconnect();
   }
-  event_channel_handle_ = {};  // Destroy old handle to release storage
+  // Release the channel storage
+  sub.handle = {};
+  sub.compact_handle = {};
+  sub.arena = nullptr;
+  sub.prefix.clear();
+  sub.uses_default_storage = false;
+}
 
-  // Create a fresh channel
-  auto [handle, sender, receiver] =
-      pw::async2::CreateSpscChannel<ReceivedEvent>(event_channel_storage_);
-  event_channel_handle_ = std::move(handle);
-  event_sender_ = std::move(sender);
-  return std::move(receiver);
+int ParticleCloudBackend::OnFunctionCall(void* data,
+                                         const char* param,
+                                         void* /*reserved*/) {
+  auto& handler = *static_cast<CloudFunction*>(data);
+  if (!handler) {
+    return -1;
+  }
+  const uint32_t start_us = NowMicros();
+  const int result =
+      handler(param ? std::string_view(param) : std::string_view());
+  const uint32_t elapsed_us = NowMicros() - start_us;
+  g_counters.function_calls.Increment();
+  g_counters.function_time_total_us.Increment(elapsed_us);
+  if (elapsed_us > g_counters.function_time_max_us.value()) {
+    g_counters.function_time_max_us.Set(elapsed_us);
+  }
+  return result;
 }
 
 void ParticleCloudBackend::OnPublishComplete(int error,
                                              const void* /*data*/,
                                              void* callback_data,
                                              void* /*reserved*/) {
-  PW_LOG_INFO("OnPublishComplete: error=%d, callback_data=%p", error,
-              callback_data);
-  auto* provider =
-      static_cast<pw::async2::ValueProvider<pw::Status>*>(callback_data);
-  if (provider) {
-    provider->Resolve(error == 0 ? pw::OkStatus() : pw::Status::Unknown());
-    PW_LOG_INFO("OnPublishComplete: resolved provider");
+  PW_LOG_DEBUG("OnPublishComplete: error=%d, callback_data=%p", error,
+               callback_data);
+  auto* slot = static_cast<PublishSlot*>(callback_data);
+  if (slot) {
+    if (error == 0) {
+      g_counters.publish_acks.Increment();
+      RecordPublishLatency((NowMicros() - slot->started_us) / 1000);
+    } else {
+      g_counters.publish_errors.Increment();
+    }
+    // Clear first: resolving may wake a task that publishes again
+    slot->in_flight = false;
+    slot->provider.Resolve(error == 0 ? pw::OkStatus() : pw::Status::Unknown());
   } else {
     PW_LOG_ERROR("OnPublishComplete: callback_data is null!");
   }
 }
 
-void ParticleCloudBackend::OnEventReceived(const char* event_name,
-                                           const char* data) {
+void ParticleCloudBackend::OnEventReceived(const void* handler_data,
+                                           const char* event_name,
+                                           const char* data,
+                                           size_t data_size,
+                                           int content_type) {
   // This is called from the Particle system thread (same as application code).
-  // We push events into the channel for the consumer to receive.
-  PW_LOG_INFO("OnEventReceived: name=%s, data=%s",
-              event_name ? event_name : "(null)", data ? data : "(null)");
+  // We push events into the channel of the subscription for the consumer to
+  // receive.
+  PW_LOG_DEBUG("OnEventReceived: name=%s", event_name ? event_name : "(null)");
 
   auto& self = Instance();
+  auto& sub = *static_cast<Subscription*>(const_cast<void*>(handler_data));
+
+  // Registrations outlive their subscription, see Subscription
+  const std::string_view name = event_name ? event_name : "";
+  if (!sub.is_open() || !name.starts_with(std::string_view(sub.prefix))) {
+    return;
+  }
+  g_counters.events_received.Increment();
+
+  // Copy data with its explicit size; it may contain zero bytes
+  const size_t data_len = data ? data_size : 0;
+
+  if (sub.arena != nullptr) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    pw::ConstByteSpan bytes(reinterpret_cast<const std::byte*>(data),
+                            std::min(data_len, kMaxEventDataSize));
+    pw::Result<CompactEvent> event =
+        sub.arena->Store(name.substr(0, kMaxEventNameSize), bytes,
+                         ToContentType(content_type));
+    if (!event.ok() || !sub.compact_sender.TrySend(std::move(*event)).ok()) {
+      self.CountDroppedEvent(sub);
+    }
+    return;
+  }
 
   ReceivedEvent event;
-  event.name = pw::InlineString<kMaxEventNameSize>(event_name);
+  event.name = pw::InlineString<kMaxEventNameSize>(name);
 
-  // Copy data (null-terminated string for simple EventHandler)
-  size_t data_len = data ? std::strlen(data) : 0;
   size_t copy_len = std::min(data_len, event.data.max_size());
+  if (copy_len < data_len) {
+    PW_LOG_WARN("OnEventReceived: '%s' truncated from %u bytes",
+                event.name.c_str(), static_cast<unsigned>(data_len));
+  }
   event.data.resize(copy_len);
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-  std::memcpy(event.data.data(), reinterpret_cast<const std::byte*>(data),
-              copy_len);
+  if (copy_len > 0) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    std::memcpy(event.data.data(), reinterpret_cast<const std::byte*>(data),
+                copy_len);
+  }
 
-  event.content_type = ContentType::kText;
+  event.content_type = ToContentType(content_type);
 
   // Push event into channel (non-blocking)
-  if (self.event_sender_.is_open()) {
-    auto status = self.event_sender_.TrySend(std::move(event));
-    PW_LOG_INFO("OnEventReceived: TrySend status=%d",
-                static_cast<int>(status.code()));
-  } else {
-    PW_LOG_WARN("OnEventReceived: channel not open, event dropped");
+  if (auto status = sub.sender.TrySend(std::move(event)); !status.ok()) {
+    self.CountDroppedEvent(sub);
+  }
+}
+
+void ParticleCloudBackend::CountDroppedEvent(const Subscription& sub) {
+  g_counters.events_dropped.Increment();
+  const uint32_t dropped = g_counters.events_dropped.value();
+  // Rate-limited: warn on the 1st, 2nd, 4th, 8th, ... dropped event
+  if ((dropped & (dropped - 1)) == 0) {
+    PW_LOG_WARN("OnEventReceived: queue of '%s' full, %u events dropped",
+                sub.prefix.c_str(), static_cast<unsigned>(dropped));
   }
 }
 
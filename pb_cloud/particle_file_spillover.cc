@@ -0,0 +1,162 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#define PW_LOG_MODULE_NAME "pb_cloud"
+#define PW_LOG_LEVEL PB_CLOUD_LOG_LEVEL
+
+#include "pb_cloud/particle_file_spillover.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "pb_cloud/config.h"
+#include "pw_log/log.h"
+#include "pw_status/try.h"
+
+namespace pb::cloud {
+
+ParticleFileSpillover::ParticleFileSpillover(const char* path,
+                                             size_t max_file_size)
+    : path_(path), max_file_size_(max_file_size) {}
+
+ParticleFileSpillover::~ParticleFileSpillover() {
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+pw::Status ParticleFileSpillover::Open() {
+  if (fd_ >= 0) {
+    return pw::OkStatus();
+  }
+  fd_ = open(path_, O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0) {
+    PW_LOG_ERROR("Spillover: can't open %s", path_);
+    return pw::Status::Unavailable();
+  }
+
+  const off_t size = lseek(fd_, 0, SEEK_END);
+  uint32_t head = 0;
+  if (size < static_cast<off_t>(kFileHeaderSize) ||
+      !ReadAt(0, &head, sizeof(head)) || head < kFileHeaderSize ||
+      head > static_cast<uint32_t>(size)) {
+    return Reset();
+  }
+
+  // Walk the records to find the end of the last complete one
+  uint32_t offset = head;
+  uint32_t count = 0;
+  while (offset + kRecordLengthSize <= static_cast<uint32_t>(size)) {
+    uint16_t len = 0;
+    if (!ReadAt(offset, &len, sizeof(len)) || len == 0 ||
+        len > kMaxQueuedRecordSize ||
+        offset + kRecordLengthSize + len > static_cast<uint32_t>(size)) {
+      break;
+    }
+    offset += kRecordLengthSize + len;
+    ++count;
+  }
+  head_ = head;
+  end_ = offset;
+  if (end_ != static_cast<uint32_t>(size)) {
+    PW_LOG_WARN("Spillover: discarding %u bytes of a partial record",
+                static_cast<unsigned>(size - end_));
+    ftruncate(fd_, end_);
+  }
+  if (empty()) {
+    return Reset();
+  }
+  PW_LOG_INFO("Spillover: %u queued events in %s",
+              static_cast<unsigned>(count), path_);
+  return pw::OkStatus();
+}
+
+pw::Status ParticleFileSpillover::Push(pw::ConstByteSpan record) {
+  if (fd_ < 0) {
+    return pw::Status::FailedPrecondition();
+  }
+  if (record.empty() || record.size() > kMaxQueuedRecordSize) {
+    return pw::Status::InvalidArgument();
+  }
+  if (end_ + kRecordLengthSize + record.size() > max_file_size_) {
+    return pw::Status::ResourceExhausted();
+  }
+
+  const auto len = static_cast<uint16_t>(record.size());
+  if (!WriteAt(end_, &len, sizeof(len)) ||
+      !WriteAt(end_ + kRecordLengthSize, record.data(), record.size())) {
+    // Open() discards the partial record after a reboot; drop it now too
+    ftruncate(fd_, end_);
+    return pw::Status::DataLoss();
+  }
+  fsync(fd_);
+  end_ += kRecordLengthSize + record.size();
+  return pw::OkStatus();
+}
+
+pw::StatusWithSize ParticleFileSpillover::Peek(pw::ByteSpan dest) {
+  if (fd_ < 0 || empty()) {
+    return pw::StatusWithSize::NotFound();
+  }
+  uint16_t len = 0;
+  if (!ReadAt(head_, &len, sizeof(len))) {
+    return pw::StatusWithSize::DataLoss();
+  }
+  if (len > dest.size()) {
+    return pw::StatusWithSize::ResourceExhausted();
+  }
+  if (!ReadAt(head_ + kRecordLengthSize, dest.data(), len)) {
+    return pw::StatusWithSize::DataLoss();
+  }
+  return pw::StatusWithSize(len);
+}
+
+pw::Status ParticleFileSpillover::Pop() {
+  if (fd_ < 0 || empty()) {
+    return pw::Status::NotFound();
+  }
+  uint16_t len = 0;
+  if (!ReadAt(head_, &len, sizeof(len))) {
+    return pw::Status::DataLoss();
+  }
+  head_ += kRecordLengthSize + len;
+  if (empty()) {
+    return Reset();
+  }
+  PW_TRY(WriteHead());
+  fsync(fd_);
+  return pw::OkStatus();
+}
+
+pw::Status ParticleFileSpillover::Reset() {
+  head_ = kFileHeaderSize;
+  end_ = kFileHeaderSize;
+  if (ftruncate(fd_, 0) != 0) {
+    return pw::Status::DataLoss();
+  }
+  PW_TRY(WriteHead());
+  fsync(fd_);
+  return pw::OkStatus();
+}
+
+pw::Status ParticleFileSpillover::WriteHead() {
+  const uint32_t head = head_;
+  return WriteAt(0, &head, sizeof(head)) ? pw::OkStatus()
+                                         : pw::Status::DataLoss();
+}
+
+bool ParticleFileSpillover::ReadAt(uint32_t offset, void* dest, size_t len) {
+  return lseek(fd_, static_cast<off_t>(offset), SEEK_SET) ==
+             static_cast<off_t>(offset) &&
+         read(fd_, dest, len) == static_cast<ssize_t>(len);
+}
+
+bool ParticleFileSpillover::WriteAt(uint32_t offset,
+                                    const void* src,
+                                    size_t len) {
+  return lseek(fd_, static_cast<off_t>(offset), SEEK_SET) ==
+             static_cast<off_t>(offset) &&
+         write(fd_, src, len) == static_cast<ssize_t>(len);
+}
+
+}  // namespace pb::cloud
@@ -1,16 +1,17 @@
 // Copyright Offene Werkstatt Wädenswil
 // SPDX-License-Identifier: MIT
 
+#define PW_LOG_MODULE_NAME "pb_ledger"
+#define PW_LOG_LEVEL PB_CLOUD_LOG_LEVEL
+
 #include "pb_cloud/particle_ledger_backend.h"
 
 #include <cstdlib>
 #include <cstring>
 
-#include "system_ledger.h"
-
-#define PW_LOG_MODULE_NAME "pb_ledger"
-
+#include "pb_cloud/config.h"
 #include "pw_log/log.h"
+#include "system_ledger.h"
 
 namespace pb::cloud {
 namespace {
@@ -49,16 +50,32 @@ ParticleLedgerBackend& ParticleLedgerBackend::Instance() {
 
 ParticleLedgerBackend::ParticleLedgerBackend() {
   g_instance = this;
-  PW_LOG_INFO("ParticleLedgerBackend constructed at %p",
-              static_cast<void*>(this));
+  PW_LOG_DEBUG("ParticleLedgerBackend constructed at %p",
+               static_cast<void*>(this));
 }
 
 ParticleLedgerBackend::~ParticleLedgerBackend() {
-  PW_LOG_INFO("ParticleLedgerBackend destructing");
+  PW_LOG_DEBUG("ParticleLedgerBackend destructing");
 }
 
 pw::Result<LedgerHandle> ParticleLedgerBackend::GetLedger(
     std::string_view name) {
+  internal::LedgerInstance* instance = AcquireInstance(name);
+  if (instance == nullptr) {
+    return pw::Status::Internal();
+  }
+  return MakeHandle(instance);
+}
+
+internal::LedgerInstance* ParticleLedgerBackend::AcquireInstance(
+    std::string_view name) {
+  for (auto& cached : instances_) {
+    if (cached.instance != nullptr && std::string_view(cached.name) == name) {
+      ++cached.handles;
+      return cached.instance;
+    }
+  }
+
   // Copy name to null-terminated string
   pw::InlineString<kMaxLedgerNameSize> name_str(name);
 
@@ -68,16 +85,57 @@ pw::Result<LedgerHandle> ParticleLedgerBackend::GetLedger(
   if (result != 0 || ledger == nullptr) {
     PW_LOG_ERROR("Failed to get ledger '%s': error=%d", name_str.c_str(),
                  result);
-    return pw::Status::Internal();
+    return nullptr;
   }
 
-  PW_LOG_INFO("Got ledger '%s' at %p", name_str.c_str(),
-              static_cast<void*>(ledger));
+  PW_LOG_DEBUG("Got ledger '%s' at %p", name_str.c_str(),
+               static_cast<void*>(ledger));
 
-  // Create handle - the instance pointer is the ledger_instance*
+  // The instance pointer is the ledger_instance*
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
   auto* instance = reinterpret_cast<internal::LedgerInstance*>(ledger);
-  return MakeHandle(instance);
+
+  // Cache it in a free slot, or in place of an unused instance
+  CachedInstance* slot = nullptr;
+  for (auto& cached : instances_) {
+    if (cached.instance == nullptr) {
+      slot = &cached;
+      break;
+    }
+    if (cached.handles == 0 && slot == nullptr) {
+      slot = &cached;
+    }
+  }
+  if (slot == nullptr) {
+    // All cached ledgers are in use: the handle releases it when closed
+    PW_LOG_DEBUG("Ledger instance cache full, '%s' not cached",
+                 name_str.c_str());
+    return instance;
+  }
+  if (slot->instance != nullptr) {
+    ForgetWrites(slot->instance);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    ledger_release(reinterpret_cast<ledger_instance*>(slot->instance),
+                   nullptr);
+  }
+  slot->name = name_str;
+  slot->instance = instance;
+  slot->handles = 1;
+  return instance;
+}
+
+void ParticleLedgerBackend::DropUnusedInstances(std::string_view name) {
+  for (auto& cached : instances_) {
+    if (cached.instance == nullptr || cached.handles != 0 ||
+        (!name.empty() && std::string_view(cached.name) != name)) {
+      continue;
+    }
+    ForgetWrites(cached.instance);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    ledger_release(reinterpret_cast<ledger_instance*>(cached.instance),
+                   nullptr);
+    cached = CachedInstance{};
+  }
 }
 
 SyncEventReceiver ParticleLedgerBackend::SubscribeToSync(
@@ -104,21 +162,22 @@ SyncEventReceiver ParticleLedgerBackend::SubscribeToSync(
   sub->handle = std::move(handle);
   sub->sender = std::move(sender);
 
-  // Get the ledger and set up the sync callback
+  // Get the ledger and set up the sync callback. The subscription keeps
+  // the cached instance in use, so later handles reuse it.
   pw::InlineString<kMaxLedgerNameSize> name_str(name);
-  ledger_instance* ledger = nullptr;
-  int result = ledger_get_instance(&ledger, name_str.c_str(), nullptr);
-  if (result == 0 && ledger != nullptr) {
+  if (sub->instance == nullptr) {
+    sub->instance = AcquireInstance(name);
+  }
+  if (sub->instance != nullptr) {
     // Set callback
     ledger_callbacks callbacks{};
     callbacks.version = LEDGER_API_VERSION;
     callbacks.sync = [](ledger_instance* ledger, void* /*app_data*/) {
       OnLedgerSync(ledger, nullptr);
     };
-    ledger_set_callbacks(ledger, &callbacks, nullptr);
-
-    // Release our reference (callback will still work)
-    ledger_release(ledger, nullptr);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    ledger_set_callbacks(reinterpret_cast<ledger_instance*>(sub->instance),
+                         &callbacks, nullptr);
   }
 
   PW_LOG_INFO("Subscribed to sync for '%s'", name_str.c_str());
@@ -145,13 +204,16 @@ pw::Status ParticleLedgerBackend::GetLedgerNames(
   }
   std::free(raw_names);
 
-  PW_LOG_INFO("Got %d ledger names", static_cast<int>(names.size()));
+  PW_LOG_DEBUG("Got %d ledger names", static_cast<int>(names.size()));
   return pw::OkStatus();
 }
 
 pw::Status ParticleLedgerBackend::Purge(std::string_view name) {
+  // Device OS refuses to purge a ledger that is still open
+  DropUnusedInstances(name);
   pw::InlineString<kMaxLedgerNameSize> name_str(name);
   int result = ledger_purge(name_str.c_str(), nullptr);
+  ++revision_;
   if (result != 0) {
     PW_LOG_ERROR("Failed to purge ledger '%s': error=%d", name_str.c_str(),
                  result);
@@ -160,7 +222,9 @@ pw::Status ParticleLedgerBackend::Purge(std::string_view name) {
 }
 
 pw::Status ParticleLedgerBackend::PurgeAll() {
+  DropUnusedInstances({});
   int result = ledger_purge_all(nullptr);
+  ++revision_;
   if (result != 0) {
     PW_LOG_ERROR("Failed to purge all ledgers: error=%d", result);
   }
@@ -171,6 +235,16 @@ void ParticleLedgerBackend::ReleaseLedger(internal::LedgerInstance* instance) {
   if (instance == nullptr) {
     return;
   }
+  for (auto& cached : instances_) {
+    if (cached.instance == instance) {
+      // Stays open for the next GetLedger()
+      if (cached.handles > 0) {
+        --cached.handles;
+      }
+      return;
+    }
+  }
+  ForgetWrites(instance);
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
   auto* ledger = reinterpret_cast<ledger_instance*>(instance);
   ledger_release(ledger, nullptr);
@@ -288,6 +362,7 @@ pw::Status ParticleLedgerBackend::DoWrite(internal::LedgerInstance* instance,
   }
 
   // Write data
+  ++revision_;
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
   auto* char_data = reinterpret_cast<const char*>(data.data());
   int bytes_written = ledger_write(stream, char_data, data.size(), nullptr);
@@ -309,6 +384,78 @@ pw::Status ParticleLedgerBackend::DoWrite(internal::LedgerInstance* instance,
   return pw::OkStatus();
 }
 
+pw::Result<internal::LedgerStream*> ParticleLedgerBackend::DoOpenStream(
+    internal::LedgerInstance* instance, LedgerStreamMode mode) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  auto* ledger = reinterpret_cast<ledger_instance*>(instance);
+
+  ledger_stream* stream = nullptr;
+  const int stream_mode = mode == LedgerStreamMode::kRead
+                              ? LEDGER_STREAM_MODE_READ
+                              : LEDGER_STREAM_MODE_WRITE;
+  int result = ledger_open(&stream, ledger, stream_mode, nullptr);
+  if (result != 0 || stream == nullptr) {
+    PW_LOG_ERROR("Failed to open ledger stream: error=%d", result);
+    return result != 0 ? ToStatus(result) : pw::Status::Internal();
+  }
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return reinterpret_cast<internal::LedgerStream*>(stream);
+}
+
+pw::StatusWithSize ParticleLedgerBackend::DoReadStream(
+    internal::LedgerStream* stream, pw::ByteSpan buffer) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  auto* ledger_stream_ptr = reinterpret_cast<ledger_stream*>(stream);
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  auto* char_buffer = reinterpret_cast<char*>(buffer.data());
+  int bytes_read =
+      ledger_read(ledger_stream_ptr, char_buffer, buffer.size(), nullptr);
+  if (bytes_read < 0) {
+    PW_LOG_ERROR("Failed to read ledger stream: error=%d", bytes_read);
+    return pw::StatusWithSize(ToStatus(bytes_read), 0);
+  }
+  return pw::StatusWithSize(static_cast<size_t>(bytes_read));
+}
+
+pw::Status ParticleLedgerBackend::DoWriteStream(internal::LedgerStream* stream,
+                                                pw::ConstByteSpan data) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  auto* ledger_stream_ptr = reinterpret_cast<ledger_stream*>(stream);
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  auto* char_data = reinterpret_cast<const char*>(data.data());
+  int bytes_written =
+      ledger_write(ledger_stream_ptr, char_data, data.size(), nullptr);
+  if (bytes_written < 0) {
+    PW_LOG_ERROR("Failed to write ledger stream: error=%d", bytes_written);
+    return ToStatus(bytes_written);
+  }
+  if (static_cast<size_t>(bytes_written) != data.size()) {
+    return pw::Status::DataLoss();
+  }
+  return pw::OkStatus();
+}
+
+pw::Status ParticleLedgerBackend::DoCloseStream(internal::LedgerStream* stream,
+                                                bool commit) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  auto* ledger_stream_ptr = reinterpret_cast<ledger_stream*>(stream);
+  // Discarding is harmless for read streams
+  const int flags = commit ? 0 : LEDGER_STREAM_CLOSE_DISCARD;
+  int result = ledger_close(ledger_stream_ptr, flags, nullptr);
+  if (commit) {
+    ++revision_;
+  }
+  if (result != 0) {
+    PW_LOG_ERROR("Failed to close ledger stream: error=%d", result);
+  }
+  return ToStatus(result);
+}
+
+uint32_t ParticleLedgerBackend::DoGetRevision(
+    internal::LedgerInstance* /*instance*/) {
+  return revision_;
+}
+
 ParticleLedgerBackend::Subscription*
 ParticleLedgerBackend::FindOrCreateSubscription(std::string_view name) {
   // Find existing
@@ -334,6 +481,7 @@ void ParticleLedgerBackend::OnLedgerSync(void* ledger_ptr, void* /*app_data*/) {
   if (g_instance == nullptr || ledger_ptr == nullptr) {
     return;
   }
+  ++g_instance->revision_;
 
   // Get ledger info to find the name
   auto* ledger = static_cast<ledger_instance*>(ledger_ptr);
@@ -347,7 +495,7 @@ void ParticleLedgerBackend::OnLedgerSync(void* ledger_ptr, void* /*app_data*/) {
   }
 
   std::string_view name(info.name);
-  PW_LOG_INFO("Ledger sync complete: %s", info.name);
+  PW_LOG_DEBUG("Ledger sync complete: %s", info.name);
 
   // Find subscription and send event
   for (auto& sub : g_instance->subscriptions_) {
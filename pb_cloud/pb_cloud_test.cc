@@ -1,6 +1,9 @@
 // Copyright Offene Werkstatt Wädenswil
 // SPDX-License-Identifier: MIT
 
+#include <algorithm>
+#include <array>
+#include <optional>
 #include <string_view>
 
 #include "pb_cloud/cloud.h"
@@ -54,6 +57,138 @@ TEST_F(CloudBackendTest, PublishCountIncrements) {
   EXPECT_EQ(mock_.publish_count(), 3u);
 }
 
+TEST_F(CloudBackendTest, PublishesStayPendingUntilCompleted) {
+  auto first = mock_.Publish("a", pw::ConstByteSpan(), {});
+  auto second = mock_.Publish("b", pw::ConstByteSpan(), {});
+  EXPECT_EQ(mock_.pending_publish_count(), 2u);
+
+  mock_.SimulatePublishSuccess();
+  EXPECT_EQ(mock_.pending_publish_count(), 1u);
+
+  mock_.SimulatePublishFailure(pw::Status::Unavailable());
+  EXPECT_EQ(mock_.pending_publish_count(), 0u);
+}
+
+constexpr PublishOptions kHighPriority{.priority = PublishPriority::kHigh};
+
+TEST_F(CloudBackendTest, PublishDoesNotTakeSlotWhenAllInFlight) {
+  std::array<PublishFuture, kMaxPendingPublishes> futures;
+  for (auto& future : futures) {
+    future = mock_.Publish("a", pw::ConstByteSpan(), kHighPriority);
+  }
+  EXPECT_EQ(mock_.pending_publish_count(), kMaxPendingPublishes);
+
+  auto rejected = mock_.Publish("b", pw::ConstByteSpan(), kHighPriority);
+  EXPECT_EQ(mock_.pending_publish_count(), kMaxPendingPublishes);
+  EXPECT_EQ(mock_.publish_count(), kMaxPendingPublishes + 1);
+
+  // A completed publish frees its slot for the next one
+  mock_.SimulatePublishSuccess();
+  auto next = mock_.Publish("c", pw::ConstByteSpan(), kHighPriority);
+  EXPECT_EQ(mock_.pending_publish_count(), kMaxPendingPublishes);
+}
+
+TEST_F(CloudBackendTest, HighPrioritySlotsAreReserved) {
+  constexpr size_t kNormalSlots =
+      kMaxPendingPublishes - kHighPriorityPublishSlots;
+  std::array<PublishFuture, kNormalSlots> futures;
+  for (auto& future : futures) {
+    future = mock_.Publish("telemetry", pw::ConstByteSpan(), {});
+  }
+  EXPECT_EQ(mock_.pending_publish_count(), kNormalSlots);
+
+  auto rejected = mock_.Publish("telemetry", pw::ConstByteSpan(), {});
+  EXPECT_EQ(mock_.pending_publish_count(), kNormalSlots);
+  EXPECT_EQ(mock_.stats().publish_busy, 1u);
+
+  auto alarm = mock_.Publish("alarm", pw::ConstByteSpan(), kHighPriority);
+  EXPECT_EQ(mock_.pending_publish_count(), kNormalSlots + 1);
+  EXPECT_EQ(mock_.stats().publish_busy, 1u);
+}
+
+TEST_F(CloudBackendTest, StatsCountPublishOutcomes) {
+  std::array<PublishFuture, kMaxPendingPublishes> futures;
+  for (auto& future : futures) {
+    future = mock_.Publish("a", pw::ConstByteSpan(), kHighPriority);
+  }
+  auto rejected = mock_.Publish("b", pw::ConstByteSpan(), {});
+  mock_.SimulatePublishSuccess();
+  mock_.SimulatePublishFailure(pw::Status::DeadlineExceeded());
+
+  CloudStats stats = mock_.stats();
+  EXPECT_EQ(stats.publishes, kMaxPendingPublishes + 1);
+  EXPECT_EQ(stats.publish_busy, 1u);
+  EXPECT_EQ(stats.publish_acks, 1u);
+  EXPECT_EQ(stats.publish_errors, 1u);
+
+  mock_.ResetStats();
+  EXPECT_EQ(mock_.stats().publishes, 0u);
+}
+
+TEST_F(CloudBackendTest, PublishTypedUsesCallerBuffer) {
+  std::array<std::byte, 8> buffer{};
+  auto future = PublishTyped(mock_, "status", std::string_view("online"),
+                             pw::ByteSpan(buffer), {});
+
+  EXPECT_EQ(mock_.last_published().name, "status");
+  EXPECT_EQ(mock_.last_published().data.size(), 6u);
+  EXPECT_EQ(mock_.last_published().options.content_type, ContentType::kText);
+  EXPECT_EQ(buffer[0], std::byte{'o'});
+}
+
+TEST_F(CloudBackendTest, PublishTypedUsesPublishBuffer) {
+  auto future =
+      PublishTyped(mock_, "status", std::string_view("online"), {});
+
+  EXPECT_EQ(mock_.last_published().name, "status");
+  EXPECT_EQ(mock_.last_published().data.size(), 6u);
+  // Returned to the pool once the data was handed to the backend
+  EXPECT_EQ(mock_.available_publish_buffers(), kPublishBufferCount);
+}
+
+TEST_F(CloudBackendTest, PublishTypedFailsWhenNoPublishBufferFree) {
+  std::array<PublishBuffer, kPublishBufferCount> leased;
+  for (auto& buffer : leased) {
+    auto result = mock_.AcquirePublishBuffer();
+    ASSERT_TRUE(result.ok());
+    buffer = std::move(result.value());
+  }
+  EXPECT_EQ(mock_.AcquirePublishBuffer().status(),
+            pw::Status::ResourceExhausted());
+
+  auto future = PublishTyped(mock_, "status", std::string_view("online"));
+  EXPECT_EQ(mock_.publish_count(), 0u);
+
+  leased[0].Release();
+  EXPECT_EQ(mock_.available_publish_buffers(), 1u);
+}
+
+TEST_F(CloudBackendTest, PublishLeasedBufferChecksSize) {
+  auto buffer = mock_.AcquirePublishBuffer();
+  ASSERT_TRUE(buffer.ok());
+  ASSERT_EQ(buffer.value().data().size(), kMaxEventDataSize);
+  buffer.value().data()[0] = std::byte{0x2a};
+
+  auto future = mock_.Publish("raw", std::move(buffer.value()), 1, {});
+  EXPECT_EQ(mock_.last_published().data.size(), 1u);
+  EXPECT_EQ(mock_.last_published().data[0], std::byte{0x2a});
+
+  auto too_large = mock_.AcquirePublishBuffer();
+  ASSERT_TRUE(too_large.ok());
+  auto rejected = mock_.Publish("raw", std::move(too_large.value()),
+                                kMaxEventDataSize + 1, {});
+  EXPECT_EQ(mock_.publish_count(), 1u);
+}
+
+TEST_F(CloudBackendTest, PublishTypedDoesNotPublishWhenSerializeFails) {
+  std::array<std::byte, 4> buffer{};
+  auto future = PublishTyped(mock_, "status", std::string_view("online"),
+                             pw::ByteSpan(buffer), {});
+
+  EXPECT_EQ(mock_.publish_count(), 0u);
+  EXPECT_EQ(mock_.pending_publish_count(), 0u);
+}
+
 // -- Subscription Tests --
 
 TEST_F(CloudBackendTest, SubscribeRecordsPrefix) {
@@ -62,6 +197,119 @@ TEST_F(CloudBackendTest, SubscribeRecordsPrefix) {
   EXPECT_EQ(mock_.subscription_prefix(), "device/");
 }
 
+class SubscriptionTest : public ::testing::Test {
+ protected:
+  void TearDown() override { mock_.Reset(); }
+
+  static constexpr std::array<std::byte, 1> kData = {std::byte{'x'}};
+
+  // Declared before mock_ so the channels outlive its subscriptions
+  EventChannelStorage<1> command_storage_;
+  EventChannelStorage<2> config_storage_;
+  std::array<EventChannelStorage<1>, kMaxEventSubscriptions> extra_storage_;
+  MockCloudBackend mock_;
+};
+
+TEST_F(SubscriptionTest, SubscribeWithStorageKeepsOtherSubscriptions) {
+  auto commands = mock_.Subscribe("device/command", command_storage_);
+  auto config = mock_.Subscribe("device/config", config_storage_);
+  auto all = mock_.Subscribe("device/");
+
+  EXPECT_EQ(mock_.subscription_count(), 3u);
+}
+
+TEST_F(SubscriptionTest, DefaultSubscribeReplacesOnlyItself) {
+  auto commands = mock_.Subscribe("device/command", command_storage_);
+  auto first = mock_.Subscribe("a/");
+  auto second = mock_.Subscribe("b/");
+
+  EXPECT_EQ(mock_.subscription_count(), 2u);
+  EXPECT_EQ(mock_.subscription_prefix(), "b/");
+}
+
+TEST_F(SubscriptionTest, EventsGoToMatchingSubscriptionsOnly) {
+  auto commands = mock_.Subscribe("device/command", command_storage_);
+  auto config = mock_.Subscribe("device/config", config_storage_);
+
+  // Fills the command queue (depth 1); the second command is dropped
+  mock_.SimulateEventReceived("device/command/reboot", kData);
+  mock_.SimulateEventReceived("device/command/update", kData);
+  EXPECT_EQ(mock_.dropped_event_count(), 1u);
+
+  // The config queue is unaffected by the command burst
+  mock_.SimulateEventReceived("device/config/rate", kData);
+  mock_.SimulateEventReceived("device/config/mode", kData);
+  EXPECT_EQ(mock_.dropped_event_count(), 1u);
+
+  mock_.SimulateEventReceived("other/event", kData);
+  EXPECT_EQ(mock_.dropped_event_count(), 1u);
+
+  EXPECT_EQ(mock_.stats().events_received, 4u);
+  EXPECT_EQ(mock_.stats().events_dropped, 1u);
+}
+
+TEST_F(SubscriptionTest, BinaryEventKeepsZeroBytesAndContentType) {
+  auto commands = mock_.Subscribe("device/command", command_storage_);
+  constexpr std::array<std::byte, 4> kPayload = {
+      std::byte{0x82}, std::byte{0x00}, std::byte{0x00}, std::byte{0x01}};
+
+  mock_.SimulateEventReceived("device/command/blob", kPayload,
+                              ContentType::kStructured);
+
+  auto result = commands.TryReceive();
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result.value().content_type, ContentType::kStructured);
+  ASSERT_EQ(result.value().data.size(), kPayload.size());
+  EXPECT_TRUE(std::equal(kPayload.begin(), kPayload.end(),
+                         result.value().data.begin()));
+}
+
+TEST_F(SubscriptionTest, ArenaSubscriptionDeliversCompactEvents) {
+  std::array<std::byte, 2 * EventArena::EventSize(21, 1)> arena_buffer;
+  EventArena arena(arena_buffer);
+  CompactEventChannelStorage<8> storage;
+  auto commands = mock_.Subscribe("device/command", storage, arena);
+  EXPECT_EQ(mock_.subscription_count(), 1u);
+
+  // The channel has room for 8 events, but the arena only for two
+  mock_.SimulateEventReceived("device/command/reboot", kData);
+  mock_.SimulateEventReceived("device/command/update", kData);
+  mock_.SimulateEventReceived("device/command/status", kData);
+  EXPECT_EQ(mock_.dropped_event_count(), 1u);
+  EXPECT_EQ(arena.event_count(), 2u);
+
+  {
+    auto result = commands.TryReceive();
+    ASSERT_TRUE(result.ok());
+    EXPECT_EQ(result.value().name(), "device/command/reboot");
+    EXPECT_EQ(result.value().data().size(), kData.size());
+  }
+  // Receiving and destroying the oldest event makes room again
+  EXPECT_EQ(arena.event_count(), 1u);
+  mock_.SimulateEventReceived("device/command/status", kData);
+  EXPECT_EQ(mock_.dropped_event_count(), 1u);
+}
+
+TEST_F(SubscriptionTest, SubscriptionEndsWithItsReceiver) {
+  {
+    auto commands = mock_.Subscribe("device/command", command_storage_);
+    EXPECT_EQ(mock_.subscription_count(), 1u);
+  }
+  EXPECT_EQ(mock_.subscription_count(), 0u);
+}
+
+TEST_F(SubscriptionTest, SubscribeFailsWhenAllSlotsInUse) {
+  std::array<std::optional<EventReceiver>, kMaxEventSubscriptions> receivers;
+  for (size_t i = 0; i < kMaxEventSubscriptions; ++i) {
+    receivers[i].emplace(mock_.Subscribe("slot/", extra_storage_[i]));
+  }
+  EXPECT_EQ(mock_.subscription_count(), kMaxEventSubscriptions);
+
+  auto rejected = mock_.Subscribe("device/command", command_storage_);
+  EXPECT_EQ(mock_.subscription_count(), kMaxEventSubscriptions);
+  EXPECT_EQ(mock_.subscription_prefix(), "slot/");
+}
+
 // -- Variable Registration Tests --
 
 TEST_F(CloudBackendTest, RegisterVariableRecordsDetails) {
@@ -98,6 +346,53 @@ TEST_F(CloudBackendTest, RegisterStringVariable) {
   EXPECT_EQ(str_var.Get(), "busy");
 }
 
+TEST_F(CloudBackendTest, RegisterCallerOwnedVariables) {
+  CloudVariable<int> count(7);
+  CloudStringVariable<8> mode("idle");
+
+  EXPECT_TRUE(mock_.RegisterVariable("count", count).ok());
+  EXPECT_EQ(mock_.last_variable().data, count.data());
+  EXPECT_EQ(mock_.last_variable().type, VariableType::kInt);
+
+  EXPECT_TRUE(mock_.RegisterVariable("mode", mode).ok());
+  EXPECT_EQ(mock_.last_variable().type, VariableType::kString);
+
+  // The backend reads the caller's container
+  count.Set(8);
+  EXPECT_EQ(*static_cast<const int*>(mock_.ReadVariable("count")), 8);
+}
+
+TEST_F(CloudBackendTest, RegisterCallerOwnedVariableFailsWhenFull) {
+  std::array<CloudVariable<int>, kMaxCloudVariables + 1> vars;
+  for (size_t i = 0; i < kMaxCloudVariables; ++i) {
+    EXPECT_TRUE(mock_.RegisterVariable("v", vars[i]).ok());
+  }
+  EXPECT_EQ(mock_.RegisterVariable("v", vars[kMaxCloudVariables]),
+            pw::Status::ResourceExhausted());
+}
+
+TEST_F(CloudBackendTest, ComputedVariableIsComputedOnRead) {
+  int calls = 0;
+  mock_.RegisterComputedVariable<int>("reads", [&calls]() { return ++calls; });
+  EXPECT_EQ(mock_.last_variable().type, VariableType::kInt);
+  EXPECT_EQ(calls, 0);
+
+  const void* value = mock_.ReadVariable("reads");
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(*static_cast<const int*>(value), 1);
+  EXPECT_EQ(*static_cast<const int*>(mock_.ReadVariable("reads")), 2);
+}
+
+TEST_F(CloudBackendTest, ComputedStringVariableIsTruncated) {
+  mock_.RegisterComputedStringVariable<4>(
+      "state", [](pw::StringBuilder& value) { value << "ready"; });
+  EXPECT_EQ(mock_.last_variable().type, VariableType::kString);
+
+  EXPECT_EQ(std::string_view(
+                static_cast<const char*>(mock_.ReadVariable("state"))),
+            "rea");
+}
+
 // -- Function Registration Tests --
 
 TEST_F(CloudBackendTest, RegisterFunctionRecordsDetails) {
@@ -1,16 +1,37 @@
 // Copyright Offene Werkstatt Wädenswil
 // SPDX-License-Identifier: MIT
 
+#include <algorithm>
 #include <array>
 
 #include "mock_ledger_backend.h"
 #include "pb_cloud/cbor.h"
+#include "pb_cloud/cbor_struct_serializer.h"
 #include "pb_cloud/ledger_backend.h"
 #include "pb_cloud/ledger_typed_api.h"
 #include "pb_cloud/ledger_types.h"
 #include "pw_unit_test/framework.h"
 
 namespace pb::cloud {
+
+struct TestConfig {
+  bool enabled = false;
+  int32_t interval_s = 60;
+  uint8_t level = 0;
+  double ratio = 0.5;
+  pw::InlineString<8> mode;
+
+  static constexpr auto kCborFields =
+      CborFields(CborField("enabled", &TestConfig::enabled),
+                 CborField("interval_s", &TestConfig::interval_s),
+                 CborField("level", &TestConfig::level),
+                 CborField("ratio", &TestConfig::ratio),
+                 CborField("mode", &TestConfig::mode));
+};
+
+template <>
+struct Serializer<TestConfig> : CborStructSerializer<TestConfig> {};
+
 namespace {
 
 // -- LedgerHandle Tests --
@@ -189,6 +210,90 @@ TEST(LedgerTypedApi, ReadNonExistentLedgerSucceeds) {
   EXPECT_TRUE(result.value().empty());
 }
 
+TEST(LedgerTypedApi, CborStructRoundTrip) {
+  MockLedgerBackend backend;
+
+  TestConfig config;
+  config.enabled = true;
+  config.interval_s = -5;
+  config.level = 200;
+  config.ratio = 0.25;
+  config.mode = "eco";
+  ASSERT_TRUE(WriteLedger(backend, "config", config).ok());
+
+  // Readable property by property too
+  EXPECT_EQ(backend.GetPropertyInt("config", "interval_s", 0), -5);
+
+  auto read = ReadLedger<TestConfig>(backend, "config");
+  ASSERT_TRUE(read.ok());
+  EXPECT_TRUE(read.value().enabled);
+  EXPECT_EQ(read.value().interval_s, -5);
+  EXPECT_EQ(read.value().level, 200);
+  EXPECT_EQ(read.value().ratio, 0.25);
+  EXPECT_EQ(std::string_view(read.value().mode), "eco");
+}
+
+TEST(LedgerTypedApi, UnchangedWriteIsSkipped) {
+  MockLedgerBackend backend;
+  TestConfig config;
+  config.interval_s = 30;
+
+  ASSERT_TRUE(WriteLedger(backend, "config", config).ok());
+  ASSERT_TRUE(WriteLedger(backend, "config", config).ok());
+  EXPECT_EQ(backend.write_count(), 1u);
+  EXPECT_EQ(backend.skipped_write_count(), 1u);
+
+  config.interval_s = 31;
+  ASSERT_TRUE(WriteLedger(backend, "config", config).ok());
+  EXPECT_EQ(backend.write_count(), 2u);
+  EXPECT_EQ(backend.GetPropertyInt("config", "interval_s", 0), 31);
+}
+
+TEST(LedgerTypedApi, WriteAfterExternalChangeIsNotSkipped) {
+  MockLedgerBackend backend;
+  TestConfig config;
+  ASSERT_TRUE(WriteLedger(backend, "config", config).ok());
+
+  // The cloud replaced the data: the same write must restore it
+  const std::byte empty_map[] = {std::byte{0xa0}};
+  backend.SetLedgerData("config", empty_map);
+  ASSERT_TRUE(WriteLedger(backend, "config", config).ok());
+  EXPECT_EQ(backend.write_count(), 2u);
+  EXPECT_EQ(backend.skipped_write_count(), 0u);
+  EXPECT_EQ(backend.GetPropertyInt("config", "interval_s", 0), 60);
+}
+
+TEST(LedgerTypedApi, CborStructSkipsUnknownAndKeepsDefaults) {
+  std::array<std::byte, 64> data{};
+  cbor::Encoder encoder(data);
+  ASSERT_TRUE(encoder.BeginMap(2).ok());
+  ASSERT_TRUE(encoder.WriteString("unknown", "x").ok());
+  ASSERT_TRUE(encoder.WriteBool("enabled", true).ok());
+
+  auto read = Serializer<TestConfig>::Deserialize(
+      pw::ConstByteSpan(data.data(), encoder.size()));
+  ASSERT_TRUE(read.ok());
+  EXPECT_TRUE(read.value().enabled);
+  EXPECT_EQ(read.value().interval_s, 60);
+}
+
+TEST(LedgerTypedApi, CborStructRejectsOutOfRangeValues) {
+  std::array<std::byte, 64> data{};
+  cbor::Encoder encoder(data);
+  ASSERT_TRUE(encoder.BeginMap(1).ok());
+  ASSERT_TRUE(encoder.WriteUint("level", 256).ok());
+  auto read = Serializer<TestConfig>::Deserialize(
+      pw::ConstByteSpan(data.data(), encoder.size()));
+  EXPECT_EQ(read.status().code(), pw::Status::OutOfRange().code());
+
+  cbor::Encoder long_string(data);
+  ASSERT_TRUE(long_string.BeginMap(1).ok());
+  ASSERT_TRUE(long_string.WriteString("mode", "far too long").ok());
+  read = Serializer<TestConfig>::Deserialize(
+      pw::ConstByteSpan(data.data(), long_string.size()));
+  EXPECT_EQ(read.status().code(), pw::Status::ResourceExhausted().code());
+}
+
 // -- Mock Backend Reset Tests --
 
 TEST(MockLedgerBackend, ResetClearsAllState) {
@@ -329,6 +434,243 @@ TEST(LedgerHandle, HasProperty) {
   EXPECT_FALSE(handle.value().Has("missing"));
 }
 
+// -- LedgerCache Tests --
+
+TEST(LedgerCache, GettersShareOneRead) {
+  MockLedgerBackend backend;
+  backend.SetProperty("test", "enabled", true);
+  backend.SetProperty("test", "count", int64_t{7});
+  backend.SetProperty("test", "name", std::string_view("unit"));
+
+  auto handle = backend.GetLedger("test");
+  ASSERT_TRUE(handle.ok());
+  std::array<std::byte, 256> cache_buffer;
+  LedgerCache cache(cache_buffer);
+  handle.value().SetCache(&cache);
+
+  const size_t reads_before = backend.read_count();
+  EXPECT_TRUE(handle.value().GetBool("enabled", false));
+  EXPECT_EQ(handle.value().GetInt("count", 0), 7);
+  EXPECT_FALSE(handle.value().Has("missing"));
+  std::array<std::byte, 8> name_buf{};
+  auto name = handle.value().GetString("name", name_buf);
+  ASSERT_TRUE(name.ok());
+  EXPECT_EQ(name.value(), 4u);
+
+  EXPECT_EQ(backend.read_count(), reads_before + 1);
+  EXPECT_TRUE(cache.loaded());
+  EXPECT_EQ(cache.property_count(), 3u);
+}
+
+TEST(LedgerCache, ReloadsAfterLocalWrite) {
+  MockLedgerBackend backend;
+  backend.SetProperty("test", "count", int64_t{1});
+
+  auto handle = backend.GetLedger("test");
+  ASSERT_TRUE(handle.ok());
+  std::array<std::byte, 256> cache_buffer;
+  LedgerCache cache(cache_buffer);
+  handle.value().SetCache(&cache);
+  EXPECT_EQ(handle.value().GetInt("count", 0), 1);
+
+  // Through the cached handle
+  {
+    std::array<std::byte, 256> edit_buffer;
+    auto editor = handle.value().Edit(edit_buffer);
+    ASSERT_TRUE(editor.ok());
+    ASSERT_TRUE(editor.value().SetInt("count", 2).ok());
+    ASSERT_TRUE(editor.value().Commit().ok());
+  }
+  EXPECT_EQ(handle.value().GetInt("count", 0), 2);
+
+  // Through another handle to the same ledger
+  backend.SetProperty("test", "count", int64_t{3});
+  EXPECT_EQ(handle.value().GetInt("count", 0), 3);
+}
+
+TEST(LedgerCache, ReloadsAfterSync) {
+  MockLedgerBackend backend;
+  backend.SetProperty("test", "count", int64_t{1});
+  auto receiver = backend.SubscribeToSync("test");
+
+  auto handle = backend.GetLedger("test");
+  ASSERT_TRUE(handle.ok());
+  std::array<std::byte, 256> cache_buffer;
+  LedgerCache cache(cache_buffer);
+  handle.value().SetCache(&cache);
+  EXPECT_EQ(handle.value().GetInt("count", 0), 1);
+
+  // Cloud-side change delivered by a sync
+  std::array<std::byte, 32> data{};
+  cbor::Encoder encoder(data);
+  ASSERT_TRUE(encoder.BeginMap(1).ok());
+  ASSERT_TRUE(encoder.WriteInt("count", 5).ok());
+  backend.SetLedgerData("test", pw::ConstByteSpan(data.data(), encoder.size()));
+  backend.SimulateSyncComplete("test");
+
+  const size_t reads_before = backend.read_count();
+  EXPECT_EQ(handle.value().GetInt("count", 0), 5);
+  EXPECT_EQ(handle.value().GetInt("count", 0), 5);
+  EXPECT_EQ(backend.read_count(), reads_before + 1);
+}
+
+TEST(LedgerCache, ReportsChangedKeysAfterSync) {
+  MockLedgerBackend backend;
+  backend.SetProperty("test", "a", int64_t{1});
+  backend.SetProperty("test", "b", int64_t{2});
+  backend.SetProperty("test", "c", int64_t{3});
+  auto receiver = backend.SubscribeToSync("test");
+
+  auto handle = backend.GetLedger("test");
+  ASSERT_TRUE(handle.ok());
+  std::array<std::byte, 256> cache_buffer;
+  LedgerCache cache(cache_buffer);
+  handle.value().SetCache(&cache);
+  ASSERT_TRUE(handle.value().RefreshCache().ok());
+  EXPECT_EQ(cache.changed_count(), 3u);  // First load: everything is new
+
+  // Two cloud syncs before the application gets to run
+  std::array<std::byte, 64> data{};
+  cbor::Encoder encoder(data);
+  ASSERT_TRUE(encoder.BeginMap(3).ok());
+  ASSERT_TRUE(encoder.WriteInt("a", 1).ok());
+  ASSERT_TRUE(encoder.WriteInt("b", 20).ok());
+  ASSERT_TRUE(encoder.WriteInt("d", 4).ok());
+  backend.SetLedgerData("test", pw::ConstByteSpan(data.data(), encoder.size()));
+  backend.SimulateSyncComplete("test");
+  backend.SimulateSyncComplete("test");
+
+  // Coalesced into one event
+  EXPECT_TRUE(receiver.TryReceive().ok());
+  EXPECT_FALSE(receiver.TryReceive().ok());
+
+  ASSERT_TRUE(handle.value().RefreshCache().ok());
+  std::array<std::string_view, kMaxLedgerProperties> keys;
+  ASSERT_EQ(cache.ChangedKeys(keys), 2u);
+  EXPECT_EQ(keys[0], "b");
+  EXPECT_EQ(keys[1], "d");
+  EXPECT_FALSE(cache.Changed("a"));
+  EXPECT_TRUE(cache.Changed("b"));
+  EXPECT_EQ(cache.removed_count(), 1u);
+
+  // No change since: nothing reported
+  backend.SimulateSyncComplete("test");
+  ASSERT_TRUE(handle.value().RefreshCache().ok());
+  EXPECT_EQ(cache.changed_count(), 0u);
+  EXPECT_EQ(cache.removed_count(), 0u);
+}
+
+TEST(LedgerCache, TooSmallBufferFallsBackToReadThrough) {
+  MockLedgerBackend backend;
+  backend.SetProperty("test", "message", std::string_view("longer than four"));
+
+  auto handle = backend.GetLedger("test");
+  ASSERT_TRUE(handle.ok());
+  std::array<std::byte, 4> cache_buffer;
+  LedgerCache cache(cache_buffer);
+  handle.value().SetCache(&cache);
+
+  EXPECT_TRUE(handle.value().Has("message"));
+  EXPECT_FALSE(cache.loaded());
+}
+
+// -- Ledger Stream Tests --
+
+TEST(LedgerStream, ChunkedWriteAndStreamDecode) {
+  MockLedgerBackend backend;
+  auto handle = backend.GetLedger("big");
+  ASSERT_TRUE(handle.ok());
+
+  // A 2 KB string, encoded and written in 256-byte chunks
+  std::array<char, 2048> text;
+  text.fill('x');
+  std::array<std::byte, 2100> encoded{};
+  cbor::Encoder encoder(encoded);
+  ASSERT_TRUE(encoder.BeginMap(2).ok());
+  ASSERT_TRUE(
+      encoder.WriteString("text", std::string_view(text.data(), text.size()))
+          .ok());
+  ASSERT_TRUE(encoder.WriteInt("count", 7).ok());
+
+  {
+    auto writer = handle.value().OpenWriter();
+    ASSERT_TRUE(writer.ok());
+    pw::ConstByteSpan data(encoded.data(), encoder.size());
+    while (!data.empty()) {
+      const size_t chunk = std::min<size_t>(256, data.size());
+      ASSERT_TRUE(writer.value().Write(data.first(chunk)).ok());
+      data = data.subspan(chunk);
+    }
+    EXPECT_EQ(writer.value().bytes_written(), encoder.size());
+    ASSERT_TRUE(writer.value().Commit().ok());
+  }
+  EXPECT_EQ(backend.GetWrittenData("big").size(), encoder.size());
+
+  auto reader = handle.value().OpenReader();
+  ASSERT_TRUE(reader.ok());
+  EXPECT_EQ(reader.value().remaining(), encoder.size());
+  std::array<std::byte, 32> window;
+  cbor::StreamDecoder decoder(reader.value(), window);
+  ASSERT_EQ(decoder.ReadMapHeader().value(), 2u);
+  std::array<std::byte, kMaxLedgerNameSize> key_buf{};
+  ASSERT_TRUE(decoder.ReadKey(key_buf).ok());
+  ASSERT_TRUE(decoder.SkipValue().ok());
+  auto key = decoder.ReadKey(key_buf);
+  ASSERT_TRUE(key.ok());
+  EXPECT_EQ(key.value(), "count");
+  EXPECT_EQ(decoder.ReadInt().value(), 7);
+  EXPECT_EQ(reader.value().remaining(), 0u);
+  EXPECT_LE(backend.max_stream_chunk(), 256u);
+}
+
+TEST(LedgerStream, WriterWithoutCommitDiscards) {
+  MockLedgerBackend backend;
+  const std::byte original[] = {std::byte{0xa0}};
+  backend.SetLedgerData("test", original);
+
+  auto handle = backend.GetLedger("test");
+  ASSERT_TRUE(handle.ok());
+  {
+    auto writer = handle.value().OpenWriter();
+    ASSERT_TRUE(writer.ok());
+    const std::byte data[] = {std::byte{0x01}, std::byte{0x02}};
+    ASSERT_TRUE(writer.value().Write(data).ok());
+  }
+  EXPECT_EQ(backend.GetWrittenData("test").size(), 1u);
+}
+
+TEST(LedgerStream, ReaderEndsWithOutOfRange) {
+  MockLedgerBackend backend;
+  const std::byte data[] = {std::byte{0x01}, std::byte{0x02},
+                            std::byte{0x03}};
+  backend.SetLedgerData("test", data);
+
+  auto handle = backend.GetLedger("test");
+  ASSERT_TRUE(handle.ok());
+  auto reader = handle.value().OpenReader();
+  ASSERT_TRUE(reader.ok());
+
+  std::array<std::byte, 2> chunk{};
+  EXPECT_EQ(reader.value().Read(chunk).value().size(), 2u);
+  EXPECT_EQ(reader.value().Read(chunk).value().size(), 1u);
+  EXPECT_EQ(reader.value().Read(chunk).status(), pw::Status::OutOfRange());
+}
+
+TEST(LedgerStream, WriterRejectsDataPastLimit) {
+  MockLedgerBackend backend;
+  auto handle = backend.GetLedger("test");
+  ASSERT_TRUE(handle.ok());
+  auto writer = handle.value().OpenWriter();
+  ASSERT_TRUE(writer.ok());
+
+  std::array<std::byte, 4096> chunk{};
+  for (size_t i = 0; i < kMaxLedgerDataSize / chunk.size(); ++i) {
+    ASSERT_TRUE(writer.value().Write(chunk).ok());
+  }
+  EXPECT_EQ(writer.value().Write(pw::ConstByteSpan(chunk).first(1)),
+            pw::Status::ResourceExhausted());
+}
+
 // -- LedgerEditor Tests --
 
 TEST(LedgerEditor, SetAndCommitProperties) {
@@ -427,6 +769,101 @@ TEST(LedgerEditor, RemoveProperty) {
   EXPECT_FALSE(handle2.value().Has("remove"));
 }
 
+TEST(LedgerEditor, CommitWithoutChangesDoesNotWrite) {
+  MockLedgerBackend backend;
+  backend.SetProperty("test", "count", int64_t{5});
+  backend.SetProperty("test", "name", std::string_view("unit"));
+  const size_t writes_before = backend.write_count();
+
+  auto handle = backend.GetLedger("test");
+  ASSERT_TRUE(handle.ok());
+  std::array<std::byte, 256> buffer;
+  auto editor = handle.value().Edit(buffer);
+  ASSERT_TRUE(editor.ok());
+  ASSERT_TRUE(editor.value().SetInt("count", 5).ok());
+  ASSERT_TRUE(editor.value().SetString("name", "unit").ok());
+  ASSERT_TRUE(editor.value().Commit().ok());
+
+  EXPECT_EQ(backend.write_count(), writes_before);
+}
+
+TEST(LedgerEditor, ReencodingToSameDataDoesNotWrite) {
+  MockLedgerBackend backend;
+  backend.SetProperty("test", "count", int64_t{5});
+  const size_t writes_before = backend.write_count();
+
+  auto handle = backend.GetLedger("test");
+  ASSERT_TRUE(handle.ok());
+  std::array<std::byte, 256> buffer;
+  auto editor = handle.value().Edit(buffer);
+  ASSERT_TRUE(editor.ok());
+  // Changes the layout, but encodes to the stored map again
+  ASSERT_TRUE(editor.value().SetInt("scratch", 1).ok());
+  ASSERT_TRUE(editor.value().Remove("scratch").ok());
+  ASSERT_TRUE(editor.value().Commit().ok());
+
+  EXPECT_EQ(backend.write_count(), writes_before);
+  EXPECT_EQ(backend.skipped_write_count(), 1u);
+}
+
+TEST(LedgerEditor, SameSizeChangesArePatchedInPlace) {
+  MockLedgerBackend backend;
+
+  // {"count": 1, "tags": [1, 2], "name": "abc"}; the array is a type the
+  // editor does not parse, so only an in-place patch keeps it
+  std::array<std::byte, 64> data{};
+  cbor::Encoder encoder(data);
+  ASSERT_TRUE(encoder.BeginMap(3).ok());
+  ASSERT_TRUE(encoder.WriteUint("count", 1).ok());
+  ASSERT_TRUE(encoder.WriteString("tags").ok());
+  ASSERT_TRUE(encoder.BeginArray(2).ok());
+  ASSERT_TRUE(encoder.WriteUint(1).ok());
+  ASSERT_TRUE(encoder.WriteUint(2).ok());
+  ASSERT_TRUE(encoder.WriteString("name", "abc").ok());
+  const size_t size = encoder.size();
+  backend.SetLedgerData("test", pw::ConstByteSpan(data.data(), size));
+
+  auto handle = backend.GetLedger("test");
+  ASSERT_TRUE(handle.ok());
+  {
+    std::array<std::byte, 256> buffer;
+    auto editor = handle.value().Edit(buffer);
+    ASSERT_TRUE(editor.ok());
+    ASSERT_TRUE(editor.value().SetUint("count", 2).ok());
+    ASSERT_TRUE(editor.value().SetString("name", "xyz").ok());
+    ASSERT_TRUE(editor.value().Commit().ok());
+  }
+
+  pw::ConstByteSpan written = backend.GetWrittenData("test");
+  ASSERT_EQ(written.size(), size);
+  EXPECT_EQ(handle.value().GetUint("count", 0), 2u);
+  std::array<std::byte, 8> name{};
+  auto name_len = handle.value().GetString("name", name);
+  ASSERT_TRUE(name_len.ok());
+  EXPECT_EQ(name[0], std::byte{'x'});
+  EXPECT_TRUE(handle.value().Has("tags"));
+}
+
+TEST(LedgerEditor, SizeChangeReencodes) {
+  MockLedgerBackend backend;
+  backend.SetProperty("test", "count", int64_t{1});
+  backend.SetProperty("test", "flag", true);
+
+  auto handle = backend.GetLedger("test");
+  ASSERT_TRUE(handle.ok());
+  {
+    std::array<std::byte, 256> buffer;
+    auto editor = handle.value().Edit(buffer);
+    ASSERT_TRUE(editor.ok());
+    // 1000 needs a 2-byte argument where 1 fit in the initial byte
+    ASSERT_TRUE(editor.value().SetInt("count", 1000).ok());
+    ASSERT_TRUE(editor.value().Commit().ok());
+  }
+
+  EXPECT_EQ(handle.value().GetInt("count", 0), 1000);
+  EXPECT_TRUE(handle.value().GetBool("flag", false));
+}
+
 TEST(LedgerEditor, PropertyCount) {
   MockLedgerBackend backend;
 
@@ -591,6 +1028,106 @@ TEST(LedgerEditor, PropertyCountLimit) {
   EXPECT_EQ(status.code(), pw::Status::ResourceExhausted().code());
 }
 
+TEST(LedgerEditor, LargerInlineTable) {
+  MockLedgerBackend backend;
+
+  auto handle = backend.GetLedger("test");
+  ASSERT_TRUE(handle.ok());
+
+  constexpr size_t kCount = kMaxLedgerProperties * 2;
+  std::array<std::array<char, 8>, kCount> keys{};
+  std::array<std::byte, 4096> buffer{};
+  {
+    auto editor = handle.value().Edit<kCount>(buffer);
+    ASSERT_TRUE(editor.ok());
+    for (size_t i = 0; i < kCount; ++i) {
+      snprintf(keys[i].data(), keys[i].size(), "p%zu", i);
+      ASSERT_TRUE(
+          editor.value().SetInt(keys[i].data(), static_cast<int64_t>(i)).ok());
+    }
+    EXPECT_TRUE(editor.value().Commit().ok());
+  }
+
+  EXPECT_EQ(handle.value().GetInt("p0", -1), 0);
+  EXPECT_EQ(handle.value().GetInt("p31", -1), 31);
+
+  // The default table cannot hold the ledger, so editing it would drop data
+  auto small = handle.value().Edit(buffer);
+  EXPECT_EQ(small.status().code(), pw::Status::ResourceExhausted().code());
+}
+
+TEST(LedgerEditor, IndexedLookupWithRemoveAndReuse) {
+  MockLedgerBackend backend;
+
+  auto handle = backend.GetLedger("test");
+  ASSERT_TRUE(handle.ok());
+
+  constexpr size_t kCount = 64;
+  std::array<std::array<char, 8>, kCount> keys{};
+  for (size_t i = 0; i < kCount; ++i) {
+    snprintf(keys[i].data(), keys[i].size(), "k%zu", i);
+  }
+  std::array<std::byte, 4096> buffer{};
+  {
+    auto editor = handle.value().Edit<kCount>(buffer);
+    ASSERT_TRUE(editor.ok());
+    for (size_t i = 0; i < kCount; ++i) {
+      ASSERT_TRUE(
+          editor.value().SetInt(keys[i].data(), static_cast<int64_t>(i)).ok());
+    }
+    // Updating existing keys must not add entries
+    for (size_t i = 0; i < kCount; ++i) {
+      ASSERT_TRUE(editor.value()
+                      .SetInt(keys[i].data(), static_cast<int64_t>(i) * 2)
+                      .ok());
+    }
+    EXPECT_EQ(editor.value().property_count(), kCount);
+
+    // Removed slots are reused for new keys
+    EXPECT_TRUE(editor.value().Remove("k3").ok());
+    EXPECT_TRUE(editor.value().SetInt("new", 7).ok());
+    EXPECT_TRUE(editor.value().SetInt("new", 8).ok());
+    EXPECT_EQ(editor.value().property_count(), kCount);
+    EXPECT_TRUE(editor.value().Commit().ok());
+  }
+
+  EXPECT_EQ(handle.value().GetInt("k3", -1), -1);
+  EXPECT_EQ(handle.value().GetInt("k63", -1), 126);
+  EXPECT_EQ(handle.value().GetInt("new", -1), 8);
+
+  // Loaded keys are indexed too
+  auto editor = handle.value().Edit<kCount>(buffer);
+  ASSERT_TRUE(editor.ok());
+  EXPECT_TRUE(editor.value().SetInt("k10", 20).ok());
+  EXPECT_EQ(editor.value().property_count(), kCount);
+}
+
+TEST(LedgerEditor, CallerProvidedTable) {
+  MockLedgerBackend backend;
+
+  auto handle = backend.GetLedger("test");
+  ASSERT_TRUE(handle.ok());
+
+  std::array<PropertyEntry, 2> table{};
+  std::array<std::byte, 512> buffer{};
+  {
+    auto editor = handle.value().Edit(buffer, table);
+    ASSERT_TRUE(editor.ok());
+    EXPECT_TRUE(editor.value().SetInt("a", 1).ok());
+    EXPECT_TRUE(editor.value().SetInt("b", 2).ok());
+    EXPECT_EQ(editor.value().SetInt("c", 3).code(),
+              pw::Status::ResourceExhausted().code());
+    EXPECT_TRUE(editor.value().Commit().ok());
+  }
+
+  EXPECT_EQ(handle.value().GetInt("a", 0), 1);
+  EXPECT_EQ(handle.value().GetInt("b", 0), 2);
+
+  std::array<PropertyEntry, 1> too_small{};
+  auto editor = handle.value().Edit(buffer, too_small);
+  EXPECT_EQ(editor.status().code(), pw::Status::ResourceExhausted().code());
+}
+
 TEST(LedgerEditor, RoundTripLargeString) {
   MockLedgerBackend backend;
 
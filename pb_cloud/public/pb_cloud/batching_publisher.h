@@ -0,0 +1,144 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file batching_publisher.h
+/// @brief Coalesces many small events into one publish.
+///
+/// Every Publish() is its own cloud message and counts against Particle's
+/// rate limit. BatchingPublisher collects entries for one event name and
+/// publishes them together as a CBOR array of byte strings, which the
+/// server side splits up again.
+///
+/// Usage:
+/// @code
+/// pb::cloud::BatchingPublisher status(
+///     cloud, "device/status",
+///     {.max_age = pw::chrono::SystemClock::for_at_least(30s)});
+///
+/// // Producer
+/// if (status.Add(sample).IsResourceExhausted()) {
+///   // Batch full and the previous one is still in flight
+/// }
+///
+/// // In the task that owns the publisher, at least every max_age
+/// auto poll = status.Pend(cx);
+/// if (poll.IsReady() && !poll.value().ok()) {
+///   PW_LOG_WARN("Batch publish failed");
+/// }
+/// @endcode
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "pb_cloud/cloud_backend.h"
+#include "pb_cloud/types.h"
+#include "pw_async2/context.h"
+#include "pw_async2/poll.h"
+#include "pw_bytes/span.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_status/status.h"
+#include "pw_string/string.h"
+
+namespace pb::cloud {
+
+/// Options for a BatchingPublisher.
+struct BatchingOptions {
+  /// Publish once the next entry would make the batch larger than this
+  /// (capped at kMaxEventDataSize)
+  size_t max_batch_bytes = kMaxEventDataSize;
+  /// Publish once the oldest entry has waited this long
+  pw::chrono::SystemClock::duration max_age =
+      pw::chrono::SystemClock::for_at_least(std::chrono::seconds(10));
+  /// Options of the batch publishes
+  PublishOptions publish = {.content_type = ContentType::kStructured};
+};
+
+/// Collects entries for one event name and publishes them as a CBOR array.
+///
+/// A batch is published when it is full, when its oldest entry is older
+/// than max_age, or on Flush(). Only one batch is in flight at a time:
+/// while it waits for its ack, entries keep filling the next batch, and
+/// Add() reports ResourceExhausted once that one is full too.
+///
+/// A failed batch is not retried; Pend() reports the failure.
+///
+/// Thread Safety: not thread-safe; use from the task that calls Pend().
+class BatchingPublisher {
+ public:
+  /// @param cloud Backend to publish with; must outlive the publisher
+  /// @param name Event name of the batches
+  BatchingPublisher(CloudBackend& cloud,
+                    std::string_view name,
+                    const BatchingOptions& options = {});
+
+  BatchingPublisher(const BatchingPublisher&) = delete;
+  BatchingPublisher& operator=(const BatchingPublisher&) = delete;
+
+  /// Adds an entry (copied) to the current batch. Publishes the batch first
+  /// if the entry doesn't fit.
+  /// @return OkStatus, or:
+  ///         - InvalidArgument if the entry doesn't fit even an empty batch
+  ///         - ResourceExhausted if the batch is full and the previous one
+  ///           is still in flight; call Pend() until it is Ready and retry
+  pw::Status Add(pw::ConstByteSpan entry);
+
+  /// Publishes the current batch now.
+  /// @return OkStatus (also if the batch is empty), or Unavailable if a
+  ///         batch is still in flight; Pend() then publishes it as soon as
+  ///         that one completes
+  pw::Status Flush();
+
+  /// Drives the publisher: completes the batch in flight and publishes the
+  /// next one when it is due. The caller's task is woken when the batch in
+  /// flight completes, not when max_age expires, so call this at least
+  /// every max_age.
+  /// @return Ready with the result of the last completed batch publish
+  ///         (OkStatus if there was none) once no batch is in flight,
+  ///         Pending otherwise
+  pw::async2::Poll<pw::Status> Pend(pw::async2::Context& cx);
+
+  /// Entries in the current batch.
+  size_t entry_count() const { return entry_count_; }
+
+  /// Encoded size of the current batch.
+  size_t batch_size() const;
+
+  bool publish_in_flight() const { return in_flight_.has_value(); }
+
+  /// Batches handed to the backend so far.
+  uint32_t batch_count() const { return batch_count_; }
+
+ private:
+  // Space for the widest array header of a batch that fits
+  // kMaxEventDataSize: up to 1024 entries need a 3-byte header.
+  static constexpr size_t kHeaderReserve = 3;
+
+  bool FlushDue() const;
+
+  // Publishes the current batch; the caller checks that none is in flight.
+  void StartPublish();
+
+  CloudBackend& cloud_;
+  pw::InlineString<kMaxEventNameSize> name_;
+  BatchingOptions options_;
+
+  // Encoded entries start at kHeaderReserve; StartPublish() puts the array
+  // header right in front of them.
+  std::array<std::byte, kHeaderReserve + kMaxEventDataSize> buffer_{};
+  size_t entries_size_ = 0;
+  size_t entry_count_ = 0;
+  pw::chrono::SystemClock::time_point oldest_entry_time_;
+  bool flush_requested_ = false;
+
+  std::optional<PublishFuture> in_flight_;
+  pw::Status last_status_;
+  uint32_t batch_count_ = 0;
+};
+
+}  // namespace pb::cloud
@@ -9,6 +9,12 @@
 /// This implements a subset of CBOR sufficient for Particle's ledger format:
 /// - Map with text keys
 /// - Primitive values: null, bool, int, uint, double, string, bytes
+/// - Nested maps and arrays, with a known count or indefinite length
+/// - Compact floats (float16/float32) and RFC 8746 typed arrays of int16
+///   and float32, for bulk samples
+/// - MapIndex for repeated key lookups in one decoded map
+/// - EncodedKey and StaticDocument for keys and documents encoded at
+///   compile time
 ///
 /// The encoding matches Particle's Wiring API format (LedgerData).
 ///
@@ -21,28 +27,48 @@
 /// encoder.WriteInt("count", 42);
 /// auto data = pw::ConstByteSpan(buffer.data(), encoder.size());
 ///
+/// // Nested containers without counting entries first
+/// encoder.BeginMap(cbor::kIndefiniteLength);
+/// encoder.BeginArray("samples", cbor::kIndefiniteLength);
+/// for (int16_t sample : samples) {
+///   encoder.WriteInt(sample);
+/// }
+/// encoder.End();  // samples
+/// encoder.End();  // map
+///
 /// // Decoding
 /// cbor::Decoder decoder(data);
 /// auto count = decoder.ReadMapHeader();
-/// std::array<char, 32> key_buf;
 /// while (decoder.HasNext()) {
-///   auto key = decoder.ReadKey(pw::as_writable_bytes(pw::span(key_buf)));
+///   auto key = decoder.ReadKeyView();  // Points into data, no copy
 ///   if (key.ok() && key.value() == "enabled") {
 ///     auto val = decoder.ReadBool();
 ///   }
 /// }
 /// @endcode
 
+#include <array>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
 #include <string_view>
+#include <utility>
 
 #include "pw_bytes/span.h"
 #include "pw_result/result.h"
+#include "pw_span/span.h"
 #include "pw_status/status.h"
+#include "pw_stream/stream.h"
 
 namespace pb::cloud::cbor {
 
+/// Container count for a map or array terminated by a break (End()) instead
+/// of a known number of entries.
+inline constexpr size_t kIndefiniteLength = SIZE_MAX;
+
+/// Deepest container/tag nesting Decoder::Validate() accepts.
+inline constexpr size_t kMaxValidationDepth = 16;
+
 /// CBOR major types (upper 3 bits of initial byte).
 enum class MajorType : uint8_t {
   kUnsignedInt = 0,   // 0x00-0x1f
@@ -60,25 +86,58 @@ enum class SimpleValue : uint8_t {
   kFalse = 20,  // 0xf4
   kTrue = 21,   // 0xf5
   kNull = 22,   // 0xf6
+  kFloat16 = 25,  // 0xf9 (followed by 2-byte IEEE 754)
+  kFloat32 = 26,  // 0xfa (followed by 4-byte IEEE 754)
   kFloat64 = 27,  // 0xfb (followed by 8-byte IEEE 754)
 };
 
+/// RFC 8746 typed array tags (tag of a byte string of packed elements).
+enum class TypedArrayTag : uint8_t {
+  kInt16BigEndian = 73,
+  kInt16LittleEndian = 77,
+  kFloat32BigEndian = 81,
+  kFloat32LittleEndian = 85,
+};
+
+template <size_t N>
+class EncodedKey;
+
 /// CBOR encoder - writes CBOR data to a buffer.
 ///
 /// The encoder writes data sequentially. Call BeginMap() first, then
 /// write key-value pairs. Keys are text strings, values can be any
-/// supported type.
+/// supported type, including nested maps and arrays.
 class Encoder {
  public:
   /// Construct encoder with output buffer.
   explicit Encoder(pw::ByteSpan buffer);
 
-  /// Start a map with a known number of key-value pairs.
+  /// Start a map.
   ///
-  /// @param count Number of key-value pairs that will follow
+  /// @param count Number of key-value pairs that will follow, or
+  ///              kIndefiniteLength to close the map with End()
   /// @return OkStatus or ResourceExhausted if buffer too small
   pw::Status BeginMap(size_t count);
 
+  /// Start an array.
+  ///
+  /// @param count Number of elements that will follow, or
+  ///              kIndefiniteLength to close the array with End()
+  /// @return OkStatus or ResourceExhausted if buffer too small
+  pw::Status BeginArray(size_t count);
+
+  /// Start a map nested under `key` in the enclosing map.
+  pw::Status BeginMap(std::string_view key, size_t count);
+
+  /// Start an array nested under `key` in the enclosing map.
+  pw::Status BeginArray(std::string_view key, size_t count);
+
+  /// Close the innermost indefinite-length map or array.
+  ///
+  /// @return OkStatus, FailedPrecondition if no indefinite-length container
+  ///         is open, or ResourceExhausted if buffer too small
+  pw::Status End();
+
   /// Write a null value with the given key.
   pw::Status WriteNull(std::string_view key);
 
@@ -97,15 +156,82 @@ class Encoder {
 
   /// Write a double-precision float value with the given key.
   ///
-  /// Always uses 8-byte IEEE 754 encoding (0xfb prefix).
+  /// Always uses 8-byte IEEE 754 encoding (0xfb prefix), as Particle's
+  /// Wiring API does.
   pw::Status WriteDouble(std::string_view key, double value);
 
+  /// Write a float value with the given key, using the shortest of
+  /// float16, float32 and float64 that represents it exactly.
+  pw::Status WriteFloat(std::string_view key, double value);
+
+  /// Write int16 samples as an RFC 8746 typed array (little-endian) under
+  /// the given key: 2 bytes per sample plus a 4-6 byte header.
+  pw::Status WriteInt16Array(std::string_view key,
+                             pw::span<const int16_t> values);
+
+  /// Write float32 samples as an RFC 8746 typed array (little-endian)
+  /// under the given key: 4 bytes per sample plus a 4-6 byte header.
+  pw::Status WriteFloat32Array(std::string_view key,
+                               pw::span<const float> values);
+
   /// Write a text string value with the given key.
   pw::Status WriteString(std::string_view key, std::string_view value);
 
   /// Write a byte string value with the given key.
   pw::Status WriteBytes(std::string_view key, pw::ConstByteSpan value);
 
+  /// Write a byte string array element (no key).
+  pw::Status WriteBytes(pw::ConstByteSpan value);
+
+  /// Write a pre-encoded key; follow it with a value written without key.
+  template <size_t N>
+  pw::Status WriteKey(const EncodedKey<N>& key) {
+    return WriteRaw(key.data(), key.size());
+  }
+
+  // -- Values without a key (array elements, or patching a map value) --
+
+  /// Write a null value (no key).
+  pw::Status WriteNull();
+
+  /// Write a boolean value (no key).
+  pw::Status WriteBool(bool value);
+
+  /// Write a signed integer value (no key).
+  pw::Status WriteInt(int64_t value);
+
+  /// Write an unsigned integer value (no key).
+  pw::Status WriteUint(uint64_t value);
+
+  /// Write a double-precision float value (no key).
+  pw::Status WriteDouble(double value);
+
+  /// Write a float value in its shortest exact encoding (no key).
+  pw::Status WriteFloat(double value);
+
+  /// Write an int16 typed array (no key).
+  pw::Status WriteInt16Array(pw::span<const int16_t> values);
+
+  /// Write a float32 typed array (no key).
+  pw::Status WriteFloat32Array(pw::span<const float> values);
+
+  /// Write a text string value (no key).
+  pw::Status WriteString(std::string_view value);
+
+  /// Number of bytes of a header with the given argument (length or count).
+  static constexpr size_t HeaderSize(uint64_t argument) {
+    if (argument < 24) {
+      return 1;
+    }
+    if (argument <= 0xff) {
+      return 2;
+    }
+    if (argument <= 0xffff) {
+      return 3;
+    }
+    return argument <= 0xffffffff ? 5 : 9;
+  }
+
   /// Get the number of bytes written so far.
   size_t size() const { return pos_; }
 
@@ -122,25 +248,352 @@ class Encoder {
   /// Write raw bytes to buffer.
   pw::Status WriteRaw(const void* data, size_t len);
 
+  /// Write a container header, opening it if `count` is indefinite.
+  pw::Status BeginContainer(MajorType type, size_t count);
+
+  /// Write a typed array tag and byte string header for `size` bytes.
+  pw::Status BeginTypedArray(TypedArrayTag tag, size_t size);
+
   pw::ByteSpan buffer_;
   size_t pos_ = 0;
+  size_t open_indefinite_ = 0;  // Indefinite containers awaiting End()
+};
+
+namespace internal {
+
+/// Compile-time counterpart of the encoders' header writer.
+///
+/// @return Bytes written to `out`, Encoder::HeaderSize(argument)
+constexpr size_t EncodeHeader(MajorType type,
+                              uint64_t argument,
+                              std::byte* out) {
+  const auto major = static_cast<uint8_t>(static_cast<uint8_t>(type) << 5);
+  const size_t size = Encoder::HeaderSize(argument);
+  if (size == 1) {
+    out[0] = static_cast<std::byte>(major | argument);
+    return 1;
+  }
+  const size_t len = size - 1;
+  const uint8_t additional = len == 1 ? 24 : len == 2 ? 25 : len == 4 ? 26 : 27;
+  out[0] = static_cast<std::byte>(major | additional);
+  for (size_t i = 0; i < len; ++i) {
+    out[1 + i] = static_cast<std::byte>(argument >> ((len - 1 - i) * 8));
+  }
+  return size;
+}
+
+}  // namespace internal
+
+/// Map key with its text string header encoded at compile time.
+///
+/// Writing it is a single copy of the precomputed bytes instead of a
+/// header encode plus copy per call.
+///
+/// @code
+/// constexpr cbor::EncodedKey kTemperature("temperature");
+/// encoder.WriteKey(kTemperature);
+/// encoder.WriteDouble(21.5);
+/// @endcode
+template <size_t N>
+class EncodedKey {
+ public:
+  /// Encode `key` (a string literal).
+  constexpr EncodedKey(const char (&key)[N]) {  // NOLINT(google-explicit-constructor)
+    const size_t header =
+        internal::EncodeHeader(MajorType::kTextString, N - 1, bytes_.data());
+    for (size_t i = 0; i + 1 < N; ++i) {
+      bytes_[header + i] = static_cast<std::byte>(key[i]);
+    }
+  }
+
+  constexpr const std::byte* data() const { return bytes_.data(); }
+  static constexpr size_t size() { return kSize; }
+
+ private:
+  static constexpr size_t kSize = Encoder::HeaderSize(N - 1) + N - 1;
+
+  std::array<std::byte, kSize> bytes_{};
+};
+
+/// A CBOR document built at compile time.
+///
+/// Use it in a constexpr initializer so the encoded bytes are a constant
+/// in flash. Writers do not return a status: a document that does not fit
+/// `kCapacity` reports !ok(), which a static_assert turns into a build
+/// error.
+///
+/// @code
+/// constexpr auto kDefaultConfig = [] {
+///   cbor::StaticDocument<64> doc;
+///   doc.BeginMap(2);
+///   doc.WriteBool("enabled", true);
+///   doc.WriteInt("interval_s", 60);
+///   return doc;
+/// }();
+/// static_assert(kDefaultConfig.ok());
+///
+/// ledger.Write(kDefaultConfig.bytes());
+/// @endcode
+template <size_t kCapacity>
+class StaticDocument {
+ public:
+  constexpr void BeginMap(size_t count) { Header(MajorType::kMap, count); }
+  constexpr void BeginArray(size_t count) {
+    Header(MajorType::kArray, count);
+  }
+  constexpr void BeginMap(std::string_view key, size_t count) {
+    WriteString(key);
+    BeginMap(count);
+  }
+  constexpr void BeginArray(std::string_view key, size_t count) {
+    WriteString(key);
+    BeginArray(count);
+  }
+
+  constexpr void WriteNull(std::string_view key) {
+    WriteString(key);
+    WriteNull();
+  }
+  constexpr void WriteBool(std::string_view key, bool value) {
+    WriteString(key);
+    WriteBool(value);
+  }
+  constexpr void WriteInt(std::string_view key, int64_t value) {
+    WriteString(key);
+    WriteInt(value);
+  }
+  constexpr void WriteUint(std::string_view key, uint64_t value) {
+    WriteString(key);
+    WriteUint(value);
+  }
+  constexpr void WriteDouble(std::string_view key, double value) {
+    WriteString(key);
+    WriteDouble(value);
+  }
+  constexpr void WriteString(std::string_view key, std::string_view value) {
+    WriteString(key);
+    WriteString(value);
+  }
+
+  // -- Values without a key --
+
+  constexpr void WriteNull() {
+    Put(0xe0 | static_cast<uint8_t>(SimpleValue::kNull));
+  }
+  constexpr void WriteBool(bool value) {
+    const auto simple = value ? SimpleValue::kTrue : SimpleValue::kFalse;
+    Put(0xe0 | static_cast<uint8_t>(simple));
+  }
+  constexpr void WriteInt(int64_t value) {
+    if (value >= 0) {
+      Header(MajorType::kUnsignedInt, static_cast<uint64_t>(value));
+    } else {
+      Header(MajorType::kNegativeInt, static_cast<uint64_t>(-1 - value));
+    }
+  }
+  constexpr void WriteUint(uint64_t value) {
+    Header(MajorType::kUnsignedInt, value);
+  }
+  constexpr void WriteDouble(double value) {
+    // float64 as Encoder::WriteDouble() writes it
+    if (!Fits(9)) {
+      return;
+    }
+    const auto bits = std::bit_cast<uint64_t>(value);
+    bytes_[size_++] = std::byte{0xfb};
+    for (int i = 7; i >= 0; --i) {
+      bytes_[size_++] = static_cast<std::byte>(bits >> (i * 8));
+    }
+  }
+  constexpr void WriteString(std::string_view value) {
+    Header(MajorType::kTextString, value.size());
+    if (!Fits(value.size())) {
+      return;
+    }
+    for (char c : value) {
+      bytes_[size_++] = static_cast<std::byte>(c);
+    }
+  }
+
+  /// False if a write did not fit kCapacity.
+  constexpr bool ok() const { return ok_; }
+
+  /// Encoded size in bytes.
+  constexpr size_t size() const { return size_; }
+
+  /// The encoded document.
+  constexpr pw::ConstByteSpan bytes() const {
+    return pw::ConstByteSpan(bytes_.data(), size_);
+  }
+
+ private:
+  constexpr bool Fits(size_t len) {
+    ok_ = ok_ && len <= kCapacity - size_;
+    return ok_;
+  }
+  constexpr void Put(uint8_t byte) {
+    if (Fits(1)) {
+      bytes_[size_++] = static_cast<std::byte>(byte);
+    }
+  }
+  constexpr void Header(MajorType type, uint64_t argument) {
+    if (Fits(Encoder::HeaderSize(argument))) {
+      size_ += internal::EncodeHeader(type, argument, &bytes_[size_]);
+    }
+  }
+
+  std::array<std::byte, kCapacity> bytes_{};
+  size_t size_ = 0;
+  bool ok_ = true;
+};
+
+/// CBOR encoder writing to a pw::stream::Writer.
+///
+/// Same writing API as Encoder, but the output goes to a stream (for
+/// example a LedgerWriter) instead of a fixed buffer, so a document of any
+/// size is produced in constant memory. Small items are collected in the
+/// caller-provided window and written in window-sized chunks; payloads that
+/// do not fit the window are written straight through. An empty window
+/// writes every item directly.
+///
+/// Call Flush() when done: bytes still in the window are not yet written.
+///
+/// @code
+/// auto writer = ledger.OpenWriter();
+/// std::array<std::byte, 64> window;
+/// cbor::StreamEncoder encoder(writer.value(), window);
+/// encoder.BeginMap(cbor::kIndefiniteLength);
+/// encoder.WriteInt("count", 42);
+/// encoder.End();
+/// encoder.Flush();
+/// writer.value().Commit();
+/// @endcode
+class StreamEncoder {
+ public:
+  /// Construct encoder over a writer, buffering through `window`.
+  StreamEncoder(pw::stream::Writer& writer, pw::ByteSpan window);
+
+  /// Start a map (count or kIndefiniteLength).
+  pw::Status BeginMap(size_t count);
+
+  /// Start an array (count or kIndefiniteLength).
+  pw::Status BeginArray(size_t count);
+
+  /// Start a map nested under `key`.
+  pw::Status BeginMap(std::string_view key, size_t count);
+
+  /// Start an array nested under `key`.
+  pw::Status BeginArray(std::string_view key, size_t count);
+
+  /// Close the innermost indefinite-length map or array.
+  pw::Status End();
+
+  pw::Status WriteNull(std::string_view key);
+  pw::Status WriteBool(std::string_view key, bool value);
+  pw::Status WriteInt(std::string_view key, int64_t value);
+  pw::Status WriteUint(std::string_view key, uint64_t value);
+  pw::Status WriteDouble(std::string_view key, double value);
+  pw::Status WriteFloat(std::string_view key, double value);
+  pw::Status WriteString(std::string_view key, std::string_view value);
+  pw::Status WriteBytes(std::string_view key, pw::ConstByteSpan value);
+  pw::Status WriteInt16Array(std::string_view key,
+                             pw::span<const int16_t> values);
+  pw::Status WriteFloat32Array(std::string_view key,
+                               pw::span<const float> values);
+
+  /// Write a pre-encoded key; follow it with a value written without key.
+  template <size_t N>
+  pw::Status WriteKey(const EncodedKey<N>& key) {
+    return Put(key.data(), key.size());
+  }
+
+  // -- Values without a key --
+
+  pw::Status WriteNull();
+  pw::Status WriteBool(bool value);
+  pw::Status WriteInt(int64_t value);
+  pw::Status WriteUint(uint64_t value);
+  pw::Status WriteDouble(double value);
+  pw::Status WriteFloat(double value);
+  pw::Status WriteString(std::string_view value);
+  pw::Status WriteBytes(pw::ConstByteSpan value);
+  pw::Status WriteInt16Array(pw::span<const int16_t> values);
+  pw::Status WriteFloat32Array(pw::span<const float> values);
+
+  /// Write any bytes still held in the window to the stream.
+  pw::Status Flush();
+
+  /// Total bytes encoded so far, including bytes not yet flushed.
+  size_t size() const { return flushed_ + pos_; }
+
+ private:
+  pw::Status WriteHeader(MajorType type, uint64_t argument);
+  pw::Status WriteKey(std::string_view key);
+  pw::Status BeginContainer(MajorType type, size_t count);
+
+  /// Append bytes to the window, flushing (or bypassing it) as needed.
+  pw::Status Put(const void* data, size_t len);
+
+  pw::stream::Writer& writer_;
+  pw::ByteSpan window_;
+  size_t pos_ = 0;      // Bytes held in window_
+  size_t flushed_ = 0;  // Bytes already written to writer_
+  size_t open_indefinite_ = 0;
 };
 
 /// CBOR decoder - reads CBOR data from a buffer.
 ///
 /// The decoder reads data sequentially. Call ReadMapHeader() first,
 /// then iterate through key-value pairs using ReadKey() and the
-/// appropriate value reader.
+/// appropriate value reader. A nested map or array value is read with
+/// ReadMapHeader() / ReadArrayHeader() followed by its entries.
+///
+/// For indefinite-length containers the header reads return
+/// kIndefiniteLength; read entries until AtBreak(), then ReadBreak().
+///
+/// Every read checks bounds and header encoding. After a successful
+/// Validate() those checks are skipped (type checks remain), and
+/// SkipValue() no longer recurses per element.
 class Decoder {
  public:
   /// Construct decoder with input data.
   explicit Decoder(pw::ConstByteSpan data);
 
+  /// Check that the data from position() to the end is a sequence of
+  /// well-formed items with complete containers, at most
+  /// kMaxValidationDepth deep. On success the decoder (and decoders made
+  /// from it with At()) use the unchecked fast paths.
+  ///
+  /// @return OkStatus, DataLoss if malformed, Unimplemented for reserved
+  ///         encodings, or ResourceExhausted if nested too deeply
+  pw::Status Validate();
+
+  /// True after a successful Validate().
+  bool validated() const { return validated_; }
+
+  /// Decoder over the same data starting at `offset`, keeping the
+  /// validated state. `offset` must be the start of an item.
+  Decoder At(size_t offset) const;
+
   /// Read the map header and return the number of entries.
   ///
-  /// @return Number of key-value pairs in the map, or error
+  /// @return Number of key-value pairs in the map, kIndefiniteLength, or
+  ///         error
   pw::Result<size_t> ReadMapHeader();
 
+  /// Read the array header and return the number of elements.
+  ///
+  /// @return Number of elements in the array, kIndefiniteLength, or error
+  pw::Result<size_t> ReadArrayHeader();
+
+  /// Check if the next byte ends an indefinite-length container.
+  bool AtBreak() const;
+
+  /// Consume the break ending an indefinite-length container.
+  ///
+  /// @return OkStatus, or DataLoss if the next byte is not a break
+  pw::Status ReadBreak();
+
   /// Check if there's more data to read.
   bool HasNext() const { return pos_ < data_.size(); }
 
@@ -150,6 +603,11 @@ class Decoder {
   /// @return The key as a string_view into key_buffer, or error
   pw::Result<std::string_view> ReadKey(pw::ByteSpan key_buffer);
 
+  /// Read the next key without copying it.
+  ///
+  /// @return The key as a string_view into the decoded data, or error
+  pw::Result<std::string_view> ReadKeyView();
+
   /// Peek at the type of the next value without consuming it.
   ///
   /// @return The major type of the next value, or error if no data
@@ -172,12 +630,24 @@ class Decoder {
   /// @return The integer value, or error if type mismatch/negative
   pw::Result<uint64_t> ReadUint();
 
-  /// Read a double-precision float value.
+  /// Read a float value (float16, float32 or float64).
   ///
   /// Also handles integer values by converting to double.
   /// @return The double value, or error if type mismatch
   pw::Result<double> ReadDouble();
 
+  /// Read an int16 typed array (either byte order) into `values`.
+  ///
+  /// @return Number of samples read, ResourceExhausted if `values` is too
+  ///         small, or DataLoss if not an int16 typed array
+  pw::Result<size_t> ReadInt16Array(pw::span<int16_t> values);
+
+  /// Read a float32 typed array (either byte order) into `values`.
+  ///
+  /// @return Number of samples read, ResourceExhausted if `values` is too
+  ///         small, or DataLoss if not a float32 typed array
+  pw::Result<size_t> ReadFloat32Array(pw::span<float> values);
+
   /// Read a text string value into the provided buffer.
   ///
   /// @param buffer Buffer to receive the string data
@@ -190,6 +660,16 @@ class Decoder {
   /// @return Number of bytes written to buffer, or error
   pw::Result<size_t> ReadBytes(pw::ByteSpan buffer);
 
+  /// Read a text string value without copying it.
+  ///
+  /// @return The string as a view into the decoded data, or error
+  pw::Result<std::string_view> ReadStringView();
+
+  /// Read a byte string value without copying it.
+  ///
+  /// @return The bytes as a span into the decoded data, or error
+  pw::Result<pw::ConstByteSpan> ReadBytesView();
+
   /// Skip the current value without reading it.
   ///
   /// Useful when looking for a specific key.
@@ -213,14 +693,189 @@ class Decoder {
   /// Read a type-length header without type checking.
   pw::Result<std::pair<MajorType, uint64_t>> ReadHeaderAny();
 
-  /// Read raw bytes from buffer.
-  pw::Status ReadRaw(void* data, size_t len);
+  /// Read a container header, mapping an indefinite length to
+  /// kIndefiniteLength.
+  pw::Result<size_t> ReadContainerHeader(MajorType type);
+
+  /// SkipValue() for validated data: counts pending items instead of
+  /// recursing, without bounds checks.
+  pw::Status SkipValidated();
+
+  /// Read a string header of `type` and consume its content.
+  ///
+  /// @return The content as a span into data_, or error
+  pw::Result<pw::ConstByteSpan> ReadStringContent(MajorType type);
+
+  /// Read a typed array of `element_size` byte elements tagged with
+  /// `big_endian` or `little_endian`.
+  ///
+  /// @return The packed elements and whether they are big-endian, or error
+  pw::Result<std::pair<pw::ConstByteSpan, bool>> ReadTypedArray(
+      TypedArrayTag big_endian,
+      TypedArrayTag little_endian,
+      size_t element_size,
+      size_t capacity);
 
   /// Peek at the next byte without consuming it.
   pw::Result<uint8_t> PeekByte() const;
 
   pw::ConstByteSpan data_;
   size_t pos_ = 0;
+  bool validated_ = false;
+};
+
+/// CBOR decoder reading from a pw::stream::Reader.
+///
+/// Same reading API as Decoder, but pulls the data through a small
+/// caller-provided window, so a large ledger can be decoded without a
+/// buffer for all of it. Strings and byte strings are copied across window
+/// refills and may be longer than the window. The window must not be
+/// empty.
+///
+/// @code
+/// auto reader = ledger.OpenReader();
+/// std::array<std::byte, 64> window;
+/// cbor::StreamDecoder decoder(reader.value(), window);
+/// auto count = decoder.ReadMapHeader();
+/// @endcode
+class StreamDecoder {
+ public:
+  /// Construct decoder over a reader, buffering through `window`.
+  StreamDecoder(pw::stream::Reader& reader, pw::ByteSpan window);
+
+  /// Read the map header and return the number of entries.
+  pw::Result<size_t> ReadMapHeader();
+
+  /// Read the array header and return the number of elements.
+  pw::Result<size_t> ReadArrayHeader();
+
+  /// Check if the next byte ends an indefinite-length container.
+  bool AtBreak();
+
+  /// Consume the break ending an indefinite-length container.
+  pw::Status ReadBreak();
+
+  /// Read the next key into the provided buffer.
+  pw::Result<std::string_view> ReadKey(pw::ByteSpan key_buffer);
+
+  /// Peek at the type of the next value without consuming it.
+  pw::Result<MajorType> PeekType();
+
+  /// Read a boolean value.
+  pw::Result<bool> ReadBool();
+
+  /// Read a signed integer value.
+  pw::Result<int64_t> ReadInt();
+
+  /// Read an unsigned integer value.
+  pw::Result<uint64_t> ReadUint();
+
+  /// Read a float value (integers are converted).
+  pw::Result<double> ReadDouble();
+
+  /// Read a text string value into the provided buffer.
+  pw::Result<size_t> ReadString(pw::ByteSpan buffer);
+
+  /// Read a byte string value into the provided buffer.
+  pw::Result<size_t> ReadBytes(pw::ByteSpan buffer);
+
+  /// Skip the current value without reading it.
+  pw::Status SkipValue();
+
+  /// Total bytes consumed from the stream so far.
+  size_t position() const { return consumed_ + pos_; }
+
+ private:
+  /// Refill the window if it has no unread bytes.
+  pw::Status Fill();
+
+  pw::Result<uint8_t> PeekByte();
+  pw::Result<uint64_t> ReadHeader(MajorType expected_type);
+  pw::Result<std::pair<MajorType, uint64_t>> ReadHeaderAny();
+  pw::Result<size_t> ReadContainerHeader(MajorType type);
+  pw::Result<size_t> ReadStringContent(MajorType type, pw::ByteSpan buffer);
+  pw::Status ReadRaw(void* data, size_t len);
+  pw::Status Skip(uint64_t len);
+
+  pw::stream::Reader& reader_;
+  pw::ByteSpan window_;
+  size_t pos_ = 0;  // Next unread byte in window_
+  size_t end_ = 0;  // End of valid bytes in window_
+  size_t consumed_ = 0;  // Bytes before the current window
+};
+
+/// FNV-1a hash, used for map key and value indexes.
+inline uint32_t Fnv1a(pw::ConstByteSpan data) {
+  uint32_t hash = 2166136261u;
+  for (std::byte b : data) {
+    hash ^= static_cast<uint8_t>(b);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+inline uint32_t HashKey(std::string_view key) {
+  return Fnv1a(pw::as_bytes(pw::span(key.data(), key.size())));
+}
+
+/// One slot of a MapIndex.
+struct MapIndexEntry {
+  uint32_t key_hash = 0;
+  uint32_t key_offset = 0;    // Start of the key text in the map data
+  uint32_t value_offset = 0;  // Start of the value; 0 marks an empty slot
+  uint32_t key_size = 0;
+};
+
+/// Hash index over the keys of one CBOR map.
+///
+/// Build() walks the map once and records each key's hash and value
+/// offset in a caller-provided open-addressing table; Find() then returns a
+/// Decoder positioned at a value without rescanning the map. The indexed
+/// data must stay valid and unchanged while the index is used. If a key
+/// appears more than once, the first occurrence is indexed.
+///
+/// @code
+/// std::array<cbor::MapIndexEntry, 32> slots;
+/// cbor::MapIndex index(slots);
+/// if (index.Build(data).ok()) {
+///   auto value = index.Find("interval");
+///   if (value.ok()) {
+///     auto interval = value.value().ReadInt();
+///   }
+/// }
+/// @endcode
+class MapIndex {
+ public:
+  /// Construct over `slots`, which must have more entries than the maps
+  /// to be indexed have keys (about 1.5x for short probe sequences).
+  explicit MapIndex(pw::span<MapIndexEntry> slots) : slots_(slots) {}
+
+  /// Index the map in `data`, replacing any previous index.
+  ///
+  /// @return OkStatus, ResourceExhausted if the map has as many keys as
+  ///         there are slots, or a decode error
+  pw::Status Build(pw::ConstByteSpan data);
+
+  /// Number of distinct keys indexed.
+  size_t size() const { return count_; }
+
+  /// Check if `key` is in the map.
+  bool Contains(std::string_view key) const { return Lookup(key) != nullptr; }
+
+  /// Get a decoder over the data starting at the value of `key`.
+  ///
+  /// The decoder's position() is relative to the value.
+  ///
+  /// @return The decoder, or NotFound
+  pw::Result<Decoder> Find(std::string_view key) const;
+
+ private:
+  const MapIndexEntry* Lookup(std::string_view key) const;
+  std::string_view KeyAt(const MapIndexEntry& entry) const;
+
+  pw::span<MapIndexEntry> slots_;
+  pw::ConstByteSpan data_;
+  size_t count_ = 0;
 };
 
 }  // namespace pb::cloud::cbor
@@ -0,0 +1,184 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file cbor_struct_serializer.h
+/// @brief CBOR map codec generated from a struct's field list.
+///
+/// A struct lists its fields once in a constexpr `kCborFields` tuple; the
+/// templates here encode all of them as one CBOR map and decode a map back
+/// into the struct in a single pass. Ledger data written by the cloud (a
+/// CBOR map) is read without per-property Get*() calls.
+///
+/// Usage:
+/// @code
+/// struct DeviceConfig {
+///   bool enabled = false;
+///   int32_t interval_s = 60;
+///   pw::InlineString<16> mode;
+///
+///   static constexpr auto kCborFields = pb::cloud::CborFields(
+///       pb::cloud::CborField("enabled", &DeviceConfig::enabled),
+///       pb::cloud::CborField("interval_s", &DeviceConfig::interval_s),
+///       pb::cloud::CborField("mode", &DeviceConfig::mode));
+/// };
+///
+/// // Make it the default serializer for ReadLedger<T>/WriteLedger<T>
+/// template <>
+/// struct pb::cloud::Serializer<DeviceConfig>
+///     : pb::cloud::CborStructSerializer<DeviceConfig> {};
+///
+/// auto config = pb::cloud::ReadLedger<DeviceConfig>(backend, "config");
+/// @endcode
+///
+/// Supported member types: bool, integers, float/double and
+/// pw::InlineString<N>. Decoding leaves members whose key is missing at
+/// their default, skips unknown keys, and fails with DataLoss on a type
+/// mismatch, OutOfRange if an integer does not fit the member, and
+/// ResourceExhausted if a string is longer than its member's capacity.
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include "pb_cloud/cbor.h"
+#include "pb_cloud/serializer.h"
+#include "pb_cloud/types.h"
+#include "pw_bytes/span.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+#include "pw_status/try.h"
+
+namespace pb::cloud {
+
+/// One struct member and the CBOR map key it is stored under.
+template <typename T, typename M>
+struct CborField {
+  constexpr CborField(std::string_view field_key, M T::*field_member)
+      : key(field_key), member(field_member) {}
+
+  std::string_view key;
+  M T::*member;
+};
+
+/// Build a struct's `kCborFields` list.
+template <typename... Fields>
+constexpr auto CborFields(Fields... fields) {
+  return std::make_tuple(fields...);
+}
+
+namespace internal {
+
+template <typename M>
+pw::Status EncodeCborField(cbor::Encoder& encoder,
+                           std::string_view key,
+                           const M& value) {
+  if constexpr (std::is_same_v<M, bool>) {
+    return encoder.WriteBool(key, value);
+  } else if constexpr (std::is_integral_v<M> && std::is_signed_v<M>) {
+    return encoder.WriteInt(key, value);
+  } else if constexpr (std::is_integral_v<M>) {
+    return encoder.WriteUint(key, value);
+  } else if constexpr (std::is_floating_point_v<M>) {
+    return encoder.WriteDouble(key, static_cast<double>(value));
+  } else {
+    return encoder.WriteString(key, std::string_view(value));
+  }
+}
+
+template <typename M>
+pw::Status DecodeCborField(cbor::Decoder& decoder, M& value) {
+  if constexpr (std::is_same_v<M, bool>) {
+    PW_TRY_ASSIGN(value, decoder.ReadBool());
+  } else if constexpr (std::is_integral_v<M> && std::is_signed_v<M>) {
+    PW_TRY_ASSIGN(const int64_t decoded, decoder.ReadInt());
+    if (decoded < std::numeric_limits<M>::min() ||
+        decoded > std::numeric_limits<M>::max()) {
+      return pw::Status::OutOfRange();
+    }
+    value = static_cast<M>(decoded);
+  } else if constexpr (std::is_integral_v<M>) {
+    PW_TRY_ASSIGN(const uint64_t decoded, decoder.ReadUint());
+    if (decoded > std::numeric_limits<M>::max()) {
+      return pw::Status::OutOfRange();
+    }
+    value = static_cast<M>(decoded);
+  } else if constexpr (std::is_floating_point_v<M>) {
+    PW_TRY_ASSIGN(const double decoded, decoder.ReadDouble());
+    value = static_cast<M>(decoded);
+  } else {
+    PW_TRY_ASSIGN(const std::string_view decoded, decoder.ReadStringView());
+    if (decoded.size() > value.max_size()) {
+      return pw::Status::ResourceExhausted();
+    }
+    value.assign(decoded);
+  }
+  return pw::OkStatus();
+}
+
+}  // namespace internal
+
+/// Serializer for structs with a `kCborFields` list (see file comment).
+///
+/// @tparam T Struct type; must be default-constructible
+template <typename T>
+struct CborStructSerializer {
+  /// Encode all fields of `value` as a CBOR map.
+  ///
+  /// @return Number of bytes written, or ResourceExhausted if buffer too
+  ///         small
+  static pw::Result<size_t> Serialize(const T& value, pw::ByteSpan buffer) {
+    cbor::Encoder encoder(buffer);
+    PW_TRY(encoder.BeginMap(std::tuple_size_v<decltype(T::kCborFields)>));
+    pw::Status status = std::apply(
+        [&](const auto&... fields) {
+          pw::Status result;
+          // Stops at the first failing field
+          ((result = result.ok() ? internal::EncodeCborField(
+                                       encoder, fields.key,
+                                       value.*(fields.member))
+                                 : result),
+           ...);
+          return result;
+        },
+        T::kCborFields);
+    PW_TRY(status);
+    return encoder.size();
+  }
+
+  /// Decode a CBOR map into a default-constructed T.
+  ///
+  /// @return The struct, or error (see file comment)
+  static pw::Result<T> Deserialize(pw::ConstByteSpan data) {
+    T value{};
+    cbor::Decoder decoder(data);
+    PW_TRY_ASSIGN(const size_t count, decoder.ReadMapHeader());
+    for (size_t i = 0; i < count; ++i) {
+      PW_TRY_ASSIGN(const std::string_view key, decoder.ReadKeyView());
+      pw::Status status;
+      const bool matched = std::apply(
+          [&](const auto&... fields) {
+            return ((fields.key == key &&
+                     (status = internal::DecodeCborField(
+                          decoder, value.*(fields.member)),
+                      true)) ||
+                    ...);
+          },
+          T::kCborFields);
+      PW_TRY(status);
+      if (!matched) {
+        PW_TRY(decoder.SkipValue());
+      }
+    }
+    return value;
+  }
+
+  /// Content type for CBOR serialization.
+  static constexpr ContentType kContentType = ContentType::kStructured;
+};
+
+}  // namespace pb::cloud
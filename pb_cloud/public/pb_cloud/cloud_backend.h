@@ -33,6 +33,9 @@
 #include <memory>
 #include <string_view>
 
+#include "pb_cloud/config.h"
+#include "pb_cloud/event_arena.h"
+#include "pb_cloud/publish_buffer.h"
 #include "pb_cloud/types.h"
 #include "pw_assert/check.h"
 #include "pw_async2/channel.h"
@@ -43,6 +46,15 @@
 
 namespace pb::cloud {
 
+namespace internal {
+
+// Dependent on V so the check only fires where an allocating overload is
+// instantiated
+template <typename V>
+inline constexpr bool kHeapVariablesAllowed = !PB_CLOUD_NO_HEAP_VARIABLES;
+
+}  // namespace internal
+
 /// Future type for publish completion.
 /// Resolves to pw::Status indicating success or failure.
 using PublishFuture = pw::async2::ValueFuture<pw::Status>;
@@ -54,6 +66,23 @@ using EventReceiver = pw::async2::Receiver<ReceivedEvent>;
 /// Sender for cloud events (used internally by backends).
 using EventSender = pw::async2::Sender<ReceivedEvent>;
 
+/// Caller-provided channel storage for Subscribe(), holding up to kDepth
+/// events that have arrived but were not received yet.
+template <uint16_t kDepth>
+using EventChannelStorage = pw::async2::ChannelStorage<ReceivedEvent, kDepth>;
+
+/// Receiver for events stored in an EventArena.
+using CompactEventReceiver = pw::async2::Receiver<CompactEvent>;
+
+/// Sender for events stored in an EventArena (used internally by backends).
+using CompactEventSender = pw::async2::Sender<CompactEvent>;
+
+/// Caller-provided channel storage for Subscribe() with an EventArena. A
+/// slot only holds a CompactEvent handle, so deep queues are cheap.
+template <uint16_t kDepth>
+using CompactEventChannelStorage =
+    pw::async2::ChannelStorage<CompactEvent, kDepth>;
+
 /// Abstract cloud backend interface.
 ///
 /// Implementations:
@@ -63,20 +92,66 @@ class CloudBackend {
  public:
   virtual ~CloudBackend() = default;
 
+  /// True while connected to the cloud, i.e. publishes can be delivered.
+  virtual bool IsConnected() const = 0;
+
+  /// Snapshot of the backend's counters.
+  virtual CloudStats stats() const = 0;
+
+  /// Resets the backend's counters to zero.
+  virtual void ResetStats() = 0;
+
   // -- Publishing --
 
   /// Publish event data to cloud. Returns future that completes when ack'd.
   ///
   /// Note: data is copied internally - caller's buffer can be freed after call.
   ///
+  /// Up to kMaxPendingPublishes publishes can be in flight at once; each
+  /// future resolves with the result of its own publish. The last
+  /// kHighPriorityPublishSlots of them are kept for PublishPriority::kHigh.
+  ///
   /// @param name Event name (max 64 chars)
   /// @param data Binary payload (will be copied)
-  /// @param options Publish options (scope, ack, content_type, ttl)
-  /// @return Future that resolves to Status when publish completes
+  /// @param options Publish options (scope, ack, content_type, ttl,
+  ///        priority)
+  /// @return Future that resolves to Status when publish completes, or to
+  ///         ResourceExhausted right away if too many publishes of the
+  ///         priority are in flight
   virtual PublishFuture Publish(std::string_view name,
                                 pw::ConstByteSpan data,
                                 const PublishOptions& options) = 0;
 
+  /// Lease one of the backend's kPublishBufferCount publish buffers, to
+  /// serialize an event without a stack buffer.
+  ///
+  /// @return The buffer, or ResourceExhausted if all are leased
+  pw::Result<PublishBuffer> AcquirePublishBuffer() {
+    return publish_buffers_.Acquire();
+  }
+
+  /// Publish the first `size` bytes of a leased buffer.
+  ///
+  /// The data is copied by Publish(name, data, options), so the buffer goes
+  /// back to the pool when this returns, before the ack.
+  ///
+  /// @return Future as from Publish(name, data, options), or resolved to
+  ///         InvalidArgument if `size` exceeds the buffer
+  PublishFuture Publish(std::string_view name,
+                        PublishBuffer buffer,
+                        size_t size,
+                        const PublishOptions& options) {
+    if (size > buffer.data().size()) {
+      return PublishFuture::Resolved(pw::Status::InvalidArgument());
+    }
+    return Publish(name, buffer.data().first(size), options);
+  }
+
+  /// Publish buffers not leased right now.
+  size_t available_publish_buffers() const {
+    return publish_buffers_.available();
+  }
+
   // -- Subscription --
 
   /// Subscribe to cloud events matching prefix.
@@ -104,6 +179,66 @@ class CloudBackend {
   /// @return Receiver handle for receiving events
   virtual EventReceiver Subscribe(std::string_view prefix) = 0;
 
+  /// Subscribe to cloud events matching prefix, buffered in a dedicated
+  /// channel in `storage`.
+  ///
+  /// Unlike Subscribe(prefix), each call adds an independent subscription
+  /// (up to kMaxEventSubscriptions), so e.g. commands and configuration
+  /// updates don't compete for one queue. Each event goes to every
+  /// subscription whose prefix it matches. If a channel is full the event is
+  /// dropped for that subscription only. A subscription ends when its
+  /// receiver is destroyed.
+  ///
+  /// Usage:
+  /// @code
+  /// pb::cloud::EventChannelStorage<16> command_storage;
+  /// pb::cloud::EventChannelStorage<2> config_storage;
+  /// auto commands = backend.Subscribe("device/command", command_storage);
+  /// auto config = backend.Subscribe("device/config", config_storage);
+  /// @endcode
+  ///
+  /// @param prefix Event name prefix to match
+  /// @param storage Channel storage; must outlive the subscription
+  /// @return Receiver handle for receiving events. Already closed if all
+  ///         kMaxEventSubscriptions are in use or the backend couldn't
+  ///         subscribe.
+  template <uint16_t kDepth>
+  EventReceiver Subscribe(std::string_view prefix,
+                          EventChannelStorage<kDepth>& storage) {
+    auto [handle, sender, receiver] =
+        pw::async2::CreateSpscChannel<ReceivedEvent>(storage);
+    if (!DoSubscribe(prefix, handle, sender).ok()) {
+      sender.Disconnect();
+    }
+    return std::move(receiver);
+  }
+
+  /// Subscribe to cloud events matching prefix, stored in `arena` and
+  /// delivered as CompactEvent handles through a channel in `storage`.
+  ///
+  /// Behaves like Subscribe(prefix, storage), but each queued event only
+  /// takes its actual size in the arena. An event is dropped if the arena or
+  /// the channel is full. Several subscriptions may share one arena.
+  ///
+  /// @param prefix Event name prefix to match
+  /// @param storage Channel storage; must outlive the subscription
+  /// @param arena Event storage; must outlive the subscription and its
+  ///              received events
+  /// @return Receiver handle for receiving events. Already closed if all
+  ///         kMaxEventSubscriptions are in use or the backend couldn't
+  ///         subscribe.
+  template <uint16_t kDepth>
+  CompactEventReceiver Subscribe(std::string_view prefix,
+                                 CompactEventChannelStorage<kDepth>& storage,
+                                 EventArena& arena) {
+    auto [handle, sender, receiver] =
+        pw::async2::CreateSpscChannel<CompactEvent>(storage);
+    if (!DoSubscribe(prefix, handle, sender, arena).ok()) {
+      sender.Disconnect();
+    }
+    return std::move(receiver);
+  }
+
   // -- Variables --
 
   /// Register a cloud-readable variable.
@@ -126,6 +261,9 @@ class CloudBackend {
   /// @endcode
   template <typename T>
   CloudVariable<T>& RegisterVariable(std::string_view name, T initial = T{}) {
+    static_assert(
+        internal::kHeapVariablesAllowed<CloudVariable<T>>,
+        "PB_CLOUD_NO_HEAP_VARIABLES: register a caller-owned variable");
     auto var = std::make_unique<CloudVariable<T>>(initial);
     CloudVariable<T>* ptr = var.get();
     pw::Status status = DoRegisterVariable(
@@ -152,6 +290,9 @@ class CloudBackend {
   CloudStringVariable<kMaxSize>& RegisterStringVariable(
       std::string_view name,
       std::string_view initial = "") {
+    static_assert(
+        internal::kHeapVariablesAllowed<CloudStringVariable<kMaxSize>>,
+        "PB_CLOUD_NO_HEAP_VARIABLES: register a caller-owned variable");
     auto var = std::make_unique<CloudStringVariable<kMaxSize>>(initial);
     CloudStringVariable<kMaxSize>* ptr = var.get();
     pw::Status status = DoRegisterVariable(
@@ -160,6 +301,113 @@ class CloudBackend {
     return *ptr;
   }
 
+  /// Register a caller-owned cloud-readable variable.
+  ///
+  /// Nothing is allocated: the backend reads `variable` directly, so it is
+  /// typically a static or a member of a long-lived object.
+  ///
+  /// @param name Variable name (max 64 chars)
+  /// @param variable Variable container; must outlive the backend
+  /// @return OkStatus on success, ResourceExhausted if max variables reached
+  ///
+  /// Usage:
+  /// @code
+  /// pb::cloud::CloudVariable<int> temp(25);
+  /// pb::cloud::CloudStringVariable<16> status("ready");
+  /// PW_CHECK_OK(cloud.RegisterVariable("temperature", temp));
+  /// PW_CHECK_OK(cloud.RegisterVariable("status", status));
+  /// @endcode
+  template <typename T>
+  pw::Status RegisterVariable(std::string_view name,
+                              CloudVariable<T>& variable) {
+    return DoRegisterVariable(
+        name, variable.data(), CloudVariable<T>::type(), VariableStorage());
+  }
+
+  /// Register a caller-owned cloud-readable string variable, sized by its
+  /// kMaxSize. See RegisterVariable(name, CloudVariable<T>&).
+  template <size_t kMaxSize>
+  pw::Status RegisterVariable(std::string_view name,
+                              CloudStringVariable<kMaxSize>& variable) {
+    return DoRegisterVariable(
+        name, variable.data(), VariableType::kString, VariableStorage());
+  }
+
+  /// Register a caller-owned computed variable without allocating. See
+  /// RegisterComputedVariable(name, compute).
+  /// @param variable Variable, e.g. a ComputedCloudVariable<T>; must outlive
+  ///                 the backend
+  /// @return OkStatus on success, ResourceExhausted if max variables reached
+  pw::Status RegisterComputedVariable(std::string_view name,
+                                      ComputedVariable& variable) {
+    return DoRegisterComputedVariable(name, variable, VariableStorage());
+  }
+
+  /// Register a cloud-readable variable computed on each cloud read.
+  ///
+  /// Unlike RegisterVariable(), the application doesn't push updates:
+  /// `compute` runs (on the system thread) only when the cloud queries the
+  /// variable, so expensive values aren't recomputed while nobody reads
+  /// them.
+  ///
+  /// Crashes (via PW_CHECK) if registration fails (e.g., max variables reached).
+  ///
+  /// @tparam T Variable type (bool, int, double)
+  /// @param name Variable name (max 64 chars)
+  /// @param compute Callable returning the current value
+  ///
+  /// Usage:
+  /// @code
+  /// cloud.RegisterComputedVariable<double>(
+  ///     "avgTemp", [&stats]() { return stats.Mean(); });
+  /// @endcode
+  template <typename T>
+  void RegisterComputedVariable(
+      std::string_view name,
+      typename ComputedCloudVariable<T>::Compute&& compute) {
+    static_assert(
+        internal::kHeapVariablesAllowed<ComputedCloudVariable<T>>,
+        "PB_CLOUD_NO_HEAP_VARIABLES: register a caller-owned variable");
+    auto var = std::make_unique<ComputedCloudVariable<T>>(std::move(compute));
+    ComputedVariable& ref = *var;
+    pw::Status status =
+        DoRegisterComputedVariable(name, ref, EraseType(std::move(var)));
+    PW_CHECK_OK(status, "Failed to register computed variable");
+  }
+
+  /// Register a cloud-readable string variable computed on each cloud read.
+  ///
+  /// Crashes (via PW_CHECK) if registration fails (e.g., max variables reached).
+  ///
+  /// @tparam kMaxSize Buffer size including the terminator (default:
+  ///                  Particle max of 622)
+  /// @param name Variable name (max 64 chars)
+  /// @param compute Callable writing the current value into its cleared
+  ///                StringBuilder argument; longer values are truncated
+  ///
+  /// Usage:
+  /// @code
+  /// cloud.RegisterComputedStringVariable<64>(
+  ///     "summary", [&](pw::StringBuilder& value) {
+  ///       value << "n=" << stats.count() << " mean=" << stats.Mean();
+  ///     });
+  /// @endcode
+  template <size_t kMaxSize = kMaxStringVariableSize>
+  void RegisterComputedStringVariable(
+      std::string_view name,
+      typename ComputedCloudStringVariable<kMaxSize>::Compute&& compute) {
+    static_assert(
+        internal::kHeapVariablesAllowed<
+            ComputedCloudStringVariable<kMaxSize>>,
+        "PB_CLOUD_NO_HEAP_VARIABLES: register a caller-owned variable");
+    auto var = std::make_unique<ComputedCloudStringVariable<kMaxSize>>(
+        std::move(compute));
+    ComputedVariable& ref = *var;
+    pw::Status status =
+        DoRegisterComputedVariable(name, ref, EraseType(std::move(var)));
+    PW_CHECK_OK(status, "Failed to register computed string variable");
+  }
+
   // -- Functions --
 
   /// Cloud function callback type.
@@ -200,28 +448,70 @@ class CloudBackend {
  protected:
   // -- Implementation hooks for backends --
 
-  /// Type-erased deleter for variable storage.
-  using VariableDeleter = void (*)(void*);
+  /// Type-erased deleter for variable storage. A struct rather than a
+  /// function pointer so empty VariableStorage is default-constructible.
+  struct VariableDeleter {
+    void (*destroy)(void*) = nullptr;
+
+    void operator()(void* ptr) const { destroy(ptr); }
+  };
+
+  /// Ownership of a variable container; empty for caller-owned variables.
+  using VariableStorage = std::unique_ptr<void, VariableDeleter>;
 
   /// Backend implementation for variable registration.
   /// @param name Variable name
   /// @param data Pointer to variable data (for Particle API)
   /// @param type Variable type
-  /// @param storage Ownership of the variable container (type-erased)
+  /// @param storage Ownership of the variable container (type-erased), or
+  ///                empty if the caller owns it
   /// @return OkStatus on success, ResourceExhausted if max variables reached
   virtual pw::Status DoRegisterVariable(
       std::string_view name,
       const void* data,
       VariableType type,
-      std::unique_ptr<void, VariableDeleter> storage) = 0;
+      VariableStorage storage) = 0;
+
+  /// Backend implementation for computed variable registration.
+  /// @param name Variable name
+  /// @param variable Variable to Read() on each cloud query
+  /// @param storage Ownership of `variable` (type-erased), or empty if the
+  ///                caller owns it
+  /// @return OkStatus on success, ResourceExhausted if max variables reached
+  virtual pw::Status DoRegisterComputedVariable(
+      std::string_view name,
+      ComputedVariable& variable,
+      VariableStorage storage) = 0;
+
+  /// Backend implementation for subscriptions with their own channel.
+  /// On success takes ownership of `handle` and `sender` and delivers the
+  /// matching events through `sender`; on failure leaves both untouched.
+  /// @return OkStatus on success, ResourceExhausted if
+  ///         kMaxEventSubscriptions are active, Internal if the cloud
+  ///         subscription failed
+  virtual pw::Status DoSubscribe(
+      std::string_view prefix,
+      pw::async2::SpscChannelHandle<ReceivedEvent>& handle,
+      EventSender& sender) = 0;
+
+  /// Backend implementation for subscriptions with an EventArena; like
+  /// DoSubscribe() above, but each event is stored in `arena` first.
+  virtual pw::Status DoSubscribe(
+      std::string_view prefix,
+      pw::async2::SpscChannelHandle<CompactEvent>& handle,
+      CompactEventSender& sender,
+      EventArena& arena) = 0;
 
   /// Helper to create type-erased storage from unique_ptr.
   template <typename T>
-  static std::unique_ptr<void, VariableDeleter> EraseType(
-      std::unique_ptr<T> ptr) {
-    return std::unique_ptr<void, VariableDeleter>(
-        ptr.release(), [](void* p) { delete static_cast<T*>(p); });
+  static VariableStorage EraseType(std::unique_ptr<T> ptr) {
+    return VariableStorage(
+        ptr.release(),
+        VariableDeleter{[](void* p) { delete static_cast<T*>(p); }});
   }
+
+ private:
+  PublishBufferPool publish_buffers_;
 };
 
 }  // namespace pb::cloud
@@ -0,0 +1,152 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file compressed_serializer.h
+/// @brief Serializers that LZ-compress the output of another serializer.
+///
+/// Wraps any serializer, so compressed payloads work with PublishTyped(),
+/// DeserializeEvent(), ReadLedger() and WriteLedger() unchanged:
+///
+/// @code
+/// inline constexpr pb::cloud::LzDictionary kTelemetryKeys{
+///     .id = 1, .data = "temperaturehumiditypressure_pa"};
+///
+/// using TelemetrySerializer = pb::cloud::CompressedSerializer<
+///     pb::cloud::ProtoSerializer<Telemetry>, kTelemetryKeys>;
+///
+/// auto future = pb::cloud::PublishTyped<Telemetry::Message,
+///                                        TelemetrySerializer>(
+///     cloud, "telemetry", message);
+/// @endcode
+///
+/// Particle ledgers hold CBOR maps, so CompressedLedgerSerializer stores the
+/// compressed bytes as {"lz": bytes} instead.
+///
+/// The inner serializer runs on a stack scratch buffer of kMaxInputSize
+/// bytes. Its Deserialize() must therefore return a value that owns its
+/// data (e.g. a pwpb message with bounded fields), not a view into the
+/// input such as Serializer<std::string_view>.
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+#include "pb_cloud/cbor.h"
+#include "pb_cloud/lz.h"
+#include "pb_cloud/types.h"
+#include "pw_bytes/span.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+
+namespace pb::cloud {
+
+/// Serializer that compresses the output of `Inner`.
+///
+/// @tparam Inner Serializer of the uncompressed value
+/// @tparam kDictionary Preset dictionary, shared with the receiver
+/// @tparam kMaxInputSize Largest uncompressed payload (stack scratch)
+template <typename Inner,
+          const LzDictionary& kDictionary = kNoLzDictionary,
+          size_t kMaxInputSize = 2 * kMaxEventDataSize>
+struct CompressedSerializer {
+  /// Serialize with `Inner`, then compress into `buffer`.
+  /// @return Compressed size, or the error of Inner or LzCompress()
+  template <typename T>
+  static pw::Result<size_t> Serialize(const T& value, pw::ByteSpan buffer) {
+    std::array<std::byte, kMaxInputSize> scratch;
+    pw::Result<size_t> size = Inner::Serialize(value, scratch);
+    if (!size.ok()) {
+      return size.status();
+    }
+    return LzCompress(pw::ConstByteSpan(scratch.data(), size.value()),
+                      buffer,
+                      kDictionary);
+  }
+
+  /// Decompress `data`, then deserialize with `Inner`.
+  static auto Deserialize(pw::ConstByteSpan data)
+      -> decltype(Inner::Deserialize(data)) {
+    std::array<std::byte, kMaxInputSize> scratch;
+    pw::Result<size_t> size = LzDecompress(data, scratch, kDictionary);
+    if (!size.ok()) {
+      return size.status();
+    }
+    return Inner::Deserialize(pw::ConstByteSpan(scratch.data(), size.value()));
+  }
+
+  /// Compressed data is binary whatever the inner content type.
+  static constexpr ContentType kContentType = ContentType::kBinary;
+};
+
+/// CompressedSerializer for ledgers: the compressed bytes are stored as the
+/// CBOR map {"lz": bytes}, which Particle accepts as ledger data.
+template <typename Inner,
+          const LzDictionary& kDictionary = kNoLzDictionary,
+          size_t kMaxInputSize = 2 * kMaxEventDataSize>
+struct CompressedLedgerSerializer {
+  using Compressed = CompressedSerializer<Inner, kDictionary, kMaxInputSize>;
+
+  /// Map key of the compressed bytes.
+  static constexpr std::string_view kKey = "lz";
+
+  /// Map header (1), key (3) and the longest byte string header (5).
+  static constexpr size_t kOverhead = 9;
+
+  template <typename T>
+  static pw::Result<size_t> Serialize(const T& value, pw::ByteSpan buffer) {
+    if (buffer.size() <= kOverhead) {
+      return pw::Status::ResourceExhausted();
+    }
+    // Compress behind the room for the CBOR headers, then move the bytes
+    // up to the headers once their length is known
+    pw::Result<size_t> size =
+        Compressed::Serialize(value, buffer.subspan(kOverhead));
+    if (!size.ok()) {
+      return size.status();
+    }
+    std::byte* out = buffer.data();
+    size_t pos = cbor::internal::EncodeHeader(cbor::MajorType::kMap, 1, out);
+    pos += cbor::internal::EncodeHeader(
+        cbor::MajorType::kTextString, kKey.size(), out + pos);
+    std::memcpy(out + pos, kKey.data(), kKey.size());
+    pos += kKey.size();
+    pos += cbor::internal::EncodeHeader(
+        cbor::MajorType::kByteString, size.value(), out + pos);
+    std::memmove(out + pos, out + kOverhead, size.value());
+    return pos + size.value();
+  }
+
+  static auto Deserialize(pw::ConstByteSpan data)
+      -> decltype(Inner::Deserialize(data)) {
+    cbor::Decoder decoder(data);
+    pw::Result<size_t> entries = decoder.ReadMapHeader();
+    if (!entries.ok()) {
+      return pw::Status::DataLoss();
+    }
+    for (size_t i = 0; i < entries.value(); ++i) {
+      pw::Result<std::string_view> key = decoder.ReadKeyView();
+      if (!key.ok()) {
+        return pw::Status::DataLoss();
+      }
+      if (key.value() != kKey) {
+        if (!decoder.SkipValue().ok()) {
+          return pw::Status::DataLoss();
+        }
+        continue;
+      }
+      pw::Result<pw::ConstByteSpan> bytes = decoder.ReadBytesView();
+      if (!bytes.ok()) {
+        return pw::Status::DataLoss();
+      }
+      return Compressed::Deserialize(bytes.value());
+    }
+    return pw::Status::NotFound();
+  }
+
+  static constexpr ContentType kContentType = ContentType::kBinary;
+};
+
+}  // namespace pb::cloud
@@ -0,0 +1,53 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+// Configuration options for pb_cloud and pb_ledger
+
+// Log level of the pb_cloud and pb_ledger sources (a PW_LOG_LEVEL_* value).
+// Per-event and per-publish messages are DEBUG, so the default keeps only
+// registration, warnings and errors. Builds with -DPB_CLOUD_LOG_LEVEL=
+// PW_LOG_LEVEL_DEBUG trace every event; PW_LOG_LEVEL_WARN drops the rest of
+// the INFO messages too.
+#ifndef PB_CLOUD_LOG_LEVEL
+#define PB_CLOUD_LOG_LEVEL PW_LOG_LEVEL_INFO
+#endif  // PB_CLOUD_LOG_LEVEL
+
+// Number of cloud functions a backend can register. Each takes a
+// CloudFunction slot in the backend; Device OS dispatches through one
+// handler, so the count has no code size cost.
+#ifndef PB_CLOUD_MAX_CLOUD_FUNCTIONS
+#define PB_CLOUD_MAX_CLOUD_FUNCTIONS 15
+#endif  // PB_CLOUD_MAX_CLOUD_FUNCTIONS
+
+// Number of operations a LedgerWorker can queue. Each slot holds a ledger
+// name and two ValueProviders, about 100 bytes.
+#ifndef PB_CLOUD_MAX_PENDING_LEDGER_OPS
+#define PB_CLOUD_MAX_PENDING_LEDGER_OPS 4
+#endif  // PB_CLOUD_MAX_PENDING_LEDGER_OPS
+
+// Number of properties a LedgerWriteBack can hold back, and the longest
+// string value it stages. Each entry takes about 100 bytes plus the string.
+#ifndef PB_CLOUD_WRITE_BACK_MAX_ENTRIES
+#define PB_CLOUD_WRITE_BACK_MAX_ENTRIES 16
+#endif  // PB_CLOUD_WRITE_BACK_MAX_ENTRIES
+
+#ifndef PB_CLOUD_WRITE_BACK_MAX_STRING_SIZE
+#define PB_CLOUD_WRITE_BACK_MAX_STRING_SIZE 32
+#endif  // PB_CLOUD_WRITE_BACK_MAX_STRING_SIZE
+
+// Number of publish buffers a cloud backend lends to PublishTyped() and
+// AcquirePublishBuffer(). Each is kMaxEventDataSize (1 KB) of backend
+// memory; a buffer is only held while a value is serialized, so one per
+// thread that publishes is enough.
+#ifndef PB_CLOUD_PUBLISH_BUFFER_COUNT
+#define PB_CLOUD_PUBLISH_BUFFER_COUNT 2
+#endif  // PB_CLOUD_PUBLISH_BUFFER_COUNT
+
+// Reject the RegisterVariable() and RegisterComputedVariable() overloads
+// that allocate the variable on the heap, at compile time. The overloads
+// taking a caller-owned variable remain.
+#ifndef PB_CLOUD_NO_HEAP_VARIABLES
+#define PB_CLOUD_NO_HEAP_VARIABLES 0
+#endif  // PB_CLOUD_NO_HEAP_VARIABLES
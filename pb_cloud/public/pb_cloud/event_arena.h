@@ -0,0 +1,148 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file event_arena.h
+/// @brief Variable-length storage for received cloud events.
+///
+/// A ReceivedEvent reserves the Particle maximum of 1 KB data plus a 64-byte
+/// name, so a channel of depth N costs N KB even when typical events are a
+/// few bytes. An EventArena packs events into a caller-provided ring buffer,
+/// each taking only its actual size, and the channel carries small
+/// CompactEvent handles into it.
+///
+/// Usage:
+/// @code
+/// std::array<std::byte, 2048> arena_buffer;
+/// pb::cloud::EventArena arena(arena_buffer);
+/// pb::cloud::CompactEventChannelStorage<32> storage;
+/// auto commands = cloud.Subscribe("device/command", storage, arena);
+///
+/// // In async loop, after receiving `event`:
+/// HandleCommand(event.name(), event.data());
+/// // The arena space is released when `event` is destroyed
+/// @endcode
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "pb_cloud/types.h"
+#include "pw_bytes/span.h"
+#include "pw_result/result.h"
+
+namespace pb::cloud {
+
+class EventArena;
+
+/// Received cloud event stored in an EventArena.
+///
+/// Move-only handle; the event's arena space is released when the handle is
+/// destroyed or Release() is called. The arena must outlive its events.
+class CompactEvent {
+ public:
+  CompactEvent() = default;
+  ~CompactEvent() { Release(); }
+
+  CompactEvent(const CompactEvent&) = delete;
+  CompactEvent& operator=(const CompactEvent&) = delete;
+
+  CompactEvent(CompactEvent&& other) noexcept
+      : arena_(other.arena_), record_(other.record_) {
+    other.arena_ = nullptr;
+    other.record_ = nullptr;
+  }
+
+  CompactEvent& operator=(CompactEvent&& other) noexcept {
+    if (this != &other) {
+      Release();
+      arena_ = other.arena_;
+      record_ = other.record_;
+      other.arena_ = nullptr;
+      other.record_ = nullptr;
+    }
+    return *this;
+  }
+
+  /// True if the handle refers to an event.
+  bool has_value() const { return record_ != nullptr; }
+
+  /// Event name; empty if the handle is empty.
+  std::string_view name() const;
+
+  /// Event data; empty if the handle is empty.
+  pw::ConstByteSpan data() const;
+
+  ContentType content_type() const;
+
+  /// Releases the event's arena space early; the handle becomes empty.
+  void Release();
+
+ private:
+  friend class EventArena;
+
+  CompactEvent(EventArena& arena, std::byte* record)
+      : arena_(&arena), record_(record) {}
+
+  EventArena* arena_ = nullptr;
+  std::byte* record_ = nullptr;
+};
+
+/// Ring buffer of variable-length received events.
+///
+/// Each event takes kEventHeaderSize plus its name and data. Space is
+/// reclaimed in arrival order: an event released out of order frees its
+/// space once all older events are released too.
+///
+/// Thread Safety: not thread-safe. Backends store events from the cloud
+/// callback thread, which on Particle is the application thread.
+class EventArena {
+ public:
+  /// Size of the per-event header: record size, name length, flags, data
+  /// length and content type.
+  static constexpr size_t kEventHeaderSize = 8;
+
+  /// Arena space taken by an event.
+  static constexpr size_t EventSize(size_t name_size, size_t data_size) {
+    return kEventHeaderSize + name_size + data_size;
+  }
+
+  /// @param buffer Storage for the events; must outlive the arena
+  explicit EventArena(pw::ByteSpan buffer);
+
+  EventArena(const EventArena&) = delete;
+  EventArena& operator=(const EventArena&) = delete;
+
+  /// Copies an event into the arena.
+  /// @return Handle to the stored event, or:
+  ///         - InvalidArgument if the name or data exceed the Particle
+  ///           limits
+  ///         - ResourceExhausted if the arena has no room
+  pw::Result<CompactEvent> Store(std::string_view name,
+                                 pw::ConstByteSpan data,
+                                 ContentType content_type);
+
+  /// Events stored and not yet reclaimed.
+  size_t event_count() const { return event_count_; }
+
+  size_t capacity() const { return buffer_.size(); }
+
+ private:
+  friend class CompactEvent;
+
+  // Marks the record released and reclaims released records at the tail.
+  void Release(std::byte* record);
+
+  pw::ByteSpan buffer_;
+
+  // Records occupy [tail_, head_), or [tail_, wrap_) and [0, head_) once
+  // the head has wrapped around.
+  size_t head_ = 0;
+  size_t tail_ = 0;
+  size_t wrap_ = 0;
+  bool wrapped_ = false;
+  size_t event_count_ = 0;
+};
+
+}  // namespace pb::cloud
@@ -32,16 +32,20 @@
 /// MyComponent component(ledger);
 /// @endcode
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
 #include <string_view>
 
 #include "pb_cloud/ledger_editor.h"
 #include "pb_cloud/ledger_handle.h"
+#include "pb_cloud/ledger_stream.h"
 #include "pb_cloud/ledger_types.h"
 #include "pw_async2/channel.h"
 #include "pw_containers/vector.h"
 #include "pw_result/result.h"
 #include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
 #include "pw_status/try.h"
 #include "pw_string/string.h"
 
@@ -81,6 +85,11 @@ class LedgerBackend {
   /// Returns a Receiver channel handle. Events are delivered when the
   /// ledger syncs with the cloud. Caller polls the receiver to get events.
   ///
+  /// Events are coalesced: at most one is pending per ledger, and syncs
+  /// while it is pending are folded into it rather than dropped. To find
+  /// out which properties changed, refresh a LedgerCache with
+  /// LedgerHandle::RefreshCache() and query its changed keys.
+  ///
   /// Note: Each call creates a new subscription channel. Only one active
   /// subscription per ledger is typically needed.
   ///
@@ -113,8 +122,14 @@ class LedgerBackend {
   /// @return OkStatus on success, or error status
   virtual pw::Status PurgeAll() = 0;
 
+  /// Number of LedgerHandle::Write() calls (including LedgerEditor
+  /// commits and WriteLedger()) skipped because the data was unchanged.
+  uint32_t skipped_write_count() const { return skipped_writes_; }
+
  protected:
   friend class LedgerHandle;
+  friend class LedgerReader;
+  friend class LedgerWriter;
 
   /// Create a LedgerHandle from an instance pointer.
   /// Derived classes use this to create handles in GetLedger().
@@ -142,15 +157,123 @@ class LedgerBackend {
   /// Called by LedgerHandle::Write().
   virtual pw::Status DoWrite(internal::LedgerInstance* instance,
                              pw::ConstByteSpan data) = 0;
+
+  /// Open a ledger stream.
+  /// Called by LedgerHandle::OpenReader() and OpenWriter().
+  virtual pw::Result<internal::LedgerStream*> DoOpenStream(
+      internal::LedgerInstance* instance, LedgerStreamMode mode) = 0;
+
+  /// Read the next chunk from a read stream.
+  /// LedgerReader never asks for more than the bytes remaining.
+  virtual pw::StatusWithSize DoReadStream(internal::LedgerStream* stream,
+                                          pw::ByteSpan buffer) = 0;
+
+  /// Append a chunk to a write stream.
+  virtual pw::Status DoWriteStream(internal::LedgerStream* stream,
+                                   pw::ConstByteSpan data) = 0;
+
+  /// Close a stream. For a write stream, `commit` selects between making
+  /// the written data the ledger's content and discarding it.
+  virtual pw::Status DoCloseStream(internal::LedgerStream* stream,
+                                   bool commit) = 0;
+
+  /// Counter that changes whenever the ledger's data may have changed.
+  /// Called by LedgerHandle to check whether its LedgerCache is stale.
+  virtual uint32_t DoGetRevision(internal::LedgerInstance* instance) = 0;
+
+  /// Forget the digest of the last write to `instance`. Backends whose
+  /// instance pointers can be reused for another ledger call this when
+  /// they release an instance.
+  void ForgetWrites(internal::LedgerInstance* instance) {
+    for (WrittenDigest& written : written_) {
+      if (written.instance == instance) {
+        written = WrittenDigest{};
+      }
+    }
+  }
+
+ private:
+  // Digest of the data a LedgerHandle::Write() stored, valid while the
+  // ledger's revision is unchanged. A sync, purge or stream write bumps the
+  // revision, so the next write goes through even with the same data.
+  struct WrittenDigest {
+    internal::LedgerInstance* instance = nullptr;
+    uint32_t revision = 0;
+    uint32_t size = 0;
+    uint64_t hash = 0;
+  };
+
+  /// Whether `data` is what the last write to `instance` stored.
+  bool IsUnchanged(internal::LedgerInstance* instance,
+                   pw::ConstByteSpan data,
+                   uint64_t hash);
+
+  /// Remember `data` as the content of `instance` after a write.
+  void RecordWrite(internal::LedgerInstance* instance,
+                   pw::ConstByteSpan data,
+                   uint64_t hash);
+
+  std::array<WrittenDigest, kMaxLedgerCount> written_{};
+  size_t next_written_ = 0;  // Slot replaced when no slot matches
+  uint32_t skipped_writes_ = 0;
 };
 
+namespace internal {
+
+/// 64-bit FNV-1a of ledger data, for detecting unchanged writes.
+inline uint64_t LedgerDigest(pw::ConstByteSpan data) {
+  uint64_t hash = 14695981039346656037u;
+  for (std::byte b : data) {
+    hash ^= static_cast<uint8_t>(b);
+    hash *= 1099511628211u;
+  }
+  return hash;
+}
+
+}  // namespace internal
+
+inline bool LedgerBackend::IsUnchanged(internal::LedgerInstance* instance,
+                                       pw::ConstByteSpan data,
+                                       uint64_t hash) {
+  for (const WrittenDigest& written : written_) {
+    if (written.instance == instance) {
+      return written.size == data.size() && written.hash == hash &&
+             written.revision == DoGetRevision(instance);
+    }
+  }
+  return false;
+}
+
+inline void LedgerBackend::RecordWrite(internal::LedgerInstance* instance,
+                                       pw::ConstByteSpan data,
+                                       uint64_t hash) {
+  WrittenDigest* slot = nullptr;
+  for (WrittenDigest& written : written_) {
+    if (written.instance == instance) {
+      slot = &written;
+      break;
+    }
+  }
+  if (slot == nullptr) {
+    slot = &written_[next_written_];
+    next_written_ = (next_written_ + 1) % written_.size();
+  }
+  *slot = {.instance = instance,
+           .revision = DoGetRevision(instance),
+           .size = static_cast<uint32_t>(data.size()),
+           .hash = hash};
+}
+
 // -- LedgerHandle Implementation --
 // Defined here after LedgerBackend is complete.
 
 inline LedgerHandle::LedgerHandle(LedgerHandle&& other) noexcept
-    : instance_(other.instance_), backend_(other.backend_) {
+    : instance_(other.instance_),
+      backend_(other.backend_),
+      cache_(other.cache_) {
   other.instance_ = nullptr;
   other.backend_ = nullptr;
+  other.cache_ = nullptr;
 }
 
 inline LedgerHandle& LedgerHandle::operator=(LedgerHandle&& other) noexcept {
@@ -158,8 +281,10 @@ inline LedgerHandle& LedgerHandle::operator=(LedgerHandle&& other) noexcept {
     Release();
     instance_ = other.instance_;
     backend_ = other.backend_;
+    cache_ = other.cache_;
     other.instance_ = nullptr;
     other.backend_ = nullptr;
+    other.cache_ = nullptr;
   }
   return *this;
 }
@@ -172,6 +297,7 @@ inline void LedgerHandle::Release() {
     instance_ = nullptr;
     backend_ = nullptr;
   }
+  cache_ = nullptr;
 }
 
 inline pw::Result<LedgerInfo> LedgerHandle::GetInfo() const {
@@ -192,14 +318,123 @@ inline pw::Status LedgerHandle::Write(pw::ConstByteSpan data) {
   if (!is_valid()) {
     return pw::Status::FailedPrecondition();
   }
-  return backend_->DoWrite(instance_, data);
+  const uint64_t hash = internal::LedgerDigest(data);
+  if (backend_->IsUnchanged(instance_, data, hash)) {
+    ++backend_->skipped_writes_;
+    return pw::OkStatus();
+  }
+  if (cache_ != nullptr) {
+    cache_->Invalidate();
+  }
+  PW_TRY(backend_->DoWrite(instance_, data));
+  backend_->RecordWrite(instance_, data, hash);
+  return pw::OkStatus();
+}
+
+// -- Ledger Stream Implementation --
+
+inline pw::Result<LedgerReader> LedgerHandle::OpenReader() {
+  if (!is_valid()) {
+    return pw::Status::FailedPrecondition();
+  }
+  PW_TRY_ASSIGN(const LedgerInfo info, backend_->DoGetInfo(instance_));
+  PW_TRY_ASSIGN(internal::LedgerStream* stream,
+                backend_->DoOpenStream(instance_, LedgerStreamMode::kRead));
+  return LedgerReader(backend_, stream, info.data_size);
+}
+
+inline pw::Result<LedgerWriter> LedgerHandle::OpenWriter() {
+  if (!is_valid()) {
+    return pw::Status::FailedPrecondition();
+  }
+  if (cache_ != nullptr) {
+    cache_->Invalidate();
+  }
+  PW_TRY_ASSIGN(internal::LedgerStream* stream,
+                backend_->DoOpenStream(instance_, LedgerStreamMode::kWrite));
+  return LedgerWriter(backend_, stream);
+}
+
+inline void LedgerReader::Close() {
+  if (stream_ != nullptr) {
+    (void)backend_->DoCloseStream(stream_, false);
+    backend_ = nullptr;
+    stream_ = nullptr;
+    remaining_ = 0;
+  }
+}
+
+inline pw::StatusWithSize LedgerReader::DoRead(pw::ByteSpan dest) {
+  if (stream_ == nullptr) {
+    return pw::StatusWithSize::FailedPrecondition();
+  }
+  if (remaining_ == 0) {
+    return pw::StatusWithSize::OutOfRange();
+  }
+  if (dest.size() > remaining_) {
+    dest = dest.first(remaining_);
+  }
+  const pw::StatusWithSize result = backend_->DoReadStream(stream_, dest);
+  if (!result.ok()) {
+    return result;
+  }
+  if (result.size() == 0) {
+    // The ledger is shorter than its info claimed
+    remaining_ = 0;
+    return pw::StatusWithSize::OutOfRange();
+  }
+  remaining_ -= result.size();
+  return result;
+}
+
+inline pw::Status LedgerWriter::DoWrite(pw::ConstByteSpan data) {
+  if (stream_ == nullptr) {
+    return pw::Status::FailedPrecondition();
+  }
+  if (data.size() > kMaxLedgerDataSize - bytes_written_) {
+    return pw::Status::ResourceExhausted();
+  }
+  PW_TRY(backend_->DoWriteStream(stream_, data));
+  bytes_written_ += data.size();
+  return pw::OkStatus();
+}
+
+inline pw::Status LedgerWriter::Close(bool commit) {
+  if (stream_ == nullptr) {
+    return pw::Status::FailedPrecondition();
+  }
+  const pw::Status status = backend_->DoCloseStream(stream_, commit);
+  backend_ = nullptr;
+  stream_ = nullptr;
+  return status;
 }
 
 // -- CBOR Property Getters Implementation --
 
+inline pw::Status LedgerHandle::RefreshCache() {
+  if (!is_valid() || cache_ == nullptr) {
+    return pw::Status::FailedPrecondition();
+  }
+  const uint32_t revision = backend_->DoGetRevision(instance_);
+  if (cache_->loaded_ && cache_->revision_ == revision) {
+    return pw::OkStatus();
+  }
+  cache_->Invalidate();
+  PW_TRY_ASSIGN(const size_t size, Read(cache_->buffer_));
+  if (size == cache_->buffer_.size()) {
+    // The ledger may be larger than the buffer
+    return pw::Status::ResourceExhausted();
+  }
+  return cache_->Load(size, revision);
+}
+
 inline bool LedgerHandle::FindKey(std::string_view target_key,
                                   cbor::Decoder& decoder,
                                   pw::ByteSpan read_buffer) {
+  if (cache_ != nullptr && RefreshCache().ok()) {
+    return cache_->Find(target_key, decoder);
+  }
+
   auto read_result = Read(read_buffer);
   if (!read_result.ok() || read_result.value() == 0) {
     return false;
@@ -214,10 +449,8 @@ inline bool LedgerHandle::FindKey(std::string_view target_key,
   }
   size_t count = count_result.value();
 
-  std::array<char, kMaxLedgerNameSize> key_buf{};
   for (size_t i = 0; i < count; ++i) {
-    auto key_result =
-        decoder.ReadKey(pw::as_writable_bytes(pw::span(key_buf)));
+    auto key_result = decoder.ReadKeyView();
     if (!key_result.ok()) {
       return false;
     }
@@ -326,7 +559,7 @@ inline pw::Result<size_t> LedgerHandle::GetBytes(std::string_view key,
   return decoder.ReadBytes(out_buffer);
 }
 
-inline pw::Result<LedgerEditor> LedgerHandle::Edit(pw::ByteSpan buffer) {
+inline pw::Result<size_t> LedgerHandle::ReadForEdit(pw::ByteSpan buffer) {
   if (!is_valid()) {
     return pw::Status::FailedPrecondition();
   }
@@ -340,29 +573,59 @@ inline pw::Result<LedgerEditor> LedgerHandle::Edit(pw::ByteSpan buffer) {
     }
   }
 
-  size_t existing_size = read_result.ok() ? read_result.value() : 0;
-  return LedgerEditor(this, buffer, existing_size);
+  return read_result.ok() ? read_result.value() : 0;
+}
+
+template <size_t kMaxProperties>
+pw::Result<InlineLedgerEditor<kMaxProperties>> LedgerHandle::Edit(
+    pw::ByteSpan buffer) {
+  PW_TRY_ASSIGN(const size_t existing_size, ReadForEdit(buffer));
+  InlineLedgerEditor<kMaxProperties> editor(this, buffer, existing_size);
+  if (editor.too_many_properties_) {
+    return pw::Status::ResourceExhausted();
+  }
+  return editor;
+}
+
+inline pw::Result<LedgerEditor> LedgerHandle::Edit(
+    pw::ByteSpan buffer, pw::span<PropertyEntry> properties) {
+  PW_TRY_ASSIGN(const size_t existing_size, ReadForEdit(buffer));
+  LedgerEditor editor(this, buffer, existing_size, properties);
+  if (editor.too_many_properties_) {
+    return pw::Status::ResourceExhausted();
+  }
+  return editor;
 }
 
 // -- LedgerEditor Implementation --
 
 inline LedgerEditor::LedgerEditor(LedgerHandle* handle, pw::ByteSpan buffer,
-                                  size_t existing_data_size)
-    : handle_(handle), buffer_(buffer) {
+                                  size_t existing_data_size,
+                                  pw::span<PropertyEntry> properties)
+    : handle_(handle),
+      buffer_(buffer),
+      properties_(properties),
+      existing_size_(existing_data_size) {
   // Parse existing data into properties
   if (existing_data_size > 0) {
     cbor::Decoder decoder(
         pw::ConstByteSpan(buffer.data(), existing_data_size));
+    // Well-formed data is parsed without per-read checks; malformed data
+    // keeps the checked reads and stops at the first bad property
+    decoder.Validate().IgnoreError();
     auto count_result = decoder.ReadMapHeader();
     if (count_result.ok()) {
       size_t count = count_result.value();
 
-      for (size_t i = 0; i < count && property_count_ < kMaxLedgerProperties;
-           ++i) {
+      for (size_t i = 0; i < count; ++i) {
+        if (property_count_ >= properties_.size()) {
+          // Committing would drop the rest; LedgerHandle::Edit() fails
+          too_many_properties_ = true;
+          break;
+        }
+
         // Read key - need to store it in our string buffer
-        std::array<char, kMaxLedgerNameSize> temp_key{};
-        auto key_result =
-            decoder.ReadKey(pw::as_writable_bytes(pw::span(temp_key)));
+        auto key_result = decoder.ReadKeyView();
         if (!key_result.ok()) {
           break;
         }
@@ -381,6 +644,7 @@ inline LedgerEditor::LedgerEditor(LedgerHandle* handle, pw::ByteSpan buffer,
             reinterpret_cast<const char*>(key_alloc.value()), key_view.size());
 
         // Peek at the type and read the value
+        const size_t value_start = decoder.position();
         auto type_result = decoder.PeekType();
         if (!type_result.ok()) {
           break;
@@ -402,31 +666,27 @@ inline LedgerEditor::LedgerEditor(LedgerHandle* handle, pw::ByteSpan buffer,
             break;
           }
           case cbor::MajorType::kByteString: {
-            // Peek at length first to allocate exactly what we need
-            auto len_peek = decoder.PeekStringLength();
-            if (!len_peek.ok()) break;
-            size_t len = len_peek.value();
+            auto view = decoder.ReadBytesView();
+            if (!view.ok()) break;
 
-            auto bytes_result = AllocateBuffer(len);
+            auto bytes_result = AllocateBuffer(view.value().size());
             if (!bytes_result.ok()) break;
-            auto read_len = decoder.ReadBytes(pw::ByteSpan(bytes_result.value(), len));
-            if (!read_len.ok()) break;
+            std::memcpy(bytes_result.value(), view.value().data(),
+                        view.value().size());
             entry.span_value.data = bytes_result.value();
-            entry.span_value.size = read_len.value();
+            entry.span_value.size = view.value().size();
             break;
           }
           case cbor::MajorType::kTextString: {
-            // Peek at length first to allocate exactly what we need
-            auto len_peek = decoder.PeekStringLength();
-            if (!len_peek.ok()) break;
-            size_t len = len_peek.value();
+            auto view = decoder.ReadStringView();
+            if (!view.ok()) break;
 
-            auto str_result = AllocateBuffer(len);
+            auto str_result = AllocateBuffer(view.value().size());
             if (!str_result.ok()) break;
-            auto read_len = decoder.ReadString(pw::ByteSpan(str_result.value(), len));
-            if (!read_len.ok()) break;
+            std::memcpy(str_result.value(), view.value().data(),
+                        view.value().size());
             entry.span_value.data = str_result.value();
-            entry.span_value.size = read_len.value();
+            entry.span_value.size = view.value().size();
             break;
           }
           case cbor::MajorType::kSimpleFloat: {
@@ -458,20 +718,25 @@ inline LedgerEditor::LedgerEditor(LedgerHandle* handle, pw::ByteSpan buffer,
             decoder.SkipValue();
             continue;
         }
+        entry.value_offset = value_start;
+        entry.value_size = decoder.position() - value_start;
         ++property_count_;
       }
     }
   }
+  AllocateIndex();
 }
 
 inline LedgerEditor::LedgerEditor(LedgerEditor&& other) noexcept
     : handle_(other.handle_),
       buffer_(other.buffer_),
+      properties_(other.properties_),
       property_count_(other.property_count_),
-      string_buffer_used_(other.string_buffer_used_) {
-  for (size_t i = 0; i < property_count_; ++i) {
-    properties_[i] = other.properties_[i];
-  }
+      string_buffer_used_(other.string_buffer_used_),
+      index_(other.index_),
+      existing_size_(other.existing_size_),
+      layout_changed_(other.layout_changed_),
+      too_many_properties_(other.too_many_properties_) {
   other.handle_ = nullptr;
   other.property_count_ = 0;
 }
@@ -481,10 +746,12 @@ inline LedgerEditor& LedgerEditor::operator=(LedgerEditor&& other) noexcept {
     handle_ = other.handle_;
     buffer_ = other.buffer_;
     property_count_ = other.property_count_;
+    properties_ = other.properties_;
     string_buffer_used_ = other.string_buffer_used_;
-    for (size_t i = 0; i < property_count_; ++i) {
-      properties_[i] = other.properties_[i];
-    }
+    index_ = other.index_;
+    existing_size_ = other.existing_size_;
+    layout_changed_ = other.layout_changed_;
+    too_many_properties_ = other.too_many_properties_;
     other.handle_ = nullptr;
     other.property_count_ = 0;
   }
@@ -492,12 +759,79 @@ inline LedgerEditor& LedgerEditor::operator=(LedgerEditor&& other) noexcept {
 }
 
 inline PropertyEntry* LedgerEditor::Find(std::string_view key) {
+  if (index_.empty()) {
+    for (size_t i = 0; i < property_count_; ++i) {
+      if (!properties_[i].removed && properties_[i].key == key) {
+        return &properties_[i];
+      }
+    }
+    return nullptr;
+  }
+
+  // At most half the slots are used, so the probe reaches an empty one
+  const size_t mask = index_slot_count() - 1;
+  for (size_t slot = internal::HashKey(key) & mask;;
+       slot = (slot + 1) & mask) {
+    const uint16_t value = index_slot(slot);
+    if (value == 0) {
+      return nullptr;
+    }
+    PropertyEntry& entry = properties_[value - 1];
+    // Removed or reused entries leave stale slots; the key check skips them
+    if (!entry.removed && entry.key == key) {
+      return &entry;
+    }
+  }
+}
+
+inline void LedgerEditor::AllocateIndex() {
+  if (properties_.size() <= kLedgerEditorLinearScanLimit ||
+      properties_.size() >= UINT16_MAX || too_many_properties_) {
+    return;
+  }
+  size_t slots = 1;
+  while (slots < properties_.size() * 2) {
+    slots <<= 1;
+  }
+  auto alloc = AllocateBuffer(slots * 2);
+  if (!alloc.ok()) {
+    return;  // Linear scan
+  }
+  index_ = pw::ByteSpan(alloc.value(), slots * 2);
+  RebuildIndex();
+}
+
+inline void LedgerEditor::RebuildIndex() {
+  std::fill(index_.begin(), index_.end(), std::byte{0});
   for (size_t i = 0; i < property_count_; ++i) {
-    if (!properties_[i].removed && properties_[i].key == key) {
-      return &properties_[i];
+    if (!properties_[i].removed) {
+      IndexInsert(i);
     }
   }
-  return nullptr;
+}
+
+inline void LedgerEditor::IndexInsert(size_t entry) {
+  if (index_.empty()) {
+    return;
+  }
+  const size_t mask = index_slot_count() - 1;
+  size_t slot = internal::HashKey(properties_[entry].key) & mask;
+  while (index_slot(slot) != 0) {
+    slot = (slot + 1) & mask;
+  }
+  set_index_slot(slot, static_cast<uint16_t>(entry + 1));
+}
+
+inline uint16_t LedgerEditor::index_slot(size_t slot) const {
+  // Byte-wise, as the string area gives no alignment
+  return static_cast<uint16_t>(
+      static_cast<uint16_t>(index_[slot * 2]) |
+      (static_cast<uint16_t>(index_[slot * 2 + 1]) << 8));
+}
+
+inline void LedgerEditor::set_index_slot(size_t slot, uint16_t value) {
+  index_[slot * 2] = static_cast<std::byte>(value & 0xff);
+  index_[slot * 2 + 1] = static_cast<std::byte>(value >> 8);
 }
 
 inline pw::Result<PropertyEntry*> LedgerEditor::FindOrCreate(
@@ -512,6 +846,7 @@ inline pw::Result<PropertyEntry*> LedgerEditor::FindOrCreate(
   for (size_t i = 0; i < property_count_; ++i) {
     if (properties_[i].removed) {
       properties_[i].removed = false;
+      layout_changed_ = true;
       // Need to allocate key storage
       auto key_alloc = AllocateBuffer(key.size());
       if (!key_alloc.ok()) {
@@ -521,12 +856,14 @@ inline pw::Result<PropertyEntry*> LedgerEditor::FindOrCreate(
       // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
       properties_[i].key = std::string_view(
           reinterpret_cast<const char*>(key_alloc.value()), key.size());
+      // Drops the stale slots of removed keys
+      RebuildIndex();
       return &properties_[i];
     }
   }
 
   // Create new entry
-  if (property_count_ >= kMaxLedgerProperties) {
+  if (property_count_ >= properties_.size()) {
     return pw::Status::ResourceExhausted();
   }
 
@@ -539,9 +876,11 @@ inline pw::Result<PropertyEntry*> LedgerEditor::FindOrCreate(
 
   PropertyEntry& entry = properties_[property_count_++];
   entry = PropertyEntry{};
+  layout_changed_ = true;
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
   entry.key = std::string_view(
       reinterpret_cast<const char*>(key_alloc.value()), key.size());
+  IndexInsert(property_count_ - 1);
   return &entry;
 }
 
@@ -562,9 +901,15 @@ inline pw::Status LedgerEditor::SetBool(std::string_view key, bool value) {
     return entry_result.status();
   }
   PropertyEntry* entry = entry_result.value();
+  const uint8_t simple = value ? 21 : 20;  // true=21, false=20
+  if (entry->type == cbor::MajorType::kSimpleFloat &&
+      entry->simple_value == simple) {
+    return pw::OkStatus();
+  }
   entry->type = cbor::MajorType::kSimpleFloat;
-  entry->simple_value = value ? 21 : 20;  // true=21, false=20
+  entry->simple_value = simple;
   entry->bool_value = value;
+  entry->dirty = true;
   return pw::OkStatus();
 }
 
@@ -575,12 +920,21 @@ inline pw::Status LedgerEditor::SetInt(std::string_view key, int64_t value) {
   }
   PropertyEntry* entry = entry_result.value();
   if (value >= 0) {
+    if (entry->type == cbor::MajorType::kUnsignedInt &&
+        entry->uint_value == static_cast<uint64_t>(value)) {
+      return pw::OkStatus();
+    }
     entry->type = cbor::MajorType::kUnsignedInt;
     entry->uint_value = static_cast<uint64_t>(value);
   } else {
+    if (entry->type == cbor::MajorType::kNegativeInt &&
+        entry->int_value == value) {
+      return pw::OkStatus();
+    }
     entry->type = cbor::MajorType::kNegativeInt;
     entry->int_value = value;
   }
+  entry->dirty = true;
   return pw::OkStatus();
 }
 
@@ -590,8 +944,13 @@ inline pw::Status LedgerEditor::SetUint(std::string_view key, uint64_t value) {
     return entry_result.status();
   }
   PropertyEntry* entry = entry_result.value();
+  if (entry->type == cbor::MajorType::kUnsignedInt &&
+      entry->uint_value == value) {
+    return pw::OkStatus();
+  }
   entry->type = cbor::MajorType::kUnsignedInt;
   entry->uint_value = value;
+  entry->dirty = true;
   return pw::OkStatus();
 }
 
@@ -601,9 +960,14 @@ inline pw::Status LedgerEditor::SetDouble(std::string_view key, double value) {
     return entry_result.status();
   }
   PropertyEntry* entry = entry_result.value();
+  if (entry->type == cbor::MajorType::kSimpleFloat &&
+      entry->simple_value == 27 && entry->double_value == value) {
+    return pw::OkStatus();
+  }
   entry->type = cbor::MajorType::kSimpleFloat;
   entry->simple_value = 27;  // double
   entry->double_value = value;
+  entry->dirty = true;
   return pw::OkStatus();
 }
 
@@ -613,6 +977,12 @@ inline pw::Status LedgerEditor::SetString(std::string_view key,
   if (!entry_result.ok()) {
     return entry_result.status();
   }
+  PropertyEntry* entry = entry_result.value();
+  if (entry->type == cbor::MajorType::kTextString &&
+      entry->span_value.size == value.size() &&
+      std::memcmp(entry->span_value.data, value.data(), value.size()) == 0) {
+    return pw::OkStatus();
+  }
 
   // Allocate space for the string value
   auto value_alloc = AllocateBuffer(value.size());
@@ -621,10 +991,10 @@ inline pw::Status LedgerEditor::SetString(std::string_view key,
   }
   std::memcpy(value_alloc.value(), value.data(), value.size());
 
-  PropertyEntry* entry = entry_result.value();
   entry->type = cbor::MajorType::kTextString;
   entry->span_value.data = value_alloc.value();
   entry->span_value.size = value.size();
+  entry->dirty = true;
   return pw::OkStatus();
 }
 
@@ -634,6 +1004,12 @@ inline pw::Status LedgerEditor::SetBytes(std::string_view key,
   if (!entry_result.ok()) {
     return entry_result.status();
   }
+  PropertyEntry* entry = entry_result.value();
+  if (entry->type == cbor::MajorType::kByteString &&
+      entry->span_value.size == value.size() &&
+      std::memcmp(entry->span_value.data, value.data(), value.size()) == 0) {
+    return pw::OkStatus();
+  }
 
   // Allocate space for the bytes
   auto value_alloc = AllocateBuffer(value.size());
@@ -642,10 +1018,10 @@ inline pw::Status LedgerEditor::SetBytes(std::string_view key,
   }
   std::memcpy(value_alloc.value(), value.data(), value.size());
 
-  PropertyEntry* entry = entry_result.value();
   entry->type = cbor::MajorType::kByteString;
   entry->span_value.data = value_alloc.value();
   entry->span_value.size = value.size();
+  entry->dirty = true;
   return pw::OkStatus();
 }
 
@@ -653,6 +1029,7 @@ inline pw::Status LedgerEditor::Remove(std::string_view key) {
   PropertyEntry* entry = Find(key);
   if (entry) {
     entry->removed = true;
+    layout_changed_ = true;
   }
   return pw::OkStatus();
 }
@@ -667,11 +1044,102 @@ inline size_t LedgerEditor::property_count() const {
   return count;
 }
 
+inline size_t LedgerEditor::EncodedValueSize(const PropertyEntry& entry) {
+  switch (entry.type) {
+    case cbor::MajorType::kUnsignedInt:
+      return cbor::Encoder::HeaderSize(entry.uint_value);
+    case cbor::MajorType::kNegativeInt:
+      return cbor::Encoder::HeaderSize(
+          static_cast<uint64_t>(-1 - entry.int_value));
+    case cbor::MajorType::kByteString:
+    case cbor::MajorType::kTextString:
+      return cbor::Encoder::HeaderSize(entry.span_value.size) +
+             entry.span_value.size;
+    case cbor::MajorType::kSimpleFloat:
+      return entry.simple_value == 27 ? 9 : 1;
+    default:
+      return 0;
+  }
+}
+
+inline pw::Status LedgerEditor::EncodeValue(cbor::Encoder& encoder,
+                                            const PropertyEntry& entry) {
+  switch (entry.type) {
+    case cbor::MajorType::kUnsignedInt:
+      return encoder.WriteUint(entry.uint_value);
+    case cbor::MajorType::kNegativeInt:
+      return encoder.WriteInt(entry.int_value);
+    case cbor::MajorType::kByteString:
+      return encoder.WriteBytes(
+          pw::ConstByteSpan(entry.span_value.data, entry.span_value.size));
+    case cbor::MajorType::kTextString:
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      return encoder.WriteString(std::string_view(
+          reinterpret_cast<const char*>(entry.span_value.data),
+          entry.span_value.size));
+    case cbor::MajorType::kSimpleFloat:
+      if (entry.simple_value == 20 || entry.simple_value == 21) {
+        return encoder.WriteBool(entry.bool_value);
+      }
+      if (entry.simple_value == 22) {
+        return encoder.WriteNull();
+      }
+      if (entry.simple_value == 27) {
+        return encoder.WriteDouble(entry.double_value);
+      }
+      return pw::Status::InvalidArgument();
+    default:
+      return pw::Status::InvalidArgument();
+  }
+}
+
+inline bool LedgerEditor::CanCommitInPlace() const {
+  if (layout_changed_ ||
+      string_buffer_used_ > buffer_.size() - existing_size_) {
+    // New keys to insert, or the loaded data was overwritten by values
+    return false;
+  }
+  for (size_t i = 0; i < property_count_; ++i) {
+    const PropertyEntry& entry = properties_[i];
+    if (entry.dirty && EncodedValueSize(entry) != entry.value_size) {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline pw::Status LedgerEditor::CommitInPlace() {
+  for (size_t i = 0; i < property_count_; ++i) {
+    const PropertyEntry& entry = properties_[i];
+    if (entry.dirty) {
+      cbor::Encoder encoder(
+          buffer_.subspan(entry.value_offset, entry.value_size));
+      PW_TRY(EncodeValue(encoder, entry));
+    }
+  }
+  PW_TRY(handle_->Write(pw::ConstByteSpan(buffer_.data(), existing_size_)));
+  for (size_t i = 0; i < property_count_; ++i) {
+    properties_[i].dirty = false;
+  }
+  return pw::OkStatus();
+}
+
 inline pw::Status LedgerEditor::Commit() {
   if (!handle_ || !handle_->is_valid()) {
     return pw::Status::FailedPrecondition();
   }
 
+  bool changed = layout_changed_;
+  for (size_t i = 0; i < property_count_ && !changed; ++i) {
+    changed = properties_[i].dirty;
+  }
+  if (!changed) {
+    return pw::OkStatus();  // Nothing to write
+  }
+  if (CanCommitInPlace()) {
+    return CommitInPlace();
+  }
+
   // Count non-removed properties
   size_t active_count = property_count();
 
@@ -720,7 +1188,9 @@ inline pw::Status LedgerEditor::Commit() {
     }
   }
 
-  // Write the encoded data to the ledger
+  // Write the encoded data to the ledger. The loaded data is gone, so
+  // any further commit re-encodes too.
+  layout_changed_ = true;
   return handle_->Write(pw::ConstByteSpan(buffer_.data(), encoder.size()));
 }
 
@@ -0,0 +1,227 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file ledger_cache.h
+/// @brief Parsed snapshot of a ledger for repeated property reads.
+///
+/// Without a cache, every LedgerHandle getter reads the whole ledger from
+/// flash and decodes the CBOR map up to the requested key. A LedgerCache
+/// holds one read of the ledger in a caller-provided buffer together with a
+/// key to value-offset index, so getters on a handle using the cache are
+/// memory lookups.
+///
+/// The snapshot is reloaded on the next getter call after the ledger
+/// changes: a local write through any handle, or a cloud sync reported to a
+/// SubscribeToSync() subscription.
+///
+/// Each reload is diffed against the previous snapshot by key and value
+/// hash, so a sync handler can reprocess only what changed:
+/// @code
+/// if (receiver.TryReceive().ok() && ledger.RefreshCache().ok()) {
+///   std::array<std::string_view, pb::cloud::kMaxLedgerProperties> keys;
+///   for (size_t i = 0; i < cache.ChangedKeys(keys); ++i) { ... }
+/// }
+/// @endcode
+///
+/// Usage:
+/// @code
+/// std::array<std::byte, 1024> cache_buffer;
+/// pb::cloud::LedgerCache cache(cache_buffer);
+/// ledger.SetCache(&cache);
+///
+/// // One flash read for all of these
+/// bool enabled = ledger.GetBool("enabled", false);
+/// int count = ledger.GetInt("retry_count", 0);
+/// @endcode
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "pb_cloud/cbor.h"
+#include "pb_cloud/ledger_editor.h"
+#include "pw_bytes/span.h"
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+#include "pw_status/try.h"
+
+namespace pb::cloud {
+
+/// Snapshot of one ledger's CBOR data with a property index.
+///
+/// A cache is attached to one LedgerHandle at a time and must outlive it.
+/// Ledgers with more than kMaxLedgerProperties properties, or that fill the
+/// whole buffer, are not cached; the handle then falls back to read-through.
+class LedgerCache {
+ public:
+  /// @param buffer Storage for the ledger data; must outlive the cache
+  explicit LedgerCache(pw::ByteSpan buffer) : buffer_(buffer) {}
+
+  LedgerCache(const LedgerCache&) = delete;
+  LedgerCache& operator=(const LedgerCache&) = delete;
+
+  /// True if the cache holds a snapshot (which may since have gone stale).
+  bool loaded() const { return loaded_; }
+
+  /// Number of indexed properties in the snapshot.
+  size_t property_count() const { return loaded_ ? property_count_ : 0; }
+
+  /// Drop the snapshot; the next getter reloads it.
+  ///
+  /// The hashes of the dropped snapshot are kept, so the reload still
+  /// reports only the properties that differ.
+  void Invalidate() { loaded_ = false; }
+
+  /// Number of properties added or changed by the last reload. On the first
+  /// load every property counts as added.
+  size_t changed_count() const {
+    size_t count = 0;
+    for (size_t i = 0; i < property_count(); ++i) {
+      count += index_[i].changed ? 1 : 0;
+    }
+    return count;
+  }
+
+  /// Number of properties removed by the last reload.
+  size_t removed_count() const { return loaded_ ? removed_count_ : 0; }
+
+  /// Whether `key` was added or changed by the last reload.
+  bool Changed(std::string_view key) const {
+    for (size_t i = 0; i < property_count(); ++i) {
+      if (index_[i].key == key) {
+        return index_[i].changed;
+      }
+    }
+    return false;
+  }
+
+  /// Copy the keys added or changed by the last reload into `keys`.
+  ///
+  /// The keys point into the snapshot and are valid until the next reload.
+  ///
+  /// @return Number of keys written (at most keys.size())
+  size_t ChangedKeys(pw::span<std::string_view> keys) const {
+    size_t count = 0;
+    for (size_t i = 0; i < property_count() && count < keys.size(); ++i) {
+      if (index_[i].changed) {
+        keys[count++] = index_[i].key;
+      }
+    }
+    return count;
+  }
+
+ private:
+  friend class LedgerHandle;
+
+  struct IndexEntry {
+    std::string_view key;  // Points into buffer_
+    size_t value_offset = 0;
+    uint32_t key_hash = 0;
+    uint32_t value_hash = 0;  // Of the encoded value
+    bool changed = false;     // Than in the previous snapshot
+  };
+
+  struct PropertyHash {
+    uint32_t key_hash = 0;
+    uint32_t value_hash = 0;
+  };
+
+  /// Index `data_size` bytes of CBOR at the start of buffer_.
+  pw::Status Load(size_t data_size, uint32_t revision) {
+    // Keep the previous snapshot's hashes for the diff
+    std::array<PropertyHash, kMaxLedgerProperties> previous{};
+    const size_t previous_count = hashed_ ? hashed_count_ : 0;
+    for (size_t i = 0; i < previous_count; ++i) {
+      previous[i] = {index_[i].key_hash, index_[i].value_hash};
+    }
+    const bool had_snapshot = hashed_;
+
+    loaded_ = false;
+    hashed_ = false;
+    property_count_ = 0;
+    removed_count_ = 0;
+    data_size_ = data_size;
+    if (data_size > 0) {
+      const pw::ConstByteSpan data(buffer_.data(), data_size);
+      cbor::Decoder decoder(data);
+      // One well-formedness pass; indexing and every later Find() decode
+      // without per-read checks
+      PW_TRY(decoder.Validate());
+      root_ = decoder;
+      auto count = decoder.ReadMapHeader();
+      if (!count.ok()) {
+        return count.status();
+      }
+      if (count.value() > index_.size()) {
+        return pw::Status::ResourceExhausted();
+      }
+      for (size_t i = 0; i < count.value(); ++i) {
+        auto key = decoder.ReadKeyView();
+        if (!key.ok()) {
+          return key.status();
+        }
+        // The key views the cache buffer, which outlives the index
+        index_[i].key = key.value();
+        const size_t value_offset = decoder.position();
+        index_[i].value_offset = value_offset;
+        if (!decoder.SkipValue().ok()) {
+          return pw::Status::DataLoss();
+        }
+        index_[i].key_hash = internal::HashKey(index_[i].key);
+        index_[i].value_hash = internal::Fnv1a(
+            data.subspan(value_offset, decoder.position() - value_offset));
+      }
+      property_count_ = count.value();
+    }
+
+    // Diff against the previous snapshot (hash equality means unchanged)
+    std::array<bool, kMaxLedgerProperties> kept{};
+    for (size_t i = 0; i < property_count_; ++i) {
+      IndexEntry& entry = index_[i];
+      entry.changed = true;
+      for (size_t j = 0; had_snapshot && j < previous_count; ++j) {
+        if (previous[j].key_hash == entry.key_hash) {
+          kept[j] = true;
+          entry.changed = previous[j].value_hash != entry.value_hash;
+          break;
+        }
+      }
+    }
+    for (size_t j = 0; j < previous_count; ++j) {
+      removed_count_ += kept[j] ? 0 : 1;
+    }
+
+    hashed_count_ = property_count_;
+    hashed_ = true;
+    revision_ = revision;
+    loaded_ = true;
+    return pw::OkStatus();
+  }
+
+  /// Position `decoder` at the value of `key`.
+  bool Find(std::string_view key, cbor::Decoder& decoder) const {
+    for (size_t i = 0; i < property_count_; ++i) {
+      if (index_[i].key == key) {
+        decoder = root_.At(index_[i].value_offset);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  pw::ByteSpan buffer_;
+  size_t data_size_ = 0;
+  cbor::Decoder root_{pw::ConstByteSpan()};  // Validated decoder over data
+  std::array<IndexEntry, kMaxLedgerProperties> index_{};
+  size_t property_count_ = 0;
+  size_t removed_count_ = 0;
+  size_t hashed_count_ = 0;  // Entries with hashes from the last load
+  uint32_t revision_ = 0;
+  bool loaded_ = false;
+  bool hashed_ = false;  // index_ hashes describe the last good snapshot
+};
+
+}  // namespace pb::cloud
@@ -25,17 +25,21 @@
 ///
 /// ## Stack Usage (Embedded Targets)
 ///
-/// LedgerEditor contains a fixed-size properties array that uses approximately
-/// 800 bytes on the stack (16 properties × ~48 bytes each). Combined with the
-/// caller-provided buffer, total stack usage is:
+/// The editor returned by LedgerHandle::Edit() contains a fixed-size
+/// properties array that uses approximately 800 bytes on the stack
+/// (16 properties × ~48 bytes each). Combined with the caller-provided
+/// buffer, total stack usage is:
 ///
 ///   ~800 bytes (properties array) + buffer size
 ///
 /// For memory-constrained embedded devices:
 /// - Use smaller buffers (256-512 bytes) for simple ledgers
 /// - Avoid deeply nested function calls when editing
-/// - `kMaxLedgerProperties` limits entries to 16 properties
+/// - `kMaxLedgerProperties` is the default limit of 16 properties; use
+///   `Edit<N>()` for a larger inline table, or pass a `PropertyEntry` span
+///   to `Edit()` to keep the table off the stack
 
+#include <array>
 #include <cstring>
 #include <string_view>
 #include <utility>
@@ -44,6 +48,7 @@
 #include "pb_cloud/ledger_types.h"
 #include "pw_bytes/span.h"
 #include "pw_result/result.h"
+#include "pw_span/span.h"
 #include "pw_status/status.h"
 
 namespace pb::cloud {
@@ -51,10 +56,22 @@ namespace pb::cloud {
 // Forward declaration
 class LedgerHandle;
 
-/// Maximum number of properties in a ledger (practical limit).
+/// Default maximum number of properties in a ledger editor.
 /// Keep this small to avoid stack overflow on embedded devices.
 inline constexpr size_t kMaxLedgerProperties = 16;
 
+/// Property tables larger than this get a hashed key index in the editor's
+/// buffer; smaller ones are scanned linearly.
+inline constexpr size_t kLedgerEditorLinearScanLimit = 16;
+
+namespace internal {
+
+// Property key and value indexes share the CBOR map index hash
+using cbor::Fnv1a;
+using cbor::HashKey;
+
+}  // namespace internal
+
 /// Internal representation of a property during editing.
 struct PropertyEntry {
   std::string_view key;
@@ -76,12 +93,28 @@ struct PropertyEntry {
   uint8_t simple_value = 0;
 
   bool removed = false;  // Marked for deletion
+
+  // Encoded value in the data the editor loaded (size 0 for new entries)
+  size_t value_offset = 0;
+  size_t value_size = 0;
+
+  bool dirty = false;  // Value changed since loading
 };
 
 /// Scoped editor for ledger properties.
 ///
 /// Maintains an in-memory representation of the ledger's CBOR map and
 /// writes it back on Commit(). Properties are stored in insertion order.
+///
+/// Setting a property to its current value is not a change. Commit() skips
+/// the write when nothing changed, and patches the loaded data in place
+/// when only values changed and each keeps its encoded size (e.g. a counter
+/// staying below the next CBOR size step). Otherwise it re-encodes the map.
+///
+/// With more than kLedgerEditorLinearScanLimit table entries, keys are
+/// looked up through an open-addressing hash index of 2 bytes per slot
+/// (two slots per entry) taken from the string area of the buffer. If the
+/// buffer has no room for it, lookups fall back to a linear scan.
 class LedgerEditor {
  public:
   /// Move constructor.
@@ -153,7 +186,9 @@ class LedgerEditor {
 
   /// Write the modified properties back to the ledger.
   ///
-  /// Encodes all properties as CBOR and writes to the underlying ledger.
+  /// Encodes all properties as CBOR and writes to the underlying ledger,
+  /// or patches changed values in place (see class comment). Returns
+  /// OkStatus without writing if nothing changed.
   /// After Commit(), this editor should not be reused.
   ///
   /// @return OkStatus on success, or error from encoding/writing
@@ -164,10 +199,12 @@ class LedgerEditor {
 
  private:
   friend class LedgerHandle;
+  template <size_t>
+  friend class InlineLedgerEditor;
 
   /// Private constructor - only LedgerHandle::Edit can create editors.
   LedgerEditor(LedgerHandle* handle, pw::ByteSpan buffer,
-               size_t existing_data_size);
+               size_t existing_data_size, pw::span<PropertyEntry> properties);
 
   /// Find or create a property entry for the given key.
   pw::Result<PropertyEntry*> FindOrCreate(std::string_view key);
@@ -178,15 +215,88 @@ class LedgerEditor {
   /// Allocate space in the string/bytes buffer.
   pw::Result<std::byte*> AllocateBuffer(size_t size);
 
+  /// Allocate the key index if the table is large enough to need one.
+  void AllocateIndex();
+
+  /// Re-insert every live entry into the key index.
+  void RebuildIndex();
+
+  /// Add properties_[entry] to the key index.
+  void IndexInsert(size_t entry);
+
+  size_t index_slot_count() const { return index_.size() / 2; }
+  uint16_t index_slot(size_t slot) const;
+  void set_index_slot(size_t slot, uint16_t value);
+
+  /// Whether every changed value can be patched into the loaded data.
+  bool CanCommitInPlace() const;
+
+  /// Patch changed values into the loaded data and write it back.
+  pw::Status CommitInPlace();
+
+  /// Size of an entry's value in CBOR.
+  static size_t EncodedValueSize(const PropertyEntry& entry);
+
+  /// Encode an entry's value without its key.
+  static pw::Status EncodeValue(cbor::Encoder& encoder,
+                                const PropertyEntry& entry);
+
   LedgerHandle* handle_ = nullptr;
   pw::ByteSpan buffer_;
 
-  // Properties array (fixed-size, no heap allocation)
-  PropertyEntry properties_[kMaxLedgerProperties];
+  // Properties table (owned by InlineLedgerEditor or the caller)
+  pw::span<PropertyEntry> properties_;
   size_t property_count_ = 0;
 
   // Buffer for string/bytes data (uses end of the provided buffer)
   size_t string_buffer_used_ = 0;  // Grows from end of buffer backwards
+
+  // Key index slots (entry + 1, 0 = empty) in the string area, or empty
+  pw::ByteSpan index_;
+
+  size_t existing_size_ = 0;     // Loaded data at the start of buffer_
+  bool layout_changed_ = false;  // Properties added or removed
+  bool too_many_properties_ = false;  // Loaded map exceeds properties_
+};
+
+namespace internal {
+
+/// Storage base so the table is constructed before the LedgerEditor base.
+template <size_t kSize>
+struct PropertyTable {
+  std::array<PropertyEntry, kSize> entries{};
+};
+
+}  // namespace internal
+
+/// LedgerEditor with an inline table of up to kMaxProperties properties.
+///
+/// Returned by LedgerHandle::Edit<kMaxProperties>().
+template <size_t kMaxProperties>
+class InlineLedgerEditor : private internal::PropertyTable<kMaxProperties>,
+                           public LedgerEditor {
+ public:
+  InlineLedgerEditor(InlineLedgerEditor&& other) noexcept
+      : internal::PropertyTable<kMaxProperties>(other),
+        LedgerEditor(std::move(other)) {
+    properties_ = this->entries;
+  }
+
+  InlineLedgerEditor& operator=(InlineLedgerEditor&& other) noexcept {
+    if (this != &other) {
+      this->entries = other.entries;
+      LedgerEditor::operator=(std::move(other));
+      properties_ = this->entries;
+    }
+    return *this;
+  }
+
+ private:
+  friend class LedgerHandle;
+
+  InlineLedgerEditor(LedgerHandle* handle, pw::ByteSpan buffer,
+                     size_t existing_data_size)
+      : LedgerEditor(handle, buffer, existing_data_size, this->entries) {}
 };
 
 }  // namespace pb::cloud
@@ -45,15 +45,26 @@
 /// // Access properties through editor...
 /// @endcode
 ///
-/// LedgerEditor itself uses ~800 bytes for the properties array (16 entries).
-/// Combined with the Edit() buffer, plan for ~1-5KB stack usage depending
-/// on buffer size chosen.
+/// Or stream the data in small chunks with OpenReader() and
+/// cbor::StreamDecoder (see ledger_stream.h).
+///
+/// The editor returned by Edit() holds its properties table, ~800 bytes for
+/// the default 16 entries. Combined with the Edit() buffer, plan for ~1-5KB
+/// stack usage depending on buffer size chosen. Edit<N>() or a
+/// caller-provided table changes the table size.
+///
+/// ## Cached Reads
+///
+/// To read several properties without a flash read per getter, attach a
+/// LedgerCache with SetCache() (see ledger_cache.h).
 
 #include <array>
 #include <cstring>
 #include <string_view>
 
 #include "pb_cloud/cbor.h"
+#include "pb_cloud/ledger_cache.h"
+#include "pb_cloud/ledger_stream.h"
 #include "pb_cloud/ledger_types.h"
 #include "pw_bytes/span.h"
 #include "pw_result/result.h"
@@ -64,6 +75,8 @@ namespace pb::cloud {
 // Forward declarations
 class LedgerBackend;
 class LedgerEditor;
+template <size_t kMaxProperties>
+class InlineLedgerEditor;
 
 namespace internal {
 /// Opaque handle type for type safety (actual type defined by backend).
@@ -75,7 +88,8 @@ struct LedgerInstance;
 /// Manages the reference count of the underlying ledger. Non-copyable but
 /// movable. Operations delegate to the backend for implementation.
 ///
-/// Property getters parse CBOR from storage on each call (read-through).
+/// Property getters parse CBOR from storage on each call (read-through),
+/// unless a LedgerCache is attached with SetCache().
 /// Use LedgerEditor for modifications (read-modify-write pattern).
 class LedgerHandle {
  public:
@@ -121,11 +135,49 @@ class LedgerHandle {
   ///
   /// Performs open-write-close internally. Data must be <= 16KB.
   ///
+  /// Returns OkStatus without writing when `data` matches the content this
+  /// backend last wrote to the ledger and the ledger has not changed since
+  /// (see LedgerBackend::skipped_write_count()), so periodic snapshots of
+  /// unchanged state cost no flash write and no cloud sync.
+  ///
   /// @param data Data to write
   /// @return OkStatus on success, or error status
   pw::Status Write(pw::ConstByteSpan data);
 
-  // -- CBOR Property Getters (read-through) --
+  /// Open the ledger data for chunked reading.
+  ///
+  /// @return LedgerReader on success, or error status
+  pw::Result<LedgerReader> OpenReader();
+
+  /// Open the ledger for chunked replacement of its data.
+  ///
+  /// The ledger keeps its old content until LedgerWriter::Commit().
+  ///
+  /// @return LedgerWriter on success, or error status
+  pw::Result<LedgerWriter> OpenWriter();
+
+  // -- CBOR Property Getters (read-through or cached) --
+
+  /// Serve property getters from a parsed snapshot held in `cache`.
+  ///
+  /// The snapshot is loaded by the first getter and reloaded after the
+  /// ledger is written or a sync is reported to SubscribeToSync(). The cache
+  /// moves with the handle and must outlive it.
+  ///
+  /// @param cache Cache to use, or nullptr to read through again
+  void SetCache(LedgerCache* cache) {
+    cache_ = cache;
+    if (cache_ != nullptr) {
+      cache_->Invalidate();
+    }
+  }
+
+  /// Reload the attached cache now if the ledger changed since it was
+  /// loaded, e.g. after a SyncEvent, so its changed keys can be inspected.
+  ///
+  /// @return OkStatus if the cache is current, FailedPrecondition if no
+  ///         cache is attached, or the read/parse error
+  pw::Status RefreshCache();
 
   /// Check if a property exists in the ledger.
   ///
@@ -199,9 +251,28 @@ class LedgerHandle {
   /// LedgerEditor for making modifications. Call Commit() on the editor
   /// to write changes back to the ledger.
   ///
+  /// The editor holds a table for up to kMaxProperties properties; use
+  /// e.g. Edit<64>(buffer) for larger ledgers.
+  ///
   /// @param buffer Working buffer for read-modify-write operations
   /// @return LedgerEditor on success, or error if buffer too small for data
-  pw::Result<LedgerEditor> Edit(pw::ByteSpan buffer);
+  ///         (ResourceExhausted if the ledger has more than kMaxProperties
+  ///         properties)
+  template <size_t kMaxProperties = kMaxLedgerProperties>
+  pw::Result<InlineLedgerEditor<kMaxProperties>> Edit(pw::ByteSpan buffer);
+
+  /// Start editing with a caller-provided property table.
+  ///
+  /// Like Edit(buffer), but the editor keeps its properties in
+  /// `properties`, which must outlive it, so the table can be sized (and
+  /// placed) by the caller.
+  ///
+  /// @param buffer Working buffer for read-modify-write operations
+  /// @param properties Property table; its size is the property limit
+  /// @return LedgerEditor on success, or error (ResourceExhausted if the
+  ///         ledger has more properties than the table holds)
+  pw::Result<LedgerEditor> Edit(pw::ByteSpan buffer,
+                                pw::span<PropertyEntry> properties);
 
  private:
   friend class LedgerBackend;
@@ -220,8 +291,12 @@ class LedgerHandle {
   bool FindKey(std::string_view target_key, cbor::Decoder& decoder,
                pw::ByteSpan read_buffer);
 
+  /// Read the current data into an editor's working buffer.
+  pw::Result<size_t> ReadForEdit(pw::ByteSpan buffer);
+
   internal::LedgerInstance* instance_ = nullptr;
   LedgerBackend* backend_ = nullptr;
+  LedgerCache* cache_ = nullptr;
 };
 
 }  // namespace pb::cloud
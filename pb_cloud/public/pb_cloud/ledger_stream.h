@@ -0,0 +1,173 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file ledger_stream.h
+/// @brief Chunked pw::stream access to ledger data.
+///
+/// LedgerHandle::Read() and Write() need one buffer for the whole ledger,
+/// which for the 16 KB Particle maximum is more than a thread stack. A
+/// LedgerReader or LedgerWriter keeps the underlying ledger stream open and
+/// moves the data in chunks of the caller's choosing.
+///
+/// Usage:
+/// @code
+/// auto reader = ledger.OpenReader();
+/// if (reader.ok()) {
+///   std::array<std::byte, 256> window;
+///   cbor::StreamDecoder decoder(reader.value(), window);
+///   // ReadMapHeader(), ReadKey(), ... as with cbor::Decoder
+/// }
+///
+/// auto writer = ledger.OpenWriter();
+/// if (writer.ok()) {
+///   writer.value().Write(chunk1);
+///   writer.value().Write(chunk2);
+///   writer.value().Commit();  // Without Commit() the write is discarded
+/// }
+/// @endcode
+
+#include <cstddef>
+
+#include "pb_cloud/ledger_types.h"
+#include "pw_bytes/span.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_stream/stream.h"
+
+namespace pb::cloud {
+
+class LedgerBackend;
+class LedgerHandle;
+
+namespace internal {
+/// Opaque open-stream type for type safety (actual type defined by backend).
+struct LedgerStream;
+}  // namespace internal
+
+/// Direction of an open ledger stream.
+enum class LedgerStreamMode : uint8_t {
+  kRead,
+  kWrite,
+};
+
+/// Reads a ledger's data in chunks.
+///
+/// Returned by LedgerHandle::OpenReader(). Read() returns OutOfRange once
+/// all data_size bytes have been read. The stream is closed when the reader
+/// is destroyed. Only one stream per ledger should be open at a time.
+class LedgerReader final : public pw::stream::NonSeekableReader {
+ public:
+  LedgerReader() = default;
+  ~LedgerReader() override { Close(); }
+
+  LedgerReader(const LedgerReader&) = delete;
+  LedgerReader& operator=(const LedgerReader&) = delete;
+
+  LedgerReader(LedgerReader&& other) noexcept
+      : backend_(other.backend_),
+        stream_(other.stream_),
+        remaining_(other.remaining_) {
+    other.backend_ = nullptr;
+    other.stream_ = nullptr;
+    other.remaining_ = 0;
+  }
+
+  LedgerReader& operator=(LedgerReader&& other) noexcept {
+    if (this != &other) {
+      Close();
+      backend_ = other.backend_;
+      stream_ = other.stream_;
+      remaining_ = other.remaining_;
+      other.backend_ = nullptr;
+      other.stream_ = nullptr;
+      other.remaining_ = 0;
+    }
+    return *this;
+  }
+
+  bool is_open() const { return stream_ != nullptr; }
+
+  /// Bytes of ledger data not yet read.
+  size_t remaining() const { return remaining_; }
+
+  /// Close the stream early.
+  void Close();
+
+ private:
+  friend class LedgerHandle;
+
+  LedgerReader(LedgerBackend* backend,
+               internal::LedgerStream* stream,
+               size_t size)
+      : backend_(backend), stream_(stream), remaining_(size) {}
+
+  pw::StatusWithSize DoRead(pw::ByteSpan dest) override;
+
+  LedgerBackend* backend_ = nullptr;
+  internal::LedgerStream* stream_ = nullptr;
+  size_t remaining_ = 0;
+};
+
+/// Replaces a ledger's data with chunks written in order.
+///
+/// Returned by LedgerHandle::OpenWriter(). The new data takes effect on
+/// Commit(); a writer destroyed without Commit() discards it. Writes past
+/// kMaxLedgerDataSize fail with ResourceExhausted.
+class LedgerWriter final : public pw::stream::NonSeekableWriter {
+ public:
+  LedgerWriter() = default;
+  ~LedgerWriter() override { Close(false); }
+
+  LedgerWriter(const LedgerWriter&) = delete;
+  LedgerWriter& operator=(const LedgerWriter&) = delete;
+
+  LedgerWriter(LedgerWriter&& other) noexcept
+      : backend_(other.backend_),
+        stream_(other.stream_),
+        bytes_written_(other.bytes_written_) {
+    other.backend_ = nullptr;
+    other.stream_ = nullptr;
+    other.bytes_written_ = 0;
+  }
+
+  LedgerWriter& operator=(LedgerWriter&& other) noexcept {
+    if (this != &other) {
+      Close(false);
+      backend_ = other.backend_;
+      stream_ = other.stream_;
+      bytes_written_ = other.bytes_written_;
+      other.backend_ = nullptr;
+      other.stream_ = nullptr;
+      other.bytes_written_ = 0;
+    }
+    return *this;
+  }
+
+  bool is_open() const { return stream_ != nullptr; }
+
+  /// Bytes written so far.
+  size_t bytes_written() const { return bytes_written_; }
+
+  /// Close the stream and make the written data the ledger's content.
+  ///
+  /// @return OkStatus, FailedPrecondition if not open, or the backend error
+  pw::Status Commit() { return Close(true); }
+
+ private:
+  friend class LedgerHandle;
+
+  LedgerWriter(LedgerBackend* backend, internal::LedgerStream* stream)
+      : backend_(backend), stream_(stream) {}
+
+  pw::Status DoWrite(pw::ConstByteSpan data) override;
+
+  pw::Status Close(bool commit);
+
+  LedgerBackend* backend_ = nullptr;
+  internal::LedgerStream* stream_ = nullptr;
+  size_t bytes_written_ = 0;
+};
+
+}  // namespace pb::cloud
@@ -92,36 +92,58 @@ pw::Status WriteLedger(LedgerBackend& backend,
 
 /// Read a protobuf message from a ledger.
 ///
-/// Convenience wrapper around ReadLedger using ProtoSerializer.
+/// Decodes straight from a LedgerReader, so no buffer for the ledger data
+/// is needed.
 ///
 /// @tparam Proto Proto type (e.g., Config from config.pwpb.h)
-/// @tparam kBufSize Read buffer size (default 1024 bytes)
 /// @param backend Ledger backend to use
 /// @param name Ledger name
 /// @return Decoded message, or error
-template <typename Proto, size_t kBufSize = 1024>
+template <typename Proto>
 pw::Result<typename Proto::Message> ReadLedgerProto(LedgerBackend& backend,
                                                     std::string_view name) {
-  return ReadLedger<typename Proto::Message, ProtoSerializer<Proto>, kBufSize>(
-      backend, name);
+  auto ledger_result = backend.GetLedger(name);
+  if (!ledger_result.ok()) {
+    return ledger_result.status();
+  }
+  auto reader = ledger_result.value().OpenReader();
+  if (!reader.ok()) {
+    return reader.status();
+  }
+  return ProtoSerializer<Proto>::DeserializeFrom(reader.value());
 }
 
 /// Write a protobuf message to a ledger.
 ///
-/// Convenience wrapper around WriteLedger using ProtoSerializer.
+/// Encodes straight into a LedgerWriter; the ledger only changes if the
+/// whole message was written.
 ///
 /// @tparam Proto Proto type (e.g., Config from config.pwpb.h)
-/// @tparam kBufSize Serialization buffer size (default 1024 bytes)
+/// @tparam kScratchSize Buffer for nested messages (default 0, enough for
+///         messages without nested messages)
 /// @param backend Ledger backend to use
 /// @param name Ledger name
 /// @param message Message to serialize and write
 /// @return OkStatus on success, or error
-template <typename Proto, size_t kBufSize = 1024>
+template <typename Proto, size_t kScratchSize = 0>
 pw::Status WriteLedgerProto(LedgerBackend& backend,
                             std::string_view name,
                             const typename Proto::Message& message) {
-  return WriteLedger<typename Proto::Message, ProtoSerializer<Proto>, kBufSize>(
-      backend, name, message);
+  auto ledger_result = backend.GetLedger(name);
+  if (!ledger_result.ok()) {
+    return ledger_result.status();
+  }
+  auto writer = ledger_result.value().OpenWriter();
+  if (!writer.ok()) {
+    return writer.status();
+  }
+  std::array<std::byte, kScratchSize> scratch;
+  pw::Status status =
+      ProtoSerializer<Proto>::SerializeTo(message, writer.value(), scratch);
+  if (!status.ok()) {
+    return status;  // The writer discards the partial data
+  }
+  return writer.value().Commit();
 }
 
 }  // namespace pb::cloud
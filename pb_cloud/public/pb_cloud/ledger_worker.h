@@ -0,0 +1,159 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file ledger_worker.h
+/// @brief Ledger I/O on a dedicated thread, completed through futures.
+///
+/// LedgerBackend::GetLedger() and LedgerHandle::Read()/Write() block the
+/// calling thread for the flash access, which can take tens of ms. A
+/// LedgerWorker runs queued operations on its own thread and resolves a
+/// future for each, so async tasks on the dispatcher keep running.
+///
+/// Usage:
+/// @code
+/// pb::cloud::LedgerWorker worker(backend);
+/// worker.Start(pw::thread::particle::Options()
+///                  .set_name("ledger")
+///                  .set_stack_size(pb::cloud::kLedgerWorkerStackSize));
+///
+/// // In a task
+/// write_ = worker.WriteAsync("device-state", data);
+/// ...
+/// auto poll = write_->Pend(cx);
+/// if (poll.IsPending()) return pw::async2::Pending();
+/// @endcode
+///
+/// The buffers (and editors) passed in must stay valid until the future
+/// resolves. While the worker runs, access the ledgers it operates on only
+/// through it.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "pb_cloud/config.h"
+#include "pb_cloud/ledger_backend.h"
+#include "pb_cloud/ledger_editor.h"
+#include "pb_cloud/ledger_types.h"
+#include "pw_async2/value_future.h"
+#include "pw_bytes/span.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+#include "pw_string/string.h"
+#include "pw_sync/mutex.h"
+#include "pw_sync/thread_notification.h"
+#include "pw_thread/options.h"
+#include "pw_thread/thread.h"
+
+namespace pb::cloud {
+
+/// Maximum number of queued LedgerWorker operations
+/// (PB_CLOUD_MAX_PENDING_LEDGER_OPS).
+inline constexpr size_t kMaxPendingLedgerOps = PB_CLOUD_MAX_PENDING_LEDGER_OPS;
+
+/// Suggested worker thread stack: the CBOR encode of a commit plus the
+/// Device OS ledger calls.
+inline constexpr size_t kLedgerWorkerStackSize = 2048;
+
+/// Future for ReadAsync(): the number of bytes read, or the error.
+using LedgerReadFuture = pw::async2::ValueFuture<pw::Result<size_t>>;
+
+/// Future for WriteAsync() and CommitAsync().
+using LedgerStatusFuture = pw::async2::ValueFuture<pw::Status>;
+
+/// Runs ledger operations in order on a dedicated thread.
+class LedgerWorker {
+ public:
+  explicit LedgerWorker(LedgerBackend& backend) : backend_(backend) {}
+
+  /// Stops the thread; queued operations resolve with Cancelled.
+  ~LedgerWorker();
+
+  LedgerWorker(const LedgerWorker&) = delete;
+  LedgerWorker& operator=(const LedgerWorker&) = delete;
+
+  /// Start the worker thread.
+  ///
+  /// @return OkStatus, or FailedPrecondition if already started
+  pw::Status Start(const pw::thread::Options& options);
+
+  /// Stop the worker thread after the operation in progress.
+  ///
+  /// Operations still queued resolve with Cancelled.
+  void Stop();
+
+  /// Read a ledger's data into `buffer`.
+  ///
+  /// @return Future resolving to the byte count (NotFound if empty), or
+  ///         immediately to ResourceExhausted if the queue is full
+  LedgerReadFuture ReadAsync(std::string_view name, pw::ByteSpan buffer);
+
+  /// Replace a ledger's data with `data`.
+  ///
+  /// @return Future resolving to the write status, or immediately to
+  ///         ResourceExhausted if the queue is full
+  LedgerStatusFuture WriteAsync(std::string_view name, pw::ConstByteSpan data);
+
+  /// Commit an editor's changes (see LedgerEditor::Commit()).
+  ///
+  /// Do not use the editor until the future resolves.
+  ///
+  /// @return Future resolving to the commit status, or immediately to
+  ///         ResourceExhausted if the queue is full
+  LedgerStatusFuture CommitAsync(LedgerEditor& editor);
+
+  /// Run the queued operations on the calling thread.
+  ///
+  /// Used by the worker thread; host tests call it instead of Start().
+  ///
+  /// @return Number of operations run
+  size_t RunPending();
+
+ private:
+  enum class Op : uint8_t {
+    kRead,
+    kWrite,
+    kCommit,
+  };
+
+  struct Request {
+    Op op = Op::kRead;
+    pw::InlineString<kMaxLedgerNameSize> name;
+    pw::ByteSpan buffer;
+    pw::ConstByteSpan data;
+    LedgerEditor* editor = nullptr;
+    pw::async2::ValueProvider<pw::Result<size_t>> read_provider;
+    pw::async2::ValueProvider<pw::Status> status_provider;
+  };
+
+  /// Reserve the next queue slot, or nullptr if full. Requires lock_.
+  Request* Enqueue();
+
+  /// Run one request and resolve its future.
+  void Execute(Request& request);
+
+  /// Resolve a request's future with `status` without running it.
+  static void Cancel(Request& request, pw::Status status);
+
+  /// Resolve all queued requests with Cancelled. Only without the thread.
+  void CancelQueued();
+
+  void Run();
+
+  LedgerBackend& backend_;
+
+  pw::sync::Mutex lock_;
+  std::array<Request, kMaxPendingLedgerOps> queue_{};
+  size_t head_ = 0;   // Protected by lock_
+  size_t count_ = 0;  // Protected by lock_
+  bool stop_ = false;  // Protected by lock_
+
+  pw::sync::ThreadNotification notification_;
+  pw::Thread thread_;
+  bool started_ = false;
+};
+
+}  // namespace pb::cloud
@@ -0,0 +1,204 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file ledger_write_back.h
+/// @brief Write-back cache that batches property updates into few commits.
+///
+/// Every LedgerEditor::Commit() rewrites the whole ledger in flash and
+/// queues a cloud sync. State that changes every second (counters, last
+/// seen values) should not be committed every second. LedgerWriteBack keeps
+/// the latest value of each property in RAM and commits them together:
+///
+/// - kImmediate properties are committed before Set*() returns, together
+///   with everything else pending.
+/// - kDebounced properties are committed `debounce` after their first
+///   unsaved update; more updates in between cost nothing.
+/// - kRelaxed properties are committed at most `max_delay` after their
+///   first unsaved update, or with the next commit for another reason.
+///
+/// A commit also happens once `max_dirty` properties are pending, when the
+/// table is full, and on Flush(), which belongs before sleep and reset.
+///
+/// Usage:
+/// @code
+/// pb::cloud::LedgerWriteBack state(backend, "device-state", edit_buffer);
+///
+/// state.SetUint("door_cycles", ++cycles);  // kDebounced
+/// state.SetString("mode", "service", pb::cloud::Durability::kImmediate);
+///
+/// // In the owning thread or task, e.g. once a second
+/// state.Service();
+///
+/// // Before System.sleep() or System.reset()
+/// state.Flush();
+/// @endcode
+///
+/// Thread Safety: not thread-safe; use from one thread or task. With a
+/// LedgerWorker running, the ledger must only be accessed through it, so
+/// use a LedgerWriteBack only for ledgers the worker does not manage.
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "pb_cloud/config.h"
+#include "pb_cloud/ledger_backend.h"
+#include "pb_cloud/ledger_types.h"
+#include "pw_bytes/span.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_status/status.h"
+#include "pw_string/string.h"
+
+namespace pb::cloud {
+
+/// Properties a LedgerWriteBack holds (PB_CLOUD_WRITE_BACK_MAX_ENTRIES).
+inline constexpr size_t kMaxWriteBackEntries = PB_CLOUD_WRITE_BACK_MAX_ENTRIES;
+
+/// Longest string value a LedgerWriteBack stages
+/// (PB_CLOUD_WRITE_BACK_MAX_STRING_SIZE).
+inline constexpr size_t kMaxWriteBackStringSize =
+    PB_CLOUD_WRITE_BACK_MAX_STRING_SIZE;
+
+/// Longest property key a LedgerWriteBack stages.
+inline constexpr size_t kMaxWriteBackKeySize = 32;
+
+/// How soon an update must reach flash (and the cloud).
+enum class Durability : uint8_t {
+  kImmediate,  ///< Committed before Set*() returns
+  kDebounced,  ///< Committed `debounce` after the first unsaved update
+  kRelaxed,    ///< Committed within `max_delay`, or with another commit
+};
+
+/// Commit policy of a LedgerWriteBack.
+struct LedgerWriteBackOptions {
+  /// Delay of kDebounced properties
+  pw::chrono::SystemClock::duration debounce =
+      pw::chrono::SystemClock::for_at_least(std::chrono::seconds(10));
+  /// Delay of kRelaxed properties
+  pw::chrono::SystemClock::duration max_delay =
+      pw::chrono::SystemClock::for_at_least(std::chrono::minutes(15));
+  /// Commit once this many properties are pending
+  size_t max_dirty = kMaxWriteBackEntries;
+};
+
+/// Counters of a LedgerWriteBack.
+struct LedgerWriteBackStats {
+  uint32_t updates = 0;    ///< Set*() calls that changed a value
+  uint32_t absorbed = 0;   ///< Updates replaced before they were committed
+  uint32_t commits = 0;    ///< Successful commits
+  uint32_t failures = 0;   ///< Failed commits (the values stay pending)
+};
+
+/// Write-back cache of properties of one ledger.
+class LedgerWriteBack {
+ public:
+  /// @param backend Ledger backend; must outlive the cache
+  /// @param ledger Ledger name
+  /// @param edit_buffer Working buffer of the commits, large enough for the
+  ///        whole ledger (see LedgerHandle::Edit())
+  LedgerWriteBack(LedgerBackend& backend,
+                  std::string_view ledger,
+                  pw::ByteSpan edit_buffer,
+                  const LedgerWriteBackOptions& options = {});
+
+  LedgerWriteBack(const LedgerWriteBack&) = delete;
+  LedgerWriteBack& operator=(const LedgerWriteBack&) = delete;
+
+  /// Stage a property value. Setting a pending property to the value it
+  /// already has is not an update.
+  ///
+  /// @return OkStatus, or:
+  ///         - InvalidArgument if the key or string is too long
+  ///         - ResourceExhausted if the table is full and committing it
+  ///           failed
+  ///         - the commit error for kImmediate (the value stays pending)
+  pw::Status SetBool(std::string_view key,
+                     bool value,
+                     Durability durability = Durability::kDebounced);
+  pw::Status SetInt(std::string_view key,
+                    int64_t value,
+                    Durability durability = Durability::kDebounced);
+  pw::Status SetUint(std::string_view key,
+                     uint64_t value,
+                     Durability durability = Durability::kDebounced);
+  pw::Status SetDouble(std::string_view key,
+                       double value,
+                       Durability durability = Durability::kDebounced);
+  pw::Status SetString(std::string_view key,
+                       std::string_view value,
+                       Durability durability = Durability::kDebounced);
+
+  /// Read a property: the pending value if there is one, else the ledger's.
+  bool GetBool(std::string_view key, bool default_value = false);
+  int64_t GetInt(std::string_view key, int64_t default_value = 0);
+  uint64_t GetUint(std::string_view key, uint64_t default_value = 0);
+  double GetDouble(std::string_view key, double default_value = 0.0);
+
+  /// Commit the properties that are due at `now`.
+  /// @return OkStatus if nothing was due or the commit succeeded, else the
+  ///         commit error; the values stay pending and are retried once
+  ///         `debounce` has passed
+  pw::Status Service(
+      pw::chrono::SystemClock::time_point now =
+          pw::chrono::SystemClock::now());
+
+  /// Commit all pending properties now, e.g. before sleep or reset.
+  pw::Status Flush();
+
+  /// Properties waiting for a commit.
+  size_t dirty_count() const { return dirty_count_; }
+
+  /// When Service() commits next without further updates, or
+  /// time_point::max() if nothing is pending. Lets a sleepy device choose
+  /// its wake-up time.
+  pw::chrono::SystemClock::time_point next_commit() const;
+
+  const LedgerWriteBackStats& stats() const { return stats_; }
+
+ private:
+  enum class Type : uint8_t { kBool, kInt, kUint, kDouble, kString };
+
+  struct Entry {
+    pw::InlineString<kMaxWriteBackKeySize> key;
+    Type type = Type::kBool;
+    union {
+      bool bool_value;
+      int64_t int_value;
+      uint64_t uint_value;
+      double double_value;
+    };
+    pw::InlineString<kMaxWriteBackStringSize> string_value;
+    bool dirty = false;
+    pw::chrono::SystemClock::time_point due;
+  };
+
+  /// Store `value` (key, type and value set) as the entry for its key.
+  pw::Status Stage(const Entry& value, Durability durability);
+
+  /// An entry for a new key: a free one, or a committed one to reuse.
+  Entry* Allocate();
+
+  Entry* Find(std::string_view key);
+
+  /// Commit every dirty entry in one LedgerEditor commit. On failure the
+  /// entries stay dirty and become due again after `debounce`.
+  pw::Status Commit();
+
+  pw::Status CommitEntries();
+
+  LedgerBackend& backend_;
+  pw::InlineString<kMaxLedgerNameSize> ledger_;
+  pw::ByteSpan edit_buffer_;
+  LedgerWriteBackOptions options_;
+
+  std::array<Entry, kMaxWriteBackEntries> entries_{};
+  size_t entry_count_ = 0;
+  size_t dirty_count_ = 0;
+  LedgerWriteBackStats stats_;
+};
+
+}  // namespace pb::cloud
@@ -0,0 +1,136 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file lz.h
+/// @brief Small-window LZ compression for event and ledger payloads.
+///
+/// An LZSS codec for the payloads pb_cloud sends: a few hundred bytes of
+/// CBOR, protobuf or JSON in which the same keys and slowly changing values
+/// repeat. Back-references reach 1 KB back and may point into a static
+/// dictionary shared by both ends (e.g. the CBOR keys of a telemetry
+/// message), so even the first occurrence of a key costs two bytes.
+///
+/// Format: one header byte (0xB0 | dictionary id), then groups of a flag
+/// byte and up to eight items, least significant flag bit first. A clear
+/// bit is a literal byte; a set bit is a big-endian 16-bit match of
+/// (distance - 1) << 6 | (length - 3), copying 3..66 bytes from
+/// 1..kLzWindowSize bytes back.
+///
+/// @code
+/// inline constexpr pb::cloud::LzDictionary kTelemetryKeys{
+///     .id = 1, .data = "temperaturehumiditypressure_pabattery_mv"};
+///
+/// auto size = pb::cloud::LzCompress(cbor, compressed, kTelemetryKeys);
+/// auto restored = pb::cloud::LzDecompress(
+///     compressed.first(size.value()), buffer, kTelemetryKeys);
+/// @endcode
+///
+/// LzCompress() needs no RAM beyond the buffers; LzDecompress() decodes
+/// into a flat buffer. LzDecoder decodes a stream in chunks of any size,
+/// e.g. from a LedgerReader, with a kLzWindowSize history.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "pw_bytes/span.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
+
+namespace pb::cloud {
+
+/// Farthest back-reference, and the history LzDecoder keeps.
+inline constexpr size_t kLzWindowSize = 1024;
+
+/// Preset dictionary. Both ends must use the same one; `id` (0..15) is
+/// stored in the header so that a mismatch is detected. Put the most
+/// frequent strings last, they are closest to the data.
+struct LzDictionary {
+  uint8_t id = 0;
+  std::string_view data;
+};
+
+/// No dictionary (id 0).
+inline constexpr LzDictionary kNoLzDictionary{};
+
+/// Largest LzCompress() output for `input_size` bytes: the header plus one
+/// flag byte per eight literals.
+constexpr size_t LzMaxCompressedSize(size_t input_size) {
+  return 1 + input_size + (input_size + 7) / 8;
+}
+
+/// Compresses `input` into `output`.
+///
+/// @return Compressed size, ResourceExhausted if `output` is too small,
+///         InvalidArgument if the dictionary id is above 15
+pw::Result<size_t> LzCompress(pw::ConstByteSpan input,
+                              pw::ByteSpan output,
+                              const LzDictionary& dictionary = {});
+
+/// Decompresses a whole payload into `output`.
+///
+/// @return Decompressed size, ResourceExhausted if `output` is too small,
+///         DataLoss if the data is corrupt or truncated, InvalidArgument if
+///         it was compressed with another dictionary
+pw::Result<size_t> LzDecompress(pw::ConstByteSpan input,
+                                pw::ByteSpan output,
+                                const LzDictionary& dictionary = {});
+
+/// Streaming decompressor with a fixed kLzWindowSize history.
+///
+/// @code
+/// pb::cloud::LzDecoder decoder(kTelemetryKeys);
+/// while (auto chunk = reader.Read(buffer); chunk.ok()) {
+///   PW_TRY(decoder.Write(chunk.value(), output));
+/// }
+/// PW_TRY(decoder.Finish());
+/// @endcode
+class LzDecoder {
+ public:
+  explicit LzDecoder(const LzDictionary& dictionary = {});
+
+  /// Decodes the next chunk of compressed data and writes the output.
+  ///
+  /// @return OkStatus, DataLoss or InvalidArgument as for LzDecompress(),
+  ///         or the error of `output`. The decoder must be Reset() after
+  ///         an error.
+  pw::Status Write(pw::ConstByteSpan input, pw::stream::Writer& output);
+
+  /// Checks that the data ended between two items.
+  /// @return DataLoss if the header or the second byte of a match is
+  ///         missing
+  pw::Status Finish() const;
+
+  /// Starts over for the next payload.
+  void Reset();
+
+  /// Decompressed bytes written since the last Reset().
+  [[nodiscard]] size_t bytes_written() const { return bytes_written_; }
+
+ private:
+  enum class State : uint8_t { kHeader, kFlags, kItem, kMatch, kError };
+
+  /// Appends a decoded byte to the history and to the output.
+  pw::Status Put(std::byte byte, pw::stream::Writer& output);
+  pw::Status FlushPending(pw::stream::Writer& output);
+
+  LzDictionary dictionary_;
+  std::array<std::byte, kLzWindowSize> window_;
+  size_t history_ = 0;   // Valid bytes in window_, up to kLzWindowSize
+  size_t position_ = 0;  // Next window_ slot
+  size_t bytes_written_ = 0;
+  State state_ = State::kHeader;
+  uint8_t flags_ = 0;
+  uint8_t items_left_ = 0;  // Items of the current flag byte
+  uint8_t match_high_ = 0;
+
+  // Decoded bytes waiting for the next write to the output stream
+  std::array<std::byte, 64> pending_;
+  size_t pending_size_ = 0;
+};
+
+}  // namespace pb::cloud
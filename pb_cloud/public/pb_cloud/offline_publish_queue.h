@@ -0,0 +1,195 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file offline_publish_queue.h
+/// @brief Store-and-forward queue for publishes made while offline.
+///
+/// CloudBackend::Publish() fails right away with Unavailable while the cloud
+/// is disconnected, and the data is lost. OfflinePublishQueue keeps events
+/// in a RAM buffer, optionally spilling over to (or always writing through)
+/// persistent storage, and publishes them in order, rate-limited, once the
+/// cloud is reachable.
+///
+/// Usage:
+/// @code
+/// std::array<std::byte, 4096> queue_storage;
+/// pb::cloud::ParticleFileSpillover spillover("/usr/publish_queue");
+/// pb::cloud::OfflinePublishQueue queue(cloud, queue_storage,
+///                                      {.spillover = &spillover});
+///
+/// queue.Enqueue("sensor/reading", data, {});
+///
+/// // In the owning task, e.g. every 100 ms
+/// queue.Pend(cx);
+/// @endcode
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "pb_cloud/cloud_backend.h"
+#include "pb_cloud/types.h"
+#include "pw_async2/context.h"
+#include "pw_async2/poll.h"
+#include "pw_bytes/span.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+
+namespace pb::cloud {
+
+/// Size of the header of a queued record: name length, flags, content
+/// type, TTL and data length.
+inline constexpr size_t kQueuedRecordHeaderSize = 8;
+
+/// Largest queued record: header, maximum name and maximum data.
+inline constexpr size_t kMaxQueuedRecordSize =
+    kQueuedRecordHeaderSize + kMaxEventNameSize + kMaxEventDataSize;
+
+/// Persistent FIFO of queued publish records, e.g. a file in flash.
+///
+/// Records are opaque byte strings of at most kMaxQueuedRecordSize bytes.
+class PublishSpillover {
+ public:
+  virtual ~PublishSpillover() = default;
+
+  /// Appends a record.
+  /// @return OkStatus, or ResourceExhausted if the storage is full
+  virtual pw::Status Push(pw::ConstByteSpan record) = 0;
+
+  /// Copies the oldest record into `dest` without removing it.
+  /// @return Size of the record, or NotFound if empty
+  virtual pw::StatusWithSize Peek(pw::ByteSpan dest) = 0;
+
+  /// Removes the oldest record.
+  virtual pw::Status Pop() = 0;
+
+  virtual bool empty() const = 0;
+};
+
+/// Options for an OfflinePublishQueue.
+struct OfflineQueueOptions {
+  /// Minimum time between two replayed publishes (Particle allows about
+  /// one event per second)
+  pw::chrono::SystemClock::duration min_interval =
+      pw::chrono::SystemClock::for_at_least(std::chrono::seconds(1));
+  /// Wait after a failed publish before retrying it
+  pw::chrono::SystemClock::duration retry_interval =
+      pw::chrono::SystemClock::for_at_least(std::chrono::seconds(5));
+  /// Attempts per event before it is dropped (0: retry forever)
+  uint8_t max_attempts = 5;
+  /// Storage for events that don't fit the RAM buffer (optional)
+  PublishSpillover* spillover = nullptr;
+  /// Write every event to `spillover` so queued events survive a reboot
+  bool persist_all = false;
+};
+
+/// Runtime counters of an OfflinePublishQueue.
+struct OfflineQueueStats {
+  uint32_t enqueued = 0;   ///< Events accepted by Enqueue()
+  uint32_t spilled = 0;    ///< Events written to the spillover storage
+  uint32_t published = 0;  ///< Events acknowledged by the backend
+  uint32_t retries = 0;    ///< Failed publish attempts that were retried
+  uint32_t dropped = 0;    ///< Events rejected (queue full) or given up on
+};
+
+/// Queues publishes and replays them in order when the cloud is reachable.
+///
+/// Events go to the RAM buffer while it has room, then to the spillover
+/// storage. Once anything is in the spillover storage, new events go there
+/// too, so the order is kept. One event is in flight at a time, at most one
+/// every min_interval.
+///
+/// PublishPriority::kHigh events go ahead of the queued kNormal ones, behind
+/// the event in flight, and skip the min_interval wait. They are kept in
+/// RAM even with persist_all, and only go to the spillover storage (in
+/// order) when the RAM buffer is full.
+///
+/// The backend copies the data of a publish, so RAM records are published
+/// in place; events from the spillover storage are read into a scratch
+/// buffer first.
+///
+/// Thread Safety: not thread-safe; use from the task that calls Pend().
+class OfflinePublishQueue {
+ public:
+  /// @param cloud Backend to publish with; must outlive the queue
+  /// @param storage RAM buffer for queued events; an event takes
+  ///                kQueuedRecordHeaderSize plus its name and data
+  OfflinePublishQueue(CloudBackend& cloud,
+                      pw::ByteSpan storage,
+                      const OfflineQueueOptions& options = {});
+
+  OfflinePublishQueue(const OfflinePublishQueue&) = delete;
+  OfflinePublishQueue& operator=(const OfflinePublishQueue&) = delete;
+
+  /// Queues an event (copied) for publishing.
+  /// @return OkStatus, or:
+  ///         - InvalidArgument if the name or data exceed the Particle
+  ///           limits
+  ///         - ResourceExhausted if neither the RAM buffer nor the
+  ///           spillover storage has room
+  pw::Status Enqueue(std::string_view name,
+                     pw::ConstByteSpan data,
+                     const PublishOptions& options);
+
+  /// Publishes the next queued event when the cloud is connected and
+  /// min_interval has passed, and completes the one in flight.
+  ///
+  /// The task is only woken when a publish in flight completes, so call
+  /// this periodically to notice reconnects and rate-limit expiry.
+  /// @return Pending while a publish is in flight, Ready otherwise
+  pw::async2::Poll<> Pend(pw::async2::Context& cx);
+
+  /// True if no events are queued in RAM or in the spillover storage.
+  bool empty() const;
+
+  /// Events queued in the RAM buffer (the spillover storage isn't counted).
+  size_t ram_count() const { return ram_count_; }
+
+  const OfflineQueueStats& stats() const { return stats_; }
+
+ private:
+  // Encodes an event into `dest`.
+  static pw::StatusWithSize EncodeRecord(std::string_view name,
+                                         pw::ConstByteSpan data,
+                                         const PublishOptions& options,
+                                         pw::ByteSpan dest);
+
+  // Starts publishing the oldest record.
+  pw::Status PublishFront();
+
+  // Removes the oldest record.
+  void PopFront();
+
+  // True if the next record to publish is a kHigh record in RAM.
+  bool HighPriorityFront() const;
+
+  // Moves the RAM record at `offset` ahead of the kNormal records.
+  void MoveAheadOfNormal(size_t offset, size_t size);
+
+  CloudBackend& cloud_;
+  pw::ByteSpan storage_;
+  OfflineQueueOptions options_;
+
+  // RAM records are packed from the start of storage_: the one in flight,
+  // then kHigh and kNormal records, each oldest first.
+  size_t ram_used_ = 0;
+  size_t ram_count_ = 0;
+
+  // Holds the front spillover record while it is published.
+  std::array<std::byte, kMaxQueuedRecordSize> scratch_{};
+
+  std::optional<PublishFuture> in_flight_;
+  bool in_flight_from_ram_ = false;
+  uint8_t attempts_ = 0;
+  pw::chrono::SystemClock::time_point next_publish_time_;
+
+  OfflineQueueStats stats_;
+};
+
+}  // namespace pb::cloud
@@ -24,11 +24,14 @@
 
 #include "pb_cloud/cloud_backend.h"
 #include "pw_async2/channel.h"
+#include "pw_metric/metric.h"
+#include "pw_result/result.h"
 #include "pw_string/string.h"
 
 namespace pb::cloud {
 
-/// Default channel capacity for event buffering.
+/// Channel capacity of Subscribe(prefix). Subscriptions with their own
+/// EventChannelStorage choose their depth.
 inline constexpr uint16_t kEventChannelCapacity = 8;
 
 /// Particle Cloud backend implementation using spark_* dynalib.
@@ -50,54 +53,133 @@ class ParticleCloudBackend : public CloudBackend {
 
   // -- CloudBackend interface --
 
+  bool IsConnected() const override;
+
+  CloudStats stats() const override;
+  void ResetStats() override;
+
+  /// The counters as a pw_metric group ("cloud"). Add it to an application
+  /// metric group to export it, e.g. over pw_rpc.
+  pw::metric::Group& metrics();
+
   PublishFuture Publish(std::string_view name,
                         pw::ConstByteSpan data,
                         const PublishOptions& options) override;
+  using CloudBackend::Publish;
 
+  /// Number of publishes waiting for their ack.
+  size_t pending_publish_count() const;
+
+  /// Replaces the previous Subscribe(prefix) subscription; subscriptions
+  /// with their own storage are kept.
   EventReceiver Subscribe(std::string_view prefix) override;
+  using CloudBackend::Subscribe;
+
+  /// Events dropped because their subscription's channel was full.
+  uint32_t dropped_event_count() const;
 
   pw::Status RegisterFunction(std::string_view name,
                               CloudFunction&& handler) override;
 
-  // Internal: Access handler for trampoline dispatch. Do not use directly.
-  CloudFunction& GetHandler(size_t index) { return function_handlers_[index]; }
-
  protected:
   pw::Status DoRegisterVariable(
       std::string_view name,
       const void* data,
       VariableType type,
-      std::unique_ptr<void, VariableDeleter> storage) override;
+      VariableStorage storage) override;
+
+  pw::Status DoRegisterComputedVariable(
+      std::string_view name,
+      ComputedVariable& variable,
+      VariableStorage storage) override;
+
+  pw::Status DoSubscribe(std::string_view prefix,
+                         pw::async2::SpscChannelHandle<ReceivedEvent>& handle,
+                         EventSender& sender) override;
+
+  pw::Status DoSubscribe(std::string_view prefix,
+                         pw::async2::SpscChannelHandle<CompactEvent>& handle,
+                         CompactEventSender& sender,
+                         EventArena& arena) override;
 
  private:
+  // One event subscription. Device OS keeps a spark_subscribe() registration
+  // with the slot as handler data, even after the slot ends or is reused for
+  // another prefix, so OnEventReceived() checks the prefix again.
+  struct Subscription {
+    pw::InlineString<kMaxEventNameSize> prefix;
+    pw::InlineString<kMaxEventNameSize> registered_prefix;
+    pw::async2::SpscChannelHandle<ReceivedEvent> handle;
+    EventSender sender;
+    // Used instead of handle and sender for subscriptions with an arena
+    pw::async2::SpscChannelHandle<CompactEvent> compact_handle;
+    CompactEventSender compact_sender;
+    EventArena* arena = nullptr;
+    bool uses_default_storage = false;
+
+    bool is_open() const {
+      return sender.is_open() || compact_sender.is_open();
+    }
+  };
+
+  // One publish waiting for its ack. Device OS gets the slot as handler
+  // data, so each ack resolves the future of its own publish.
+  struct PublishSlot {
+    pw::async2::ValueProvider<pw::Status> provider;
+    bool in_flight = false;
+    uint32_t started_us = 0;  // For the publish latency
+  };
+
   // Private constructor for singleton pattern
   ParticleCloudBackend();
   ~ParticleCloudBackend();
 
-  EventReceiver CreateSubscriptionReceiver();
+  // Takes a free slot and registers it for `prefix`; the caller then
+  // attaches the channel.
+  pw::Result<Subscription*> AddSubscription(std::string_view prefix);
+
+  // Ends the subscription of `sub` and releases its channel.
+  static void EndSubscription(Subscription& sub);
+
+  // Counts an event dropped for `sub`, with a rate-limited warning.
+  void CountDroppedEvent(const Subscription& sub);
+
+  // Registers a variable with Device OS and keeps its storage. `extra` is
+  // the spark_variable_t of spark_variable(), or null.
+  pw::Status RegisterSparkVariable(
+      std::string_view name,
+      const void* data,
+      VariableType type,
+      void* extra,
+      VariableStorage storage);
+
+  // Dispatches a cloud function call to the handler in `data`.
+  static int OnFunctionCall(void* data, const char* param, void* reserved);
 
   static void OnPublishComplete(int error,
                                 const void* data,
                                 void* reserved,
                                 void* reserved2);
 
-  static void OnEventReceived(const char* event_name, const char* data);
+  static void OnEventReceived(const void* handler_data,
+                              const char* event_name,
+                              const char* data,
+                              size_t data_size,
+                              int content_type);
 
-  // Function handlers for cloud function trampolines
+  // Function handlers; Device OS holds a pointer to each registered one
   std::array<CloudFunction, kMaxCloudFunctions> function_handlers_{};
 
-  pw::async2::ValueProvider<pw::Status> publish_provider_;
+  std::array<PublishSlot, kMaxPendingPublishes> publish_slots_{};
 
-  // Event channel for subscription
-  pw::async2::ChannelStorage<ReceivedEvent, kEventChannelCapacity>
-      event_channel_storage_;
-  pw::async2::SpscChannelHandle<ReceivedEvent> event_channel_handle_;
-  pw::async2::Sender<ReceivedEvent> event_sender_;
+  // Channel storage of Subscribe(prefix)
+  EventChannelStorage<kEventChannelCapacity> event_channel_storage_;
 
-  pw::InlineString<kMaxEventNameSize> subscription_prefix_;
+  std::array<Subscription, kMaxEventSubscriptions> subscriptions_{};
 
-  // Variable storage (ownership of CloudVariable containers)
-  std::array<std::shared_ptr<void>, kMaxCloudVariables> variable_storage_{};
+  // Variable storage (ownership of CloudVariable containers registered
+  // without caller storage)
+  std::array<VariableStorage, kMaxCloudVariables> variable_storage_{};
   size_t variable_count_ = 0;
 
   // Function count (handlers are stored in function_handlers_)
@@ -0,0 +1,76 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file particle_file_spillover.h
+/// @brief PublishSpillover in a file on the Device OS flash filesystem.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pb_cloud/offline_publish_queue.h"
+#include "pw_bytes/span.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+
+namespace pb::cloud {
+
+/// Queued publish records in a file, so they survive a reboot.
+///
+/// The file starts with the offset of the oldest record, followed by the
+/// records, each prefixed with its 16-bit length. Pop() only moves that
+/// offset; the file is truncated once it has been read to the end. Every
+/// Push() and Pop() is synced to flash.
+///
+/// Usage:
+/// @code
+/// pb::cloud::ParticleFileSpillover spillover("/usr/publish_queue");
+/// PW_TRY(spillover.Open());
+/// @endcode
+class ParticleFileSpillover : public PublishSpillover {
+ public:
+  /// @param path File to use; must outlive this object
+  /// @param max_file_size Push() fails once the file would grow beyond this
+  explicit ParticleFileSpillover(const char* path,
+                                 size_t max_file_size = 64 * 1024);
+
+  ~ParticleFileSpillover() override;
+
+  ParticleFileSpillover(const ParticleFileSpillover&) = delete;
+  ParticleFileSpillover& operator=(const ParticleFileSpillover&) = delete;
+
+  /// Opens or creates the file and picks up the records already in it. A
+  /// record cut short by a reset during Push() is discarded.
+  /// @return OkStatus, or Unavailable if the file can't be opened
+  pw::Status Open();
+
+  /// @return OkStatus, ResourceExhausted if the file is full,
+  ///         FailedPrecondition if not open, or DataLoss on write errors
+  pw::Status Push(pw::ConstByteSpan record) override;
+  pw::StatusWithSize Peek(pw::ByteSpan dest) override;
+  pw::Status Pop() override;
+
+  /// True if no records are stored (or not open).
+  bool empty() const override { return head_ >= end_; }
+
+ private:
+  static constexpr uint32_t kFileHeaderSize = 4;
+  static constexpr uint32_t kRecordLengthSize = 2;
+
+  // Starts the file over with no records.
+  pw::Status Reset();
+
+  pw::Status WriteHead();
+
+  bool ReadAt(uint32_t offset, void* dest, size_t len);
+  bool WriteAt(uint32_t offset, const void* src, size_t len);
+
+  const char* path_;
+  const size_t max_file_size_;
+  int fd_ = -1;
+  uint32_t head_ = kFileHeaderSize;  // Oldest record
+  uint32_t end_ = kFileHeaderSize;   // End of the last record
+};
+
+}  // namespace pb::cloud
@@ -27,13 +27,19 @@
 
 namespace pb::cloud {
 
-/// Default channel capacity for sync event buffering.
-inline constexpr uint16_t kSyncChannelCapacity = 4;
+/// Channel capacity for sync event buffering. One pending event per
+/// ledger: a sync while an event is pending is folded into it.
+inline constexpr uint16_t kSyncChannelCapacity = 1;
 
 /// Particle Ledger backend implementation using system_ledger dynalib.
 ///
 /// This is a singleton - use Instance() to get the single instance.
 /// Only one instance is allowed (enforced at compile time via private ctor).
+///
+/// Opened ledger_instance pointers are cached by name (up to
+/// kMaxLedgerCount), so repeated GetLedger() calls and typed reads skip the
+/// Device OS lookup. An instance stays open while unused; it is released
+/// when its slot is needed for another ledger, or before a purge.
 class ParticleLedgerBackend : public LedgerBackend {
  public:
   /// Get the singleton instance.
@@ -64,18 +70,42 @@ class ParticleLedgerBackend : public LedgerBackend {
                             pw::ByteSpan buffer) override;
   pw::Status DoWrite(internal::LedgerInstance* instance,
                      pw::ConstByteSpan data) override;
+  pw::Result<internal::LedgerStream*> DoOpenStream(
+      internal::LedgerInstance* instance, LedgerStreamMode mode) override;
+  pw::StatusWithSize DoReadStream(internal::LedgerStream* stream,
+                                  pw::ByteSpan buffer) override;
+  pw::Status DoWriteStream(internal::LedgerStream* stream,
+                           pw::ConstByteSpan data) override;
+  pw::Status DoCloseStream(internal::LedgerStream* stream,
+                           bool commit) override;
+  uint32_t DoGetRevision(internal::LedgerInstance* instance) override;
 
  private:
   // Private constructor for singleton pattern
   ParticleLedgerBackend();
   ~ParticleLedgerBackend();
 
+  // Open ledger instance, shared by all handles to the ledger
+  struct CachedInstance {
+    pw::InlineString<kMaxLedgerNameSize> name;
+    internal::LedgerInstance* instance = nullptr;
+    uint16_t handles = 0;  // Open LedgerHandles (and a subscription)
+  };
+
+  /// Get the cached instance for `name`, opening it if needed, and count
+  /// one more user. Returns nullptr on failure.
+  internal::LedgerInstance* AcquireInstance(std::string_view name);
+
+  /// Release unused cached instances for `name`, or all if empty.
+  void DropUnusedInstances(std::string_view name);
+
   // Per-ledger subscription tracking
   struct Subscription {
     pw::InlineString<kMaxLedgerNameSize> name;
     pw::async2::ChannelStorage<SyncEvent, kSyncChannelCapacity> storage;
     pw::async2::SpscChannelHandle<SyncEvent> handle;
     pw::async2::Sender<SyncEvent> sender;
+    internal::LedgerInstance* instance = nullptr;  // Keeps the callback set
     bool active = false;
   };
 
@@ -86,6 +116,11 @@ class ParticleLedgerBackend : public LedgerBackend {
   static void OnLedgerSync(void* ledger, void* app_data);
 
   std::array<Subscription, kMaxLedgerCount> subscriptions_{};
+  std::array<CachedInstance, kMaxLedgerCount> instances_{};
+
+  // Bumped on every local write, purge and reported sync. Shared by all
+  // ledgers: a change to one also reloads caches of the others.
+  uint32_t revision_ = 0;
 };
 
 }  // namespace pb::cloud
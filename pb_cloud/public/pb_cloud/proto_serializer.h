@@ -32,12 +32,20 @@
 ///   // decoded.value().field == 42
 /// }
 /// @endcode
+///
+/// SerializeTo() and DeserializeFrom() work on a pw::stream directly, e.g.
+/// a LedgerWriter/LedgerReader, so no buffer for the whole message is
+/// needed. kMaxEncodedSize sizes buffers from the generated bound.
+
+#include <cstddef>
 
 #include "pb_cloud/serializer.h"
 #include "pb_cloud/types.h"
 #include "pw_bytes/span.h"
 #include "pw_result/result.h"
+#include "pw_status/status.h"
 #include "pw_stream/memory_stream.h"
+#include "pw_stream/stream.h"
 
 namespace pb::cloud {
 
@@ -50,6 +58,17 @@ struct ProtoSerializer {
   /// The message struct type.
   using Message = typename Proto::Message;
 
+  /// Largest encoding of a Message: Proto::kMaxEncodedSizeBytes, which
+  /// pw_protobuf generates when every field is bounded, otherwise the
+  /// Particle event data limit.
+  static constexpr size_t kMaxEncodedSize = [] {
+    if constexpr (requires { Proto::kMaxEncodedSizeBytes; }) {
+      return static_cast<size_t>(Proto::kMaxEncodedSizeBytes);
+    } else {
+      return kMaxEventDataSize;
+    }
+  }();
+
   /// Serialize message to buffer.
   ///
   /// @param value Message to serialize
@@ -65,13 +84,39 @@ struct ProtoSerializer {
     return encoder.size();
   }
 
+  /// Serialize message straight into a stream.
+  ///
+  /// @param value Message to serialize
+  /// @param writer Destination, e.g. a LedgerWriter
+  /// @param scratch Buffer for nested messages (their length prefix is
+  ///                written before their fields); may be empty if the
+  ///                message has none
+  /// @return OkStatus, or the encoder or writer error
+  static pw::Status SerializeTo(const Message& value,
+                                pw::stream::Writer& writer,
+                                pw::ByteSpan scratch = {}) {
+    typename Proto::StreamEncoder encoder(writer, scratch);
+    return encoder.Write(value);
+  }
+
   /// Deserialize bytes to message.
   ///
+  /// Decodes in place: the reader only tracks a position in `data`.
+  ///
   /// @param data Encoded proto bytes
   /// @return Decoded message, or error
   static pw::Result<Message> Deserialize(pw::ConstByteSpan data) {
-    Message msg{};
     pw::stream::MemoryReader reader(data);
+    return DeserializeFrom(reader);
+  }
+
+  /// Deserialize a message read from a stream, e.g. a LedgerReader or the
+  /// data of a ReceivedEvent.
+  ///
+  /// @param reader Source, read until the end of the message
+  /// @return Decoded message, or error
+  static pw::Result<Message> DeserializeFrom(pw::stream::Reader& reader) {
+    Message msg{};
     typename Proto::StreamDecoder decoder(reader);
     pw::Status status = decoder.Read(msg);
     if (!status.ok()) {
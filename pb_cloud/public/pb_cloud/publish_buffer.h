@@ -0,0 +1,115 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file publish_buffer.h
+/// @brief Fixed pool of event-sized buffers for serializing publishes.
+///
+/// Serializing into a std::array on the caller's stack costs up to 1 KB of
+/// stack per publish, which small coroutine and thread stacks can't spare.
+/// Each CloudBackend owns a PublishBufferPool instead; PublishTyped()
+/// leases a buffer, serializes into it, publishes from it and returns it.
+///
+/// Usage:
+/// @code
+/// auto buffer = cloud.AcquirePublishBuffer();
+/// if (buffer.ok()) {
+///   cbor::Encoder encoder(buffer.value().data());
+///   // ... encode ...
+///   auto future = cloud.Publish("sensor/batch", std::move(buffer.value()),
+///                               encoder.size(), {});
+/// }
+/// @endcode
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#include "pb_cloud/config.h"
+#include "pb_cloud/types.h"
+#include "pw_bytes/span.h"
+#include "pw_result/result.h"
+
+namespace pb::cloud {
+
+/// Publish buffers per backend (PB_CLOUD_PUBLISH_BUFFER_COUNT).
+inline constexpr size_t kPublishBufferCount = PB_CLOUD_PUBLISH_BUFFER_COUNT;
+
+class PublishBufferPool;
+
+/// Buffer leased from a PublishBufferPool.
+///
+/// Move-only handle; the buffer goes back to the pool when the handle is
+/// destroyed or Release() is called. The pool must outlive its buffers.
+class PublishBuffer {
+ public:
+  PublishBuffer() = default;
+  ~PublishBuffer() { Release(); }
+
+  PublishBuffer(const PublishBuffer&) = delete;
+  PublishBuffer& operator=(const PublishBuffer&) = delete;
+
+  PublishBuffer(PublishBuffer&& other) noexcept
+      : pool_(other.pool_), index_(other.index_) {
+    other.pool_ = nullptr;
+  }
+
+  PublishBuffer& operator=(PublishBuffer&& other) noexcept {
+    if (this != &other) {
+      Release();
+      pool_ = other.pool_;
+      index_ = other.index_;
+      other.pool_ = nullptr;
+    }
+    return *this;
+  }
+
+  /// True if the handle holds a buffer.
+  bool has_value() const { return pool_ != nullptr; }
+
+  /// The kMaxEventDataSize bytes of the buffer; empty if the handle is
+  /// empty.
+  pw::ByteSpan data() const;
+
+  /// Returns the buffer to its pool early; the handle becomes empty.
+  void Release();
+
+ private:
+  friend class PublishBufferPool;
+
+  PublishBuffer(PublishBufferPool& pool, size_t index)
+      : pool_(&pool), index_(index) {}
+
+  PublishBufferPool* pool_ = nullptr;
+  size_t index_ = 0;
+};
+
+/// kPublishBufferCount buffers of kMaxEventDataSize bytes each.
+///
+/// Thread Safety: Acquire() and releasing a buffer may be called from any
+/// thread.
+class PublishBufferPool {
+ public:
+  PublishBufferPool() = default;
+
+  PublishBufferPool(const PublishBufferPool&) = delete;
+  PublishBufferPool& operator=(const PublishBufferPool&) = delete;
+
+  /// Lease a free buffer.
+  /// @return The buffer, or ResourceExhausted if all are leased
+  pw::Result<PublishBuffer> Acquire();
+
+  /// Buffers not leased right now.
+  size_t available() const;
+
+ private:
+  friend class PublishBuffer;
+
+  using Buffer = std::array<std::byte, kMaxEventDataSize>;
+
+  std::array<Buffer, kPublishBufferCount> buffers_;
+  std::array<std::atomic<bool>, kPublishBufferCount> leased_{};
+};
+
+}  // namespace pb::cloud
@@ -27,48 +27,81 @@
 /// }
 /// @endcode
 
-#include <array>
 #include <string_view>
+#include <utility>
 
 #include "pb_cloud/cloud_backend.h"
 #include "pb_cloud/proto_serializer.h"
 #include "pb_cloud/serializer.h"
 #include "pb_cloud/types.h"
+#include "pw_bytes/span.h"
 
 namespace pb::cloud {
 
+/// Publish typed value, serialized into a caller-provided buffer.
+///
+/// For callers with their own long-lived buffer, e.g. a static or a slice
+/// of an arena. The buffer is copied internally by the backend, so it can
+/// be reused once this returns.
+///
+/// @tparam T Value type to publish
+/// @tparam Ser Serializer to use (defaults to Serializer<T>)
+/// @param cloud Cloud backend to use
+/// @param name Event name
+/// @param value Value to serialize and publish
+/// @param buffer Serialization buffer
+/// @param options Publish options (required, so that `{}` selects the
+///                overload without a buffer)
+/// @return Future that resolves when publish completes, or right away to
+///         the serializer error
+template <typename T, typename Ser = Serializer<T>>
+PublishFuture PublishTyped(CloudBackend& cloud,
+                           std::string_view name,
+                           const T& value,
+                           pw::ByteSpan buffer,
+                           const PublishOptions& options) {
+  auto result = Ser::Serialize(value, buffer);
+  if (!result.ok()) {
+    return PublishFuture::Resolved(result.status());
+  }
+
+  PublishOptions opts = options;
+  opts.content_type = Ser::kContentType;
+  return cloud.Publish(name, buffer.first(result.value()), opts);
+}
+
 /// Publish typed value using the specified serializer.
 ///
-/// Serializes the value to a temporary buffer, then publishes via the cloud
-/// backend. The buffer is copied internally by the backend.
+/// Serializes the value into one of the backend's publish buffers (see
+/// publish_buffer.h) and publishes from it, so the stack use doesn't
+/// depend on the event size.
 ///
 /// @tparam T Value type to publish
 /// @tparam Ser Serializer to use (defaults to Serializer<T>)
-/// @tparam kBufSize Serialization buffer size (default 256)
 /// @param cloud Cloud backend to use
 /// @param name Event name
 /// @param value Value to serialize and publish
 /// @param options Publish options (optional)
-/// @return Future that resolves when publish completes
-template <typename T,
-          typename Ser = Serializer<T>,
-          size_t kBufSize = 256>
+/// @return Future that resolves when publish completes, or right away to
+///         ResourceExhausted if no publish buffer is free, or to the
+///         serializer error
+template <typename T, typename Ser = Serializer<T>>
 PublishFuture PublishTyped(CloudBackend& cloud,
                            std::string_view name,
                            const T& value,
                            const PublishOptions& options = {}) {
-  std::array<std::byte, kBufSize> buffer;
-  auto result = Ser::Serialize(value, buffer);
+  auto buffer = cloud.AcquirePublishBuffer();
+  if (!buffer.ok()) {
+    return PublishFuture::Resolved(buffer.status());
+  }
+  auto result = Ser::Serialize(value, buffer.value().data());
   if (!result.ok()) {
-    // Return immediately-failed future
-    // Note: We need to create a provider and immediately set it
-    return cloud.Publish(name, pw::ConstByteSpan(), options);
+    return PublishFuture::Resolved(result.status());
   }
 
   PublishOptions opts = options;
   opts.content_type = Ser::kContentType;
-  return cloud.Publish(
-      name, pw::ConstByteSpan(buffer.data(), result.value()), opts);
+  return cloud.Publish(name, std::move(buffer.value()), result.value(), opts);
 }
 
 /// Publish a protobuf message.
@@ -76,20 +109,37 @@ PublishFuture PublishTyped(CloudBackend& cloud,
 /// Convenience wrapper around PublishTyped using ProtoSerializer.
 ///
 /// @tparam Proto Proto type (e.g., SensorReading from sensor_reading.pwpb.h)
-/// @tparam kBufSize Serialization buffer size (default 256)
 /// @param cloud Cloud backend to use
 /// @param name Event name
 /// @param message Message to serialize and publish
 /// @param options Publish options (optional)
 /// @return Future that resolves when publish completes
-template <typename Proto, size_t kBufSize = 256>
+template <typename Proto>
 PublishFuture PublishProto(CloudBackend& cloud,
                            std::string_view name,
                            const typename Proto::Message& message,
                            const PublishOptions& options = {}) {
-  return PublishTyped<typename Proto::Message,
-                      ProtoSerializer<Proto>,
-                      kBufSize>(cloud, name, message, options);
+  return PublishTyped<typename Proto::Message, ProtoSerializer<Proto>>(
+      cloud, name, message, options);
+}
+
+/// Publish a protobuf message, serialized into a caller-provided buffer.
+///
+/// @tparam Proto Proto type
+/// @param cloud Cloud backend to use
+/// @param name Event name
+/// @param message Message to serialize and publish
+/// @param buffer Serialization buffer
+/// @param options Publish options
+/// @return Future that resolves when publish completes
+template <typename Proto>
+PublishFuture PublishProto(CloudBackend& cloud,
+                           std::string_view name,
+                           const typename Proto::Message& message,
+                           pw::ByteSpan buffer,
+                           const PublishOptions& options) {
+  return PublishTyped<typename Proto::Message, ProtoSerializer<Proto>>(
+      cloud, name, message, buffer, options);
 }
 
 /// Deserialize a received event to a typed value.
@@ -106,6 +156,20 @@ pw::Result<T> DeserializeEvent(const ReceivedEvent& event) {
       pw::ConstByteSpan(event.data.data(), event.data.size()));
 }
 
+/// Deserialize an event stored in an EventArena to a typed value.
+///
+/// Decodes from the arena directly; the value must not keep pointers into
+/// the event's data beyond the event's lifetime.
+///
+/// @tparam T Target type
+/// @tparam Ser Serializer to use (defaults to Serializer<T>)
+/// @param event Received event
+/// @return Deserialized value, or error
+template <typename T, typename Ser = Serializer<T>>
+pw::Result<T> DeserializeEvent(const CompactEvent& event) {
+  return Ser::Deserialize(event.data());
+}
+
 /// Deserialize a received event to a protobuf message.
 ///
 /// Convenience wrapper for protobuf deserialization.
@@ -120,4 +184,16 @@ pw::Result<typename Proto::Message> DeserializeProtoEvent(
       event);
 }
 
+/// Deserialize an event stored in an EventArena to a protobuf message.
+///
+/// @tparam Proto Proto type
+/// @param event Received event
+/// @return Deserialized message, or error
+template <typename Proto>
+pw::Result<typename Proto::Message> DeserializeProtoEvent(
+    const CompactEvent& event) {
+  return DeserializeEvent<typename Proto::Message, ProtoSerializer<Proto>>(
+      event);
+}
+
 }  // namespace pb::cloud
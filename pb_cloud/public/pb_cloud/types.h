@@ -6,12 +6,16 @@
 /// @file types.h
 /// @brief Core types for Particle Cloud API.
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
 
+#include "pb_cloud/config.h"
 #include "pw_containers/vector.h"
+#include "pw_function/function.h"
 #include "pw_string/string.h"
+#include "pw_string/string_builder.h"
 
 namespace pb::cloud {
 
@@ -33,6 +37,15 @@ enum class AckMode : uint8_t {
   kWithAck,  ///< Wait for cloud acknowledgement
 };
 
+/// Publish priority class.
+///
+/// kHigh publishes (alarms) keep kHighPriorityPublishSlots backend slots to
+/// themselves and go ahead of queued kNormal events in OfflinePublishQueue.
+enum class PublishPriority : uint8_t {
+  kNormal,  ///< Telemetry and other bulk traffic
+  kHigh,    ///< Events whose latency matters under load
+};
+
 /// Content type for event data.
 enum class ContentType : int {
   kText = 0,          ///< Plain text (UTF-8)
@@ -86,6 +99,7 @@ struct PublishOptions {
   AckMode ack = AckMode::kWithAck;
   ContentType content_type = ContentType::kText;
   int ttl_seconds = 60;
+  PublishPriority priority = PublishPriority::kNormal;
 };
 
 /// Received cloud event - OWNS its data (copied from Particle callback buffer).
@@ -100,8 +114,9 @@ struct ReceivedEvent {
 
 // -- Particle Limits --
 
-/// Maximum number of cloud functions (Particle limit).
-inline constexpr size_t kMaxCloudFunctions = 15;
+/// Maximum number of cloud functions (PB_CLOUD_MAX_CLOUD_FUNCTIONS, by
+/// default the Particle limit of 15).
+inline constexpr size_t kMaxCloudFunctions = PB_CLOUD_MAX_CLOUD_FUNCTIONS;
 
 /// Maximum number of cloud variables (Particle limit).
 inline constexpr size_t kMaxCloudVariables = 20;
@@ -109,6 +124,47 @@ inline constexpr size_t kMaxCloudVariables = 20;
 /// Maximum string variable size (Particle limit).
 inline constexpr size_t kMaxStringVariableSize = 622;
 
+/// Maximum number of concurrent event subscriptions per backend.
+inline constexpr size_t kMaxEventSubscriptions = 4;
+
+/// Maximum number of publishes in flight (waiting for their ack) per backend.
+inline constexpr size_t kMaxPendingPublishes = 4;
+
+/// Publish slots only kHigh publishes may take, so an alarm never finds
+/// every slot taken by telemetry.
+inline constexpr size_t kHighPriorityPublishSlots = 1;
+
+// -- Statistics --
+
+/// Buckets of the CloudStats publish latency histogram: < 100 ms, < 250 ms,
+/// < 500 ms, < 1 s, < 5 s and >= 5 s.
+inline constexpr size_t kCloudLatencyBuckets = 6;
+
+/// Counters of a CloudBackend (see CloudBackend::stats()).
+///
+/// Publish latency runs from Publish() to the ack, so it includes the time
+/// Device OS holds the event before sending it. Long latencies with few
+/// publishes pending point at the cloud or the link; many publish_busy
+/// failures at the application publishing faster than acks arrive.
+struct CloudStats {
+  uint32_t publishes = 0;            ///< Publish() calls
+  uint32_t publish_acks = 0;         ///< Publishes that completed OK
+  uint32_t publish_errors = 0;       ///< Publishes that failed after starting
+  uint32_t publish_unavailable = 0;  ///< Publishes Device OS couldn't start
+  uint32_t publish_busy = 0;  ///< Rejected: no free slot for the priority
+  uint32_t publish_latency_max_ms = 0;
+  std::array<uint32_t, kCloudLatencyBuckets> publish_latency_ms{};
+
+  /// Events delivered to a subscription; an event matching two
+  /// subscriptions counts twice
+  uint32_t events_received = 0;
+  uint32_t events_dropped = 0;  ///< Of events_received: channel/arena full
+
+  uint32_t function_calls = 0;
+  uint32_t function_time_max_us = 0;
+  uint32_t function_time_total_us = 0;
+};
+
 // -- Cloud Variable Containers --
 
 /// Cloud-readable variable container for scalar types.
@@ -189,4 +245,70 @@ class CloudStringVariable {
   char buffer_[kMaxSize]{};
 };
 
+/// Cloud-readable variable whose value is computed when the cloud reads it.
+///
+/// The backend calls Read() on every cloud query; nothing is computed while
+/// nobody reads the variable.
+class ComputedVariable {
+ public:
+  virtual ~ComputedVariable() = default;
+
+  /// Computes the value and returns a pointer to it in the Particle
+  /// representation, valid until the next Read().
+  virtual const void* Read() = 0;
+
+  virtual VariableType type() const = 0;
+};
+
+/// Computed cloud variable for scalar types.
+///
+/// @tparam T Variable type (bool, int, double)
+template <typename T>
+class ComputedCloudVariable final : public ComputedVariable {
+ public:
+  using Compute = pw::Function<T()>;
+
+  explicit ComputedCloudVariable(Compute&& compute)
+      : compute_(std::move(compute)) {}
+
+  const void* Read() override {
+    value_ = compute_();
+    return &value_;
+  }
+
+  VariableType type() const override { return VariableTypeTrait<T>::kType; }
+
+ private:
+  Compute compute_;
+  T value_{};
+};
+
+/// Computed cloud string variable.
+///
+/// The compute function writes the value into a cleared StringBuilder of
+/// kMaxSize bytes; longer values are truncated.
+///
+/// @tparam kMaxSize Buffer size including the terminator (default: Particle
+///                  max of 622)
+template <size_t kMaxSize = kMaxStringVariableSize>
+class ComputedCloudStringVariable final : public ComputedVariable {
+ public:
+  using Compute = pw::Function<void(pw::StringBuilder& value)>;
+
+  explicit ComputedCloudStringVariable(Compute&& compute)
+      : compute_(std::move(compute)) {}
+
+  const void* Read() override {
+    builder_.clear();
+    compute_(builder_);
+    return builder_.c_str();
+  }
+
+  VariableType type() const override { return VariableType::kString; }
+
+ private:
+  Compute compute_;
+  pw::StringBuffer<kMaxSize> builder_;
+};
+
 }  // namespace pb::cloud
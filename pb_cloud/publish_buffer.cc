@@ -0,0 +1,42 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_cloud/publish_buffer.h"
+
+namespace pb::cloud {
+
+pw::ByteSpan PublishBuffer::data() const {
+  if (pool_ == nullptr) {
+    return pw::ByteSpan();
+  }
+  return pool_->buffers_[index_];
+}
+
+void PublishBuffer::Release() {
+  if (pool_ == nullptr) {
+    return;
+  }
+  pool_->leased_[index_].store(false, std::memory_order_release);
+  pool_ = nullptr;
+}
+
+pw::Result<PublishBuffer> PublishBufferPool::Acquire() {
+  for (size_t i = 0; i < leased_.size(); ++i) {
+    if (!leased_[i].exchange(true, std::memory_order_acquire)) {
+      return PublishBuffer(*this, i);
+    }
+  }
+  return pw::Status::ResourceExhausted();
+}
+
+size_t PublishBufferPool::available() const {
+  size_t count = 0;
+  for (const auto& leased : leased_) {
+    if (!leased.load(std::memory_order_relaxed)) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+}  // namespace pb::cloud
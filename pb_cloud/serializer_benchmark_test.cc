@@ -0,0 +1,170 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+/// @file serializer_benchmark_test.cc
+/// @brief Payload size and encode/decode time of CBOR vs. pw_protobuf.
+///
+/// Serializes the same telemetry reading with CborStructSerializer and
+/// ProtoSerializer, checks the round trips and logs bytes and time per
+/// message. Built for the host (serializer_benchmark_test) and the P2
+/// (serializer_benchmark_device_test); timings are not asserted.
+
+#define PW_LOG_MODULE_NAME "ser_bench"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "pb_cloud/cbor_struct_serializer.h"
+#include "pb_cloud/proto_serializer.h"
+#include "pb_cloud/serializer_benchmark.pwpb.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_stream/memory_stream.h"
+#include "pw_unit_test/framework.h"
+
+namespace pb::cloud {
+namespace {
+
+using pw::chrono::SystemClock;
+
+constexpr int kIterations = 2000;
+
+// pw_protobuf generates each message as a namespace; ProtoSerializer takes
+// a type, so collect the generated names in one
+struct SensorReadingProto {
+  using Message = benchmark::pwpb::SensorReading::Message;
+  using MemoryEncoder = benchmark::pwpb::SensorReading::MemoryEncoder;
+  using StreamEncoder = benchmark::pwpb::SensorReading::StreamEncoder;
+  using StreamDecoder = benchmark::pwpb::SensorReading::StreamDecoder;
+  static constexpr size_t kMaxEncodedSizeBytes =
+      benchmark::pwpb::SensorReading::kMaxEncodedSizeBytes;
+};
+
+using ProtoCodec = ProtoSerializer<SensorReadingProto>;
+
+// Same fields as SensorReading
+struct SensorReading {
+  float temperature = 0;
+  float humidity = 0;
+  uint32_t pressure_pa = 0;
+  uint32_t battery_mv = 0;
+  uint64_t uptime_s = 0;
+  int32_t rssi = 0;
+  bool charging = false;
+
+  static constexpr auto kCborFields = CborFields(
+      CborField("temperature", &SensorReading::temperature),
+      CborField("humidity", &SensorReading::humidity),
+      CborField("pressure_pa", &SensorReading::pressure_pa),
+      CborField("battery_mv", &SensorReading::battery_mv),
+      CborField("uptime_s", &SensorReading::uptime_s),
+      CborField("rssi", &SensorReading::rssi),
+      CborField("charging", &SensorReading::charging));
+};
+
+using CborCodec = CborStructSerializer<SensorReading>;
+
+constexpr SensorReading kReading = {
+    .temperature = 21.5f,
+    .humidity = 48.25f,
+    .pressure_pa = 96350,
+    .battery_mv = 3912,
+    .uptime_s = 864123,
+    .rssi = -67,
+    .charging = true,
+};
+
+constexpr SensorReadingProto::Message kProtoReading = {
+    .temperature = kReading.temperature,
+    .humidity = kReading.humidity,
+    .pressure_pa = kReading.pressure_pa,
+    .battery_mv = kReading.battery_mv,
+    .uptime_s = kReading.uptime_s,
+    .rssi = kReading.rssi,
+    .charging = kReading.charging,
+};
+
+uint32_t ElapsedNsPerMessage(SystemClock::time_point start) {
+  const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           SystemClock::now() - start)
+                           .count();
+  return static_cast<uint32_t>(elapsed / kIterations);
+}
+
+TEST(SerializerBenchmark, Cbor) {
+  std::array<std::byte, 128> buffer{};
+  size_t size = 0;
+  auto start = SystemClock::now();
+  for (int i = 0; i < kIterations; ++i) {
+    auto result = CborCodec::Serialize(kReading, buffer);
+    ASSERT_TRUE(result.ok());
+    size = result.value();
+  }
+  const uint32_t encode_ns = ElapsedNsPerMessage(start);
+
+  const pw::ConstByteSpan data(buffer.data(), size);
+  SensorReading decoded;
+  start = SystemClock::now();
+  for (int i = 0; i < kIterations; ++i) {
+    auto result = CborCodec::Deserialize(data);
+    ASSERT_TRUE(result.ok());
+    decoded = result.value();
+  }
+  const uint32_t decode_ns = ElapsedNsPerMessage(start);
+
+  EXPECT_EQ(decoded.temperature, kReading.temperature);
+  EXPECT_EQ(decoded.uptime_s, kReading.uptime_s);
+  EXPECT_EQ(decoded.rssi, kReading.rssi);
+  EXPECT_EQ(decoded.charging, kReading.charging);
+  PW_LOG_INFO("cbor      %3u bytes  encode %6u ns  decode %6u ns",
+              static_cast<unsigned>(size), static_cast<unsigned>(encode_ns),
+              static_cast<unsigned>(decode_ns));
+}
+
+TEST(SerializerBenchmark, Protobuf) {
+  std::array<std::byte, ProtoCodec::kMaxEncodedSize> buffer{};
+  size_t size = 0;
+  auto start = SystemClock::now();
+  for (int i = 0; i < kIterations; ++i) {
+    auto result = ProtoCodec::Serialize(kProtoReading, buffer);
+    ASSERT_TRUE(result.ok());
+    size = result.value();
+  }
+  const uint32_t encode_ns = ElapsedNsPerMessage(start);
+
+  const pw::ConstByteSpan data(buffer.data(), size);
+  SensorReadingProto::Message decoded;
+  start = SystemClock::now();
+  for (int i = 0; i < kIterations; ++i) {
+    auto result = ProtoCodec::Deserialize(data);
+    ASSERT_TRUE(result.ok());
+    decoded = result.value();
+  }
+  const uint32_t decode_ns = ElapsedNsPerMessage(start);
+
+  EXPECT_EQ(decoded.temperature, kProtoReading.temperature);
+  EXPECT_EQ(decoded.uptime_s, kProtoReading.uptime_s);
+  EXPECT_EQ(decoded.rssi, kProtoReading.rssi);
+  EXPECT_EQ(decoded.charging, kProtoReading.charging);
+  PW_LOG_INFO("protobuf  %3u bytes  encode %6u ns  decode %6u ns",
+              static_cast<unsigned>(size), static_cast<unsigned>(encode_ns),
+              static_cast<unsigned>(decode_ns));
+}
+
+TEST(SerializerBenchmark, ProtobufStreamMatchesMemoryEncoding) {
+  std::array<std::byte, ProtoCodec::kMaxEncodedSize> memory{};
+  auto size = ProtoCodec::Serialize(kProtoReading, memory);
+  ASSERT_TRUE(size.ok());
+
+  std::array<std::byte, ProtoCodec::kMaxEncodedSize> streamed{};
+  pw::stream::MemoryWriter writer(streamed);
+  ASSERT_EQ(ProtoCodec::SerializeTo(kProtoReading, writer), pw::OkStatus());
+  ASSERT_EQ(writer.bytes_written(), size.value());
+  EXPECT_TRUE(std::equal(memory.begin(), memory.begin() + size.value(),
+                         streamed.begin()));
+}
+
+}  // namespace
+}  // namespace pb::cloud
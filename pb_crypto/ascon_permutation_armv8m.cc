@@ -0,0 +1,189 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+/// @file ascon_permutation_armv8m.cc
+/// @brief Bit-interleaved 32-bit ASCON permutation for Cortex-M33.
+///
+/// Drop-in replacement for the reference ascon_permutation() (see
+/// pb_crypto_ascon_armv8m in BUILD.bazel). Each 64-bit state word is split
+/// into its even and odd bits, so every 64-bit rotation becomes two 32-bit
+/// rotations, which the Thumb-2 barrel shifter folds into the EOR of the
+/// linear layer. That EOR-with-rotate is inline assembly on ARM; elsewhere
+/// the same interleaved code is plain C++, so host tests cover it too.
+///
+/// The reference AEAD and hash code keep the state non-interleaved, so the
+/// state is converted on entry and exit of each call.
+
+#include <array>
+#include <cstdint>
+
+#include "ascon.h"
+#include "pb_ramfunc/ramfunc.h"
+
+namespace {
+
+constexpr int kMaxRounds = 12;
+
+// A 64-bit state word as its even and odd bits
+struct Interleaved {
+  uint32_t even;
+  uint32_t odd;
+};
+
+constexpr uint32_t Compress(uint64_t value, unsigned first_bit) {
+  uint32_t half = 0;
+  for (unsigned i = 0; i < 32; ++i) {
+    half |= static_cast<uint32_t>((value >> (2 * i + first_bit)) & 1) << i;
+  }
+  return half;
+}
+
+constexpr std::array<Interleaved, kMaxRounds> MakeRoundConstants() {
+  std::array<Interleaved, kMaxRounds> constants{};
+  for (int i = 0; i < kMaxRounds; ++i) {
+    // Reference constants 0xf0, 0xe1, ..., 0x4b
+    const uint64_t constant = ((0xfu - i) << 4) | i;
+    constants[i] = {Compress(constant, 0), Compress(constant, 1)};
+  }
+  return constants;
+}
+
+// ASCON-p round constants, bit-interleaved
+constexpr std::array<Interleaved, kMaxRounds> kRoundConstants =
+    MakeRoundConstants();
+
+static_assert(kRoundConstants[0].even == 0xc &&
+              kRoundConstants[0].odd == 0xc);
+static_assert(kRoundConstants[11].even == 0x9 &&
+              kRoundConstants[11].odd == 0x3);
+
+// Move the even bits of a 32-bit word to its low half and the odd bits to
+// its high half, and back
+uint32_t Unzip(uint32_t x) {
+  uint32_t t;
+  t = (x ^ (x >> 1)) & 0x22222222;
+  x ^= t ^ (t << 1);
+  t = (x ^ (x >> 2)) & 0x0c0c0c0c;
+  x ^= t ^ (t << 2);
+  t = (x ^ (x >> 4)) & 0x00f000f0;
+  x ^= t ^ (t << 4);
+  t = (x ^ (x >> 8)) & 0x0000ff00;
+  x ^= t ^ (t << 8);
+  return x;
+}
+
+uint32_t Zip(uint32_t x) {
+  uint32_t t;
+  t = (x ^ (x >> 8)) & 0x0000ff00;
+  x ^= t ^ (t << 8);
+  t = (x ^ (x >> 4)) & 0x00f000f0;
+  x ^= t ^ (t << 4);
+  t = (x ^ (x >> 2)) & 0x0c0c0c0c;
+  x ^= t ^ (t << 2);
+  t = (x ^ (x >> 1)) & 0x22222222;
+  x ^= t ^ (t << 1);
+  return x;
+}
+
+Interleaved ToInterleaved(uint64_t word) {
+  const uint32_t low = Unzip(static_cast<uint32_t>(word));
+  const uint32_t high = Unzip(static_cast<uint32_t>(word >> 32));
+  return {(low & 0xffff) | (high << 16), (low >> 16) | (high & 0xffff0000)};
+}
+
+uint64_t FromInterleaved(Interleaved word) {
+  const uint32_t low = Zip((word.even & 0xffff) | (word.odd << 16));
+  const uint32_t high = Zip((word.even >> 16) | (word.odd & 0xffff0000));
+  return (static_cast<uint64_t>(high) << 32) | low;
+}
+
+// a ^ ror32(b, kShift)
+template <unsigned kShift>
+inline uint32_t EorRor(uint32_t a, uint32_t b) {
+  if constexpr (kShift == 0) {
+    return a ^ b;
+  } else {
+#if defined(__arm__) && defined(__thumb2__)
+    uint32_t result;
+    asm("eor %[result], %[a], %[b], ror %[shift]"
+        : [result] "=r"(result)
+        : [a] "r"(a), [b] "r"(b), [shift] "I"(kShift));
+    return result;
+#else
+    return a ^ ((b >> kShift) | (b << (32 - kShift)));
+#endif
+  }
+}
+
+// x ^= ror64(t, kRotation) for interleaved words
+template <unsigned kRotation>
+inline void EorRotated(Interleaved& x, Interleaved t) {
+  if constexpr (kRotation % 2 == 0) {
+    x.even = EorRor<kRotation / 2>(x.even, t.even);
+    x.odd = EorRor<kRotation / 2>(x.odd, t.odd);
+  } else {
+    x.even = EorRor<kRotation / 2>(x.even, t.odd);
+    x.odd = EorRor<kRotation / 2 + 1>(x.odd, t.even);
+  }
+}
+
+// x ^= ror64(x, kFirst + kSecond) ^ ror64(x, kSecond), as
+// x ^= ror64(x ^ ror64(x, kFirst), kSecond)
+template <unsigned kFirst, unsigned kSecond>
+inline void Diffuse(Interleaved& x) {
+  Interleaved t = x;
+  EorRotated<kFirst>(t, x);
+  EorRotated<kSecond>(x, t);
+}
+
+// S-box of the reference, on one half of every state word
+inline void Sbox(uint32_t& x0,
+                 uint32_t& x1,
+                 uint32_t& x2,
+                 uint32_t& x3,
+                 uint32_t& x4) {
+  x0 ^= x4;
+  x4 ^= x3;
+  x2 ^= x1;
+  const uint32_t t0 = x0 ^ (~x1 & x2);
+  const uint32_t t1 = x1 ^ (~x2 & x3);
+  const uint32_t t2 = x2 ^ (~x3 & x4);
+  const uint32_t t3 = x3 ^ (~x4 & x0);
+  const uint32_t t4 = x4 ^ (~x0 & x1);
+  x0 = t0 ^ t4;
+  x1 = t1 ^ t0;
+  x2 = ~t2;
+  x3 = t3 ^ t2;
+  x4 = t4;
+}
+
+}  // namespace
+
+// Hot in every AEAD and hash block; runs from SRAM
+extern "C" PB_RAMFUNC void ascon_permutation(ascon_state_t* state,
+                                             int rounds) {
+  Interleaved x0 = ToInterleaved(state->x[0]);
+  Interleaved x1 = ToInterleaved(state->x[1]);
+  Interleaved x2 = ToInterleaved(state->x[2]);
+  Interleaved x3 = ToInterleaved(state->x[3]);
+  Interleaved x4 = ToInterleaved(state->x[4]);
+
+  for (int i = kMaxRounds - rounds; i < kMaxRounds; ++i) {
+    x2.even ^= kRoundConstants[i].even;
+    x2.odd ^= kRoundConstants[i].odd;
+    Sbox(x0.even, x1.even, x2.even, x3.even, x4.even);
+    Sbox(x0.odd, x1.odd, x2.odd, x3.odd, x4.odd);
+    // Rotations (19, 28), (61, 39), (1, 6), (10, 17), (7, 41)
+    Diffuse<9, 19>(x0);
+    Diffuse<22, 39>(x1);
+    Diffuse<5, 1>(x2);
+    Diffuse<7, 10>(x3);
+    Diffuse<34, 7>(x4);
+  }
+
+  state->x[0] = FromInterleaved(x0);
+  state->x[1] = FromInterleaved(x1);
+  state->x[2] = FromInterleaved(x2);
+  state->x[3] = FromInterleaved(x3);
+  state->x[4] = FromInterleaved(x4);
+}
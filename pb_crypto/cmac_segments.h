@@ -0,0 +1,85 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file cmac_segments.h
+/// @brief CMAC block walk over scatter-gather segments, shared by the AES
+/// backends.
+///
+/// The backends differ only in how they chain full blocks (mbedTLS ECB or
+/// the crypto engine); splitting the concatenated segments into chained
+/// blocks and the padded last block is the same for all of them.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#include "pb_crypto/pb_crypto.h"
+#include "pw_bytes/span.h"
+#include "pw_status/status.h"
+#include "pw_status/try.h"
+
+namespace pb::crypto::internal {
+
+using CmacBlock = std::array<std::byte, kAesBlockSize>;
+
+/// Pass every block but the last of the concatenated `segments` to
+/// `chain`, as runs of whole blocks taken directly from a segment where
+/// possible, and return the last block in `last`: XORed with K1 if
+/// complete, or padded with 10* and XORed with K2.
+///
+/// @param chain Callable `pw::Status(pw::ConstByteSpan blocks)`
+template <typename Chain>
+pw::Status WalkCmacBlocks(ByteSegments segments,
+                          const CmacBlock& k1,
+                          const CmacBlock& k2,
+                          Chain&& chain,
+                          CmacBlock& last) {
+  size_t total = 0;
+  for (pw::ConstByteSpan segment : segments) {
+    total += segment.size();
+  }
+  const size_t chained =
+      total == 0 ? 0 : (total - 1) / kAesBlockSize * kAesBlockSize;
+
+  // Bytes of a block split across segments, then the last block
+  CmacBlock pending{};
+  size_t pending_size = 0;
+  size_t done = 0;
+  for (pw::ConstByteSpan rest : segments) {
+    while (!rest.empty() && done < chained) {
+      if (pending_size == 0 && rest.size() >= kAesBlockSize) {
+        const size_t run = std::min(rest.size(), chained - done) /
+                           kAesBlockSize * kAesBlockSize;
+        PW_TRY(chain(rest.first(run)));
+        rest = rest.subspan(run);
+        done += run;
+        continue;
+      }
+      const size_t take = std::min(kAesBlockSize - pending_size, rest.size());
+      std::copy_n(rest.begin(), take, pending.begin() + pending_size);
+      pending_size += take;
+      done += take;
+      rest = rest.subspan(take);
+      if (pending_size == kAesBlockSize) {
+        PW_TRY(chain(pending));
+        pending_size = 0;
+      }
+    }
+    std::copy(rest.begin(), rest.end(), pending.begin() + pending_size);
+    pending_size += rest.size();
+  }
+
+  const CmacBlock& subkey = pending_size == kAesBlockSize ? k1 : k2;
+  for (size_t i = 0; i < kAesBlockSize; ++i) {
+    const std::byte block = i < pending_size    ? pending[i]
+                            : i == pending_size ? std::byte{0x80}
+                                                : std::byte{0};
+    last[i] = block ^ subkey[i];
+  }
+  std::fill(pending.begin(), pending.end(), std::byte{0});
+  return pw::OkStatus();
+}
+
+}  // namespace pb::crypto::internal
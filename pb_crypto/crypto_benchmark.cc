@@ -0,0 +1,205 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#define PW_LOG_MODULE_NAME "crypto_bench"
+
+#include "crypto_benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_status/try.h"
+
+namespace pb::crypto::benchmark {
+namespace {
+
+using pw::chrono::SystemClock;
+
+#if defined(__arm__)
+
+// DWT cycle counter (ARMv8-M)
+constexpr uintptr_t kDemcr = 0xE000EDFC;
+constexpr uintptr_t kDwtCtrl = 0xE0001000;
+constexpr uintptr_t kDwtCyccnt = 0xE0001004;
+
+volatile uint32_t& Register(uintptr_t address) {
+  // NOLINTNEXTLINE(performance-no-int-to-ptr)
+  return *reinterpret_cast<volatile uint32_t*>(address);
+}
+
+void StartCycleCounter() {
+  Register(kDemcr) = Register(kDemcr) | (1u << 24);  // TRCENA
+  Register(kDwtCtrl) = Register(kDwtCtrl) | 1u;      // CYCCNTENA
+}
+
+uint32_t Cycles() { return Register(kDwtCyccnt); }
+
+#else
+
+void StartCycleCounter() {}
+
+uint32_t Cycles() { return 0; }
+
+#endif  // defined(__arm__)
+
+constexpr std::array<std::byte, kAesKeySize> kKey = {
+    std::byte{0x2b}, std::byte{0x7e}, std::byte{0x15}, std::byte{0x16},
+    std::byte{0x28}, std::byte{0xae}, std::byte{0xd2}, std::byte{0xa6},
+    std::byte{0xab}, std::byte{0xf7}, std::byte{0x15}, std::byte{0x88},
+    std::byte{0x09}, std::byte{0xcf}, std::byte{0x4f}, std::byte{0x3c}};
+constexpr std::array<std::byte, kAesBlockSize> kIv{};
+constexpr std::array<std::byte, kAsconNonceSize> kNonce{};
+constexpr std::array<std::byte, kAesGcmNonceSize> kGcmNonce{};
+
+bool IsAes(Operation operation) {
+  return operation == Operation::kAesCbcEncrypt ||
+         operation == Operation::kAesCbcDecrypt ||
+         operation == Operation::kAesCmac ||
+         operation == Operation::kAesGcmEncrypt ||
+         operation == Operation::kAesGcmDecrypt;
+}
+
+// Keys and the AEAD tag, set up outside the timed loop
+struct Context {
+  AesKey aes;
+  CmacKey cmac;
+  std::array<std::byte, kAsconTagSize> tag{};
+  std::array<std::byte, kAsconHashSize> hash{};
+};
+
+pw::Status RunOnce(Operation operation,
+                   Context& context,
+                   pw::ConstByteSpan input,
+                   pw::ByteSpan output) {
+  switch (operation) {
+    case Operation::kAesCbcEncrypt:
+      return context.aes.CbcEncrypt(kIv, input, output);
+    case Operation::kAesCbcDecrypt:
+      return context.aes.CbcDecrypt(kIv, input, output);
+    case Operation::kAesCmac:
+      return context.cmac.Compute(input, context.hash);
+    case Operation::kAesGcmEncrypt:
+      return AesGcmEncrypt(kKey, kGcmNonce, {}, input, output, context.tag);
+    case Operation::kAesGcmDecrypt:
+      return AesGcmDecrypt(kKey, kGcmNonce, {}, input, context.tag, output);
+    case Operation::kAsconAead128Encrypt:
+      return AsconAead128Encrypt(kKey, kNonce, {}, input, output, context.tag);
+    case Operation::kAsconAead128Decrypt:
+      return AsconAead128Decrypt(kKey, kNonce, {}, input, context.tag, output);
+    case Operation::kAsconHash256:
+      return AsconHash256(input, context.hash);
+  }
+  return pw::Status::InvalidArgument();
+}
+
+}  // namespace
+
+std::string_view OperationName(Operation operation) {
+  switch (operation) {
+    case Operation::kAesCbcEncrypt:
+      return "aes_cbc_encrypt";
+    case Operation::kAesCbcDecrypt:
+      return "aes_cbc_decrypt";
+    case Operation::kAesCmac:
+      return "aes_cmac";
+    case Operation::kAesGcmEncrypt:
+      return "aes_gcm_encrypt";
+    case Operation::kAesGcmDecrypt:
+      return "aes_gcm_decrypt";
+    case Operation::kAsconAead128Encrypt:
+      return "ascon_aead128_encrypt";
+    case Operation::kAsconAead128Decrypt:
+      return "ascon_aead128_decrypt";
+    case Operation::kAsconHash256:
+      return "ascon_hash256";
+  }
+  return "unknown";
+}
+
+bool HasCycleCounter() {
+#if defined(__arm__)
+  return true;
+#else
+  return false;
+#endif
+}
+
+pw::Result<Sample> Measure(Operation operation,
+                           size_t payload_size,
+                           Scratch& scratch) {
+  if (payload_size == 0 || payload_size % kAesBlockSize != 0 ||
+      payload_size > scratch.input.size()) {
+    return pw::Status::InvalidArgument();
+  }
+  const pw::ConstByteSpan input =
+      pw::ConstByteSpan(scratch.input).first(payload_size);
+  const pw::ByteSpan output = pw::ByteSpan(scratch.output).first(payload_size);
+
+  Context context;
+  PW_TRY(context.aes.SetKey(kKey));
+  PW_TRY(context.cmac.SetKey(kKey));
+  // Decrypt a valid ciphertext, so every iteration checks the full tag
+  if (operation == Operation::kAesGcmDecrypt) {
+    PW_TRY(AesGcmEncrypt(kKey, kGcmNonce, {}, input, output, context.tag));
+    std::copy(output.begin(), output.end(), scratch.input.begin());
+  } else if (operation == Operation::kAsconAead128Decrypt) {
+    PW_TRY(AsconAead128Encrypt(kKey, kNonce, {}, input, output, context.tag));
+    std::copy(output.begin(), output.end(), scratch.input.begin());
+  }
+
+  StartCycleCounter();
+  Sample sample{.operation = operation, .payload_size = payload_size};
+  uint64_t cycles = 0;
+  const auto start = SystemClock::now();
+  auto elapsed = SystemClock::duration::zero();
+  while (sample.iterations < kMinIterations ||
+         elapsed < std::chrono::milliseconds(kMinDurationMs)) {
+    const uint32_t cycles_start = Cycles();
+    PW_TRY(RunOnce(operation, context, input, output));
+    cycles += Cycles() - cycles_start;
+    ++sample.iterations;
+    elapsed = SystemClock::now() - start;
+  }
+
+  const uint64_t elapsed_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+  sample.cycles_per_op = static_cast<uint32_t>(cycles / sample.iterations);
+  sample.elapsed_us = static_cast<uint32_t>(elapsed_us);
+  sample.bytes_per_s = static_cast<uint32_t>(
+      uint64_t{payload_size} * sample.iterations * 1'000'000 / elapsed_us);
+  return sample;
+}
+
+pw::Status RunAndLog(const Implementation& implementation,
+                     Scratch& scratch,
+                     pw::span<const Operation> operations) {
+  PW_LOG_INFO("Crypto benchmark, AES %.*s, ASCON %.*s, cycle counter %s",
+              static_cast<int>(implementation.aes.size()),
+              implementation.aes.data(),
+              static_cast<int>(implementation.ascon.size()),
+              implementation.ascon.data(),
+              HasCycleCounter() ? "on" : "off");
+  for (Operation operation : operations) {
+    const std::string_view name = OperationName(operation);
+    const std::string_view impl =
+        IsAes(operation) ? implementation.aes : implementation.ascon;
+    for (size_t size : kPayloadSizes) {
+      PW_TRY_ASSIGN(const Sample sample, Measure(operation, size, scratch));
+      PW_LOG_INFO(
+          "crypto_bench op=%.*s impl=%.*s size=%u iterations=%u "
+          "cycles_per_op=%u elapsed_us=%u bytes_per_s=%u",
+          static_cast<int>(name.size()), name.data(),
+          static_cast<int>(impl.size()), impl.data(),
+          static_cast<unsigned>(sample.payload_size),
+          static_cast<unsigned>(sample.iterations),
+          static_cast<unsigned>(sample.cycles_per_op),
+          static_cast<unsigned>(sample.elapsed_us),
+          static_cast<unsigned>(sample.bytes_per_s));
+    }
+  }
+  return pw::OkStatus();
+}
+
+}  // namespace pb::crypto::benchmark
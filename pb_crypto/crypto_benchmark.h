@@ -0,0 +1,108 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file crypto_benchmark.h
+/// @brief Throughput and cycle counts of the pb_crypto operations.
+///
+/// Compiled into crypto_benchmark_test (host, checks that every operation
+/// can be measured) and the pb_crypto_benchmark*_device_test targets (P2,
+/// for the numbers) rather than being a library, since each of them links
+/// a different pb_crypto backend. Each sample is logged as one
+/// `crypto_bench key=value ...` line, so a harness reading the device log
+/// can collect them.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "pb_crypto/pb_crypto.h"
+#include "pw_result/result.h"
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+
+namespace pb::crypto::benchmark {
+
+/// Payload sizes swept for every operation (multiples of the AES block).
+inline constexpr std::array<size_t, 5> kPayloadSizes = {16, 64, 256, 1024,
+                                                        2048};
+
+/// An operation is repeated at least this often and for at least
+/// kMinDurationMs, so the 1 ms system clock on device is accurate enough.
+inline constexpr uint32_t kMinIterations = 8;
+inline constexpr uint32_t kMinDurationMs = 100;
+
+enum class Operation {
+  kAesCbcEncrypt,
+  kAesCbcDecrypt,
+  kAesCmac,
+  kAesGcmEncrypt,
+  kAesGcmDecrypt,
+  kAsconAead128Encrypt,
+  kAsconAead128Decrypt,
+  kAsconHash256,
+};
+
+inline constexpr std::array<Operation, 8> kAllOperations = {
+    Operation::kAesCbcEncrypt,        Operation::kAesCbcDecrypt,
+    Operation::kAesCmac,              Operation::kAesGcmEncrypt,
+    Operation::kAesGcmDecrypt,        Operation::kAsconAead128Encrypt,
+    Operation::kAsconAead128Decrypt, Operation::kAsconHash256,
+};
+
+inline constexpr std::array<Operation, 5> kAesOperations = {
+    Operation::kAesCbcEncrypt, Operation::kAesCbcDecrypt,
+    Operation::kAesCmac,       Operation::kAesGcmEncrypt,
+    Operation::kAesGcmDecrypt,
+};
+
+/// Name used in the log, e.g. "aes_cbc_encrypt".
+std::string_view OperationName(Operation operation);
+
+/// Backend names reported with the samples, e.g. {"mbedtls", "reference"}.
+struct Implementation {
+  std::string_view aes;
+  std::string_view ascon;
+};
+
+/// True if cycles are counted (DWT on Cortex-M); on host
+/// `Sample::cycles_per_op` is 0.
+bool HasCycleCounter();
+
+/// Buffers for the largest payload. Too large for a thread stack on
+/// device; make it static.
+struct Scratch {
+  std::array<std::byte, kPayloadSizes.back()> input;
+  std::array<std::byte, kPayloadSizes.back()> output;
+};
+
+/// One operation on one payload size.
+struct Sample {
+  Operation operation = Operation::kAesCbcEncrypt;
+  size_t payload_size = 0;
+  uint32_t iterations = 0;     // Repetitions measured
+  uint32_t cycles_per_op = 0;  // Average CPU cycles, 0 without counter
+  uint32_t elapsed_us = 0;     // Total time of all repetitions
+  uint32_t bytes_per_s = 0;    // Payload throughput
+};
+
+/// Measure `operation` on `payload_size` bytes. Keys are set up once, so
+/// AES timings exclude the key expansion.
+///
+/// @return The sample, InvalidArgument if `payload_size` is not a
+///         multiple of kAesBlockSize or larger than the scratch buffers,
+///         or the operation's error
+pw::Result<Sample> Measure(Operation operation,
+                           size_t payload_size,
+                           Scratch& scratch);
+
+/// Measure `operations` over kPayloadSizes and log one line per sample.
+///
+/// @return OkStatus, or the first measurement error
+pw::Status RunAndLog(const Implementation& implementation,
+                     Scratch& scratch,
+                     pw::span<const Operation> operations = kAllOperations);
+
+}  // namespace pb::crypto::benchmark
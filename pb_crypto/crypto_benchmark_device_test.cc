@@ -0,0 +1,35 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+/// @file crypto_benchmark_device_test.cc
+/// @brief pb_crypto throughput and cycle report on P2.
+///
+/// Flash this to a P2 device and collect the `crypto_bench` lines from the
+/// log.
+
+#define PW_LOG_MODULE_NAME "crypto_bench"
+
+#include "crypto_benchmark.h"
+#include "pw_log/log.h"
+#include "pw_unit_test/framework.h"
+
+#ifndef PB_CRYPTO_ASCON_ARMV8M
+#define PB_CRYPTO_ASCON_ARMV8M 0
+#endif
+
+namespace {
+
+using namespace pb::crypto::benchmark;
+
+constexpr std::string_view kAscon =
+    PB_CRYPTO_ASCON_ARMV8M ? "armv8m" : "reference";
+
+// Too large for the test thread's stack
+Scratch scratch;
+
+TEST(CryptoBenchmarkDevice, Report) {
+  EXPECT_EQ(RunAndLog({.aes = "mbedtls", .ascon = kAscon}, scratch),
+            pw::OkStatus());
+}
+
+}  // namespace
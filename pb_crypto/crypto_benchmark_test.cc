@@ -0,0 +1,43 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "crypto_benchmark.h"
+
+#include "pw_unit_test/framework.h"
+
+namespace pb::crypto::benchmark {
+namespace {
+
+Scratch scratch;
+
+TEST(CryptoBenchmark, MeasuresEveryOperation) {
+  for (Operation operation : kAllOperations) {
+    auto sample = Measure(operation, kPayloadSizes.front(), scratch);
+    ASSERT_TRUE(sample.ok()) << OperationName(operation).data();
+    EXPECT_EQ(sample.value().payload_size, kPayloadSizes.front());
+    EXPECT_GE(sample.value().iterations, kMinIterations);
+    EXPECT_GE(sample.value().elapsed_us, kMinDurationMs * 1000);
+    EXPECT_GT(sample.value().bytes_per_s, 0u);
+    EXPECT_EQ(sample.value().cycles_per_op == 0, !HasCycleCounter());
+  }
+}
+
+TEST(CryptoBenchmark, RejectsInvalidSizes) {
+  EXPECT_EQ(Measure(Operation::kAesCbcEncrypt, 0, scratch).status(),
+            pw::Status::InvalidArgument());
+  EXPECT_EQ(Measure(Operation::kAesCbcEncrypt, 17, scratch).status(),
+            pw::Status::InvalidArgument());
+  EXPECT_EQ(Measure(Operation::kAsconHash256, scratch.input.size() + 16,
+                    scratch)
+                .status(),
+            pw::Status::InvalidArgument());
+}
+
+TEST(CryptoBenchmark, RunAndLog) {
+  EXPECT_EQ(RunAndLog({.aes = "mbedtls", .ascon = "reference"}, scratch,
+                      kAesOperations),
+            pw::OkStatus());
+}
+
+}  // namespace
+}  // namespace pb::crypto::benchmark
@@ -0,0 +1,18 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file hardware_random.h
+/// @brief Entropy source of each AES backend, for the NonceGenerator DRBG.
+
+#include "pw_bytes/span.h"
+#include "pw_status/status.h"
+
+namespace pb::crypto::internal {
+
+/// Fill `output` from the platform's RNG: HAL_RNG_GetRandomNumber() on the
+/// P2, std::random_device on host.
+pw::Status FillHardwareRandom(pw::ByteSpan output);
+
+}  // namespace pb::crypto::internal
@@ -3,14 +3,44 @@
 
 /// @file pb_crypto_ascon.cc
 /// @brief ASCON implementation using the portable reference library.
+///
+/// The one-shot functions call the library directly. The incremental
+/// classes run the same sponge over ascon_permutation(), keeping a partial
+/// rate block in the state itself, so chunks of any size cost no buffer.
 
 #include "pb_crypto/pb_crypto.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "ascon.h"
+#include "pw_status/try.h"
 
 namespace pb::crypto {
+namespace {
+
+// Decryption through AsconAead128Decryptor, which handles plaintext ==
+// ciphertext and segmented associated data. Zeroes the plaintext on failure.
+pw::Status DecryptIncremental(pw::ConstByteSpan key,
+                              pw::ConstByteSpan nonce,
+                              ByteSegments associated_data,
+                              pw::ConstByteSpan ciphertext,
+                              pw::ConstByteSpan tag,
+                              pw::ByteSpan plaintext) {
+  AsconAead128Decryptor decryptor;
+  PW_TRY(decryptor.Start(key, nonce));
+  for (pw::ConstByteSpan segment : associated_data) {
+    PW_TRY(decryptor.UpdateAssociatedData(segment));
+  }
+  PW_TRY(decryptor.Update(ciphertext, plaintext));
+  pw::Status status = decryptor.Finish(tag);
+  if (!status.ok()) {
+    std::memset(plaintext.data(), 0, ciphertext.size());
+  }
+  return status;
+}
+
+}  // namespace
 
 pw::Status AsconAead128Encrypt(pw::ConstByteSpan key,
                                pw::ConstByteSpan nonce,
@@ -30,6 +60,11 @@ pw::Status AsconAead128Encrypt(pw::ConstByteSpan key,
   if (tag.size() < kAsconTagSize) {
     return pw::Status::ResourceExhausted();
   }
+  // The reference encryption reads each block before writing it, so
+  // ciphertext == plaintext works
+  if (internal::PartiallyOverlaps(plaintext, ciphertext)) {
+    return pw::Status::InvalidArgument();
+  }
 
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
   const auto* key_ptr = reinterpret_cast<const uint8_t*>(key.data());
@@ -74,6 +109,15 @@ pw::Status AsconAead128Decrypt(pw::ConstByteSpan key,
   if (plaintext.size() < ciphertext.size()) {
     return pw::Status::ResourceExhausted();
   }
+  if (internal::PartiallyOverlaps(ciphertext, plaintext)) {
+    return pw::Status::InvalidArgument();
+  }
+  // The reference decryption re-reads the last partial block after writing
+  // it; in place goes through the incremental decryptor instead
+  if (ciphertext.data() == plaintext.data()) {
+    return DecryptIncremental(key, nonce, ByteSegments(&associated_data, 1),
+                              ciphertext, tag, plaintext);
+  }
 
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
   const auto* key_ptr = reinterpret_cast<const uint8_t*>(key.data());
@@ -119,4 +163,275 @@ pw::Status AsconHash256(pw::ConstByteSpan message, pw::ByteSpan hash) {
   return pw::OkStatus();
 }
 
+pw::Status AsconAead128EncryptSegments(pw::ConstByteSpan key,
+                                       pw::ConstByteSpan nonce,
+                                       ByteSegments associated_data,
+                                       pw::ConstByteSpan plaintext,
+                                       pw::ByteSpan ciphertext,
+                                       pw::ByteSpan tag) {
+  AsconAead128Encryptor encryptor;
+  PW_TRY(encryptor.Start(key, nonce));
+  if (tag.size() < kAsconTagSize) {
+    return pw::Status::ResourceExhausted();
+  }
+  for (pw::ConstByteSpan segment : associated_data) {
+    PW_TRY(encryptor.UpdateAssociatedData(segment));
+  }
+  PW_TRY(encryptor.Update(plaintext, ciphertext));
+  return encryptor.Finish(tag);
+}
+
+pw::Status AsconAead128DecryptSegments(pw::ConstByteSpan key,
+                                       pw::ConstByteSpan nonce,
+                                       ByteSegments associated_data,
+                                       pw::ConstByteSpan ciphertext,
+                                       pw::ConstByteSpan tag,
+                                       pw::ByteSpan plaintext) {
+  if (key.size() != kAsconKeySize || nonce.size() != kAsconNonceSize ||
+      tag.size() != kAsconTagSize) {
+    return pw::Status::InvalidArgument();
+  }
+  if (plaintext.size() < ciphertext.size()) {
+    return pw::Status::ResourceExhausted();
+  }
+  if (internal::PartiallyOverlaps(ciphertext, plaintext)) {
+    return pw::Status::InvalidArgument();
+  }
+  return DecryptIncremental(key, nonce, associated_data, ciphertext, tag,
+                            plaintext);
+}
+
+// -- Incremental ASCON --
+
+namespace {
+
+constexpr size_t kRate = 8;
+constexpr uint64_t kAeadIv = 0x80400c0600000000ULL;
+constexpr uint64_t kHashIv = 0x00400c0000000100ULL;
+constexpr int kRoundsA = 12;
+constexpr int kRoundsB = 6;
+
+static_assert(sizeof(ascon_state_t) == sizeof(std::array<uint64_t, 5>));
+
+void Permute(std::array<uint64_t, 5>& state, int rounds) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  ascon_permutation(reinterpret_cast<ascon_state_t*>(state.data()), rounds);
+}
+
+uint64_t Load64(const std::byte* bytes) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < kRate; ++i) {
+    value = (value << 8) | static_cast<uint8_t>(bytes[i]);
+  }
+  return value;
+}
+
+void Store64(std::byte* bytes, uint64_t value) {
+  for (size_t i = 0; i < kRate; ++i) {
+    bytes[i] = static_cast<std::byte>(value >> (56 - 8 * i));
+  }
+}
+
+// Shift of rate byte `position` within the big-endian state word
+constexpr unsigned Shift(size_t position) {
+  return 56 - 8 * static_cast<unsigned>(position);
+}
+
+void Pad(uint64_t& word, size_t position) {
+  word ^= uint64_t{0x80} << Shift(position);
+}
+
+// Absorb `data` into the rate, permuting after each full block
+void Absorb(std::array<uint64_t, 5>& state,
+            size_t& position,
+            pw::ConstByteSpan data,
+            int rounds) {
+  size_t i = 0;
+  for (; i < data.size() && position != 0; ++i) {
+    state[0] ^= uint64_t{static_cast<uint8_t>(data[i])} << Shift(position);
+    if (++position == kRate) {
+      Permute(state, rounds);
+      position = 0;
+    }
+  }
+  for (; i + kRate <= data.size(); i += kRate) {
+    state[0] ^= Load64(&data[i]);
+    Permute(state, rounds);
+  }
+  for (; i < data.size(); ++i) {
+    state[0] ^= uint64_t{static_cast<uint8_t>(data[i])} << Shift(position++);
+  }
+}
+
+template <size_t kSize>
+void WipeWords(std::array<uint64_t, kSize>& words) {
+  SecureZero(pw::as_writable_bytes(pw::span(words)));
+}
+
+}  // namespace
+
+namespace internal {
+
+AsconAeadState::~AsconAeadState() { Wipe(); }
+
+void AsconAeadState::Wipe() {
+  WipeWords(state_);
+  WipeWords(key_);
+  position_ = 0;
+  has_associated_data_ = false;
+  phase_ = Phase::kIdle;
+}
+
+pw::Status AsconAeadState::Start(pw::ConstByteSpan key,
+                                 pw::ConstByteSpan nonce) {
+  Wipe();
+  if (key.size() != kAsconKeySize || nonce.size() != kAsconNonceSize) {
+    return pw::Status::InvalidArgument();
+  }
+  key_ = {Load64(&key[0]), Load64(&key[kRate])};
+  state_ = {kAeadIv, key_[0], key_[1], Load64(&nonce[0]),
+            Load64(&nonce[kRate])};
+  Permute(state_, kRoundsA);
+  state_[3] ^= key_[0];
+  state_[4] ^= key_[1];
+  phase_ = Phase::kAssociatedData;
+  return pw::OkStatus();
+}
+
+pw::Status AsconAeadState::AbsorbAssociatedData(
+    pw::ConstByteSpan associated_data) {
+  if (phase_ != Phase::kAssociatedData) {
+    return pw::Status::FailedPrecondition();
+  }
+  if (!associated_data.empty()) {
+    has_associated_data_ = true;
+    Absorb(state_, position_, associated_data, kRoundsB);
+  }
+  return pw::OkStatus();
+}
+
+void AsconAeadState::StartData() {
+  // Associated data is padded only if there was any
+  if (has_associated_data_) {
+    Pad(state_[0], position_);
+    Permute(state_, kRoundsB);
+    position_ = 0;
+  }
+  state_[4] ^= 1;  // Domain separation
+  phase_ = Phase::kData;
+}
+
+pw::Status AsconAeadState::Crypt(bool decrypt,
+                                 pw::ConstByteSpan input,
+                                 pw::ByteSpan output) {
+  if (phase_ == Phase::kIdle) {
+    return pw::Status::FailedPrecondition();
+  }
+  if (output.size() < input.size()) {
+    return pw::Status::ResourceExhausted();
+  }
+  if (PartiallyOverlaps(input, output)) {
+    return pw::Status::InvalidArgument();
+  }
+  if (phase_ == Phase::kAssociatedData) {
+    StartData();
+  }
+
+  // Byte by byte up to a block boundary, then whole blocks, then the rest.
+  // Each input byte is read before its output byte is written.
+  const auto crypt_byte = [&](size_t i) {
+    const unsigned shift = Shift(position_);
+    const auto in = uint64_t{static_cast<uint8_t>(input[i])};
+    const uint64_t out = ((state_[0] >> shift) & 0xff) ^ in;
+    state_[0] ^= (decrypt ? out : in) << shift;
+    output[i] = static_cast<std::byte>(out);
+  };
+  size_t i = 0;
+  for (; i < input.size() && position_ != 0; ++i) {
+    crypt_byte(i);
+    if (++position_ == kRate) {
+      Permute(state_, kRoundsB);
+      position_ = 0;
+    }
+  }
+  for (; i + kRate <= input.size(); i += kRate) {
+    const uint64_t in = Load64(&input[i]);
+    Store64(&output[i], state_[0] ^ in);
+    state_[0] = decrypt ? in : state_[0] ^ in;
+    Permute(state_, kRoundsB);
+  }
+  for (; i < input.size(); ++i) {
+    crypt_byte(i);
+    ++position_;
+  }
+  return pw::OkStatus();
+}
+
+pw::Status AsconAeadState::Finish(std::array<std::byte, kAsconTagSize>& tag) {
+  if (phase_ == Phase::kIdle) {
+    return pw::Status::FailedPrecondition();
+  }
+  if (phase_ == Phase::kAssociatedData) {
+    StartData();
+  }
+  Pad(state_[0], position_);
+  state_[1] ^= key_[0];
+  state_[2] ^= key_[1];
+  Permute(state_, kRoundsA);
+  Store64(&tag[0], state_[3] ^ key_[0]);
+  Store64(&tag[kRate], state_[4] ^ key_[1]);
+  Wipe();
+  return pw::OkStatus();
+}
+
+}  // namespace internal
+
+pw::Status AsconAead128Encryptor::Finish(pw::ByteSpan tag) {
+  if (tag.size() < kAsconTagSize) {
+    return pw::Status::ResourceExhausted();
+  }
+  std::array<std::byte, kAsconTagSize> computed;
+  PW_TRY(state_.Finish(computed));
+  std::copy(computed.begin(), computed.end(), tag.begin());
+  return pw::OkStatus();
+}
+
+pw::Status AsconAead128Decryptor::Finish(pw::ConstByteSpan tag) {
+  if (tag.size() != kAsconTagSize) {
+    return pw::Status::InvalidArgument();
+  }
+  std::array<std::byte, kAsconTagSize> computed;
+  PW_TRY(state_.Finish(computed));
+  return ConstantTimeEqual(computed, tag) ? pw::OkStatus()
+                                         : pw::Status::Unauthenticated();
+}
+
+AsconHash256Hasher::AsconHash256Hasher() { Reset(); }
+
+void AsconHash256Hasher::Reset() {
+  state_ = {kHashIv, 0, 0, 0, 0};
+  Permute(state_, kRoundsA);
+  position_ = 0;
+}
+
+void AsconHash256Hasher::Update(pw::ConstByteSpan data) {
+  Absorb(state_, position_, data, kRoundsA);
+}
+
+pw::Status AsconHash256Hasher::Finish(pw::ByteSpan hash) {
+  if (hash.size() < kAsconHashSize) {
+    return pw::Status::ResourceExhausted();
+  }
+  Pad(state_[0], position_);
+  Permute(state_, kRoundsA);
+  for (size_t offset = 0; offset < kAsconHashSize; offset += kRate) {
+    if (offset != 0) {
+      Permute(state_, kRoundsA);
+    }
+    Store64(&hash[offset], state_[0]);
+  }
+  Reset();
+  return pw::OkStatus();
+}
+
 }  // namespace pb::crypto
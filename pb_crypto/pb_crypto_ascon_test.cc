@@ -3,6 +3,7 @@
 
 #include "pb_crypto/pb_crypto.h"
 
+#include <algorithm>
 #include <array>
 #include <cstring>
 
@@ -264,5 +265,266 @@ TEST(AsconHash256Test, HashBufferTooSmall) {
   EXPECT_EQ(AsconHash256(kMessage, small_hash), pw::Status::ResourceExhausted());
 }
 
+// Incremental API: chunked processing must match the one-shot functions
+
+constexpr auto kStreamKey = pw::bytes::Array<
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f>();
+
+constexpr auto kStreamNonce = pw::bytes::Array<
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+    0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f>();
+
+template <size_t kSize>
+std::array<std::byte, kSize> Pattern(uint8_t seed) {
+  std::array<std::byte, kSize> data;
+  for (size_t i = 0; i < kSize; ++i) {
+    data[i] = static_cast<std::byte>(seed + i * 7);
+  }
+  return data;
+}
+
+TEST(AsconStreamTest, EncryptorMatchesOneShotForAnyChunking) {
+  const auto plaintext = Pattern<61>(1);
+  for (size_t ad_size : {size_t{0}, size_t{5}, size_t{8}, size_t{19}}) {
+    const auto ad_data = Pattern<19>(100);
+    const pw::ConstByteSpan ad = pw::ConstByteSpan(ad_data).first(ad_size);
+    std::array<std::byte, plaintext.size()> expected{};
+    std::array<std::byte, kAsconTagSize> expected_tag{};
+    ASSERT_EQ(AsconAead128Encrypt(kStreamKey, kStreamNonce, ad, plaintext,
+                                  expected, expected_tag),
+              pw::OkStatus());
+
+    for (size_t chunk : {size_t{1}, size_t{3}, size_t{8}, size_t{13}}) {
+      AsconAead128Encryptor encryptor;
+      ASSERT_EQ(encryptor.Start(kStreamKey, kStreamNonce), pw::OkStatus());
+      for (size_t i = 0; i < ad.size(); i += chunk) {
+        ASSERT_EQ(encryptor.UpdateAssociatedData(
+                      ad.subspan(i, std::min(chunk, ad.size() - i))),
+                  pw::OkStatus());
+      }
+      std::array<std::byte, plaintext.size()> ciphertext{};
+      for (size_t i = 0; i < plaintext.size(); i += chunk) {
+        const size_t size = std::min(chunk, plaintext.size() - i);
+        ASSERT_EQ(encryptor.Update(pw::ConstByteSpan(plaintext).subspan(i, size),
+                                   pw::ByteSpan(ciphertext).subspan(i)),
+                  pw::OkStatus());
+      }
+      std::array<std::byte, kAsconTagSize> tag{};
+      ASSERT_EQ(encryptor.Finish(tag), pw::OkStatus());
+
+      EXPECT_EQ(std::memcmp(ciphertext.data(), expected.data(),
+                            expected.size()),
+                0);
+      EXPECT_EQ(std::memcmp(tag.data(), expected_tag.data(), kAsconTagSize),
+                0);
+    }
+  }
+}
+
+TEST(AsconStreamTest, DecryptorVerifiesOneShotOutput) {
+  const auto plaintext = Pattern<40>(3);
+  const auto ad = Pattern<7>(50);
+  std::array<std::byte, plaintext.size()> ciphertext{};
+  std::array<std::byte, kAsconTagSize> tag{};
+  ASSERT_EQ(AsconAead128Encrypt(kStreamKey, kStreamNonce, ad, plaintext,
+                                ciphertext, tag),
+            pw::OkStatus());
+
+  AsconAead128Decryptor decryptor;
+  ASSERT_EQ(decryptor.Start(kStreamKey, kStreamNonce), pw::OkStatus());
+  ASSERT_EQ(decryptor.UpdateAssociatedData(ad), pw::OkStatus());
+  std::array<std::byte, plaintext.size()> decrypted{};
+  const pw::ConstByteSpan input(ciphertext);
+  ASSERT_EQ(decryptor.Update(input.first(11), decrypted), pw::OkStatus());
+  ASSERT_EQ(decryptor.Update(input.subspan(11),
+                             pw::ByteSpan(decrypted).subspan(11)),
+            pw::OkStatus());
+  EXPECT_EQ(decryptor.Finish(tag), pw::OkStatus());
+  EXPECT_EQ(std::memcmp(decrypted.data(), plaintext.data(), plaintext.size()),
+            0);
+
+  // Tampered ciphertext
+  ciphertext[17] ^= std::byte{0x01};
+  ASSERT_EQ(decryptor.Start(kStreamKey, kStreamNonce), pw::OkStatus());
+  ASSERT_EQ(decryptor.UpdateAssociatedData(ad), pw::OkStatus());
+  ASSERT_EQ(decryptor.Update(ciphertext, decrypted), pw::OkStatus());
+  EXPECT_EQ(decryptor.Finish(tag), pw::Status::Unauthenticated());
+}
+
+TEST(AsconStreamTest, StateErrors) {
+  AsconAead128Encryptor encryptor;
+  std::array<std::byte, 8> buffer{};
+  std::array<std::byte, kAsconTagSize> tag{};
+  EXPECT_EQ(encryptor.Update(buffer, buffer), pw::Status::FailedPrecondition());
+  EXPECT_EQ(encryptor.Finish(tag), pw::Status::FailedPrecondition());
+  EXPECT_EQ(encryptor.Start(pw::ConstByteSpan(kStreamKey).first(8),
+                            kStreamNonce),
+            pw::Status::InvalidArgument());
+
+  ASSERT_EQ(encryptor.Start(kStreamKey, kStreamNonce), pw::OkStatus());
+  EXPECT_EQ(encryptor.Update(buffer, pw::ByteSpan(buffer).first(4)),
+            pw::Status::ResourceExhausted());
+  ASSERT_EQ(encryptor.Update(buffer, buffer), pw::OkStatus());
+  EXPECT_EQ(encryptor.UpdateAssociatedData(buffer),
+            pw::Status::FailedPrecondition());
+  ASSERT_EQ(encryptor.Finish(tag), pw::OkStatus());
+  // Finish() ends the message
+  EXPECT_EQ(encryptor.Update(buffer, buffer), pw::Status::FailedPrecondition());
+
+  AsconAead128Decryptor decryptor;
+  ASSERT_EQ(decryptor.Start(kStreamKey, kStreamNonce), pw::OkStatus());
+  EXPECT_EQ(decryptor.Finish(pw::ConstByteSpan(tag).first(8)),
+            pw::Status::InvalidArgument());
+}
+
+TEST(AsconStreamTest, HasherMatchesOneShot) {
+  const auto message = Pattern<50>(9);
+  for (size_t size : {size_t{0}, size_t{1}, size_t{8}, size_t{17}, size_t{50}}) {
+    const pw::ConstByteSpan data = pw::ConstByteSpan(message).first(size);
+    std::array<std::byte, kAsconHashSize> expected{};
+    ASSERT_EQ(AsconHash256(data, expected), pw::OkStatus());
+
+    AsconHash256Hasher hasher;
+    // Twice: Finish() resets the hasher
+    for (int round = 0; round < 2; ++round) {
+      for (size_t i = 0; i < data.size(); i += 3) {
+        hasher.Update(data.subspan(i, std::min(size_t{3}, data.size() - i)));
+      }
+      std::array<std::byte, kAsconHashSize> hash{};
+      ASSERT_EQ(hasher.Finish(hash), pw::OkStatus());
+      EXPECT_EQ(std::memcmp(hash.data(), expected.data(), kAsconHashSize), 0);
+    }
+  }
+
+  AsconHash256Hasher hasher;
+  std::array<std::byte, 16> small_hash{};
+  EXPECT_EQ(hasher.Finish(small_hash), pw::Status::ResourceExhausted());
+}
+
+// In place: output == input gives the same result as separate buffers
+
+TEST(AsconInPlaceTest, MatchesSeparateBuffers) {
+  const auto ad = Pattern<9>(70);
+  // Partial last block for 13, exact blocks for 32
+  for (size_t size : {size_t{13}, size_t{32}}) {
+    const auto message = Pattern<32>(5);
+    const pw::ConstByteSpan plaintext = pw::ConstByteSpan(message).first(size);
+    std::array<std::byte, 32> expected{};
+    std::array<std::byte, kAsconTagSize> expected_tag{};
+    ASSERT_EQ(AsconAead128Encrypt(kStreamKey, kStreamNonce, ad, plaintext,
+                                  expected, expected_tag),
+              pw::OkStatus());
+
+    std::array<std::byte, 32> buffer = message;
+    const pw::ByteSpan data = pw::ByteSpan(buffer).first(size);
+    std::array<std::byte, kAsconTagSize> tag{};
+    ASSERT_EQ(AsconAead128EncryptInPlace(kStreamKey, kStreamNonce, ad, data,
+                                         tag),
+              pw::OkStatus());
+    EXPECT_EQ(std::memcmp(buffer.data(), expected.data(), size), 0);
+    EXPECT_EQ(std::memcmp(tag.data(), expected_tag.data(), kAsconTagSize), 0);
+
+    ASSERT_EQ(AsconAead128DecryptInPlace(kStreamKey, kStreamNonce, ad, data,
+                                         tag),
+              pw::OkStatus());
+    EXPECT_EQ(std::memcmp(buffer.data(), message.data(), size), 0);
+  }
+}
+
+TEST(AsconInPlaceTest, FailedDecryptZeroesBuffer) {
+  const auto message = Pattern<21>(8);
+  std::array<std::byte, 21> buffer = message;
+  std::array<std::byte, kAsconTagSize> tag{};
+  ASSERT_EQ(AsconAead128EncryptInPlace(kStreamKey, kStreamNonce, {}, buffer,
+                                       tag),
+            pw::OkStatus());
+  tag[0] ^= std::byte{0x01};
+  EXPECT_EQ(AsconAead128DecryptInPlace(kStreamKey, kStreamNonce, {}, buffer,
+                                       tag),
+            pw::Status::Unauthenticated());
+  for (std::byte b : buffer) {
+    EXPECT_EQ(b, std::byte{0});
+  }
+}
+
+TEST(AsconInPlaceTest, StreamingInPlace) {
+  const auto message = Pattern<27>(2);
+  std::array<std::byte, 27> expected{};
+  std::array<std::byte, kAsconTagSize> expected_tag{};
+  ASSERT_EQ(AsconAead128Encrypt(kStreamKey, kStreamNonce, {}, message,
+                                expected, expected_tag),
+            pw::OkStatus());
+
+  std::array<std::byte, 27> buffer = message;
+  AsconAead128Encryptor encryptor;
+  ASSERT_EQ(encryptor.Start(kStreamKey, kStreamNonce), pw::OkStatus());
+  const pw::ByteSpan data(buffer);
+  ASSERT_EQ(encryptor.Update(data.first(10), data.first(10)), pw::OkStatus());
+  ASSERT_EQ(encryptor.Update(data.subspan(10), data.subspan(10)),
+            pw::OkStatus());
+  std::array<std::byte, kAsconTagSize> tag{};
+  ASSERT_EQ(encryptor.Finish(tag), pw::OkStatus());
+  EXPECT_EQ(std::memcmp(buffer.data(), expected.data(), buffer.size()), 0);
+}
+
+TEST(AsconInPlaceTest, RejectsPartialOverlap) {
+  std::array<std::byte, 40> buffer{};
+  const pw::ByteSpan data(buffer);
+  std::array<std::byte, kAsconTagSize> tag{};
+  EXPECT_EQ(AsconAead128Encrypt(kStreamKey, kStreamNonce, {}, data.first(32),
+                                data.subspan(4), tag),
+            pw::Status::InvalidArgument());
+  EXPECT_EQ(AsconAead128Decrypt(kStreamKey, kStreamNonce, {}, data.subspan(4),
+                                tag, data.first(36)),
+            pw::Status::InvalidArgument());
+
+  AsconAead128Encryptor encryptor;
+  ASSERT_EQ(encryptor.Start(kStreamKey, kStreamNonce), pw::OkStatus());
+  EXPECT_EQ(encryptor.Update(data.first(16), data.subspan(1)),
+            pw::Status::InvalidArgument());
+}
+
+// Segmented associated data: same result as the concatenation
+
+TEST(AsconSegmentsTest, MatchesConcatenatedAssociatedData) {
+  const auto ad = Pattern<23>(40);
+  const auto plaintext = Pattern<30>(4);
+  std::array<std::byte, plaintext.size()> expected{};
+  std::array<std::byte, kAsconTagSize> expected_tag{};
+  ASSERT_EQ(AsconAead128Encrypt(kStreamKey, kStreamNonce, ad, plaintext,
+                                expected, expected_tag),
+            pw::OkStatus());
+
+  // Header || counter || empty || rest
+  const pw::ConstByteSpan all(ad);
+  const std::array<pw::ConstByteSpan, 4> segments = {
+      all.first(5), all.subspan(5, 4), pw::ConstByteSpan(), all.subspan(9)};
+  std::array<std::byte, plaintext.size()> ciphertext{};
+  std::array<std::byte, kAsconTagSize> tag{};
+  ASSERT_EQ(AsconAead128EncryptSegments(kStreamKey, kStreamNonce, segments,
+                                        plaintext, ciphertext, tag),
+            pw::OkStatus());
+  EXPECT_EQ(std::memcmp(ciphertext.data(), expected.data(), expected.size()),
+            0);
+  EXPECT_EQ(std::memcmp(tag.data(), expected_tag.data(), kAsconTagSize), 0);
+
+  std::array<std::byte, plaintext.size()> decrypted{};
+  ASSERT_EQ(AsconAead128DecryptSegments(kStreamKey, kStreamNonce, segments,
+                                        ciphertext, tag, decrypted),
+            pw::OkStatus());
+  EXPECT_EQ(std::memcmp(decrypted.data(), plaintext.data(), plaintext.size()),
+            0);
+
+  // Authenticates the whole associated data
+  const std::array<pw::ConstByteSpan, 1> header_only = {all.first(5)};
+  EXPECT_EQ(AsconAead128DecryptSegments(kStreamKey, kStreamNonce, header_only,
+                                        ciphertext, tag, decrypted),
+            pw::Status::Unauthenticated());
+  for (std::byte b : decrypted) {
+    EXPECT_EQ(b, std::byte{0});
+  }
+}
+
 }  // namespace
 }  // namespace pb::crypto
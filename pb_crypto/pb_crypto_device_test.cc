@@ -7,7 +7,9 @@
 
 #include "pb_crypto/pb_crypto.h"
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
 #include <cstring>
 
 #include "pw_bytes/array.h"
@@ -161,4 +163,250 @@ TEST(PbCryptoDeviceTest, SessionKeyDerivation) {
   EXPECT_TRUE(match) << "Session key derivation failed!";
 }
 
+TEST(PbCryptoDeviceTest, SessionKeysMatchOneShotFunctions) {
+  constexpr auto kIv = pw::bytes::Array<
+      0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+      0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f>();
+
+  pb::crypto::AesKey aes;
+  EXPECT_FALSE(aes.has_key());
+  std::array<std::byte, 32> encrypted{};
+  EXPECT_EQ(aes.CbcEncrypt(kIv, kRndA, encrypted),
+            pw::Status::FailedPrecondition());
+  ASSERT_EQ(aes.SetKey(kRfc4493Key), pw::OkStatus());
+
+  // Reused schedule gives the same result as a fresh key each time
+  std::array<std::byte, 32> plaintext{};
+  std::copy(kRndA.begin(), kRndA.end(), plaintext.begin());
+  std::copy(kRndB.begin(), kRndB.end(), plaintext.begin() + 16);
+  std::array<std::byte, 32> expected{};
+  ASSERT_EQ(pb::crypto::AesCbcEncrypt(kRfc4493Key, kIv, plaintext, expected),
+            pw::OkStatus());
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ(aes.CbcEncrypt(kIv, plaintext, encrypted), pw::OkStatus());
+    EXPECT_EQ(std::memcmp(encrypted.data(), expected.data(), 32), 0);
+  }
+  std::array<std::byte, 32> decrypted{};
+  ASSERT_EQ(aes.CbcDecrypt(kIv, encrypted, decrypted), pw::OkStatus());
+  EXPECT_EQ(std::memcmp(decrypted.data(), plaintext.data(), 32), 0);
+
+  pb::crypto::CmacKey cmac;
+  ASSERT_EQ(cmac.SetKey(kRfc4493Key), pw::OkStatus());
+  std::array<std::byte, 16> mac{};
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ(cmac.Compute(kMessage16, mac), pw::OkStatus());
+    EXPECT_EQ(std::memcmp(mac.data(), kExpectedMac16.data(), 16), 0);
+  }
+
+  EXPECT_EQ(cmac.SetKey(pw::ConstByteSpan(kRfc4493Key).first(8)),
+            pw::Status::InvalidArgument());
+  EXPECT_FALSE(cmac.has_key());
+}
+
+TEST(PbCryptoDeviceTest, CmacOverSegments) {
+  // RFC 4493 example 3 (40 bytes) split as header || counter || payload
+  constexpr auto kMessage40 = pw::bytes::Array<
+      0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96,
+      0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+      0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c,
+      0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+      0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11>();
+  constexpr auto kExpectedMac40 = pw::bytes::Array<
+      0xdf, 0xa6, 0x67, 0x47, 0xde, 0x9a, 0xe6, 0x30,
+      0x30, 0xca, 0x32, 0x61, 0x14, 0x97, 0xc8, 0x27>();
+
+  const pw::ConstByteSpan message(kMessage40);
+  const std::array<pw::ConstByteSpan, 3> segments = {
+      message.first(3), message.subspan(3, 2), message.subspan(5)};
+
+  std::array<std::byte, 16> mac{};
+  ASSERT_EQ(pb::crypto::AesCmac(kRfc4493Key, segments, mac), pw::OkStatus());
+  EXPECT_EQ(std::memcmp(mac.data(), kExpectedMac40.data(), 16), 0);
+
+  pb::crypto::CmacKey cmac;
+  ASSERT_EQ(cmac.SetKey(kRfc4493Key), pw::OkStatus());
+  mac = {};
+  ASSERT_EQ(cmac.Compute(segments, mac), pw::OkStatus());
+  EXPECT_EQ(std::memcmp(mac.data(), kExpectedMac40.data(), 16), 0);
+}
+
+TEST(PbCryptoDeviceTest, CbcInPlace) {
+  constexpr auto kIv = pw::bytes::Array<
+      0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+      0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f>();
+
+  // A 2 KB frame in one buffer, word-aligned and not
+  alignas(4) static std::array<std::byte, 2048 + 1> buffer;
+  static std::array<std::byte, 2048> plaintext;
+  static std::array<std::byte, 2048> expected;
+  for (size_t i = 0; i < plaintext.size(); ++i) {
+    plaintext[i] = static_cast<std::byte>(i * 13);
+  }
+  ASSERT_EQ(pb::crypto::AesCbcEncrypt(kRfc4493Key, kIv, plaintext, expected),
+            pw::OkStatus());
+
+  pb::crypto::AesKey aes;
+  ASSERT_EQ(aes.SetKey(kRfc4493Key), pw::OkStatus());
+  for (size_t offset : {size_t{0}, size_t{1}}) {
+    const pw::ByteSpan frame =
+        pw::ByteSpan(buffer).subspan(offset, plaintext.size());
+    std::copy(plaintext.begin(), plaintext.end(), frame.begin());
+    ASSERT_EQ(pb::crypto::AesCbcEncryptInPlace(kRfc4493Key, kIv, frame),
+              pw::OkStatus());
+    EXPECT_TRUE(std::equal(frame.begin(), frame.end(), expected.begin()));
+    ASSERT_EQ(aes.CbcDecryptInPlace(kIv, frame), pw::OkStatus());
+    EXPECT_TRUE(std::equal(frame.begin(), frame.end(), plaintext.begin()));
+  }
+
+  // Overlapping at an offset is rejected
+  const pw::ByteSpan all(buffer);
+  EXPECT_EQ(pb::crypto::AesCbcEncrypt(kRfc4493Key, kIv, all.first(32),
+                                      all.subspan(16)),
+            pw::Status::InvalidArgument());
+}
+
+// McGrew & Viega GCM test case 4 (AES-128, 96-bit IV, 60-byte plaintext)
+constexpr auto kGcmKey = pw::bytes::Array<
+    0xfe, 0xff, 0xe9, 0x92, 0x86, 0x65, 0x73, 0x1c,
+    0x6d, 0x6a, 0x8f, 0x94, 0x67, 0x30, 0x83, 0x08>();
+
+constexpr auto kGcmNonce = pw::bytes::Array<
+    0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad,
+    0xde, 0xca, 0xf8, 0x88>();
+
+constexpr auto kGcmAssociatedData = pw::bytes::Array<
+    0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef,
+    0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef,
+    0xab, 0xad, 0xda, 0xd2>();
+
+constexpr auto kGcmPlaintext = pw::bytes::Array<
+    0xd9, 0x31, 0x32, 0x25, 0xf8, 0x84, 0x06, 0xe5,
+    0xa5, 0x59, 0x09, 0xc5, 0xaf, 0xf5, 0x26, 0x9a,
+    0x86, 0xa7, 0xa9, 0x53, 0x15, 0x34, 0xf7, 0xda,
+    0x2e, 0x4c, 0x30, 0x3d, 0x8a, 0x31, 0x8a, 0x72,
+    0x1c, 0x3c, 0x0c, 0x95, 0x95, 0x68, 0x09, 0x53,
+    0x2f, 0xcf, 0x0e, 0x24, 0x49, 0xa6, 0xb5, 0x25,
+    0xb1, 0x6a, 0xed, 0xf5, 0xaa, 0x0d, 0xe6, 0x57,
+    0xba, 0x63, 0x7b, 0x39>();
+
+constexpr auto kGcmCiphertext = pw::bytes::Array<
+    0x42, 0x83, 0x1e, 0xc2, 0x21, 0x77, 0x74, 0x24,
+    0x4b, 0x72, 0x21, 0xb7, 0x84, 0xd0, 0xd4, 0x9c,
+    0xe3, 0xaa, 0x21, 0x2f, 0x2c, 0x02, 0xa4, 0xe0,
+    0x35, 0xc1, 0x7e, 0x23, 0x29, 0xac, 0xa1, 0x2e,
+    0x21, 0xd5, 0x14, 0xb2, 0x54, 0x66, 0x93, 0x1c,
+    0x7d, 0x8f, 0x6a, 0x5a, 0xac, 0x84, 0xaa, 0x05,
+    0x1b, 0xa3, 0x0b, 0x39, 0x6a, 0x0a, 0xac, 0x97,
+    0x3d, 0x58, 0xe0, 0x91>();
+
+constexpr auto kGcmTag = pw::bytes::Array<
+    0x5b, 0xc9, 0x4f, 0xbc, 0x32, 0x21, 0xa5, 0xdb,
+    0x94, 0xfa, 0xe9, 0x5a, 0xe7, 0x12, 0x1a, 0x47>();
+
+TEST(PbCryptoDeviceTest, AesGcmVector) {
+  std::array<std::byte, kGcmPlaintext.size()> ciphertext{};
+  std::array<std::byte, pb::crypto::kAesGcmTagSize> tag{};
+  ASSERT_EQ(pb::crypto::AesGcmEncrypt(kGcmKey, kGcmNonce, kGcmAssociatedData,
+                                      kGcmPlaintext, ciphertext, tag),
+            pw::OkStatus());
+  EXPECT_EQ(std::memcmp(ciphertext.data(), kGcmCiphertext.data(),
+                        ciphertext.size()),
+            0);
+  EXPECT_EQ(std::memcmp(tag.data(), kGcmTag.data(), tag.size()), 0);
+
+  std::array<std::byte, kGcmPlaintext.size()> decrypted{};
+  ASSERT_EQ(pb::crypto::AesGcmDecrypt(kGcmKey, kGcmNonce, kGcmAssociatedData,
+                                      kGcmCiphertext, kGcmTag, decrypted),
+            pw::OkStatus());
+  EXPECT_EQ(std::memcmp(decrypted.data(), kGcmPlaintext.data(),
+                        decrypted.size()),
+            0);
+}
+
+TEST(PbCryptoDeviceTest, AesGcmRejectsModifiedMessage) {
+  auto tag = kGcmTag;
+  tag[0] ^= std::byte{0x01};
+  std::array<std::byte, kGcmPlaintext.size()> decrypted{};
+  decrypted.fill(std::byte{0xaa});
+  EXPECT_EQ(pb::crypto::AesGcmDecrypt(kGcmKey, kGcmNonce, kGcmAssociatedData,
+                                      kGcmCiphertext, tag, decrypted),
+            pw::Status::Unauthenticated());
+  EXPECT_TRUE(std::all_of(decrypted.begin(), decrypted.end(),
+                          [](std::byte b) { return b == std::byte{0}; }));
+
+  EXPECT_EQ(pb::crypto::AesGcmDecrypt(kGcmKey, kGcmNonce, {}, kGcmCiphertext,
+                                      kGcmTag, decrypted),
+            pw::Status::Unauthenticated());
+
+  // 16-byte nonces are for ASCON; GCM takes 12
+  const std::array<std::byte, 16> long_nonce{};
+  EXPECT_EQ(pb::crypto::AesGcmDecrypt(kGcmKey, long_nonce, {}, kGcmCiphertext,
+                                      kGcmTag, decrypted),
+            pw::Status::InvalidArgument());
+}
+
+TEST(PbCryptoDeviceTest, AesGcmInPlace) {
+  auto frame = kGcmPlaintext;
+  std::array<std::byte, pb::crypto::kAesGcmTagSize> tag{};
+  ASSERT_EQ(pb::crypto::AesGcmEncryptInPlace(kGcmKey, kGcmNonce,
+                                             kGcmAssociatedData, frame, tag),
+            pw::OkStatus());
+  EXPECT_EQ(frame, kGcmCiphertext);
+  EXPECT_EQ(tag, kGcmTag);
+  ASSERT_EQ(pb::crypto::AesGcmDecryptInPlace(kGcmKey, kGcmNonce,
+                                             kGcmAssociatedData, frame, tag),
+            pw::OkStatus());
+  EXPECT_EQ(frame, kGcmPlaintext);
+}
+
+TEST(PbCryptoDeviceTest, ConstantTimeEqual) {
+  // Differences in the word-wise part and in the byte tail
+  auto mac = kExpectedMac16;
+  EXPECT_TRUE(pb::crypto::ConstantTimeEqual(mac, kExpectedMac16));
+  mac[5] ^= std::byte{0x10};
+  EXPECT_FALSE(pb::crypto::ConstantTimeEqual(mac, kExpectedMac16));
+
+  const pw::ConstByteSpan odd = pw::ConstByteSpan(kExpectedMac16).first(7);
+  std::array<std::byte, 7> copy;
+  std::copy(odd.begin(), odd.end(), copy.begin());
+  EXPECT_TRUE(pb::crypto::ConstantTimeEqual(copy, odd));
+  copy[6] ^= std::byte{0x01};
+  EXPECT_FALSE(pb::crypto::ConstantTimeEqual(copy, odd));
+
+  EXPECT_FALSE(pb::crypto::ConstantTimeEqual(odd, kExpectedMac16));
+  EXPECT_TRUE(pb::crypto::ConstantTimeEqual({}, {}));
+}
+
+TEST(PbCryptoDeviceTest, SecureZero) {
+  auto key = kRfc4493Key;
+  pb::crypto::SecureZero(key);
+  EXPECT_TRUE(std::all_of(key.begin(), key.end(),
+                          [](std::byte b) { return b == std::byte{0}; }));
+}
+
+TEST(PbCryptoDeviceTest, NonceGenerator) {
+  pb::crypto::NonceGenerator nonces;
+  std::array<std::byte, pb::crypto::kAsconNonceSize> first{};
+  EXPECT_EQ(nonces.Generate(first), pw::Status::FailedPrecondition());
+
+  ASSERT_EQ(nonces.Seed(pw::bytes::String("crypto_test")), pw::OkStatus());
+  EXPECT_TRUE(nonces.seeded());
+  std::array<std::byte, pb::crypto::kAsconNonceSize> second{};
+  ASSERT_EQ(nonces.Generate(first), pw::OkStatus());
+  ASSERT_EQ(nonces.Generate(second), pw::OkStatus());
+  EXPECT_NE(first, second);
+
+  // A second instance seeded at the same time gives other nonces
+  pb::crypto::NonceGenerator other;
+  ASSERT_EQ(other.Seed(), pw::OkStatus());
+  ASSERT_EQ(other.Generate(second), pw::OkStatus());
+  EXPECT_NE(first, second);
+
+  // Requests above the DRBG's per-call limit are split
+  static std::array<std::byte, 2048> large{};
+  ASSERT_EQ(nonces.Generate(large), pw::OkStatus());
+  EXPECT_FALSE(std::all_of(large.end() - 16, large.end(),
+                           [](std::byte b) { return b == std::byte{0}; }));
+}
+
 }  // namespace
@@ -0,0 +1,144 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+/// @file pb_crypto_gcm.cc
+/// @brief AES-GCM for pb_crypto, on mbedTLS for every AES backend.
+///
+/// Compiled into each backend against that backend's mbedTLS (the host
+/// library, or mbedtls_embedded on the P2, where MBEDTLS_GCM_C is already
+/// enabled for TLS). The RTL872x engine backend uses it too: GCM runs in
+/// software there.
+
+#include <mbedtls/gcm.h>
+
+#include "pb_crypto/pb_crypto.h"
+
+namespace pb::crypto {
+
+namespace {
+
+constexpr unsigned kKeyBits = kAesKeySize * 8;
+
+// NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+const unsigned char* Bytes(pw::ConstByteSpan data) {
+  return reinterpret_cast<const unsigned char*>(data.data());
+}
+
+unsigned char* Bytes(pw::ByteSpan data) {
+  return reinterpret_cast<unsigned char*>(data.data());
+}
+// NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+
+pw::Status CheckArguments(pw::ConstByteSpan key,
+                          pw::ConstByteSpan nonce,
+                          pw::ConstByteSpan input,
+                          pw::ByteSpan output) {
+  if (key.size() != kAesKeySize || nonce.size() != kAesGcmNonceSize) {
+    return pw::Status::InvalidArgument();
+  }
+  if (output.size() < input.size()) {
+    return pw::Status::ResourceExhausted();
+  }
+  // mbedTLS GCM handles output == input
+  if (internal::PartiallyOverlaps(input, output)) {
+    return pw::Status::InvalidArgument();
+  }
+  return pw::OkStatus();
+}
+
+// mbedtls_gcm_context wrapper that is freed (and wiped) on every path
+class GcmContext {
+ public:
+  GcmContext() { mbedtls_gcm_init(&context_); }
+  ~GcmContext() { mbedtls_gcm_free(&context_); }
+
+  GcmContext(const GcmContext&) = delete;
+  GcmContext& operator=(const GcmContext&) = delete;
+
+  pw::Status SetKey(pw::ConstByteSpan key) {
+    return mbedtls_gcm_setkey(
+               &context_, MBEDTLS_CIPHER_ID_AES, Bytes(key), kKeyBits) == 0
+               ? pw::OkStatus()
+               : pw::Status::Internal();
+  }
+
+  mbedtls_gcm_context* get() { return &context_; }
+
+ private:
+  mbedtls_gcm_context context_;
+};
+
+}  // namespace
+
+pw::Status AesGcmEncrypt(pw::ConstByteSpan key,
+                         pw::ConstByteSpan nonce,
+                         pw::ConstByteSpan associated_data,
+                         pw::ConstByteSpan plaintext,
+                         pw::ByteSpan ciphertext,
+                         pw::ByteSpan tag) {
+  pw::Status status = CheckArguments(key, nonce, plaintext, ciphertext);
+  if (!status.ok()) {
+    return status;
+  }
+  if (tag.size() < kAesGcmTagSize) {
+    return pw::Status::ResourceExhausted();
+  }
+
+  GcmContext gcm;
+  status = gcm.SetKey(key);
+  if (!status.ok()) {
+    return status;
+  }
+  if (mbedtls_gcm_crypt_and_tag(gcm.get(),
+                                MBEDTLS_GCM_ENCRYPT,
+                                plaintext.size(),
+                                Bytes(nonce),
+                                nonce.size(),
+                                Bytes(associated_data),
+                                associated_data.size(),
+                                Bytes(plaintext),
+                                Bytes(ciphertext),
+                                kAesGcmTagSize,
+                                Bytes(tag)) != 0) {
+    return pw::Status::Internal();
+  }
+  return pw::OkStatus();
+}
+
+pw::Status AesGcmDecrypt(pw::ConstByteSpan key,
+                         pw::ConstByteSpan nonce,
+                         pw::ConstByteSpan associated_data,
+                         pw::ConstByteSpan ciphertext,
+                         pw::ConstByteSpan tag,
+                         pw::ByteSpan plaintext) {
+  if (tag.size() != kAesGcmTagSize) {
+    return pw::Status::InvalidArgument();
+  }
+  pw::Status status = CheckArguments(key, nonce, ciphertext, plaintext);
+  if (!status.ok()) {
+    return status;
+  }
+
+  GcmContext gcm;
+  status = gcm.SetKey(key);
+  if (!status.ok()) {
+    return status;
+  }
+  // Zeroes the plaintext if the tag does not match
+  const int result = mbedtls_gcm_auth_decrypt(gcm.get(),
+                                              ciphertext.size(),
+                                              Bytes(nonce),
+                                              nonce.size(),
+                                              Bytes(associated_data),
+                                              associated_data.size(),
+                                              Bytes(tag),
+                                              tag.size(),
+                                              Bytes(ciphertext),
+                                              Bytes(plaintext));
+  if (result == MBEDTLS_ERR_GCM_AUTH_FAILED) {
+    return pw::Status::Unauthenticated();
+  }
+  return result == 0 ? pw::OkStatus() : pw::Status::Internal();
+}
+
+}  // namespace pb::crypto
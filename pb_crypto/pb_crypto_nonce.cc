@@ -0,0 +1,85 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+/// @file pb_crypto_nonce.cc
+/// @brief NonceGenerator on the mbedTLS CTR-DRBG of each AES backend.
+///
+/// Compiled into each backend like pb_crypto_gcm.cc; the entropy comes from
+/// the backend's FillHardwareRandom().
+
+#include <mbedtls/ctr_drbg.h>
+
+#include <algorithm>
+
+#include "hardware_random.h"
+#include "pb_crypto/pb_crypto.h"
+
+namespace pb::crypto {
+
+namespace {
+
+static_assert(sizeof(mbedtls_ctr_drbg_context) <=
+                  internal::kCtrDrbgContextSize,
+              "internal::kCtrDrbgContextSize too small for "
+              "mbedtls_ctr_drbg_context");
+static_assert(alignof(mbedtls_ctr_drbg_context) <= 8,
+              "DRBG context storage is 8-byte aligned");
+
+mbedtls_ctr_drbg_context* Context(
+    std::array<std::byte, internal::kCtrDrbgContextSize>& storage) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return reinterpret_cast<mbedtls_ctr_drbg_context*>(storage.data());
+}
+
+// mbedTLS entropy callback, for the seed and every reseed
+int Entropy(void*, unsigned char* output, size_t length) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  const pw::ByteSpan buffer(reinterpret_cast<std::byte*>(output), length);
+  return internal::FillHardwareRandom(buffer).ok()
+             ? 0
+             : MBEDTLS_ERR_CTR_DRBG_ENTROPY_SOURCE_FAILED;
+}
+
+}  // namespace
+
+NonceGenerator::NonceGenerator() { mbedtls_ctr_drbg_init(Context(context_)); }
+
+NonceGenerator::~NonceGenerator() {
+  // mbedtls_ctr_drbg_free() zeroes the state
+  mbedtls_ctr_drbg_free(Context(context_));
+}
+
+pw::Status NonceGenerator::Seed(pw::ConstByteSpan personalization) {
+  seeded_ = false;
+  mbedtls_ctr_drbg_free(Context(context_));
+  mbedtls_ctr_drbg_init(Context(context_));
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  const auto* custom =
+      reinterpret_cast<const unsigned char*>(personalization.data());
+  if (mbedtls_ctr_drbg_seed(Context(context_), Entropy, nullptr, custom,
+                            personalization.size()) != 0) {
+    return pw::Status::Internal();
+  }
+  seeded_ = true;
+  return pw::OkStatus();
+}
+
+pw::Status NonceGenerator::Generate(pw::ByteSpan output) {
+  if (!seeded_) {
+    return pw::Status::FailedPrecondition();
+  }
+  // One DRBG request is limited to MBEDTLS_CTR_DRBG_MAX_REQUEST bytes
+  while (!output.empty()) {
+    const size_t chunk =
+        std::min<size_t>(output.size(), MBEDTLS_CTR_DRBG_MAX_REQUEST);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto* bytes = reinterpret_cast<unsigned char*>(output.data());
+    if (mbedtls_ctr_drbg_random(Context(context_), bytes, chunk) != 0) {
+      return pw::Status::Internal();
+    }
+    output = output.subspan(chunk);
+  }
+  return pw::OkStatus();
+}
+
+}  // namespace pb::crypto
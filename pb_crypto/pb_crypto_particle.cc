@@ -11,9 +11,14 @@
 
 #include <algorithm>
 #include <array>
+#include <cstring>
 
+#include "cmac_segments.h"
+#include "hardware_random.h"
 #include "mbedtls/aes.h"
-#include "mbedtls/cmac.h"
+#include "mbedtls/platform_util.h"
+#include "pw_status/try.h"
+#include "rng_hal.h"
 
 namespace pb::crypto {
 
@@ -21,118 +26,287 @@ namespace {
 
 constexpr size_t kBitsPerByte = 8;
 
-}  // namespace
+// CMAC subkey constant for 128-bit blocks (NIST SP 800-38B)
+constexpr std::byte kCmacRb{0x87};
 
-pw::Status AesCbcEncrypt(pw::ConstByteSpan key,
-                         pw::ConstByteSpan iv,
-                         pw::ConstByteSpan plaintext,
-                         pw::ByteSpan ciphertext) {
-  if (key.size() != kAesKeySize) {
-    return pw::Status::InvalidArgument();
-  }
+static_assert(sizeof(mbedtls_aes_context) <= internal::kAesContextSize,
+              "internal::kAesContextSize too small for mbedtls_aes_context");
+static_assert(alignof(mbedtls_aes_context) <= 8,
+              "AES context storage is 8-byte aligned");
+
+mbedtls_aes_context* Context(std::array<std::byte, internal::kAesContextSize>&
+                                 storage) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return reinterpret_cast<mbedtls_aes_context*>(storage.data());
+}
+
+// NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+const unsigned char* Bytes(pw::ConstByteSpan data) {
+  return reinterpret_cast<const unsigned char*>(data.data());
+}
+
+unsigned char* Bytes(pw::ByteSpan data) {
+  return reinterpret_cast<unsigned char*>(data.data());
+}
+// NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+
+pw::Status CheckCbcArguments(pw::ConstByteSpan iv,
+                             pw::ConstByteSpan input,
+                             pw::ByteSpan output) {
   if (iv.size() != kAesBlockSize) {
     return pw::Status::InvalidArgument();
   }
-  if (plaintext.size() % kAesBlockSize != 0) {
+  if (input.size() % kAesBlockSize != 0) {
     return pw::Status::InvalidArgument();
   }
-  if (ciphertext.size() < plaintext.size()) {
+  if (output.size() < input.size()) {
     return pw::Status::ResourceExhausted();
   }
+  // mbedtls_aes_crypt_cbc() handles output == input
+  if (internal::PartiallyOverlaps(input, output)) {
+    return pw::Status::InvalidArgument();
+  }
+  return pw::OkStatus();
+}
 
-  mbedtls_aes_context aes;
-  mbedtls_aes_init(&aes);
-
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-  auto* key_data = reinterpret_cast<const unsigned char*>(key.data());
-  if (mbedtls_aes_setkey_enc(&aes, key_data, kAesKeySize * kBitsPerByte) != 0) {
-    mbedtls_aes_free(&aes);
-    return pw::Status::Internal();
+pw::Status ExpandKey(mbedtls_aes_context& aes,
+                     pw::ConstByteSpan key,
+                     int mode) {
+  if (key.size() != kAesKeySize) {
+    return pw::Status::InvalidArgument();
   }
+  const int result =
+      mode == MBEDTLS_AES_ENCRYPT
+          ? mbedtls_aes_setkey_enc(&aes, Bytes(key), kAesKeySize * kBitsPerByte)
+          : mbedtls_aes_setkey_dec(&aes, Bytes(key), kAesKeySize * kBitsPerByte);
+  return result == 0 ? pw::OkStatus() : pw::Status::Internal();
+}
 
+// Arguments already checked with CheckCbcArguments()
+pw::Status Cbc(mbedtls_aes_context& aes,
+               int mode,
+               pw::ConstByteSpan iv,
+               pw::ConstByteSpan input,
+               pw::ByteSpan output) {
   // mbedtls_aes_crypt_cbc modifies IV in place, so make a copy
   std::array<unsigned char, kAesBlockSize> iv_copy;
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-  std::copy(reinterpret_cast<const unsigned char*>(iv.data()),
-            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-            reinterpret_cast<const unsigned char*>(iv.data()) + kAesBlockSize,
-            iv_copy.begin());
-
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-  auto* in = reinterpret_cast<const unsigned char*>(plaintext.data());
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-  auto* out = reinterpret_cast<unsigned char*>(ciphertext.data());
+  std::copy(Bytes(iv), Bytes(iv) + kAesBlockSize, iv_copy.begin());
 
   if (mbedtls_aes_crypt_cbc(&aes,
-                            MBEDTLS_AES_ENCRYPT,
-                            plaintext.size(),
+                            mode,
+                            input.size(),
                             iv_copy.data(),
-                            in,
-                            out) != 0) {
-    mbedtls_aes_free(&aes);
+                            Bytes(input),
+                            Bytes(output)) != 0) {
     return pw::Status::Internal();
   }
+  return pw::OkStatus();
+}
 
-  mbedtls_aes_free(&aes);
+pw::Status EncryptBlock(mbedtls_aes_context& aes,
+                        const std::array<std::byte, kAesBlockSize>& in,
+                        std::array<std::byte, kAesBlockSize>& out) {
+  // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+  if (mbedtls_aes_crypt_ecb(&aes,
+                            MBEDTLS_AES_ENCRYPT,
+                            reinterpret_cast<const unsigned char*>(in.data()),
+                            reinterpret_cast<unsigned char*>(out.data())) !=
+      0) {
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+    return pw::Status::Internal();
+  }
   return pw::OkStatus();
 }
 
-pw::Status AesCbcDecrypt(pw::ConstByteSpan key,
-                         pw::ConstByteSpan iv,
-                         pw::ConstByteSpan ciphertext,
-                         pw::ByteSpan plaintext) {
-  if (key.size() != kAesKeySize) {
-    return pw::Status::InvalidArgument();
+// Left shift by one bit, XORing Rb in if the top bit was set
+void DoubleSubkey(const std::array<std::byte, kAesBlockSize>& in,
+                  std::array<std::byte, kAesBlockSize>& out) {
+  const bool carry = (in[0] & std::byte{0x80}) != std::byte{0};
+  for (size_t i = 0; i < kAesBlockSize - 1; ++i) {
+    out[i] = (in[i] << 1) | (in[i + 1] >> 7);
   }
-  if (iv.size() != kAesBlockSize) {
-    return pw::Status::InvalidArgument();
+  out[kAesBlockSize - 1] = in[kAesBlockSize - 1] << 1;
+  if (carry) {
+    out[kAesBlockSize - 1] ^= kCmacRb;
   }
-  if (ciphertext.size() % kAesBlockSize != 0) {
-    return pw::Status::InvalidArgument();
+}
+
+}  // namespace
+
+// -- AesKey --
+
+AesKey::AesKey() {
+  mbedtls_aes_init(Context(encrypt_));
+  mbedtls_aes_init(Context(decrypt_));
+}
+
+AesKey::~AesKey() {
+  // mbedtls_aes_free() zeroes the schedules
+  mbedtls_aes_free(Context(encrypt_));
+  mbedtls_aes_free(Context(decrypt_));
+}
+
+pw::Status AesKey::SetKey(pw::ConstByteSpan key) {
+  has_key_ = false;
+  pw::Status status =
+      ExpandKey(*Context(encrypt_), key, MBEDTLS_AES_ENCRYPT);
+  if (!status.ok()) {
+    return status;
   }
-  if (plaintext.size() < ciphertext.size()) {
-    return pw::Status::ResourceExhausted();
+  status = ExpandKey(*Context(decrypt_), key, MBEDTLS_AES_DECRYPT);
+  if (!status.ok()) {
+    return status;
   }
+  has_key_ = true;
+  return pw::OkStatus();
+}
 
-  mbedtls_aes_context aes;
-  mbedtls_aes_init(&aes);
+pw::Status AesKey::CbcEncrypt(pw::ConstByteSpan iv,
+                              pw::ConstByteSpan plaintext,
+                              pw::ByteSpan ciphertext) {
+  if (!has_key_) {
+    return pw::Status::FailedPrecondition();
+  }
+  pw::Status status = CheckCbcArguments(iv, plaintext, ciphertext);
+  if (!status.ok()) {
+    return status;
+  }
+  return Cbc(*Context(encrypt_), MBEDTLS_AES_ENCRYPT, iv, plaintext,
+             ciphertext);
+}
 
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-  auto* key_data = reinterpret_cast<const unsigned char*>(key.data());
-  if (mbedtls_aes_setkey_dec(&aes, key_data, kAesKeySize * kBitsPerByte) != 0) {
-    mbedtls_aes_free(&aes);
-    return pw::Status::Internal();
+pw::Status AesKey::CbcDecrypt(pw::ConstByteSpan iv,
+                              pw::ConstByteSpan ciphertext,
+                              pw::ByteSpan plaintext) {
+  if (!has_key_) {
+    return pw::Status::FailedPrecondition();
+  }
+  pw::Status status = CheckCbcArguments(iv, ciphertext, plaintext);
+  if (!status.ok()) {
+    return status;
   }
+  return Cbc(*Context(decrypt_), MBEDTLS_AES_DECRYPT, iv, ciphertext,
+             plaintext);
+}
 
-  // mbedtls_aes_crypt_cbc modifies IV in place, so make a copy
-  std::array<unsigned char, kAesBlockSize> iv_copy;
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-  std::copy(reinterpret_cast<const unsigned char*>(iv.data()),
-            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-            reinterpret_cast<const unsigned char*>(iv.data()) + kAesBlockSize,
-            iv_copy.begin());
+// -- CmacKey --
 
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-  auto* in = reinterpret_cast<const unsigned char*>(ciphertext.data());
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-  auto* out = reinterpret_cast<unsigned char*>(plaintext.data());
+CmacKey::CmacKey() { mbedtls_aes_init(Context(encrypt_)); }
 
-  if (mbedtls_aes_crypt_cbc(&aes,
-                            MBEDTLS_AES_DECRYPT,
-                            ciphertext.size(),
-                            iv_copy.data(),
-                            in,
-                            out) != 0) {
-    mbedtls_aes_free(&aes);
-    return pw::Status::Internal();
+CmacKey::~CmacKey() {
+  mbedtls_aes_free(Context(encrypt_));
+  mbedtls_platform_zeroize(k1_.data(), k1_.size());
+  mbedtls_platform_zeroize(k2_.data(), k2_.size());
+}
+
+pw::Status CmacKey::SetKey(pw::ConstByteSpan key) {
+  has_key_ = false;
+  pw::Status status =
+      ExpandKey(*Context(encrypt_), key, MBEDTLS_AES_ENCRYPT);
+  if (!status.ok()) {
+    return status;
   }
 
-  mbedtls_aes_free(&aes);
+  // K1 = dbl(E(K, 0)), K2 = dbl(K1)
+  std::array<std::byte, kAesBlockSize> l{};
+  status = EncryptBlock(*Context(encrypt_), l, l);
+  if (!status.ok()) {
+    return status;
+  }
+  DoubleSubkey(l, k1_);
+  DoubleSubkey(k1_, k2_);
+  mbedtls_platform_zeroize(l.data(), l.size());
+  has_key_ = true;
   return pw::OkStatus();
 }
 
+pw::Status CmacKey::Compute(ByteSegments segments, pw::ByteSpan mac) {
+  if (!has_key_) {
+    return pw::Status::FailedPrecondition();
+  }
+  if (mac.size() < kAesBlockSize) {
+    return pw::Status::ResourceExhausted();
+  }
+
+  // All blocks but the last are chained as in CBC-MAC
+  internal::CmacBlock state{};
+  internal::CmacBlock last;
+  pw::Status status = internal::WalkCmacBlocks(
+      segments, k1_, k2_,
+      [&](pw::ConstByteSpan blocks) {
+        for (size_t offset = 0; offset < blocks.size();
+             offset += kAesBlockSize) {
+          for (size_t i = 0; i < kAesBlockSize; ++i) {
+            state[i] ^= blocks[offset + i];
+          }
+          PW_TRY(EncryptBlock(*Context(encrypt_), state, state));
+        }
+        return pw::OkStatus();
+      },
+      last);
+  if (status.ok()) {
+    for (size_t i = 0; i < kAesBlockSize; ++i) {
+      state[i] ^= last[i];
+    }
+    status = EncryptBlock(*Context(encrypt_), state, state);
+  }
+  if (status.ok()) {
+    std::copy(state.begin(), state.end(), mac.begin());
+  }
+  mbedtls_platform_zeroize(state.data(), state.size());
+  mbedtls_platform_zeroize(last.data(), last.size());
+  return status;
+}
+
+// -- One-shot functions --
+
+pw::Status AesCbcEncrypt(pw::ConstByteSpan key,
+                         pw::ConstByteSpan iv,
+                         pw::ConstByteSpan plaintext,
+                         pw::ByteSpan ciphertext) {
+  if (key.size() != kAesKeySize) {
+    return pw::Status::InvalidArgument();
+  }
+  pw::Status status = CheckCbcArguments(iv, plaintext, ciphertext);
+  if (!status.ok()) {
+    return status;
+  }
+
+  // Only the encryption schedule is needed, so not an AesKey
+  mbedtls_aes_context aes;
+  mbedtls_aes_init(&aes);
+  status = ExpandKey(aes, key, MBEDTLS_AES_ENCRYPT);
+  if (status.ok()) {
+    status = Cbc(aes, MBEDTLS_AES_ENCRYPT, iv, plaintext, ciphertext);
+  }
+  mbedtls_aes_free(&aes);
+  return status;
+}
+
+pw::Status AesCbcDecrypt(pw::ConstByteSpan key,
+                         pw::ConstByteSpan iv,
+                         pw::ConstByteSpan ciphertext,
+                         pw::ByteSpan plaintext) {
+  if (key.size() != kAesKeySize) {
+    return pw::Status::InvalidArgument();
+  }
+  pw::Status status = CheckCbcArguments(iv, ciphertext, plaintext);
+  if (!status.ok()) {
+    return status;
+  }
+
+  mbedtls_aes_context aes;
+  mbedtls_aes_init(&aes);
+  status = ExpandKey(aes, key, MBEDTLS_AES_DECRYPT);
+  if (status.ok()) {
+    status = Cbc(aes, MBEDTLS_AES_DECRYPT, iv, ciphertext, plaintext);
+  }
+  mbedtls_aes_free(&aes);
+  return status;
+}
+
 pw::Status AesCmac(pw::ConstByteSpan key,
-                   pw::ConstByteSpan data,
+                   ByteSegments segments,
                    pw::ByteSpan mac) {
   if (key.size() != kAesKeySize) {
     return pw::Status::InvalidArgument();
@@ -140,29 +314,23 @@ pw::Status AesCmac(pw::ConstByteSpan key,
   if (mac.size() < kAesBlockSize) {
     return pw::Status::ResourceExhausted();
   }
-
-  const mbedtls_cipher_info_t* cipher_info =
-      mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_AES_128_ECB);
-  if (cipher_info == nullptr) {
-    return pw::Status::Internal();
+  CmacKey cmac;
+  pw::Status status = cmac.SetKey(key);
+  if (!status.ok()) {
+    return status;
   }
+  return cmac.Compute(segments, mac);
+}
 
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-  auto* key_data = reinterpret_cast<const unsigned char*>(key.data());
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-  auto* data_ptr = reinterpret_cast<const unsigned char*>(data.data());
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-  auto* mac_ptr = reinterpret_cast<unsigned char*>(mac.data());
-
-  if (mbedtls_cipher_cmac(cipher_info,
-                          key_data,
-                          kAesKeySize * kBitsPerByte,
-                          data_ptr,
-                          data.size(),
-                          mac_ptr) != 0) {
-    return pw::Status::Internal();
-  }
+// -- Entropy --
 
+pw::Status internal::FillHardwareRandom(pw::ByteSpan output) {
+  while (!output.empty()) {
+    const uint32_t random = HAL_RNG_GetRandomNumber();
+    const size_t n = std::min(sizeof(random), output.size());
+    std::memcpy(output.data(), &random, n);
+    output = output.subspan(n);
+  }
   return pw::OkStatus();
 }
 
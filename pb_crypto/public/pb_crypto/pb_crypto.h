@@ -8,13 +8,28 @@
 ///
 /// This module provides:
 /// - AES-128-CBC and AES-CMAC for NTAG424 authentication (platform-specific)
+/// - AES-128-GCM authenticated encryption in one pass (mbedTLS)
+/// - NonceGenerator: random nonces and IVs from a CTR-DRBG
 /// - ASCON-AEAD128 and ASCON-Hash256 for gateway communication (portable)
 ///
 /// AES backends:
 /// - Particle P2: Uses Device OS mbedTLS (potentially HW accelerated)
 /// - Host: Uses mbedTLS directly
 ///
-/// ASCON uses the portable reference implementation on all platforms.
+/// ASCON uses the portable reference implementation on all platforms. Besides
+/// the one-shot functions, AsconAead128Encryptor, AsconAead128Decryptor and
+/// AsconHash256Hasher process data in chunks, in constant memory.
+///
+/// ConstantTimeEqual() and SecureZero() compare MACs and wipe keys without
+/// the timing leak of memcmp() or the elided loop of a plain wipe.
+///
+/// AES-CMAC and ASCON-AEAD associated data also take ByteSegments, so a MAC
+/// over header || counter || payload needs no temporary buffer.
+///
+/// In-place operation: AES-CBC and ASCON-AEAD accept the same buffer as
+/// input and output (the *InPlace() functions spell this out), so a frame
+/// needs one buffer. Spans that overlap without starting at the same
+/// address are rejected with InvalidArgument.
 ///
 /// Usage:
 /// @code
@@ -27,6 +42,11 @@
 /// std::array<std::byte, 32> ciphertext;
 /// PW_TRY(pb::crypto::AesCbcEncrypt(key, iv, plaintext, ciphertext));
 ///
+/// // Many operations with one session key: expand it once
+/// pb::crypto::CmacKey mac_key;
+/// PW_TRY(mac_key.SetKey(session_mac_key));
+/// PW_TRY(mac_key.Compute(command, mac));
+///
 /// // ASCON for gateway communication
 /// std::array<std::byte, 16> ascon_key = {...};
 /// std::array<std::byte, 16> nonce = {...};
@@ -37,12 +57,55 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 
 #include "pw_bytes/span.h"
+#include "pw_span/span.h"
 #include "pw_status/status.h"
 
 namespace pb::crypto {
 
+/// A message given as consecutive pieces, e.g. header, counter and payload,
+/// processed as their concatenation without assembling it.
+using ByteSegments = pw::span<const pw::ConstByteSpan>;
+
+/// Compare two MACs or tags in time that depends only on their size, not on
+/// where they differ; use it instead of memcmp() for anything secret.
+///
+/// Compares a word at a time (unaligned loads are fine on Cortex-M33; the
+/// host compiler vectorizes the loop).
+///
+/// @return True if `a` and `b` have the same size and contents
+inline bool ConstantTimeEqual(pw::ConstByteSpan a, pw::ConstByteSpan b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  uint32_t diff = 0;
+  size_t i = 0;
+  for (; i + sizeof(uint32_t) <= a.size(); i += sizeof(uint32_t)) {
+    uint32_t x;
+    uint32_t y;
+    std::memcpy(&x, a.data() + i, sizeof(x));
+    std::memcpy(&y, b.data() + i, sizeof(y));
+    diff |= x ^ y;
+  }
+  for (; i < a.size(); ++i) {
+    diff |= static_cast<uint32_t>(a[i] ^ b[i]);
+  }
+  // Hide the value, so the compiler cannot turn the loop into an early exit
+  asm volatile("" : "+r"(diff));
+  return diff == 0;
+}
+
+/// Zero key material or plaintext so the compiler cannot remove the writes,
+/// e.g. for a buffer that is not read again. As fast as memset().
+inline void SecureZero(pw::ByteSpan data) {
+  std::memset(data.data(), 0, data.size());
+  // The memory clobber makes the zeroes observable here
+  asm volatile("" : : "r"(data.data()) : "memory");
+}
+
 /// AES block size in bytes (128 bits).
 inline constexpr size_t kAesBlockSize = 16;
 
@@ -54,9 +117,10 @@ inline constexpr size_t kAesKeySize = 16;
 /// @param key 16-byte AES key
 /// @param iv 16-byte initialization vector (not modified)
 /// @param plaintext Input data (must be multiple of 16 bytes)
-/// @param ciphertext Output buffer (same size as plaintext)
-/// @return OkStatus on success, InvalidArgument for wrong sizes,
-///         Internal for crypto errors
+/// @param ciphertext Output buffer (same size as plaintext); may start at
+///        plaintext.data() for in-place encryption
+/// @return OkStatus on success, InvalidArgument for wrong sizes or
+///         partially overlapping buffers, Internal for crypto errors
 pw::Status AesCbcEncrypt(pw::ConstByteSpan key,
                          pw::ConstByteSpan iv,
                          pw::ConstByteSpan plaintext,
@@ -67,27 +131,251 @@ pw::Status AesCbcEncrypt(pw::ConstByteSpan key,
 /// @param key 16-byte AES key
 /// @param iv 16-byte initialization vector (not modified)
 /// @param ciphertext Input data (must be multiple of 16 bytes)
-/// @param plaintext Output buffer (same size as ciphertext)
-/// @return OkStatus on success, InvalidArgument for wrong sizes,
-///         Internal for crypto errors
+/// @param plaintext Output buffer (same size as ciphertext); may start at
+///        ciphertext.data() for in-place decryption
+/// @return OkStatus on success, InvalidArgument for wrong sizes or
+///         partially overlapping buffers, Internal for crypto errors
 pw::Status AesCbcDecrypt(pw::ConstByteSpan key,
                          pw::ConstByteSpan iv,
                          pw::ConstByteSpan ciphertext,
                          pw::ByteSpan plaintext);
 
+/// AES-128-CBC encryption of `data` in place; see AesCbcEncrypt().
+inline pw::Status AesCbcEncryptInPlace(pw::ConstByteSpan key,
+                                       pw::ConstByteSpan iv,
+                                       pw::ByteSpan data) {
+  return AesCbcEncrypt(key, iv, data, data);
+}
+
+/// AES-128-CBC decryption of `data` in place; see AesCbcDecrypt().
+inline pw::Status AesCbcDecryptInPlace(pw::ConstByteSpan key,
+                                       pw::ConstByteSpan iv,
+                                       pw::ByteSpan data) {
+  return AesCbcDecrypt(key, iv, data, data);
+}
+
 /// AES-CMAC (Cipher-based Message Authentication Code).
 ///
-/// Computes a 16-byte MAC over the input data using AES-128.
+/// Computes a 16-byte MAC over the concatenation of `segments` using
+/// AES-128, without assembling them:
+///
+/// @code
+/// const std::array<pw::ConstByteSpan, 3> message = {header, counter, data};
+/// PW_TRY(pb::crypto::AesCmac(key, message, mac));
+/// @endcode
 ///
 /// @param key 16-byte AES key
-/// @param data Input data (any length)
+/// @param segments Input data (any length, any number of segments)
 /// @param mac Output MAC (must be at least 16 bytes)
 /// @return OkStatus on success, InvalidArgument for wrong key size,
 ///         ResourceExhausted if mac too small, Internal for crypto errors
 pw::Status AesCmac(pw::ConstByteSpan key,
-                   pw::ConstByteSpan data,
+                   ByteSegments segments,
                    pw::ByteSpan mac);
 
+/// AES-CMAC of contiguous `data`.
+inline pw::Status AesCmac(pw::ConstByteSpan key,
+                          pw::ConstByteSpan data,
+                          pw::ByteSpan mac) {
+  return AesCmac(key, ByteSegments(&data, 1), mac);
+}
+
+namespace internal {
+
+/// Storage for one backend AES context (an mbedtls_aes_context), checked
+/// against the real size in the backend.
+inline constexpr size_t kAesContextSize = 288;
+
+/// True if `input` and `output` share bytes but do not start at the same
+/// address, which no pb_crypto function supports.
+inline bool PartiallyOverlaps(pw::ConstByteSpan input,
+                              pw::ConstByteSpan output) {
+  // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+  const auto in = reinterpret_cast<uintptr_t>(input.data());
+  const auto out = reinterpret_cast<uintptr_t>(output.data());
+  // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+  return in != out && in < out + output.size() && out < in + input.size();
+}
+
+}  // namespace internal
+
+/// AES-128 key with its expanded encryption and decryption schedules.
+///
+/// AesCbcEncrypt() and AesCbcDecrypt() expand the key on every call. An
+/// AesKey expands it once, e.g. when an NTAG424 session key is derived, and
+/// reuses the schedules for each operation of the session. The schedules
+/// are wiped when the key is destroyed.
+///
+/// Not copyable or movable: the backend context may point into itself.
+///
+/// @code
+/// pb::crypto::AesKey session;
+/// PW_TRY(session.SetKey(ses_auth_enc_key));
+/// PW_TRY(session.CbcEncrypt(iv, command_data, encrypted));
+/// @endcode
+class AesKey {
+ public:
+  AesKey();
+  ~AesKey();
+
+  AesKey(const AesKey&) = delete;
+  AesKey& operator=(const AesKey&) = delete;
+
+  /// Expand a key, replacing the previous one.
+  ///
+  /// @param key 16-byte AES key
+  /// @return OkStatus on success, InvalidArgument for wrong key size,
+  ///         Internal for crypto errors
+  pw::Status SetKey(pw::ConstByteSpan key);
+
+  /// True once SetKey() succeeded.
+  bool has_key() const { return has_key_; }
+
+  /// AES-128-CBC encryption; see AesCbcEncrypt().
+  /// @return As AesCbcEncrypt(), or FailedPrecondition without a key
+  pw::Status CbcEncrypt(pw::ConstByteSpan iv,
+                        pw::ConstByteSpan plaintext,
+                        pw::ByteSpan ciphertext);
+
+  /// AES-128-CBC decryption; see AesCbcDecrypt().
+  /// @return As AesCbcDecrypt(), or FailedPrecondition without a key
+  pw::Status CbcDecrypt(pw::ConstByteSpan iv,
+                        pw::ConstByteSpan ciphertext,
+                        pw::ByteSpan plaintext);
+
+  /// CbcEncrypt() of `data` in place.
+  pw::Status CbcEncryptInPlace(pw::ConstByteSpan iv, pw::ByteSpan data) {
+    return CbcEncrypt(iv, data, data);
+  }
+
+  /// CbcDecrypt() of `data` in place.
+  pw::Status CbcDecryptInPlace(pw::ConstByteSpan iv, pw::ByteSpan data) {
+    return CbcDecrypt(iv, data, data);
+  }
+
+ private:
+  alignas(8) std::array<std::byte, internal::kAesContextSize> encrypt_;
+  alignas(8) std::array<std::byte, internal::kAesContextSize> decrypt_;
+  bool has_key_ = false;
+  bool hardware_ = false;  // Key held for a hardware engine, if any
+};
+
+/// AES-CMAC key with its expanded schedule and derived subkeys.
+///
+/// Like AesKey for AesCmac(): the key schedule and the K1/K2 subkeys are
+/// computed once in SetKey(), so each MAC costs only the block
+/// encryptions. Wiped when destroyed; not copyable or movable.
+class CmacKey {
+ public:
+  CmacKey();
+  ~CmacKey();
+
+  CmacKey(const CmacKey&) = delete;
+  CmacKey& operator=(const CmacKey&) = delete;
+
+  /// Expand a key and derive its subkeys, replacing the previous key.
+  ///
+  /// @param key 16-byte AES key
+  /// @return OkStatus on success, InvalidArgument for wrong key size,
+  ///         Internal for crypto errors
+  pw::Status SetKey(pw::ConstByteSpan key);
+
+  /// True once SetKey() succeeded.
+  bool has_key() const { return has_key_; }
+
+  /// Compute the 16-byte MAC of `data`; see AesCmac().
+  /// @return As AesCmac(), or FailedPrecondition without a key
+  pw::Status Compute(pw::ConstByteSpan data, pw::ByteSpan mac) {
+    return Compute(ByteSegments(&data, 1), mac);
+  }
+
+  /// Compute the MAC of the concatenation of `segments`.
+  pw::Status Compute(ByteSegments segments, pw::ByteSpan mac);
+
+ private:
+  alignas(8) std::array<std::byte, internal::kAesContextSize> encrypt_;
+  std::array<std::byte, kAesBlockSize> k1_{};
+  std::array<std::byte, kAesBlockSize> k2_{};
+  bool has_key_ = false;
+  bool hardware_ = false;  // Key held for a hardware engine, if any
+};
+
+// ----------------------------------------------------------------------------
+// AES-GCM
+// ----------------------------------------------------------------------------
+
+/// AES-GCM nonce size in bytes (96 bits, the size GCM is specified for).
+inline constexpr size_t kAesGcmNonceSize = 12;
+
+/// AES-GCM authentication tag size in bytes.
+inline constexpr size_t kAesGcmTagSize = 16;
+
+/// AES-128-GCM authenticated encryption.
+///
+/// Encrypts and authenticates in one pass with one key schedule, instead of
+/// AesCbcEncrypt() followed by AesCmac(). Works on any plaintext length.
+/// The nonce MUST be unique for each encryption with the same key; a
+/// repeated nonce reveals the authentication key.
+///
+/// @param key 16-byte AES key
+/// @param nonce 12-byte nonce (MUST be unique per encryption)
+/// @param associated_data Data to authenticate but not encrypt (can be empty)
+/// @param plaintext Data to encrypt
+/// @param ciphertext Output buffer (same size as plaintext); may start at
+///        plaintext.data() for in-place encryption
+/// @param tag Output authentication tag (16 bytes)
+/// @return OkStatus on success, InvalidArgument for wrong sizes or
+///         partially overlapping buffers, ResourceExhausted if an output is
+///         too small, Internal for crypto errors
+pw::Status AesGcmEncrypt(pw::ConstByteSpan key,
+                         pw::ConstByteSpan nonce,
+                         pw::ConstByteSpan associated_data,
+                         pw::ConstByteSpan plaintext,
+                         pw::ByteSpan ciphertext,
+                         pw::ByteSpan tag);
+
+/// AES-128-GCM authenticated decryption.
+///
+/// Decrypts ciphertext and verifies the authentication tag. If verification
+/// fails, the plaintext buffer is zeroed and an error is returned.
+///
+/// @param key 16-byte AES key
+/// @param nonce 12-byte nonce (must match encryption)
+/// @param associated_data Associated data (must match encryption)
+/// @param ciphertext Data to decrypt
+/// @param tag Authentication tag to verify (16 bytes)
+/// @param plaintext Output buffer (same size as ciphertext); may start at
+///        ciphertext.data() for in-place decryption
+/// @return OkStatus on success, Unauthenticated if tag verification fails,
+///         InvalidArgument for wrong sizes or partially overlapping buffers,
+///         ResourceExhausted if plaintext is too small, Internal for crypto
+///         errors
+pw::Status AesGcmDecrypt(pw::ConstByteSpan key,
+                         pw::ConstByteSpan nonce,
+                         pw::ConstByteSpan associated_data,
+                         pw::ConstByteSpan ciphertext,
+                         pw::ConstByteSpan tag,
+                         pw::ByteSpan plaintext);
+
+/// AES-128-GCM encryption of `data` in place; see AesGcmEncrypt().
+inline pw::Status AesGcmEncryptInPlace(pw::ConstByteSpan key,
+                                       pw::ConstByteSpan nonce,
+                                       pw::ConstByteSpan associated_data,
+                                       pw::ByteSpan data,
+                                       pw::ByteSpan tag) {
+  return AesGcmEncrypt(key, nonce, associated_data, data, data, tag);
+}
+
+/// AES-128-GCM decryption of `data` in place; see AesGcmDecrypt().
+/// `data` is zeroed if the tag does not verify.
+inline pw::Status AesGcmDecryptInPlace(pw::ConstByteSpan key,
+                                       pw::ConstByteSpan nonce,
+                                       pw::ConstByteSpan associated_data,
+                                       pw::ByteSpan data,
+                                       pw::ConstByteSpan tag) {
+  return AesGcmDecrypt(key, nonce, associated_data, data, tag, data);
+}
+
 // ============================================================================
 // ASCON Lightweight Cryptography (NIST LWC Standard)
 // ============================================================================
@@ -114,9 +402,11 @@ inline constexpr size_t kAsconHashSize = 32;
 /// @param nonce 16-byte nonce (MUST be unique per encryption)
 /// @param associated_data Data to authenticate but not encrypt (can be empty)
 /// @param plaintext Data to encrypt
-/// @param ciphertext Output buffer (same size as plaintext)
+/// @param ciphertext Output buffer (same size as plaintext); may start at
+///        plaintext.data() for in-place encryption
 /// @param tag Output authentication tag (16 bytes)
-/// @return OkStatus on success, InvalidArgument for wrong sizes
+/// @return OkStatus on success, InvalidArgument for wrong sizes or
+///         partially overlapping buffers
 pw::Status AsconAead128Encrypt(pw::ConstByteSpan key,
                                pw::ConstByteSpan nonce,
                                pw::ConstByteSpan associated_data,
@@ -134,9 +424,10 @@ pw::Status AsconAead128Encrypt(pw::ConstByteSpan key,
 /// @param associated_data Associated data (must match encryption)
 /// @param ciphertext Data to decrypt
 /// @param tag Authentication tag to verify (16 bytes)
-/// @param plaintext Output buffer (same size as ciphertext)
+/// @param plaintext Output buffer (same size as ciphertext); may start at
+///        ciphertext.data() for in-place decryption
 /// @return OkStatus on success, Unauthenticated if tag verification fails,
-///         InvalidArgument for wrong sizes
+///         InvalidArgument for wrong sizes or partially overlapping buffers
 pw::Status AsconAead128Decrypt(pw::ConstByteSpan key,
                                pw::ConstByteSpan nonce,
                                pw::ConstByteSpan associated_data,
@@ -144,6 +435,43 @@ pw::Status AsconAead128Decrypt(pw::ConstByteSpan key,
                                pw::ConstByteSpan tag,
                                pw::ByteSpan plaintext);
 
+/// AsconAead128Encrypt() with the associated data given as segments, e.g.
+/// header and counter. (Not an overload: `{}` for empty associated data
+/// would be ambiguous.)
+pw::Status AsconAead128EncryptSegments(pw::ConstByteSpan key,
+                                       pw::ConstByteSpan nonce,
+                                       ByteSegments associated_data,
+                                       pw::ConstByteSpan plaintext,
+                                       pw::ByteSpan ciphertext,
+                                       pw::ByteSpan tag);
+
+/// AsconAead128Decrypt() with the associated data given as segments.
+pw::Status AsconAead128DecryptSegments(pw::ConstByteSpan key,
+                                       pw::ConstByteSpan nonce,
+                                       ByteSegments associated_data,
+                                       pw::ConstByteSpan ciphertext,
+                                       pw::ConstByteSpan tag,
+                                       pw::ByteSpan plaintext);
+
+/// ASCON-AEAD128 encryption of `data` in place; see AsconAead128Encrypt().
+inline pw::Status AsconAead128EncryptInPlace(pw::ConstByteSpan key,
+                                             pw::ConstByteSpan nonce,
+                                             pw::ConstByteSpan associated_data,
+                                             pw::ByteSpan data,
+                                             pw::ByteSpan tag) {
+  return AsconAead128Encrypt(key, nonce, associated_data, data, data, tag);
+}
+
+/// ASCON-AEAD128 decryption of `data` in place; see AsconAead128Decrypt().
+/// `data` is zeroed if the tag does not verify.
+inline pw::Status AsconAead128DecryptInPlace(pw::ConstByteSpan key,
+                                             pw::ConstByteSpan nonce,
+                                             pw::ConstByteSpan associated_data,
+                                             pw::ByteSpan data,
+                                             pw::ConstByteSpan tag) {
+  return AsconAead128Decrypt(key, nonce, associated_data, data, tag, data);
+}
+
 /// ASCON-Hash256 cryptographic hash.
 ///
 /// Computes a 256-bit hash of the input message.
@@ -153,4 +481,218 @@ pw::Status AsconAead128Decrypt(pw::ConstByteSpan key,
 /// @return OkStatus on success, ResourceExhausted if hash buffer too small
 pw::Status AsconHash256(pw::ConstByteSpan message, pw::ByteSpan hash);
 
+// ----------------------------------------------------------------------------
+// Incremental ASCON
+// ----------------------------------------------------------------------------
+
+namespace internal {
+
+/// ASCON-AEAD128 duplex state shared by the encryptor and decryptor.
+class AsconAeadState {
+ public:
+  AsconAeadState() = default;
+  ~AsconAeadState();
+
+  AsconAeadState(const AsconAeadState&) = delete;
+  AsconAeadState& operator=(const AsconAeadState&) = delete;
+
+  pw::Status Start(pw::ConstByteSpan key, pw::ConstByteSpan nonce);
+  pw::Status AbsorbAssociatedData(pw::ConstByteSpan associated_data);
+  pw::Status Crypt(bool decrypt, pw::ConstByteSpan input, pw::ByteSpan output);
+  /// Finalizes, writes the tag and wipes the state.
+  pw::Status Finish(std::array<std::byte, kAsconTagSize>& tag);
+
+ private:
+  enum class Phase : uint8_t { kIdle, kAssociatedData, kData };
+
+  void StartData();
+  void Wipe();
+
+  std::array<uint64_t, 5> state_{};
+  std::array<uint64_t, 2> key_{};
+  size_t position_ = 0;  // Byte offset in the 8-byte rate
+  bool has_associated_data_ = false;
+  Phase phase_ = Phase::kIdle;
+};
+
+}  // namespace internal
+
+/// Incremental ASCON-AEAD128 encryption.
+///
+/// Gives the same ciphertext and tag as AsconAead128Encrypt() over the
+/// concatenated chunks, for chunks of any size, so a frame can be encrypted
+/// as it arrives without assembling it first. Ciphertext is written as soon
+/// as each plaintext chunk is passed in.
+///
+/// @code
+/// pb::crypto::AsconAead128Encryptor encryptor;
+/// PW_TRY(encryptor.Start(key, nonce));
+/// PW_TRY(encryptor.UpdateAssociatedData(header));
+/// while (...) {
+///   PW_TRY(encryptor.Update(chunk, ciphertext.subspan(offset)));
+/// }
+/// PW_TRY(encryptor.Finish(tag));
+/// @endcode
+///
+/// All associated data must come before the first Update(). The key is
+/// wiped by Finish() and by the destructor.
+class AsconAead128Encryptor {
+ public:
+  /// Begin a message; discards any unfinished one.
+  /// @return OkStatus, or InvalidArgument for wrong key or nonce size
+  pw::Status Start(pw::ConstByteSpan key, pw::ConstByteSpan nonce) {
+    return state_.Start(key, nonce);
+  }
+
+  /// Absorb associated data (authenticated, not encrypted).
+  /// @return OkStatus, or FailedPrecondition if not started or after
+  ///         Update()
+  pw::Status UpdateAssociatedData(pw::ConstByteSpan associated_data) {
+    return state_.AbsorbAssociatedData(associated_data);
+  }
+
+  /// Encrypt the next plaintext chunk into the first plaintext.size() bytes
+  /// of `ciphertext`, which may be the plaintext itself.
+  /// @return OkStatus, FailedPrecondition if not started,
+  ///         ResourceExhausted if ciphertext is too small, or InvalidArgument if
+  ///         the buffers partially overlap
+  pw::Status Update(pw::ConstByteSpan plaintext, pw::ByteSpan ciphertext) {
+    return state_.Crypt(false, plaintext, ciphertext);
+  }
+
+  /// Finish the message and write its 16-byte tag. Start() again for the
+  /// next message.
+  /// @return OkStatus, FailedPrecondition if not started, or
+  ///         ResourceExhausted if tag is too small
+  pw::Status Finish(pw::ByteSpan tag);
+
+ private:
+  internal::AsconAeadState state_;
+};
+
+/// Incremental ASCON-AEAD128 decryption.
+///
+/// Counterpart of AsconAead128Encryptor. Plaintext is written as each chunk
+/// is passed in, before the tag is known: nothing may be acted on until
+/// Finish() returns OkStatus. Unlike AsconAead128Decrypt(), earlier chunks
+/// cannot be zeroed on failure; the caller discards them.
+class AsconAead128Decryptor {
+ public:
+  /// Begin a message; discards any unfinished one.
+  /// @return OkStatus, or InvalidArgument for wrong key or nonce size
+  pw::Status Start(pw::ConstByteSpan key, pw::ConstByteSpan nonce) {
+    return state_.Start(key, nonce);
+  }
+
+  /// Absorb associated data (must match encryption).
+  /// @return OkStatus, or FailedPrecondition if not started or after
+  ///         Update()
+  pw::Status UpdateAssociatedData(pw::ConstByteSpan associated_data) {
+    return state_.AbsorbAssociatedData(associated_data);
+  }
+
+  /// Decrypt the next ciphertext chunk into the first ciphertext.size()
+  /// bytes of `plaintext`, which may be the ciphertext itself.
+  /// @return OkStatus, FailedPrecondition if not started,
+  ///         ResourceExhausted if plaintext is too small, or InvalidArgument if
+  ///         the buffers partially overlap
+  pw::Status Update(pw::ConstByteSpan ciphertext, pw::ByteSpan plaintext) {
+    return state_.Crypt(true, ciphertext, plaintext);
+  }
+
+  /// Finish the message and verify its tag (constant time).
+  /// @return OkStatus if authentic, Unauthenticated if not,
+  ///         InvalidArgument for wrong tag size, FailedPrecondition if not
+  ///         started
+  pw::Status Finish(pw::ConstByteSpan tag);
+
+ private:
+  internal::AsconAeadState state_;
+};
+
+/// Incremental ASCON-Hash256.
+///
+/// Gives the same hash as AsconHash256() over the concatenated chunks.
+/// Ready after construction; Finish() resets it for the next message.
+class AsconHash256Hasher {
+ public:
+  AsconHash256Hasher();
+
+  /// Absorb the next chunk of the message.
+  void Update(pw::ConstByteSpan data);
+
+  /// Write the 32-byte hash and reset.
+  /// @return OkStatus, or ResourceExhausted if hash is too small
+  pw::Status Finish(pw::ByteSpan hash);
+
+ private:
+  void Reset();
+
+  std::array<uint64_t, 5> state_{};
+  size_t position_ = 0;  // Byte offset in the 8-byte rate
+};
+
+// ============================================================================
+// Random Nonces and IVs
+// ============================================================================
+
+namespace internal {
+
+/// Storage for one backend DRBG (an mbedtls_ctr_drbg_context), checked
+/// against the real size in the backend.
+inline constexpr size_t kCtrDrbgContextSize = 448;
+
+}  // namespace internal
+
+/// Random nonces, IVs and keys from an mbedTLS CTR-DRBG.
+///
+/// Seeded once from the hardware RNG (std::random_device on host); after
+/// that each Generate() costs a few AES blocks instead of one RNG read per
+/// word. The DRBG reseeds itself from the hardware RNG at mbedTLS's reseed
+/// interval.
+///
+/// Random 16-byte ASCON nonces do not repeat in practice. A random 12-byte
+/// GCM nonce should be used for at most 2^32 messages per key.
+///
+/// Not thread-safe and not copyable or movable; the state is wiped when
+/// destroyed.
+///
+/// @code
+/// pb::crypto::NonceGenerator nonces;
+/// PW_TRY(nonces.Seed());
+///
+/// std::array<std::byte, pb::crypto::kAsconNonceSize> nonce;
+/// PW_TRY(nonces.Generate(nonce));
+/// PW_TRY(pb::crypto::AsconAead128Encrypt(key, nonce, {}, plaintext,
+///                                         ciphertext, tag));
+/// @endcode
+class NonceGenerator {
+ public:
+  NonceGenerator();
+  ~NonceGenerator();
+
+  NonceGenerator(const NonceGenerator&) = delete;
+  NonceGenerator& operator=(const NonceGenerator&) = delete;
+
+  /// Seed from the hardware RNG, replacing the previous state.
+  ///
+  /// @param personalization Optional bytes that make this instance's output
+  ///        differ from others seeded at the same time, e.g. a device ID
+  /// @return OkStatus on success, Internal if seeding fails
+  pw::Status Seed(pw::ConstByteSpan personalization = {});
+
+  /// True once Seed() succeeded.
+  bool seeded() const { return seeded_; }
+
+  /// Fill `output` with random bytes, e.g. a nonce or an IV.
+  ///
+  /// @return OkStatus on success, FailedPrecondition if not seeded,
+  ///         Internal for DRBG errors
+  pw::Status Generate(pw::ByteSpan output);
+
+ private:
+  alignas(8) std::array<std::byte, internal::kCtrDrbgContextSize> context_;
+  bool seeded_ = false;
+};
+
 }  // namespace pb::crypto
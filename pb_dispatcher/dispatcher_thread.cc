@@ -0,0 +1,155 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#define PW_LOG_MODULE_NAME "pb_disp"
+
+#include "pb_dispatcher/dispatcher_thread.h"
+
+#include <mutex>
+
+#include "pw_log/log.h"
+
+namespace pb {
+
+DispatcherThread::DispatcherThread() { dispatcher_.Post(inbox_); }
+
+DispatcherThread::~DispatcherThread() {
+  Stop();
+  inbox_.Deregister();
+}
+
+pw::Status DispatcherThread::Start(const pw::thread::Options& options) {
+  if (started_) {
+    return pw::Status::FailedPrecondition();
+  }
+  {
+    std::lock_guard lock(lock_);
+    stop_ = false;
+  }
+  thread_ = pw::Thread(options, [this]() {
+    Run();
+    exited_.release();
+  });
+  started_ = true;
+  return pw::OkStatus();
+}
+
+void DispatcherThread::Run() {
+  // The inbox completes on Stop(); a restart posts it again
+  if (!inbox_.IsRegistered()) {
+    dispatcher_.Post(inbox_);
+  }
+  dispatcher_.RunToCompletion();
+}
+
+void DispatcherThread::Stop() {
+  {
+    std::lock_guard lock(lock_);
+    stop_ = true;
+    while (count_ > 0) {
+      queue_[head_] = nullptr;
+      head_ = (head_ + 1) % queue_.size();
+      --count_;
+    }
+  }
+  WakeInbox();
+  if (started_) {
+    // Joining would also wait for the idle task to delete the exited
+    // thread, which a busy higher-priority caller can starve; once Run()
+    // has returned, nothing touches this object, and the detached thread
+    // frees its own context.
+    exited_.acquire();
+    thread_.detach();
+    started_ = false;
+  }
+}
+
+pw::Status DispatcherThread::PostWork(WorkItem&& work) {
+  {
+    std::lock_guard lock(lock_);
+    if (stop_) {
+      return pw::Status::FailedPrecondition();
+    }
+    if (count_ >= queue_.size()) {
+      PW_LOG_WARN("DispatcherThread: queue full");
+      return pw::Status::ResourceExhausted();
+    }
+    queue_[(head_ + count_) % queue_.size()] = std::move(work);
+    ++count_;
+    if (count_ > max_count_) {
+      max_count_ = count_;
+    }
+  }
+  WakeInbox();
+  return pw::OkStatus();
+}
+
+size_t DispatcherThread::queued() {
+  std::lock_guard lock(lock_);
+  return count_;
+}
+
+size_t DispatcherThread::max_queued() {
+  std::lock_guard lock(lock_);
+  return max_count_;
+}
+
+pw::async2::Poll<> DispatcherThread::PendInbox(pw::async2::Context& cx) {
+  // Only the items queued now: work that keeps posting work must not
+  // starve the tasks
+  size_t budget = queue_.size();
+  while (budget-- > 0) {
+    WorkItem work = Pop();
+    if (work == nullptr) {
+      break;
+    }
+    work();
+  }
+
+  pw::async2::Waker yield;
+  {
+    std::lock_guard lock(lock_);
+    if (stop_) {
+      return pw::async2::Ready();
+    }
+    PW_ASYNC_STORE_WAKER(cx, waker_, "Waiting for posted work");
+    has_waker_ = true;
+    if (count_ == 0) {
+      return pw::async2::Pending();
+    }
+    // Yield to the other tasks; the rest runs on the next poll
+    yield = std::move(waker_);
+    has_waker_ = false;
+  }
+  yield.Wake();
+  return pw::async2::Pending();
+}
+
+DispatcherThread::WorkItem DispatcherThread::Pop() {
+  std::lock_guard lock(lock_);
+  if (count_ == 0 || stop_) {
+    return nullptr;
+  }
+  WorkItem work = std::move(queue_[head_]);
+  queue_[head_] = nullptr;
+  head_ = (head_ + 1) % queue_.size();
+  --count_;
+  return work;
+}
+
+void DispatcherThread::WakeInbox() {
+  // Wake() acquires internal pw_async2 locks, so we must not hold our
+  // lock while calling it
+  pw::async2::Waker waker;
+  {
+    std::lock_guard lock(lock_);
+    if (!has_waker_) {
+      return;
+    }
+    waker = std::move(waker_);
+    has_waker_ = false;
+  }
+  waker.Wake();
+}
+
+}  // namespace pb
@@ -0,0 +1,143 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_dispatcher/dispatcher_thread.h"
+
+#include <optional>
+
+#include "pw_async2/pend_func_task.h"
+#include "pw_result/result.h"
+#include "pw_unit_test/framework.h"
+
+namespace pb {
+namespace {
+
+using pw::async2::Context;
+using pw::async2::PendFuncTask;
+using pw::async2::Poll;
+using pw::async2::Ready;
+
+constexpr size_t kQueueSize = dispatcher::config::kQueueSize;
+
+// Host tests drive the dispatchers with RunUntilStalled() instead of
+// starting their threads.
+
+TEST(DispatcherThread, RunsPostedWorkOnDispatcher) {
+  DispatcherThread dispatcher;
+  int runs = 0;
+
+  ASSERT_EQ(dispatcher.PostWork([&runs] { ++runs; }), pw::OkStatus());
+  EXPECT_EQ(runs, 0);
+  EXPECT_EQ(dispatcher.queued(), 1u);
+
+  dispatcher.dispatcher().RunUntilStalled();
+  EXPECT_EQ(runs, 1);
+  EXPECT_EQ(dispatcher.queued(), 0u);
+}
+
+TEST(DispatcherThread, RunsWorkPostedFromWork) {
+  DispatcherThread dispatcher;
+  int runs = 0;
+
+  auto post_again = [&] {
+    ++runs;
+    EXPECT_EQ(dispatcher.PostWork([&runs] { ++runs; }), pw::OkStatus());
+  };
+  ASSERT_EQ(dispatcher.PostWork(post_again), pw::OkStatus());
+
+  dispatcher.dispatcher().RunUntilStalled();
+  EXPECT_EQ(runs, 2);
+}
+
+TEST(DispatcherThread, RejectsWorkWhenQueueFull) {
+  DispatcherThread dispatcher;
+  int runs = 0;
+
+  for (size_t i = 0; i < kQueueSize; ++i) {
+    ASSERT_EQ(dispatcher.PostWork([&runs] { ++runs; }), pw::OkStatus());
+  }
+  EXPECT_EQ(dispatcher.PostWork([&runs] { ++runs; }),
+            pw::Status::ResourceExhausted());
+  EXPECT_EQ(dispatcher.max_queued(), kQueueSize);
+
+  dispatcher.dispatcher().RunUntilStalled();
+  EXPECT_EQ(runs, static_cast<int>(kQueueSize));
+}
+
+TEST(DispatcherThread, StopDropsQueuedWork) {
+  DispatcherThread dispatcher;
+  int runs = 0;
+
+  ASSERT_EQ(dispatcher.PostWork([&runs] { ++runs; }), pw::OkStatus());
+  dispatcher.Stop();
+  EXPECT_EQ(dispatcher.queued(), 0u);
+  EXPECT_EQ(dispatcher.PostWork([&runs] { ++runs; }),
+            pw::Status::FailedPrecondition());
+
+  dispatcher.dispatcher().RunUntilStalled();
+  EXPECT_EQ(runs, 0);
+}
+
+TEST(DispatcherThread, CallResolvesFutureOnOtherDispatcher) {
+  DispatcherThread io;
+  DispatcherThread background;
+  pw::async2::ValueProvider<pw::Status> provider;
+  bool ran_on_io = false;
+  std::optional<pw::Status> result;
+
+  pw::async2::ValueFuture<pw::Status> future =
+      io.Call(provider, [&ran_on_io] {
+        ran_on_io = true;
+        return pw::Status::DataLoss();
+      });
+  PendFuncTask task([&](Context& cx) -> Poll<> {
+    Poll<pw::Status> poll = future.Pend(cx);
+    if (poll.IsPending()) {
+      return pw::async2::Pending();
+    }
+    result = *poll;
+    return Ready();
+  });
+  background.Post(task);
+
+  background.dispatcher().RunUntilStalled();
+  EXPECT_FALSE(result.has_value());
+
+  io.dispatcher().RunUntilStalled();
+  EXPECT_TRUE(ran_on_io);
+  EXPECT_FALSE(result.has_value());
+
+  background.dispatcher().RunUntilStalled();
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(*result, pw::Status::DataLoss());
+}
+
+TEST(DispatcherThread, CallResolvesRightAwayWhenQueueFull) {
+  DispatcherThread io;
+  for (size_t i = 0; i < kQueueSize; ++i) {
+    ASSERT_EQ(io.PostWork([] {}), pw::OkStatus());
+  }
+
+  pw::async2::ValueProvider<pw::Result<int>> provider;
+  pw::async2::ValueFuture<pw::Result<int>> future =
+      io.Call(provider, []() -> pw::Result<int> { return 7; });
+
+  std::optional<pw::Result<int>> result;
+  PendFuncTask task([&](Context& cx) -> Poll<> {
+    Poll<pw::Result<int>> poll = future.Pend(cx);
+    if (poll.IsPending()) {
+      return pw::async2::Pending();
+    }
+    result = *poll;
+    return Ready();
+  });
+  pw::async2::BasicDispatcher caller;
+  caller.Post(task);
+  caller.RunUntilStalled();
+
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->status(), pw::Status::ResourceExhausted());
+}
+
+}  // namespace
+}  // namespace pb
@@ -0,0 +1,36 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+
+// Configuration options for pb_dispatcher
+
+// Work items one DispatcherThread holds before PostWork() fails. Each slot
+// is a pw::Function in the DispatcherThread object.
+#ifndef PB_DISPATCHER_QUEUE_SIZE
+#define PB_DISPATCHER_QUEUE_SIZE 8
+#endif  // PB_DISPATCHER_QUEUE_SIZE
+
+// Suggested dispatcher stack: coroutine frames live in their allocator,
+// the stack only holds the deepest DoPend() call chain. Size it from a
+// stack report (pb_integration_tests/harness/stack_report.py).
+#ifndef PB_DISPATCHER_DEFAULT_STACK_SIZE
+#define PB_DISPATCHER_DEFAULT_STACK_SIZE 4096
+#endif  // PB_DISPATCHER_DEFAULT_STACK_SIZE
+
+namespace pb::dispatcher::config {
+
+inline constexpr size_t kQueueSize = PB_DISPATCHER_QUEUE_SIZE;
+
+inline constexpr size_t kDefaultStackSize = PB_DISPATCHER_DEFAULT_STACK_SIZE;
+
+// Suggested priorities. The I/O dispatcher runs above the application
+// (2) and the AsyncUart service thread (3), so frame handling preempts
+// bulk work; the background dispatcher runs below the application, just
+// above the idle thread (pb_power, 0).
+inline constexpr int kIoPriority = 4;
+inline constexpr int kBackgroundPriority = 1;
+
+}  // namespace pb::dispatcher::config
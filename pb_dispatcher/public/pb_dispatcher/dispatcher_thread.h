@@ -0,0 +1,181 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file dispatcher_thread.h
+/// @brief pw_async2 dispatcher on a thread of its own.
+///
+/// All tasks on one dispatcher share its thread: while one task parses a
+/// large CBOR payload, a UART frame waits. Running latency-sensitive tasks
+/// and bulk work on separate DispatcherThreads, each at its own priority,
+/// lets the scheduler preempt the bulk work instead.
+///
+/// Usage:
+/// @code
+/// pb::DispatcherThread io_dispatcher;
+/// pb::DispatcherThread background_dispatcher;
+///
+/// io_dispatcher.Start(pw::thread::particle::Options()
+///                         .set_name("io_dispatch")
+///                         .set_priority(pb::dispatcher::config::kIoPriority)
+///                         .set_stack_size(
+///                             pb::dispatcher::config::kDefaultStackSize));
+/// io_dispatcher.Post(uart_task);
+///
+/// // From a task on background_dispatcher: run on the I/O thread and
+/// // await the result
+/// pw::async2::ValueProvider<pw::Status> sent;
+/// pw::Status status = co_await io_dispatcher.Call(
+///     sent, [&] { return rpc_channel.Send(packet); });
+/// @endcode
+///
+/// Tasks never move between dispatchers; a task posted to one is polled
+/// only by its thread. Wakers are safe to wake from any thread, so a
+/// future resolved on one dispatcher wakes its waiter on the other.
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "pb_dispatcher/config.h"
+#include "pw_async2/basic_dispatcher.h"
+#include "pw_async2/context.h"
+#include "pw_async2/poll.h"
+#include "pw_async2/task.h"
+#include "pw_async2/value_future.h"
+#include "pw_async2/waker.h"
+#include "pw_function/function.h"
+#include "pw_status/status.h"
+#include "pw_sync/mutex.h"
+#include "pw_sync/thread_notification.h"
+#include "pw_thread/options.h"
+#include "pw_thread/thread.h"
+
+namespace pb {
+
+/// A pw::async2::BasicDispatcher run by its own thread, with an inbox for
+/// work posted from other threads and dispatchers.
+class DispatcherThread {
+ public:
+  using WorkItem = pw::Function<void()>;
+
+  DispatcherThread();
+
+  /// Stops the thread; work still queued is dropped without running.
+  ~DispatcherThread();
+
+  DispatcherThread(const DispatcherThread&) = delete;
+  DispatcherThread& operator=(const DispatcherThread&) = delete;
+
+  /// Start the thread that runs the dispatcher.
+  ///
+  /// @return OkStatus, or FailedPrecondition if already started
+  pw::Status Start(const pw::thread::Options& options);
+
+  /// Run the dispatcher on the calling thread until Stop().
+  ///
+  /// Used by the thread Start() creates; call it instead of Start() to
+  /// run the dispatcher on a thread that already exists, e.g. the Device
+  /// OS application thread (pw_system_particle).
+  void Run();
+
+  /// End Run() and wait for it to return on the thread Start() created.
+  /// Run() returns once the tasks still posted complete, so deregister
+  /// long-running tasks first. Work still queued is dropped without
+  /// running.
+  void Stop();
+
+  /// Post `task` to the dispatcher. Safe from any thread.
+  void Post(pw::async2::Task& task) { dispatcher_.Post(task); }
+
+  /// Queue `work` to run on the dispatcher thread, between task polls.
+  /// Safe from any thread; never blocks. Work must not block either: it
+  /// holds up every task on this dispatcher while it runs.
+  ///
+  /// @return OkStatus, ResourceExhausted if the queue is full, or
+  ///         FailedPrecondition after Stop()
+  pw::Status PostWork(WorkItem&& work);
+
+  /// Run `function` on the dispatcher thread and resolve `provider` with
+  /// its result. Returns the future of `provider`, to be awaited from any
+  /// dispatcher. If the work cannot be queued, the future resolves with
+  /// the status of PostWork() right away, so `T` is pw::Status or a
+  /// pw::Result.
+  ///
+  /// `provider` must outlive the call. The captures of `function` plus a
+  /// pointer must fit the inline storage of pw::Function.
+  template <typename T, typename Function>
+  pw::async2::ValueFuture<T> Call(pw::async2::ValueProvider<T>& provider,
+                                  Function&& function);
+
+  /// The dispatcher. Host tests run it with RunUntilStalled() instead of
+  /// starting the thread.
+  pw::async2::BasicDispatcher& dispatcher() { return dispatcher_; }
+
+  /// Number of work items waiting for the dispatcher.
+  size_t queued();
+
+  /// Largest number of work items that were waiting at once, to size the
+  /// queue.
+  size_t max_queued();
+
+ private:
+  // Runs posted work; pending until Stop() so the dispatcher never runs
+  // out of tasks
+  class Inbox final : public pw::async2::Task {
+   public:
+    explicit Inbox(DispatcherThread& owner) : owner_(owner) {}
+
+   private:
+    pw::async2::Poll<> DoPend(pw::async2::Context& cx) override {
+      return owner_.PendInbox(cx);
+    }
+
+    DispatcherThread& owner_;
+  };
+
+  pw::async2::Poll<> PendInbox(pw::async2::Context& cx);
+
+  // Take the oldest item, or an empty function if none
+  WorkItem Pop();
+
+  void WakeInbox();
+
+  pw::async2::BasicDispatcher dispatcher_;
+  Inbox inbox_{*this};
+
+  pw::sync::Mutex lock_;
+  // Protected by lock_
+  std::array<WorkItem, dispatcher::config::kQueueSize> queue_;
+  size_t head_ = 0;          // Protected by lock_
+  size_t count_ = 0;         // Protected by lock_
+  size_t max_count_ = 0;     // Protected by lock_
+  bool stop_ = false;        // Protected by lock_
+  pw::async2::Waker waker_;  // Protected by lock_
+  bool has_waker_ = false;   // Protected by lock_
+
+  pw::sync::ThreadNotification exited_;  // Released as Run() returns
+  pw::Thread thread_;
+  bool started_ = false;
+};
+
+template <typename T, typename Function>
+pw::async2::ValueFuture<T> DispatcherThread::Call(
+    pw::async2::ValueProvider<T>& provider, Function&& function) {
+  static_assert(std::is_constructible_v<T, pw::Status>,
+                "Call() resolves with a status if the work cannot be "
+                "queued; use pw::Status or pw::Result<T>");
+  pw::async2::ValueFuture<T> future = provider.Get();
+  pw::Status status = PostWork(
+      [&provider, function = std::forward<Function>(function)]() mutable {
+        provider.Resolve(function());
+      });
+  if (!status.ok()) {
+    provider.Resolve(T(status));
+  }
+  return future;
+}
+
+}  // namespace pb
@@ -0,0 +1,138 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_integration_tests/firmware/rpc_benchmark_service.h"
+
+#include <chrono>
+#include <mutex>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_thread/sleep.h"
+#include "pw_thread/thread.h"
+
+namespace pb::test {
+namespace {
+
+namespace msgs = benchmark::pwpb;
+
+using pw::chrono::SystemClock;
+
+// How long a stream message may wait for room in the transport before the
+// stream is aborted
+constexpr auto kSendTimeout = std::chrono::seconds(1);
+constexpr auto kSendRetryInterval = std::chrono::milliseconds(1);
+
+}  // namespace
+
+pw::Status RpcBenchmarkService::Start(const pw::thread::Options& options) {
+  {
+    std::lock_guard lock(lock_);
+    if (started_) {
+      return pw::Status::FailedPrecondition();
+    }
+    started_ = true;
+  }
+  // Lives as long as the service, which lives as long as the RPC server
+  pw::Thread(options, [this]() { Run(); }).detach();
+  return pw::OkStatus();
+}
+
+pw::Status RpcBenchmarkService::Ping(
+    const msgs::PingRequest::Message& request,
+    msgs::PingResponse::Message& response) {
+  response.sequence = request.sequence;
+  response.device_time_us = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          SystemClock::now().time_since_epoch())
+          .count());
+  return pw::OkStatus();
+}
+
+pw::Status RpcBenchmarkService::Echo(const msgs::EchoMessage::Message& request,
+                                     msgs::EchoMessage::Message& response) {
+  response.payload.assign(request.payload.begin(), request.payload.end());
+  return pw::OkStatus();
+}
+
+void RpcBenchmarkService::StreamMessages(
+    const msgs::StreamRequest::Message& request,
+    pw::rpc::PwpbServerWriter<msgs::StreamMessage::Message>& writer) {
+  if (request.payload_size > kMaxBenchmarkPayload) {
+    writer.Finish(pw::Status::InvalidArgument()).IgnoreError();
+    return;
+  }
+  {
+    std::lock_guard lock(lock_);
+    if (started_ && !streaming_) {
+      streaming_ = true;
+      count_ = request.count;
+      payload_size_ = request.payload_size;
+      writer_ = std::move(writer);
+    }
+  }
+  if (writer.active()) {
+    // Not taken over: not started or another stream is running
+    writer.Finish(pw::Status::Unavailable()).IgnoreError();
+    return;
+  }
+  notification_.release();
+}
+
+void RpcBenchmarkService::Run() {
+  while (true) {
+    notification_.acquire();
+
+    uint32_t count;
+    {
+      std::lock_guard lock(lock_);
+      count = count_;
+      message_.payload.resize(payload_size_);
+    }
+    for (size_t i = 0; i < message_.payload.size(); ++i) {
+      message_.payload[i] = static_cast<std::byte>(i * 7 + 1);
+    }
+
+    const SystemClock::time_point start = SystemClock::now();
+    pw::Status status;
+    uint32_t sent = 0;
+    while (sent < count) {
+      message_.sequence = sent;
+      status = Send();
+      if (!status.ok()) {
+        break;
+      }
+      ++sent;
+    }
+    const auto elapsed_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            SystemClock::now() - start)
+            .count();
+    PW_LOG_INFO("StreamMessages: %u x %u B in %u ms (%d)",
+                static_cast<unsigned>(sent),
+                static_cast<unsigned>(message_.payload.size()),
+                static_cast<unsigned>(elapsed_ms),
+                static_cast<int>(status.code()));
+
+    std::lock_guard lock(lock_);
+    writer_.Finish(status).IgnoreError();
+    streaming_ = false;
+  }
+}
+
+pw::Status RpcBenchmarkService::Send() {
+  const SystemClock::time_point deadline = SystemClock::now() + kSendTimeout;
+  while (true) {
+    // Writes fail while the transport's packet queue is full
+    pw::Status status = writer_.Write(message_);
+    if (status.ok() || status.IsFailedPrecondition()) {
+      return status;  // Sent, or the client cancelled the call
+    }
+    if (SystemClock::now() >= deadline) {
+      return pw::Status::DeadlineExceeded();
+    }
+    pw::this_thread::sleep_for(kSendRetryInterval);
+  }
+}
+
+}  // namespace pb::test
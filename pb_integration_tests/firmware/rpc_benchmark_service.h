@@ -0,0 +1,89 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// pw_rpc transport benchmark service.
+//
+// Ping, Echo and StreamMessages measure round-trip latency, payload
+// throughput in both directions and device-to-host streaming throughput of
+// the transport the RPC server runs on (USB CDC in TestSystemInit, or e.g.
+// TcpSocketStreamAdapter in a test firmware serving RPC over TCP). The host
+// side is RpcBenchmark in pb_integration_tests/harness/rpc_client.py.
+//
+// TestSystemInit registers one instance on every test firmware. To serve it
+// from another RPC server:
+//
+//   static pb::test::RpcBenchmarkService benchmark;
+//   benchmark.Start(pw::thread::particle::Options()
+//                       .set_name("rpc_bench")
+//                       .set_stack_size(pb::test::kRpcBenchmarkStackSize));
+//   server.RegisterService(benchmark);
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pb_integration_tests/firmware/rpc_benchmark.rpc.pwpb.h"
+#include "pw_rpc/pwpb/server_reader_writer.h"
+#include "pw_status/status.h"
+#include "pw_sync/mutex.h"
+#include "pw_sync/thread_notification.h"
+#include "pw_thread/options.h"
+
+namespace pb::test {
+
+/// Largest Echo and StreamMessages payload (see rpc_benchmark.options).
+inline constexpr size_t kMaxBenchmarkPayload = 512;
+
+/// Suggested stack size of the streaming thread. The message being sent
+/// lives in the service, not on the stack.
+inline constexpr size_t kRpcBenchmarkStackSize = 2048;
+
+class RpcBenchmarkService
+    : public benchmark::pw_rpc::pwpb::RpcBenchmark::Service<
+          RpcBenchmarkService> {
+ public:
+  RpcBenchmarkService() = default;
+
+  RpcBenchmarkService(const RpcBenchmarkService&) = delete;
+  RpcBenchmarkService& operator=(const RpcBenchmarkService&) = delete;
+
+  /// Starts the thread that sends StreamMessages responses. Streaming from
+  /// the RPC handler itself would block the thread that drains the
+  /// transport. Without Start(), StreamMessages fails with Unavailable.
+  pw::Status Start(const pw::thread::Options& options);
+
+  pw::Status Ping(const benchmark::pwpb::PingRequest::Message& request,
+                  benchmark::pwpb::PingResponse::Message& response);
+
+  pw::Status Echo(const benchmark::pwpb::EchoMessage::Message& request,
+                  benchmark::pwpb::EchoMessage::Message& response);
+
+  /// Streams `count` messages of `payload_size` bytes, then finishes with
+  /// OK. Only one stream runs at a time; another request while one is
+  /// running finishes with Unavailable.
+  void StreamMessages(
+      const benchmark::pwpb::StreamRequest::Message& request,
+      pw::rpc::PwpbServerWriter<benchmark::pwpb::StreamMessage::Message>&
+          writer);
+
+ private:
+  [[noreturn]] void Run();
+
+  /// Sends message_, retrying while the transport has no room for it.
+  pw::Status Send();
+
+  pw::sync::ThreadNotification notification_;
+
+  pw::sync::Mutex lock_;
+  bool started_ = false;   // Guarded by lock_
+  bool streaming_ = false; // Guarded by lock_
+  pw::rpc::PwpbServerWriter<benchmark::pwpb::StreamMessage::Message> writer_;
+  uint32_t count_ = 0;
+  uint32_t payload_size_ = 0;
+
+  // Only used by the streaming thread
+  benchmark::pwpb::StreamMessage::Message message_;
+};
+
+}  // namespace pb::test
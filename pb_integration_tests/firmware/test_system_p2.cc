@@ -7,6 +7,9 @@
 
 #include <cstddef>
 
+#include "pb_integration_tests/firmware/rpc_benchmark_service.h"
+#include "pb_integration_tests/firmware/thread_stack_service.h"
+
 // Pigweed headers first - before Particle headers that define pin macros
 #include "pw_channel/stream_channel.h"
 #include "pw_log/log.h"
@@ -16,6 +19,7 @@
 #include "pw_thread_particle/options.h"
 
 // Particle HAL headers
+#include "pb_boot/boot_timeline.h"
 #include "pb_log/log_bridge.h"
 #include "delay_hal.h"
 #include "system_cloud.h"
@@ -29,6 +33,7 @@ pw::rpc::Server& GetRpcServer() { return pw::System().rpc_server(); }
 
 void TestSystemInit(pw::Function<void()> init_callback) {
   pb::log::InitLogBridge();
+  pb::boot::MarkBootMilestone("log_bridge");
 
   // Wait up to 10s for USB serial connection (for logs/RPC)
   for (int i = 0; i < 100; i++) {
@@ -46,8 +51,24 @@ void TestSystemInit(pw::Function<void()> init_callback) {
     HAL_Delay_Milliseconds(100);
   }
 
+  pb::boot::MarkBootMilestone("usb_serial");
+
   // Call test-specific initialization
   init_callback();
+  pb::boot::MarkBootMilestone("init_callback");
+
+  // Transport benchmarks (RpcBenchmark in harness/rpc_client.py)
+  static RpcBenchmarkService benchmark_service;
+  benchmark_service
+      .Start(pw::thread::particle::Options()
+                 .set_name("rpc_bench")
+                 .set_stack_size(kRpcBenchmarkStackSize))
+      .IgnoreError();
+  GetRpcServer().RegisterService(benchmark_service);
+
+  // Stack high-water marks (StackReport in harness/stack_report.py)
+  static ThreadStackService thread_stack_service;
+  GetRpcServer().RegisterService(thread_stack_service);
 
   // Set up RPC channel over USB serial
   static std::byte channel_buffer[8192];
@@ -66,6 +87,8 @@ void TestSystemInit(pw::Function<void()> init_callback) {
           .set_stack_size(8192),
       multibuf_alloc);
 
+  pb::boot::MarkBootMilestone("pw_system_start");
+  pb::boot::LogBootTimeline();
   PW_LOG_INFO("=== Integration Test System Ready ===");
 
   pw::system::StartAndClobberTheStack(channel->channel());
@@ -87,6 +110,7 @@ bool WaitForCloudConnection(uint32_t timeout_ms) {
     elapsed_ms += kPollIntervalMs;
   }
 
+  pb::boot::MarkBootMilestone("cloud_connected");
   PW_LOG_INFO("Cloud connected after %u ms", static_cast<unsigned>(elapsed_ms));
   return true;
 }
@@ -0,0 +1,64 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_integration_tests/firmware/thread_stack_service.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "pw_log/log.h"
+#include "pw_thread/thread_info.h"
+#include "pw_thread/thread_iteration.h"
+
+namespace pb::test {
+namespace {
+
+namespace msgs = stacks::pwpb;
+
+uint32_t StackSize(const pw::thread::ThreadInfo& info) {
+  if (!info.stack_low_addr().has_value() ||
+      !info.stack_high_addr().has_value()) {
+    return 0;
+  }
+  return static_cast<uint32_t>(info.stack_high_addr().value() -
+                               info.stack_low_addr().value());
+}
+
+uint32_t PeakUsed(const pw::thread::ThreadInfo& info) {
+  if (!info.stack_peak_addr().has_value() ||
+      !info.stack_high_addr().has_value()) {
+    return 0;
+  }
+  return static_cast<uint32_t>(info.stack_high_addr().value() -
+                               info.stack_peak_addr().value());
+}
+
+}  // namespace
+
+pw::Status ThreadStackService::GetThreadStacks(
+    const msgs::ThreadStacksRequest::Message&,
+    msgs::ThreadStacksResponse::Message& response) {
+  // Runs with scheduling suspended: only copy, don't log or allocate
+  const pw::Status status =
+      pw::thread::ForEachThread([&response](const pw::thread::ThreadInfo& info) {
+        if (response.threads.full()) {
+          ++response.omitted;
+          return true;
+        }
+        msgs::ThreadStack::Message& thread = response.threads.emplace_back();
+        if (info.thread_name().has_value()) {
+          const pw::span<const std::byte> name = info.thread_name().value();
+          const size_t size = std::min(name.size(), thread.name.max_size());
+          thread.name.assign(reinterpret_cast<const char*>(name.data()), size);
+        }
+        thread.stack_size = StackSize(info);
+        thread.peak_used = PeakUsed(info);
+        return true;
+      });
+  if (!status.ok()) {
+    PW_LOG_WARN("Thread iteration failed: %d", static_cast<int>(status.code()));
+  }
+  return status;
+}
+
+}  // namespace pb::test
@@ -0,0 +1,44 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Thread stack report service.
+//
+// GetThreadStacks returns the stack size and peak usage of every thread
+// (pw::thread::ForEachThread), so stack sizes can be fitted to a workload
+// instead of guessed. The host side is StackReport in
+// pb_integration_tests/harness/stack_report.py.
+//
+// TestSystemInit registers one instance on every test firmware. To serve it
+// from another RPC server:
+//
+//   static pb::test::ThreadStackService stacks;
+//   server.RegisterService(stacks);
+
+#pragma once
+
+#include <cstddef>
+
+#include "pb_integration_tests/firmware/thread_stacks.rpc.pwpb.h"
+#include "pw_status/status.h"
+
+namespace pb::test {
+
+/// Threads per report (see thread_stacks.options).
+inline constexpr size_t kMaxReportedThreads = 32;
+
+class ThreadStackService
+    : public stacks::pw_rpc::pwpb::ThreadStacks::Service<ThreadStackService> {
+ public:
+  ThreadStackService() = default;
+
+  ThreadStackService(const ThreadStackService&) = delete;
+  ThreadStackService& operator=(const ThreadStackService&) = delete;
+
+  /// Walks the thread list with scheduling suspended; takes well under a
+  /// millisecond for the usual two dozen threads.
+  pw::Status GetThreadStacks(
+      const stacks::pwpb::ThreadStacksRequest::Message& request,
+      stacks::pwpb::ThreadStacksResponse::Message& response);
+};
+
+}  // namespace pb::test
@@ -4,7 +4,8 @@
 """Integration test harness for P2 firmware tests.
 
 This package provides infrastructure for testing firmware-gateway-Firebase
-interactions on real P2 hardware.
+interactions on real P2 hardware. P2DeviceFixture leases its device from the
+attached devices, so tests in separate processes run on a rack in parallel.
 
 Example usage:
     from pb_integration_tests.harness import P2DeviceFixture, IntegrationTestHarness
@@ -29,6 +30,16 @@ Example usage:
 from .fixtures.base import Fixture
 from .fixtures.p2_device import P2DeviceFixture
 from .harness import IntegrationTestHarness
-from .rpc_client import RpcClient
+from .rpc_client import RpcBenchmark, RpcBenchmarkResult, RpcClient
+from .stack_report import StackReport, ThreadStackUsage
 
-__all__ = ["Fixture", "IntegrationTestHarness", "P2DeviceFixture", "RpcClient"]
+__all__ = [
+    "Fixture",
+    "IntegrationTestHarness",
+    "P2DeviceFixture",
+    "RpcBenchmark",
+    "RpcBenchmarkResult",
+    "RpcClient",
+    "StackReport",
+    "ThreadStackUsage",
+]
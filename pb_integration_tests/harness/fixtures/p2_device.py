@@ -4,7 +4,8 @@
 """P2 device fixture for integration tests.
 
 Handles flashing firmware and establishing RPC communication with
-a P2 device connected via USB.
+a P2 device connected via USB. The device is leased from a DevicePool, so
+integration tests in separate processes run on separate devices.
 """
 
 import asyncio
@@ -24,6 +25,9 @@ from pw_stream import stream_readers
 from pw_system.device import Device as PwSystemDevice, DEFAULT_DEVICE_LOGGER
 from pw_tokenizer import detokenize
 
+from pb_integration_tests.firmware import rpc_benchmark_pb2
+from pb_integration_tests.firmware import thread_stacks_pb2
+from tools.usb.device_pool import DeviceLease, DevicePool
 from tools.usb.flash import ParticleFlasher, FlashError
 from tools.usb.serial_port import wait_for_serial_port
 
@@ -138,7 +142,8 @@ class P2DeviceFixture:
     """Fixture for testing on real P2 hardware.
 
     This fixture:
-    1. Flashes test firmware to the P2 device
+    1. Leases a free device from the device pool and flashes test firmware
+       to it
     2. Waits for the device to reboot
     3. Opens USB serial connection
     4. Initializes pw_rpc client over HDLC (using pw_system.device.Device)
@@ -171,6 +176,8 @@ class P2DeviceFixture:
         baudrate: int = 115200,
         rpc_timeout: float = 5.0,
         show_device_logs: bool = True,
+        device_pool: Optional[DevicePool] = None,
+        lease_timeout: float = 600.0,
     ) -> None:
         """Initialize the P2 device fixture.
 
@@ -183,10 +190,14 @@ class P2DeviceFixture:
             flash_timeout: Timeout for flashing in seconds.
             device_timeout: Timeout for device to appear after flash in seconds.
             serial_number: Optional device serial number for selection.
+                Defaults to any free device of `device_pool`.
             baudrate: Serial baud rate.
             rpc_timeout: Default RPC call timeout in seconds.
             show_device_logs: If True, display detokenized device logs to stderr.
                              Useful for debugging crashes and firmware issues.
+            device_pool: Pool to lease the device from. Defaults to the
+                attached devices (see tools/usb/device_pool.py).
+            lease_timeout: Time to wait for a free device in seconds.
         """
         self._firmware_bin = Path(firmware_bin)
         self._firmware_elf = Path(firmware_elf) if firmware_elf else None
@@ -198,6 +209,13 @@ class P2DeviceFixture:
         self._baudrate = baudrate
         self._rpc_timeout = rpc_timeout
         self._show_device_logs = show_device_logs
+        if device_pool is None:
+            device_pool = DevicePool(
+                serial_numbers=[serial_number] if serial_number else None
+            )
+        self._device_pool = device_pool
+        self._lease_timeout = lease_timeout
+        self._lease: Optional[DeviceLease] = None
 
         self._device: Optional[PwSystemDevice] = None
         self._serial: Optional[serial.Serial] = None
@@ -232,18 +250,29 @@ class P2DeviceFixture:
         if not firmware_bin.exists():
             raise RuntimeError(f"Firmware binary not found: {firmware_bin}")
 
+        # Lease a device; waits while other tests use every pool device
+        self._lease = await asyncio.to_thread(
+            self._device_pool.acquire, timeout=self._lease_timeout
+        )
+        self._lease.write_record()
+
         # Flash firmware (synchronous, run in thread pool)
         _LOG.info("Flashing firmware: %s", firmware_bin)
-        await asyncio.to_thread(self._flash_firmware, firmware_bin)
+        try:
+            await asyncio.to_thread(self._flash_firmware, firmware_bin)
+        except Exception:
+            self._release_lease()
+            raise
 
         # Wait for device to reboot and appear
         _LOG.info("Waiting for device to appear...")
         self._port = await asyncio.to_thread(
             wait_for_serial_port,
             timeout=self._device_timeout,
-            serial_number=self._serial_number,
+            serial_number=self._lease.serial_number,
         )
         if not self._port:
+            self._release_lease()
             raise RuntimeError(
                 f"Device did not appear within {self._device_timeout}s"
             )
@@ -277,8 +306,13 @@ class P2DeviceFixture:
         self._reader = stream_readers.SelectableReader(self._serial, 8192)
 
         # Create Device with HDLC encoding and RPC logging
-        # Include log_pb2 proto to enable pw_system log streaming
-        proto_library = list(self._proto_paths) + [log_pb2]
+        # Include log_pb2 proto to enable pw_system log streaming, and the
+        # services every test firmware registers (RpcBenchmark, ThreadStacks)
+        proto_library = list(self._proto_paths) + [
+            log_pb2,
+            rpc_benchmark_pb2,
+            thread_stacks_pb2,
+        ]
         self._device = PwSystemDevice(
             channel_id=self._channel_id,
             reader=self._reader,
@@ -301,7 +335,7 @@ class P2DeviceFixture:
 
     def _flash_firmware(self, firmware_path: Path) -> None:
         """Flash firmware to the device (runs in thread pool)."""
-        flasher = ParticleFlasher()
+        flasher = ParticleFlasher(serial_number=self._lease.serial_number)
         flasher.flash_local(
             str(firmware_path),
             wait_for_device=True,
@@ -330,8 +364,15 @@ class P2DeviceFixture:
             self._device_log_handler = None
 
         self._port = None
+        self._release_lease()
         _LOG.info("P2 device fixture stopped")
 
+    def _release_lease(self) -> None:
+        """Return the device to the pool."""
+        if self._lease:
+            self._lease.release()
+            self._lease = None
+
     @property
     def device(self) -> PwSystemDevice:
         """Get the pw_system Device for communicating with the device.
@@ -349,6 +390,17 @@ class P2DeviceFixture:
         """Alias for device property."""
         return self.device
 
+    @property
+    def serial_number(self) -> str:
+        """Get the USB serial number (device ID) of the leased device.
+
+        Raises:
+            RuntimeError: If fixture is not started.
+        """
+        if self._lease is None:
+            raise RuntimeError("Device fixture not started")
+        return self._lease.serial_number
+
     @property
     def port(self) -> str:
         """Get the serial port path.
@@ -4,10 +4,15 @@
 """pw_rpc client for integration tests over USB serial.
 
 Provides a simple RPC client that communicates with P2 devices
-using HDLC-encoded pw_rpc over USB serial.
+using HDLC-encoded pw_rpc over USB serial (or a TCP socket://host:port URL),
+and RpcBenchmark, which measures that transport with the benchmark service
+built into every test firmware.
 """
 
 import logging
+import statistics
+import time
+from dataclasses import dataclass, field
 from pathlib import Path
 from types import ModuleType
 from typing import Any, Callable, Iterable
@@ -21,6 +26,9 @@ from pw_rpc import callback_client
 from pw_stream import stream_readers
 from pw_protobuf_compiler import python_protos
 
+from pb_integration_tests.firmware import rpc_benchmark_pb2
+from pb_integration_tests.firmware import thread_stacks_pb2
+
 _LOG = logging.getLogger(__name__)
 
 
@@ -63,15 +71,20 @@ class RpcClient:
         """Initialize the RPC client.
 
         Args:
-            port: Serial port path (e.g., "/dev/ttyACM0").
-            proto_paths: Paths to .proto files or proto modules.
+            port: Serial port path (e.g., "/dev/ttyACM0") or pyserial URL
+                (e.g., "socket://192.168.1.20:33000" for RPC over TCP).
+            proto_paths: Paths to .proto files or proto modules. The
+                benchmark and thread stack services are always included.
             channel_id: pw_rpc channel ID.
             hdlc_address: HDLC frame address.
             baud_rate: Serial baud rate.
             rpc_timeout_s: Default RPC timeout in seconds.
         """
         self._port_path = port
-        self._proto_paths = list(proto_paths)
+        self._proto_paths = list(proto_paths) + [
+            rpc_benchmark_pb2,
+            thread_stacks_pb2,
+        ]
         self._channel_id = channel_id
         self._hdlc_address = hdlc_address
         self._baud_rate = baud_rate
@@ -95,7 +108,7 @@ class RpcClient:
             raise RuntimeError("RPC client already started")
 
         _LOG.info("Opening serial port %s", self._port_path)
-        self._serial = serial.Serial(
+        self._serial = serial.serial_for_url(
             self._port_path,
             baudrate=self._baud_rate,
             timeout=0.1,
@@ -205,9 +218,207 @@ class RpcClient:
             raise RuntimeError("RPC client not started")
         return self._client
 
+    @property
+    def benchmark(self) -> "RpcBenchmark":
+        """Transport benchmarks against the device's RpcBenchmark service.
+
+        Raises:
+            RuntimeError: If client is not started.
+        """
+        return RpcBenchmark(self.rpcs)
+
     def __enter__(self) -> "RpcClient":
         self.start()
         return self
 
     def __exit__(self, *exc_info) -> None:
         self.stop()
+
+
+@dataclass
+class RpcBenchmarkResult:
+    """Timings of one RpcBenchmark run.
+
+    Attributes:
+        name: Benchmark that produced the result ("ping", "echo", "stream").
+        payload_size: Payload bytes per message.
+        messages: Messages completed (calls for ping/echo, responses for
+            stream).
+        elapsed_s: Wall time of the whole run.
+        latencies_s: Round-trip time of each call (ping/echo only).
+        errors: Failed calls, or missing stream messages.
+    """
+
+    name: str
+    payload_size: int
+    messages: int
+    elapsed_s: float
+    latencies_s: list[float] = field(default_factory=list)
+    errors: int = 0
+
+    @property
+    def bytes_per_s(self) -> float:
+        """Payload throughput; echo counts both directions."""
+        if self.elapsed_s <= 0:
+            return 0.0
+        directions = 2 if self.name == "echo" else 1
+        return self.messages * self.payload_size * directions / self.elapsed_s
+
+    @property
+    def messages_per_s(self) -> float:
+        if self.elapsed_s <= 0:
+            return 0.0
+        return self.messages / self.elapsed_s
+
+    def latency_percentile(self, percentile: float) -> float | None:
+        """Round-trip time at `percentile` (0-100), or None without calls."""
+        if not self.latencies_s:
+            return None
+        ordered = sorted(self.latencies_s)
+        index = min(len(ordered) - 1, int(len(ordered) * percentile / 100))
+        return ordered[index]
+
+    def __str__(self) -> str:
+        text = (
+            f"{self.name} {self.payload_size} B x {self.messages}: "
+            f"{self.messages_per_s:.1f} msg/s, {self.bytes_per_s:.0f} B/s"
+        )
+        if self.latencies_s:
+            text += (
+                f", rtt p50={statistics.median(self.latencies_s) * 1e3:.2f} ms"
+                f" p99={self.latency_percentile(99) * 1e3:.2f} ms"
+            )
+        if self.errors:
+            text += f", {self.errors} errors"
+        return text
+
+
+class RpcBenchmark:
+    """Measures pw_rpc over the transport a client talks to.
+
+    Uses the RpcBenchmark service that TestSystemInit registers on every
+    test firmware (pb_integration_tests/firmware/rpc_benchmark_service.h).
+    Works with RpcClient.rpcs and with P2DeviceFixture.device.rpcs, so the
+    same numbers can be taken over USB CDC and over TCP.
+
+    Example:
+        bench = RpcBenchmark(fixture.device.rpcs)
+        print(bench.ping(iterations=200))
+        for size in (16, 128, 512):
+            print(bench.echo(size))
+        print(bench.stream(512, count=500))
+    """
+
+    # Must match kMaxBenchmarkPayload in rpc_benchmark_service.h
+    MAX_PAYLOAD = 512
+
+    def __init__(self, rpcs: Any, timeout_s: float = 5.0) -> None:
+        """Initialize the benchmark.
+
+        Args:
+            rpcs: RPC accessor of a started client (`client.rpcs`).
+            timeout_s: Timeout of each unary call, and per streamed message.
+        """
+        self._service = rpcs.pb.test.benchmark.RpcBenchmark
+        self._timeout_s = timeout_s
+
+    def ping(self, iterations: int = 100) -> RpcBenchmarkResult:
+        """Round trips of empty requests, one at a time."""
+        return self._unary(
+            "ping",
+            0,
+            iterations,
+            lambda i: self._service.Ping(
+                sequence=i, pw_rpc_timeout_s=self._timeout_s
+            ),
+            lambda i, response: response.sequence == i,
+        )
+
+    def echo(
+        self, payload_size: int, iterations: int = 100
+    ) -> RpcBenchmarkResult:
+        """Round trips of `payload_size` bytes, one at a time."""
+        self._check_payload_size(payload_size)
+        payload = _benchmark_payload(payload_size)
+        return self._unary(
+            "echo",
+            payload_size,
+            iterations,
+            lambda i: self._service.Echo(
+                payload=payload, pw_rpc_timeout_s=self._timeout_s
+            ),
+            lambda i, response: response.payload == payload,
+        )
+
+    def stream(
+        self, payload_size: int, count: int = 100
+    ) -> RpcBenchmarkResult:
+        """Device-to-host throughput of `count` streamed messages.
+
+        Messages lost by the transport show up as errors; the device numbers
+        them, so every gap in the sequence counts.
+        """
+        self._check_payload_size(payload_size)
+        start = time.perf_counter()
+        status, responses = self._service.StreamMessages(
+            count=count,
+            payload_size=payload_size,
+            pw_rpc_timeout_s=self._timeout_s * max(1, count / 100),
+        )
+        elapsed = time.perf_counter() - start
+
+        received = {response.sequence for response in responses}
+        errors = count - len(received)
+        if not status.ok():
+            _LOG.warning("StreamMessages finished with %s", status)
+            errors = max(errors, 1)
+        return RpcBenchmarkResult(
+            name="stream",
+            payload_size=payload_size,
+            messages=len(responses),
+            elapsed_s=elapsed,
+            errors=errors,
+        )
+
+    def _unary(
+        self,
+        name: str,
+        payload_size: int,
+        iterations: int,
+        call: Callable[[int], Any],
+        check: Callable[[int, Any], bool],
+    ) -> RpcBenchmarkResult:
+        latencies = []
+        errors = 0
+        start = time.perf_counter()
+        for i in range(iterations):
+            call_start = time.perf_counter()
+            try:
+                status, response = call(i)
+            except callback_client.RpcTimeout:
+                errors += 1
+                continue
+            if status.ok() and check(i, response):
+                latencies.append(time.perf_counter() - call_start)
+            else:
+                errors += 1
+        return RpcBenchmarkResult(
+            name=name,
+            payload_size=payload_size,
+            messages=len(latencies),
+            elapsed_s=time.perf_counter() - start,
+            latencies_s=latencies,
+            errors=errors,
+        )
+
+    def _check_payload_size(self, payload_size: int) -> None:
+        if not 0 <= payload_size <= self.MAX_PAYLOAD:
+            raise ValueError(
+                f"payload_size must be 0..{self.MAX_PAYLOAD}, "
+                f"got {payload_size}"
+            )
+
+
+def _benchmark_payload(size: int) -> bytes:
+    """Same pattern as the device's stream payload."""
+    return bytes((i * 7 + 1) & 0xFF for i in range(size))
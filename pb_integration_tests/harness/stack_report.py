@@ -0,0 +1,263 @@
+# Copyright Offene Werkstatt Wädenswil
+# SPDX-License-Identifier: MIT
+
+"""Thread stack right-sizing from high-water marks.
+
+StackReport polls the ThreadStacks service that TestSystemInit registers on
+every test firmware (pb_integration_tests/firmware/thread_stack_service.h)
+while a workload runs, keeps the deepest use seen per thread and suggests a
+stack size with a safety margin. Threads that come and go (the socket
+worker, uart_svc) are caught by polling rather than reading once at the end.
+
+Usage:
+    bazel run //pb_integration_tests/harness:stack_report -- \\
+        --port /dev/ttyACM0 --duration 600
+
+    # From a test, around its workload
+    report = StackReport(fixture.device.rpcs)
+    report.run(lambda: exercise_device(fixture), interval_s=1.0)
+    print(report.format())
+"""
+
+import argparse
+import logging
+import threading
+import time
+from dataclasses import dataclass
+from typing import Any, Callable
+
+_LOG = logging.getLogger(__name__)
+
+# Thread name -> option that sets its stack size, for the report
+STACK_SIZE_OPTIONS = {
+    "uart_svc": "PB_UART_CONFIG_SERVICE_STACK_SIZE",
+    "socket": "PB_SOCKET_CONFIG_WORKER_STACK_SIZE",
+    "dns": "PB_SOCKET_CONFIG_RESOLVER_STACK_SIZE",
+    "log_drain": "PB_LOG_CONFIG_DRAIN_STACK_SIZE",
+    "timer_dispatch": "PW_CHRONO_PARTICLE_TIMER_THREAD_STACK_SIZE",
+    "power_idle": "PB_POWER_CONFIG_IDLE_STACK_SIZE",
+}
+
+# Must match kMinimumStackSizeBytes in pw_thread_particle/config.h
+MINIMUM_STACK_SIZE = 1024
+
+
+def suggest_stack_size(
+    peak_used: int,
+    margin: float = 0.25,
+    granularity: int = 256,
+    minimum: int = MINIMUM_STACK_SIZE,
+) -> int:
+    """Stack size for `peak_used` bytes plus `margin`, rounded up.
+
+    The margin covers paths the workload did not take (error handling,
+    logging a long message); keep it generous for threads that call into
+    Device OS.
+    """
+    needed = int(peak_used * (1.0 + margin))
+    rounded = -(-needed // granularity) * granularity
+    return max(rounded, minimum)
+
+
+@dataclass
+class ThreadStackUsage:
+    """Deepest stack use seen for one thread.
+
+    Attributes:
+        name: FreeRTOS task name.
+        stack_size: Configured stack in bytes, 0 if unknown.
+        peak_used: Deepest use in bytes over all samples.
+        suggested: Suggested stack size in bytes.
+    """
+
+    name: str
+    stack_size: int
+    peak_used: int
+    suggested: int = 0
+
+    @property
+    def reclaimable(self) -> int:
+        """Bytes saved by switching to the suggested size (may be < 0)."""
+        if self.stack_size == 0:
+            return 0
+        return self.stack_size - self.suggested
+
+
+class StackReport:
+    """Collects per-thread peak stack use from a test firmware.
+
+    Works with RpcClient.rpcs and with P2DeviceFixture.device.rpcs.
+    """
+
+    def __init__(
+        self,
+        rpcs: Any,
+        margin: float = 0.25,
+        granularity: int = 256,
+        timeout_s: float = 5.0,
+    ) -> None:
+        """Initialize the report.
+
+        Args:
+            rpcs: RPC accessor of a started client (`client.rpcs`).
+            margin: Safety margin on top of the peak (0.25 = 25%).
+            granularity: Suggested sizes are rounded up to this many bytes.
+            timeout_s: Timeout of each GetThreadStacks call.
+        """
+        self._service = rpcs.pb.test.stacks.ThreadStacks
+        self._margin = margin
+        self._granularity = granularity
+        self._timeout_s = timeout_s
+        self._threads: dict[str, ThreadStackUsage] = {}
+        self.samples = 0
+
+    def sample(self) -> None:
+        """Reads the current high-water marks and merges them in."""
+        status, response = self._service.GetThreadStacks(
+            pw_rpc_timeout_s=self._timeout_s
+        )
+        if not status.ok():
+            raise RuntimeError(f"GetThreadStacks failed: {status}")
+        if response.omitted:
+            _LOG.warning(
+                "%d threads did not fit into the report", response.omitted
+            )
+        for thread in response.threads:
+            known = self._threads.get(thread.name)
+            if known is None:
+                self._threads[thread.name] = ThreadStackUsage(
+                    thread.name, thread.stack_size, thread.peak_used
+                )
+            else:
+                known.stack_size = max(known.stack_size, thread.stack_size)
+                known.peak_used = max(known.peak_used, thread.peak_used)
+        self.samples += 1
+
+    def run(
+        self,
+        workload: Callable[[], None] | None = None,
+        duration_s: float = 0.0,
+        interval_s: float = 1.0,
+    ) -> None:
+        """Samples every `interval_s` while the workload runs.
+
+        Args:
+            workload: Called on a separate thread; sampling stops when it
+                returns. Without one, samples for `duration_s`.
+            duration_s: Sampling time without a workload.
+            interval_s: Time between samples.
+        """
+        done = threading.Event()
+        worker = None
+        if workload is not None:
+
+            def run_workload() -> None:
+                try:
+                    workload()
+                finally:
+                    done.set()
+
+            worker = threading.Thread(target=run_workload, daemon=True)
+            worker.start()
+
+        deadline = time.monotonic() + duration_s
+        while True:
+            self.sample()
+            if worker is None and time.monotonic() >= deadline:
+                break
+            if done.wait(interval_s):
+                break
+        if worker is not None:
+            worker.join()
+            self.sample()  # Final marks after the workload
+
+    def threads(self) -> list[ThreadStackUsage]:
+        """Threads seen so far with suggestions, largest saving first."""
+        result = []
+        for thread in self._threads.values():
+            thread.suggested = suggest_stack_size(
+                thread.peak_used, self._margin, self._granularity
+            )
+            result.append(thread)
+        result.sort(key=lambda t: t.reclaimable, reverse=True)
+        return result
+
+    def format(self) -> str:
+        """The report as a table, with the option to set where known."""
+        threads = self.threads()
+        lines = [
+            f"{'thread':<16} {'size':>6} {'peak':>6} {'use':>5} "
+            f"{'suggest':>7} {'saves':>6}  option",
+        ]
+        for t in threads:
+            use = "-"
+            if t.stack_size:
+                use = f"{100 * t.peak_used / t.stack_size:.0f}%"
+            lines.append(
+                f"{t.name:<16} {t.stack_size:>6} {t.peak_used:>6} {use:>5} "
+                f"{t.suggested:>7} {t.reclaimable:>6}  "
+                f"{STACK_SIZE_OPTIONS.get(t.name, '')}"
+            )
+        saved = sum(max(t.reclaimable, 0) for t in threads)
+        short = [t.name for t in threads if t.reclaimable < 0]
+        lines.append(
+            f"{self.samples} samples, margin {self._margin:.0%}: "
+            f"{saved} bytes reclaimable"
+        )
+        if short:
+            lines.append(f"Below the margin: {', '.join(short)}")
+        return "\n".join(lines)
+
+
+def main() -> None:
+    # Only the command line needs the serial client
+    from pb_integration_tests.harness.rpc_client import RpcClient
+
+    parser = argparse.ArgumentParser(
+        description="Suggest thread stack sizes from high-water marks"
+    )
+    parser.add_argument(
+        "--port", required=True, help="Serial port or pyserial URL"
+    )
+    parser.add_argument(
+        "--duration",
+        type=float,
+        default=60.0,
+        help="Sampling time in seconds while the workload runs (default: 60)",
+    )
+    parser.add_argument(
+        "--interval",
+        type=float,
+        default=1.0,
+        help="Seconds between samples (default: 1)",
+    )
+    parser.add_argument(
+        "--margin",
+        type=float,
+        default=0.25,
+        help="Safety margin on top of the peak (default: 0.25)",
+    )
+    parser.add_argument(
+        "-v", "--verbose",
+        action="store_true",
+        help="Enable verbose logging",
+    )
+    args = parser.parse_args()
+
+    logging.basicConfig(
+        level=logging.DEBUG if args.verbose else logging.INFO,
+        format="%(message)s",
+    )
+
+    with RpcClient(port=args.port, proto_paths=[]) as client:
+        report = StackReport(client.rpcs, margin=args.margin)
+        print(
+            f"Sampling stacks for {args.duration:.0f} s - "
+            "run the workload now"
+        )
+        report.run(duration_s=args.duration, interval_s=args.interval)
+        print(report.format())
+
+
+if __name__ == "__main__":
+    main()
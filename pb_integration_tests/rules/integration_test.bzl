@@ -17,6 +17,14 @@ Example:
         firmware_deps = ["//maco_firmware/modules/firebase:firebase_client"],
         platform = "//maco_firmware/targets/p2:p2",
     )
+
+Tests lease their device from the pool of attached devices (see
+tools/usb/device_pool.py), so independent targets run concurrently, one per
+device. Match the job count to the rack; Bazel's test summary lists the
+result of every target, and each target's undeclared outputs record the
+device it ran on (device.json):
+
+    bazel test --local_test_jobs=<devices> //path/to:integration_tests
 """
 
 load("@com_google_protobuf//bazel:proto_library.bzl", "proto_library")
@@ -160,6 +168,6 @@ def pb_integration_test(
             # Note: particle-cli must be on system PATH (npm install -g particle-cli)
         ] + test_data,
         timeout = test_timeout,
-        tags = ["local", "exclusive", "manual"] + tags,  # local for USB, exclusive to avoid conflicts, manual requires hardware
+        tags = ["local", "manual"] + tags,  # local for USB, manual requires hardware; devices are leased per test
         visibility = visibility,
     )
@@ -4,73 +4,264 @@
 // Minimal HAL-level bridge from Particle Device OS logging to pw_log.
 // This intercepts all system and application logs via log_set_callbacks().
 //
-// Thread safety is handled by pw_sys_io - each PW_LOG call uses WriteLine
-// which is atomic.
+// With PB_LOG_CONFIG_ASYNC, messages are queued in a LogRing and written by
+// the "log_drain" thread, so the logging thread never waits for USB. Thread
+// safety of the output itself is handled by pw_sys_io - each PW_LOG call
+// uses WriteLine which is atomic.
 
 #include "pb_log/log_bridge.h"
 
 #include <cstddef>
+#include <cstdio>
+#include <mutex>
+#include <string_view>
 
 #include "logging.h"
+#include "pb_log/config.h"
+#include "pb_log/log_filter.h"
+#include "pb_log/log_limiter.h"
+#include "pb_log/log_ring.h"
+#include "pb_log/retained_crash_log.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/thread_notification.h"
+#include "pw_thread/thread.h"
+#include "pw_thread_particle/options.h"
+#include "timer_hal.h"
 
+// No PW_LOG_LEVEL here: g_filter decides which Device OS levels get through
 #define PW_LOG_MODULE_NAME "device_os"
-#define PW_LOG_LEVEL PW_LOG_LEVEL_WARN
 
 #include "pw_log/log.h"
+#include "pw_log/tokens.h"
+#include "pw_span/span.h"
 #include "pw_sys_io/sys_io.h"
 
 namespace pb::log {
 namespace {
 
-// Map Particle log levels to appropriate PW_LOG calls
-void LogMessageCallback(const char* msg, int level, const char* category,
-                        const LogAttributes* attr, void* reserved) {
-  (void)attr;
-  (void)reserved;
+LogFilter<config::kMaxCategoryFilters, config::kMaxCategorySize> g_filter(
+    config::kDefaultLogLevel);
 
-  const char* cat = category ? category : "system";
+// Categories Device OS logs under. With pw_log_tokenized these go out as
+// nested tokens instead of strings; other backends get the name back.
+struct KnownCategory {
+  std::string_view name;
+  PW_LOG_TOKEN_TYPE token;
+};
+
+const KnownCategory kKnownCategories[] = {
+    {"app", PW_LOG_TOKEN_EXPR("app")},
+    {"system", PW_LOG_TOKEN_EXPR("system")},
+    {"system.nm", PW_LOG_TOKEN_EXPR("system.nm")},
+    {"system.ledger", PW_LOG_TOKEN_EXPR("system.ledger")},
+    {"sys.power", PW_LOG_TOKEN_EXPR("sys.power")},
+    {"comm", PW_LOG_TOKEN_EXPR("comm")},
+    {"comm.protocol", PW_LOG_TOKEN_EXPR("comm.protocol")},
+    {"comm.dtls", PW_LOG_TOKEN_EXPR("comm.dtls")},
+    {"comm.coap", PW_LOG_TOKEN_EXPR("comm.coap")},
+    {"comm.ota", PW_LOG_TOKEN_EXPR("comm.ota")},
+    {"net", PW_LOG_TOKEN_EXPR("net")},
+    {"net.ifapi", PW_LOG_TOKEN_EXPR("net.ifapi")},
+    {"net.en", PW_LOG_TOKEN_EXPR("net.en")},
+    {"net.lwip", PW_LOG_TOKEN_EXPR("net.lwip")},
+    {"ncp", PW_LOG_TOKEN_EXPR("ncp")},
+    {"ncp.client", PW_LOG_TOKEN_EXPR("ncp.client")},
+    {"ncp.at", PW_LOG_TOKEN_EXPR("ncp.at")},
+    {"hal", PW_LOG_TOKEN_EXPR("hal")},
+    {"hal.ble", PW_LOG_TOKEN_EXPR("hal.ble")},
+    {"wiring", PW_LOG_TOKEN_EXPR("wiring")},
+};
+
+const KnownCategory* FindCategory(std::string_view name) {
+  for (const KnownCategory& category : kKnownCategories) {
+    if (category.name == name) {
+      return &category;
+    }
+  }
+  return nullptr;
+}
 
+// Known categories are logged as a token, others as a string argument
+#define PB_LOG_EMIT(log_macro, known, cat, msg)                       \
+  do {                                                                \
+    if ((known) != nullptr) {                                         \
+      log_macro("[" PW_LOG_TOKEN_FMT() "] %s", (known)->token, msg); \
+    } else {                                                          \
+      log_macro("[%s] %s", cat, msg);                                 \
+    }                                                                 \
+  } while (0)
+
+// Map Particle log levels to appropriate PW_LOG calls
+void Emit(int level, const char* cat, const char* msg) {
+  const KnownCategory* known = FindCategory(cat);
   // Map Particle levels to pw_log levels
   // Particle: TRACE=1, INFO=30, WARN=40, ERROR=50, PANIC=60
   if (level >= LOG_LEVEL_PANIC) {
-    PW_LOG_CRITICAL("[%s] %s", cat, msg);
+    PB_LOG_EMIT(PW_LOG_CRITICAL, known, cat, msg);
   } else if (level >= LOG_LEVEL_ERROR) {
-    PW_LOG_ERROR("[%s] %s", cat, msg);
+    PB_LOG_EMIT(PW_LOG_ERROR, known, cat, msg);
   } else if (level >= LOG_LEVEL_WARN) {
-    PW_LOG_WARN("[%s] %s", cat, msg);
+    PB_LOG_EMIT(PW_LOG_WARN, known, cat, msg);
   } else if (level >= LOG_LEVEL_INFO) {
-    PW_LOG_INFO("[%s] %s", cat, msg);
+    PB_LOG_EMIT(PW_LOG_INFO, known, cat, msg);
   } else {
-    PW_LOG_DEBUG("[%s] %s", cat, msg);
+    PB_LOG_EMIT(PW_LOG_DEBUG, known, cat, msg);
   }
 }
 
+#undef PB_LOG_EMIT
+
+#if PB_LOG_CONFIG_ASYNC
+
+using Ring = LogRing<config::kRingSlots, config::kMaxCategorySize,
+                     config::kMaxMessageSize>;
+
+Ring g_ring;
+pw::sync::ThreadNotification g_pending;
+
+[[noreturn]] void DrainThread() {
+  uint32_t reported_drops = 0;
+  while (true) {
+    g_pending.acquire();
+    while (g_ring.TryPop([](const Ring::Record& record) {
+      Emit(record.level, record.category.data(), record.message.data());
+    })) {
+    }
+    const uint32_t dropped = g_ring.dropped();
+    if (dropped != reported_drops) {
+      PW_LOG_WARN("%u Device OS log messages dropped (ring full)",
+                  static_cast<unsigned>(dropped - reported_drops));
+      reported_drops = dropped;
+    }
+  }
+}
+
+void StartDrainThread() {
+  static bool started = false;
+  if (started) {
+    return;
+  }
+  started = true;
+  pw::Thread(pw::thread::particle::Options()
+                 .set_name("log_drain")
+                 .set_priority(config::kDrainThreadPriority)
+                 .set_stack_size(config::kDrainThreadStackSize),
+             [] { DrainThread(); })
+      .detach();
+}
+
+#endif  // PB_LOG_CONFIG_ASYNC
+
+// Queue or write one message, and keep it in the crash log
+void Forward(int level, const char* cat, const char* msg) {
+#if PB_LOG_CONFIG_CRASH_LOG
+  RecordCrashLog(level, cat, msg);
+#endif  // PB_LOG_CONFIG_CRASH_LOG
+
+#if PB_LOG_CONFIG_ASYNC
+  // A full ring drops the message; the drain thread reports the count
+  if (g_ring.TryPush(level, cat, msg)) {
+    g_pending.release();
+  }
+#else
+  Emit(level, cat, msg);
+#endif  // PB_LOG_CONFIG_ASYNC
+}
+
+#if PB_LOG_CONFIG_RATE_LIMIT
+
+LogLimiter<config::kRateLimitCategories> g_limiter(
+    config::kRateLimitBurst, config::kRateLimitPerSecond);
+pw::sync::InterruptSpinLock g_limiter_lock;
+
+// Report suppressed messages, then decide whether this one goes out
+bool Admit(int level, const char* cat, const char* msg) {
+  decltype(g_limiter)::Decision decision;
+  {
+    std::lock_guard lock(g_limiter_lock);
+    decision = g_limiter.Check(level, cat, msg, HAL_Timer_Get_Milli_Seconds());
+  }
+
+  char note[48];
+  if (decision.repeated > 0) {
+    snprintf(note, sizeof(note), "last message repeated %u times",
+             static_cast<unsigned>(decision.repeated));
+    Forward(LOG_LEVEL_WARN, "log", note);
+  }
+  if (decision.limited > 0) {
+    snprintf(note, sizeof(note), "%u [%s] messages dropped (rate limit)",
+             static_cast<unsigned>(decision.limited), cat);
+    Forward(LOG_LEVEL_WARN, "log", note);
+  }
+  return decision.emit;
+}
+
+#endif  // PB_LOG_CONFIG_RATE_LIMIT
+
+void LogMessageCallback(const char* msg, int level, const char* category,
+                        const LogAttributes* attr, void* reserved) {
+  (void)attr;
+  (void)reserved;
+
+  const char* cat = category ? category : "system";
+
+#if PB_LOG_CONFIG_RATE_LIMIT
+  if (!Admit(level, cat, msg)) {
+    return;
+  }
+#endif  // PB_LOG_CONFIG_RATE_LIMIT
+
+  Forward(level, cat, msg);
+}
+
 void LogWriteCallback(const char* data, size_t size, int level,
                       const char* category, void* reserved) {
   (void)level;
   (void)category;
   (void)reserved;
 
-  // Write raw data directly through pw_sys_io (thread-safe)
-  for (size_t i = 0; i < size; i++) {
-    (void)pw::sys_io::WriteByte(static_cast<std::byte>(data[i]));
-  }
+  // One WriteBytes call takes the output lock once for the whole chunk
+  (void)pw::sys_io::WriteBytes(pw::as_bytes(pw::span(data, size)));
 }
 
+// Device OS only formats a message if this returns nonzero
 int LogEnabledCallback(int level, const char* category, void* reserved) {
-  (void)category;
   (void)reserved;
-
-  // Enable all levels - pw_log will do its own filtering
-  (void)level;
-  return 1;
+  return g_filter.Enabled(level, category ? category : "system") ? 1 : 0;
 }
 
 }  // namespace
 
 void InitLogBridge() {
+#if PB_LOG_CONFIG_ASYNC
+  StartDrainThread();
+#endif  // PB_LOG_CONFIG_ASYNC
   log_set_callbacks(LogMessageCallback, LogWriteCallback, LogEnabledCallback,
                     nullptr);
 }
 
+void SetDefaultLogLevel(int level) { g_filter.SetDefaultLevel(level); }
+
+int DefaultLogLevel() { return g_filter.default_level(); }
+
+pw::Status SetCategoryLogLevel(std::string_view category, int level) {
+  return g_filter.SetLevel(category, level);
+}
+
+pw::Status ClearCategoryLogLevel(std::string_view category) {
+  return g_filter.SetLevel(category, decltype(g_filter)::kInherit);
+}
+
+int CategoryLogLevel(std::string_view category) {
+  return g_filter.Threshold(category);
+}
+
+uint32_t DroppedLogMessages() {
+#if PB_LOG_CONFIG_ASYNC
+  return g_ring.dropped();
+#else
+  return 0;
+#endif  // PB_LOG_CONFIG_ASYNC
+}
+
 }  // namespace pb::log
@@ -0,0 +1,85 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_log/log_filter.h"
+
+#include "pw_unit_test/framework.h"
+
+namespace pb::log {
+namespace {
+
+constexpr int kTrace = 1;
+constexpr int kInfo = 30;
+constexpr int kWarn = 40;
+constexpr int kError = 50;
+
+using SmallFilter = LogFilter<2, 8>;
+
+TEST(LogFilter, DefaultLevelApplies) {
+  SmallFilter filter(kWarn);
+  EXPECT_FALSE(filter.Enabled(kInfo, "comm"));
+  EXPECT_TRUE(filter.Enabled(kWarn, "comm"));
+  EXPECT_TRUE(filter.Enabled(kError, "comm"));
+
+  filter.SetDefaultLevel(kInfo);
+  EXPECT_TRUE(filter.Enabled(kInfo, "comm"));
+  EXPECT_EQ(filter.default_level(), kInfo);
+}
+
+TEST(LogFilter, CategoryOverridesDefault) {
+  SmallFilter filter(kWarn);
+  ASSERT_EQ(filter.SetLevel("comm", kTrace), pw::OkStatus());
+  EXPECT_TRUE(filter.Enabled(kTrace, "comm"));
+  EXPECT_FALSE(filter.Enabled(kInfo, "wifi"));
+
+  ASSERT_EQ(filter.SetLevel("wifi", kError), pw::OkStatus());
+  EXPECT_FALSE(filter.Enabled(kWarn, "wifi"));
+}
+
+TEST(LogFilter, SubcategoriesInherit) {
+  SmallFilter filter(kWarn);
+  ASSERT_EQ(filter.SetLevel("comm", kInfo), pw::OkStatus());
+  EXPECT_TRUE(filter.Enabled(kInfo, "comm.proto"));
+  EXPECT_FALSE(filter.Enabled(kInfo, "commands"));
+  EXPECT_FALSE(filter.Enabled(kInfo, "com"));
+}
+
+TEST(LogFilter, LongestMatchWins) {
+  SmallFilter filter(kWarn);
+  ASSERT_EQ(filter.SetLevel("comm", kTrace), pw::OkStatus());
+  ASSERT_EQ(filter.SetLevel("comm.io", kError), pw::OkStatus());
+  EXPECT_EQ(filter.Threshold("comm.io"), kError);
+  EXPECT_EQ(filter.Threshold("comm.io.x"), kError);
+  EXPECT_EQ(filter.Threshold("comm.ota"), kTrace);
+}
+
+TEST(LogFilter, ClearRestoresDefault) {
+  SmallFilter filter(kWarn);
+  ASSERT_EQ(filter.SetLevel("comm", kTrace), pw::OkStatus());
+  ASSERT_EQ(filter.SetLevel("comm", SmallFilter::kInherit), pw::OkStatus());
+  EXPECT_EQ(filter.Threshold("comm"), kWarn);
+
+  // A cleared entry is reused when the category is set again
+  ASSERT_EQ(filter.SetLevel("comm", kInfo), pw::OkStatus());
+  ASSERT_EQ(filter.SetLevel("wifi", kInfo), pw::OkStatus());
+  EXPECT_EQ(filter.Threshold("comm"), kInfo);
+}
+
+TEST(LogFilter, RejectsBadCategories) {
+  SmallFilter filter(kWarn);
+  EXPECT_EQ(filter.SetLevel("", kInfo), pw::Status::InvalidArgument());
+  EXPECT_EQ(filter.SetLevel("toolongname", kInfo),
+            pw::Status::InvalidArgument());
+}
+
+TEST(LogFilter, FullTable) {
+  SmallFilter filter(kWarn);
+  ASSERT_EQ(filter.SetLevel("a", kInfo), pw::OkStatus());
+  ASSERT_EQ(filter.SetLevel("b", kInfo), pw::OkStatus());
+  EXPECT_EQ(filter.SetLevel("c", kInfo), pw::Status::ResourceExhausted());
+  EXPECT_EQ(filter.SetLevel("a", kError), pw::OkStatus());
+  EXPECT_EQ(filter.Threshold("c"), kWarn);
+}
+
+}  // namespace
+}  // namespace pb::log
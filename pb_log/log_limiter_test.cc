@@ -0,0 +1,70 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_log/log_limiter.h"
+
+#include "pw_unit_test/framework.h"
+
+namespace pb::log {
+namespace {
+
+using Limiter = LogLimiter<2>;
+
+TEST(LogLimiter, CountsDuplicates) {
+  Limiter limiter(100, 100);
+  EXPECT_TRUE(limiter.Check(40, "comm", "timeout", 0).emit);
+  EXPECT_FALSE(limiter.Check(40, "comm", "timeout", 1).emit);
+  EXPECT_FALSE(limiter.Check(40, "comm", "timeout", 2).emit);
+
+  const Limiter::Decision next = limiter.Check(40, "comm", "connected", 3);
+  EXPECT_TRUE(next.emit);
+  EXPECT_EQ(next.repeated, 2u);
+
+  // The count restarts after it was reported
+  EXPECT_EQ(limiter.Check(40, "comm", "timeout", 4).repeated, 0u);
+}
+
+TEST(LogLimiter, LevelAndCategoryMakeMessagesDistinct) {
+  Limiter limiter(100, 100);
+  EXPECT_TRUE(limiter.Check(40, "comm", "timeout", 0).emit);
+  EXPECT_TRUE(limiter.Check(50, "comm", "timeout", 0).emit);
+  EXPECT_TRUE(limiter.Check(50, "net", "timeout", 0).emit);
+}
+
+TEST(LogLimiter, RateLimitsPerCategory) {
+  Limiter limiter(2, 1);
+  EXPECT_TRUE(limiter.Check(40, "comm", "a", 0).emit);
+  EXPECT_TRUE(limiter.Check(40, "comm", "b", 0).emit);
+  EXPECT_FALSE(limiter.Check(40, "comm", "c", 0).emit);
+  EXPECT_FALSE(limiter.Check(40, "comm", "d", 500).emit);
+
+  // Other categories have their own bucket
+  EXPECT_TRUE(limiter.Check(40, "net", "e", 500).emit);
+
+  // One token per second
+  const Limiter::Decision refilled = limiter.Check(40, "comm", "f", 1000);
+  EXPECT_TRUE(refilled.emit);
+  EXPECT_EQ(refilled.limited, 2u);
+  EXPECT_FALSE(limiter.Check(40, "comm", "g", 1000).emit);
+}
+
+TEST(LogLimiter, BucketRefillIsCapped) {
+  Limiter limiter(2, 1);
+  EXPECT_TRUE(limiter.Check(40, "comm", "a", 0).emit);
+  EXPECT_TRUE(limiter.Check(40, "comm", "b", 100000).emit);
+  EXPECT_TRUE(limiter.Check(40, "comm", "c", 100000).emit);
+  EXPECT_FALSE(limiter.Check(40, "comm", "d", 100000).emit);
+}
+
+TEST(LogLimiter, EvictsLeastRecentlyUsedCategory) {
+  Limiter limiter(1, 1);
+  EXPECT_TRUE(limiter.Check(40, "a", "1", 0).emit);
+  EXPECT_TRUE(limiter.Check(40, "b", "1", 10).emit);
+  EXPECT_FALSE(limiter.Check(40, "b", "2", 20).emit);
+  // "c" takes over the bucket of "a", which starts full again
+  EXPECT_TRUE(limiter.Check(40, "c", "1", 30).emit);
+  EXPECT_TRUE(limiter.Check(40, "a", "2", 40).emit);
+}
+
+}  // namespace
+}  // namespace pb::log
@@ -0,0 +1,101 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_log/log_ring.h"
+
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "pw_unit_test/framework.h"
+
+namespace pb::log {
+namespace {
+
+using SmallRing = LogRing<4, 8, 16>;
+
+std::string_view Text(const char* text) { return std::string_view(text); }
+
+TEST(LogRing, PopsInOrder) {
+  SmallRing ring;
+  EXPECT_TRUE(ring.TryPush(30, "comm", "first"));
+  EXPECT_TRUE(ring.TryPush(40, "wifi", "second"));
+
+  int level = 0;
+  EXPECT_TRUE(ring.TryPop([&level](const SmallRing::Record& record) {
+    level = record.level;
+    EXPECT_EQ(Text(record.category.data()), "comm");
+    EXPECT_EQ(Text(record.message.data()), "first");
+  }));
+  EXPECT_EQ(level, 30);
+  EXPECT_TRUE(ring.TryPop([](const SmallRing::Record& record) {
+    EXPECT_EQ(Text(record.message.data()), "second");
+  }));
+  EXPECT_FALSE(ring.TryPop([](const SmallRing::Record&) {}));
+}
+
+TEST(LogRing, TruncatesLongText) {
+  SmallRing ring;
+  EXPECT_TRUE(ring.TryPush(1, "category", "a message longer than the slot"));
+  EXPECT_TRUE(ring.TryPop([](const SmallRing::Record& record) {
+    EXPECT_EQ(Text(record.category.data()), "categor");
+    EXPECT_EQ(Text(record.message.data()), "a message longe");
+  }));
+}
+
+TEST(LogRing, DropsWhenFullAndRecovers) {
+  SmallRing ring;
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(ring.TryPush(i, "c", "m"));
+  }
+  EXPECT_FALSE(ring.TryPush(4, "c", "m"));
+  EXPECT_FALSE(ring.TryPush(5, "c", "m"));
+  EXPECT_EQ(ring.dropped(), 2u);
+
+  // Wraps around many times
+  for (int lap = 0; lap < 100; ++lap) {
+    EXPECT_TRUE(ring.TryPop([](const SmallRing::Record&) {}));
+    EXPECT_TRUE(ring.TryPush(lap, "c", "m"));
+  }
+  EXPECT_EQ(ring.dropped(), 2u);
+}
+
+TEST(LogRing, ManyProducers) {
+  LogRing<64, 8, 16> ring;
+  constexpr int kProducers = 4;
+  constexpr int kPerProducer = 1000;
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&ring, p] {
+      for (int i = 0; i < kPerProducer; ++i) {
+        ring.TryPush(p * kPerProducer + i, "c", "m");
+      }
+    });
+  }
+
+  // Every message is either popped exactly once or counted as dropped
+  std::vector<int> seen(kProducers * kPerProducer, 0);
+  int popped = 0;
+  auto pop = [&](const LogRing<64, 8, 16>::Record& record) {
+    ++seen[record.level];
+    ++popped;
+  };
+  while (popped + static_cast<int>(ring.dropped()) <
+         kProducers * kPerProducer) {
+    ring.TryPop(pop);
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  while (ring.TryPop(pop)) {
+  }
+  EXPECT_EQ(popped + static_cast<int>(ring.dropped()),
+            kProducers * kPerProducer);
+  for (int count : seen) {
+    EXPECT_LE(count, 1);
+  }
+}
+
+}  // namespace
+}  // namespace pb::log
@@ -0,0 +1,17 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// pw_log_tokenized handler that hands every encoded entry to the network
+// log sink (pb::log::SetNetworkLogSink). Entries logged while no sink is
+// set are discarded.
+
+#include "pb_log/network_log_sink.h"
+#include "pw_log_tokenized/handler.h"
+#include "pw_span/span.h"
+
+extern "C" void pw_log_tokenized_HandleLog(uint32_t metadata,
+                                           const uint8_t encoded_message[],
+                                           size_t size_bytes) {
+  pb::log::WriteNetworkLog(
+      metadata, pw::as_bytes(pw::span(encoded_message, size_bytes)));
+}
@@ -0,0 +1,222 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_log/network_log_sink.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+
+#include "pw_chrono/system_clock.h"
+
+// No PW_LOG here: the sink is the log backend's output, a message about it
+// would be queued into the buffer it is draining.
+
+namespace pb::log {
+namespace {
+
+std::atomic<NetworkLogSink*> g_sink{nullptr};
+
+void PutLittleEndian(std::byte* out, uint32_t value, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    out[i] = static_cast<std::byte>(value >> (8 * i));
+  }
+}
+
+}  // namespace
+
+NetworkLogSink::NetworkLogSink(socket::TcpSocket& socket,
+                               pw::ByteSpan buffer,
+                               pw::ByteSpan frame,
+                               const NetworkLogOptions& options)
+    : socket_(socket), buffer_(buffer), frame_(frame), options_(options) {}
+
+NetworkLogSink::~NetworkLogSink() { Stop(); }
+
+pw::Status NetworkLogSink::Start(const pw::thread::Options& options) {
+  if (started_) {
+    return pw::Status::FailedPrecondition();
+  }
+  {
+    std::lock_guard lock(lock_);
+    stop_ = false;
+  }
+  thread_ = pw::Thread(options, [this]() { Run(); });
+  started_ = true;
+  return pw::OkStatus();
+}
+
+void NetworkLogSink::Stop() {
+  if (!started_) {
+    return;
+  }
+  {
+    std::lock_guard lock(lock_);
+    stop_ = true;
+  }
+  wake_.release();
+  // Joining would also wait for the idle task to delete the exited thread,
+  // which a busy higher-priority caller can starve; once Run() has
+  // returned, nothing touches the sink, and the detached thread frees its
+  // own context.
+  exited_.acquire();
+  thread_.detach();
+  started_ = false;
+}
+
+bool NetworkLogSink::Write(uint32_t metadata, pw::ConstByteSpan message) {
+  const size_t size = kNetworkLogEntryHeaderSize + message.size();
+  if (message.size() > 0xff ||
+      size > frame_.size() - kNetworkLogFrameHeaderSize) {
+    std::lock_guard lock(lock_);
+    ++stats_.dropped;
+    return false;
+  }
+
+  std::array<std::byte, kNetworkLogEntryHeaderSize> header;
+  header[0] = static_cast<std::byte>(message.size());
+  PutLittleEndian(&header[1], metadata, 4);
+
+  bool wake = false;
+  {
+    std::lock_guard lock(lock_);
+    if (buffer_.size() - used_ < size) {
+      ++stats_.dropped;
+      return false;
+    }
+    const size_t position = (head_ + used_) % buffer_.size();
+    CopyIn(position, header);
+    CopyIn((position + header.size()) % buffer_.size(), message);
+    wake = used_ < options_.batch_bytes &&
+           used_ + size >= options_.batch_bytes;
+    used_ += size;
+    ++stats_.entries;
+  }
+  if (wake) {
+    wake_.release();
+  }
+  return true;
+}
+
+size_t NetworkLogSink::RunOnce() {
+  size_t sent = 0;
+  while (frame_used_ != 0 || BuildFrame()) {
+    const pw::Status status = socket_.Write(frame_.first(frame_used_));
+    if (!status.ok()) {
+      {
+        std::lock_guard lock(lock_);
+        ++stats_.send_failures;
+      }
+      // A write that failed on a live connection may have sent part of the
+      // frame; restart the stream so the collector sees whole frames only.
+      // Unavailable: a ReconnectingTcpSocket waiting for its backoff
+      if (!status.IsUnavailable() && socket_.IsConnected()) {
+        socket_.Disconnect();
+        socket_.Connect().IgnoreError();
+      }
+      break;
+    }
+    {
+      std::lock_guard lock(lock_);
+      ++stats_.frames;
+      stats_.bytes += static_cast<uint32_t>(frame_used_);
+    }
+    frame_used_ = 0;
+    ++sent;
+  }
+  return sent;
+}
+
+size_t NetworkLogSink::buffered() {
+  std::lock_guard lock(lock_);
+  return used_;
+}
+
+NetworkLogStats NetworkLogSink::stats() {
+  std::lock_guard lock(lock_);
+  return stats_;
+}
+
+bool NetworkLogSink::BuildFrame() {
+  size_t frame_used = kNetworkLogFrameHeaderSize;
+  // One entry per lock, so interrupts stay enabled between copies
+  while (true) {
+    std::lock_guard lock(lock_);
+    if (used_ == 0) {
+      break;
+    }
+    std::byte size_byte;
+    CopyOut(head_, pw::ByteSpan(&size_byte, 1));
+    const size_t size =
+        kNetworkLogEntryHeaderSize + static_cast<size_t>(size_byte);
+    if (frame_used + size > frame_.size()) {
+      break;
+    }
+    CopyOut(head_, frame_.subspan(frame_used, size));
+    head_ = (head_ + size) % buffer_.size();
+    used_ -= size;
+    frame_used += size;
+  }
+
+  uint32_t dropped;
+  {
+    std::lock_guard lock(lock_);
+    dropped = stats_.dropped - dropped_reported_;
+    dropped_reported_ = stats_.dropped;
+  }
+  if (frame_used == kNetworkLogFrameHeaderSize && dropped == 0) {
+    return false;
+  }
+
+  std::byte* header = frame_.data();
+  PutLittleEndian(&header[0], kNetworkLogFrameMagic, 2);
+  PutLittleEndian(
+      &header[2],
+      static_cast<uint32_t>(frame_used - kNetworkLogFrameHeaderSize), 2);
+  PutLittleEndian(&header[4], sequence_++, 4);
+  PutLittleEndian(&header[8], dropped, 4);
+  frame_used_ = frame_used;
+  return true;
+}
+
+void NetworkLogSink::CopyOut(size_t position, pw::ByteSpan out) const {
+  const size_t first = std::min(out.size(), buffer_.size() - position);
+  std::memcpy(out.data(), buffer_.data() + position, first);
+  std::memcpy(out.data() + first, buffer_.data(), out.size() - first);
+}
+
+void NetworkLogSink::CopyIn(size_t position, pw::ConstByteSpan data) {
+  const size_t first = std::min(data.size(), buffer_.size() - position);
+  std::memcpy(buffer_.data() + position, data.data(), first);
+  std::memcpy(buffer_.data(), data.data() + first, data.size() - first);
+}
+
+void NetworkLogSink::Run() {
+  const auto interval = pw::chrono::SystemClock::for_at_least(
+      std::chrono::milliseconds(options_.flush_interval_ms));
+  while (true) {
+    // Woken early once batch_bytes are buffered
+    static_cast<void>(wake_.try_acquire_for(interval));
+    {
+      std::lock_guard lock(lock_);
+      if (stop_) {
+        break;
+      }
+    }
+    RunOnce();
+  }
+  exited_.release();
+}
+
+void SetNetworkLogSink(NetworkLogSink* sink) {
+  g_sink.store(sink, std::memory_order_release);
+}
+
+bool WriteNetworkLog(uint32_t metadata, pw::ConstByteSpan message) {
+  NetworkLogSink* sink = g_sink.load(std::memory_order_acquire);
+  return sink != nullptr && sink->Write(metadata, message);
+}
+
+}  // namespace pb::log
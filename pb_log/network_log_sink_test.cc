@@ -0,0 +1,196 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_log/network_log_sink.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "mock_tcp_socket.h"
+#include "pw_unit_test/framework.h"
+
+namespace pb::log {
+namespace {
+
+using socket::MockTcpSocket;
+
+constexpr uint8_t kMessage[] = {0x12, 0x34, 0x56, 0x78, 0x01};
+
+pw::ConstByteSpan Message() { return pw::as_bytes(pw::span(kMessage)); }
+
+uint32_t ReadLittleEndian(const std::vector<std::byte>& data,
+                          size_t offset,
+                          size_t size) {
+  uint32_t value = 0;
+  for (size_t i = 0; i < size; ++i) {
+    value |= static_cast<uint32_t>(data[offset + i]) << (8 * i);
+  }
+  return value;
+}
+
+struct Frame {
+  uint32_t sequence;
+  uint32_t dropped;
+  std::vector<uint32_t> metadata;  // One per entry
+};
+
+// Parses the frames in `data`; fails the test on a malformed one.
+std::vector<Frame> ParseFrames(const std::vector<std::byte>& data) {
+  std::vector<Frame> frames;
+  size_t offset = 0;
+  while (offset < data.size()) {
+    EXPECT_GE(data.size() - offset, kNetworkLogFrameHeaderSize);
+    EXPECT_EQ(ReadLittleEndian(data, offset, 2), kNetworkLogFrameMagic);
+    const size_t length = ReadLittleEndian(data, offset + 2, 2);
+    Frame frame = {.sequence = ReadLittleEndian(data, offset + 4, 4),
+                   .dropped = ReadLittleEndian(data, offset + 8, 4),
+                   .metadata = {}};
+    size_t position = offset + kNetworkLogFrameHeaderSize;
+    const size_t end = position + length;
+    while (position < end) {
+      const size_t size = static_cast<size_t>(data[position]);
+      frame.metadata.push_back(ReadLittleEndian(data, position + 1, 4));
+      position += kNetworkLogEntryHeaderSize + size;
+    }
+    EXPECT_EQ(position, end);
+    frames.push_back(frame);
+    offset = end;
+  }
+  return frames;
+}
+
+// Entry of kMessage with its header
+constexpr size_t kEntrySize = kNetworkLogEntryHeaderSize + sizeof(kMessage);
+
+TEST(NetworkLogSink, BatchesEntriesIntoOneFrame) {
+  MockTcpSocket socket;
+  socket.set_connected(true);
+  NetworkLogSinkWithBuffer<256> sink(socket);
+
+  EXPECT_TRUE(sink.Write(1, Message()));
+  EXPECT_TRUE(sink.Write(2, Message()));
+  EXPECT_TRUE(sink.Write(3, Message()));
+  EXPECT_EQ(sink.buffered(), 3 * kEntrySize);
+  EXPECT_TRUE(socket.written_data().empty());
+
+  EXPECT_EQ(sink.RunOnce(), 1u);
+  const std::vector<Frame> frames = ParseFrames(socket.written_data());
+  ASSERT_EQ(frames.size(), 1u);
+  EXPECT_EQ(frames[0].sequence, 0u);
+  EXPECT_EQ(frames[0].dropped, 0u);
+  EXPECT_EQ(frames[0].metadata, (std::vector<uint32_t>{1, 2, 3}));
+  EXPECT_EQ(sink.buffered(), 0u);
+  EXPECT_EQ(sink.stats().frames, 1u);
+  EXPECT_EQ(sink.stats().bytes, kNetworkLogFrameHeaderSize + 3 * kEntrySize);
+}
+
+TEST(NetworkLogSink, SplitsAtFrameSize) {
+  MockTcpSocket socket;
+  socket.set_connected(true);
+  // Two entries per frame
+  NetworkLogSinkWithBuffer<256, kNetworkLogFrameHeaderSize + 2 * kEntrySize>
+      sink(socket);
+
+  for (uint32_t i = 0; i < 5; ++i) {
+    ASSERT_TRUE(sink.Write(i, Message()));
+  }
+  EXPECT_EQ(sink.RunOnce(), 3u);
+
+  const std::vector<Frame> frames = ParseFrames(socket.written_data());
+  ASSERT_EQ(frames.size(), 3u);
+  EXPECT_EQ(frames[0].metadata, (std::vector<uint32_t>{0, 1}));
+  EXPECT_EQ(frames[1].metadata, (std::vector<uint32_t>{2, 3}));
+  EXPECT_EQ(frames[2].metadata, (std::vector<uint32_t>{4}));
+  EXPECT_EQ(frames[2].sequence, 2u);
+}
+
+TEST(NetworkLogSink, FullBufferDropsAndReportsCount) {
+  MockTcpSocket socket;
+  socket.set_connected(true);
+  NetworkLogSinkWithBuffer<3 * kEntrySize> sink(socket);
+
+  EXPECT_TRUE(sink.Write(1, Message()));
+  EXPECT_TRUE(sink.Write(2, Message()));
+  EXPECT_TRUE(sink.Write(3, Message()));
+  EXPECT_FALSE(sink.Write(4, Message()));
+  EXPECT_FALSE(sink.Write(5, Message()));
+  EXPECT_EQ(sink.stats().dropped, 2u);
+
+  EXPECT_EQ(sink.RunOnce(), 1u);
+  std::vector<Frame> frames = ParseFrames(socket.PopWrittenData());
+  ASSERT_EQ(frames.size(), 1u);
+  EXPECT_EQ(frames[0].dropped, 2u);
+
+  // Reported once
+  EXPECT_TRUE(sink.Write(6, Message()));
+  EXPECT_EQ(sink.RunOnce(), 1u);
+  frames = ParseFrames(socket.PopWrittenData());
+  ASSERT_EQ(frames.size(), 1u);
+  EXPECT_EQ(frames[0].dropped, 0u);
+}
+
+TEST(NetworkLogSink, WrapsAroundBufferEnd) {
+  MockTcpSocket socket;
+  socket.set_connected(true);
+  // Odd size, so entries straddle the end of the buffer
+  NetworkLogSinkWithBuffer<2 * kEntrySize + 3> sink(socket);
+
+  for (uint32_t i = 0; i < 6; ++i) {
+    ASSERT_TRUE(sink.Write(0x1000 + i, Message()));
+    ASSERT_TRUE(sink.Write(0x2000 + i, Message()));
+    ASSERT_EQ(sink.RunOnce(), 1u);
+    const std::vector<Frame> frames = ParseFrames(socket.PopWrittenData());
+    ASSERT_EQ(frames.size(), 1u);
+    EXPECT_EQ(frames[0].metadata,
+              (std::vector<uint32_t>{0x1000 + i, 0x2000 + i}));
+  }
+}
+
+TEST(NetworkLogSink, KeepsFrameWhileDisconnected) {
+  MockTcpSocket socket;
+  NetworkLogSinkWithBuffer<256> sink(socket);
+
+  ASSERT_TRUE(sink.Write(1, Message()));
+  EXPECT_EQ(sink.RunOnce(), 0u);
+  EXPECT_EQ(sink.stats().send_failures, 1u);
+  EXPECT_EQ(sink.buffered(), 0u);  // Packed into the pending frame
+
+  ASSERT_TRUE(sink.Write(2, Message()));
+  socket.set_connected(true);
+  EXPECT_EQ(sink.RunOnce(), 2u);
+
+  const std::vector<Frame> frames = ParseFrames(socket.written_data());
+  ASSERT_EQ(frames.size(), 2u);
+  EXPECT_EQ(frames[0].sequence, 0u);
+  EXPECT_EQ(frames[0].metadata, (std::vector<uint32_t>{1}));
+  EXPECT_EQ(frames[1].sequence, 1u);
+  EXPECT_EQ(frames[1].metadata, (std::vector<uint32_t>{2}));
+}
+
+TEST(NetworkLogSink, RejectsEntryLargerThanFrame) {
+  MockTcpSocket socket;
+  socket.set_connected(true);
+  NetworkLogSinkWithBuffer<256, kNetworkLogFrameHeaderSize + kEntrySize>
+      sink(socket);
+
+  constexpr std::array<std::byte, sizeof(kMessage) + 1> kLong{};
+  EXPECT_TRUE(sink.Write(1, Message()));
+  EXPECT_FALSE(sink.Write(2, kLong));
+  EXPECT_EQ(sink.stats().entries, 1u);
+  EXPECT_EQ(sink.stats().dropped, 1u);
+}
+
+TEST(NetworkLogSink, WritesToRegisteredSink) {
+  MockTcpSocket socket;
+  NetworkLogSinkWithBuffer<256> sink(socket);
+
+  EXPECT_FALSE(WriteNetworkLog(1, Message()));
+  SetNetworkLogSink(&sink);
+  EXPECT_TRUE(WriteNetworkLog(1, Message()));
+  SetNetworkLogSink(nullptr);
+  EXPECT_EQ(sink.stats().entries, 1u);
+}
+
+}  // namespace
+}  // namespace pb::log
@@ -0,0 +1,82 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Configuration options for pb_log
+
+// Queue Device OS log messages in a ring buffer drained by a low-priority
+// thread, so logging threads (including the system thread) do not wait for
+// the USB transfer. Set to 0 to write each message from the calling thread.
+#ifndef PB_LOG_CONFIG_ASYNC
+#define PB_LOG_CONFIG_ASYNC 1
+#endif
+
+// Copy every Device OS message that passes the level filter into a ring in
+// retained RAM, readable after a reset (pb_log/retained_crash_log.h).
+#ifndef PB_LOG_CONFIG_CRASH_LOG
+#define PB_LOG_CONFIG_CRASH_LOG 1
+#endif
+
+// Drop copies of the previous message and limit each category's message
+// rate (pb_log/log_limiter.h), so a failure storm cannot saturate USB.
+#ifndef PB_LOG_CONFIG_RATE_LIMIT
+#define PB_LOG_CONFIG_RATE_LIMIT 1
+#endif
+
+// Stack of the drain thread ("log_drain"), which formats nothing itself
+// and only hands queued messages to the USB serial.
+#ifndef PB_LOG_CONFIG_DRAIN_STACK_SIZE
+#define PB_LOG_CONFIG_DRAIN_STACK_SIZE 1536
+#endif
+
+// Stack of the network log drain thread (NetworkLogSink, suggested name
+// "log_net"), which packs frames and blocks in the socket write.
+#ifndef PB_LOG_CONFIG_NETWORK_STACK_SIZE
+#define PB_LOG_CONFIG_NETWORK_STACK_SIZE 2048
+#endif
+
+namespace pb::log::config {
+
+// Messages the ring holds before new ones are dropped (power of two).
+inline constexpr size_t kRingSlots = 16;
+
+// Longest category and message kept per slot, including the terminator;
+// longer ones are truncated.
+inline constexpr size_t kMaxCategorySize = 16;
+inline constexpr size_t kMaxMessageSize = 128;
+
+// Priority and stack of the drain thread ("log_drain"). Below the default,
+// so it writes when nothing else needs the CPU.
+inline constexpr int kDrainThreadPriority = 1;
+inline constexpr size_t kDrainThreadStackSize = PB_LOG_CONFIG_DRAIN_STACK_SIZE;
+
+// Suggested priority and stack of the network log drain thread. Lowest
+// above idle, like the USB drain: logs go out when nothing else runs.
+inline constexpr int kNetworkThreadPriority = 1;
+inline constexpr size_t kNetworkThreadStackSize =
+    PB_LOG_CONFIG_NETWORK_STACK_SIZE;
+
+// Device OS messages below this level are not formatted at all, unless a
+// category threshold (SetCategoryLogLevel) says otherwise. 40 is
+// LOG_LEVEL_WARN.
+inline constexpr int kDefaultLogLevel = 40;
+
+// Categories that can have their own threshold.
+inline constexpr size_t kMaxCategoryFilters = 8;
+
+// Retained RAM used by the crash log, and the longest message kept per
+// entry. The P2 has about 3 KB of retained RAM for the whole application.
+inline constexpr size_t kCrashLogSize = 1024;
+inline constexpr size_t kCrashLogMessageSize = 96;
+
+// Per-category token bucket: messages allowed in a burst, and refill rate.
+// kRateLimitCategories categories have a bucket at a time.
+inline constexpr uint32_t kRateLimitBurst = 20;
+inline constexpr uint32_t kRateLimitPerSecond = 10;
+inline constexpr size_t kRateLimitCategories = 8;
+
+}  // namespace pb::log::config
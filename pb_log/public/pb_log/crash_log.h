@@ -0,0 +1,163 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file crash_log.h
+/// @brief Log ring that survives a reset when placed in retained RAM.
+///
+/// Entries are packed as `[level][category size][message size][category]
+/// [message]` into a byte ring; a full ring overwrites its oldest entries.
+/// The class has no constructor and no member initializers, so an instance
+/// in a retained section keeps its content across a reset. Attach() then
+/// checks the header and keeps the previous entries or starts empty.
+///
+/// The header is updated after the entry bytes are written, so a reset in
+/// the middle of Append() loses at most that entry. A torn header fails
+/// the check word and discards the ring.
+///
+/// Not thread safe: callers serialize Append() and ForEach().
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace pb::log {
+
+template <size_t kDataSize, size_t kMaxCategorySize = 16,
+          size_t kMaxMessageSize = 96>
+class CrashLog {
+ public:
+  static_assert(kMaxCategorySize <= 255 && kMaxMessageSize <= 255,
+                "Entry sizes are stored in one byte");
+  static_assert(kDataSize >= 3 + kMaxCategorySize + kMaxMessageSize,
+                "The ring must hold at least one full entry");
+
+  /// Longest category and message kept per entry; longer ones are
+  /// truncated.
+  static constexpr size_t kMaxCategory = kMaxCategorySize;
+  static constexpr size_t kMaxMessage = kMaxMessageSize;
+
+  /// Keep the content if the header is intact, otherwise start empty.
+  ///
+  /// @return True if entries from before the reset were kept
+  bool Attach() {
+    if (magic_ == kMagic && begin_ < kDataSize && used_ <= kDataSize &&
+        check_ == Check()) {
+      return used_ > 0;
+    }
+    Clear();
+    return false;
+  }
+
+  void Clear() {
+    begin_ = 0;
+    used_ = 0;
+    magic_ = kMagic;
+    check_ = Check();
+  }
+
+  /// Add an entry, overwriting the oldest ones if needed.
+  void Append(uint8_t level, std::string_view category,
+              std::string_view message) {
+    category = category.substr(0, kMaxCategorySize);
+    message = message.substr(0, kMaxMessageSize);
+    const size_t size = 3 + category.size() + message.size();
+
+    uint32_t begin = begin_;
+    uint32_t used = used_;
+    while (kDataSize - used < size) {
+      const size_t oldest = EntrySize(begin);
+      begin = Wrap(begin + oldest);
+      used -= oldest;
+    }
+    // Publish the dropped entries before their bytes get overwritten
+    if (begin != begin_) {
+      SetHeader(begin, used);
+    }
+
+    size_t position = Wrap(begin + used);
+    position = Put(position, level);
+    position = Put(position, static_cast<uint8_t>(category.size()));
+    position = Put(position, static_cast<uint8_t>(message.size()));
+    for (char c : category) {
+      position = Put(position, static_cast<uint8_t>(c));
+    }
+    for (char c : message) {
+      position = Put(position, static_cast<uint8_t>(c));
+    }
+    SetHeader(begin, used + size);
+  }
+
+  /// Call `visit(uint8_t level, std::string_view category,
+  /// std::string_view message)` for each entry, oldest first.
+  template <typename Visit>
+  void ForEach(Visit&& visit) const {
+    std::array<char, kMaxCategorySize> category;
+    std::array<char, kMaxMessageSize> message;
+    size_t position = begin_;
+    size_t remaining = used_;
+    while (remaining >= 3) {
+      const uint8_t level = data_[position];
+      const size_t category_size = data_[Wrap(position + 1)];
+      const size_t message_size = data_[Wrap(position + 2)];
+      const size_t size = 3 + category_size + message_size;
+      if (category_size > kMaxCategorySize ||
+          message_size > kMaxMessageSize || size > remaining) {
+        return;  // Not an entry we wrote; stop rather than misparse
+      }
+      position = Wrap(position + 3);
+      for (size_t i = 0; i < category_size; ++i) {
+        category[i] = static_cast<char>(data_[position]);
+        position = Wrap(position + 1);
+      }
+      for (size_t i = 0; i < message_size; ++i) {
+        message[i] = static_cast<char>(data_[position]);
+        position = Wrap(position + 1);
+      }
+      visit(level,
+            std::string_view(category.data(), category_size),
+            std::string_view(message.data(), message_size));
+      remaining -= size;
+    }
+  }
+
+  /// Bytes of entry data held.
+  size_t used() const { return used_; }
+
+ private:
+  static constexpr uint32_t kMagic = 0x50424c31;  // "PBL1"
+
+  static size_t Wrap(size_t position) { return position % kDataSize; }
+
+  size_t EntrySize(size_t position) const {
+    return 3 + data_[Wrap(position + 1)] + data_[Wrap(position + 2)];
+  }
+
+  size_t Put(size_t position, uint8_t value) {
+    data_[position] = value;
+    return Wrap(position + 1);
+  }
+
+  uint32_t Check() const {
+    return ~(kMagic ^ (begin_ * 0x9e3779b1u) ^ used_ ^
+             static_cast<uint32_t>(kDataSize));
+  }
+
+  void SetHeader(uint32_t begin, uint32_t used) {
+    begin_ = begin;
+    used_ = used;
+    check_ = Check();
+  }
+
+  // No initializers: see the file comment
+  uint32_t magic_;
+  uint32_t begin_;
+  uint32_t used_;
+  uint32_t check_;
+  std::array<uint8_t, kDataSize> data_;
+};
+
+}  // namespace pb::log
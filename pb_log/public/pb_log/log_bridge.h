@@ -5,10 +5,40 @@
 
 #pragma once
 
+#include <cstdint>
+#include <string_view>
+
+#include "pw_status/status.h"
+
 namespace pb::log {
 
 // Initialize the log bridge. Call this early in setup() to intercept
-// all Device OS system logs and route them through pw_log.
+// all Device OS system logs and route them through pw_log. With
+// PB_LOG_CONFIG_ASYNC (the default) this also starts the drain thread.
 void InitLogBridge();
 
+// Threshold for Device OS messages whose category has no threshold of its
+// own. Messages below it are never formatted. Default
+// config::kDefaultLogLevel (WARN). Levels are Device OS levels: TRACE=1,
+// INFO=30, WARN=40, ERROR=50, PANIC=60.
+void SetDefaultLogLevel(int level);
+int DefaultLogLevel();
+
+// Threshold for `category` and its subcategories ("comm" also covers
+// "comm.protocol"); the longest matching category wins. Safe to call at
+// runtime, e.g. from an RPC handler, but not from two threads at once.
+// Returns InvalidArgument for an empty or too long category and
+// ResourceExhausted when config::kMaxCategoryFilters categories are set.
+pw::Status SetCategoryLogLevel(std::string_view category, int level);
+
+// Drop the threshold for `category`; the default applies again.
+pw::Status ClearCategoryLogLevel(std::string_view category);
+
+// Threshold currently applied to `category`.
+int CategoryLogLevel(std::string_view category);
+
+// Device OS messages dropped because the log ring was full (always 0
+// without PB_LOG_CONFIG_ASYNC).
+uint32_t DroppedLogMessages();
+
 }  // namespace pb::log
@@ -0,0 +1,126 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file log_filter.h
+/// @brief Per-category log level thresholds, checked before formatting.
+///
+/// Device OS asks the bridge whether a (level, category) is enabled before
+/// it formats a message. The filter answers from a small table of category
+/// thresholds and a default threshold. Categories are hierarchical like
+/// Device OS's own filters: an entry for "comm" also applies to
+/// "comm.protocol", and the longest matching entry wins.
+///
+/// Enabled() is lock-free and may run on any thread. The setters may run
+/// concurrently with Enabled(), but not with each other (call them from
+/// setup() or a single RPC thread).
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <string_view>
+
+#include "pw_status/status.h"
+
+namespace pb::log {
+
+template <size_t kEntries, size_t kCategorySize>
+class LogFilter {
+ public:
+  /// Threshold of an entry that was cleared: the next shorter match or
+  /// the default threshold applies.
+  static constexpr int kInherit = -1;
+
+  explicit constexpr LogFilter(int default_level)
+      : default_level_(default_level) {}
+
+  LogFilter(const LogFilter&) = delete;
+  LogFilter& operator=(const LogFilter&) = delete;
+
+  /// True if a message of `level` in `category` should be logged.
+  bool Enabled(int level, std::string_view category) const {
+    return level >= Threshold(category);
+  }
+
+  /// Threshold that applies to `category`.
+  int Threshold(std::string_view category) const {
+    int threshold = default_level_.load(std::memory_order_relaxed);
+    size_t best_length = 0;
+    const size_t count =
+        std::min(used_.load(std::memory_order_acquire), kEntries);
+    for (size_t i = 0; i < count; ++i) {
+      const Entry& entry = entries_[i];
+      const int level = entry.level.load(std::memory_order_relaxed);
+      const std::string_view name(entry.category.data(), entry.length);
+      if (level != kInherit && entry.length > best_length &&
+          Matches(name, category)) {
+        threshold = level;
+        best_length = entry.length;
+      }
+    }
+    return threshold;
+  }
+
+  int default_level() const {
+    return default_level_.load(std::memory_order_relaxed);
+  }
+
+  void SetDefaultLevel(int level) {
+    default_level_.store(level, std::memory_order_relaxed);
+  }
+
+  /// Set the threshold for `category` and its subcategories; kInherit
+  /// clears it.
+  ///
+  /// @return InvalidArgument for an empty or too long category,
+  ///         ResourceExhausted if the table is full
+  pw::Status SetLevel(std::string_view category, int level) {
+    if (category.empty() || category.size() >= kCategorySize) {
+      return pw::Status::InvalidArgument();
+    }
+    const size_t count = used_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) {
+      Entry& entry = entries_[i];
+      if (std::string_view(entry.category.data(), entry.length) == category) {
+        entry.level.store(level, std::memory_order_relaxed);
+        return pw::OkStatus();
+      }
+    }
+    if (level == kInherit) {
+      return pw::OkStatus();
+    }
+    // Entries are never renamed, so a reader never sees a half-written
+    // name; a new category always appends
+    if (count == kEntries) {
+      return pw::Status::ResourceExhausted();
+    }
+    Entry& entry = entries_[count];
+    std::copy(category.begin(), category.end(), entry.category.begin());
+    entry.length = category.size();
+    entry.level.store(level, std::memory_order_relaxed);
+    used_.store(count + 1, std::memory_order_release);
+    return pw::OkStatus();
+  }
+
+ private:
+  struct Entry {
+    std::array<char, kCategorySize> category{};
+    size_t length = 0;
+    std::atomic<int> level{kInherit};
+  };
+
+  // "comm" matches "comm" and "comm.protocol", not "commander"
+  static bool Matches(std::string_view prefix, std::string_view category) {
+    return category.substr(0, prefix.size()) == prefix &&
+           (category.size() == prefix.size() ||
+            category[prefix.size()] == '.');
+  }
+
+  std::array<Entry, kEntries> entries_{};
+  std::atomic<size_t> used_{0};
+  std::atomic<int> default_level_;
+};
+
+}  // namespace pb::log
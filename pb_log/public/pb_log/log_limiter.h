@@ -0,0 +1,134 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file log_limiter.h
+/// @brief Duplicate suppression and per-category rate limiting.
+///
+/// Two cheap checks bound the cost of a log storm:
+///
+/// - A message identical to the previous one (same level, category and
+///   text) is counted instead of logged. The count is reported with the
+///   next different message ("last message repeated N times").
+/// - Each category has a token bucket: `burst` messages at once, refilled
+///   at `per_second`. Messages beyond that are counted and the count is
+///   reported with the next message the bucket lets through.
+///
+/// Categories are tracked in a small table; when it is full, the least
+/// recently used category gives up its bucket.
+///
+/// Not thread safe: callers serialize Check().
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace pb::log {
+
+template <size_t kCategories>
+class LogLimiter {
+ public:
+  static_assert(kCategories > 0);
+
+  struct Decision {
+    /// Log this message.
+    bool emit = false;
+    /// Copies of the previous message suppressed since it was logged;
+    /// report them even if this message is not emitted.
+    uint32_t repeated = 0;
+    /// Messages of this category dropped by the rate limit since the last
+    /// one that got through; report them with this one.
+    uint32_t limited = 0;
+  };
+
+  constexpr LogLimiter(uint32_t burst, uint32_t per_second)
+      : burst_(burst), per_second_(per_second) {}
+
+  LogLimiter(const LogLimiter&) = delete;
+  LogLimiter& operator=(const LogLimiter&) = delete;
+
+  Decision Check(int level, std::string_view category,
+                 std::string_view message, uint32_t now_ms) {
+    Decision decision;
+    const uint32_t key = Hash(Hash(kHashSeed, category), message) ^
+                         static_cast<uint32_t>(level);
+    if (have_last_ && key == last_key_) {
+      ++repeated_;
+      return decision;
+    }
+    decision.repeated = repeated_;
+    repeated_ = 0;
+
+    Bucket& bucket = Find(Hash(kHashSeed, category), now_ms);
+    Refill(bucket, now_ms);
+    if (bucket.milli_tokens < kMilli) {
+      ++bucket.limited;
+      // A dropped message still ends a run of duplicates
+      have_last_ = false;
+      return decision;
+    }
+    bucket.milli_tokens -= kMilli;
+    decision.emit = true;
+    decision.limited = bucket.limited;
+    bucket.limited = 0;
+    have_last_ = true;
+    last_key_ = key;
+    return decision;
+  }
+
+ private:
+  static constexpr uint32_t kMilli = 1000;
+  static constexpr uint32_t kHashSeed = 2166136261u;
+
+  struct Bucket {
+    uint32_t category = 0;
+    uint32_t milli_tokens = 0;
+    uint32_t updated_ms = 0;
+    uint32_t limited = 0;
+    bool used = false;
+  };
+
+  // FNV-1a
+  static uint32_t Hash(uint32_t hash, std::string_view text) {
+    for (char c : text) {
+      hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return hash;
+  }
+
+  Bucket& Find(uint32_t category, uint32_t now_ms) {
+    Bucket* victim = nullptr;
+    for (Bucket& bucket : buckets_) {
+      if (bucket.used && bucket.category == category) {
+        return bucket;
+      }
+      if (victim == nullptr || !bucket.used ||
+          (victim->used &&
+           now_ms - bucket.updated_ms > now_ms - victim->updated_ms)) {
+        victim = &bucket;
+      }
+    }
+    *victim = Bucket{category, burst_ * kMilli, now_ms, 0, true};
+    return *victim;
+  }
+
+  void Refill(Bucket& bucket, uint32_t now_ms) {
+    const uint64_t refill =
+        static_cast<uint64_t>(now_ms - bucket.updated_ms) * per_second_;
+    const uint64_t tokens = bucket.milli_tokens + refill;
+    const uint64_t cap = static_cast<uint64_t>(burst_) * kMilli;
+    bucket.milli_tokens = static_cast<uint32_t>(tokens < cap ? tokens : cap);
+    bucket.updated_ms = now_ms;
+  }
+
+  const uint32_t burst_;
+  const uint32_t per_second_;
+  std::array<Bucket, kCategories> buckets_{};
+  uint32_t last_key_ = 0;
+  bool have_last_ = false;
+  uint32_t repeated_ = 0;
+};
+
+}  // namespace pb::log
@@ -0,0 +1,121 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file log_ring.h
+/// @brief Bounded lock-free queue of log messages.
+///
+/// Any number of threads push without blocking; one drain thread pops. A
+/// push into a full ring fails and is counted instead of waiting. Each
+/// slot has a sequence number (Vyukov's bounded queue), so a producer
+/// claims a slot with one compare-and-swap and publishes it with one
+/// store, and the consumer never sees a half-written message.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace pb::log {
+
+/// One queued message, truncated to the slot size.
+template <size_t kCategorySize, size_t kMessageSize>
+struct LogRecord {
+  int level = 0;
+  std::array<char, kCategorySize> category{};  // NUL-terminated
+  std::array<char, kMessageSize> message{};    // NUL-terminated
+};
+
+template <size_t kSlots, size_t kCategorySize, size_t kMessageSize>
+class LogRing {
+ public:
+  static_assert(kSlots >= 2 && (kSlots & (kSlots - 1)) == 0,
+                "kSlots must be a power of two");
+
+  using Record = LogRecord<kCategorySize, kMessageSize>;
+
+  LogRing() {
+    for (size_t i = 0; i < kSlots; ++i) {
+      slots_[i].sequence.store(static_cast<uint32_t>(i),
+                               std::memory_order_relaxed);
+    }
+  }
+
+  LogRing(const LogRing&) = delete;
+  LogRing& operator=(const LogRing&) = delete;
+
+  /// Queue a message; safe from any thread, never blocks.
+  ///
+  /// @return False (and counted in dropped()) if the ring is full
+  bool TryPush(int level, std::string_view category, std::string_view message) {
+    uint32_t position = enqueue_.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+      slot = &slots_[position % kSlots];
+      const uint32_t sequence = slot->sequence.load(std::memory_order_acquire);
+      const auto lag = static_cast<int32_t>(sequence - position);
+      if (lag == 0) {
+        if (enqueue_.compare_exchange_weak(position, position + 1,
+                                           std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (lag < 0) {
+        // The slot still holds a message from the previous lap
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else {
+        position = enqueue_.load(std::memory_order_relaxed);
+      }
+    }
+
+    slot->record.level = level;
+    Copy(category, slot->record.category);
+    Copy(message, slot->record.message);
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Pass the oldest message to `consume(const Record&)` and free its slot.
+  /// Only one thread may pop.
+  ///
+  /// @return False if the ring is empty
+  template <typename Consume>
+  bool TryPop(Consume&& consume) {
+    const uint32_t position = dequeue_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[position % kSlots];
+    const uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (static_cast<int32_t>(sequence - (position + 1)) < 0) {
+      return false;
+    }
+    consume(static_cast<const Record&>(slot.record));
+    slot.sequence.store(position + kSlots, std::memory_order_release);
+    dequeue_.store(position + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /// Messages dropped because the ring was full, since construction.
+  uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Slot {
+    std::atomic<uint32_t> sequence{0};
+    Record record;
+  };
+
+  template <size_t kSize>
+  static void Copy(std::string_view text, std::array<char, kSize>& out) {
+    const size_t size = std::min(text.size(), kSize - 1);
+    std::copy_n(text.begin(), size, out.begin());
+    out[size] = '\0';
+  }
+
+  std::array<Slot, kSlots> slots_;
+  std::atomic<uint32_t> enqueue_{0};
+  std::atomic<uint32_t> dequeue_{0};
+  std::atomic<uint32_t> dropped_{0};
+};
+
+}  // namespace pb::log
@@ -0,0 +1,170 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file network_log_sink.h
+/// @brief Streams tokenized log entries to a TCP collector in large frames.
+///
+/// Logging threads copy each entry into a bounded RAM buffer under an
+/// interrupt spin lock and return; a full buffer drops the entry and counts
+/// it. A low-priority drain thread packs the buffered entries into frames
+/// and writes them to the socket, so only the drain thread ever waits for
+/// the network.
+///
+/// Frame (little endian):
+///
+///   magic (2, "PL") | length (2) | sequence (4) | dropped (4) | entries
+///
+/// `length` counts the bytes after the 12-byte header. `dropped` is the
+/// number of entries lost to a full buffer since the previous frame. Each
+/// entry is
+///
+///   size (1) | pw_log_tokenized metadata (4) | encoded message (size)
+///
+/// A frame that could not be sent is kept and sent first once the socket
+/// is back, so sequence numbers have no gaps; a gap in the log is only
+/// ever reported as `dropped`. tools/log_collector.py receives and
+/// detokenizes the stream.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pb_socket/tcp_socket.h"
+#include "pw_bytes/span.h"
+#include "pw_status/status.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/thread_notification.h"
+#include "pw_sync/timed_thread_notification.h"
+#include "pw_thread/options.h"
+#include "pw_thread/thread.h"
+
+namespace pb::log {
+
+inline constexpr uint16_t kNetworkLogFrameMagic = 0x4c50;  // "PL"
+inline constexpr size_t kNetworkLogFrameHeaderSize = 12;
+inline constexpr size_t kNetworkLogEntryHeaderSize = 5;
+
+/// Batching of a NetworkLogSink.
+struct NetworkLogOptions {
+  /// Buffered bytes that wake the drain thread before the interval ends.
+  size_t batch_bytes = 512;
+  /// Longest an entry waits in the buffer while the collector is reachable.
+  uint32_t flush_interval_ms = 1000;
+};
+
+/// Counters of a NetworkLogSink, since construction.
+struct NetworkLogStats {
+  uint32_t entries = 0;        ///< Entries accepted into the buffer
+  uint32_t dropped = 0;        ///< Entries lost to a full buffer
+  uint32_t frames = 0;         ///< Frames sent
+  uint32_t bytes = 0;          ///< Bytes sent, headers included
+  uint32_t send_failures = 0;  ///< Frame writes that failed
+};
+
+/// Tokenized log sink over any TcpSocket. Wrap a ParticleTcpSocket in a
+/// ReconnectingTcpSocket and Connect() it once: the sink does not connect
+/// by itself, it keeps its frame until a write goes through.
+class NetworkLogSink {
+ public:
+  /// `buffer` holds entries waiting for the drain thread; `frame` is the
+  /// largest frame sent. Both must outlive the sink.
+  NetworkLogSink(socket::TcpSocket& socket,
+                 pw::ByteSpan buffer,
+                 pw::ByteSpan frame,
+                 const NetworkLogOptions& options = {});
+
+  /// Stops the drain thread.
+  ~NetworkLogSink();
+
+  NetworkLogSink(const NetworkLogSink&) = delete;
+  NetworkLogSink& operator=(const NetworkLogSink&) = delete;
+
+  /// Start the drain thread.
+  ///
+  /// @return OkStatus, or FailedPrecondition if already started
+  pw::Status Start(const pw::thread::Options& options);
+
+  /// Stop the drain thread after its current write. Buffered entries stay
+  /// buffered.
+  void Stop();
+
+  /// Buffer one entry. Safe from any thread and from interrupts; never
+  /// blocks.
+  ///
+  /// @return False (and counted as dropped) if the buffer is full or the
+  ///         entry cannot fit a frame
+  bool Write(uint32_t metadata, pw::ConstByteSpan message);
+
+  /// Send the buffered entries. Used by the drain thread; host tests call
+  /// it instead of Start().
+  ///
+  /// @return Number of frames sent
+  size_t RunOnce();
+
+  /// Bytes of entries waiting in the buffer.
+  size_t buffered();
+
+  NetworkLogStats stats();
+
+ private:
+  // Pack buffered entries into frame_; false if there were none
+  bool BuildFrame();
+
+  // Copy buffer bytes from `position` into `out`, or `data` into the
+  // buffer at `position`, wrapping at its end
+  void CopyOut(size_t position, pw::ByteSpan out) const;
+  void CopyIn(size_t position, pw::ConstByteSpan data);
+
+  void Run();
+
+  socket::TcpSocket& socket_;
+  pw::ByteSpan buffer_;
+  pw::ByteSpan frame_;
+  const NetworkLogOptions options_;
+
+  pw::sync::InterruptSpinLock lock_;
+  size_t head_ = 0;                // Protected by lock_
+  size_t used_ = 0;                // Protected by lock_
+  uint32_t dropped_reported_ = 0;  // Protected by lock_
+  NetworkLogStats stats_;          // Protected by lock_
+  bool stop_ = false;              // Protected by lock_
+
+  // Drain thread only
+  size_t frame_used_ = 0;  // A built frame not sent yet, if non-zero
+  uint32_t sequence_ = 0;
+
+  pw::sync::TimedThreadNotification wake_;
+  pw::sync::ThreadNotification exited_;  // Released as Run() returns
+  pw::Thread thread_;
+  bool started_ = false;
+};
+
+/// NetworkLogSink with kBufferSize bytes of entry buffer and frames of up
+/// to kFrameSize bytes.
+template <size_t kBufferSize, size_t kFrameSize = 1024>
+class NetworkLogSinkWithBuffer : public NetworkLogSink {
+ public:
+  static_assert(kFrameSize > kNetworkLogFrameHeaderSize +
+                                 kNetworkLogEntryHeaderSize &&
+                kFrameSize <= 0xffff + kNetworkLogFrameHeaderSize);
+
+  explicit NetworkLogSinkWithBuffer(socket::TcpSocket& socket,
+                                    const NetworkLogOptions& options = {})
+      : NetworkLogSink(socket, buffer_storage_, frame_storage_, options) {}
+
+ private:
+  std::array<std::byte, kBufferSize> buffer_storage_;
+  std::array<std::byte, kFrameSize> frame_storage_;
+};
+
+/// Send what the pw_log_tokenized handler (//pb_log:network_log_handler)
+/// receives to `sink`; nullptr stops it. Set it before the sink's
+/// Start() and clear it before destroying the sink.
+void SetNetworkLogSink(NetworkLogSink* sink);
+
+/// Write to the sink set with SetNetworkLogSink(), if any.
+bool WriteNetworkLog(uint32_t metadata, pw::ConstByteSpan message);
+
+}  // namespace pb::log
@@ -0,0 +1,36 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Crash log in retained RAM: the last Device OS and assert messages before
+// a reset, for post-mortem retrieval (see pb_log/crash_log.h).
+
+#pragma once
+
+#include <string_view>
+
+#include "pw_function/function.h"
+
+namespace pb::log {
+
+using CrashLogVisitor = pw::Function<void(
+    int level, std::string_view category, std::string_view message)>;
+
+// Append a message. Safe from any thread; copies at most
+// config::kCrashLogMessageSize bytes of the message with interrupts
+// disabled. The first call after a reset attaches to the retained ring
+// and appends a "boot" entry, so the content reads as one block per boot.
+void RecordCrashLog(int level, std::string_view category,
+                    std::string_view message);
+
+// True if the ring held entries from before the last reset.
+bool CrashLogRestored();
+
+// Pass every entry to `visit`, oldest first. `visit` runs with interrupts
+// disabled: copy what you need (e.g. into an RPC response or a publish
+// buffer) and do not log or block.
+void ReadCrashLog(const CrashLogVisitor& visit);
+
+// Drop all entries, e.g. after they were published.
+void ClearCrashLog();
+
+}  // namespace pb::log
@@ -0,0 +1,72 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// CrashLog instance in Device OS retained RAM (.retained_user), guarded by
+// an interrupt spin lock so the log callback and assert handler can share
+// it.
+
+#include "pb_log/retained_crash_log.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+
+#include "pb_log/config.h"
+#include "pb_log/crash_log.h"
+#include "pw_sync/interrupt_spin_lock.h"
+
+namespace pb::log {
+namespace {
+
+using RetainedLog = CrashLog<config::kCrashLogSize, config::kMaxCategorySize,
+                             config::kCrashLogMessageSize>;
+
+// Same section as Device OS's `retained` keyword; not zeroed at startup
+__attribute__((section(".retained_user"))) RetainedLog g_crash_log;
+
+pw::sync::InterruptSpinLock g_lock;
+bool g_attached = false;
+bool g_restored = false;
+
+// Caller holds g_lock
+void AttachLocked() {
+  if (g_attached) {
+    return;
+  }
+  g_attached = true;
+  g_restored = g_crash_log.Attach();
+  g_crash_log.Append(0, "boot", "");
+}
+
+}  // namespace
+
+void RecordCrashLog(int level, std::string_view category,
+                    std::string_view message) {
+  const auto stored_level = static_cast<uint8_t>(std::clamp(level, 0, 255));
+  std::lock_guard lock(g_lock);
+  AttachLocked();
+  g_crash_log.Append(stored_level, category, message);
+}
+
+bool CrashLogRestored() {
+  std::lock_guard lock(g_lock);
+  AttachLocked();
+  return g_restored;
+}
+
+void ReadCrashLog(const CrashLogVisitor& visit) {
+  std::lock_guard lock(g_lock);
+  AttachLocked();
+  g_crash_log.ForEach([&visit](uint8_t level, std::string_view category,
+                               std::string_view message) {
+    visit(level, category, message);
+  });
+}
+
+void ClearCrashLog() {
+  std::lock_guard lock(g_lock);
+  g_attached = true;
+  g_crash_log.Clear();
+}
+
+}  // namespace pb::log
@@ -0,0 +1,189 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#define PW_LOG_MODULE_NAME "idle"
+
+#include "pb_power/idle.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+#include "pw_log/log.h"
+
+namespace pb::power {
+
+namespace {
+
+using pw::chrono::SystemClock;
+
+constexpr SleepMode kDeepestMode =
+#if PB_POWER_CONFIG_ULTRA_LOW_POWER
+    SleepMode::kUltraLowPower;
+#else
+    SleepMode::kStop;
+#endif
+
+SystemClock::time_point After(SystemClock::time_point now, uint32_t ms) {
+  return now + SystemClock::for_at_least(std::chrono::milliseconds(ms));
+}
+
+}  // namespace
+
+pw::Status SleepPlan::Add(const WakeupSource& source) {
+  if (source_count_ == sources_.size()) {
+    return pw::Status::ResourceExhausted();
+  }
+  sources_[source_count_++] = source;
+  return pw::OkStatus();
+}
+
+pw::Status SleepPlan::AddUartWakeup(uint16_t serial) {
+  LimitMode(SleepMode::kStop);
+  return Add({.type = WakeupSource::Type::kUart,
+              .id = serial,
+              .edge = PinEdge::kFalling});
+}
+
+pw::Status SleepPlan::AddPinWakeup(uint16_t pin, PinEdge edge) {
+  return Add({.type = WakeupSource::Type::kPin, .id = pin, .edge = edge});
+}
+
+pw::Status IdleManager::Register(IdleParticipant& participant) {
+  std::lock_guard lock(lock_);
+  if (participant_count_ == participants_.size()) {
+    PW_LOG_ERROR("More than %u idle participants",
+                 static_cast<unsigned>(participants_.size()));
+    return pw::Status::ResourceExhausted();
+  }
+  participants_[participant_count_++] = &participant;
+  return pw::OkStatus();
+}
+
+void IdleManager::Unregister(IdleParticipant& participant) {
+  std::lock_guard lock(lock_);
+  auto end = participants_.begin() + participant_count_;
+  auto it = std::find(participants_.begin(), end, &participant);
+  if (it == end) {
+    return;
+  }
+  // Keep the order: participants resume in reverse registration order
+  std::move(it + 1, end, it);
+  participants_[--participant_count_] = nullptr;
+}
+
+void IdleManager::ResumeParticipants(size_t count) {
+  while (count > 0) {
+    participants_[--count]->ResumeFromSleep();
+  }
+}
+
+IdleResult IdleManager::RunOnce() {
+  const SystemClock::time_point now = SystemClock::now();
+  if (wake_locks_.load(std::memory_order_acquire) > 0) {
+    std::lock_guard lock(lock_);
+    ++stats_.vetoed;
+    // Releasing the last wake lock notifies
+    return {IdleOutcome::kVetoed, SystemClock::time_point::max()};
+  }
+
+  pw::Result<SystemClock::time_point> next_timer =
+      backend_.NextTimerDeadline();
+  if (!next_timer.ok()) {
+    return {IdleOutcome::kUnsupported, SystemClock::time_point::max()};
+  }
+
+  std::lock_guard lock(lock_);
+  SleepPlan plan(std::min(*next_timer, After(now, config::kMaxSleepMs)),
+                 kDeepestMode);
+  size_t prepared = 0;
+  for (; prepared < participant_count_; ++prepared) {
+    if (!participants_[prepared]->PrepareForSleep(plan)) {
+      ResumeParticipants(prepared);
+      ++stats_.vetoed;
+      return {IdleOutcome::kVetoed, After(now, config::kRetryIntervalMs)};
+    }
+  }
+
+  // A participant's deadline may be closer than the timer's
+  if (plan.deadline() < After(now, config::kMinSleepMs)) {
+    ResumeParticipants(prepared);
+    ++stats_.too_short;
+    // Wait for the timer to fire; an overdue one is about to
+    return {IdleOutcome::kTooShort, std::max(plan.deadline(), After(now, 1))};
+  }
+
+  // A wake lock taken while the participants prepared, e.g. by a thread
+  // that ran in between, must still keep the device awake
+  if (wake_locks_.load(std::memory_order_acquire) > 0) {
+    ResumeParticipants(prepared);
+    ++stats_.vetoed;
+    return {IdleOutcome::kVetoed, SystemClock::time_point::max()};
+  }
+
+  const SystemClock::time_point sleep_start = SystemClock::now();
+  pw::Result<WakeupReason> reason = backend_.Sleep(plan);
+  const SystemClock::time_point sleep_end = SystemClock::now();
+  ResumeParticipants(prepared);
+
+  if (!reason.ok()) {
+    ++stats_.failed;
+    PW_LOG_WARN("Sleep rejected: %s", reason.status().str());
+    return {IdleOutcome::kFailed, After(sleep_end, config::kRetryIntervalMs)};
+  }
+  ++stats_.sleeps;
+  stats_.slept_ms += static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(sleep_end -
+                                                            sleep_start)
+          .count());
+  stats_.last_wakeup = *reason;
+  return {IdleOutcome::kSlept, sleep_end};
+}
+
+void IdleManager::Run() {
+  while (!stop_.load(std::memory_order_acquire)) {
+    const IdleResult result = RunOnce();
+    switch (result.outcome) {
+      case IdleOutcome::kSlept:
+        // Let the woken threads run first; this thread only runs again
+        // once they all block
+        continue;
+      case IdleOutcome::kUnsupported:
+        PW_LOG_WARN("Timer deadlines unavailable; low-power idle disabled");
+        return;
+      default:
+        break;
+    }
+    if (result.next_pass == SystemClock::time_point::max()) {
+      notification_.acquire();
+    } else {
+      (void)notification_.try_acquire_until(result.next_pass);
+    }
+  }
+}
+
+void IdleManager::Stop() {
+  stop_.store(true, std::memory_order_release);
+  notification_.release();
+}
+
+IdleStats IdleManager::stats() const {
+  std::lock_guard lock(lock_);
+  return stats_;
+}
+
+void WakeLock::Acquire() {
+  if (!held_.exchange(true, std::memory_order_acq_rel)) {
+    manager_.wake_locks_.fetch_add(1, std::memory_order_acq_rel);
+  }
+}
+
+void WakeLock::Release() {
+  if (held_.exchange(false, std::memory_order_acq_rel)) {
+    if (manager_.wake_locks_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      manager_.Notify();
+    }
+  }
+}
+
+}  // namespace pb::power
@@ -0,0 +1,182 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_power/idle.h"
+
+#include <chrono>
+
+#include "pw_unit_test/framework.h"
+
+namespace pb::power {
+namespace {
+
+using pw::chrono::SystemClock;
+using namespace std::chrono_literals;
+
+// Records the plan instead of sleeping
+class FakeSleepBackend : public SleepBackend {
+ public:
+  pw::Result<SystemClock::time_point> NextTimerDeadline() override {
+    return next_deadline;
+  }
+
+  pw::Result<WakeupReason> Sleep(const SleepPlan& plan) override {
+    ++sleeps;
+    deadline = plan.deadline();
+    mode = plan.mode();
+    source_count = plan.wakeup_sources().size();
+    if (!sleep_status.ok()) {
+      return sleep_status;
+    }
+    return WakeupReason::kDeadline;
+  }
+
+  pw::Result<SystemClock::time_point> next_deadline =
+      SystemClock::time_point::max();
+  pw::Status sleep_status;
+  int sleeps = 0;
+  SystemClock::time_point deadline;
+  SleepMode mode = SleepMode::kStop;
+  size_t source_count = 0;
+};
+
+class FakeParticipant : public IdleParticipant {
+ public:
+  bool PrepareForSleep(SleepPlan& plan) override {
+    ++prepared;
+    if (uart_wakeup) {
+      EXPECT_EQ(plan.AddUartWakeup(1), pw::OkStatus());
+    }
+    if (wake_lock != nullptr) {
+      wake_lock->Acquire();
+    }
+    return allow;
+  }
+
+  void ResumeFromSleep() override { ++resumed; }
+
+  bool allow = true;
+  bool uart_wakeup = false;
+  WakeLock* wake_lock = nullptr;  // Acquired while preparing
+  int prepared = 0;
+  int resumed = 0;
+};
+
+class IdleManagerTest : public ::testing::Test {
+ protected:
+  FakeSleepBackend backend_;
+  IdleManager manager_{backend_};
+  FakeParticipant first_;
+  FakeParticipant second_;
+};
+
+TEST_F(IdleManagerTest, SleepsUntilNextTimerDeadline) {
+  const SystemClock::time_point deadline = SystemClock::now() + 5s;
+  backend_.next_deadline = deadline;
+  ASSERT_EQ(manager_.Register(first_), pw::OkStatus());
+
+  const IdleResult result = manager_.RunOnce();
+  EXPECT_EQ(result.outcome, IdleOutcome::kSlept);
+  EXPECT_EQ(backend_.sleeps, 1);
+  EXPECT_TRUE(backend_.deadline == deadline);
+  EXPECT_EQ(first_.prepared, 1);
+  EXPECT_EQ(first_.resumed, 1);
+  EXPECT_EQ(manager_.stats().sleeps, 1u);
+  EXPECT_EQ(manager_.stats().last_wakeup, WakeupReason::kDeadline);
+}
+
+TEST_F(IdleManagerTest, NoTimerSleepsAtMostMaxSleep) {
+  const SystemClock::time_point before = SystemClock::now();
+  EXPECT_EQ(manager_.RunOnce().outcome, IdleOutcome::kSlept);
+  EXPECT_TRUE(backend_.deadline <=
+              SystemClock::now() + SystemClock::for_at_least(
+                                       std::chrono::milliseconds(
+                                           config::kMaxSleepMs)));
+  EXPECT_TRUE(backend_.deadline > before);
+}
+
+TEST_F(IdleManagerTest, VetoResumesEarlierParticipants) {
+  backend_.next_deadline = SystemClock::now() + 5s;
+  second_.allow = false;
+  ASSERT_EQ(manager_.Register(first_), pw::OkStatus());
+  ASSERT_EQ(manager_.Register(second_), pw::OkStatus());
+
+  EXPECT_EQ(manager_.RunOnce().outcome, IdleOutcome::kVetoed);
+  EXPECT_EQ(backend_.sleeps, 0);
+  EXPECT_EQ(first_.resumed, 1);
+  EXPECT_EQ(second_.resumed, 0);
+  EXPECT_EQ(manager_.stats().vetoed, 1u);
+
+  manager_.Unregister(second_);
+  EXPECT_EQ(manager_.RunOnce().outcome, IdleOutcome::kSlept);
+}
+
+TEST_F(IdleManagerTest, WakeLockKeepsDeviceAwake) {
+  backend_.next_deadline = SystemClock::now() + 5s;
+  WakeLock wake_lock(manager_);
+  wake_lock.Acquire();
+  wake_lock.Acquire();
+
+  const IdleResult result = manager_.RunOnce();
+  EXPECT_EQ(result.outcome, IdleOutcome::kVetoed);
+  EXPECT_TRUE(result.next_pass == SystemClock::time_point::max());
+
+  wake_lock.Release();
+  EXPECT_FALSE(wake_lock.held());
+  EXPECT_EQ(manager_.RunOnce().outcome, IdleOutcome::kSlept);
+}
+
+TEST_F(IdleManagerTest, WakeLockTakenWhilePreparingKeepsDeviceAwake) {
+  backend_.next_deadline = SystemClock::now() + 5s;
+  WakeLock wake_lock(manager_);
+  first_.wake_lock = &wake_lock;
+  ASSERT_EQ(manager_.Register(first_), pw::OkStatus());
+
+  const IdleResult result = manager_.RunOnce();
+  EXPECT_EQ(result.outcome, IdleOutcome::kVetoed);
+  EXPECT_TRUE(result.next_pass == SystemClock::time_point::max());
+  EXPECT_EQ(backend_.sleeps, 0);
+  EXPECT_EQ(first_.resumed, 1);
+  EXPECT_EQ(manager_.stats().vetoed, 1u);
+}
+
+TEST_F(IdleManagerTest, CloseDeadlineIsWaitedOutAwake) {
+  const SystemClock::time_point deadline = SystemClock::now() + 2ms;
+  backend_.next_deadline = deadline;
+  ASSERT_EQ(manager_.Register(first_), pw::OkStatus());
+
+  const IdleResult result = manager_.RunOnce();
+  EXPECT_EQ(result.outcome, IdleOutcome::kTooShort);
+  EXPECT_TRUE(result.next_pass >= deadline);
+  EXPECT_EQ(backend_.sleeps, 0);
+  EXPECT_EQ(first_.resumed, 1);
+}
+
+TEST_F(IdleManagerTest, UartWakeupLimitsModeToStop) {
+  backend_.next_deadline = SystemClock::now() + 5s;
+  first_.uart_wakeup = true;
+  ASSERT_EQ(manager_.Register(first_), pw::OkStatus());
+
+  EXPECT_EQ(manager_.RunOnce().outcome, IdleOutcome::kSlept);
+  EXPECT_EQ(backend_.mode, SleepMode::kStop);
+  EXPECT_EQ(backend_.source_count, 1u);
+}
+
+TEST_F(IdleManagerTest, RejectedSleepIsCounted) {
+  backend_.next_deadline = SystemClock::now() + 5s;
+  backend_.sleep_status = pw::Status::Unimplemented();
+  ASSERT_EQ(manager_.Register(first_), pw::OkStatus());
+
+  EXPECT_EQ(manager_.RunOnce().outcome, IdleOutcome::kFailed);
+  EXPECT_EQ(first_.resumed, 1);
+  EXPECT_EQ(manager_.stats().failed, 1u);
+}
+
+TEST_F(IdleManagerTest, InvisibleTimersDisableSleep) {
+  backend_.next_deadline = pw::Status::Unimplemented();
+  EXPECT_EQ(manager_.RunOnce().outcome, IdleOutcome::kUnsupported);
+  EXPECT_EQ(backend_.sleeps, 0);
+}
+
+}  // namespace
+}  // namespace pb::power
@@ -0,0 +1,194 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#define PW_LOG_MODULE_NAME "idle"
+
+#include "pb_power/particle_idle.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+
+#include "pw_chrono_particle/next_timer_deadline.h"
+#include "pw_log/log.h"
+#include "pw_thread/thread.h"
+#include "pw_thread_particle/options.h"
+#include "sleep_hal.h"
+#include "system_error.h"
+#include "system_network.h"
+#include "system_sleep.h"
+#include "usb_hal.h"
+
+namespace pb::power {
+
+namespace {
+
+using pw::chrono::SystemClock;
+
+hal_sleep_mode_t ToHal(SleepMode mode) {
+  switch (mode) {
+    case SleepMode::kUltraLowPower:
+      return HAL_SLEEP_MODE_ULTRA_LOW_POWER;
+    case SleepMode::kStop:
+    default:
+      return HAL_SLEEP_MODE_STOP;
+  }
+}
+
+InterruptMode ToHal(PinEdge edge) {
+  switch (edge) {
+    case PinEdge::kRising:
+      return RISING;
+    case PinEdge::kFalling:
+      return FALLING;
+    case PinEdge::kBoth:
+    default:
+      return CHANGE;
+  }
+}
+
+WakeupReason FromHal(const hal_wakeup_source_base_t* source) {
+  if (source == nullptr) {
+    return WakeupReason::kOther;
+  }
+  switch (source->type) {
+    case HAL_WAKEUP_SOURCE_TYPE_RTC:
+      return WakeupReason::kDeadline;
+    case HAL_WAKEUP_SOURCE_TYPE_USART:
+      return WakeupReason::kUart;
+    case HAL_WAKEUP_SOURCE_TYPE_GPIO:
+      return WakeupReason::kPin;
+    default:
+      return WakeupReason::kOther;
+  }
+}
+
+pw::Status FromSystemError(int error) {
+  switch (error) {
+    case SYSTEM_ERROR_NOT_SUPPORTED:
+      return pw::Status::Unimplemented();
+    case SYSTEM_ERROR_INVALID_ARGUMENT:
+      return pw::Status::InvalidArgument();
+    case SYSTEM_ERROR_INVALID_STATE:
+      return pw::Status::FailedPrecondition();
+    default:
+      return pw::Status::Internal();
+  }
+}
+
+// Keeps the device awake while sleeping would cut off USB or the network
+class SystemParticipant final : public IdleParticipant {
+ public:
+  bool PrepareForSleep(SleepPlan&) override {
+#if !PB_POWER_CONFIG_SLEEP_WITH_USB
+    if (HAL_USB_USART_Is_Connected(HAL_USB_USART_SERIAL)) {
+      return false;
+    }
+#endif  // !PB_POWER_CONFIG_SLEEP_WITH_USB
+#if !PB_POWER_CONFIG_SLEEP_WITH_NETWORK
+    if (network_is_on(NETWORK_INTERFACE_ALL, nullptr)) {
+      return false;
+    }
+#endif  // !PB_POWER_CONFIG_SLEEP_WITH_NETWORK
+    return true;
+  }
+};
+
+}  // namespace
+
+pw::Result<SystemClock::time_point> ParticleSleepBackend::NextTimerDeadline() {
+  return pw::chrono::particle::NextTimerDeadline();
+}
+
+pw::Result<WakeupReason> ParticleSleepBackend::Sleep(const SleepPlan& plan) {
+  // Chained wake-up sources: the plan's UARTs and pins, then the deadline
+  union Source {
+    hal_wakeup_source_base_t base;
+    hal_wakeup_source_usart_t usart;
+    hal_wakeup_source_gpio_t gpio;
+  };
+  std::array<Source, config::kMaxWakeupSources> sources{};
+  hal_wakeup_source_rtc_t rtc{};
+  hal_wakeup_source_base_t* head = nullptr;
+
+  if (plan.deadline() != SystemClock::time_point::max()) {
+    const int64_t ms = std::chrono::ceil<std::chrono::milliseconds>(
+                           plan.deadline() - SystemClock::now())
+                           .count();
+    rtc.base = {.size = sizeof(rtc),
+                .version = HAL_SLEEP_VERSION,
+                .type = HAL_WAKEUP_SOURCE_TYPE_RTC,
+                .next = head};
+    rtc.ms = static_cast<uint32_t>(std::max<int64_t>(ms, 1));
+    head = &rtc.base;
+  }
+
+  size_t count = 0;
+  for (const WakeupSource& source : plan.wakeup_sources()) {
+    Source& hal = sources[count++];
+    if (source.type == WakeupSource::Type::kUart) {
+      hal.usart.base = {.size = sizeof(hal.usart),
+                        .version = HAL_SLEEP_VERSION,
+                        .type = HAL_WAKEUP_SOURCE_TYPE_USART,
+                        .next = head};
+      hal.usart.serial = static_cast<hal_usart_interface_t>(source.id);
+    } else {
+      hal.gpio.base = {.size = sizeof(hal.gpio),
+                       .version = HAL_SLEEP_VERSION,
+                       .type = HAL_WAKEUP_SOURCE_TYPE_GPIO,
+                       .next = head};
+      hal.gpio.pin = static_cast<hal_pin_t>(source.id);
+      hal.gpio.mode = ToHal(source.edge);
+    }
+    head = &hal.base;
+  }
+
+  const hal_sleep_config_t sleep_config = {
+      .size = sizeof(hal_sleep_config_t),
+      .version = HAL_SLEEP_VERSION,
+      .mode = ToHal(plan.mode()),
+      .flags = HAL_SLEEP_FLAG_NONE,
+      .wakeup_sources = head,
+  };
+
+  // Device OS allocates the reported source; the caller frees it
+  hal_wakeup_source_base_t* woken_by = nullptr;
+  const int result = system_sleep_ext(&sleep_config, &woken_by, nullptr);
+  const WakeupReason reason = FromHal(woken_by);
+  free(woken_by);
+  if (result != SYSTEM_ERROR_NONE) {
+    return FromSystemError(result);
+  }
+  return reason;
+}
+
+IdleManager& DeviceIdleManager() {
+  static ParticleSleepBackend backend;
+  static SystemParticipant system_participant;
+  static IdleManager manager(backend);
+  static const bool registered = [] {
+    manager.Register(system_participant).IgnoreError();
+    return true;
+  }();
+  (void)registered;
+  return manager;
+}
+
+void StartIdleThread() {
+  static bool started = false;
+  if (started) {
+    return;
+  }
+  started = true;
+  IdleManager& manager = DeviceIdleManager();
+  pw::Thread(pw::thread::particle::Options()
+                 .set_name("power_idle")
+                 .set_priority(config::kIdleThreadPriority)
+                 .set_stack_size(config::kIdleThreadStackSize),
+             [&manager] { manager.Run(); })
+      .detach();
+  PW_LOG_INFO("Low-power idle started");
+}
+
+}  // namespace pb::power
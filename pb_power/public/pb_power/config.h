@@ -0,0 +1,70 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Configuration options for pb_power
+
+// Stack of the idle thread ("power_idle"). It asks the participants for a
+// plan and calls into Device OS to sleep; size it from a stack report
+// (pb_integration_tests/harness/stack_report.py).
+#ifndef PB_POWER_CONFIG_IDLE_STACK_SIZE
+#define PB_POWER_CONFIG_IDLE_STACK_SIZE 2048
+#endif
+
+// Shortest sleep worth entering. Entering and leaving STOP mode costs a
+// few milliseconds, so a closer deadline is waited out awake.
+#ifndef PB_POWER_CONFIG_MIN_SLEEP_MS
+#define PB_POWER_CONFIG_MIN_SLEEP_MS 20
+#endif
+
+// Longest single sleep, also when no timer is armed. Bounds the time a
+// wake-up source that was missed (or a watchdog that keeps counting) can
+// go unnoticed.
+#ifndef PB_POWER_CONFIG_MAX_SLEEP_MS
+#define PB_POWER_CONFIG_MAX_SLEEP_MS 60000
+#endif
+
+// Allow ULTRA_LOW_POWER when no participant limits the mode; 0 stops at
+// STOP mode.
+#ifndef PB_POWER_CONFIG_ULTRA_LOW_POWER
+#define PB_POWER_CONFIG_ULTRA_LOW_POWER 1
+#endif
+
+// Sleep while a USB host is attached. Off by default: the host powers the
+// device, and sleeping drops the USB serial (logs, pw_system RPC).
+#ifndef PB_POWER_CONFIG_SLEEP_WITH_USB
+#define PB_POWER_CONFIG_SLEEP_WITH_USB 0
+#endif
+
+// Sleep while the network interface is on. Off by default: Device OS
+// turns the network off for the sleep, and reconnecting costs more than
+// the sleep saves.
+#ifndef PB_POWER_CONFIG_SLEEP_WITH_NETWORK
+#define PB_POWER_CONFIG_SLEEP_WITH_NETWORK 0
+#endif
+
+namespace pb::power::config {
+
+// Participants one IdleManager consults.
+inline constexpr size_t kMaxParticipants = 8;
+
+// Wake-up sources (UARTs, pins) one sleep can have besides its deadline.
+inline constexpr size_t kMaxWakeupSources = 4;
+
+inline constexpr uint32_t kMinSleepMs = PB_POWER_CONFIG_MIN_SLEEP_MS;
+inline constexpr uint32_t kMaxSleepMs = PB_POWER_CONFIG_MAX_SLEEP_MS;
+
+// How long the idle thread waits before asking again after a participant
+// kept the device awake. Releasing a WakeLock asks again right away.
+inline constexpr uint32_t kRetryIntervalMs = 100;
+
+// Priority and stack of the idle thread ("power_idle"). The lowest
+// priority, so it only runs once every other thread blocks.
+inline constexpr int kIdleThreadPriority = 0;
+inline constexpr size_t kIdleThreadStackSize = PB_POWER_CONFIG_IDLE_STACK_SIZE;
+
+}  // namespace pb::power::config
@@ -0,0 +1,267 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Tickless low-power idle: sleep until the next timer deadline or wake-up
+// source once every thread and pw_async2 task is waiting
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "pb_power/config.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_result/result.h"
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+#include "pw_sync/mutex.h"
+#include "pw_sync/timed_thread_notification.h"
+
+namespace pb::power {
+
+/// Device OS sleep modes the idle manager may enter, shallowest first.
+/// Both keep RAM and resume where they stopped; HIBERNATE (a reset) is
+/// never entered.
+enum class SleepMode : uint8_t {
+  /// Clocks stopped, peripherals kept; all wake-up sources work.
+  kStop,
+  /// Like kStop with more of the chip powered down; fewer wake-up sources
+  /// (no UART wake-up on the P2).
+  kUltraLowPower,
+};
+
+/// Edge of a pin wake-up source.
+enum class PinEdge : uint8_t {
+  kRising,
+  kFalling,
+  kBoth,
+};
+
+/// What woke the device from its last sleep.
+enum class WakeupReason : uint8_t {
+  kNone,
+  /// The plan's deadline (RTC)
+  kDeadline,
+  kUart,
+  kPin,
+  /// Something Device OS did not report, e.g. an interrupt of its own
+  kOther,
+};
+
+/// A UART or pin that ends a sleep before its deadline.
+struct WakeupSource {
+  enum class Type : uint8_t { kUart, kPin };
+  Type type;
+  /// hal_usart_interface_t or hal_pin_t
+  uint16_t id;
+  PinEdge edge;
+};
+
+/// The sleep the idle manager is about to enter. Participants narrow it:
+/// an earlier deadline, a shallower mode, more wake-up sources.
+class SleepPlan {
+ public:
+  SleepPlan(pw::chrono::SystemClock::time_point deadline, SleepMode mode)
+      : deadline_(deadline), mode_(mode) {}
+
+  /// Latest time to wake up; time_point::max() has no deadline.
+  pw::chrono::SystemClock::time_point deadline() const { return deadline_; }
+  SleepMode mode() const { return mode_; }
+  pw::span<const WakeupSource> wakeup_sources() const {
+    return pw::span(sources_).first(source_count_);
+  }
+
+  /// Wakes up no later than `deadline`.
+  void WakeBy(pw::chrono::SystemClock::time_point deadline) {
+    deadline_ = std::min(deadline_, deadline);
+  }
+
+  /// Sleeps no deeper than `mode`.
+  void LimitMode(SleepMode mode) { mode_ = std::min(mode_, mode); }
+
+  /// Wakes up on RX activity of `serial` (hal_usart_interface_t). Limits
+  /// the mode to kStop, the only one with UART wake-up on the P2. The
+  /// byte that wakes the device is received.
+  /// @return OkStatus, or ResourceExhausted beyond kMaxWakeupSources
+  pw::Status AddUartWakeup(uint16_t serial);
+
+  /// Wakes up on `edge` of `pin` (hal_pin_t).
+  /// @return OkStatus, or ResourceExhausted beyond kMaxWakeupSources
+  pw::Status AddPinWakeup(uint16_t pin, PinEdge edge);
+
+ private:
+  pw::Status Add(const WakeupSource& source);
+
+  pw::chrono::SystemClock::time_point deadline_;
+  SleepMode mode_;
+  std::array<WakeupSource, config::kMaxWakeupSources> sources_{};
+  size_t source_count_ = 0;
+};
+
+/// A module with work that would be cut off by a sleep: a poller, a
+/// transfer in flight, a bus that must stay powered.
+class IdleParticipant {
+ public:
+  virtual ~IdleParticipant() = default;
+
+  /// Called on the idle thread before every sleep. Stop polling, add the
+  /// wake-up sources the module needs and return true, or return false to
+  /// keep the device awake this time.
+  virtual bool PrepareForSleep(SleepPlan& plan) = 0;
+
+  /// Called after the sleep (or after a later participant kept the device
+  /// awake) on every participant that returned true, in reverse order.
+  virtual void ResumeFromSleep() {}
+};
+
+/// Backend that knows the timers and enters the sleep.
+class SleepBackend {
+ public:
+  virtual ~SleepBackend() = default;
+
+  /// Earliest armed timer deadline, time_point::max() if none is armed.
+  /// Unimplemented if the timers can't be seen, in which case the idle
+  /// manager never sleeps.
+  virtual pw::Result<pw::chrono::SystemClock::time_point>
+  NextTimerDeadline() = 0;
+
+  /// Sleeps according to `plan` and returns once it ends.
+  /// @return What woke the device, or the error that kept it awake
+  virtual pw::Result<WakeupReason> Sleep(const SleepPlan& plan) = 0;
+};
+
+/// Outcome of one IdleManager::RunOnce() pass.
+enum class IdleOutcome : uint8_t {
+  kSlept,
+  /// A wake lock or participant kept the device awake
+  kVetoed,
+  /// The next deadline was closer than kMinSleepMs
+  kTooShort,
+  /// The backend rejected the sleep
+  kFailed,
+  /// The backend can't see the timers; sleeping is disabled
+  kUnsupported,
+};
+
+struct IdleResult {
+  IdleOutcome outcome;
+  /// Earliest time another pass can sleep; time_point::max() waits for
+  /// IdleManager::Notify()
+  pw::chrono::SystemClock::time_point next_pass;
+};
+
+struct IdleStats {
+  uint32_t sleeps = 0;
+  uint32_t vetoed = 0;
+  uint32_t too_short = 0;
+  uint32_t failed = 0;
+  /// Time spent asleep, as measured by SystemClock
+  uint64_t slept_ms = 0;
+  WakeupReason last_wakeup = WakeupReason::kNone;
+};
+
+/// Decides when the device may sleep, and how deeply.
+///
+/// The idle thread runs at the lowest priority, so it only gets the CPU
+/// once every other thread blocks - including the pw_async2 dispatcher
+/// thread, which blocks when every task is pending. Each pass then:
+///
+/// 1. stays awake while a WakeLock is held,
+/// 2. plans a sleep until the next timer deadline (capped at kMaxSleepMs),
+/// 3. lets every participant quiesce and narrow the plan, or veto it,
+/// 4. sleeps if the deadline is at least kMinSleepMs away,
+/// 5. resumes the participants.
+///
+/// pw_async2 timeouts (pw::async2::TimeProvider) and AsyncUart read
+/// deadlines are SystemTimers, so they end the sleep on time. A thread
+/// that waits with its own timeout (sleep_for, try_acquire_for) is not
+/// seen: it runs late by up to one sleep unless it holds a WakeLock or
+/// uses a SystemTimer.
+///
+/// Thread Safety: Register(), Unregister() and Notify() may be called from
+/// any thread; the participant callbacks run on the thread calling
+/// RunOnce(), with the participant list locked.
+class IdleManager {
+ public:
+  explicit IdleManager(SleepBackend& backend) : backend_(backend) {}
+
+  IdleManager(const IdleManager&) = delete;
+  IdleManager& operator=(const IdleManager&) = delete;
+
+  /// Consults `participant` before every sleep from now on. It must stay
+  /// alive until Unregister().
+  /// @return OkStatus, or ResourceExhausted beyond kMaxParticipants
+  pw::Status Register(IdleParticipant& participant);
+
+  /// Stops consulting `participant`; waits for a pass that uses it.
+  void Unregister(IdleParticipant& participant);
+
+  /// One idle pass. Called by the idle thread; tests call it directly.
+  IdleResult RunOnce();
+
+  /// Runs passes until Stop(), waiting between them as RunOnce() says.
+  /// The body of the idle thread.
+  void Run();
+
+  /// Ends Run() after the current pass.
+  void Stop();
+
+  /// Wakes the idle thread for a new pass, e.g. after a veto went away.
+  void Notify() { notification_.release(); }
+
+  IdleStats stats() const;
+
+ private:
+  friend class WakeLock;
+
+  // Resumes participants_[0..count) in reverse order. Must be called with
+  // lock_ held.
+  void ResumeParticipants(size_t count);
+
+  SleepBackend& backend_;
+  mutable pw::sync::Mutex lock_;
+  std::array<IdleParticipant*, config::kMaxParticipants> participants_{};
+  size_t participant_count_ = 0;
+  IdleStats stats_;  // Protected by lock_
+  std::atomic<uint32_t> wake_locks_{0};
+  std::atomic<bool> stop_{false};
+  pw::sync::TimedThreadNotification notification_;
+};
+
+/// Keeps the device awake while held, e.g. across a protocol exchange
+/// whose steps are timed by a thread rather than a SystemTimer.
+///
+/// @code
+///   pb::power::WakeLock wake_lock(pb::power::DeviceIdleManager());
+///
+///   wake_lock.Acquire();
+///   RunCalibration();
+///   wake_lock.Release();
+/// @endcode
+///
+/// Acquire() and Release() are atomic and may be called from any thread;
+/// one WakeLock is either held or not (acquiring twice holds it once).
+class WakeLock {
+ public:
+  explicit WakeLock(IdleManager& manager) : manager_(manager) {}
+  ~WakeLock() { Release(); }
+
+  WakeLock(const WakeLock&) = delete;
+  WakeLock& operator=(const WakeLock&) = delete;
+
+  void Acquire();
+
+  /// Releases the lock and lets the idle thread try again right away.
+  void Release();
+
+  bool held() const { return held_.load(std::memory_order_relaxed); }
+
+ private:
+  IdleManager& manager_;
+  std::atomic<bool> held_{false};
+};
+
+}  // namespace pb::power
@@ -0,0 +1,33 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Device OS sleep backend and idle thread for pb::power::IdleManager
+
+#pragma once
+
+#include "pb_power/idle.h"
+
+namespace pb::power {
+
+/// Enters STOP or ULTRA_LOW_POWER through system_sleep_ext() with an RTC
+/// wake-up at the plan's deadline. Timer deadlines come from
+/// pw::chrono::particle::NextTimerDeadline(), so the multiplexed
+/// system_timer backend is required.
+class ParticleSleepBackend final : public SleepBackend {
+ public:
+  pw::Result<pw::chrono::SystemClock::time_point> NextTimerDeadline()
+      override;
+  pw::Result<WakeupReason> Sleep(const SleepPlan& plan) override;
+};
+
+/// The device's idle manager. Keeps the device awake while a USB host is
+/// attached or the network is on (see PB_POWER_CONFIG_SLEEP_WITH_USB and
+/// PB_POWER_CONFIG_SLEEP_WITH_NETWORK).
+IdleManager& DeviceIdleManager();
+
+/// Starts the idle thread ("power_idle") running DeviceIdleManager().
+/// Until it is started, participants register but the device never
+/// sleeps. Calling it again does nothing.
+void StartIdleThread();
+
+}  // namespace pb::power
@@ -0,0 +1,47 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file ramfunc.h
+/// @brief Run hot functions from internal SRAM.
+///
+/// User-part code executes from external memory through a small cache, so
+/// a hot loop that shares the cache with other code keeps refetching.
+/// PB_RAMFUNC places a function in a .data.ramfunc.* input section: the
+/// user-part linker script collects it with .data, so the startup code
+/// copies it from flash into SRAM with the initialized data, and the
+/// two-pass link (rules/particle_firmware.bzl) sizes the SRAM region with
+/// it. The size report lists the bytes per library under "ramfunc".
+///
+/// @code
+///   PB_RAMFUNC void Permute(State& state) { ... }
+/// @endcode
+///
+/// Calls between SRAM and flash are out of direct branch range and go
+/// through linker veneers, a few cycles each; tag leaf functions and inner
+/// loops rather than their callers. Only functions are moved - constants
+/// they read stay in flash.
+///
+/// Builds with -DPB_RAMFUNC_ENABLED=0, and host builds, leave everything in
+/// flash, e.g. to measure the difference with a particle_benchmark.
+
+#include "pw_preprocessor/util.h"
+
+#ifndef PB_RAMFUNC_ENABLED
+#if defined(__arm__)
+#define PB_RAMFUNC_ENABLED 1
+#else
+#define PB_RAMFUNC_ENABLED 0
+#endif  // defined(__arm__)
+#endif  // PB_RAMFUNC_ENABLED
+
+#if PB_RAMFUNC_ENABLED
+// One section per function (by line) so --gc-sections can still drop
+// unused ones. noinline keeps the body where it was placed.
+#define PB_RAMFUNC                                                      \
+  __attribute__((section(".data.ramfunc." PW_STRINGIFY(__LINE__)),      \
+                 noinline))
+#else
+#define PB_RAMFUNC
+#endif  // PB_RAMFUNC_ENABLED
@@ -0,0 +1,200 @@
+# Copyright Offene Werkstatt Wädenswil
+# SPDX-License-Identifier: MIT
+
+"""ParticleTcpSocket benchmarks.
+
+Measures round-trip latency and sustained throughput of ParticleTcpSocket on
+P2 hardware against the host echo server, with and without staging buffers
+and through TcpSocketStreamAdapter + HDLC as used by pw_rpc. Uses the
+integration test firmware's RunBenchmark RPC.
+
+Results are printed as a table. When run under Bazel they are also written
+to benchmark_results.json in TEST_UNDECLARED_OUTPUTS_DIR so runs can be
+compared over time.
+
+Architecture:
+    Python Test → TcpEchoServer (on host)
+                       ↑
+    P2 Device → ParticleTcpSocket → TCP connection → host
+"""
+
+import asyncio
+import json
+import logging
+import os
+import sys
+import threading
+import time
+import unittest
+from pathlib import Path
+
+logging.basicConfig(
+    level=logging.INFO,
+    format='%(asctime)s %(name)s %(levelname)s: %(message)s',
+    stream=sys.stdout,
+    force=True,
+)
+
+from pb_integration_tests.harness import P2DeviceFixture, IntegrationTestHarness
+from tcp_echo_server import TcpEchoServerFixture
+
+import particle_tcp_socket_test_pb2
+from pw_log.proto import log_pb2
+
+_TEST_DIR = Path(__file__).parent
+FIRMWARE_BIN = _TEST_DIR / "particle_tcp_socket_test_firmware.bin.bin"
+FIRMWARE_ELF = _TEST_DIR / "particle_tcp_socket_test_firmware"
+
+_PAYLOAD_SIZES = [16, 128, 512, 1024]
+_ITERATIONS = 100
+
+_MODES = {
+    "round_trip": particle_tcp_socket_test_pb2.BENCHMARK_MODE_ROUND_TRIP,
+    "throughput": particle_tcp_socket_test_pb2.BENCHMARK_MODE_THROUGHPUT,
+    "hdlc": particle_tcp_socket_test_pb2.BENCHMARK_MODE_HDLC_ROUND_TRIP,
+}
+
+
+class ParticleTcpSocketBenchmark(unittest.TestCase):
+    """Socket benchmarks on P2 hardware."""
+
+    harness: IntegrationTestHarness
+    echo_server: TcpEchoServerFixture
+    device: P2DeviceFixture
+
+    _echo_loop: asyncio.AbstractEventLoop
+    _echo_thread: "threading.Thread"
+    _results: list[dict]
+
+    @classmethod
+    def setUpClass(cls):
+        cls.harness = IntegrationTestHarness()
+        cls._results = []
+
+        # Same fixed port as the functional tests (WSL2 port forwarding)
+        cls.echo_server = TcpEchoServerFixture(port=19283)
+        cls.harness.add_fixture("echo_server", cls.echo_server)
+
+        cls._echo_loop = asyncio.new_event_loop()
+        cls._echo_thread = threading.Thread(
+            target=cls._run_echo_server, daemon=True
+        )
+        cls._echo_thread.start()
+        for _ in range(50):
+            if cls.echo_server._server is not None:
+                break
+            time.sleep(0.1)
+        else:
+            raise RuntimeError("Echo server failed to start")
+
+        cls.device = P2DeviceFixture(
+            firmware_bin=FIRMWARE_BIN,
+            firmware_elf=FIRMWARE_ELF,
+            proto_paths=[particle_tcp_socket_test_pb2, log_pb2],
+        )
+        cls.harness.add_fixture("device", cls.device)
+        asyncio.run(cls.device.start())
+
+        response = cls.device.rpc.rpcs.maco.test.socket.TestControl.WaitForCloud(
+            timeout_ms=60000,
+            pw_rpc_timeout_s=65.0,
+        )
+        if not response.response.connected:
+            raise RuntimeError("Device failed to connect to cloud within 60 seconds")
+
+    @classmethod
+    def _run_echo_server(cls):
+        asyncio.set_event_loop(cls._echo_loop)
+        cls._echo_loop.run_until_complete(cls.echo_server.start())
+        cls._echo_loop.run_forever()
+
+    @classmethod
+    def tearDownClass(cls):
+        cls._print_results()
+        cls._write_results()
+        asyncio.run(cls.device.stop())
+        cls._echo_loop.call_soon_threadsafe(cls._echo_loop.stop)
+        cls._echo_thread.join(timeout=5.0)
+
+    def _run(self, mode: str, payload_size: int, buffered: bool) -> None:
+        response = self.device.rpc.rpcs.maco.test.socket.TestControl.RunBenchmark(
+            host=self.echo_server.host,
+            port=self.echo_server.port,
+            mode=_MODES[mode],
+            payload_size=payload_size,
+            iterations=_ITERATIONS,
+            buffered=buffered,
+            pw_rpc_timeout_s=60.0,
+        )
+        result = response.response
+        self.assertTrue(
+            result.success,
+            f"{mode} size={payload_size} buffered={buffered}: {result.error}",
+        )
+        self._results.append({
+            "mode": mode,
+            "payload_size": payload_size,
+            "buffered": buffered,
+            "iterations": result.iterations,
+            "elapsed_us": result.elapsed_us,
+            "throughput_bytes_per_s": result.throughput_bytes_per_s,
+            "latency_us": {
+                "min": result.latency_min_us,
+                "p50": result.latency_p50_us,
+                "p90": result.latency_p90_us,
+                "p99": result.latency_p99_us,
+                "max": result.latency_max_us,
+            },
+            "worker": {
+                "queue_depth_peak": result.worker_queue_depth_peak,
+                "queue_wait_max_us": result.worker_queue_wait_max_us,
+                "exec_max_us": result.worker_exec_max_us,
+                "send_eagain_retries": result.worker_send_eagain_retries,
+            },
+        })
+
+    def test_round_trip_latency(self):
+        for size in _PAYLOAD_SIZES:
+            for buffered in (False, True):
+                with self.subTest(size=size, buffered=buffered):
+                    self._run("round_trip", size, buffered)
+
+    def test_throughput(self):
+        for size in _PAYLOAD_SIZES:
+            for buffered in (False, True):
+                with self.subTest(size=size, buffered=buffered):
+                    self._run("throughput", size, buffered)
+
+    def test_hdlc_round_trip_latency(self):
+        for size in _PAYLOAD_SIZES:
+            for buffered in (False, True):
+                with self.subTest(size=size, buffered=buffered):
+                    self._run("hdlc", size, buffered)
+
+    @classmethod
+    def _print_results(cls):
+        print("\n=== ParticleTcpSocket benchmark ===", flush=True)
+        print(f"{'mode':<11} {'size':>5} {'buf':>4} {'B/s':>9} "
+              f"{'p50 us':>8} {'p90 us':>8} {'p99 us':>8} {'max us':>8} "
+              f"{'qpeak':>5} {'exec us':>8}")
+        for r in cls._results:
+            lat = r["latency_us"]
+            print(f"{r['mode']:<11} {r['payload_size']:>5} "
+                  f"{'yes' if r['buffered'] else 'no':>4} "
+                  f"{r['throughput_bytes_per_s']:>9} {lat['p50']:>8} "
+                  f"{lat['p90']:>8} {lat['p99']:>8} {lat['max']:>8} "
+                  f"{r['worker']['queue_depth_peak']:>5} "
+                  f"{r['worker']['exec_max_us']:>8}")
+
+    @classmethod
+    def _write_results(cls):
+        out_dir = os.environ.get("TEST_UNDECLARED_OUTPUTS_DIR")
+        if not out_dir:
+            return
+        path = Path(out_dir) / "benchmark_results.json"
+        path.write_text(json.dumps(cls._results, indent=2))
+        print(f"Results written to {path}", flush=True)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -8,14 +8,21 @@
 
 #include "particle_tcp_socket_test.rpc.pb.h"
 
+#include <algorithm>
+#include <array>
 #include <cstring>
+#include <memory>
 
 #include "concurrent_hal.h"
 #include "pb_integration_tests/firmware/test_system.h"
 #include "pb_socket/particle_tcp_socket.h"
+#include "pb_socket/tcp_socket_stream_adapter.h"
+#include "pw_hdlc/decoder.h"
+#include "pw_hdlc/encoder.h"
 #include "pw_log/log.h"
 #include "pw_rpc/nanopb/server_reader_writer.h"
 #include "pw_sync/binary_semaphore.h"
+#include "timer_hal.h"
 
 namespace {
 
@@ -46,6 +53,69 @@ maco_test_socket_TcpState ToProtoState(pb::socket::TcpState state) {
   return maco_test_socket_TcpState_TCP_STATE_DISCONNECTED;
 }
 
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+constexpr size_t kMaxBenchmarkPayload = 1024;
+constexpr size_t kMaxBenchmarkIterations = 256;
+constexpr uint32_t kThroughputWindow = 4;  // Payloads in flight
+constexpr uint64_t kHdlcAddress = 1;
+
+// Shared by all benchmark runs (RPCs are handled one at a time)
+std::array<std::byte, kMaxBenchmarkPayload> g_bench_tx;
+std::array<std::byte, kMaxBenchmarkPayload> g_bench_rx;
+std::array<uint32_t, kMaxBenchmarkIterations> g_bench_latency_us;
+pw::hdlc::DecoderBuffer<kMaxBenchmarkPayload + 16> g_bench_decoder;
+
+// Reads until `dest` is full. Each Read() waits up to the socket's read
+// timeout, so a lost echo ends the benchmark instead of hanging it.
+pw::Status ReadFull(pb::socket::TcpSocket& socket, pw::ByteSpan dest) {
+  size_t received = 0;
+  while (received < dest.size()) {
+    pw::StatusWithSize result = socket.Read(dest.subspan(received));
+    if (!result.ok()) {
+      return result.status();
+    }
+    if (result.size() == 0) {
+      return pw::Status::DeadlineExceeded();
+    }
+    received += result.size();
+  }
+  return pw::OkStatus();
+}
+
+// Reads from `stream` until the decoder completes a frame, and copies its
+// payload to `dest`.
+pw::Status ReadHdlcFrame(pb::socket::TcpSocketStreamAdapter& stream,
+                         pw::ByteSpan dest) {
+  std::array<std::byte, 64> chunk;
+  while (true) {
+    pw::Result<pw::ByteSpan> read = stream.Read(chunk);
+    if (!read.ok()) {
+      return read.status();
+    }
+    if (read->empty()) {
+      return pw::Status::DeadlineExceeded();
+    }
+    for (std::byte b : *read) {
+      pw::Result<pw::hdlc::Frame> frame = g_bench_decoder.Process(b);
+      if (frame.status().IsUnavailable()) {
+        continue;  // Frame not complete yet
+      }
+      if (!frame.ok()) {
+        return frame.status();
+      }
+      if (frame->data().size() != dest.size()) {
+        return pw::Status::DataLoss();
+      }
+      // The echo of one frame never contains the start of the next one
+      std::copy(frame->data().begin(), frame->data().end(), dest.begin());
+      return pw::OkStatus();
+    }
+  }
+}
+
 class TestControlServiceImpl
     : public svc::TestControl::Service<TestControlServiceImpl> {
  public:
@@ -395,6 +465,141 @@ class TestControlServiceImpl
 
     return pw::OkStatus();
   }
+
+  pw::Status RunBenchmark(const maco_test_socket_BenchmarkRequest& request,
+                          maco_test_socket_BenchmarkResponse& response) {
+    PW_LOG_INFO("RunBenchmark: mode=%d size=%u n=%u buffered=%d",
+                static_cast<int>(request.mode),
+                static_cast<unsigned>(request.payload_size),
+                static_cast<unsigned>(request.iterations), request.buffered);
+
+    response = maco_test_socket_BenchmarkResponse{};
+    if (request.payload_size == 0 ||
+        request.payload_size > kMaxBenchmarkPayload ||
+        request.iterations == 0 ||
+        request.iterations > kMaxBenchmarkIterations) {
+      std::strncpy(response.error, "Invalid payload size or iterations",
+                   sizeof(response.error) - 1);
+      return pw::OkStatus();
+    }
+
+    pb::socket::TcpConfig config{
+        .host = request.host,
+        .port = static_cast<uint16_t>(request.port),
+        .connect_timeout_ms = 10000,
+        .read_timeout_ms = 5000,
+    };
+    std::unique_ptr<pb::socket::ParticleTcpSocket> socket;
+    if (request.buffered) {
+      socket = std::make_unique<
+          pb::socket::ParticleTcpSocketWithBuffers<1460, 512>>(config);
+    } else {
+      socket = std::make_unique<pb::socket::ParticleTcpSocket>(config);
+    }
+    if (!socket->Connect().ok()) {
+      std::snprintf(response.error, sizeof(response.error),
+                    "Connect failed: %d", socket->last_error());
+      return pw::OkStatus();
+    }
+
+    const size_t size = request.payload_size;
+    const pw::ConstByteSpan payload(g_bench_tx.data(), size);
+    const pw::ByteSpan echo(g_bench_rx.data(), size);
+    for (size_t i = 0; i < size; ++i) {
+      g_bench_tx[i] = static_cast<std::byte>(i * 7 + 1);
+    }
+
+    pb::socket::TcpSocketStreamAdapter stream(*socket);
+    g_bench_decoder.Clear();
+    const bool throughput =
+        request.mode == maco_test_socket_BenchmarkMode_BENCHMARK_MODE_THROUGHPUT;
+
+    pw::Status status;
+    uint32_t done = 0;
+    pb::socket::ParticleTcpSocket::ResetWorkerStats();
+    const uint32_t start_us = HAL_Timer_Get_Micro_Seconds();
+    if (throughput) {
+      uint32_t sent = 0;
+      while (status.ok() && done < request.iterations) {
+        if (sent < request.iterations && sent - done < kThroughputWindow) {
+          status = socket->Write(payload);
+          ++sent;
+          continue;
+        }
+        status = ReadFull(*socket, echo);
+        if (status.ok()) {
+          ++done;
+        }
+      }
+    } else {
+      const bool hdlc =
+          request.mode ==
+          maco_test_socket_BenchmarkMode_BENCHMARK_MODE_HDLC_ROUND_TRIP;
+      while (status.ok() && done < request.iterations) {
+        const uint32_t sent_us = HAL_Timer_Get_Micro_Seconds();
+        if (hdlc) {
+          status = pw::hdlc::WriteUIFrame(kHdlcAddress, payload, stream);
+          if (status.ok()) {
+            status = ReadHdlcFrame(stream, echo);
+          }
+        } else {
+          status = socket->Write(payload);
+          if (status.ok()) {
+            status = ReadFull(*socket, echo);
+          }
+        }
+        if (status.ok() && !std::equal(echo.begin(), echo.end(),
+                                       payload.begin())) {
+          status = pw::Status::DataLoss();
+        }
+        if (status.ok()) {
+          g_bench_latency_us[done++] = HAL_Timer_Get_Micro_Seconds() - sent_us;
+        }
+      }
+    }
+    const uint32_t elapsed_us = HAL_Timer_Get_Micro_Seconds() - start_us;
+    const pb::socket::SocketWorkerStats worker =
+        pb::socket::ParticleTcpSocket::WorkerStats();
+    socket->Disconnect();
+
+    response.iterations = done;
+    response.total_bytes = static_cast<uint32_t>(done * size);
+    response.elapsed_us = elapsed_us;
+    if (elapsed_us > 0) {
+      response.throughput_bytes_per_s = static_cast<uint32_t>(
+          uint64_t{response.total_bytes} * 1000000 / elapsed_us);
+    }
+    response.worker_queue_depth_peak = worker.queue_depth_peak;
+    response.worker_queue_wait_max_us = worker.queue_wait_max_us;
+    response.worker_exec_max_us = worker.exec_max_us;
+    response.worker_send_eagain_retries = worker.send_eagain_retries;
+    if (!throughput && done > 0) {
+      uint32_t* latencies = g_bench_latency_us.data();
+      std::sort(latencies, latencies + done);
+      const auto percentile = [&](uint32_t p) {
+        return latencies[std::min<uint32_t>(done - 1, done * p / 100)];
+      };
+      response.latency_min_us = latencies[0];
+      response.latency_p50_us = percentile(50);
+      response.latency_p90_us = percentile(90);
+      response.latency_p99_us = percentile(99);
+      response.latency_max_us = latencies[done - 1];
+    }
+
+    if (!status.ok()) {
+      std::snprintf(response.error, sizeof(response.error),
+                    "Failed after %u payloads: %s (errno %d)",
+                    static_cast<unsigned>(done), status.str(),
+                    socket->last_error());
+      return pw::OkStatus();
+    }
+    response.success = true;
+    PW_LOG_INFO("RunBenchmark: %u B/s, p50=%u us, p99=%u us",
+                static_cast<unsigned>(response.throughput_bytes_per_s),
+                static_cast<unsigned>(response.latency_p50_us),
+                static_cast<unsigned>(response.latency_p99_us));
+    return pw::OkStatus();
+  }
 };
 
 void TestInit() {
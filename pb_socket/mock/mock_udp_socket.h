@@ -0,0 +1,108 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file mock_udp_socket.h
+/// @brief Mock UDP socket for host testing.
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "pb_socket/udp_socket.h"
+
+namespace pb::socket {
+
+/// Mock UDP socket for testing.
+///
+/// Returns pre-loaded datagrams from RecvFrom() and captures sent datagrams
+/// for verification.
+///
+/// Usage:
+/// @code
+///   MockUdpSocket mock;
+///   mock.Open();
+///   mock.EnqueueDatagram({.addr = 0x0100007f, .port = 5001},
+///                        pw::bytes::Array<0x01, 0x02>());
+///
+///   // Use mock with code under test
+///
+///   auto sent = mock.PopSentDatagrams();
+/// @endcode
+class MockUdpSocket : public UdpSocket {
+ public:
+  struct Datagram {
+    UdpEndpoint endpoint;  // Destination of sent, source of received ones
+    std::vector<std::byte> data;
+  };
+
+  MockUdpSocket() = default;
+
+  // UdpSocket interface
+  pw::Status Open() override {
+    if (open_) {
+      return pw::Status::FailedPrecondition();
+    }
+    open_ = true;
+    return pw::OkStatus();
+  }
+
+  void Close() override { open_ = false; }
+
+  bool IsOpen() const override { return open_; }
+
+  int last_error() const override { return 0; }
+
+  UdpEndpoint peer() const override { return peer_; }
+
+  pw::Status SendTo(const UdpEndpoint& to, pw::ConstByteSpan data) override {
+    if (!open_) {
+      return pw::Status::FailedPrecondition();
+    }
+    sent_.push_back({to, std::vector<std::byte>(data.begin(), data.end())});
+    return pw::OkStatus();
+  }
+
+  pw::StatusWithSize RecvFrom(pw::ByteSpan dest, UdpEndpoint* from) override {
+    if (!open_) {
+      return pw::StatusWithSize::FailedPrecondition();
+    }
+    if (received_.empty()) {
+      return pw::StatusWithSize(0);  // No datagram available
+    }
+
+    // Like a real socket, the part that doesn't fit is dropped
+    const Datagram& front = received_.front();
+    const size_t to_copy = std::min(dest.size(), front.data.size());
+    std::copy(front.data.begin(), front.data.begin() + to_copy, dest.begin());
+    if (from != nullptr) {
+      *from = front.endpoint;
+    }
+    received_.pop_front();
+    return pw::StatusWithSize(to_copy);
+  }
+
+  // Mock configuration
+  void set_peer(const UdpEndpoint& peer) { peer_ = peer; }
+
+  /// Enqueue a datagram to be returned by RecvFrom().
+  void EnqueueDatagram(const UdpEndpoint& from, pw::ConstByteSpan data) {
+    received_.push_back({from, std::vector<std::byte>(data.begin(), data.end())});
+  }
+
+  /// Get datagrams sent via SendTo()/SendBatch() and clear them.
+  std::vector<Datagram> PopSentDatagrams() {
+    std::vector<Datagram> result;
+    std::swap(result, sent_);
+    return result;
+  }
+
+ private:
+  bool open_ = false;
+  UdpEndpoint peer_;
+  std::deque<Datagram> received_;
+  std::vector<Datagram> sent_;
+};
+
+}  // namespace pb::socket
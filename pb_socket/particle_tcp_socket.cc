@@ -5,16 +5,32 @@
 
 #include "pb_socket/particle_tcp_socket.h"
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <cerrno>
+#include <chrono>
+#include <cstdint>
 #include <cstring>
+#include <mutex>
+#include <utility>
 
 #include "concurrent_hal.h"
 #include "inet_hal_posix.h"
 #include "netdb_hal.h"
+#include "pb_socket/config.h"
+#include "pb_socket/particle_tcp_listener.h"
+#include "pb_socket/particle_udp_socket.h"
+#include "pw_assert/check.h"
+#include "pw_chrono/system_clock.h"
 #include "pw_log/log.h"
-#include "pw_sync/binary_semaphore.h"
+#include "pw_metric/metric.h"
+#include "pw_status/try.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/timed_thread_notification.h"
 #include "socket_hal_posix.h"
+#include "system_network.h"
+#include "timer_hal.h"
 
 namespace pb::socket {
 namespace {
@@ -27,545 +43,2147 @@ namespace {
 // between the calling thread (e.g., pw_rpc handlers) and Particle's system
 // thread. Both compete for LwIP's lock_tcpip_core mutex.
 
-enum class SocketOp {
-  kConnect,
-  kDisconnect,
-  kSend,
-  kRecv,
+using internal::BlockingRequest;
+using internal::SocketBuffers;
+using internal::SocketOp;
+using internal::SocketRequest;
+
+/// Counters behind ParticleTcpSocket::WorkerStats(). Only the socket thread
+/// updates them.
+struct WorkerCounters {
+  PW_METRIC_GROUP(group, "socket_worker");
+  PW_METRIC(group, requests, "requests", 0u);
+  PW_METRIC(group, queue_depth_peak, "queue_depth_peak", 0u);
+  PW_METRIC(group, queue_wait_max_us, "queue_wait_max_us", 0u);
+  PW_METRIC(group, queue_wait_lt_100us, "queue_wait_lt_100us", 0u);
+  PW_METRIC(group, queue_wait_lt_1ms, "queue_wait_lt_1ms", 0u);
+  PW_METRIC(group, queue_wait_lt_10ms, "queue_wait_lt_10ms", 0u);
+  PW_METRIC(group, queue_wait_lt_100ms, "queue_wait_lt_100ms", 0u);
+  PW_METRIC(group, queue_wait_lt_1s, "queue_wait_lt_1s", 0u);
+  PW_METRIC(group, queue_wait_ge_1s, "queue_wait_ge_1s", 0u);
+  PW_METRIC(group, exec_max_us, "exec_max_us", 0u);
+  PW_METRIC(group, exec_lt_100us, "exec_lt_100us", 0u);
+  PW_METRIC(group, exec_lt_1ms, "exec_lt_1ms", 0u);
+  PW_METRIC(group, exec_lt_10ms, "exec_lt_10ms", 0u);
+  PW_METRIC(group, exec_lt_100ms, "exec_lt_100ms", 0u);
+  PW_METRIC(group, exec_lt_1s, "exec_lt_1s", 0u);
+  PW_METRIC(group, exec_ge_1s, "exec_ge_1s", 0u);
+  PW_METRIC(group, connects, "connects", 0u);
+  PW_METRIC(group, disconnects, "disconnects", 0u);
+  PW_METRIC(group, sends, "sends", 0u);
+  PW_METRIC(group, recvs, "recvs", 0u);
+  PW_METRIC(group, flushes, "flushes", 0u);
+  PW_METRIC(group, listens, "listens", 0u);
+  PW_METRIC(group, accepts, "accepts", 0u);
+  PW_METRIC(group, udp_opens, "udp_opens", 0u);
+  PW_METRIC(group, send_tos, "send_tos", 0u);
+  PW_METRIC(group, recv_froms, "recv_froms", 0u);
+  PW_METRIC(group, send_eagain_retries, "send_eagain_retries", 0u);
+  PW_METRIC(group, bytes_sent, "bytes_sent", 0u);
+  PW_METRIC(group, bytes_received, "bytes_received", 0u);
+
+  using Histogram =
+      std::array<pw::metric::TypedMetric<uint32_t>*, kSocketLatencyBuckets>;
+  Histogram queue_wait{&queue_wait_lt_100us, &queue_wait_lt_1ms,
+                       &queue_wait_lt_10ms,  &queue_wait_lt_100ms,
+                       &queue_wait_lt_1s,    &queue_wait_ge_1s};
+  Histogram exec{&exec_lt_100us, &exec_lt_1ms, &exec_lt_10ms,
+                 &exec_lt_100ms, &exec_lt_1s,  &exec_ge_1s};
+
+  pw::metric::TypedMetric<uint32_t>& OpCount(SocketOp op) {
+    switch (op) {
+      case SocketOp::kConnect:
+        return connects;
+      case SocketOp::kDisconnect:
+        return disconnects;
+      case SocketOp::kSend:
+        return sends;
+      case SocketOp::kRecv:
+        return recvs;
+      case SocketOp::kFlush:
+        return flushes;
+      case SocketOp::kListen:
+        return listens;
+      case SocketOp::kAccept:
+        return accepts;
+      case SocketOp::kUdpOpen:
+        return udp_opens;
+      case SocketOp::kSendTo:
+        return send_tos;
+      case SocketOp::kRecvFrom:
+        return recv_froms;
+    }
+    return requests;  // Unreachable
+  }
+};
+
+WorkerCounters g_counters;
+
+uint32_t NowMicros() {
+  return static_cast<uint32_t>(HAL_Timer_Get_Micro_Seconds());
+}
+
+/// Counts `us` in its histogram bucket and tracks the maximum.
+void RecordLatency(WorkerCounters::Histogram& histogram,
+                   pw::metric::TypedMetric<uint32_t>& max,
+                   uint32_t us) {
+  constexpr std::array<uint32_t, kSocketLatencyBuckets - 1> kBounds = {
+      100, 1000, 10000, 100000, 1000000};
+  size_t bucket = 0;
+  while (bucket < kBounds.size() && us >= kBounds[bucket]) {
+    ++bucket;
+  }
+  histogram[bucket]->Increment();
+  if (us > max.value()) {
+    max.Set(us);
+  }
+}
+
+// Signals the caller that the socket thread is done with `req`. The request
+// must not be touched afterwards; its owner may already be gone.
+void Complete(SocketRequest& req) {
+  if (req.future != nullptr) {
+    req.future->OnRequestDone();
+  } else if (req.done != nullptr) {
+    req.done->release();
+  }
+}
+
+/// FIFO of requests for a worker thread, linked through SocketRequest::next.
+/// Any thread may push; only the worker pops. Pushing never blocks or fails
+/// and the lock is only held for a few pointer updates, so handing over a
+/// request costs one notification instead of a copy into a kernel queue.
+class RequestQueue {
+ public:
+  void Push(SocketRequest* req) {
+    req->next = nullptr;
+    req->queued_at_us = NowMicros();
+    {
+      std::lock_guard lock(lock_);
+      if (tail_ == nullptr) {
+        head_ = req;
+      } else {
+        tail_->next = req;
+      }
+      tail_ = req;
+      ++depth_;
+    }
+    ready_.release();
+  }
+
+  /// Returns the oldest request, waiting up to `timeout_ms` for one
+  /// (CONCURRENT_WAIT_FOREVER: indefinitely). Returns nullptr on timeout.
+  /// `depth`, if given, is set to the number of requests queued before this
+  /// one was taken.
+  SocketRequest* Pop(system_tick_t timeout_ms, size_t* depth = nullptr) {
+    while (true) {
+      {
+        std::lock_guard lock(lock_);
+        if (SocketRequest* req = head_; req != nullptr) {
+          head_ = req->next;
+          if (head_ == nullptr) {
+            tail_ = nullptr;
+          }
+          if (depth != nullptr) {
+            *depth = depth_;
+          }
+          --depth_;
+          return req;
+        }
+      }
+      // The notification may be left over from a request already popped;
+      // the loop then rechecks the list.
+      if (timeout_ms == CONCURRENT_WAIT_FOREVER) {
+        ready_.acquire();
+      } else if (!ready_.try_acquire_for(pw::chrono::SystemClock::for_at_least(
+                     std::chrono::milliseconds(timeout_ms)))) {
+        return nullptr;
+      }
+    }
+  }
+
+  size_t depth() const {
+    std::lock_guard lock(lock_);
+    return depth_;
+  }
+
+ private:
+  mutable pw::sync::InterruptSpinLock lock_;
+  SocketRequest* head_ = nullptr;  // Protected by lock_
+  SocketRequest* tail_ = nullptr;  // Protected by lock_
+  size_t depth_ = 0;               // Protected by lock_
+  pw::sync::TimedThreadNotification ready_;
+};
+
+// Requests for the socket thread
+RequestQueue g_socket_queue;
+os_thread_t g_socket_thread = nullptr;
+std::atomic<bool> g_socket_thread_started{false};
+std::atomic<bool> g_socket_thread_init_in_progress{false};
+
+// Reads waiting for data to arrive (ReadAsync(), or Read() with a read
+// timeout) and accepts waiting for a connection. Only touched by the socket
+// thread, in the order they arrived.
+std::array<SocketRequest*, config::kMaxParkedReads> g_parked_reads{};
+size_t g_parked_count = 0;
+
+/// Receives into `req` without blocking, filling its buffers in order.
+/// Returns false if no data was available; the EAGAIN result is recorded in
+/// `req` all the same.
+bool RecvNow(SocketRequest& req) {
+  pw::ByteSpan single(static_cast<std::byte*>(req.recv_buffer), req.recv_size);
+  pw::span<const pw::ByteSpan> chunks =
+      req.recv_chunks.empty() ? pw::span<const pw::ByteSpan>(&single, 1)
+                              : req.recv_chunks;
+
+  size_t total = 0;
+  for (pw::ByteSpan chunk : chunks) {
+    // Use MSG_DONTWAIT to avoid blocking on the LwIP lock.
+    ssize_t received =
+        sock_recv(req.socket_fd, chunk.data(), chunk.size(), MSG_DONTWAIT);
+    if (received > 0) {
+      g_counters.bytes_received.Increment(static_cast<uint32_t>(received));
+      total += static_cast<size_t>(received);
+      if (static_cast<size_t>(received) < chunk.size()) {
+        break;
+      }
+      continue;
+    }
+    if (total > 0) {
+      // Report what we got; the next read sees the close or error
+      break;
+    }
+
+    if (received < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        req.result = -1;
+        req.error_code = errno;
+        req.last_error = errno;
+        return false;
+      }
+      req.error_code = errno;
+      req.result = -1;
+      req.last_error = errno;
+      req.state = TcpState::kError;
+    } else {
+      // Connection closed by peer
+      req.result = 0;
+      req.error_code = 0;
+      req.state = TcpState::kDisconnected;
+    }
+    return true;
+  }
+
+  req.result = static_cast<ssize_t>(total);
+  req.error_code = 0;
+  return true;
+}
+
+/// Parks a read until its socket becomes readable. Returns false if all
+/// slots are taken; the caller then completes the read with EAGAIN.
+bool ParkRead(SocketRequest* req) {
+  if (g_parked_count == g_parked_reads.size()) {
+    return false;
+  }
+  req->deadline_ms = HAL_Timer_Get_Milli_Seconds() + req->read_timeout_ms;
+  g_parked_reads[g_parked_count++] = req;
+  return true;
+}
+
+// Connected buffered sockets. The socket thread fills their RX rings ahead
+// of reads and sends their batched writes once due. Only touched by the
+// socket thread.
+std::array<SocketBuffers*, config::kMaxBufferedSockets> g_buffered{};
+size_t g_buffered_count = 0;
+
+// NextBatchFlushMs() result if no batch is waiting for its delay.
+constexpr uint32_t kNoBatchFlush = UINT32_MAX;
+
+/// Resets the staging buffers for a new connection and registers the socket
+/// for read-ahead and batched writes.
+void StartBuffering(SocketBuffers& buffers, int fd) {
+  {
+    std::lock_guard lock(buffers.lock);
+    buffers.rx_head = 0;
+    buffers.rx_count = 0;
+    buffers.tx_used = 0;
+    buffers.tx_error = 0;
+  }
+  buffers.fd = fd;
+  buffers.rx_eof = false;
+  if (g_buffered_count == g_buffered.size()) {
+    // Still works, but reads aren't served from the ring and batches are
+    // only sent by size, Flush() or an oversized write
+    PW_LOG_WARN("SocketThread: no buffered socket slot for fd=%d", fd);
+    return;
+  }
+  g_buffered[g_buffered_count++] = &buffers;
+}
+
+void StopBuffering(int fd) {
+  size_t kept = 0;
+  for (size_t i = 0; i < g_buffered_count; ++i) {
+    if (g_buffered[i]->fd != fd) {
+      g_buffered[kept++] = g_buffered[i];
+    }
+  }
+  g_buffered_count = kept;
+}
+
+bool HasParkedRead(int fd) {
+  for (size_t i = 0; i < g_parked_count; ++i) {
+    if (g_parked_reads[i]->socket_fd == fd) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/// A parked read takes the data directly, so the ring is only filled while
+/// nobody waits on the socket.
+bool WantsReadAhead(SocketBuffers& buffers) {
+  if (buffers.rx.empty() || buffers.rx_eof || HasParkedRead(buffers.fd)) {
+    return false;
+  }
+  std::lock_guard lock(buffers.lock);
+  return buffers.rx_count < buffers.rx.size();
+}
+
+/// Receives whatever is available into the free part of the RX ring.
+void ReadAhead(SocketBuffers& buffers) {
+  size_t tail = 0;
+  size_t space = 0;
+  {
+    std::lock_guard lock(buffers.lock);
+    const size_t size = buffers.rx.size();
+    tail = (buffers.rx_head + buffers.rx_count) % size;
+    space = std::min(size - buffers.rx_count, size - tail);
+  }
+  if (space == 0) {
+    return;
+  }
+
+  // Only the socket thread writes the free region, so no lock is needed
+  ssize_t received = sock_recv(buffers.fd, buffers.rx.data() + tail, space,
+                               MSG_DONTWAIT);
+  if (received > 0) {
+    g_counters.bytes_received.Increment(static_cast<uint32_t>(received));
+    std::lock_guard lock(buffers.lock);
+    buffers.rx_count += static_cast<size_t>(received);
+    return;
+  }
+  if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+    return;
+  }
+  // Peer closed or error: stop reading ahead and let the next direct read
+  // report it once the ring has been drained
+  buffers.rx_eof = true;
+}
+
+/// Completes the parked reads on `fd` and stops reading ahead before the
+/// socket is closed.
+void ForgetSocket(int fd) {
+  StopBuffering(fd);
+  size_t kept = 0;
+  for (size_t i = 0; i < g_parked_count; ++i) {
+    SocketRequest* req = g_parked_reads[i];
+    if (req->socket_fd != fd) {
+      g_parked_reads[kept++] = req;
+      continue;
+    }
+    req->result = -1;
+    req->error_code = ENOTCONN;
+    req->last_error = ENOTCONN;
+    req->state = TcpState::kDisconnected;
+    Complete(*req);
+  }
+  g_parked_count = kept;
+}
+
+/// Accepts a connection on the listening socket of `req` without blocking
+/// and hands it to the accepting socket's buffers. Returns false if no
+/// connection was pending; the EAGAIN result is recorded in `req` all the
+/// same.
+bool AcceptNow(SocketRequest& req) {
+  const int fd = sock_accept(req.socket_fd, nullptr, nullptr);
+  if (fd < 0) {
+    const int err = errno;
+    req.result = -1;
+    req.error_code = err;
+    req.last_error = err;
+    return err != EAGAIN && err != EWOULDBLOCK;
+  }
+
+  // Same socket options as a connected socket, which is blocking
+  int flag = 1;
+  sock_setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &flag, sizeof(flag));
+  const int flags = sock_fcntl(fd, F_GETFL, 0);
+  sock_fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+
+  if (req.buffers != nullptr) {
+    StartBuffering(*req.buffers, fd);
+  }
+  req.result = fd;
+  req.error_code = 0;
+  req.last_error = 0;
+  req.state = TcpState::kConnected;
+  PW_LOG_INFO("Accepted connection (fd=%d)", fd);
+  return true;
+}
+
+/// Receives one datagram into `req` without blocking. Returns false if none
+/// was queued; the EAGAIN result is recorded in `req` all the same.
+bool RecvFromNow(SocketRequest& req) {
+  struct sockaddr_in from;
+  socklen_t from_len = sizeof(from);
+  std::memset(&from, 0, sizeof(from));
+  const ssize_t received =
+      sock_recvfrom(req.socket_fd, req.recv_buffer, req.recv_size,
+                    MSG_DONTWAIT, reinterpret_cast<struct sockaddr*>(&from),
+                    &from_len);
+  if (received < 0) {
+    const int err = errno;
+    req.result = -1;
+    req.error_code = err;
+    req.last_error = err;
+    return err != EAGAIN && err != EWOULDBLOCK;
+  }
+  // 0 is an empty datagram, not a closed connection
+  g_counters.bytes_received.Increment(static_cast<uint32_t>(received));
+  req.result = received;
+  req.error_code = 0;
+  if (req.from != nullptr) {
+    req.from->addr = from.sin_addr.s_addr;
+    req.from->port = inet_ntohs(from.sin_port);
+  }
+  return true;
+}
+
+/// Retries a parked request once its socket is readable. Returns true if it
+/// is done.
+bool RetryParked(SocketRequest& req) {
+  switch (req.op) {
+    case SocketOp::kAccept:
+      return AcceptNow(req);
+    case SocketOp::kRecvFrom:
+      return RecvFromNow(req);
+    default:
+      return RecvNow(req);
+  }
+}
+
+/// True if PollSockets() has something to wait for.
+bool HasSocketsToPoll() {
+  if (g_parked_count > 0) {
+    return true;
+  }
+  for (size_t i = 0; i < g_buffered_count; ++i) {
+    if (WantsReadAhead(*g_buffered[i])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/// Waits up to `timeout_ms` for any parked or read-ahead socket to become
+/// readable. Then completes the parked reads that got data, hit an error or
+/// passed their deadline, and fills the RX rings of readable buffered
+/// sockets.
+void PollSockets(int timeout_ms) {
+  std::array<struct pollfd,
+             config::kMaxParkedReads + config::kMaxBufferedSockets>
+      pfds;
+  std::array<SocketBuffers*, config::kMaxBufferedSockets> ahead;
+  const size_t parked = g_parked_count;
+  size_t ahead_count = 0;
+  for (size_t i = 0; i < parked; ++i) {
+    pfds[i].fd = g_parked_reads[i]->socket_fd;
+  }
+  for (size_t i = 0; i < g_buffered_count; ++i) {
+    if (WantsReadAhead(*g_buffered[i])) {
+      pfds[parked + ahead_count].fd = g_buffered[i]->fd;
+      ahead[ahead_count++] = g_buffered[i];
+    }
+  }
+  const size_t count = parked + ahead_count;
+  if (count == 0) {
+    return;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    pfds[i].events = POLLIN;
+    pfds[i].revents = 0;
+  }
+
+  int ret = sock_poll(pfds.data(), count, timeout_ms);
+  if (ret < 0) {
+    // Probe every socket directly so a bad descriptor still completes
+    PW_LOG_WARN("SocketThread: sock_poll failed: %d", errno);
+  }
+  const uint32_t now = HAL_Timer_Get_Milli_Seconds();
+
+  size_t kept = 0;
+  for (size_t i = 0; i < parked; ++i) {
+    SocketRequest* req = g_parked_reads[i];
+    const bool accept = req->op == SocketOp::kAccept;
+    bool done = (ret < 0 || pfds[i].revents != 0) && RetryParked(*req);
+    if (!done && req->read_timeout_ms > 0 &&
+        static_cast<int32_t>(now - req->deadline_ms) >= 0) {
+      // Timed out: reads report 0 bytes, like a non-blocking read
+      req->result = -1;
+      req->error_code = accept ? ETIMEDOUT : EAGAIN;
+      done = true;
+    }
+    if (done) {
+      Complete(*req);
+    } else {
+      g_parked_reads[kept++] = req;
+    }
+  }
+  g_parked_count = kept;
+
+  for (size_t i = 0; i < ahead_count; ++i) {
+    if (ret < 0 || pfds[parked + i].revents != 0) {
+      ReadAhead(*ahead[i]);
+    }
+  }
+}
+
+#ifdef MSG_MORE
+constexpr int kMoreFlag = MSG_MORE;
+#else
+constexpr int kMoreFlag = 0;
+#endif  // MSG_MORE
+
+/// Sends `size` bytes, waiting for the socket to become writable as needed.
+/// `flags` are added to MSG_DONTWAIT. Returns 0 or the errno of the failure.
+int SendAll(int fd, const void* data, size_t size, int flags = 0) {
+  // Loop to handle partial writes. sock_send with MSG_DONTWAIT may
+  // only send part of the data if the send buffer is full. We poll
+  // for writability and retry to ensure the entire payload is sent,
+  // which is critical for HDLC frame integrity.
+  const auto* data_ptr = static_cast<const uint8_t*>(data);
+  size_t remaining = size;
+
+  while (remaining > 0) {
+    ssize_t sent = sock_send(fd, data_ptr, remaining, MSG_DONTWAIT | flags);
+
+    if (sent > 0) {
+      g_counters.bytes_sent.Increment(static_cast<uint32_t>(sent));
+      data_ptr += sent;
+      remaining -= static_cast<size_t>(sent);
+      continue;
+    }
+
+    if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      // Send buffer full — wait for writability then retry
+      g_counters.send_eagain_retries.Increment();
+      struct pollfd pfd;
+      pfd.fd = fd;
+      pfd.events = POLLOUT;
+      pfd.revents = 0;
+      int poll_ret = sock_poll(&pfd, 1, 5000);
+      if (poll_ret <= 0) {
+        return (poll_ret == 0) ? ETIMEDOUT : errno;
+      }
+      continue;
+    }
+
+    // Real send error
+    return errno;
+  }
+  return 0;
+}
+
+/// Sends the WriteV() chunks of `req`, or its single buffer. Returns 0 or
+/// the errno of the failure.
+int SendRequestData(const SocketRequest& req) {
+  if (req.send_chunks.empty()) {
+    return SendAll(req.socket_fd, req.send_data, req.send_size);
+  }
+  for (size_t i = 0; i < req.send_chunks.size(); ++i) {
+    // Tell LwIP more data follows so chunks can share a segment
+    const int flags = (i + 1 < req.send_chunks.size()) ? kMoreFlag : 0;
+    const pw::ConstByteSpan chunk = req.send_chunks[i];
+    if (int error = SendAll(req.socket_fd, chunk.data(), chunk.size(), flags);
+        error != 0) {
+      return error;
+    }
+  }
+  return 0;
+}
+
+/// Sends the bytes staged in the TX buffer. Callers keep appending behind
+/// the bytes being sent. Returns 0 or the errno of the failure.
+int SendStagedTx(SocketBuffers& buffers, int fd) {
+  while (true) {
+    size_t staged = 0;
+    {
+      std::lock_guard lock(buffers.lock);
+      staged = buffers.tx_used;
+    }
+    if (staged == 0) {
+      return 0;
+    }
+    // Callers only append past tx_used, so the staged bytes are stable
+    int error = SendAll(fd, buffers.tx.data(), staged);
+    std::lock_guard lock(buffers.lock);
+    if (error != 0) {
+      buffers.tx_used = 0;
+      return error;
+    }
+    std::memmove(buffers.tx.data(), buffers.tx.data() + staged,
+                 buffers.tx_used - staged);
+    buffers.tx_used -= staged;
+  }
+}
+
+/// Sends staged bytes until none are left, then clears tx_flush_queued.
+/// The caller has set tx_flush_queued so no other flush runs concurrently.
+void FlushStaged(SocketBuffers& buffers, int fd) {
+  while (true) {
+    int error = SendStagedTx(buffers, fd);
+    std::lock_guard lock(buffers.lock);
+    if (error != 0) {
+      PW_LOG_WARN("SocketThread: staged send failed: %d", error);
+      buffers.tx_error = error;
+    }
+    if (error != 0 || buffers.tx_used == 0) {
+      buffers.tx_flush_queued = false;
+      return;
+    }
+  }
+}
+
+/// Milliseconds until the next batch is due, or kNoBatchFlush.
+uint32_t NextBatchFlushMs(uint32_t now) {
+  uint32_t next = kNoBatchFlush;
+  for (size_t i = 0; i < g_buffered_count; ++i) {
+    SocketBuffers& buffers = *g_buffered[i];
+    std::lock_guard lock(buffers.lock);
+    if (buffers.tx_used == 0 || buffers.tx_flush_queued ||
+        buffers.tx_batch_delay_ms == 0) {
+      continue;
+    }
+    const uint32_t age = now - buffers.tx_staged_at_ms;
+    const uint32_t due =
+        age >= buffers.tx_batch_delay_ms ? 0 : buffers.tx_batch_delay_ms - age;
+    next = std::min(next, due);
+  }
+  return next;
+}
+
+/// Sends the batches whose delay has passed.
+void FlushDueBatches(uint32_t now) {
+  for (size_t i = 0; i < g_buffered_count; ++i) {
+    SocketBuffers& buffers = *g_buffered[i];
+    {
+      std::lock_guard lock(buffers.lock);
+      if (buffers.tx_used == 0 || buffers.tx_flush_queued ||
+          buffers.tx_batch_delay_ms == 0 ||
+          now - buffers.tx_staged_at_ms < buffers.tx_batch_delay_ms) {
+        continue;
+      }
+      // Keeps callers from queueing tx_request while we send
+      buffers.tx_flush_queued = true;
+    }
+    FlushStaged(buffers, buffers.fd);
+  }
+}
+
+// ============================================================================
+// DNS cache and resolver thread
+// ============================================================================
+//
+// netdb_getaddrinfo() blocks for up to the DNS timeout. Lookups run on their
+// own thread so they don't stall the socket worker, and results are cached
+// so reconnects to the same host skip resolution. LwIP does not report
+// record TTLs, so entries live for config::kDnsCacheTtlMs, and an entry is
+// dropped early when connecting to its address fails.
+
+class DnsCache {
+ public:
+  bool Lookup(const char* host, uint32_t& addr) {
+    std::lock_guard lock(lock_);
+    const uint32_t now = HAL_Timer_Get_Milli_Seconds();
+    for (Entry& entry : entries_) {
+      if (entry.valid && std::strcmp(entry.host, host) == 0) {
+        if (static_cast<int32_t>(now - entry.expires_ms) >= 0) {
+          entry.valid = false;
+          return false;
+        }
+        addr = entry.addr;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void Insert(const char* host, uint32_t addr) {
+    if (std::strlen(host) >= config::kDnsMaxHostLength) {
+      return;  // Not cached, resolved on every connect
+    }
+    std::lock_guard lock(lock_);
+    // Reuse the host's entry or a free one, else evict the oldest
+    Entry* slot = &entries_[0];
+    for (Entry& entry : entries_) {
+      if (entry.valid && std::strcmp(entry.host, host) == 0) {
+        slot = &entry;
+        break;
+      }
+      if (!entry.valid) {
+        slot = &entry;
+      } else if (slot->valid && static_cast<int32_t>(entry.expires_ms -
+                                                     slot->expires_ms) < 0) {
+        slot = &entry;
+      }
+    }
+    std::strcpy(slot->host, host);
+    slot->addr = addr;
+    slot->expires_ms = HAL_Timer_Get_Milli_Seconds() + config::kDnsCacheTtlMs;
+    slot->valid = true;
+  }
+
+  void Invalidate(const char* host) {
+    std::lock_guard lock(lock_);
+    for (Entry& entry : entries_) {
+      if (entry.valid && std::strcmp(entry.host, host) == 0) {
+        entry.valid = false;
+      }
+    }
+  }
+
+  void Clear() {
+    std::lock_guard lock(lock_);
+    for (Entry& entry : entries_) {
+      entry.valid = false;
+    }
+  }
+
+ private:
+  struct Entry {
+    char host[config::kDnsMaxHostLength];
+    uint32_t addr;  // Network byte order
+    uint32_t expires_ms;
+    bool valid;
+  };
+
+  pw::sync::Mutex lock_;
+  std::array<Entry, config::kDnsCacheSize> entries_{};
 };
 
-struct SocketRequest {
-  SocketOp op;
+DnsCache g_dns_cache;
+
+// Connect requests waiting for name resolution
+RequestQueue g_resolver_queue;
+os_thread_t g_resolver_thread = nullptr;
+bool g_resolver_started = false;  // Set before the socket thread starts
+
+/// Resolves `host` to an IPv4 address in network byte order. Returns 0 or
+/// the netdb error.
+int ResolveHost(const char* host, uint32_t& addr) {
+  struct addrinfo hints;
+  struct addrinfo* result = nullptr;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+
+  int err = netdb_getaddrinfo(host, nullptr, &hints, &result);
+  if (err != 0 || result == nullptr) {
+    PW_LOG_ERROR("getaddrinfo failed: %d", err);
+    return err != 0 ? err : EAI_FAIL;
+  }
+  auto* sin = reinterpret_cast<struct sockaddr_in*>(result->ai_addr);
+  addr = sin->sin_addr.s_addr;
+  netdb_freeaddrinfo(result);
+  return 0;
+}
+
+void FailResolve(SocketRequest& req, int err) {
+  req.error_code = err;
+  req.result = -1;
+  req.state = TcpState::kError;
+  req.last_error = err;
+  Complete(req);
+}
+
+/// Passes a connect request to the resolver thread. Returns false if the
+/// resolver isn't running.
+bool HandToResolver(SocketRequest* req) {
+  if (!g_resolver_started) {
+    return false;
+  }
+  g_resolver_queue.Push(req);
+  return true;
+}
+
+void ResolverThreadMain(void* /*arg*/) {
+  while (true) {
+    SocketRequest* req = g_resolver_queue.Pop(CONCURRENT_WAIT_FOREVER);
+
+    PW_LOG_DEBUG("Resolver: looking up %s", req->host);
+    uint32_t addr = 0;
+    if (int err = ResolveHost(req->host, addr); err != 0) {
+      FailResolve(*req, err);
+      continue;
+    }
+    g_dns_cache.Insert(req->host, addr);
+
+    // Back to the socket thread to actually connect
+    req->resolved_addr = addr;
+    req->addr_resolved = true;
+    g_socket_queue.Push(req);
+  }
+}
+
+/// Resolves req->host for a connect or UDP open. Returns false if the
+/// request went to the resolver thread, which queues it back here once
+/// resolved, or if resolution failed and the request has been completed.
+bool ResolveRequestHost(SocketRequest* req, uint32_t& addr) {
+  if (req->addr_resolved) {
+    addr = req->resolved_addr;
+    return true;
+  }
+  struct in_addr numeric;
+  if (inet_inet_pton(AF_INET, req->host, &numeric) == 1) {
+    addr = numeric.s_addr;
+    return true;
+  }
+  if (g_dns_cache.Lookup(req->host, addr)) {
+    return true;
+  }
+  if (HandToResolver(req)) {
+    return false;
+  }
+  // Resolver unavailable: resolve here
+  if (int err = ResolveHost(req->host, addr); err != 0) {
+    FailResolve(*req, err);
+    return false;
+  }
+  g_dns_cache.Insert(req->host, addr);
+  return true;
+}
+
+void HandleRequest(SocketRequest* req) {
+  switch (req->op) {
+    case SocketOp::kConnect: {
+      PW_LOG_DEBUG("SocketThread: Connect to %s:%u", req->host, req->port);
+
+      // Close existing socket if any
+      if (req->socket_fd >= 0) {
+        ForgetSocket(req->socket_fd);
+        sock_close(req->socket_fd);
+        req->socket_fd = -1;
+      }
+
+      // Resolve address. Hostnames missing from the DNS cache go to the
+      // resolver thread, which queues the request back here once resolved,
+      // so other sockets keep flowing during a slow lookup.
+      uint32_t addr = 0;
+      if (!ResolveRequestHost(req, addr)) {
+        break;
+      }
+      struct sockaddr_in server_addr;
+      std::memset(&server_addr, 0, sizeof(server_addr));
+      server_addr.sin_family = AF_INET;
+      server_addr.sin_port = inet_htons(req->port);
+      server_addr.sin_addr.s_addr = addr;
+
+      // Create socket
+      req->socket_fd = sock_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+      if (req->socket_fd < 0) {
+        req->error_code = errno;
+        req->result = -1;
+        req->state = TcpState::kError;
+        req->last_error = req->error_code;
+        PW_LOG_ERROR("sock_socket failed: %d", req->error_code);
+        Complete(*req);
+        break;
+      }
+
+      // Set keepalive
+      int flag = 1;
+      sock_setsockopt(req->socket_fd, SOL_SOCKET, SO_KEEPALIVE, &flag,
+                      sizeof(flag));
+
+      // Set read timeout if specified
+      if (req->read_timeout_ms > 0) {
+        struct timeval tv;
+        tv.tv_sec = req->read_timeout_ms / 1000;
+        tv.tv_usec = (req->read_timeout_ms % 1000) * 1000;
+        sock_setsockopt(req->socket_fd, SOL_SOCKET, SO_RCVTIMEO, &tv,
+                        sizeof(tv));
+      }
+
+      // Non-blocking connect with timeout
+      int flags = sock_fcntl(req->socket_fd, F_GETFL, 0);
+      sock_fcntl(req->socket_fd, F_SETFL, flags | O_NONBLOCK);
+
+      int ret = sock_connect(
+          req->socket_fd, reinterpret_cast<struct sockaddr*>(&server_addr),
+          sizeof(server_addr));
+
+      if (ret < 0 && errno != EINPROGRESS) {
+        req->error_code = errno;
+        req->result = -1;
+        sock_close(req->socket_fd);
+        req->socket_fd = -1;
+        req->state = TcpState::kError;
+        req->last_error = req->error_code;
+        PW_LOG_ERROR("sock_connect failed: %d", req->error_code);
+        g_dns_cache.Invalidate(req->host);
+        Complete(*req);
+        break;
+      }
+
+      // Poll for connection
+      struct pollfd pfd;
+      pfd.fd = req->socket_fd;
+      pfd.events = POLLOUT;
+      pfd.revents = 0;
+
+      ret = sock_poll(&pfd, 1, static_cast<int>(req->connect_timeout_ms));
+      if (ret <= 0) {
+        req->error_code = (ret == 0) ? ETIMEDOUT : errno;
+        req->result = -1;
+        sock_close(req->socket_fd);
+        req->socket_fd = -1;
+        req->state = TcpState::kError;
+        req->last_error = req->error_code;
+        PW_LOG_ERROR("sock_poll timeout/error: %d", req->error_code);
+        g_dns_cache.Invalidate(req->host);
+        Complete(*req);
+        break;
+      }
+
+      // Check socket error
+      int socket_error = 0;
+      socklen_t len = sizeof(socket_error);
+      sock_getsockopt(req->socket_fd, SOL_SOCKET, SO_ERROR, &socket_error,
+                      &len);
+      if (socket_error != 0) {
+        req->error_code = socket_error;
+        req->result = -1;
+        sock_close(req->socket_fd);
+        req->socket_fd = -1;
+        req->state = TcpState::kError;
+        req->last_error = socket_error;
+        PW_LOG_ERROR("Connection error: %d", socket_error);
+        g_dns_cache.Invalidate(req->host);
+        Complete(*req);
+        break;
+      }
+
+      // Restore blocking mode
+      sock_fcntl(req->socket_fd, F_SETFL, flags);
+
+      if (req->buffers != nullptr) {
+        StartBuffering(*req->buffers, req->socket_fd);
+      }
+
+      req->state = TcpState::kConnected;
+      req->last_error = 0;
+      req->result = 0;
+      req->error_code = 0;
+      PW_LOG_INFO("Connected to %s:%u (fd=%d)", req->host, req->port,
+                  req->socket_fd);
+      Complete(*req);
+      break;
+    }
+
+    case SocketOp::kDisconnect: {
+      PW_LOG_DEBUG("SocketThread: Disconnect (fd=%d)", req->socket_fd);
+      if (req->socket_fd >= 0) {
+        ForgetSocket(req->socket_fd);
+        if (req->buffers != nullptr) {
+          // Best effort: staged bytes were announced as written
+          (void)SendStagedTx(*req->buffers, req->socket_fd);
+        }
+        sock_shutdown(req->socket_fd, SHUT_RDWR);
+        sock_close(req->socket_fd);
+        req->socket_fd = -1;
+      }
+      req->state = TcpState::kDisconnected;
+      req->last_error = 0;
+      req->result = 0;
+      req->error_code = 0;
+      Complete(*req);
+      break;
+    }
+
+    case SocketOp::kSend: {
+      PW_LOG_DEBUG("SocketThread: Send %zu bytes (fd=%d)", req->send_size,
+                   req->socket_fd);
+      if (req->state != TcpState::kConnected || req->socket_fd < 0) {
+        req->result = -1;
+        req->error_code = ENOTCONN;
+        req->last_error = ENOTCONN;
+        PW_LOG_WARN("SocketThread: Send failed - not connected");
+        Complete(*req);
+        break;
+      }
+
+      // Staged bytes were written earlier and must go out first
+      int error = 0;
+      if (req->buffers != nullptr) {
+        error = SendStagedTx(*req->buffers, req->socket_fd);
+      }
+      if (error == 0) {
+        error = SendRequestData(*req);
+      }
+
+      if (error != 0) {
+        req->error_code = error;
+        req->result = -1;
+        req->last_error = error;
+        req->state = TcpState::kError;
+      } else {
+        req->result = static_cast<ssize_t>(req->send_size);
+        req->error_code = 0;
+      }
+      Complete(*req);
+      break;
+    }
+
+    case SocketOp::kRecv: {
+      PW_LOG_DEBUG("SocketThread: Recv up to %zu bytes (fd=%d)", req->recv_size,
+                   req->socket_fd);
+      if (req->state != TcpState::kConnected || req->socket_fd < 0) {
+        req->result = -1;
+        req->error_code = ENOTCONN;
+        req->last_error = ENOTCONN;
+        PW_LOG_WARN("SocketThread: Recv failed - not connected");
+        Complete(*req);
+        break;
+      }
+
+      // Bytes read ahead precede anything still in the socket
+      if (req->buffers != nullptr) {
+        const size_t copied =
+            req->recv_chunks.empty()
+                ? req->buffers->ReadRx(pw::ByteSpan(
+                      static_cast<std::byte*>(req->recv_buffer),
+                      req->recv_size))
+                : req->buffers->ReadRx(req->recv_chunks);
+        if (copied > 0) {
+          req->result = static_cast<ssize_t>(copied);
+          req->error_code = 0;
+          Complete(*req);
+          break;
+        }
+      }
+
+      // Reads that wait for data complete from PollSockets() once the
+      // socket is readable. Others return EAGAIN and let the caller retry.
+      if (!RecvNow(*req) && req->wait_for_data && ParkRead(req)) {
+        break;
+      }
+      Complete(*req);
+      break;
+    }
+
+    case SocketOp::kFlush: {
+      // Owned by the socket and reused as soon as tx_flush_queued is
+      // cleared, so it is never completed or touched afterwards.
+      FlushStaged(*req->buffers, req->socket_fd);
+      break;
+    }
+
+    case SocketOp::kListen: {
+      PW_LOG_DEBUG("SocketThread: Listen on port %u", req->port);
+      const int fd = sock_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+      if (fd < 0) {
+        req->error_code = errno;
+        req->result = -1;
+        req->last_error = req->error_code;
+        PW_LOG_ERROR("sock_socket failed: %d", req->error_code);
+        Complete(*req);
+        break;
+      }
+
+      // Allow restarting the server while old connections are in TIME_WAIT
+      int flag = 1;
+      sock_setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(flag));
+
+      struct sockaddr_in local_addr;
+      std::memset(&local_addr, 0, sizeof(local_addr));
+      local_addr.sin_family = AF_INET;
+      local_addr.sin_port = inet_htons(req->port);
+      local_addr.sin_addr.s_addr = inet_htonl(INADDR_ANY);
+
+      if (sock_bind(fd, reinterpret_cast<struct sockaddr*>(&local_addr),
+                    sizeof(local_addr)) != 0 ||
+          sock_listen(fd, req->backlog) != 0) {
+        req->error_code = errno;
+        req->result = -1;
+        req->last_error = req->error_code;
+        sock_close(fd);
+        PW_LOG_ERROR("Listen on port %u failed: %d", req->port,
+                     req->error_code);
+        Complete(*req);
+        break;
+      }
+
+      // Accepts are polled like reads and must never block the thread
+      const int flags = sock_fcntl(fd, F_GETFL, 0);
+      sock_fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+      req->socket_fd = fd;
+      req->result = 0;
+      req->error_code = 0;
+      req->last_error = 0;
+      PW_LOG_INFO("Listening on port %u (fd=%d)", req->port, fd);
+      Complete(*req);
+      break;
+    }
+
+    case SocketOp::kAccept: {
+      if (req->socket_fd < 0) {
+        req->result = -1;
+        req->error_code = ENOTCONN;
+        req->last_error = ENOTCONN;
+        Complete(*req);
+        break;
+      }
+      // Waits for a connection the way a read waits for data. Without a
+      // free parking slot the accept completes with EAGAIN.
+      if (!AcceptNow(*req) && ParkRead(req)) {
+        break;
+      }
+      Complete(*req);
+      break;
+    }
+
+    case SocketOp::kUdpOpen: {
+      PW_LOG_DEBUG("SocketThread: UDP open on port %u", req->local_port);
+      uint32_t peer_addr = 0;
+      if (req->host != nullptr && !ResolveRequestHost(req, peer_addr)) {
+        break;
+      }
+
+      const int fd = sock_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+      if (fd < 0) {
+        req->error_code = errno;
+        req->result = -1;
+        req->last_error = req->error_code;
+        PW_LOG_ERROR("sock_socket failed: %d", req->error_code);
+        Complete(*req);
+        break;
+      }
+
+      // Bound even for port 0 so datagrams can be received before sending
+      struct sockaddr_in local_addr;
+      std::memset(&local_addr, 0, sizeof(local_addr));
+      local_addr.sin_family = AF_INET;
+      local_addr.sin_port = inet_htons(req->local_port);
+      local_addr.sin_addr.s_addr = inet_htonl(INADDR_ANY);
+      if (sock_bind(fd, reinterpret_cast<struct sockaddr*>(&local_addr),
+                    sizeof(local_addr)) != 0) {
+        req->error_code = errno;
+        req->result = -1;
+        req->last_error = req->error_code;
+        sock_close(fd);
+        PW_LOG_ERROR("UDP bind to port %u failed: %d", req->local_port,
+                     req->error_code);
+        Complete(*req);
+        break;
+      }
+
+      req->socket_fd = fd;
+      req->resolved_addr = peer_addr;
+      req->result = 0;
+      req->error_code = 0;
+      req->last_error = 0;
+      Complete(*req);
+      break;
+    }
+
+    case SocketOp::kSendTo: {
+      // All datagrams of a batch in one pass; UDP sends don't block in LwIP
+      size_t sent = 0;
+      int error = 0;
+      for (const UdpDatagram& datagram : req->datagrams) {
+        struct sockaddr_in to;
+        std::memset(&to, 0, sizeof(to));
+        to.sin_family = AF_INET;
+        to.sin_port = inet_htons(datagram.to.port);
+        to.sin_addr.s_addr = datagram.to.addr;
+        if (sock_sendto(req->socket_fd, datagram.data.data(),
+                        datagram.data.size(), MSG_DONTWAIT,
+                        reinterpret_cast<struct sockaddr*>(&to),
+                        sizeof(to)) < 0) {
+          error = errno;
+          break;
+        }
+        g_counters.bytes_sent.Increment(
+            static_cast<uint32_t>(datagram.data.size()));
+        ++sent;
+      }
+      req->result = static_cast<ssize_t>(sent);
+      req->error_code = error;
+      if (error != 0) {
+        req->last_error = error;
+        PW_LOG_WARN("SocketThread: sendto failed after %zu datagrams: %d",
+                    sent, error);
+      }
+      Complete(*req);
+      break;
+    }
+
+    case SocketOp::kRecvFrom: {
+      if (!RecvFromNow(*req) && req->wait_for_data && ParkRead(req)) {
+        break;
+      }
+      Complete(*req);
+      break;
+    }
+  }
+}
+
+void SocketThreadMain(void* /*arg*/) {
+  PW_LOG_INFO("Socket worker thread started");
+
+  while (true) {
+    // Block on the queue only while no socket needs polling, and no longer
+    // than until the next write batch is due. Otherwise drain everything
+    // queued, then poll the sockets for a short while so new requests are
+    // picked up within kPollIntervalMs.
+    const uint32_t flush_in = NextBatchFlushMs(HAL_Timer_Get_Milli_Seconds());
+    const bool poll = HasSocketsToPoll();
+    system_tick_t wait = CONCURRENT_WAIT_FOREVER;
+    if (poll) {
+      wait = 0;
+    } else if (flush_in != kNoBatchFlush) {
+      wait = flush_in;
+    }
+
+    if (wait == CONCURRENT_WAIT_FOREVER) {
+      PW_LOG_DEBUG("SocketThread: waiting for request...");
+    }
+    size_t depth = 0;
+    if (SocketRequest* req = g_socket_queue.Pop(wait, &depth);
+        req != nullptr) {
+      PW_LOG_DEBUG("SocketThread: got request op=%d fd=%d",
+                   static_cast<int>(req->op), req->socket_fd);
+      const uint32_t start_us = NowMicros();
+      g_counters.requests.Increment();
+      if (depth > g_counters.queue_depth_peak.value()) {
+        g_counters.queue_depth_peak.Set(static_cast<uint32_t>(depth));
+      }
+      RecordLatency(g_counters.queue_wait, g_counters.queue_wait_max_us,
+                    start_us - req->queued_at_us);
+      // A connect comes back from the resolver thread once resolved
+      if (req->op != SocketOp::kConnect || !req->addr_resolved) {
+        g_counters.OpCount(req->op).Increment();
+      }
+      HandleRequest(req);  // May complete `req`, which is then gone
+      RecordLatency(g_counters.exec, g_counters.exec_max_us,
+                    NowMicros() - start_us);
+      continue;
+    }
+    if (poll) {
+      PollSockets(static_cast<int>(
+          std::min<uint32_t>(config::kPollIntervalMs, flush_in)));
+    }
+    FlushDueBatches(HAL_Timer_Get_Milli_Seconds());
+  }
+}
+
+/// Initialize socket thread with proper synchronization.
+/// Returns true if thread is ready, false on initialization failure.
+bool EnsureSocketThreadStarted() {
+  // Fast path: already initialized
+  if (g_socket_thread_started.load(std::memory_order_acquire)) {
+    return true;
+  }
+
+  // Try to claim initialization
+  bool expected = false;
+  if (!g_socket_thread_init_in_progress.compare_exchange_strong(
+          expected, true, std::memory_order_acq_rel)) {
+    // Another thread is initializing, spin until done
+    while (!g_socket_thread_started.load(std::memory_order_acquire)) {
+      // Small delay to avoid busy spinning
+      os_thread_yield();
+    }
+    return true;
+  }
+
+  // We claimed initialization, do it.
+  // Create resolver thread. Optional: without it the socket thread resolves
+  // hostnames itself. Not retried if the socket thread fails below.
+  if (!g_resolver_started) {
+    if (os_thread_create(&g_resolver_thread, "dns", OS_THREAD_PRIORITY_DEFAULT,
+                         ResolverThreadMain, nullptr,
+                         config::kResolverStackSize) == 0) {
+      g_resolver_started = true;
+    } else {
+      PW_LOG_WARN("DNS resolver thread not started, resolving inline");
+    }
+  }
+
+  // Create socket thread
+  int ret =
+      os_thread_create(&g_socket_thread, "socket", OS_THREAD_PRIORITY_DEFAULT,
+                       SocketThreadMain, nullptr, config::kWorkerStackSize);
+  if (ret != 0) {
+    PW_LOG_ERROR("os_thread_create failed: %d", ret);
+    g_socket_thread_init_in_progress.store(false, std::memory_order_release);
+    return false;
+  }
+
+  g_socket_thread_started.store(true, std::memory_order_release);
+  return true;
+}
+
+/// Hands the prepared request of `slot` to the socket thread and waits for
+/// it. The caller holds slot.lock.
+void Execute(BlockingRequest& slot) {
+  slot.request.done = &slot.done;
+  g_socket_queue.Push(&slot.request);
+  slot.done.acquire();
+}
+
+}  // namespace
+
+// ============================================================================
+// ParticleTcpSocket Implementation
+// ============================================================================
+
+ParticleTcpSocket::ParticleTcpSocket(const TcpConfig& config)
+    : config_(config) {}
+
+ParticleTcpSocket::ParticleTcpSocket(const TcpConfig& config,
+                                     pw::ByteSpan rx_buffer,
+                                     pw::ByteSpan tx_buffer)
+    : config_(config) {
+  buffers_.rx = rx_buffer;
+  buffers_.tx = tx_buffer;
+}
+
+ParticleTcpSocket::~ParticleTcpSocket() { Disconnect(); }
+
+pw::Status ParticleTcpSocket::PrepareRequest(SocketOp op, SocketRequest& req) {
+  if (op == SocketOp::kConnect) {
+    if (state_.load(std::memory_order_acquire) == TcpState::kConnected) {
+      return pw::Status::FailedPrecondition();
+    }
+  } else if (!IsConnected()) {
+    last_error_.store(ENOTCONN, std::memory_order_release);
+    return pw::Status::FailedPrecondition();
+  }
+
+  if (!EnsureSocketThreadStarted()) {
+    last_error_.store(ENOMEM, std::memory_order_release);
+    return pw::Status::Internal();
+  }
+
+  if (op == SocketOp::kConnect) {
+    state_.store(TcpState::kConnecting, std::memory_order_release);
+    req.host = config_.host;
+    req.port = config_.port;
+    req.connect_timeout_ms = config_.connect_timeout_ms;
+  }
+  req.read_timeout_ms = config_.read_timeout_ms;
+
+  req.op = op;
+  req.buffers = (rx_buffered() || tx_buffered()) ? &buffers_ : nullptr;
+  req.socket_fd = socket_fd_.load(std::memory_order_acquire);
+  req.state = state_.load(std::memory_order_acquire);
+  req.last_error = last_error_.load(std::memory_order_acquire);
+  return pw::OkStatus();
+}
+
+pw::Status ParticleTcpSocket::FinishConnect(const SocketRequest& req) {
+  // Store results atomically
+  socket_fd_.store(req.socket_fd, std::memory_order_release);
+  state_.store(req.state, std::memory_order_release);
+  last_error_.store(req.last_error, std::memory_order_release);
+
+  if (req.result < 0) {
+    if (req.error_code == ETIMEDOUT) {
+      return pw::Status::DeadlineExceeded();
+    }
+    return pw::Status::Unavailable();
+  }
+
+  return pw::OkStatus();
+}
+
+pw::StatusWithSize ParticleTcpSocket::FinishRead(const SocketRequest& req) {
+  // Store results atomically
+  state_.store(req.state, std::memory_order_release);
+  last_error_.store(req.last_error, std::memory_order_release);
+
+  if (req.result < 0) {
+    if (req.error_code == EAGAIN || req.error_code == EWOULDBLOCK) {
+      return pw::StatusWithSize(0);
+    }
+    if (req.error_code == ENOTCONN) {
+      // Disconnected while the read waited for data
+      return pw::StatusWithSize::FailedPrecondition();
+    }
+    return pw::StatusWithSize::Internal();
+  }
+
+  if (req.result == 0) {
+    // Connection closed by peer
+    return pw::StatusWithSize::OutOfRange();
+  }
+
+  return pw::StatusWithSize(static_cast<size_t>(req.result));
+}
+
+pw::Status ParticleTcpSocket::FinishWrite(const SocketRequest& req) {
+  // Store results atomically
+  state_.store(req.state, std::memory_order_release);
+  last_error_.store(req.last_error, std::memory_order_release);
+
+  if (req.result < 0) {
+    return pw::Status::Internal();
+  }
+
+  return pw::OkStatus();
+}
+
+size_t ParticleTcpSocket::ReadBuffered(pw::span<const pw::ByteSpan> dest) {
+  return rx_buffered() ? buffers_.ReadRx(dest) : 0;
+}
+
+pw::Status ParticleTcpSocket::TakeStagedWriteError() {
+  std::lock_guard lock(buffers_.lock);
+  if (buffers_.tx_error == 0) {
+    return pw::OkStatus();
+  }
+  // Report the failed staged send once
+  last_error_.store(buffers_.tx_error, std::memory_order_release);
+  state_.store(TcpState::kError, std::memory_order_release);
+  buffers_.tx_error = 0;
+  return pw::Status::Internal();
+}
+
+pw::Status ParticleTcpSocket::StageWrite(
+    pw::span<const pw::ConstByteSpan> chunks) {
+  if (!tx_buffered()) {
+    return pw::Status::ResourceExhausted();
+  }
+  PW_TRY(TakeStagedWriteError());
+
+  size_t total = 0;
+  for (pw::ConstByteSpan chunk : chunks) {
+    total += chunk.size();
+  }
+
+  bool queue_flush = false;
+  {
+    std::lock_guard lock(buffers_.lock);
+    if (total > buffers_.tx.size() - buffers_.tx_used) {
+      return pw::Status::ResourceExhausted();
+    }
+    if (buffers_.tx_used == 0) {
+      buffers_.tx_staged_at_ms = HAL_Timer_Get_Milli_Seconds();
+    }
+    for (pw::ConstByteSpan chunk : chunks) {
+      std::memcpy(buffers_.tx.data() + buffers_.tx_used, chunk.data(),
+                  chunk.size());
+      buffers_.tx_used += chunk.size();
+    }
+    // Without batching (tx_batch_bytes == 0) every write queues the flush
+    if (!buffers_.tx_flush_queued &&
+        buffers_.tx_used >= buffers_.tx_batch_bytes) {
+      buffers_.tx_flush_queued = true;
+      queue_flush = true;
+    }
+  }
+
+  if (queue_flush) {
+    // One flush request is in flight at a time; writes staged until the
+    // socket thread picks it up go out with the same sock_send
+    SocketRequest& req = buffers_.tx_request;
+    req = SocketRequest{};
+    req.op = SocketOp::kFlush;
+    req.socket_fd = socket_fd_.load(std::memory_order_acquire);
+    req.buffers = &buffers_;
+    g_socket_queue.Push(&req);
+  }
+  return pw::OkStatus();
+}
+
+void ParticleTcpSocket::set_write_batching(const WriteBatching& batching) {
+  std::lock_guard lock(buffers_.lock);
+  buffers_.tx_batch_bytes = std::min(batching.min_bytes, buffers_.tx.size());
+  buffers_.tx_batch_delay_ms = batching.max_delay_ms;
+}
+
+pw::Status ParticleTcpSocket::Connect() {
+  std::lock_guard lock(control_request_.lock);
+  SocketRequest& req = control_request_.request;
+  req = SocketRequest{};
+  if (pw::Status status = PrepareRequest(SocketOp::kConnect, req);
+      !status.ok()) {
+    return status;
+  }
+
+  // Queue connect request to socket thread
+  Execute(control_request_);
+
+  return FinishConnect(req);
+}
+
+void ParticleTcpSocket::Disconnect() {
+  int fd = socket_fd_.load(std::memory_order_acquire);
+  TcpState current_state = state_.load(std::memory_order_acquire);
+  if (fd < 0 && current_state == TcpState::kDisconnected) {
+    return;
+  }
+
+  if (!EnsureSocketThreadStarted()) {
+    // Can't start thread, just mark as disconnected
+    socket_fd_.store(-1, std::memory_order_release);
+    state_.store(TcpState::kDisconnected, std::memory_order_release);
+    return;
+  }
+
+  std::lock_guard lock(control_request_.lock);
+  SocketRequest& req = control_request_.request;
+  req = SocketRequest{};
+  req.op = SocketOp::kDisconnect;
+  req.socket_fd = socket_fd_.load(std::memory_order_acquire);
+  req.state = state_.load(std::memory_order_acquire);
+  req.last_error = last_error_.load(std::memory_order_acquire);
+  req.buffers = (rx_buffered() || tx_buffered()) ? &buffers_ : nullptr;
+
+  Execute(control_request_);
+
+  // Store results atomically
+  socket_fd_.store(req.socket_fd, std::memory_order_release);
+  state_.store(req.state, std::memory_order_release);
+  last_error_.store(req.last_error, std::memory_order_release);
+}
+
+void ParticleTcpSocket::ClearDnsCache() { g_dns_cache.Clear(); }
+
+bool ParticleTcpSocket::NetworkReady() {
+  return network_ready(NETWORK_INTERFACE_ALL, 0, nullptr);
+}
+
+SocketWorkerStats ParticleTcpSocket::WorkerStats() {
+  SocketWorkerStats stats{
+      .requests = g_counters.requests.value(),
+      .queue_depth = static_cast<uint32_t>(g_socket_queue.depth()),
+      .queue_depth_peak = g_counters.queue_depth_peak.value(),
+      .queue_wait_max_us = g_counters.queue_wait_max_us.value(),
+      .exec_max_us = g_counters.exec_max_us.value(),
+      .connects = g_counters.connects.value(),
+      .disconnects = g_counters.disconnects.value(),
+      .sends = g_counters.sends.value(),
+      .recvs = g_counters.recvs.value(),
+      .flushes = g_counters.flushes.value(),
+      .listens = g_counters.listens.value(),
+      .accepts = g_counters.accepts.value(),
+      .udp_opens = g_counters.udp_opens.value(),
+      .send_tos = g_counters.send_tos.value(),
+      .recv_froms = g_counters.recv_froms.value(),
+      .send_eagain_retries = g_counters.send_eagain_retries.value(),
+      .bytes_sent = g_counters.bytes_sent.value(),
+      .bytes_received = g_counters.bytes_received.value(),
+  };
+  for (size_t i = 0; i < kSocketLatencyBuckets; ++i) {
+    stats.queue_wait_us[i] = g_counters.queue_wait[i]->value();
+    stats.exec_us[i] = g_counters.exec[i]->value();
+  }
+  return stats;
+}
+
+void ParticleTcpSocket::ResetWorkerStats() {
+  g_counters.requests.Set(0);
+  g_counters.queue_depth_peak.Set(0);
+  g_counters.queue_wait_max_us.Set(0);
+  g_counters.exec_max_us.Set(0);
+  for (size_t i = 0; i < kSocketLatencyBuckets; ++i) {
+    g_counters.queue_wait[i]->Set(0);
+    g_counters.exec[i]->Set(0);
+  }
+  g_counters.connects.Set(0);
+  g_counters.disconnects.Set(0);
+  g_counters.sends.Set(0);
+  g_counters.recvs.Set(0);
+  g_counters.flushes.Set(0);
+  g_counters.listens.Set(0);
+  g_counters.accepts.Set(0);
+  g_counters.udp_opens.Set(0);
+  g_counters.send_tos.Set(0);
+  g_counters.recv_froms.Set(0);
+  g_counters.send_eagain_retries.Set(0);
+  g_counters.bytes_sent.Set(0);
+  g_counters.bytes_received.Set(0);
+}
+
+pw::metric::Group& ParticleTcpSocket::WorkerMetrics() {
+  return g_counters.group;
+}
+
+bool ParticleTcpSocket::IsConnected() const {
+  return state_.load(std::memory_order_acquire) == TcpState::kConnected &&
+         socket_fd_.load(std::memory_order_acquire) >= 0;
+}
+
+pw::StatusWithSize ParticleTcpSocket::Read(pw::ByteSpan dest) {
+  return ReadChunks(pw::span<const pw::ByteSpan>(&dest, 1));
+}
 
-  // For Connect
-  const char* host;
-  uint16_t port;
-  uint32_t connect_timeout_ms;
-  uint32_t read_timeout_ms;
+pw::StatusWithSize ParticleTcpSocket::ReadV(
+    pw::span<const pw::ByteSpan> buffers) {
+  return ReadChunks(buffers);
+}
 
-  // For Send
-  const void* send_data;
-  size_t send_size;
+pw::Status ParticleTcpSocket::Write(pw::ConstByteSpan data) {
+  return WriteChunks(pw::span<const pw::ConstByteSpan>(&data, 1));
+}
 
-  // For Recv
-  void* recv_buffer;
-  size_t recv_size;
+pw::Status ParticleTcpSocket::WriteV(pw::span<const pw::ConstByteSpan> chunks) {
+  return WriteChunks(chunks);
+}
 
-  // Input/output state (caller provides current values, socket thread updates)
-  int socket_fd;
-  TcpState state;
-  int last_error;
+pw::StatusWithSize ParticleTcpSocket::ReadChunks(
+    pw::span<const pw::ByteSpan> buffers) {
+  // Fast path: served from the read-ahead ring without a round-trip
+  if (IsConnected()) {
+    if (const size_t copied = ReadBuffered(buffers); copied > 0) {
+      return pw::StatusWithSize(copied);
+    }
+  }
 
-  // Result
-  ssize_t result;
-  int error_code;
+  std::lock_guard lock(read_request_.lock);
+  SocketRequest& req = read_request_.request;
+  req = SocketRequest{};
+  if (pw::Status status = PrepareRequest(SocketOp::kRecv, req);
+      !status.ok()) {
+    PW_LOG_WARN("Read: cannot queue request (status=%d)",
+                static_cast<int>(status.code()));
+    return pw::StatusWithSize(status, 0);
+  }
 
-  // Completion signal
-  pw::sync::BinarySemaphore* done;
-};
+  if (buffers.size() == 1) {
+    req.recv_buffer = buffers[0].data();
+    req.recv_size = buffers[0].size();
+  } else {
+    req.recv_chunks = buffers;
+  }
+  req.wait_for_data = config_.read_timeout_ms > 0;
 
-// Global queue for socket requests (holds pointers to SocketRequest)
-os_queue_t g_socket_queue = nullptr;
-os_thread_t g_socket_thread = nullptr;
-std::atomic<bool> g_socket_thread_started{false};
-std::atomic<bool> g_socket_thread_init_in_progress{false};
+  PW_LOG_DEBUG("Read: queuing recv request fd=%d chunks=%zu", req.socket_fd,
+               buffers.size());
+  Execute(read_request_);
+  PW_LOG_DEBUG("Read: completed result=%zd err=%d", req.result, req.error_code);
 
-void SocketThreadMain(void* /*arg*/) {
-  PW_LOG_INFO("Socket worker thread started");
+  return FinishRead(req);
+}
 
-  while (true) {
-    SocketRequest* req = nullptr;
-    PW_LOG_DEBUG("SocketThread: waiting for request...");
-    if (os_queue_take(g_socket_queue, &req, CONCURRENT_WAIT_FOREVER, nullptr) !=
-        0) {
-      PW_LOG_WARN("SocketThread: queue take failed");
-      continue;
+pw::Status ParticleTcpSocket::WriteChunks(
+    pw::span<const pw::ConstByteSpan> chunks) {
+  // Fast path: staged for the socket thread to send without waiting
+  if (IsConnected()) {
+    if (pw::Status status = StageWrite(chunks);
+        !status.IsResourceExhausted()) {
+      return status;
     }
-    if (req == nullptr) {
-      PW_LOG_WARN("SocketThread: got null request");
-      continue;
+  }
+
+  std::lock_guard lock(write_request_.lock);
+  SocketRequest& req = write_request_.request;
+  req = SocketRequest{};
+  if (pw::Status status = PrepareRequest(SocketOp::kSend, req);
+      !status.ok()) {
+    return status;
+  }
+
+  if (chunks.size() == 1) {
+    req.send_data = chunks[0].data();
+    req.send_size = chunks[0].size();
+  } else {
+    req.send_chunks = chunks;
+    req.send_size = 0;
+    for (pw::ConstByteSpan chunk : chunks) {
+      req.send_size += chunk.size();
     }
-    PW_LOG_DEBUG("SocketThread: got request op=%d fd=%d",
-                 static_cast<int>(req->op), req->socket_fd);
+  }
+  Execute(write_request_);
 
-    switch (req->op) {
-      case SocketOp::kConnect: {
-        PW_LOG_DEBUG("SocketThread: Connect to %s:%u", req->host, req->port);
+  return FinishWrite(req);
+}
 
-        // Close existing socket if any
-        if (req->socket_fd >= 0) {
-          sock_close(req->socket_fd);
-          req->socket_fd = -1;
-        }
+pw::Status ParticleTcpSocket::Flush() {
+  if (!tx_buffered()) {
+    return pw::OkStatus();
+  }
+  PW_TRY(TakeStagedWriteError());
+
+  // An empty send: the socket thread sends the staged bytes ahead of it
+  std::lock_guard lock(write_request_.lock);
+  SocketRequest& req = write_request_.request;
+  req = SocketRequest{};
+  PW_TRY(PrepareRequest(SocketOp::kSend, req));
+  req.send_data = nullptr;
+  req.send_size = 0;
+  Execute(write_request_);
+
+  return FinishWrite(req);
+}
 
-        // Create socket
-        req->socket_fd = sock_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-        if (req->socket_fd < 0) {
-          req->error_code = errno;
-          req->result = -1;
-          req->state = TcpState::kError;
-          req->last_error = req->error_code;
-          PW_LOG_ERROR("sock_socket failed: %d", req->error_code);
-          req->done->release();
-          break;
-        }
+// ============================================================================
+// Async futures
+// ============================================================================
 
-        // Set keepalive
-        int flag = 1;
-        sock_setsockopt(req->socket_fd, SOL_SOCKET, SO_KEEPALIVE, &flag,
-                        sizeof(flag));
-
-        // Set read timeout if specified
-        if (req->read_timeout_ms > 0) {
-          struct timeval tv;
-          tv.tv_sec = req->read_timeout_ms / 1000;
-          tv.tv_usec = (req->read_timeout_ms % 1000) * 1000;
-          sock_setsockopt(req->socket_fd, SOL_SOCKET, SO_RCVTIMEO, &tv,
-                          sizeof(tv));
-        }
+namespace internal {
 
-        // Resolve address
-        struct sockaddr_in server_addr;
-        std::memset(&server_addr, 0, sizeof(server_addr));
-        server_addr.sin_family = AF_INET;
-        server_addr.sin_port = inet_htons(req->port);
-
-        if (inet_inet_pton(AF_INET, req->host, &server_addr.sin_addr) != 1) {
-          struct addrinfo hints;
-          struct addrinfo* result = nullptr;
-          std::memset(&hints, 0, sizeof(hints));
-          hints.ai_family = AF_INET;
-          hints.ai_socktype = SOCK_STREAM;
-
-          int err = netdb_getaddrinfo(req->host, nullptr, &hints, &result);
-          if (err != 0 || result == nullptr) {
-            req->error_code = err;
-            req->result = -1;
-            sock_close(req->socket_fd);
-            req->socket_fd = -1;
-            req->state = TcpState::kError;
-            req->last_error = err;
-            PW_LOG_ERROR("getaddrinfo failed: %d", err);
-            req->done->release();
-            break;
-          }
-          auto* addr = reinterpret_cast<struct sockaddr_in*>(result->ai_addr);
-          server_addr.sin_addr = addr->sin_addr;
-          netdb_freeaddrinfo(result);
-        }
+size_t SocketBuffers::ReadRx(pw::span<const pw::ByteSpan> dest) {
+  size_t total = 0;
+  for (pw::ByteSpan chunk : dest) {
+    const size_t copied = ReadRx(chunk);
+    total += copied;
+    if (copied < chunk.size()) {
+      break;
+    }
+  }
+  return total;
+}
 
-        // Non-blocking connect with timeout
-        int flags = sock_fcntl(req->socket_fd, F_GETFL, 0);
-        sock_fcntl(req->socket_fd, F_SETFL, flags | O_NONBLOCK);
-
-        int ret = sock_connect(
-            req->socket_fd, reinterpret_cast<struct sockaddr*>(&server_addr),
-            sizeof(server_addr));
-
-        if (ret < 0 && errno != EINPROGRESS) {
-          req->error_code = errno;
-          req->result = -1;
-          sock_close(req->socket_fd);
-          req->socket_fd = -1;
-          req->state = TcpState::kError;
-          req->last_error = req->error_code;
-          PW_LOG_ERROR("sock_connect failed: %d", req->error_code);
-          req->done->release();
-          break;
-        }
+size_t SocketBuffers::ReadRx(pw::ByteSpan dest) {
+  std::lock_guard guard(lock);
+  const size_t size = rx.size();
+  size_t copied = 0;
+  while (copied < dest.size() && rx_count > 0) {
+    const size_t chunk =
+        std::min({dest.size() - copied, rx_count, size - rx_head});
+    std::memcpy(dest.data() + copied, rx.data() + rx_head, chunk);
+    copied += chunk;
+    rx_head = (rx_head + chunk) % size;
+    rx_count -= chunk;
+  }
+  return copied;
+}
 
-        // Poll for connection
-        struct pollfd pfd;
-        pfd.fd = req->socket_fd;
-        pfd.events = POLLOUT;
-        pfd.revents = 0;
-
-        ret = sock_poll(&pfd, 1, static_cast<int>(req->connect_timeout_ms));
-        if (ret <= 0) {
-          req->error_code = (ret == 0) ? ETIMEDOUT : errno;
-          req->result = -1;
-          sock_close(req->socket_fd);
-          req->socket_fd = -1;
-          req->state = TcpState::kError;
-          req->last_error = req->error_code;
-          PW_LOG_ERROR("sock_poll timeout/error: %d", req->error_code);
-          req->done->release();
-          break;
-        }
+SocketFuture::SocketFuture(ParticleTcpSocket* socket, SocketOp op)
+    : socket_(socket) {
+  request_.op = op;
+}
 
-        // Check socket error
-        int socket_error = 0;
-        socklen_t len = sizeof(socket_error);
-        sock_getsockopt(req->socket_fd, SOL_SOCKET, SO_ERROR, &socket_error,
-                        &len);
-        if (socket_error != 0) {
-          req->error_code = socket_error;
-          req->result = -1;
-          sock_close(req->socket_fd);
-          req->socket_fd = -1;
-          req->state = TcpState::kError;
-          req->last_error = socket_error;
-          PW_LOG_ERROR("Connection error: %d", socket_error);
-          req->done->release();
-          break;
-        }
+SocketFuture::SocketFuture(SocketFuture&& other) noexcept { MoveFrom(other); }
 
-        // Restore blocking mode
-        sock_fcntl(req->socket_fd, F_SETFL, flags);
+SocketFuture& SocketFuture::operator=(SocketFuture&& other) noexcept {
+  if (this != &other) {
+    // The socket thread holds a pointer to a queued request
+    PW_CHECK(!queued_ || finished_, "Cannot overwrite a queued socket future");
+    if (queued_) {
+      released_.acquire();
+    }
+    MoveFrom(other);
+  }
+  return *this;
+}
 
-        req->state = TcpState::kConnected;
-        req->last_error = 0;
-        req->result = 0;
-        req->error_code = 0;
-        PW_LOG_INFO("Connected to %s:%u (fd=%d)", req->host, req->port,
-                    req->socket_fd);
-        req->done->release();
-        break;
-      }
+SocketFuture::~SocketFuture() {
+  if (queued_) {
+    // The socket thread may still be using request_
+    released_.acquire();
+  }
+}
 
-      case SocketOp::kDisconnect: {
-        PW_LOG_DEBUG("SocketThread: Disconnect (fd=%d)", req->socket_fd);
-        if (req->socket_fd >= 0) {
-          sock_shutdown(req->socket_fd, SHUT_RDWR);
-          sock_close(req->socket_fd);
-          req->socket_fd = -1;
-        }
-        req->state = TcpState::kDisconnected;
-        req->last_error = 0;
-        req->result = 0;
-        req->error_code = 0;
-        req->done->release();
-        break;
-      }
+void SocketFuture::MoveFrom(SocketFuture& other) {
+  // The socket thread holds a pointer to a queued request
+  PW_CHECK(!other.queued_, "Cannot move a socket future after polling it");
+  socket_ = other.socket_;
+  listener_ = other.listener_;
+  request_ = other.request_;
+  request_done_ = false;
+  queued_ = false;
+  finished_ = other.finished_;
+
+  other.socket_ = nullptr;
+  other.finished_ = true;
+}
 
-      case SocketOp::kSend: {
-        PW_LOG_DEBUG("SocketThread: Send %zu bytes (fd=%d)", req->send_size,
-                     req->socket_fd);
-        if (req->state != TcpState::kConnected || req->socket_fd < 0) {
-          req->result = -1;
-          req->error_code = ENOTCONN;
-          req->last_error = ENOTCONN;
-          PW_LOG_WARN("SocketThread: Send failed - not connected");
-          req->done->release();
-          break;
-        }
+void SocketFuture::OnRequestDone() {
+  // Copy waker under lock, then wake outside lock (see AsyncUart)
+  pw::async2::Waker waker;
+  {
+    std::lock_guard lock(lock_);
+    request_done_ = true;
+    waker = std::move(waker_);
+  }
+  waker.Wake();
+  // Last access from the socket thread; the owner may destroy us after this
+  released_.release();
+}
 
-        // Loop to handle partial writes. sock_send with MSG_DONTWAIT may
-        // only send part of the data if the send buffer is full. We poll
-        // for writability and retry to ensure the entire payload is sent,
-        // which is critical for HDLC frame integrity.
-        const auto* data_ptr =
-            static_cast<const uint8_t*>(req->send_data);
-        size_t remaining = req->send_size;
-        bool send_error = false;
-
-        while (remaining > 0) {
-          ssize_t sent =
-              sock_send(req->socket_fd, data_ptr, remaining, MSG_DONTWAIT);
-
-          if (sent > 0) {
-            data_ptr += sent;
-            remaining -= static_cast<size_t>(sent);
-            continue;
-          }
+pw::async2::Poll<pw::Status> SocketFuture::PendRequest(
+    pw::async2::Context& cx) {
+  if (socket_ == nullptr || finished_) {
+    return pw::async2::Ready(pw::Status::InvalidArgument());
+  }
 
-          if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-            // Send buffer full — wait for writability then retry
-            struct pollfd pfd;
-            pfd.fd = req->socket_fd;
-            pfd.events = POLLOUT;
-            pfd.revents = 0;
-            int poll_ret = sock_poll(&pfd, 1, 5000);
-            if (poll_ret <= 0) {
-              req->error_code = (poll_ret == 0) ? ETIMEDOUT : errno;
-              req->result = -1;
-              req->last_error = req->error_code;
-              req->state = TcpState::kError;
-              send_error = true;
-              break;
-            }
-            continue;
-          }
+  if (!queued_) {
+    const pw::Status status =
+        listener_ != nullptr ? listener_->PrepareAccept(*socket_, request_)
+                             : socket_->PrepareRequest(request_.op, request_);
+    if (!status.ok()) {
+      finished_ = true;
+      return pw::async2::Ready(status);
+    }
+    request_.done = nullptr;
+    request_.future = this;
+
+    // Store the waker before queueing so the socket thread can't complete
+    // the request in between
+    {
+      std::lock_guard lock(lock_);
+      PW_ASYNC_STORE_WAKER(cx, waker_, "Waiting for socket thread");
+    }
+    // Never blocks, so the dispatcher isn't held up
+    g_socket_queue.Push(&request_);
+    queued_ = true;
+    return pw::async2::Pending();
+  }
 
-          // Real send error
-          req->error_code = errno;
-          req->result = -1;
-          req->last_error = errno;
-          req->state = TcpState::kError;
-          send_error = true;
-          break;
-        }
+  std::lock_guard lock(lock_);
+  if (!request_done_) {
+    PW_ASYNC_STORE_WAKER(cx, waker_, "Waiting for socket thread");
+    return pw::async2::Pending();
+  }
+  finished_ = true;
+  return pw::async2::Ready(pw::OkStatus());
+}
 
-        if (!send_error) {
-          req->result = static_cast<ssize_t>(req->send_size);
-          req->error_code = 0;
-        }
-        req->done->release();
-        break;
-      }
+}  // namespace internal
 
-      case SocketOp::kRecv: {
-        PW_LOG_DEBUG("SocketThread: Recv up to %zu bytes (fd=%d)", req->recv_size,
-                     req->socket_fd);
-        if (req->state != TcpState::kConnected || req->socket_fd < 0) {
-          req->result = -1;
-          req->error_code = ENOTCONN;
-          req->last_error = ENOTCONN;
-          PW_LOG_WARN("SocketThread: Recv failed - not connected");
-          req->done->release();
-          break;
-        }
+TcpConnectFuture::TcpConnectFuture(ParticleTcpSocket* socket)
+    : SocketFuture(socket, SocketOp::kConnect) {}
 
-        // Use MSG_DONTWAIT to avoid blocking on the LwIP lock.
-        // The caller can retry if EAGAIN is returned.
-        ssize_t received = sock_recv(req->socket_fd, req->recv_buffer,
-                                     req->recv_size, MSG_DONTWAIT);
-
-        if (received < 0) {
-          req->error_code = errno;
-          req->result = -1;
-          req->last_error = errno;
-          if (errno != EAGAIN && errno != EWOULDBLOCK) {
-            req->state = TcpState::kError;
-          }
-        } else if (received == 0) {
-          // Connection closed by peer
-          req->result = 0;
-          req->error_code = 0;
-          req->state = TcpState::kDisconnected;
-        } else {
-          req->result = received;
-          req->error_code = 0;
-        }
-        req->done->release();
-        break;
-      }
-    }
+pw::async2::Poll<pw::Status> TcpConnectFuture::Pend(pw::async2::Context& cx) {
+  pw::async2::Poll<pw::Status> poll = PendRequest(cx);
+  if (poll.IsPending()) {
+    return pw::async2::Pending();
+  }
+  if (!poll->ok()) {
+    return poll;
   }
+  return pw::async2::Ready(socket_->FinishConnect(request_));
 }
 
-/// Initialize socket thread with proper synchronization.
-/// Returns true if thread is ready, false on initialization failure.
-bool EnsureSocketThreadStarted() {
-  // Fast path: already initialized
-  if (g_socket_thread_started.load(std::memory_order_acquire)) {
-    return true;
-  }
+TcpReadFuture::TcpReadFuture(ParticleTcpSocket* socket, pw::ByteSpan dest)
+    : SocketFuture(socket, SocketOp::kRecv) {
+  request_.recv_buffer = dest.data();
+  request_.recv_size = dest.size();
+  request_.wait_for_data = true;
+}
 
-  // Try to claim initialization
-  bool expected = false;
-  if (!g_socket_thread_init_in_progress.compare_exchange_strong(
-          expected, true, std::memory_order_acq_rel)) {
-    // Another thread is initializing, spin until done
-    while (!g_socket_thread_started.load(std::memory_order_acquire)) {
-      // Small delay to avoid busy spinning
-      os_thread_yield();
+pw::async2::Poll<pw::StatusWithSize> TcpReadFuture::Pend(
+    pw::async2::Context& cx) {
+  if (socket_ != nullptr && !queued() && !is_complete() &&
+      socket_->IsConnected()) {
+    const pw::ByteSpan dest(static_cast<std::byte*>(request_.recv_buffer),
+                            request_.recv_size);
+    if (const size_t copied =
+            socket_->ReadBuffered(pw::span<const pw::ByteSpan>(&dest, 1));
+        copied > 0) {
+      MarkFinished();
+      return pw::async2::Ready(pw::StatusWithSize(copied));
     }
-    return true;
   }
-
-  // We claimed initialization, do it
-  // Create request queue (holds up to 4 request pointers)
-  int ret = os_queue_create(&g_socket_queue, sizeof(SocketRequest*), 4, nullptr);
-  if (ret != 0) {
-    PW_LOG_ERROR("os_queue_create failed: %d", ret);
-    g_socket_thread_init_in_progress.store(false, std::memory_order_release);
-    return false;
+  pw::async2::Poll<pw::Status> poll = PendRequest(cx);
+  if (poll.IsPending()) {
+    return pw::async2::Pending();
   }
-
-  // Create socket thread with 4KB stack
-  ret = os_thread_create(&g_socket_thread, "socket", OS_THREAD_PRIORITY_DEFAULT,
-                         SocketThreadMain, nullptr, 4096);
-  if (ret != 0) {
-    PW_LOG_ERROR("os_thread_create failed: %d", ret);
-    // Clean up queue on failure
-    // Note: Device OS doesn't have os_queue_destroy, so we leak it
-    g_socket_thread_init_in_progress.store(false, std::memory_order_release);
-    return false;
+  if (!poll->ok()) {
+    return pw::async2::Ready(pw::StatusWithSize(*poll, 0));
   }
+  return pw::async2::Ready(socket_->FinishRead(request_));
+}
 
-  g_socket_thread_started.store(true, std::memory_order_release);
-  return true;
+TcpWriteFuture::TcpWriteFuture(ParticleTcpSocket* socket,
+                               pw::ConstByteSpan data)
+    : SocketFuture(socket, SocketOp::kSend) {
+  request_.send_data = data.data();
+  request_.send_size = data.size();
 }
 
-}  // namespace
+pw::async2::Poll<pw::Status> TcpWriteFuture::Pend(pw::async2::Context& cx) {
+  if (socket_ != nullptr && !queued() && !is_complete() &&
+      socket_->IsConnected()) {
+    const pw::ConstByteSpan data(
+        static_cast<const std::byte*>(request_.send_data), request_.send_size);
+    if (pw::Status status =
+            socket_->StageWrite(pw::span<const pw::ConstByteSpan>(&data, 1));
+        !status.IsResourceExhausted()) {
+      MarkFinished();
+      return pw::async2::Ready(status);
+    }
+  }
+  pw::async2::Poll<pw::Status> poll = PendRequest(cx);
+  if (poll.IsPending()) {
+    return pw::async2::Pending();
+  }
+  if (!poll->ok()) {
+    return poll;
+  }
+  return pw::async2::Ready(socket_->FinishWrite(request_));
+}
 
 // ============================================================================
-// ParticleTcpSocket Implementation
+// ParticleTcpListener Implementation
 // ============================================================================
 
-ParticleTcpSocket::ParticleTcpSocket(const TcpConfig& config)
+ParticleTcpListener::ParticleTcpListener(const TcpListenerConfig& config)
     : config_(config) {}
 
-ParticleTcpSocket::~ParticleTcpSocket() { Disconnect(); }
+ParticleTcpListener::~ParticleTcpListener() { Close(); }
 
-pw::Status ParticleTcpSocket::Connect() {
-  TcpState current_state = state_.load(std::memory_order_acquire);
-  if (current_state == TcpState::kConnected) {
+pw::Status ParticleTcpListener::Listen() {
+  std::lock_guard lock(control_request_.lock);
+  if (is_listening()) {
     return pw::Status::FailedPrecondition();
   }
-
   if (!EnsureSocketThreadStarted()) {
     last_error_.store(ENOMEM, std::memory_order_release);
     return pw::Status::Internal();
   }
 
-  state_.store(TcpState::kConnecting, std::memory_order_release);
-
-  // Queue connect request to socket thread
-  pw::sync::BinarySemaphore done;
-  SocketRequest req{};
-  req.op = SocketOp::kConnect;
-  req.socket_fd = socket_fd_.load(std::memory_order_acquire);
-  req.state = state_.load(std::memory_order_acquire);
-  req.last_error = last_error_.load(std::memory_order_acquire);
-  req.host = config_.host;
+  SocketRequest& req = control_request_.request;
+  req = SocketRequest{};
+  req.op = SocketOp::kListen;
   req.port = config_.port;
-  req.connect_timeout_ms = config_.connect_timeout_ms;
-  req.read_timeout_ms = config_.read_timeout_ms;
-  req.done = &done;
+  req.backlog = config_.backlog;
+  req.socket_fd = -1;
+  Execute(control_request_);
 
-  SocketRequest* req_ptr = &req;
-  os_queue_put(g_socket_queue, &req_ptr, CONCURRENT_WAIT_FOREVER, nullptr);
-  done.acquire();
-
-  // Store results atomically
-  socket_fd_.store(req.socket_fd, std::memory_order_release);
-  state_.store(req.state, std::memory_order_release);
   last_error_.store(req.last_error, std::memory_order_release);
-
   if (req.result < 0) {
-    if (req.error_code == ETIMEDOUT) {
-      return pw::Status::DeadlineExceeded();
-    }
     return pw::Status::Unavailable();
   }
-
+  listen_fd_.store(req.socket_fd, std::memory_order_release);
   return pw::OkStatus();
 }
 
-void ParticleTcpSocket::Disconnect() {
-  int fd = socket_fd_.load(std::memory_order_acquire);
-  TcpState current_state = state_.load(std::memory_order_acquire);
-  if (fd < 0 && current_state == TcpState::kDisconnected) {
-    return;
-  }
-
-  if (!EnsureSocketThreadStarted()) {
-    // Can't start thread, just mark as disconnected
-    socket_fd_.store(-1, std::memory_order_release);
-    state_.store(TcpState::kDisconnected, std::memory_order_release);
+void ParticleTcpListener::Close() {
+  std::lock_guard lock(control_request_.lock);
+  const int fd = listen_fd_.exchange(-1, std::memory_order_acq_rel);
+  if (fd < 0) {
     return;
   }
 
-  pw::sync::BinarySemaphore done;
-  SocketRequest req{};
+  // Also completes the accepts still waiting on the socket
+  SocketRequest& req = control_request_.request;
+  req = SocketRequest{};
   req.op = SocketOp::kDisconnect;
   req.socket_fd = fd;
-  req.state = current_state;
-  req.last_error = last_error_.load(std::memory_order_acquire);
-  req.done = &done;
+  req.state = TcpState::kConnected;
+  Execute(control_request_);
+}
 
-  SocketRequest* req_ptr = &req;
-  os_queue_put(g_socket_queue, &req_ptr, CONCURRENT_WAIT_FOREVER, nullptr);
-  done.acquire();
+pw::Status ParticleTcpListener::Accept(ParticleTcpSocket& socket) {
+  std::lock_guard lock(accept_request_.lock);
+  SocketRequest& req = accept_request_.request;
+  req = SocketRequest{};
+  PW_TRY(PrepareAccept(socket, req));
+  Execute(accept_request_);
+  return FinishAccept(socket, req);
+}
 
-  // Store results atomically
-  socket_fd_.store(req.socket_fd, std::memory_order_release);
-  state_.store(req.state, std::memory_order_release);
+pw::Status ParticleTcpListener::PrepareAccept(ParticleTcpSocket& socket,
+                                              SocketRequest& req) {
+  // The socket thread is running: it created the listening socket
+  const int fd = listen_fd_.load(std::memory_order_acquire);
+  if (fd < 0 || socket.socket_fd() >= 0) {
+    return pw::Status::FailedPrecondition();
+  }
+  // Claim the socket so a concurrent Connect() or Accept() fails
+  TcpState expected = socket.state();
+  if (expected == TcpState::kConnecting || expected == TcpState::kConnected ||
+      !socket.state_.compare_exchange_strong(expected, TcpState::kConnecting,
+                                             std::memory_order_acq_rel)) {
+    return pw::Status::FailedPrecondition();
+  }
+
+  req.op = SocketOp::kAccept;
+  req.socket_fd = fd;
+  req.read_timeout_ms = config_.accept_timeout_ms;
+  req.wait_for_data = true;
+  req.buffers = (socket.rx_buffered() || socket.tx_buffered())
+                    ? &socket.buffers_
+                    : nullptr;
+  req.state = TcpState::kDisconnected;
+  req.last_error = 0;
+  return pw::OkStatus();
+}
+
+pw::Status ParticleTcpListener::FinishAccept(ParticleTcpSocket& socket,
+                                             const SocketRequest& req) {
   last_error_.store(req.last_error, std::memory_order_release);
+  if (req.result < 0) {
+    socket.state_.store(TcpState::kDisconnected, std::memory_order_release);
+    switch (req.error_code) {
+      case ETIMEDOUT:
+        return pw::Status::DeadlineExceeded();
+      case EAGAIN:
+        return pw::Status::ResourceExhausted();
+      case ENOTCONN:
+        return pw::Status::FailedPrecondition();
+      default:
+        return pw::Status::Internal();
+    }
+  }
+
+  socket.socket_fd_.store(static_cast<int>(req.result),
+                          std::memory_order_release);
+  socket.last_error_.store(0, std::memory_order_release);
+  socket.state_.store(TcpState::kConnected, std::memory_order_release);
+  return pw::OkStatus();
 }
 
-bool ParticleTcpSocket::IsConnected() const {
-  return state_.load(std::memory_order_acquire) == TcpState::kConnected &&
-         socket_fd_.load(std::memory_order_acquire) >= 0;
+TcpAcceptFuture::TcpAcceptFuture(ParticleTcpListener* listener,
+                                 ParticleTcpSocket* socket)
+    : SocketFuture(socket, SocketOp::kAccept) {
+  listener_ = listener;
 }
 
-pw::StatusWithSize ParticleTcpSocket::Read(pw::ByteSpan dest) {
-  PW_LOG_DEBUG("Read: checking connection state");
-  if (!IsConnected()) {
-    PW_LOG_WARN("Read: not connected");
-    last_error_.store(ENOTCONN, std::memory_order_release);
-    return pw::StatusWithSize::FailedPrecondition();
+pw::async2::Poll<pw::Status> TcpAcceptFuture::Pend(pw::async2::Context& cx) {
+  pw::async2::Poll<pw::Status> poll = PendRequest(cx);
+  if (poll.IsPending()) {
+    return pw::async2::Pending();
+  }
+  if (!poll->ok()) {
+    return poll;
   }
+  return pw::async2::Ready(listener_->FinishAccept(*socket_, request_));
+}
+
+// ============================================================================
+// ParticleUdpSocket Implementation
+// ============================================================================
+
+ParticleUdpSocket::ParticleUdpSocket(const UdpConfig& config)
+    : config_(config) {}
 
+ParticleUdpSocket::~ParticleUdpSocket() { Close(); }
+
+pw::Status ParticleUdpSocket::Open() {
+  std::lock_guard lock(control_request_.lock);
+  if (IsOpen()) {
+    return pw::Status::FailedPrecondition();
+  }
   if (!EnsureSocketThreadStarted()) {
-    PW_LOG_ERROR("Read: socket thread not started");
     last_error_.store(ENOMEM, std::memory_order_release);
-    return pw::StatusWithSize::Internal();
+    return pw::Status::Internal();
   }
 
-  pw::sync::BinarySemaphore done;
-  SocketRequest req{};
-  req.op = SocketOp::kRecv;
-  req.socket_fd = socket_fd_.load(std::memory_order_acquire);
-  req.state = state_.load(std::memory_order_acquire);
-  req.last_error = last_error_.load(std::memory_order_acquire);
-  req.recv_buffer = dest.data();
-  req.recv_size = dest.size();
-  req.done = &done;
-
-  PW_LOG_DEBUG("Read: queuing recv request fd=%d size=%zu", req.socket_fd,
-               req.recv_size);
-  SocketRequest* req_ptr = &req;
-  os_queue_put(g_socket_queue, &req_ptr, CONCURRENT_WAIT_FOREVER, nullptr);
-  PW_LOG_DEBUG("Read: waiting for completion");
-  done.acquire();
-  PW_LOG_DEBUG("Read: completed result=%zd err=%d", req.result, req.error_code);
+  SocketRequest& req = control_request_.request;
+  req = SocketRequest{};
+  req.op = SocketOp::kUdpOpen;
+  req.host = config_.host;
+  req.port = config_.port;
+  req.local_port = config_.local_port;
+  req.socket_fd = -1;
+  Execute(control_request_);
 
-  // Store results atomically
-  state_.store(req.state, std::memory_order_release);
   last_error_.store(req.last_error, std::memory_order_release);
-
   if (req.result < 0) {
-    if (req.error_code == EAGAIN || req.error_code == EWOULDBLOCK) {
-      return pw::StatusWithSize(0);
-    }
-    return pw::StatusWithSize::Internal();
+    return pw::Status::Unavailable();
   }
+  peer_ = config_.host != nullptr
+              ? UdpEndpoint{.addr = req.resolved_addr, .port = config_.port}
+              : UdpEndpoint{};
+  socket_fd_.store(req.socket_fd, std::memory_order_release);
+  return pw::OkStatus();
+}
 
-  if (req.result == 0) {
-    // Connection closed by peer
-    return pw::StatusWithSize::OutOfRange();
+void ParticleUdpSocket::Close() {
+  std::lock_guard lock(control_request_.lock);
+  const int fd = socket_fd_.exchange(-1, std::memory_order_acq_rel);
+  if (fd < 0) {
+    return;
   }
 
-  return pw::StatusWithSize(static_cast<size_t>(req.result));
+  // Also completes a RecvFrom() still waiting on the socket
+  SocketRequest& req = control_request_.request;
+  req = SocketRequest{};
+  req.op = SocketOp::kDisconnect;
+  req.socket_fd = fd;
+  req.state = TcpState::kConnected;
+  Execute(control_request_);
 }
 
-pw::Status ParticleTcpSocket::Write(pw::ConstByteSpan data) {
-  if (!IsConnected()) {
+pw::Status ParticleUdpSocket::PrepareRequest(SocketOp op, SocketRequest& req) {
+  // Open() started the socket thread
+  req.op = op;
+  req.socket_fd = socket_fd_.load(std::memory_order_acquire);
+  if (req.socket_fd < 0) {
     last_error_.store(ENOTCONN, std::memory_order_release);
     return pw::Status::FailedPrecondition();
   }
+  req.read_timeout_ms = config_.read_timeout_ms;
+  req.state = TcpState::kConnected;
+  req.last_error = last_error_.load(std::memory_order_acquire);
+  return pw::OkStatus();
+}
 
-  if (!EnsureSocketThreadStarted()) {
-    last_error_.store(ENOMEM, std::memory_order_release);
-    return pw::Status::Internal();
+pw::Status ParticleUdpSocket::SendTo(const UdpEndpoint& to,
+                                     pw::ConstByteSpan data) {
+  const UdpDatagram datagram{.to = to, .data = data};
+  return SendBatch(pw::span<const UdpDatagram>(&datagram, 1)).status();
+}
+
+pw::StatusWithSize ParticleUdpSocket::SendBatch(
+    pw::span<const UdpDatagram> datagrams) {
+  std::lock_guard lock(send_request_.lock);
+  SocketRequest& req = send_request_.request;
+  req = SocketRequest{};
+  if (pw::Status status = PrepareRequest(SocketOp::kSendTo, req);
+      !status.ok()) {
+    return pw::StatusWithSize(status, 0);
   }
+  req.datagrams = datagrams;
+  Execute(send_request_);
 
-  pw::sync::BinarySemaphore done;
-  SocketRequest req{};
-  req.op = SocketOp::kSend;
-  req.socket_fd = socket_fd_.load(std::memory_order_acquire);
-  req.state = state_.load(std::memory_order_acquire);
-  req.last_error = last_error_.load(std::memory_order_acquire);
-  req.send_data = data.data();
-  req.send_size = data.size();
-  req.done = &done;
+  last_error_.store(req.last_error, std::memory_order_release);
+  const size_t sent = static_cast<size_t>(req.result);
+  if (sent > 0 || req.error_code == 0) {
+    return pw::StatusWithSize(sent);
+  }
+  // Out of pbufs: worth retrying later
+  if (req.error_code == ENOMEM || req.error_code == ENOBUFS ||
+      req.error_code == EAGAIN || req.error_code == EWOULDBLOCK) {
+    return pw::StatusWithSize::ResourceExhausted();
+  }
+  return pw::StatusWithSize::Internal();
+}
 
-  SocketRequest* req_ptr = &req;
-  os_queue_put(g_socket_queue, &req_ptr, CONCURRENT_WAIT_FOREVER, nullptr);
-  done.acquire();
+pw::StatusWithSize ParticleUdpSocket::RecvFrom(pw::ByteSpan dest,
+                                               UdpEndpoint* from) {
+  std::lock_guard lock(recv_request_.lock);
+  SocketRequest& req = recv_request_.request;
+  req = SocketRequest{};
+  if (pw::Status status = PrepareRequest(SocketOp::kRecvFrom, req);
+      !status.ok()) {
+    return pw::StatusWithSize(status, 0);
+  }
+  req.recv_buffer = dest.data();
+  req.recv_size = dest.size();
+  req.from = from;
+  req.wait_for_data = config_.read_timeout_ms > 0;
+  Execute(recv_request_);
 
-  // Store results atomically
-  state_.store(req.state, std::memory_order_release);
   last_error_.store(req.last_error, std::memory_order_release);
-
   if (req.result < 0) {
-    return pw::Status::Internal();
+    if (req.error_code == EAGAIN || req.error_code == EWOULDBLOCK) {
+      return pw::StatusWithSize(0);
+    }
+    if (req.error_code == ENOTCONN) {
+      // Closed while waiting for a datagram
+      return pw::StatusWithSize::FailedPrecondition();
+    }
+    return pw::StatusWithSize::Internal();
   }
-
-  return pw::OkStatus();
+  return pw::StatusWithSize(static_cast<size_t>(req.result));
 }
 
 }  // namespace pb::socket
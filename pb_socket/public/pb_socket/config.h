@@ -0,0 +1,56 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Configuration options for pb_socket
+
+// Stacks of the shared socket worker thread ("socket") and the DNS
+// resolver thread ("dns"). Measure with a stack report
+// (pb_integration_tests/harness/stack_report.py) before shrinking them.
+#ifndef PB_SOCKET_CONFIG_WORKER_STACK_SIZE
+#define PB_SOCKET_CONFIG_WORKER_STACK_SIZE 4096
+#endif
+
+#ifndef PB_SOCKET_CONFIG_RESOLVER_STACK_SIZE
+#define PB_SOCKET_CONFIG_RESOLVER_STACK_SIZE 3072
+#endif
+
+namespace pb::socket::config {
+
+// Maximum number of reads that wait for data at the same time
+// (ReadAsync(), or Read() with TcpConfig::read_timeout_ms set). Further reads
+// return 0 bytes immediately.
+inline constexpr size_t kMaxParkedReads = 8;
+
+// Maximum number of connected buffered sockets (ParticleTcpSocketWithBuffers)
+// the socket thread reads ahead for. Further sockets read unbuffered.
+inline constexpr size_t kMaxBufferedSockets = 4;
+
+// Longest time a queued request waits while the socket thread polls sockets
+// with waiting reads or read-ahead space. Shorter values lower request
+// latency at the cost of more wakeups while sockets are polled.
+inline constexpr uint32_t kPollIntervalMs = 10;
+
+// Default TcpListenerConfig::backlog: connections LwIP holds until they are
+// accepted.
+inline constexpr int kListenBacklog = 2;
+
+// Stack size of the shared socket worker thread ("socket").
+inline constexpr size_t kWorkerStackSize = PB_SOCKET_CONFIG_WORKER_STACK_SIZE;
+
+// Stack size of the DNS resolver thread ("dns").
+inline constexpr size_t kResolverStackSize =
+    PB_SOCKET_CONFIG_RESOLVER_STACK_SIZE;
+
+// Number of hostnames whose IPv4 address is cached, how long a result is
+// reused (LwIP doesn't expose record TTLs), and the longest cacheable
+// hostname including its terminator.
+inline constexpr size_t kDnsCacheSize = 4;
+inline constexpr uint32_t kDnsCacheTtlMs = 5 * 60 * 1000;
+inline constexpr size_t kDnsMaxHostLength = 64;
+
+}  // namespace pb::socket::config
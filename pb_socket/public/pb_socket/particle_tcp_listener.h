@@ -0,0 +1,140 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file particle_tcp_listener.h
+/// @brief TCP server socket on top of the ParticleTcpSocket worker thread.
+///
+/// The listening socket lives on the shared socket thread like every other
+/// socket. Accepted connections are handed to a caller-provided, disconnected
+/// ParticleTcpSocket, which then behaves exactly as if it had connected
+/// itself (including its staging buffers), so no sockets are allocated.
+
+#include <atomic>
+#include <cstdint>
+
+#include "pb_socket/config.h"
+#include "pb_socket/particle_tcp_socket.h"
+#include "pw_async2/context.h"
+#include "pw_async2/poll.h"
+#include "pw_status/status.h"
+
+namespace pb::socket {
+
+/// Configuration for a ParticleTcpListener.
+struct TcpListenerConfig {
+  /// Local port to listen on
+  uint16_t port = 0;
+  /// Connections LwIP completes and holds until accepted. Further
+  /// connection attempts are refused.
+  int backlog = config::kListenBacklog;
+  /// How long Accept() waits for a connection (0 = wait indefinitely)
+  uint32_t accept_timeout_ms = 0;
+};
+
+/// Future returned by ParticleTcpListener::AcceptAsync().
+class TcpAcceptFuture : public internal::SocketFuture {
+ public:
+  using value_type = pw::Status;
+
+  TcpAcceptFuture() = default;
+  TcpAcceptFuture(TcpAcceptFuture&&) noexcept = default;
+  TcpAcceptFuture& operator=(TcpAcceptFuture&&) noexcept = default;
+
+  /// Same results as ParticleTcpListener::Accept().
+  pw::async2::Poll<pw::Status> Pend(pw::async2::Context& cx);
+
+ private:
+  friend class ParticleTcpListener;
+  TcpAcceptFuture(ParticleTcpListener* listener, ParticleTcpSocket* socket);
+};
+
+/// Listening TCP socket.
+///
+/// Usage:
+/// @code
+///   pb::socket::ParticleTcpListener listener({.port = 8111});
+///   PW_TRY(listener.Listen());
+///
+///   pb::socket::ParticleTcpSocketWithBuffers<1460, 512> client({});
+///   if (listener.Accept(client).ok()) {
+///     // Serve pw_rpc over TcpSocketStreamAdapter(client) ...
+///     client.Disconnect();
+///   }
+/// @endcode
+///
+/// Each accept waiting for a connection takes one of the socket thread's
+/// config::kMaxParkedReads slots.
+class ParticleTcpListener {
+ public:
+  explicit ParticleTcpListener(const TcpListenerConfig& config);
+
+  /// Destructor - closes the listening socket.
+  ~ParticleTcpListener();
+
+  ParticleTcpListener(const ParticleTcpListener&) = delete;
+  ParticleTcpListener& operator=(const ParticleTcpListener&) = delete;
+  ParticleTcpListener(ParticleTcpListener&&) = delete;
+  ParticleTcpListener& operator=(ParticleTcpListener&&) = delete;
+
+  /// Binds to config.port on all interfaces and starts listening.
+  /// @returns
+  ///   - OK on success
+  ///   - FailedPrecondition if already listening
+  ///   - Unavailable if the socket can't be created, bound or listened on
+  ///     (see last_error())
+  ///   - Internal if the socket thread can't be started
+  pw::Status Listen();
+
+  /// Stops listening. Waiting accepts complete with FailedPrecondition;
+  /// sockets accepted earlier stay connected.
+  void Close();
+
+  bool is_listening() const {
+    return listen_fd_.load(std::memory_order_acquire) >= 0;
+  }
+
+  /// errno of the last failed Listen() or Accept().
+  int last_error() const {
+    return last_error_.load(std::memory_order_acquire);
+  }
+
+  /// Waits for the next connection and hands it to `socket`, which must not
+  /// be connected.
+  /// @returns
+  ///   - OK once `socket` is connected to the peer
+  ///   - FailedPrecondition if not listening, closed while waiting, or
+  ///     `socket` is connected
+  ///   - DeadlineExceeded if config.accept_timeout_ms passed first
+  ///   - ResourceExhausted if config::kMaxParkedReads operations already
+  ///     wait on the socket thread
+  ///   - Internal on other accept errors (see last_error())
+  pw::Status Accept(ParticleTcpSocket& socket);
+
+  /// Async variant of Accept(). `socket` must stay valid until the future
+  /// completes.
+  TcpAcceptFuture AcceptAsync(ParticleTcpSocket& socket) {
+    return TcpAcceptFuture(this, &socket);
+  }
+
+ private:
+  friend class internal::SocketFuture;
+  friend class TcpAcceptFuture;
+
+  // Like ParticleTcpSocket::PrepareRequest(), for accepting into `socket`.
+  pw::Status PrepareAccept(ParticleTcpSocket& socket,
+                           internal::SocketRequest& req);
+
+  // Hands an accepted connection to `socket` and maps the result.
+  pw::Status FinishAccept(ParticleTcpSocket& socket,
+                          const internal::SocketRequest& req);
+
+  TcpListenerConfig config_;
+  internal::BlockingRequest control_request_;  // Listen()/Close()
+  internal::BlockingRequest accept_request_;
+  std::atomic<int> listen_fd_{-1};
+  std::atomic<int> last_error_{0};
+};
+
+}  // namespace pb::socket
@@ -13,19 +13,317 @@
 ///
 /// Architecture:
 /// - All sock_* HAL calls are executed on a dedicated socket thread
-/// - Public methods queue requests to the socket thread and wait for completion
-/// - A global thread/queue is shared by all ParticleTcpSocket instances
+/// - Reads that wait for data are parked on the socket thread, which
+///   sock_poll()s all of their sockets at once and completes each read as
+///   soon as its data arrives
+/// - Blocking methods hand a preallocated per-socket request to the socket
+///   thread and wait on its reusable notification
+/// - ConnectAsync()/ReadAsync()/WriteAsync() return pw_async2 futures that the
+///   socket thread completes and wakes, so dispatcher tasks never block
+/// - A global thread and request list is shared by all ParticleTcpSocket
+///   instances
+/// - Hostnames are resolved on a separate "dns" thread and cached, so a slow
+///   lookup doesn't hold up other sockets and reconnects skip resolution
 ///
 /// Thread Safety:
 /// - Safe to call from any thread (operations are serialized through the queue)
 /// - State accessors use atomic variables for thread-safe reads
 
+#include <sys/types.h>
+
+#include <array>
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 
 #include "pb_socket/tcp_socket.h"
+#include "pb_socket/udp_socket.h"
+#include "pw_async2/context.h"
+#include "pw_async2/poll.h"
+#include "pw_async2/waker.h"
+#include "pw_bytes/span.h"
+#include "pw_metric/metric.h"
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_sync/binary_semaphore.h"
+#include "pw_sync/mutex.h"
+#include "pw_sync/thread_notification.h"
 
 namespace pb::socket {
 
+class ParticleTcpListener;
+class ParticleTcpSocket;
+
+namespace internal {
+
+class SocketFuture;
+struct SocketBuffers;
+
+enum class SocketOp {
+  kConnect,
+  kDisconnect,
+  kSend,
+  kRecv,
+  kFlush,   // Send the staged TX bytes; fire-and-forget
+  kListen,  // socket_fd: the new listening socket
+  kAccept,  // socket_fd: listening socket; result: the accepted socket
+  kUdpOpen,
+  kSendTo,    // result: number of datagrams sent
+  kRecvFrom,
+};
+
+/// Operation handed to the socket worker thread. Lives in the socket for
+/// blocking calls and inside the future for async calls.
+struct SocketRequest {
+  SocketOp op;
+  SocketRequest* next;  // Link in the worker's request list
+
+  // For Connect (host, port), Listen (port, backlog) and UdpOpen (host,
+  // port, local_port)
+  const char* host;
+  uint16_t port;
+  int backlog;
+  uint16_t local_port;
+  uint32_t connect_timeout_ms;
+  uint32_t read_timeout_ms;
+  uint32_t resolved_addr;  // IPv4, network order; set by the resolver thread
+  bool addr_resolved;
+
+  // For Send: send_chunks (WriteV) if non-empty, else send_data.
+  // send_size is the total either way.
+  const void* send_data;
+  size_t send_size;
+  pw::span<const pw::ConstByteSpan> send_chunks;
+
+  // For Recv: recv_chunks (ReadV) if non-empty, else recv_buffer
+  void* recv_buffer;
+  size_t recv_size;
+  pw::span<const pw::ByteSpan> recv_chunks;
+  bool wait_for_data;    // Park until readable instead of returning EAGAIN
+  uint32_t deadline_ms;  // Set by the socket thread when parking
+
+  uint32_t queued_at_us;  // Set when pushed to the worker, for WorkerStats()
+
+  // For SendTo (datagrams) and RecvFrom (recv_buffer, recv_size, from)
+  pw::span<const UdpDatagram> datagrams;
+  UdpEndpoint* from;  // Sender of the received datagram, if not null
+
+  // Input/output state (caller provides current values, socket thread updates)
+  int socket_fd;
+  TcpState state;
+  int last_error;
+
+  // Staging buffers of the socket, or nullptr if unbuffered
+  SocketBuffers* buffers;
+
+  // Result
+  ssize_t result;
+  int error_code;
+
+  // Completion signal: at most one of these is set (none for kFlush)
+  pw::sync::ThreadNotification* done;  // Blocking callers
+  SocketFuture* future;                // Async callers
+};
+
+/// Request slot for the blocking calls of one kind (connection, reads or
+/// writes). Reused for every call, so the hot path constructs no request or
+/// semaphore; `lock` lets one caller at a time use it.
+struct BlockingRequest {
+  pw::sync::Mutex lock;
+  pw::sync::ThreadNotification done;
+  SocketRequest request{};
+};
+
+/// RX read-ahead ring and TX staging buffer of a buffered ParticleTcpSocket.
+///
+/// The socket thread fills the RX ring while the socket is readable and
+/// nobody waits on it; callers copy out of it without a worker round-trip.
+/// Callers append small writes to the TX buffer and the socket thread sends
+/// them with one sock_send. Counters are protected by `lock`; the ring region
+/// being filled and the TX bytes being sent are only touched by the socket
+/// thread.
+struct SocketBuffers {
+  /// Copies up to dest.size() read-ahead bytes. Returns the number copied.
+  size_t ReadRx(pw::ByteSpan dest);
+
+  /// Fills `dest` buffers in order from the read-ahead bytes.
+  size_t ReadRx(pw::span<const pw::ByteSpan> dest);
+
+  pw::sync::Mutex lock;
+
+  pw::ByteSpan rx;
+  size_t rx_head = 0;   // First unread byte
+  size_t rx_count = 0;  // Unread bytes
+  int fd = -1;          // Socket thread only
+  bool rx_eof = false;  // Socket thread only: stop reading ahead
+
+  pw::ByteSpan tx;
+  size_t tx_used = 0;            // Staged bytes at the start of tx
+  bool tx_flush_queued = false;  // tx_request queued or flush in progress
+  int tx_error = 0;              // errno of a failed staged send, if any
+  uint32_t tx_staged_at_ms = 0;  // When tx_used last became non-zero
+  size_t tx_batch_bytes = 0;     // WriteBatching::min_bytes
+  uint32_t tx_batch_delay_ms = 0;  // WriteBatching::max_delay_ms
+  SocketRequest tx_request{};
+};
+
+/// Common part of the ParticleTcpSocket futures.
+///
+/// Owns the SocketRequest handed to the socket thread. The request is queued
+/// on the first Pend() and the socket thread wakes the task when it is done.
+/// A future may only be moved before it is first polled. Destroying a future
+/// whose request is still queued blocks until the socket thread finishes it.
+class SocketFuture {
+ public:
+  ~SocketFuture();
+
+  SocketFuture(const SocketFuture&) = delete;
+  SocketFuture& operator=(const SocketFuture&) = delete;
+
+  /// Returns true if the future has completed.
+  [[nodiscard]] bool is_complete() const { return finished_; }
+
+  /// Called by the socket thread once the request has been executed.
+  void OnRequestDone();
+
+ protected:
+  /// True once the request has been handed to the socket thread.
+  [[nodiscard]] bool queued() const { return queued_; }
+
+  /// Completes the future without queueing a request (for results served
+  /// from the socket's staging buffers).
+  void MarkFinished() { finished_ = true; }
+
+  SocketFuture() = default;
+  SocketFuture(ParticleTcpSocket* socket, SocketOp op);
+  SocketFuture(SocketFuture&& other) noexcept;
+  SocketFuture& operator=(SocketFuture&& other) noexcept;
+
+  /// Queues the request on the first call, then returns Ready once the socket
+  /// thread has executed it. Returns Ready with an error if the request could
+  /// not be queued. Ready is returned at most once.
+  pw::async2::Poll<pw::Status> PendRequest(pw::async2::Context& cx);
+
+  ParticleTcpSocket* socket_ = nullptr;
+  ParticleTcpListener* listener_ = nullptr;  // Accepting into socket_
+  SocketRequest request_{};
+
+ private:
+  void MoveFrom(SocketFuture& other);
+
+  pw::sync::Mutex lock_;
+  pw::async2::Waker waker_;         // Protected by lock_
+  bool request_done_ = false;       // Protected by lock_
+  bool queued_ = false;
+  bool finished_ = false;
+  pw::sync::BinarySemaphore released_;  // Released once the thread is done
+};
+
+}  // namespace internal
+
+/// Nagle-style batching of staged writes (see
+/// ParticleTcpSocket::set_write_batching()).
+struct WriteBatching {
+  /// Send once this many bytes are staged. 0 sends every write right away.
+  size_t min_bytes = 0;
+  /// Send staged bytes at the latest this long after the first of them was
+  /// written. 0 waits for min_bytes, Flush() or a write that doesn't fit.
+  uint32_t max_delay_ms = 0;
+};
+
+/// Buckets of the SocketWorkerStats latency histograms: < 100 us, < 1 ms,
+/// < 10 ms, < 100 ms, < 1 s and >= 1 s.
+inline constexpr size_t kSocketLatencyBuckets = 6;
+
+/// Counters of the shared socket thread (see ParticleTcpSocket::WorkerStats()).
+///
+/// Execution time is what the socket thread spends handling a request, which
+/// includes waiting for LwIP's lock_tcpip_core inside the sock_* calls. Long
+/// sends and receives next to short queue waits point at lock contention;
+/// long queue waits at the single thread being saturated. Reads and accepts
+/// parked until their socket is readable count their first attempt only.
+struct SocketWorkerStats {
+  uint32_t requests = 0;          ///< Requests taken from the queue
+  uint32_t queue_depth = 0;       ///< Requests waiting right now
+  uint32_t queue_depth_peak = 0;  ///< Most requests waiting at once
+  uint32_t queue_wait_max_us = 0;
+  std::array<uint32_t, kSocketLatencyBuckets> queue_wait_us{};
+  uint32_t exec_max_us = 0;
+  std::array<uint32_t, kSocketLatencyBuckets> exec_us{};
+
+  // Requests by operation
+  uint32_t connects = 0;
+  uint32_t disconnects = 0;
+  uint32_t sends = 0;  ///< Write()/WriteV()/WriteAsync()
+  uint32_t recvs = 0;  ///< Reads that needed the socket thread
+  uint32_t flushes = 0;
+  uint32_t listens = 0;
+  uint32_t accepts = 0;
+  uint32_t udp_opens = 0;
+  uint32_t send_tos = 0;  ///< ParticleUdpSocket sends (batches count once)
+  uint32_t recv_froms = 0;
+
+  uint32_t send_eagain_retries = 0;  ///< Waits for a full LwIP send buffer
+  uint32_t bytes_sent = 0;           ///< TCP and UDP payload bytes
+  uint32_t bytes_received = 0;       ///< Including read-ahead
+};
+
+/// Future returned by ParticleTcpSocket::ConnectAsync().
+class TcpConnectFuture : public internal::SocketFuture {
+ public:
+  using value_type = pw::Status;
+
+  TcpConnectFuture() = default;
+  TcpConnectFuture(TcpConnectFuture&&) noexcept = default;
+  TcpConnectFuture& operator=(TcpConnectFuture&&) noexcept = default;
+
+  /// Same results as ParticleTcpSocket::Connect().
+  pw::async2::Poll<pw::Status> Pend(pw::async2::Context& cx);
+
+ private:
+  friend class ParticleTcpSocket;
+  explicit TcpConnectFuture(ParticleTcpSocket* socket);
+};
+
+/// Future returned by ParticleTcpSocket::ReadAsync().
+class TcpReadFuture : public internal::SocketFuture {
+ public:
+  using value_type = pw::StatusWithSize;
+
+  TcpReadFuture() = default;
+  TcpReadFuture(TcpReadFuture&&) noexcept = default;
+  TcpReadFuture& operator=(TcpReadFuture&&) noexcept = default;
+
+  /// Completes as soon as data arrives, with the same results as
+  /// ParticleTcpSocket::Read(). Returns 0 bytes if TcpConfig::read_timeout_ms
+  /// is set and expires first, or if config::kMaxParkedReads reads already
+  /// wait.
+  pw::async2::Poll<pw::StatusWithSize> Pend(pw::async2::Context& cx);
+
+ private:
+  friend class ParticleTcpSocket;
+  TcpReadFuture(ParticleTcpSocket* socket, pw::ByteSpan dest);
+};
+
+/// Future returned by ParticleTcpSocket::WriteAsync().
+class TcpWriteFuture : public internal::SocketFuture {
+ public:
+  using value_type = pw::Status;
+
+  TcpWriteFuture() = default;
+  TcpWriteFuture(TcpWriteFuture&&) noexcept = default;
+  TcpWriteFuture& operator=(TcpWriteFuture&&) noexcept = default;
+
+  /// Same results as ParticleTcpSocket::Write(). Completes once the whole
+  /// payload has been handed to LwIP.
+  pw::async2::Poll<pw::Status> Pend(pw::async2::Context& cx);
+
+ private:
+  friend class ParticleTcpSocket;
+  TcpWriteFuture(ParticleTcpSocket* socket, pw::ConstByteSpan data);
+};
+
 /// TCP socket implementation using Particle Device OS sockets.
 ///
 /// Uses a dedicated socket worker thread to avoid deadlocks with Particle's
@@ -47,12 +345,36 @@ namespace pb::socket {
 ///   }
 ///   socket.Disconnect();
 /// @endcode
+///
+/// From a pw_async2 coroutine, the async variants don't block the dispatcher:
+/// @code
+///   PW_CO_TRY(co_await socket.ConnectAsync());
+///   PW_CO_TRY(co_await socket.WriteAsync(request));
+///   pw::StatusWithSize result = co_await socket.ReadAsync(buffer);
+/// @endcode
+///
+/// Several read and write futures may be in flight at once; the socket thread
+/// executes them in the order they were first polled. Start data transfers
+/// only after the TcpConnectFuture has completed.
+///
+/// Constructed with staging buffers (or as ParticleTcpSocketWithBuffers), the
+/// socket reads ahead into the RX buffer and stages small writes in the TX
+/// buffer, so byte-sized reads and writes, e.g. from TcpSocketStreamAdapter,
+/// mostly complete without a worker round-trip. A staged write returns OK
+/// before the bytes are sent; a failure to send them is reported by the next
+/// Write().
 class ParticleTcpSocket : public TcpSocket {
  public:
   /// Construct TCP socket with configuration.
   /// The socket worker thread is started lazily on first Connect().
   explicit ParticleTcpSocket(const TcpConfig& config);
 
+  /// Construct a buffered TCP socket. Either buffer may be empty to only
+  /// buffer one direction. The buffers must outlive the socket.
+  ParticleTcpSocket(const TcpConfig& config,
+                    pw::ByteSpan rx_buffer,
+                    pw::ByteSpan tx_buffer);
+
   /// Destructor - disconnects if connected.
   ~ParticleTcpSocket() override;
 
@@ -73,14 +395,108 @@ class ParticleTcpSocket : public TcpSocket {
     return last_error_.load(std::memory_order_acquire);
   }
 
+  /// Returns 0 bytes right away if no data is available, unless
+  /// TcpConfig::read_timeout_ms is set: then waits up to that long for data.
   pw::StatusWithSize Read(pw::ByteSpan dest) override;
   pw::Status Write(pw::ConstByteSpan data) override;
 
+  /// Vectored Read()/Write() in a single socket thread round-trip. Each
+  /// chunk goes to LwIP straight from the caller's buffer (with MSG_MORE on
+  /// all but the last, so they share segments) and received data is copied
+  /// straight into the caller's buffers.
+  pw::Status WriteV(pw::span<const pw::ConstByteSpan> chunks) override;
+  pw::StatusWithSize ReadV(pw::span<const pw::ByteSpan> buffers) override;
+
+  /// Sends the staged TX bytes and waits until they are handed to LwIP.
+  /// Returns the error of a failed staged write, if any.
+  pw::Status Flush() override;
+
+  /// Batch staged writes into fewer, larger TCP segments instead of sending
+  /// each write as soon as the socket thread gets to it. Useful for the many
+  /// tiny frames of pw_rpc streaming. Needs a TX buffer; min_bytes is capped
+  /// at its size. Disabled by default.
+  ///
+  /// @code
+  ///   // Send at 256 bytes or after 5 ms, whichever comes first
+  ///   socket.set_write_batching({.min_bytes = 256, .max_delay_ms = 5});
+  /// @endcode
+  void set_write_batching(const WriteBatching& batching);
+
+  /// Async variants of Connect(), Read() and Write(). The request is queued
+  /// to the socket thread when the future is first polled. The buffers must
+  /// stay valid until the future completes.
+  TcpConnectFuture ConnectAsync() { return TcpConnectFuture(this); }
+  TcpReadFuture ReadAsync(pw::ByteSpan dest) {
+    return TcpReadFuture(this, dest);
+  }
+  TcpWriteFuture WriteAsync(pw::ConstByteSpan data) {
+    return TcpWriteFuture(this, data);
+  }
+
+  /// Drops all cached DNS results, e.g. after switching networks. Hostnames
+  /// are resolved again on the next Connect().
+  static void ClearDnsCache();
+
+  /// True if a network interface is up and has an IP address. Suitable as
+  /// ReconnectPolicy::network_ready.
+  static bool NetworkReady();
+
+  /// Snapshot of the socket thread's counters, shared by all sockets,
+  /// listeners and UDP sockets. Counters are updated by the socket thread
+  /// while it runs, so a snapshot may be slightly inconsistent.
+  static SocketWorkerStats WorkerStats();
+
+  /// Resets the socket thread's counters to zero.
+  static void ResetWorkerStats();
+
+  /// The counters as a pw_metric group ("socket_worker"). Add it to an
+  /// application metric group to export it, e.g. over pw_rpc.
+  static pw::metric::Group& WorkerMetrics();
+
   /// Direct socket fd access for debugging only.
   int socket_fd() const { return socket_fd_.load(std::memory_order_acquire); }
 
  private:
+  friend class internal::SocketFuture;
+  friend class ParticleTcpListener;
+  friend class TcpConnectFuture;
+  friend class TcpReadFuture;
+  friend class TcpWriteFuture;
+
+  // Checks that `op` can be issued and fills in the connection state for the
+  // socket thread. Shared by the blocking and async paths.
+  pw::Status PrepareRequest(internal::SocketOp op,
+                            internal::SocketRequest& req);
+
+  // Store the socket thread's results and map them to the API status.
+  pw::Status FinishConnect(const internal::SocketRequest& req);
+  pw::StatusWithSize FinishRead(const internal::SocketRequest& req);
+  pw::Status FinishWrite(const internal::SocketRequest& req);
+
+  // Returns and clears the error of a failed background flush.
+  pw::Status TakeStagedWriteError();
+
+  // Staging buffer fast paths. ReadBuffered() returns 0 if nothing was read
+  // ahead. StageWrite() returns ResourceExhausted if `data` doesn't fit, or
+  // the error of a previously staged write.
+  size_t ReadBuffered(pw::span<const pw::ByteSpan> dest);
+  pw::Status StageWrite(pw::span<const pw::ConstByteSpan> chunks);
+
+  // Shared by the single-span and vectored entry points
+  pw::StatusWithSize ReadChunks(pw::span<const pw::ByteSpan> buffers);
+  pw::Status WriteChunks(pw::span<const pw::ConstByteSpan> chunks);
+
+  bool rx_buffered() const { return !buffers_.rx.empty(); }
+  bool tx_buffered() const { return !buffers_.tx.empty(); }
+
   TcpConfig config_;
+  internal::SocketBuffers buffers_;
+
+  // Connect()/Disconnect(), Read()/ReadV() and Write()/WriteV()/Flush(), so
+  // a blocked read doesn't hold up writes on the same socket
+  internal::BlockingRequest control_request_;
+  internal::BlockingRequest read_request_;
+  internal::BlockingRequest write_request_;
 
   // Atomic state variables - modified by socket thread, read by public accessors.
   // Uses memory_order_acquire/release for proper synchronization.
@@ -89,4 +505,36 @@ class ParticleTcpSocket : public TcpSocket {
   std::atomic<int> last_error_{0};
 };
 
+namespace internal {
+
+// Storage base of ParticleTcpSocketWithBuffers. Inherited before
+// ParticleTcpSocket so the buffers exist when the socket is handed them.
+template <size_t kRxBufferSize, size_t kTxBufferSize>
+struct TcpSocketBuffers {
+  std::array<std::byte, kRxBufferSize> rx_storage{};
+  std::array<std::byte, kTxBufferSize> tx_storage{};
+};
+
+}  // namespace internal
+
+/// ParticleTcpSocket with inline RX/TX staging buffers.
+///
+/// Size the RX buffer for a typical burst (e.g. one RPC response) and the TX
+/// buffer for the frames written back-to-back between two worker passes.
+///
+/// @code
+///   // pw_rpc over HDLC: read ahead a full TCP segment, stage small frames
+///   pb::socket::ParticleTcpSocketWithBuffers<1460, 512> socket(config);
+/// @endcode
+template <size_t kRxBufferSize, size_t kTxBufferSize = kRxBufferSize>
+class ParticleTcpSocketWithBuffers
+    : private internal::TcpSocketBuffers<kRxBufferSize, kTxBufferSize>,
+      public ParticleTcpSocket {
+  using Buffers = internal::TcpSocketBuffers<kRxBufferSize, kTxBufferSize>;
+
+ public:
+  explicit ParticleTcpSocketWithBuffers(const TcpConfig& config)
+      : ParticleTcpSocket(config, Buffers::rx_storage, Buffers::tx_storage) {}
+};
+
 }  // namespace pb::socket
@@ -0,0 +1,88 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file particle_udp_socket.h
+/// @brief UDP socket implementation on the ParticleTcpSocket worker thread.
+///
+/// Like ParticleTcpSocket, every sock_* call runs on the shared socket thread
+/// so callers never contend with Particle's system thread for LwIP's core
+/// lock. Waiting RecvFrom() calls are parked and polled alongside TCP reads.
+
+#include <atomic>
+
+#include "pb_socket/particle_tcp_socket.h"
+#include "pb_socket/udp_socket.h"
+#include "pw_bytes/span.h"
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+
+namespace pb::socket {
+
+/// UDP socket using Particle Device OS sockets.
+///
+/// SendBatch() hands all datagrams to the socket thread in a single
+/// round-trip, which is what makes tens of small datagrams per second cheap.
+///
+/// @code
+///   pb::socket::ParticleUdpSocket socket({.host = "telemetry.local",
+///                                         .port = 5001});
+///   PW_TRY(socket.Open());
+///   const pb::socket::UdpDatagram batch[] = {
+///       {socket.peer(), sample_a},
+///       {socket.peer(), sample_b},
+///   };
+///   socket.SendBatch(batch);
+/// @endcode
+class ParticleUdpSocket : public UdpSocket {
+ public:
+  /// The socket worker thread is started lazily on first Open().
+  explicit ParticleUdpSocket(const UdpConfig& config);
+
+  /// Destructor - closes the socket if open.
+  ~ParticleUdpSocket() override;
+
+  ParticleUdpSocket(const ParticleUdpSocket&) = delete;
+  ParticleUdpSocket& operator=(const ParticleUdpSocket&) = delete;
+  ParticleUdpSocket(ParticleUdpSocket&&) = delete;
+  ParticleUdpSocket& operator=(ParticleUdpSocket&&) = delete;
+
+  // UdpSocket interface - all operations are queued to socket thread
+  pw::Status Open() override;
+  void Close() override;
+  bool IsOpen() const override {
+    return socket_fd_.load(std::memory_order_acquire) >= 0;
+  }
+  int last_error() const override {
+    return last_error_.load(std::memory_order_acquire);
+  }
+  UdpEndpoint peer() const override { return peer_; }
+
+  pw::Status SendTo(const UdpEndpoint& to, pw::ConstByteSpan data) override;
+
+  /// Returns 0 bytes right away if no datagram is queued, unless
+  /// UdpConfig::read_timeout_ms is set: then waits up to that long.
+  pw::StatusWithSize RecvFrom(pw::ByteSpan dest, UdpEndpoint* from) override;
+
+  pw::StatusWithSize SendBatch(pw::span<const UdpDatagram> datagrams) override;
+
+ private:
+  // Checks that the socket is open and fills in the request for `op`.
+  pw::Status PrepareRequest(internal::SocketOp op,
+                            internal::SocketRequest& req);
+
+  UdpConfig config_;
+  UdpEndpoint peer_;  // Set by Open()
+
+  // Open()/Close(), sends and receives
+  internal::BlockingRequest control_request_;
+  internal::BlockingRequest send_request_;
+  internal::BlockingRequest recv_request_;
+
+  std::atomic<int> socket_fd_{-1};
+  std::atomic<int> last_error_{0};
+};
+
+}  // namespace pb::socket
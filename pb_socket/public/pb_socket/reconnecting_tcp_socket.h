@@ -0,0 +1,121 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file reconnecting_tcp_socket.h
+/// @brief TcpSocket decorator that reconnects with jittered backoff.
+
+#include <cstdint>
+
+#include "pb_socket/tcp_socket.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_function/function.h"
+#include "pw_sync/mutex.h"
+
+namespace pb::socket {
+
+/// Retry behaviour of a ReconnectingTcpSocket.
+struct ReconnectPolicy {
+  /// Delay before the first retry after the connection is lost.
+  uint32_t initial_backoff_ms = 500;
+  /// Upper bound of the doubling delay between failed attempts.
+  uint32_t max_backoff_ms = 60000;
+  /// Random extra delay of up to this percentage of the backoff, so devices
+  /// that lost the same access point don't reconnect in lockstep.
+  uint32_t jitter_percent = 25;
+  /// Returns whether the network is up. While it returns false no attempt
+  /// is made (and the backoff doesn't grow), so the radio isn't kept busy
+  /// with connects that can't succeed. nullptr treats the network as always
+  /// up; use ParticleTcpSocket::NetworkReady on Device OS.
+  bool (*network_ready)() = nullptr;
+};
+
+/// Managed connection around any TcpSocket.
+///
+/// After Connect() succeeds once, a lost connection (peer close or I/O
+/// error) is re-established automatically: Read() and Write() return
+/// Unavailable while disconnected and try to reconnect whenever the backoff
+/// has expired. Call Service() periodically if the socket may sit idle.
+/// Disconnect() stops managing the connection.
+///
+/// Usage:
+/// @code
+///   pb::socket::ParticleTcpSocket tcp(config);
+///   pb::socket::ReconnectingTcpSocket socket(
+///       tcp, {.network_ready = pb::socket::ParticleTcpSocket::NetworkReady});
+///   socket.set_reconnect_callback([] { OpenRpcStreams(); });
+///   socket.Connect();
+///   pb::socket::TcpSocketStreamAdapter stream(socket);
+/// @endcode
+///
+/// Thread Safety: the reconnect state is protected by a mutex; I/O is as
+/// thread-safe as the wrapped socket. The callback runs on the thread whose
+/// call re-established the connection.
+class ReconnectingTcpSocket : public TcpSocket {
+ public:
+  /// Invoked after each automatic reconnect, e.g. to re-open pw_rpc streams.
+  using ReconnectCallback = pw::Function<void()>;
+
+  explicit ReconnectingTcpSocket(TcpSocket& socket,
+                                 const ReconnectPolicy& policy = {});
+
+  ReconnectingTcpSocket(const ReconnectingTcpSocket&) = delete;
+  ReconnectingTcpSocket& operator=(const ReconnectingTcpSocket&) = delete;
+
+  void set_reconnect_callback(ReconnectCallback callback);
+
+  /// Connects and starts managing the connection. If this attempt fails the
+  /// error is returned and retries are scheduled with backoff.
+  pw::Status Connect() override;
+
+  /// Disconnects and stops reconnecting.
+  void Disconnect() override;
+
+  bool IsConnected() const override { return socket_.IsConnected(); }
+  TcpState state() const override { return socket_.state(); }
+  int last_error() const override { return socket_.last_error(); }
+
+  pw::StatusWithSize Read(pw::ByteSpan dest) override;
+  pw::Status Write(pw::ConstByteSpan data) override;
+  pw::Status WriteV(pw::span<const pw::ConstByteSpan> chunks) override;
+  pw::StatusWithSize ReadV(pw::span<const pw::ByteSpan> buffers) override;
+  pw::Status Flush() override;
+
+  /// Reconnects if the connection is managed, down and the backoff has
+  /// expired. Returns OkStatus if connected afterwards, Unavailable while
+  /// waiting, or the error of a failed attempt.
+  pw::Status Service();
+
+  /// Number of successful automatic reconnects.
+  uint32_t reconnects() const { return reconnects_; }
+  /// Number of failed connect attempts since the last success.
+  uint32_t failed_attempts() const { return failed_attempts_; }
+
+ private:
+  // Makes sure the socket is connected before I/O; false while waiting.
+  bool EnsureConnected();
+
+  // Checks an I/O result for a lost connection and schedules a reconnect.
+  void CheckConnection(pw::Status status);
+
+  // Schedules the next attempt after the current backoff, then doubles it.
+  // Requires lock_.
+  void ScheduleRetry();
+
+  uint32_t NextRandom();
+
+  TcpSocket& socket_;
+  const ReconnectPolicy policy_;
+  ReconnectCallback callback_;
+
+  pw::sync::Mutex lock_;
+  bool managed_ = false;
+  uint32_t backoff_ms_;
+  pw::chrono::SystemClock::time_point next_attempt_;
+  uint32_t rng_state_;
+  uint32_t reconnects_ = 0;
+  uint32_t failed_attempts_ = 0;
+};
+
+}  // namespace pb::socket
@@ -0,0 +1,194 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file secure_channel.h
+/// @brief TcpSocket decorator with ASCON-AEAD128 frames and counter nonces.
+///
+/// A lightweight alternative to TlsSocket for peers that share a key, such
+/// as the MACO gateway. Connect() exchanges a 16-byte random from each end
+/// and derives a key and nonce prefix per direction from the pre-shared key
+/// and both randoms with ASCON-Hash256. After that, each frame is
+///
+///   length (2 bytes, little endian) | ciphertext | tag (16 bytes)
+///
+/// with the length as associated data. The nonce is the direction's prefix
+/// and a frame counter that both ends keep, so it is never sent. As TCP
+/// delivers in order, a frame only verifies as the next one expected: a
+/// replayed, reordered, dropped or tampered frame fails its tag.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pb_crypto/pb_crypto.h"
+#include "pb_socket/tcp_socket.h"
+#include "pw_bytes/span.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+
+namespace pb::socket {
+
+/// Size of the length field in front of each frame.
+inline constexpr size_t kSecureFrameHeaderSize = 2;
+
+/// Bytes a frame adds to its payload: length field and tag.
+inline constexpr size_t kSecureFrameOverhead =
+    kSecureFrameHeaderSize + crypto::kAsconTagSize;
+
+/// Size of the random each end sends in Connect().
+inline constexpr size_t kSecureHelloSize = 16;
+
+/// Which end of the connection a SecureChannel is. The two ends derive the
+/// same keys in opposite directions, so they must have different roles.
+enum class SecureChannelRole : uint8_t {
+  kClient,  ///< Connects the wrapped socket (the device)
+  kServer,  ///< Wraps an accepted socket
+};
+
+/// Configuration for a SecureChannel.
+struct SecureChannelConfig {
+  /// Pre-shared 16-byte ASCON key. Must outlive the channel; required.
+  pw::ConstByteSpan key;
+  SecureChannelRole role = SecureChannelRole::kClient;
+  /// How long Connect() waits for the peer's random
+  uint32_t handshake_timeout_ms = 5000;
+};
+
+/// Counters of a SecureChannel.
+struct SecureChannelStats {
+  uint32_t frames_sent = 0;
+  uint32_t frames_received = 0;
+  uint32_t frames_rejected = 0;  ///< Failed the tag or too large
+};
+
+/// Authenticated, encrypted connection over a TcpSocket.
+///
+/// Write() cuts the data into frames of up to max_payload_size() bytes and
+/// encrypts each directly into `tx_buffer`, so a frame costs one pass over
+/// the data and 18 bytes. WriteFrame() sends a payload the caller encoded
+/// into frame_payload(), which saves the copy. Read() returns plaintext once
+/// a whole frame has arrived and verified; until then it returns 0 bytes.
+///
+/// Usage:
+/// @code
+///   pb::socket::ParticleTcpSocket tcp({.host = "gateway.local",
+///                                      .port = 5000,
+///                                      .read_timeout_ms = 100});
+///   static std::array<std::byte, 512> rx_buffer;
+///   static std::array<std::byte, 512> tx_buffer;
+///   pb::socket::SecureChannel socket(
+///       tcp, {.key = kGatewayKey}, rx_buffer, tx_buffer);
+///   PW_TRY(socket.Connect());
+///   pb::socket::TcpSocketStreamAdapter stream(socket);
+/// @endcode
+///
+/// Each Connect() derives fresh keys, so a ReconnectingTcpSocket around the
+/// channel needs nothing else. The peer must use the same frame size: a
+/// frame larger than `rx_buffer` is rejected.
+///
+/// Thread Safety: not thread-safe; use from one thread at a time.
+class SecureChannel : public TcpSocket {
+ public:
+  /// @param socket Wrapped socket; for kServer an accepted connection
+  /// @param config Key and role
+  /// @param rx_buffer Holds one received frame
+  /// @param tx_buffer Holds one frame being sent
+  SecureChannel(TcpSocket& socket,
+                const SecureChannelConfig& config,
+                pw::ByteSpan rx_buffer,
+                pw::ByteSpan tx_buffer);
+
+  /// Destructor - disconnects and wipes the session keys.
+  ~SecureChannel() override;
+
+  SecureChannel(const SecureChannel&) = delete;
+  SecureChannel& operator=(const SecureChannel&) = delete;
+
+  /// Connects the wrapped socket unless it already is, and derives the
+  /// session keys with the peer.
+  /// @return OkStatus on success, or:
+  ///         - FailedPrecondition if already connected
+  ///         - InvalidArgument if config.key isn't 16 bytes or a buffer
+  ///           can't hold a frame
+  ///         - DeadlineExceeded if the peer's random didn't arrive within
+  ///           config.handshake_timeout_ms
+  ///         - the wrapped socket's error if it couldn't connect
+  pw::Status Connect() override;
+
+  /// Disconnects the wrapped socket and wipes the session keys.
+  void Disconnect() override;
+
+  bool IsConnected() const override;
+  TcpState state() const override;
+
+  /// The wrapped socket's last error.
+  int last_error() const override { return last_error_; }
+
+  /// Returns 0 bytes if no complete frame has arrived yet.
+  /// @return As TcpSocket::Read(), or DataLoss if a frame failed its tag or
+  ///         was too large; the connection is dropped then
+  pw::StatusWithSize Read(pw::ByteSpan dest) override;
+
+  pw::Status Write(pw::ConstByteSpan data) override;
+  pw::Status Flush() override { return socket_.Flush(); }
+
+  /// Plaintext area of the TX frame, max_payload_size() bytes. Encode a
+  /// payload here and send it with WriteFrame().
+  pw::ByteSpan frame_payload() {
+    return tx_buffer_.subspan(kSecureFrameHeaderSize, max_payload_size());
+  }
+
+  /// Encrypts the first `size` bytes of frame_payload() in place and sends
+  /// them as one frame.
+  /// @return As Write(), or InvalidArgument if `size` exceeds
+  ///         max_payload_size()
+  pw::Status WriteFrame(size_t size);
+
+  /// Largest payload of one sent frame.
+  size_t max_payload_size() const;
+
+  const SecureChannelStats& stats() const { return stats_; }
+
+ private:
+  // Key and nonce state of one direction.
+  struct Direction {
+    std::array<std::byte, crypto::kAsconKeySize> key{};
+    std::array<std::byte, crypto::kAsconNonceSize - sizeof(uint64_t)>
+        nonce_prefix{};
+    uint64_t counter = 0;
+
+    // Nonce of the next frame: prefix and counter.
+    std::array<std::byte, crypto::kAsconNonceSize> Nonce() const;
+  };
+
+  pw::Status Handshake();
+
+  // Reads the rest of the current frame, and decrypts it once complete.
+  pw::Status ReceiveFrame();
+
+  // Records the wrapped socket's error, drops the connection and wipes the
+  // keys.
+  void Fail();
+
+  void WipeSession();
+
+  TcpSocket& socket_;
+  const SecureChannelConfig config_;
+  pw::ByteSpan rx_buffer_;
+  pw::ByteSpan tx_buffer_;
+  crypto::NonceGenerator random_;
+
+  Direction tx_;
+  Direction rx_;
+  size_t rx_received_ = 0;  // Bytes of the current frame in rx_buffer_
+  size_t rx_offset_ = 0;    // Plaintext already returned by Read()
+  size_t rx_available_ = 0; // Plaintext not yet returned
+
+  TcpState state_ = TcpState::kDisconnected;
+  int last_error_ = 0;
+  SecureChannelStats stats_;
+};
+
+}  // namespace pb::socket
@@ -16,6 +16,7 @@
 #include <cstdint>
 
 #include "pw_bytes/span.h"
+#include "pw_span/span.h"
 #include "pw_status/status.h"
 #include "pw_status/status_with_size.h"
 
@@ -104,6 +105,50 @@ class TcpSocket {
   ///         - ResourceExhausted if would block or partial write
   ///         - Internal on write error
   virtual pw::Status Write(pw::ConstByteSpan data) = 0;
+
+  /// Write several buffers as one contiguous stream, e.g. a frame header and
+  /// its payload, without assembling them in a temporary buffer first.
+  ///
+  /// The default implementation calls Write() for each chunk.
+  ///
+  /// @param chunks Data to write, in order
+  /// @return Same as Write()
+  virtual pw::Status WriteV(pw::span<const pw::ConstByteSpan> chunks) {
+    for (pw::ConstByteSpan chunk : chunks) {
+      if (pw::Status status = Write(chunk); !status.ok()) {
+        return status;
+      }
+    }
+    return pw::OkStatus();
+  }
+
+  /// Read into several buffers in order, filling each before the next.
+  ///
+  /// The default implementation calls Read() for each buffer and stops at
+  /// the first short read.
+  ///
+  /// @param buffers Buffers to read into
+  /// @return Total bytes read, or the same errors as Read()
+  virtual pw::StatusWithSize ReadV(pw::span<const pw::ByteSpan> buffers) {
+    size_t total = 0;
+    for (pw::ByteSpan buffer : buffers) {
+      pw::StatusWithSize result = Read(buffer);
+      if (!result.ok()) {
+        return total > 0 ? pw::StatusWithSize(total) : result;
+      }
+      total += result.size();
+      if (result.size() < buffer.size()) {
+        break;
+      }
+    }
+    return pw::StatusWithSize(total);
+  }
+
+  /// Send any data an implementation has buffered from previous Write()
+  /// calls. Blocks until it has been handed to the network stack.
+  ///
+  /// @return OkStatus on success, or the error of a buffered write
+  virtual pw::Status Flush() { return pw::OkStatus(); }
 };
 
 }  // namespace pb::socket
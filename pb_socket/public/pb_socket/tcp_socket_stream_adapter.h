@@ -34,6 +34,10 @@ class TcpSocketStreamAdapter : public pw::stream::NonSeekableReaderWriter {
   /// Construct adapter wrapping a TcpSocket.
   explicit TcpSocketStreamAdapter(TcpSocket& socket) : socket_(socket) {}
 
+  /// Send data the socket batched from previous writes (TcpSocket::Flush()).
+  /// Call after the last frame of a burst when write batching is enabled.
+  pw::Status Flush() { return socket_.Flush(); }
+
  private:
   pw::StatusWithSize DoRead(pw::ByteSpan dest) override {
     return socket_.Read(dest);
@@ -0,0 +1,143 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file tls_socket.h
+/// @brief TcpSocket decorator that runs TLS 1.2 over any TcpSocket.
+///
+/// Uses the mbedTLS client built from mbedtls_config.h. The session of the
+/// last connection is kept and offered to the server on the next Connect()
+/// (session ticket or session ID), so reconnects skip the certificate chain
+/// and ECDHE exchange that make a full handshake take seconds on the P2.
+
+#include <cstdint>
+
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/x509_crt.h"
+#include "pb_socket/tcp_socket.h"
+#include "pw_bytes/span.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+
+namespace pb::socket {
+
+/// Configuration for a TlsSocket.
+struct TlsConfig {
+  /// Hostname sent as SNI and matched against the server certificate;
+  /// required, since the certificate is always verified
+  const char* server_name = nullptr;
+  /// Trusted CA certificates: PEM including the terminating NUL, or DER.
+  /// Must outlive the first Connect(); required.
+  pw::ConstByteSpan ca_certs;
+  /// How long the handshake may take after the TCP connection is up
+  uint32_t handshake_timeout_ms = 30000;
+  /// How long a Write() may wait for the connection to take more data
+  uint32_t write_timeout_ms = 10000;
+  /// Offer the previous session on reconnect
+  bool resume_sessions = true;
+};
+
+/// TLS client connection over a TcpSocket.
+///
+/// Connect() connects the wrapped socket and performs the handshake;
+/// Read() and Write() transfer application data. Give the wrapped socket a
+/// read timeout so the handshake waits for server records instead of
+/// polling. Wrap a TlsSocket in a ReconnectingTcpSocket for a managed
+/// connection that resumes its session on every reconnect.
+///
+/// Usage:
+/// @code
+///   pb::socket::ParticleTcpSocket tcp({.host = "gateway.example.com",
+///                                      .port = 8883,
+///                                      .read_timeout_ms = 1000});
+///   pb::socket::TlsSocket socket(tcp, {.server_name = "gateway.example.com",
+///                                      .ca_certs = kRootCaPem});
+///   PW_TRY(socket.Connect());
+///   pb::socket::TcpSocketStreamAdapter stream(socket);
+/// @endcode
+///
+/// The first Connect() allocates about 25 KiB of record buffers and
+/// handshake state from the heap.
+///
+/// Thread Safety: not thread-safe; use from one thread at a time.
+class TlsSocket : public TcpSocket {
+ public:
+  TlsSocket(TcpSocket& socket, const TlsConfig& config);
+
+  /// Destructor - disconnects if connected.
+  ~TlsSocket() override;
+
+  TlsSocket(const TlsSocket&) = delete;
+  TlsSocket& operator=(const TlsSocket&) = delete;
+
+  /// Connects the wrapped socket and performs the TLS handshake.
+  /// @return OkStatus on success, or:
+  ///         - FailedPrecondition if already connected
+  ///         - InvalidArgument if config.server_name is missing, or
+  ///           config.ca_certs is missing or can't be parsed
+  ///         - Unauthenticated if the server certificate isn't trusted
+  ///         - DeadlineExceeded if the handshake took longer than
+  ///           config.handshake_timeout_ms
+  ///         - Unavailable on other handshake errors (see last_error())
+  ///         - the wrapped socket's error if it couldn't connect
+  pw::Status Connect() override;
+
+  /// Sends close_notify and disconnects the wrapped socket. The session is
+  /// kept for the next Connect().
+  void Disconnect() override;
+
+  bool IsConnected() const override;
+  TcpState state() const override;
+
+  /// Negative mbedTLS error code of the last TLS failure, or the wrapped
+  /// socket's error if that failed.
+  int last_error() const override { return last_error_; }
+
+  /// Returns 0 bytes if no complete record has arrived yet.
+  pw::StatusWithSize Read(pw::ByteSpan dest) override;
+  /// Sends all of `data`. DeadlineExceeded (and the connection dropped) if
+  /// the connection takes no more data for config.write_timeout_ms.
+  pw::Status Write(pw::ConstByteSpan data) override;
+  pw::Status Flush() override { return socket_.Flush(); }
+
+  /// Drops the saved session, so the next Connect() does a full handshake.
+  void ForgetSession();
+
+  /// Duration of the last successful handshake, to tell full handshakes
+  /// from resumed ones.
+  uint32_t last_handshake_ms() const { return last_handshake_ms_; }
+
+ private:
+  // One-time setup of DRBG, CA chain and SSL context on first Connect().
+  pw::Status Setup();
+
+  pw::Status Handshake();
+
+  // Maps a fatal mbedTLS error, records it and drops the connection.
+  void Fail(int error);
+
+  // mbedTLS I/O callbacks over socket_.
+  static int Send(void* ctx, const unsigned char* buf, size_t len);
+  static int Recv(void* ctx, unsigned char* buf, size_t len);
+
+  TcpSocket& socket_;
+  const TlsConfig config_;
+
+  mbedtls_entropy_context entropy_;
+  mbedtls_ctr_drbg_context ctr_drbg_;
+  mbedtls_x509_crt ca_chain_;
+  mbedtls_ssl_config ssl_config_;
+  mbedtls_ssl_context ssl_;
+  mbedtls_ssl_session session_;
+
+  bool setup_done_ = false;
+  bool have_session_ = false;
+  TcpState state_ = TcpState::kDisconnected;
+  int last_error_ = 0;
+  uint32_t last_handshake_ms_ = 0;
+};
+
+}  // namespace pb::socket
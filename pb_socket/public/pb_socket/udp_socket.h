@@ -0,0 +1,122 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file udp_socket.h
+/// @brief Abstract UDP datagram socket interface.
+///
+/// Sibling of TcpSocket for traffic that prefers low latency over reliable
+/// delivery, e.g. high-rate telemetry where a late sample is worthless and
+/// TCP retransmits would hold up the newer ones behind it.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+
+namespace pb::socket {
+
+/// IPv4 address and port of a datagram's destination or source.
+struct UdpEndpoint {
+  /// IPv4 address in network byte order
+  uint32_t addr = 0;
+  /// Port in host byte order
+  uint16_t port = 0;
+};
+
+/// One datagram of UdpSocket::SendBatch().
+struct UdpDatagram {
+  UdpEndpoint to;
+  pw::ConstByteSpan data;
+};
+
+/// Configuration for a UDP socket.
+struct UdpConfig {
+  /// Local port to bind to (0 = any free port)
+  uint16_t local_port = 0;
+  /// Optional default peer, resolved by Open() and returned by peer()
+  /// (IPv4 in dotted decimal or hostname)
+  const char* host = nullptr;
+  /// Port of the default peer
+  uint16_t port = 0;
+  /// How long RecvFrom() waits for a datagram (0 = non-blocking)
+  uint32_t read_timeout_ms = 0;
+};
+
+/// Abstract UDP socket interface.
+///
+/// Usage:
+/// @code
+///   pb::socket::ParticleUdpSocket socket({.host = "192.168.1.100",
+///                                         .port = 5001});
+///   if (socket.Open().ok()) {
+///     socket.SendTo(socket.peer(), sample);
+///   }
+///   socket.Close();
+/// @endcode
+class UdpSocket {
+ public:
+  virtual ~UdpSocket() = default;
+
+  /// Create the socket, bind it and resolve the default peer.
+  /// @return OkStatus on success, FailedPrecondition if already open,
+  ///         Unavailable if the socket can't be created or the peer can't
+  ///         be resolved
+  virtual pw::Status Open() = 0;
+
+  /// Close the socket.
+  virtual void Close() = 0;
+
+  /// Check if the socket is open.
+  virtual bool IsOpen() const = 0;
+
+  /// Get last error code (platform-specific).
+  virtual int last_error() const = 0;
+
+  /// Default peer from UdpConfig, valid after Open(). All zero if none was
+  /// configured.
+  virtual UdpEndpoint peer() const = 0;
+
+  /// Send one datagram.
+  /// @return OkStatus once handed to the network stack (not a delivery
+  ///         confirmation), or:
+  ///         - FailedPrecondition if not open
+  ///         - ResourceExhausted if the stack is out of buffers
+  ///         - Internal on other send errors
+  virtual pw::Status SendTo(const UdpEndpoint& to, pw::ConstByteSpan data) = 0;
+
+  /// Receive one datagram. Bytes beyond dest.size() are discarded.
+  ///
+  /// @param dest Buffer for the datagram payload
+  /// @param from Set to the sender, if not null
+  /// @return StatusWithSize with the payload size (0 if no datagram arrived
+  ///         in time), or FailedPrecondition if not open or closed while
+  ///         waiting, Internal on receive error
+  virtual pw::StatusWithSize RecvFrom(pw::ByteSpan dest, UdpEndpoint* from) = 0;
+
+  /// Send several datagrams, in order, stopping at the first failure.
+  ///
+  /// The default implementation calls SendTo() for each datagram.
+  ///
+  /// @return Number of datagrams sent. If none was sent, the error of the
+  ///         first SendTo(); otherwise the status is OK even if a later one
+  ///         failed and the size tells how many went out.
+  virtual pw::StatusWithSize SendBatch(pw::span<const UdpDatagram> datagrams) {
+    size_t sent = 0;
+    for (const UdpDatagram& datagram : datagrams) {
+      if (pw::Status status = SendTo(datagram.to, datagram.data);
+          !status.ok()) {
+        return sent > 0 ? pw::StatusWithSize(sent)
+                        : pw::StatusWithSize(status, 0);
+      }
+      ++sent;
+    }
+    return pw::StatusWithSize(sent);
+  }
+};
+
+}  // namespace pb::socket
@@ -0,0 +1,194 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#define PW_LOG_MODULE_NAME "pb_socket"
+
+#include "pb_socket/reconnecting_tcp_socket.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <utility>
+
+#include "pw_log/log.h"
+
+namespace pb::socket {
+
+using pw::chrono::SystemClock;
+
+ReconnectingTcpSocket::ReconnectingTcpSocket(TcpSocket& socket,
+                                             const ReconnectPolicy& policy)
+    : socket_(socket),
+      policy_(policy),
+      backoff_ms_(policy.initial_backoff_ms),
+      next_attempt_(SystemClock::now()),
+      // Any non-zero seed will do; the clock differs between devices enough
+      // to decorrelate their retries
+      rng_state_(static_cast<uint32_t>(
+                     SystemClock::now().time_since_epoch().count()) |
+                 1u) {}
+
+void ReconnectingTcpSocket::set_reconnect_callback(ReconnectCallback callback) {
+  std::lock_guard lock(lock_);
+  callback_ = std::move(callback);
+}
+
+pw::Status ReconnectingTcpSocket::Connect() {
+  std::lock_guard lock(lock_);
+  managed_ = true;
+  backoff_ms_ = policy_.initial_backoff_ms;
+  pw::Status status = socket_.Connect();
+  if (status.ok()) {
+    failed_attempts_ = 0;
+  } else {
+    ++failed_attempts_;
+    ScheduleRetry();
+  }
+  return status;
+}
+
+void ReconnectingTcpSocket::Disconnect() {
+  std::lock_guard lock(lock_);
+  managed_ = false;
+  socket_.Disconnect();
+}
+
+pw::Status ReconnectingTcpSocket::Service() {
+  bool reconnected = false;
+  {
+    std::lock_guard lock(lock_);
+    if (socket_.IsConnected()) {
+      return pw::OkStatus();
+    }
+    if (!managed_) {
+      return pw::Status::FailedPrecondition();
+    }
+    const SystemClock::time_point now = SystemClock::now();
+    if (now < next_attempt_) {
+      return pw::Status::Unavailable();
+    }
+    if (policy_.network_ready != nullptr && !policy_.network_ready()) {
+      // Check again later without growing the backoff
+      next_attempt_ = now + SystemClock::for_at_least(std::chrono::milliseconds(
+                                policy_.initial_backoff_ms));
+      return pw::Status::Unavailable();
+    }
+
+    pw::Status status = socket_.Connect();
+    if (!status.ok()) {
+      ++failed_attempts_;
+      PW_LOG_WARN("Reconnect attempt %u failed (status=%d), retry in %u ms",
+                  static_cast<unsigned>(failed_attempts_),
+                  static_cast<int>(status.code()),
+                  static_cast<unsigned>(backoff_ms_));
+      ScheduleRetry();
+      return status;
+    }
+
+    PW_LOG_INFO("Reconnected after %u failed attempts",
+                static_cast<unsigned>(failed_attempts_));
+    ++reconnects_;
+    failed_attempts_ = 0;
+    backoff_ms_ = policy_.initial_backoff_ms;
+    reconnected = true;
+  }
+
+  // Outside the lock so the callback may use this socket
+  if (reconnected && callback_ != nullptr) {
+    callback_();
+  }
+  return pw::OkStatus();
+}
+
+pw::StatusWithSize ReconnectingTcpSocket::Read(pw::ByteSpan dest) {
+  if (!EnsureConnected()) {
+    return pw::StatusWithSize::Unavailable();
+  }
+  pw::StatusWithSize result = socket_.Read(dest);
+  CheckConnection(result.status());
+  return result;
+}
+
+pw::Status ReconnectingTcpSocket::Write(pw::ConstByteSpan data) {
+  if (!EnsureConnected()) {
+    return pw::Status::Unavailable();
+  }
+  pw::Status status = socket_.Write(data);
+  CheckConnection(status);
+  return status;
+}
+
+pw::Status ReconnectingTcpSocket::WriteV(
+    pw::span<const pw::ConstByteSpan> chunks) {
+  if (!EnsureConnected()) {
+    return pw::Status::Unavailable();
+  }
+  pw::Status status = socket_.WriteV(chunks);
+  CheckConnection(status);
+  return status;
+}
+
+pw::StatusWithSize ReconnectingTcpSocket::ReadV(
+    pw::span<const pw::ByteSpan> buffers) {
+  if (!EnsureConnected()) {
+    return pw::StatusWithSize::Unavailable();
+  }
+  pw::StatusWithSize result = socket_.ReadV(buffers);
+  CheckConnection(result.status());
+  return result;
+}
+
+pw::Status ReconnectingTcpSocket::Flush() {
+  if (!EnsureConnected()) {
+    return pw::Status::Unavailable();
+  }
+  pw::Status status = socket_.Flush();
+  CheckConnection(status);
+  return status;
+}
+
+bool ReconnectingTcpSocket::EnsureConnected() {
+  return socket_.IsConnected() || Service().ok();
+}
+
+void ReconnectingTcpSocket::CheckConnection(pw::Status status) {
+  // OutOfRange: closed by peer. FailedPrecondition/Internal: the socket
+  // dropped the connection or hit an I/O error.
+  if (status.ok() || !(status.IsOutOfRange() || status.IsInternal() ||
+                       status.IsFailedPrecondition())) {
+    return;
+  }
+  std::lock_guard lock(lock_);
+  if (!managed_ || socket_.IsConnected()) {
+    return;
+  }
+  PW_LOG_WARN("Connection lost (status=%d), reconnecting in %u ms",
+              static_cast<int>(status.code()),
+              static_cast<unsigned>(policy_.initial_backoff_ms));
+  socket_.Disconnect();
+  backoff_ms_ = policy_.initial_backoff_ms;
+  ScheduleRetry();
+}
+
+void ReconnectingTcpSocket::ScheduleRetry() {
+  uint32_t delay_ms = backoff_ms_;
+  if (policy_.jitter_percent > 0) {
+    const uint32_t max_jitter =
+        static_cast<uint32_t>(uint64_t{backoff_ms_} * policy_.jitter_percent /
+                              100);
+    delay_ms += NextRandom() % (max_jitter + 1);
+  }
+  next_attempt_ = SystemClock::TimePointAfterAtLeast(
+      std::chrono::milliseconds(delay_ms));
+  backoff_ms_ = std::min(backoff_ms_ * 2, policy_.max_backoff_ms);
+}
+
+uint32_t ReconnectingTcpSocket::NextRandom() {
+  // xorshift32: plenty for spreading out retries
+  rng_state_ ^= rng_state_ << 13;
+  rng_state_ ^= rng_state_ >> 17;
+  rng_state_ ^= rng_state_ << 5;
+  return rng_state_;
+}
+
+}  // namespace pb::socket
@@ -0,0 +1,330 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#define PW_LOG_MODULE_NAME "pb_socket"
+
+#include "pb_socket/secure_channel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string_view>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_status/try.h"
+#include "pw_thread/sleep.h"
+
+namespace pb::socket {
+
+namespace {
+
+using pw::chrono::SystemClock;
+
+// Wait between reads while the peer's random hasn't arrived
+constexpr auto kHandshakePollInterval = std::chrono::milliseconds(10);
+
+constexpr std::string_view kRandomPersonalization = "pb_socket_secure";
+
+// Direction labels of the key derivation
+constexpr std::string_view kClientToServer = "pb_socket c2s";
+constexpr std::string_view kServerToClient = "pb_socket s2c";
+
+// A frame's length must fit the 16-bit length field
+constexpr size_t kMaxFramePayload = 0xffff;
+
+void PutU16(pw::ByteSpan dest, size_t value) {
+  dest[0] = static_cast<std::byte>(value & 0xff);
+  dest[1] = static_cast<std::byte>((value >> 8) & 0xff);
+}
+
+size_t GetU16(pw::ConstByteSpan src) {
+  return static_cast<size_t>(src[0]) | (static_cast<size_t>(src[1]) << 8);
+}
+
+// Derives the key and nonce prefix of one direction from the pre-shared key
+// and both randoms.
+template <typename Direction>
+pw::Status DeriveDirection(pw::ConstByteSpan key,
+                           pw::ConstByteSpan client_random,
+                           pw::ConstByteSpan server_random,
+                           std::string_view label,
+                           Direction& direction) {
+  crypto::AsconHash256Hasher hasher;
+  hasher.Update(key);
+  hasher.Update(client_random);
+  hasher.Update(server_random);
+  hasher.Update(pw::as_bytes(pw::span(label)));
+  std::array<std::byte, crypto::kAsconHashSize> hash;
+  PW_TRY(hasher.Finish(hash));
+
+  std::copy_n(hash.begin(), direction.key.size(), direction.key.begin());
+  std::copy_n(hash.begin() + direction.key.size(),
+              direction.nonce_prefix.size(),
+              direction.nonce_prefix.begin());
+  direction.counter = 0;
+  crypto::SecureZero(hash);
+  return pw::OkStatus();
+}
+
+}  // namespace
+
+std::array<std::byte, crypto::kAsconNonceSize>
+SecureChannel::Direction::Nonce() const {
+  std::array<std::byte, crypto::kAsconNonceSize> nonce;
+  std::copy(nonce_prefix.begin(), nonce_prefix.end(), nonce.begin());
+  for (size_t i = 0; i < sizeof(counter); ++i) {
+    nonce[nonce_prefix.size() + i] =
+        static_cast<std::byte>((counter >> (8 * i)) & 0xff);
+  }
+  return nonce;
+}
+
+SecureChannel::SecureChannel(TcpSocket& socket,
+                             const SecureChannelConfig& config,
+                             pw::ByteSpan rx_buffer,
+                             pw::ByteSpan tx_buffer)
+    : socket_(socket),
+      config_(config),
+      rx_buffer_(rx_buffer),
+      tx_buffer_(tx_buffer) {}
+
+SecureChannel::~SecureChannel() { Disconnect(); }
+
+size_t SecureChannel::max_payload_size() const {
+  if (tx_buffer_.size() <= kSecureFrameOverhead) {
+    return 0;
+  }
+  return std::min(tx_buffer_.size() - kSecureFrameOverhead, kMaxFramePayload);
+}
+
+pw::Status SecureChannel::Connect() {
+  if (state_ == TcpState::kConnected) {
+    return pw::Status::FailedPrecondition();
+  }
+  if (config_.key.size() != crypto::kAsconKeySize ||
+      rx_buffer_.size() <= kSecureFrameOverhead || max_payload_size() == 0) {
+    return pw::Status::InvalidArgument();
+  }
+  if (!random_.seeded()) {
+    PW_TRY(random_.Seed(pw::as_bytes(pw::span(kRandomPersonalization))));
+  }
+
+  state_ = TcpState::kConnecting;
+  if (!socket_.IsConnected()) {
+    if (pw::Status status = socket_.Connect(); !status.ok()) {
+      last_error_ = socket_.last_error();
+      state_ = TcpState::kError;
+      return status;
+    }
+  }
+
+  if (pw::Status status = Handshake(); !status.ok()) {
+    Fail();
+    return status;
+  }
+  rx_received_ = 0;
+  rx_offset_ = 0;
+  rx_available_ = 0;
+  state_ = TcpState::kConnected;
+  return pw::OkStatus();
+}
+
+pw::Status SecureChannel::Handshake() {
+  std::array<std::byte, kSecureHelloSize> local;
+  std::array<std::byte, kSecureHelloSize> peer;
+  PW_TRY(random_.Generate(local));
+  PW_TRY(socket_.Write(local));
+
+  const SystemClock::time_point deadline =
+      SystemClock::now() +
+      SystemClock::for_at_least(
+          std::chrono::milliseconds(config_.handshake_timeout_ms));
+  size_t received = 0;
+  while (received < peer.size()) {
+    pw::StatusWithSize result =
+        socket_.Read(pw::ByteSpan(peer).subspan(received));
+    if (!result.ok()) {
+      return result.status();
+    }
+    received += result.size();
+    if (result.size() == 0) {
+      if (SystemClock::now() >= deadline) {
+        PW_LOG_WARN("Secure channel handshake timed out");
+        return pw::Status::DeadlineExceeded();
+      }
+      pw::this_thread::sleep_for(
+          SystemClock::for_at_least(kHandshakePollInterval));
+    }
+  }
+
+  const bool client = config_.role == SecureChannelRole::kClient;
+  const pw::ConstByteSpan client_random = client ? local : peer;
+  const pw::ConstByteSpan server_random = client ? peer : local;
+  PW_TRY(DeriveDirection(config_.key, client_random, server_random,
+                         kClientToServer, client ? tx_ : rx_));
+  PW_TRY(DeriveDirection(config_.key, client_random, server_random,
+                         kServerToClient, client ? rx_ : tx_));
+  return pw::OkStatus();
+}
+
+void SecureChannel::Disconnect() {
+  if (state_ != TcpState::kDisconnected) {
+    socket_.Disconnect();
+  }
+  WipeSession();
+  state_ = TcpState::kDisconnected;
+}
+
+bool SecureChannel::IsConnected() const {
+  return state_ == TcpState::kConnected && socket_.IsConnected();
+}
+
+TcpState SecureChannel::state() const {
+  if (state_ == TcpState::kConnected && !socket_.IsConnected()) {
+    return socket_.state();
+  }
+  return state_;
+}
+
+void SecureChannel::Fail() {
+  last_error_ = socket_.last_error();
+  state_ = TcpState::kError;
+  socket_.Disconnect();
+  WipeSession();
+}
+
+void SecureChannel::WipeSession() {
+  crypto::SecureZero(tx_.key);
+  crypto::SecureZero(rx_.key);
+  tx_.counter = 0;
+  rx_.counter = 0;
+  // Plaintext not yet read
+  crypto::SecureZero(rx_buffer_);
+  rx_received_ = 0;
+  rx_offset_ = 0;
+  rx_available_ = 0;
+}
+
+pw::StatusWithSize SecureChannel::Read(pw::ByteSpan dest) {
+  if (state_ != TcpState::kConnected) {
+    return pw::StatusWithSize::FailedPrecondition();
+  }
+  if (rx_available_ == 0) {
+    if (pw::Status status = ReceiveFrame(); !status.ok()) {
+      return pw::StatusWithSize(status, 0);
+    }
+  }
+
+  const size_t size = std::min(dest.size(), rx_available_);
+  std::memcpy(dest.data(),
+              rx_buffer_.data() + kSecureFrameHeaderSize + rx_offset_,
+              size);
+  rx_offset_ += size;
+  rx_available_ -= size;
+  return pw::StatusWithSize(size);
+}
+
+pw::Status SecureChannel::ReceiveFrame() {
+  // Reads no further than the current frame, so the next one stays in the
+  // wrapped socket
+  while (true) {
+    size_t frame_size = kSecureFrameHeaderSize;
+    if (rx_received_ >= kSecureFrameHeaderSize) {
+      frame_size = kSecureFrameOverhead + GetU16(rx_buffer_);
+      if (frame_size > rx_buffer_.size()) {
+        PW_LOG_WARN("Secure channel: frame of %u bytes too large",
+                    static_cast<unsigned>(frame_size));
+        ++stats_.frames_rejected;
+        Fail();
+        return pw::Status::DataLoss();
+      }
+      if (rx_received_ == frame_size) {
+        break;
+      }
+    }
+
+    pw::StatusWithSize result = socket_.Read(
+        rx_buffer_.subspan(rx_received_, frame_size - rx_received_));
+    if (result.status().IsOutOfRange()) {
+      socket_.Disconnect();
+      WipeSession();
+      state_ = TcpState::kDisconnected;
+      return result.status();
+    }
+    if (!result.ok()) {
+      Fail();
+      return result.status();
+    }
+    if (result.size() == 0) {
+      return pw::OkStatus();  // Rest of the frame not here yet
+    }
+    rx_received_ += result.size();
+  }
+
+  const size_t payload_size = rx_received_ - kSecureFrameOverhead;
+  const pw::ConstByteSpan header = rx_buffer_.first(kSecureFrameHeaderSize);
+  const pw::ByteSpan payload =
+      rx_buffer_.subspan(kSecureFrameHeaderSize, payload_size);
+  const pw::ConstByteSpan tag = rx_buffer_.subspan(
+      kSecureFrameHeaderSize + payload_size, crypto::kAsconTagSize);
+  if (!crypto::AsconAead128DecryptInPlace(
+           rx_.key, rx_.Nonce(), header, payload, tag)
+           .ok()) {
+    PW_LOG_WARN("Secure channel: frame %u failed authentication",
+                static_cast<unsigned>(rx_.counter));
+    ++stats_.frames_rejected;
+    Fail();
+    return pw::Status::DataLoss();
+  }
+
+  ++rx_.counter;
+  ++stats_.frames_received;
+  rx_received_ = 0;
+  rx_offset_ = 0;
+  rx_available_ = payload_size;
+  return pw::OkStatus();
+}
+
+pw::Status SecureChannel::Write(pw::ConstByteSpan data) {
+  if (state_ != TcpState::kConnected) {
+    return pw::Status::FailedPrecondition();
+  }
+  const pw::ByteSpan payload = frame_payload();
+  while (!data.empty()) {
+    const size_t size = std::min(data.size(), payload.size());
+    std::memcpy(payload.data(), data.data(), size);
+    PW_TRY(WriteFrame(size));
+    data = data.subspan(size);
+  }
+  return pw::OkStatus();
+}
+
+pw::Status SecureChannel::WriteFrame(size_t size) {
+  if (state_ != TcpState::kConnected) {
+    return pw::Status::FailedPrecondition();
+  }
+  if (size > max_payload_size()) {
+    return pw::Status::InvalidArgument();
+  }
+
+  PutU16(tx_buffer_, size);
+  const pw::ConstByteSpan header = tx_buffer_.first(kSecureFrameHeaderSize);
+  const pw::ByteSpan payload = tx_buffer_.subspan(kSecureFrameHeaderSize, size);
+  const pw::ByteSpan tag =
+      tx_buffer_.subspan(kSecureFrameHeaderSize + size, crypto::kAsconTagSize);
+  PW_TRY(crypto::AsconAead128EncryptInPlace(
+      tx_.key, tx_.Nonce(), header, payload, tag));
+  ++tx_.counter;
+
+  // The peer expects every counter value, so a lost frame ends the session
+  const pw::ConstByteSpan frame = tx_buffer_.first(size + kSecureFrameOverhead);
+  if (pw::Status status = socket_.Write(frame); !status.ok()) {
+    Fail();
+    return status;
+  }
+  ++stats_.frames_sent;
+  return pw::OkStatus();
+}
+
+}  // namespace pb::socket
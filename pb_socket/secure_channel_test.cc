@@ -0,0 +1,212 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_socket/secure_channel.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "mock_tcp_socket.h"
+#include "pw_unit_test/framework.h"
+#include "sim_tcp_socket.h"
+
+namespace pb::socket {
+namespace {
+
+constexpr std::array<std::byte, 16> kKey = {
+    std::byte{0x00}, std::byte{0x01}, std::byte{0x02}, std::byte{0x03},
+    std::byte{0x04}, std::byte{0x05}, std::byte{0x06}, std::byte{0x07},
+    std::byte{0x08}, std::byte{0x09}, std::byte{0x0a}, std::byte{0x0b},
+    std::byte{0x0c}, std::byte{0x0d}, std::byte{0x0e}, std::byte{0x0f}};
+
+constexpr size_t kFrameSize = 64;
+
+pw::ConstByteSpan Bytes(std::string_view text) {
+  return pw::as_bytes(pw::span(text));
+}
+
+// Passes everything through to the wrapped socket; can send the next write
+// twice (a replay) or with a flipped byte.
+class TamperingSocket : public TcpSocket {
+ public:
+  explicit TamperingSocket(TcpSocket& socket) : socket_(socket) {}
+
+  pw::Status Connect() override { return socket_.Connect(); }
+  void Disconnect() override { socket_.Disconnect(); }
+  bool IsConnected() const override { return socket_.IsConnected(); }
+  TcpState state() const override { return socket_.state(); }
+  int last_error() const override { return socket_.last_error(); }
+  pw::StatusWithSize Read(pw::ByteSpan dest) override {
+    return socket_.Read(dest);
+  }
+
+  pw::Status Write(pw::ConstByteSpan data) override {
+    if (flip_next_) {
+      flip_next_ = false;
+      std::vector<std::byte> copy(data.begin(), data.end());
+      copy.back() ^= std::byte{0x01};
+      return socket_.Write(copy);
+    }
+    if (replay_next_) {
+      replay_next_ = false;
+      if (pw::Status status = socket_.Write(data); !status.ok()) {
+        return status;
+      }
+    }
+    return socket_.Write(data);
+  }
+
+  void ReplayNextWrite() { replay_next_ = true; }
+  void FlipNextWrite() { flip_next_ = true; }
+
+ private:
+  TcpSocket& socket_;
+  bool replay_next_ = false;
+  bool flip_next_ = false;
+};
+
+class SecureChannelTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(link_.client().Connect(), pw::OkStatus());
+    // Both ends wait for each other's random
+    std::thread server([this] { server_status_ = server_.Connect(); });
+    ASSERT_EQ(client_.Connect(), pw::OkStatus());
+    server.join();
+    ASSERT_EQ(server_status_, pw::OkStatus());
+  }
+
+  // Reads from `channel` until data or an error arrives.
+  static pw::StatusWithSize ReadSome(SecureChannel& channel,
+                                     pw::ByteSpan dest) {
+    for (int i = 0; i < 20; ++i) {
+      pw::StatusWithSize result = channel.Read(dest);
+      if (!result.ok() || result.size() > 0) {
+        return result;
+      }
+    }
+    return pw::StatusWithSize(0);
+  }
+
+  SimTcpLink link_{{.latency_ms = 1, .read_timeout_ms = 50}};
+  TamperingSocket tap_{link_.client()};
+
+  std::array<std::byte, kFrameSize> client_rx_{};
+  std::array<std::byte, kFrameSize> client_tx_{};
+  SecureChannel client_{tap_, {.key = kKey}, client_rx_, client_tx_};
+
+  std::array<std::byte, kFrameSize> server_rx_{};
+  std::array<std::byte, kFrameSize> server_tx_{};
+  SecureChannel server_{link_.server(),
+                        {.key = kKey, .role = SecureChannelRole::kServer},
+                        server_rx_,
+                        server_tx_};
+  pw::Status server_status_;
+};
+
+TEST_F(SecureChannelTest, ExchangesDataBothWays) {
+  ASSERT_EQ(client_.Write(Bytes("ping")), pw::OkStatus());
+  std::array<std::byte, 16> buffer{};
+  pw::StatusWithSize result = ReadSome(server_, buffer);
+  ASSERT_EQ(result.status(), pw::OkStatus());
+  EXPECT_EQ(std::string_view(reinterpret_cast<const char*>(buffer.data()),
+                             result.size()),
+            "ping");
+
+  ASSERT_EQ(server_.Write(Bytes("pong")), pw::OkStatus());
+  result = ReadSome(client_, buffer);
+  ASSERT_EQ(result.status(), pw::OkStatus());
+  EXPECT_EQ(std::string_view(reinterpret_cast<const char*>(buffer.data()),
+                             result.size()),
+            "pong");
+}
+
+TEST_F(SecureChannelTest, SplitsLargeWritesIntoFrames) {
+  std::vector<std::byte> sent(3 * client_.max_payload_size() + 5);
+  for (size_t i = 0; i < sent.size(); ++i) {
+    sent[i] = static_cast<std::byte>(i * 7);
+  }
+  ASSERT_EQ(client_.Write(sent), pw::OkStatus());
+  EXPECT_EQ(client_.stats().frames_sent, 4u);
+
+  std::vector<std::byte> received;
+  std::array<std::byte, 10> buffer;
+  while (received.size() < sent.size()) {
+    pw::StatusWithSize result = ReadSome(server_, buffer);
+    ASSERT_EQ(result.status(), pw::OkStatus());
+    ASSERT_GT(result.size(), 0u);
+    received.insert(
+        received.end(), buffer.begin(), buffer.begin() + result.size());
+  }
+  EXPECT_TRUE(received == sent);
+  EXPECT_EQ(server_.stats().frames_received, 4u);
+}
+
+TEST_F(SecureChannelTest, WriteFrameEncryptsInPlace) {
+  const pw::ConstByteSpan text = Bytes("in place");
+  std::copy(text.begin(), text.end(), client_.frame_payload().begin());
+  ASSERT_EQ(client_.WriteFrame(text.size()), pw::OkStatus());
+  EXPECT_EQ(client_.WriteFrame(client_.max_payload_size() + 1),
+            pw::Status::InvalidArgument());
+
+  std::array<std::byte, 16> buffer{};
+  pw::StatusWithSize result = ReadSome(server_, buffer);
+  ASSERT_EQ(result.status(), pw::OkStatus());
+  EXPECT_EQ(result.size(), text.size());
+}
+
+TEST_F(SecureChannelTest, RejectsReplayedFrame) {
+  tap_.ReplayNextWrite();
+  ASSERT_EQ(client_.Write(Bytes("open door")), pw::OkStatus());
+
+  std::array<std::byte, 16> buffer{};
+  EXPECT_EQ(ReadSome(server_, buffer).status(), pw::OkStatus());
+  // Same bytes, but the server expects the next counter
+  EXPECT_EQ(ReadSome(server_, buffer).status(), pw::Status::DataLoss());
+  EXPECT_EQ(server_.stats().frames_rejected, 1u);
+  EXPECT_FALSE(server_.IsConnected());
+}
+
+TEST_F(SecureChannelTest, RejectsTamperedFrame) {
+  tap_.FlipNextWrite();
+  ASSERT_EQ(client_.Write(Bytes("open door")), pw::OkStatus());
+
+  std::array<std::byte, 16> buffer{};
+  EXPECT_EQ(ReadSome(server_, buffer).status(), pw::Status::DataLoss());
+  EXPECT_EQ(server_.stats().frames_received, 0u);
+}
+
+TEST(SecureChannel, FrameAddsHeaderAndTag) {
+  MockTcpSocket socket;
+  const std::array<std::byte, kSecureHelloSize> peer_random{};
+  socket.EnqueueReadData(peer_random);
+  std::array<std::byte, kFrameSize> rx;
+  std::array<std::byte, kFrameSize> tx;
+  SecureChannel channel(socket, {.key = kKey}, rx, tx);
+  ASSERT_EQ(channel.Connect(), pw::OkStatus());
+  EXPECT_EQ(socket.PopWrittenData().size(), kSecureHelloSize);
+
+  ASSERT_EQ(channel.Write(Bytes("hello")), pw::OkStatus());
+  const std::vector<std::byte> first = socket.PopWrittenData();
+  EXPECT_EQ(first.size(), 5 + kSecureFrameOverhead);
+
+  // The counter nonce changes the ciphertext of the same plaintext
+  ASSERT_EQ(channel.Write(Bytes("hello")), pw::OkStatus());
+  EXPECT_TRUE(socket.PopWrittenData() != first);
+}
+
+TEST(SecureChannel, RejectsWrongKeySize) {
+  MockTcpSocket socket;
+  std::array<std::byte, kFrameSize> rx;
+  std::array<std::byte, kFrameSize> tx;
+  SecureChannel channel(
+      socket, {.key = pw::ConstByteSpan(kKey).first(8)}, rx, tx);
+  EXPECT_EQ(channel.Connect(), pw::Status::InvalidArgument());
+}
+
+}  // namespace
+}  // namespace pb::socket
@@ -0,0 +1,277 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "sim_tcp_socket.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+#include "pw_thread/sleep.h"
+
+namespace pb::socket {
+namespace {
+
+// TCP/IP headers sent with every segment
+constexpr size_t kHeaderBytes = 40;
+
+constexpr auto kMaxSleep = std::chrono::milliseconds(1);
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// SimTcpSocket
+// ---------------------------------------------------------------------------
+
+pw::Status SimTcpSocket::Connect() { return link_.Connect(index_); }
+
+void SimTcpSocket::Disconnect() { link_.Disconnect(index_); }
+
+bool SimTcpSocket::IsConnected() const {
+  return link_.State(index_) == TcpState::kConnected;
+}
+
+TcpState SimTcpSocket::state() const { return link_.State(index_); }
+
+pw::StatusWithSize SimTcpSocket::Read(pw::ByteSpan dest) {
+  return link_.Read(index_, dest);
+}
+
+pw::Status SimTcpSocket::Write(pw::ConstByteSpan data) {
+  return link_.Write(index_, data);
+}
+
+// ---------------------------------------------------------------------------
+// SimTcpLink
+// ---------------------------------------------------------------------------
+
+SimTcpLink::SimTcpLink(const SimTcpLinkConfig& config)
+    : config_(config),
+      latency_(std::chrono::milliseconds(config.latency_ms)),
+      ends_{SimTcpSocket(*this, 0), SimTcpSocket(*this, 1)} {}
+
+void SimTcpLink::set_accepting(bool accepting) {
+  std::lock_guard lock(lock_);
+  accepting_ = accepting;
+}
+
+SimTcpDirectionStats SimTcpLink::client_to_server() const {
+  std::lock_guard lock(lock_);
+  return directions_[0].stats;
+}
+
+SimTcpDirectionStats SimTcpLink::server_to_client() const {
+  std::lock_guard lock(lock_);
+  return directions_[1].stats;
+}
+
+pw::Status SimTcpLink::Connect(size_t index) {
+  {
+    std::lock_guard lock(lock_);
+    if (states_[index] == TcpState::kConnected) {
+      return pw::Status::Unavailable();
+    }
+    if (!accepting_) {
+      states_[index] = TcpState::kError;
+      return pw::Status::Unavailable();
+    }
+    states_[index] = TcpState::kConnecting;
+  }
+
+  // SYN, SYN-ACK: one round trip before data can flow
+  pw::this_thread::sleep_for(2 * latency_);
+
+  std::lock_guard lock(lock_);
+  const Clock::time_point now = Clock::now();
+  for (size_t i = 0; i < 2; ++i) {
+    const SimTcpDirectionStats stats = directions_[i].stats;
+    directions_[i] = Direction{};
+    directions_[i].wire_free = now;
+    directions_[i].ready_at = now;
+    directions_[i].stats = stats;
+    states_[i] = TcpState::kConnected;
+  }
+  return pw::OkStatus();
+}
+
+void SimTcpLink::Disconnect(size_t index) {
+  std::lock_guard lock(lock_);
+  Advance(Clock::now());
+  if (states_[index] == TcpState::kConnected) {
+    // Data already written still reaches the peer, followed by the FIN
+    directions_[index].closed = true;
+  }
+  directions_[1 - index].send_queue.clear();
+  states_[index] = TcpState::kDisconnected;
+}
+
+TcpState SimTcpLink::State(size_t index) const {
+  std::lock_guard lock(lock_);
+  return states_[index];
+}
+
+pw::StatusWithSize SimTcpLink::Read(size_t index, pw::ByteSpan dest) {
+  const Clock::time_point deadline =
+      Clock::now() + std::chrono::milliseconds(config_.read_timeout_ms);
+  while (true) {
+    Clock::time_point wake;
+    {
+      std::lock_guard lock(lock_);
+      if (states_[index] != TcpState::kConnected) {
+        return pw::StatusWithSize::FailedPrecondition();
+      }
+      const Clock::time_point now = Clock::now();
+      Advance(now);
+
+      Direction& incoming = directions_[1 - index];
+      if (!incoming.received.empty()) {
+        const size_t count = std::min(dest.size(), incoming.received.size());
+        std::copy_n(incoming.received.begin(), count, dest.begin());
+        incoming.received.erase(incoming.received.begin(),
+                                incoming.received.begin() + count);
+        // The window update lets the peer send again
+        incoming.ready_at = now;
+        return pw::StatusWithSize(count);
+      }
+      if (incoming.closed && incoming.send_queue.empty() &&
+          incoming.in_flight.empty()) {
+        states_[index] = TcpState::kDisconnected;
+        return pw::StatusWithSize::OutOfRange();
+      }
+      if (now >= deadline) {
+        return pw::StatusWithSize(0);
+      }
+      wake = std::min(NextEvent(now), deadline);
+    }
+    pw::this_thread::sleep_until(wake);
+  }
+}
+
+pw::Status SimTcpLink::Write(size_t index, pw::ConstByteSpan data) {
+  const Clock::time_point deadline =
+      Clock::now() + std::chrono::milliseconds(config_.write_timeout_ms);
+  bool stalled = false;
+  while (true) {
+    Clock::time_point wake;
+    {
+      std::lock_guard lock(lock_);
+      if (states_[index] != TcpState::kConnected) {
+        return pw::Status::FailedPrecondition();
+      }
+      const Clock::time_point now = Clock::now();
+      Advance(now);
+
+      Direction& outgoing = directions_[index];
+      if (directions_[1 - index].closed) {
+        // LwIP closes both directions; the peer answers with a reset
+        states_[index] = TcpState::kError;
+        return pw::Status::Internal();
+      }
+      const size_t space = config_.send_buffer - std::min(config_.send_buffer,
+                                                          Buffered(outgoing));
+      const size_t count = std::min(space, data.size());
+      if (count > 0) {
+        outgoing.send_queue.insert(
+            outgoing.send_queue.end(), data.begin(), data.begin() + count);
+        outgoing.ready_at = std::max(outgoing.ready_at, now);
+        data = data.subspan(count);
+        Advance(outgoing, now);
+      }
+      if (data.empty()) {
+        return pw::OkStatus();
+      }
+      if (now >= deadline) {
+        states_[index] = TcpState::kError;
+        return pw::Status::Internal();
+      }
+      if (!stalled) {
+        stalled = true;
+        ++outgoing.stats.write_stalls;
+      }
+      wake = std::min(NextEvent(now), deadline);
+    }
+    pw::this_thread::sleep_until(wake);
+  }
+}
+
+void SimTcpLink::Advance(Clock::time_point now) {
+  Advance(directions_[0], now);
+  Advance(directions_[1], now);
+}
+
+void SimTcpLink::Advance(Direction& direction, Clock::time_point now) {
+  // Deliver arrived segments in order, then drop the acked ones
+  for (Segment& segment : direction.segments) {
+    if (segment.arrival > now) {
+      break;
+    }
+    if (!segment.delivered) {
+      segment.delivered = true;
+      direction.received.insert(direction.received.end(),
+                                direction.in_flight.begin(),
+                                direction.in_flight.begin() + segment.size);
+      direction.in_flight.erase(direction.in_flight.begin(),
+                                direction.in_flight.begin() + segment.size);
+      direction.stats.bytes += static_cast<uint32_t>(segment.size);
+    }
+  }
+  while (!direction.segments.empty() &&
+         direction.segments.front().acked <= now) {
+    direction.unacked -= direction.segments.front().size;
+    direction.segments.pop_front();
+  }
+
+  // Send what the receive window allows, back to back on the wire
+  while (!direction.send_queue.empty()) {
+    const size_t window_used =
+        direction.received.size() + direction.in_flight.size();
+    const size_t window =
+        config_.receive_window - std::min(config_.receive_window, window_used);
+    const size_t size =
+        std::min({config_.mss, window, direction.send_queue.size()});
+    if (size == 0) {
+      break;
+    }
+    const Clock::time_point departure =
+        std::max(direction.wire_free, direction.ready_at);
+    direction.wire_free = departure + SerializationTime(size + kHeaderBytes);
+    const Clock::time_point arrival = direction.wire_free + latency_;
+    direction.segments.push_back(Segment{
+        .arrival = arrival,
+        .acked = arrival + latency_,
+        .size = size,
+    });
+    direction.in_flight.insert(direction.in_flight.end(),
+                               direction.send_queue.begin(),
+                               direction.send_queue.begin() + size);
+    direction.send_queue.erase(direction.send_queue.begin(),
+                               direction.send_queue.begin() + size);
+    direction.unacked += size;
+    ++direction.stats.segments;
+  }
+}
+
+SimTcpLink::Clock::time_point SimTcpLink::NextEvent(
+    Clock::time_point now) const {
+  Clock::time_point next = now + kMaxSleep;
+  for (const Direction& direction : directions_) {
+    for (const Segment& segment : direction.segments) {
+      const Clock::time_point event =
+          segment.delivered ? segment.acked : segment.arrival;
+      if (event > now) {
+        next = std::min(next, event);
+      }
+    }
+  }
+  return next;
+}
+
+SimTcpLink::Clock::duration SimTcpLink::SerializationTime(size_t bytes) const {
+  if (config_.bandwidth_bps == 0) {
+    return Clock::duration::zero();
+  }
+  return std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(
+      uint64_t{bytes} * 8 * 1'000'000'000u / config_.bandwidth_bps));
+}
+
+}  // namespace pb::socket
@@ -0,0 +1,167 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file sim_tcp_socket.h
+/// @brief Host TCP link with a timing model, for performance tests.
+///
+/// MockTcpSocket hands data over instantly. SimTcpLink connects two
+/// TcpSocket ends through a model of an LwIP connection instead: writes
+/// fill a bounded send buffer, leave in MSS-sized segments at the link
+/// rate, arrive after the one-way latency and are only sent while the
+/// receiver's window has room. Acks free the send buffer one latency later.
+/// Time is host time (pw::chrono::SystemClock), so framing, pw_rpc or TLS
+/// code on top of a TcpSocket can be profiled under a given throughput.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+#include "pb_socket/tcp_socket.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_sync/mutex.h"
+
+namespace pb::socket {
+
+/// Link model of a SimTcpLink. Both directions use the same settings.
+struct SimTcpLinkConfig {
+  /// Link rate per direction in bits per second (0 = unlimited)
+  uint32_t bandwidth_bps = 10'000'000;
+  /// One-way delay in milliseconds
+  uint32_t latency_ms = 5;
+  /// Largest segment payload
+  size_t mss = 1460;
+  /// Bytes a Write() may queue before it blocks (LwIP TCP_SND_BUF)
+  size_t send_buffer = 4 * 1460;
+  /// Unread bytes a receiver accepts (LwIP TCP_WND)
+  size_t receive_window = 4 * 1460;
+  /// How long Read() waits for data (0 = non-blocking), as in TcpConfig
+  uint32_t read_timeout_ms = 0;
+  /// How long Write() waits for send buffer space before failing
+  uint32_t write_timeout_ms = 5000;
+};
+
+/// Counters of one direction of a SimTcpLink.
+struct SimTcpDirectionStats {
+  uint32_t bytes = 0;        ///< Payload bytes delivered to the receiver
+  uint32_t segments = 0;     ///< Segments sent
+  uint32_t write_stalls = 0; ///< Write() calls that waited for buffer space
+};
+
+class SimTcpLink;
+
+/// One end of a SimTcpLink.
+///
+/// Connect() on either end takes one round trip and connects both ends;
+/// the other end plays the accepted socket. Disconnect() closes the
+/// connection: the peer reads the remaining data, then OutOfRange.
+class SimTcpSocket : public TcpSocket {
+ public:
+  pw::Status Connect() override;
+  void Disconnect() override;
+  bool IsConnected() const override;
+  TcpState state() const override;
+  int last_error() const override { return 0; }
+  pw::StatusWithSize Read(pw::ByteSpan dest) override;
+  pw::Status Write(pw::ConstByteSpan data) override;
+
+ private:
+  friend class SimTcpLink;
+
+  SimTcpSocket(SimTcpLink& link, size_t index) : link_(link), index_(index) {}
+
+  SimTcpLink& link_;
+  size_t index_;
+};
+
+/// Two connected TcpSocket ends with an LwIP-like timing model.
+///
+/// Usage:
+/// @code
+///   pb::socket::SimTcpLink link({.bandwidth_bps = 1'000'000,
+///                                .latency_ms = 30});
+///   PW_TRY(link.client().Connect());
+///
+///   // Code under test talks to link.client(); a test thread serves
+///   // link.server(), e.g. as an echo server.
+/// @endcode
+class SimTcpLink {
+ public:
+  explicit SimTcpLink(const SimTcpLinkConfig& config = {});
+
+  SimTcpLink(const SimTcpLink&) = delete;
+  SimTcpLink& operator=(const SimTcpLink&) = delete;
+
+  /// The connecting end (the device side in most tests).
+  SimTcpSocket& client() { return ends_[0]; }
+
+  /// The other end (the server side).
+  SimTcpSocket& server() { return ends_[1]; }
+
+  /// While false, Connect() fails with Unavailable (connection refused).
+  void set_accepting(bool accepting);
+
+  /// Counters of the client-to-server and server-to-client directions.
+  SimTcpDirectionStats client_to_server() const;
+  SimTcpDirectionStats server_to_client() const;
+
+ private:
+  friend class SimTcpSocket;
+
+  using Clock = pw::chrono::SystemClock;
+
+  struct Segment {
+    Clock::time_point arrival;
+    Clock::time_point acked;
+    size_t size;
+    bool delivered = false;
+  };
+
+  /// Data flowing from ends_[i] to ends_[1 - i].
+  struct Direction {
+    std::deque<std::byte> send_queue;  // Written, not yet segmented
+    std::deque<std::byte> in_flight;   // Payload not yet delivered
+    std::deque<Segment> segments;      // Sent, not yet acked
+    size_t unacked = 0;                // Payload bytes of `segments`
+    std::deque<std::byte> received;    // Delivered, not yet read
+    Clock::time_point wire_free{};     // End of the last serialization
+    Clock::time_point ready_at{};      // Last time sending became possible
+    bool closed = false;               // Sender has disconnected
+    SimTcpDirectionStats stats;
+  };
+
+  pw::Status Connect(size_t index);
+  void Disconnect(size_t index);
+  TcpState State(size_t index) const;
+  pw::StatusWithSize Read(size_t index, pw::ByteSpan dest);
+  pw::Status Write(size_t index, pw::ConstByteSpan data);
+
+  /// Moves both directions forward to `now`. Must be called with lock_ held.
+  void Advance(Clock::time_point now);
+  void Advance(Direction& direction, Clock::time_point now);
+
+  /// Bytes the sender still accounts to its send buffer.
+  static size_t Buffered(const Direction& direction) {
+    return direction.send_queue.size() + direction.unacked;
+  }
+
+  /// When the next segment arrives or is acked, bounded to 1 ms so that
+  /// actions of the peer on another thread are noticed.
+  Clock::time_point NextEvent(Clock::time_point now) const;
+
+  Clock::duration SerializationTime(size_t bytes) const;
+
+  const SimTcpLinkConfig config_;
+  const Clock::duration latency_;
+  std::array<SimTcpSocket, 2> ends_;
+
+  mutable pw::sync::Mutex lock_;
+  std::array<Direction, 2> directions_;
+  std::array<TcpState, 2> states_ = {TcpState::kDisconnected,
+                                     TcpState::kDisconnected};
+  bool accepting_ = true;
+};
+
+}  // namespace pb::socket
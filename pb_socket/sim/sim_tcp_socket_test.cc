@@ -0,0 +1,93 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "sim_tcp_socket.h"
+
+#include <array>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_unit_test/framework.h"
+
+namespace pb::socket {
+namespace {
+
+using pw::chrono::SystemClock;
+
+// Reads from `socket` until the peer closes. Runs on its own thread.
+std::vector<std::byte> ReadUntilClosed(TcpSocket& socket) {
+  std::vector<std::byte> received;
+  std::array<std::byte, 512> buffer;
+  while (true) {
+    pw::StatusWithSize result = socket.Read(buffer);
+    if (!result.ok()) {
+      break;
+    }
+    received.insert(
+        received.end(), buffer.begin(), buffer.begin() + result.size());
+  }
+  return received;
+}
+
+TEST(SimTcpLink, TransferTakesLinkTime) {
+  constexpr size_t kSize = 20000;
+  constexpr uint32_t kBandwidthBps = 1'000'000;
+  SimTcpLink link({.bandwidth_bps = kBandwidthBps,
+                   .latency_ms = 10,
+                   .read_timeout_ms = 100});
+  ASSERT_EQ(link.client().Connect(), pw::OkStatus());
+  EXPECT_TRUE(link.server().IsConnected());
+
+  std::vector<std::byte> sent(kSize);
+  for (size_t i = 0; i < kSize; ++i) {
+    sent[i] = static_cast<std::byte>(i * 13);
+  }
+  std::vector<std::byte> received;
+  std::thread server([&] { received = ReadUntilClosed(link.server()); });
+
+  const auto start = SystemClock::now();
+  EXPECT_EQ(link.client().Write(sent), pw::OkStatus());
+  link.client().Disconnect();
+  server.join();
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      SystemClock::now() - start);
+
+  const SimTcpDirectionStats stats = link.client_to_server();
+  PW_LOG_INFO("%u bytes in %u segments, %u ms",
+              static_cast<unsigned>(stats.bytes),
+              static_cast<unsigned>(stats.segments),
+              static_cast<unsigned>(elapsed.count()));
+
+  EXPECT_TRUE(received == sent);
+  EXPECT_EQ(stats.bytes, kSize);
+  EXPECT_GT(stats.write_stalls, 0u);
+  // The payload alone needs kSize * 8 / kBandwidthBps on the wire
+  EXPECT_GE(elapsed.count(), static_cast<int64_t>(kSize * 8 * 1000 /
+                                                  kBandwidthBps));
+}
+
+TEST(SimTcpLink, RefusedConnection) {
+  SimTcpLink link;
+  link.set_accepting(false);
+  EXPECT_EQ(link.client().Connect(), pw::Status::Unavailable());
+  EXPECT_EQ(link.client().state(), TcpState::kError);
+
+  link.set_accepting(true);
+  EXPECT_EQ(link.client().Connect(), pw::OkStatus());
+}
+
+TEST(SimTcpLink, WriteAfterPeerClosedFails) {
+  SimTcpLink link;
+  ASSERT_EQ(link.client().Connect(), pw::OkStatus());
+  link.server().Disconnect();
+
+  std::array<std::byte, 4> data{};
+  EXPECT_EQ(link.client().Write(data), pw::Status::Internal());
+  EXPECT_EQ(link.client().state(), TcpState::kError);
+}
+
+}  // namespace
+}  // namespace pb::socket
@@ -0,0 +1,330 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#define PW_LOG_MODULE_NAME "pb_socket"
+
+#include "pb_socket/tls_socket.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "mbedtls/net_sockets.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_status/try.h"
+#include "pw_thread/sleep.h"
+#include "rng_hal.h"
+
+namespace pb::socket {
+
+namespace {
+
+using pw::chrono::SystemClock;
+
+// Wait between handshake steps when the wrapped socket had no data yet
+constexpr auto kHandshakePollInterval = std::chrono::milliseconds(10);
+
+// Wait before retrying a write the wrapped socket couldn't take yet
+constexpr auto kWritePollInterval = std::chrono::milliseconds(10);
+
+constexpr char kDrbgPersonalization[] = "pb_socket_tls";
+
+/// mbedTLS entropy source backed by the hardware RNG.
+int HardwareEntropy(void*, unsigned char* output, size_t len, size_t* olen) {
+  size_t filled = 0;
+  while (filled < len) {
+    const uint32_t random = HAL_RNG_GetRandomNumber();
+    const size_t n = std::min(sizeof(random), len - filled);
+    std::memcpy(output + filled, &random, n);
+    filled += n;
+  }
+  *olen = len;
+  return 0;
+}
+
+}  // namespace
+
+TlsSocket::TlsSocket(TcpSocket& socket, const TlsConfig& config)
+    : socket_(socket), config_(config) {
+  mbedtls_entropy_init(&entropy_);
+  mbedtls_ctr_drbg_init(&ctr_drbg_);
+  mbedtls_x509_crt_init(&ca_chain_);
+  mbedtls_ssl_config_init(&ssl_config_);
+  mbedtls_ssl_init(&ssl_);
+  mbedtls_ssl_session_init(&session_);
+}
+
+TlsSocket::~TlsSocket() {
+  Disconnect();
+  mbedtls_ssl_session_free(&session_);
+  mbedtls_ssl_free(&ssl_);
+  mbedtls_ssl_config_free(&ssl_config_);
+  mbedtls_x509_crt_free(&ca_chain_);
+  mbedtls_ctr_drbg_free(&ctr_drbg_);
+  mbedtls_entropy_free(&entropy_);
+}
+
+pw::Status TlsSocket::Setup() {
+  if (setup_done_) {
+    return pw::OkStatus();
+  }
+  if (config_.ca_certs.empty()) {
+    PW_LOG_ERROR("TLS: no CA certificates configured");
+    return pw::Status::InvalidArgument();
+  }
+  // Without a name any certificate from a trusted CA would be accepted
+  if (config_.server_name == nullptr || config_.server_name[0] == '\0') {
+    PW_LOG_ERROR("TLS: no server name configured");
+    return pw::Status::InvalidArgument();
+  }
+
+  int ret = mbedtls_entropy_add_source(&entropy_, HardwareEntropy, nullptr,
+                                       32, MBEDTLS_ENTROPY_SOURCE_STRONG);
+  if (ret == 0) {
+    ret = mbedtls_ctr_drbg_seed(
+        &ctr_drbg_, mbedtls_entropy_func, &entropy_,
+        reinterpret_cast<const unsigned char*>(kDrbgPersonalization),
+        sizeof(kDrbgPersonalization) - 1);
+  }
+  if (ret != 0) {
+    last_error_ = ret;
+    PW_LOG_ERROR("TLS: DRBG seeding failed: -0x%04x", -ret);
+    return pw::Status::Internal();
+  }
+
+  ret = mbedtls_x509_crt_parse(
+      &ca_chain_,
+      reinterpret_cast<const unsigned char*>(config_.ca_certs.data()),
+      config_.ca_certs.size());
+  if (ret < 0) {
+    last_error_ = ret;
+    PW_LOG_ERROR("TLS: CA certificates can't be parsed: -0x%04x", -ret);
+    return pw::Status::InvalidArgument();
+  }
+
+  ret = mbedtls_ssl_config_defaults(&ssl_config_, MBEDTLS_SSL_IS_CLIENT,
+                                    MBEDTLS_SSL_TRANSPORT_STREAM,
+                                    MBEDTLS_SSL_PRESET_DEFAULT);
+  if (ret != 0) {
+    last_error_ = ret;
+    return pw::Status::Internal();
+  }
+  mbedtls_ssl_conf_authmode(&ssl_config_, MBEDTLS_SSL_VERIFY_REQUIRED);
+  mbedtls_ssl_conf_ca_chain(&ssl_config_, &ca_chain_, nullptr);
+  mbedtls_ssl_conf_rng(&ssl_config_, mbedtls_ctr_drbg_random, &ctr_drbg_);
+  mbedtls_ssl_conf_session_tickets(&ssl_config_,
+                                   config_.resume_sessions
+                                       ? MBEDTLS_SSL_SESSION_TICKETS_ENABLED
+                                       : MBEDTLS_SSL_SESSION_TICKETS_DISABLED);
+
+  ret = mbedtls_ssl_setup(&ssl_, &ssl_config_);
+  if (ret == 0) {
+    ret = mbedtls_ssl_set_hostname(&ssl_, config_.server_name);
+  }
+  if (ret != 0) {
+    last_error_ = ret;
+    return pw::Status::Internal();
+  }
+  mbedtls_ssl_set_bio(&ssl_, this, Send, Recv, nullptr);
+
+  setup_done_ = true;
+  return pw::OkStatus();
+}
+
+pw::Status TlsSocket::Connect() {
+  if (state_ == TcpState::kConnected) {
+    return pw::Status::FailedPrecondition();
+  }
+  PW_TRY(Setup());
+
+  state_ = TcpState::kConnecting;
+  if (pw::Status status = socket_.Connect(); !status.ok()) {
+    last_error_ = socket_.last_error();
+    state_ = TcpState::kError;
+    return status;
+  }
+
+  mbedtls_ssl_session_reset(&ssl_);
+  if (config_.resume_sessions && have_session_) {
+    // If the server no longer knows the session it falls back to a full
+    // handshake by itself
+    mbedtls_ssl_set_session(&ssl_, &session_);
+  }
+
+  if (pw::Status status = Handshake(); !status.ok()) {
+    socket_.Disconnect();
+    state_ = TcpState::kError;
+    return status;
+  }
+
+  if (config_.resume_sessions) {
+    mbedtls_ssl_session_free(&session_);
+    mbedtls_ssl_session_init(&session_);
+    have_session_ = mbedtls_ssl_get_session(&ssl_, &session_) == 0;
+  }
+  state_ = TcpState::kConnected;
+  return pw::OkStatus();
+}
+
+pw::Status TlsSocket::Handshake() {
+  const SystemClock::time_point start = SystemClock::now();
+  const SystemClock::time_point deadline =
+      start + SystemClock::for_at_least(
+                  std::chrono::milliseconds(config_.handshake_timeout_ms));
+
+  while (true) {
+    const int ret = mbedtls_ssl_handshake(&ssl_);
+    if (ret == 0) {
+      break;
+    }
+    if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+      last_error_ = ret;
+      PW_LOG_WARN("TLS handshake failed: -0x%04x", -ret);
+      if (ret == MBEDTLS_ERR_X509_CERT_VERIFY_FAILED) {
+        return pw::Status::Unauthenticated();
+      }
+      return pw::Status::Unavailable();
+    }
+    if (SystemClock::now() >= deadline) {
+      last_error_ = ret;
+      PW_LOG_WARN("TLS handshake timed out");
+      return pw::Status::DeadlineExceeded();
+    }
+    pw::this_thread::sleep_for(
+        SystemClock::for_at_least(kHandshakePollInterval));
+  }
+
+  last_handshake_ms_ = static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          SystemClock::now() - start)
+          .count());
+  PW_LOG_INFO("TLS connected (%s) in %u ms",
+              mbedtls_ssl_get_ciphersuite(&ssl_),
+              static_cast<unsigned>(last_handshake_ms_));
+  return pw::OkStatus();
+}
+
+void TlsSocket::Disconnect() {
+  if (state_ == TcpState::kConnected) {
+    // Best effort; the peer may already be gone
+    mbedtls_ssl_close_notify(&ssl_);
+  }
+  if (state_ != TcpState::kDisconnected) {
+    socket_.Disconnect();
+  }
+  state_ = TcpState::kDisconnected;
+}
+
+bool TlsSocket::IsConnected() const {
+  return state_ == TcpState::kConnected && socket_.IsConnected();
+}
+
+TcpState TlsSocket::state() const {
+  if (state_ == TcpState::kConnected && !socket_.IsConnected()) {
+    return socket_.state();
+  }
+  return state_;
+}
+
+void TlsSocket::Fail(int error) {
+  last_error_ = error;
+  state_ = TcpState::kError;
+  socket_.Disconnect();
+}
+
+pw::StatusWithSize TlsSocket::Read(pw::ByteSpan dest) {
+  if (state_ != TcpState::kConnected) {
+    return pw::StatusWithSize::FailedPrecondition();
+  }
+  const int ret = mbedtls_ssl_read(
+      &ssl_, reinterpret_cast<unsigned char*>(dest.data()), dest.size());
+  if (ret > 0) {
+    return pw::StatusWithSize(static_cast<size_t>(ret));
+  }
+  if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+    return pw::StatusWithSize(0);
+  }
+  if (ret == 0 || ret == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY ||
+      ret == MBEDTLS_ERR_SSL_CONN_EOF) {
+    socket_.Disconnect();
+    state_ = TcpState::kDisconnected;
+    return pw::StatusWithSize::OutOfRange();
+  }
+  PW_LOG_WARN("TLS read failed: -0x%04x", -ret);
+  Fail(ret);
+  return pw::StatusWithSize::Internal();
+}
+
+pw::Status TlsSocket::Write(pw::ConstByteSpan data) {
+  if (state_ != TcpState::kConnected) {
+    return pw::Status::FailedPrecondition();
+  }
+  const auto* bytes = reinterpret_cast<const unsigned char*>(data.data());
+  size_t written = 0;
+  SystemClock::time_point deadline = SystemClock::now();
+  bool deadline_set = false;
+  while (written < data.size()) {
+    const int ret =
+        mbedtls_ssl_write(&ssl_, bytes + written, data.size() - written);
+    if (ret > 0) {
+      written += static_cast<size_t>(ret);
+      deadline_set = false;  // Progress: a new wait starts from scratch
+      continue;
+    }
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+      if (!deadline_set) {
+        deadline = SystemClock::TimePointAfterAtLeast(
+            std::chrono::milliseconds(config_.write_timeout_ms));
+        deadline_set = true;
+      } else if (SystemClock::now() >= deadline) {
+        PW_LOG_WARN("TLS write timed out");
+        Fail(ret);
+        return pw::Status::DeadlineExceeded();
+      }
+      pw::this_thread::sleep_for(
+          SystemClock::for_at_least(kWritePollInterval));
+      continue;
+    }
+    PW_LOG_WARN("TLS write failed: -0x%04x", -ret);
+    Fail(ret);
+    return pw::Status::Internal();
+  }
+  return pw::OkStatus();
+}
+
+void TlsSocket::ForgetSession() {
+  mbedtls_ssl_session_free(&session_);
+  mbedtls_ssl_session_init(&session_);
+  have_session_ = false;
+}
+
+int TlsSocket::Send(void* ctx, const unsigned char* buf, size_t len) {
+  auto& self = *static_cast<TlsSocket*>(ctx);
+  // Write() sends everything or fails
+  pw::Status status = self.socket_.Write(pw::as_bytes(pw::span(buf, len)));
+  if (!status.ok()) {
+    self.last_error_ = self.socket_.last_error();
+    return MBEDTLS_ERR_NET_SEND_FAILED;
+  }
+  return static_cast<int>(len);
+}
+
+int TlsSocket::Recv(void* ctx, unsigned char* buf, size_t len) {
+  auto& self = *static_cast<TlsSocket*>(ctx);
+  pw::StatusWithSize result =
+      self.socket_.Read(pw::as_writable_bytes(pw::span(buf, len)));
+  if (result.status().IsOutOfRange()) {
+    return 0;  // Peer closed the connection
+  }
+  if (!result.ok()) {
+    self.last_error_ = self.socket_.last_error();
+    return MBEDTLS_ERR_NET_RECV_FAILED;
+  }
+  if (result.size() == 0) {
+    return MBEDTLS_ERR_SSL_WANT_READ;
+  }
+  return static_cast<int>(result.size());
+}
+
+}  // namespace pb::socket
@@ -4,14 +4,33 @@
 #include "pb_uart/async_uart.h"
 
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <mutex>
 
-#include "delay_hal.h"
+#include "pb_power/idle.h"
+#include "pb_uart/double_buffered_rx.h"
+#include "pb_uart/usart_io.h"
 #include "pw_assert/check.h"
 #include "pw_async2/waker.h"
+#include "pw_chrono/system_clock.h"
 #include "pw_log/log.h"
-#include "pw_thread_particle/options.h"
+#include "pw_status/try.h"
+#include "pw_sync/thread_notification.h"
+#include "pw_sync/timed_thread_notification.h"
+#include "pw_thread/sleep.h"
+#include "pw_thread/thread.h"
 #include "timer_hal.h"
 
+#ifdef PB_USART_HAL_SIM
+#include "pw_thread_stl/options.h"
+#else
+#include "pb_power/particle_idle.h"
+#include "pw_thread_particle/options.h"
+#endif  // PB_USART_HAL_SIM
+
 namespace pb {
 
 // ---------------------------------------------------------------------------
@@ -25,16 +44,24 @@ ReadFuture::ReadFuture(AsyncUart* uart,
     : uart_(uart),
       buffer_(buffer),
       min_bytes_(min_bytes),
-      timeout_ms_(timeout_ms),
-      start_time_ms_(HAL_Timer_Get_Milli_Seconds()) {}
+      timeout_ms_(timeout_ms) {
+  if (timeout_ms_ != kNoTimeout) {
+    deadline_ = pw::chrono::SystemClock::TimePointAfterAtLeast(
+        std::chrono::milliseconds(timeout_ms_));
+  }
+}
 
 ReadFuture::ReadFuture(ReadFuture&& other) noexcept
     : uart_(other.uart_),
       buffer_(other.buffer_),
       min_bytes_(other.min_bytes_),
       bytes_read_(other.bytes_read_),
+      mode_(other.mode_),
+      delimiter_(other.delimiter_),
+      frame_parser_(other.frame_parser_),
       timeout_ms_(other.timeout_ms_),
-      start_time_ms_(other.start_time_ms_),
+      deadline_(other.deadline_),
+      deadline_armed_(other.deadline_armed_),
       completed_(other.completed_) {
   other.uart_ = nullptr;
   other.buffer_ = {};
@@ -47,8 +74,12 @@ ReadFuture& ReadFuture::operator=(ReadFuture&& other) noexcept {
     buffer_ = other.buffer_;
     min_bytes_ = other.min_bytes_;
     bytes_read_ = other.bytes_read_;
+    mode_ = other.mode_;
+    delimiter_ = other.delimiter_;
+    frame_parser_ = other.frame_parser_;
     timeout_ms_ = other.timeout_ms_;
-    start_time_ms_ = other.start_time_ms_;
+    deadline_ = other.deadline_;
+    deadline_armed_ = other.deadline_armed_;
     completed_ = other.completed_;
 
     other.uart_ = nullptr;
@@ -67,6 +98,315 @@ pw::async2::Poll<pw::StatusWithSize> ReadFuture::Pend(pw::async2::Context& cx) {
   return uart_->TryRead(*this, cx);
 }
 
+// ---------------------------------------------------------------------------
+// RxTap implementation
+// ---------------------------------------------------------------------------
+
+RxTap::~RxTap() {
+  if (uart_ != nullptr) {
+    uart_->RemoveRxTap(*this);
+  }
+}
+
+size_t RxTap::Read(pw::ByteSpan dest) {
+  if (uart_ == nullptr) {
+    return 0;
+  }
+  std::lock_guard lock(uart_->tap_lock_);
+  const pw::ByteSpan history = uart_->tap_history_;
+  uint32_t unread = uart_->tap_head_ - cursor_;
+  if (unread > history.size()) {
+    // Overwritten by newer data - skip to the oldest byte still in the ring
+    dropped_ += unread - static_cast<uint32_t>(history.size());
+    unread = static_cast<uint32_t>(history.size());
+    cursor_ = uart_->tap_head_ - unread;
+  }
+
+  const size_t count = std::min(dest.size(), static_cast<size_t>(unread));
+  const size_t offset = cursor_ % history.size();
+  const size_t first = std::min(count, history.size() - offset);
+  std::memcpy(dest.data(), history.data() + offset, first);
+  std::memcpy(dest.data() + first, history.data(), count - first);
+  cursor_ += static_cast<uint32_t>(count);
+  return count;
+}
+
+pw::async2::Poll<> RxTap::PendReadable(pw::async2::Context& cx) {
+  if (uart_ == nullptr) {
+    return pw::async2::Ready();
+  }
+  std::lock_guard lock(uart_->tap_lock_);
+  if (uart_->tap_head_ != cursor_) {
+    return pw::async2::Ready();
+  }
+  PW_ASYNC_STORE_WAKER(cx, waker_, "Waiting for tapped UART data");
+  has_waker_ = true;
+  return pw::async2::Pending();
+}
+
+// ---------------------------------------------------------------------------
+// WriteFuture implementation
+// ---------------------------------------------------------------------------
+
+WriteFuture::WriteFuture(AsyncUart* uart,
+                         pw::ConstByteSpan data,
+                         WriteCompletion completion)
+    : uart_(uart), data_(data), completion_(completion) {}
+
+WriteFuture::WriteFuture(WriteFuture&& other) noexcept
+    : uart_(other.uart_),
+      data_(other.data_),
+      bytes_written_(other.bytes_written_),
+      completion_(other.completion_),
+      completed_(other.completed_) {
+  other.uart_ = nullptr;
+  other.data_ = {};
+  other.completed_ = true;
+}
+
+WriteFuture& WriteFuture::operator=(WriteFuture&& other) noexcept {
+  if (this != &other) {
+    uart_ = other.uart_;
+    data_ = other.data_;
+    bytes_written_ = other.bytes_written_;
+    completion_ = other.completion_;
+    completed_ = other.completed_;
+
+    other.uart_ = nullptr;
+    other.data_ = {};
+    other.completed_ = true;
+  }
+  return *this;
+}
+
+pw::async2::Poll<pw::Status> WriteFuture::Pend(pw::async2::Context& cx) {
+  if (uart_ == nullptr || completed_) {
+    return pw::async2::Ready(pw::Status::InvalidArgument());
+  }
+  return uart_->TryWrite(*this, cx);
+}
+
+// ---------------------------------------------------------------------------
+// AsyncUartService implementation
+// ---------------------------------------------------------------------------
+
+/// Single background task shared by all initialized AsyncUart instances.
+///
+/// Sleeps on a notification while no future is pending on any port. Futures
+/// release the notification when they park, so the first pending read or
+/// write wakes the task immediately.
+///
+/// On the device it also takes part in low-power idle (pb_power): the
+/// polling stops while the device sleeps, every initialized port wakes it
+/// on RX, and a transmission in progress keeps it awake.
+class AsyncUartService final : public power::IdleParticipant {
+ public:
+  static AsyncUartService& Get() {
+    static AsyncUartService service;
+    return service;
+  }
+
+  pw::Status Register(AsyncUart& uart);
+  void Unregister(AsyncUart& uart);
+
+  /// Sets the DoubleBufferedRx filled by the service passes over `uart`.
+  void SetBlockReceiver(AsyncUart& uart, DoubleBufferedRx* rx);
+
+  /// Wakes the task from its idle sleep. Called after a future parks.
+  void Notify() { notification_.release(); }
+
+  bool PrepareForSleep(power::SleepPlan& plan) override;
+
+  /// Runs a pass right away: data may have arrived during the sleep.
+  void ResumeFromSleep() override { Notify(); }
+
+ private:
+  AsyncUartService() {
+#ifndef PB_USART_HAL_SIM
+    // Lives as long as the firmware, so it never unregisters
+    power::DeviceIdleManager().Register(*this).IgnoreError();
+#endif  // PB_USART_HAL_SIM
+  }
+
+  void Run();
+
+  // Serializes starting and stopping the task (never held by the task)
+  pw::sync::Mutex lifecycle_lock_;
+  pw::sync::Mutex lock_;
+  std::array<AsyncUart*, uart::config::kMaxInstances> instances_{};
+  pw::sync::TimedThreadNotification notification_;
+  pw::sync::ThreadNotification exited_;  // Released as Run() returns
+  pw::Thread thread_;
+  bool started_ = false;
+  bool stop_ = false;  // Protected by lock_
+};
+
+pw::Status AsyncUartService::Register(AsyncUart& uart) {
+  std::lock_guard lifecycle(lifecycle_lock_);
+  std::lock_guard lock(lock_);
+  auto slot = std::find(instances_.begin(), instances_.end(), nullptr);
+  if (slot == instances_.end()) {
+    PW_LOG_ERROR("AsyncUartService: more than %u UARTs",
+                 static_cast<unsigned>(uart::config::kMaxInstances));
+    return pw::Status::ResourceExhausted();
+  }
+  *slot = &uart;
+
+  if (!started_) {
+    // Runs until the last port unregisters; detached once it has stopped.
+    stop_ = false;
+#ifdef PB_USART_HAL_SIM
+    // Host simulation (//pb_uart:usart_hal_sim): a plain std::thread
+    thread_ = pw::Thread(pw::thread::stl::Options(), [this]() { Run(); });
+#else
+    thread_ = pw::Thread(
+        pw::thread::particle::Options()
+            .set_name("uart_svc")
+            .set_priority(uart::config::kServiceThreadPriority)
+            .set_stack_size(uart::config::kServiceThreadStackSize),
+        [this]() { Run(); });
+#endif  // PB_USART_HAL_SIM
+    started_ = true;
+  }
+  return pw::OkStatus();
+}
+
+void AsyncUartService::Unregister(AsyncUart& uart) {
+  std::lock_guard lifecycle(lifecycle_lock_);
+  bool stop = false;
+  {
+    // Taking the lock also waits for a service pass over `uart` to finish.
+    std::lock_guard lock(lock_);
+    auto slot = std::find(instances_.begin(), instances_.end(), &uart);
+    if (slot != instances_.end()) {
+      *slot = nullptr;
+    }
+    stop = started_ && std::all_of(instances_.begin(),
+                                   instances_.end(),
+                                   [](AsyncUart* u) { return u == nullptr; });
+    if (stop) {
+      stop_ = true;
+      started_ = false;
+    }
+  }
+
+  if (stop) {
+    // Last port gone: stop the task so its stack is reclaimed. An event wait
+    // in progress ends within kEventIdleTimeoutMs. Joining would also wait
+    // for the idle task to delete the exited thread, which a busy
+    // higher-priority caller can starve; once Run() has returned, nothing
+    // touches the service, and the detached thread frees its own context.
+    notification_.release();
+    exited_.acquire();
+    thread_.detach();
+  }
+}
+
+void AsyncUartService::SetBlockReceiver(AsyncUart& uart,
+                                        DoubleBufferedRx* rx) {
+  {
+    // Taking the lock also waits for a service pass over `uart` to finish.
+    std::lock_guard lock(lock_);
+    uart.block_rx_ = rx;
+  }
+  if (rx != nullptr) {
+    Notify();
+  }
+}
+
+bool AsyncUartService::PrepareForSleep(power::SleepPlan& plan) {
+  std::lock_guard lock(lock_);
+  for (AsyncUart* uart : instances_) {
+    if (uart == nullptr) {
+      continue;
+    }
+    // Stopping the clocks would cut a transmission (or a bus turnaround)
+    // short
+    if (uart->HasPendingWrite() ||
+        uart->driving_.load(std::memory_order_acquire) ||
+        !uart->TxBufferEmpty()) {
+      return false;
+    }
+    // The last byte may still be in the shift register: one byte time
+    uart->FlushTx();
+    // Also ports without a pending read: their bytes would be lost
+    if (!plan.AddUartWakeup(static_cast<uint16_t>(uart->serial_)).ok()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void AsyncUartService::Run() {
+  PW_LOG_INFO("AsyncUartService: started");
+
+  while (true) {
+    // One pass over all ports: wake the futures that can make progress.
+    size_t active = 0;
+    uint32_t interval_ms = UINT32_MAX;
+    [[maybe_unused]] bool single_port_events = false;
+    [[maybe_unused]] hal_usart_interface_t event_serial{};
+    [[maybe_unused]] bool event_writing = false;
+    [[maybe_unused]] uint32_t event_timeout_ms = 0;
+    {
+      std::lock_guard lock(lock_);
+      if (stop_) {
+        break;
+      }
+      AsyncUart* last_active = nullptr;
+      for (AsyncUart* uart : instances_) {
+        if (uart == nullptr || !uart->Service()) {
+          continue;
+        }
+        ++active;
+        interval_ms = std::min(interval_ms, uart->poll_interval_ms_);
+        last_active = uart;
+        single_port_events = uart->rx_events_;
+        event_serial = uart->serial_;
+        event_writing = uart->tx_events_ &&
+                        (uart->HasPendingWrite() ||
+                         uart->driving_.load(std::memory_order_acquire));
+      }
+      // Notify() can't end an event wait. Bound it by the poll interval of
+      // the other ports, so a future parking on one of them is noticed as
+      // soon as it would be while polling.
+      event_timeout_ms = uart::config::kEventIdleTimeoutMs;
+      for (AsyncUart* uart : instances_) {
+        if (uart != nullptr && uart != last_active) {
+          event_timeout_ms =
+              std::min(event_timeout_ms, uart->poll_interval_ms_);
+        }
+      }
+    }
+
+    if (active == 0) {
+      // Nothing pending on any port - sleep until a future parks.
+      notification_.acquire();
+      continue;
+    }
+
+#if PB_UART_CONFIG_HAL_EVENTS
+    if (active == 1 && single_port_events) {
+      // Block on the RX (and TX) interrupt event of the only active port.
+      uint32_t events = HAL_USART_PVT_EVENT_READABLE;
+      if (event_writing) {
+        events |= HAL_USART_PVT_EVENT_WRITABLE;
+      }
+      hal_usart_pvt_wait_event(event_serial, events, event_timeout_ms);
+      continue;
+    }
+#endif  // PB_UART_CONFIG_HAL_EVENTS
+
+    // Several active ports (or no events): poll. A newly parked future on
+    // another port cuts the sleep short.
+    (void)notification_.try_acquire_for(pw::chrono::SystemClock::for_at_least(
+        std::chrono::milliseconds(interval_ms)));
+  }
+
+  PW_LOG_INFO("AsyncUartService: stopped");
+  exited_.release();
+}
+
 // ---------------------------------------------------------------------------
 // AsyncUart implementation
 // ---------------------------------------------------------------------------
@@ -78,8 +418,16 @@ AsyncUart::AsyncUart(hal_usart_interface_t serial,
     : serial_(serial),
       poll_interval_ms_(poll_interval_ms),
       rx_buffer_(rx_buffer),
-      tx_buffer_(tx_buffer) {
+      tx_buffer_(tx_buffer),
+      read_timer_([this](pw::chrono::SystemClock::time_point) {
+        // Runs in the timer task: the pending read has reached its deadline
+        WakePendingReader(/*force=*/true);
+      }) {
   // Initialize buffers in constructor (matching Wiring's USARTSerial)
+  ConfigureBuffers();
+}
+
+void AsyncUart::ConfigureBuffers() {
   hal_usart_buffer_config_t config = {
       .size = sizeof(hal_usart_buffer_config_t),
       .rx_buffer = reinterpret_cast<uint8_t*>(rx_buffer_.data()),
@@ -89,59 +437,114 @@ AsyncUart::AsyncUart(hal_usart_interface_t serial,
   };
   int result = hal_usart_init_ex(serial_, &config, nullptr);
   PW_ASSERT(result == 0);
+  buffers_configured_ = true;
 }
 
 AsyncUart::~AsyncUart() { Deinit(); }
 
-pw::Status AsyncUart::Init(uint32_t baud_rate) {
+pw::Status AsyncUart::Init(uint32_t baud_rate, uint32_t config) {
+  if (running_.load(std::memory_order_acquire)) {
+    return pw::Status::FailedPrecondition();
+  }
+  // hal_usart_end() in Deinit() releases the ring buffers; hand them to the
+  // HAL again when re-initializing.
+  if (!buffers_configured_) {
+    ConfigureBuffers();
+  }
+
   // Configure baud rate and start (matching Wiring's begin())
-  hal_usart_begin_config(serial_, baud_rate, SERIAL_8N1, nullptr);
+  hal_usart_begin_config(serial_, baud_rate, config, nullptr);
+  MeasureTxCapacity();
 
-  // Start the background polling task
-  running_.store(true, std::memory_order_release);
-  thread_exited_.store(false, std::memory_order_release);
+#if PB_UART_CONFIG_HAL_EVENTS
+  // Prefer the RX/TX interrupt events. Not every port supports them (only
+  // the DMA backed UART does on RTL872x); those ports are polled instead.
+  rx_events_ =
+      hal_usart_pvt_enable_event(serial_, HAL_USART_PVT_EVENT_READABLE) == 0;
+  tx_events_ = rx_events_ && hal_usart_pvt_enable_event(
+                                 serial_, HAL_USART_PVT_EVENT_WRITABLE) == 0;
+#endif  // PB_UART_CONFIG_HAL_EVENTS
 
-  polling_thread_ = pw::Thread(
-      pw::thread::particle::Options()
-          .set_name("uart_poll")
-          .set_priority(3)  // Slightly above default for responsive I/O
-          .set_stack_size(2048),
-      [this]() { PollingTaskLoop(); });
+  // Hand the port to the shared background task
+  PW_TRY(AsyncUartService::Get().Register(*this));
+  running_.store(true, std::memory_order_release);
 
-  PW_LOG_INFO("AsyncUart initialized: baud=%lu, poll=%lums",
+  PW_LOG_INFO("AsyncUart initialized: baud=%lu, poll=%lums, events=%d",
               static_cast<unsigned long>(baud_rate),
-              static_cast<unsigned long>(poll_interval_ms_));
+              static_cast<unsigned long>(poll_interval_ms_),
+              static_cast<int>(rx_events_));
 
   return pw::OkStatus();
 }
 
 void AsyncUart::Deinit() {
-  // TODO(b/async-uart): Thread shutdown doesn't work reliably.
-  //
-  // Root cause: FreeRTOS tasks don't enter eDeleted state until the idle task
-  // cleans them up. os_thread_join() polls eTaskGetState() waiting for
-  // eDeleted, but if we call join() immediately after the thread exits, the
-  // idle task hasn't run yet to set eDeleted, causing an infinite loop.
-  //
-  // Potential fix: Call vTaskDelay(1) before joining to let idle task run.
-  // However, this requires including FreeRTOS headers directly.
-  //
-  // For now, AsyncUart instances should be kept alive for the application
-  // lifetime. See loopback_hardware_test.cc for the workaround pattern.
-  //
-  // Also note: After hal_usart_end(), the UART is de-configured and Init()
-  // cannot be called again without re-constructing the object.
-
   bool was_running = running_.exchange(false, std::memory_order_acq_rel);
   if (was_running) {
-    // Just stop the polling loop - don't try to join/detach
-    // The thread will exit on its own but we can't wait for it
-    PW_LOG_WARN("Deinit: thread cleanup skipped (known issue)");
+    // The shared task no longer touches this port once Unregister returns
+    AsyncUartService::Get().Unregister(*this);
+    read_timer_.Cancel();
+
+#if PB_UART_CONFIG_HAL_EVENTS
+    if (tx_events_) {
+      hal_usart_pvt_disable_event(serial_, HAL_USART_PVT_EVENT_WRITABLE);
+    }
+    if (rx_events_) {
+      hal_usart_pvt_disable_event(serial_, HAL_USART_PVT_EVENT_READABLE);
+    }
+#endif  // PB_UART_CONFIG_HAL_EVENTS
+    rx_events_ = false;
+    tx_events_ = false;
 
     // Shutdown UART
     hal_usart_flush(serial_);
+    ReleaseDirection(/*wait=*/true);
     hal_usart_end(serial_);
+    buffers_configured_ = false;
+
+    // Pending futures complete with FailedPrecondition when polled
+    WakePendingReader(/*force=*/true);
+    WakePendingWriter();
   }
+  // The application may release the tap history once the port is down
+  DisableRxTaps();
+}
+
+pw::Status AsyncUart::Reconfigure(uint32_t baud_rate, uint32_t config) {
+  if (!running_.load(std::memory_order_acquire) || HasPendingWrite()) {
+    return pw::Status::FailedPrecondition();
+  }
+
+  // Let queued TX data leave at the old rate before switching
+  hal_usart_flush(serial_);
+  ReleaseDirection(/*wait=*/true);
+  hal_usart_begin_config(serial_, baud_rate, config, nullptr);
+
+#if PB_UART_CONFIG_HAL_EVENTS
+  // Restarting the peripheral may reset the event mask. If it can't be
+  // re-enabled the background task still polls every kEventIdleTimeoutMs.
+  if ((rx_events_ && hal_usart_pvt_enable_event(
+                         serial_, HAL_USART_PVT_EVENT_READABLE) != 0) ||
+      (tx_events_ && hal_usart_pvt_enable_event(
+                         serial_, HAL_USART_PVT_EVENT_WRITABLE) != 0)) {
+    PW_LOG_WARN("AsyncUart: re-enabling HAL events failed");
+  }
+#endif  // PB_UART_CONFIG_HAL_EVENTS
+
+  MeasureTxCapacity();
+  // Bytes received around the switch may be garbled; start clean
+  (void)uart::DiscardAvailable(serial_);
+
+  PW_LOG_INFO("AsyncUart reconfigured: baud=%lu config=0x%lx",
+              static_cast<unsigned long>(baud_rate),
+              static_cast<unsigned long>(config));
+  return pw::OkStatus();
+}
+
+void AsyncUart::MeasureTxCapacity() {
+  // The HAL may reserve a slot of the ring buffer, so measure the usable
+  // TX capacity instead of assuming tx_buffer_.size().
+  int32_t tx_space = hal_usart_available_data_for_write(serial_);
+  tx_capacity_ = tx_space > 0 ? static_cast<size_t>(tx_space) : 0;
 }
 
 ReadFuture AsyncUart::Read(pw::ByteSpan buffer, size_t min_bytes) {
@@ -154,7 +557,30 @@ ReadFuture AsyncUart::ReadWithTimeout(pw::ByteSpan buffer,
   return ReadFuture(this, buffer, min_bytes, timeout_ms);
 }
 
+ReadFuture AsyncUart::ReadUntil(pw::ByteSpan buffer,
+                                std::byte delimiter,
+                                uint32_t timeout_ms) {
+  ReadFuture future(this, buffer, 1, timeout_ms);
+  future.mode_ = ReadFuture::Mode::kDelimiter;
+  future.delimiter_ = delimiter;
+  return future;
+}
+
+ReadFuture AsyncUart::ReadFrame(pw::ByteSpan buffer,
+                                FrameLengthParser parser,
+                                uint32_t timeout_ms,
+                                size_t received) {
+  PW_CHECK_NOTNULL(parser);
+  PW_CHECK_UINT_LE(received, buffer.size());
+  ReadFuture future(this, buffer, 1, timeout_ms);
+  future.mode_ = ReadFuture::Mode::kFrame;
+  future.frame_parser_ = parser;
+  future.bytes_read_ = received;
+  return future;
+}
+
 pw::Status AsyncUart::Write(pw::ConstByteSpan data) {
+  std::lock_guard tx_lock(tx_lock_);
   // Check if there's enough space in TX buffer (non-blocking write)
   int32_t available = hal_usart_available_data_for_write(serial_);
   if (available < 0 || static_cast<size_t>(available) < data.size()) {
@@ -162,108 +588,505 @@ pw::Status AsyncUart::Write(pw::ConstByteSpan data) {
     return pw::Status::ResourceExhausted();
   }
 
-  for (auto b : data) {
-    hal_usart_write(serial_, static_cast<uint8_t>(b));
+  if (!data.empty()) {
+    AssertDirection();
   }
+  bytes_sent_.Increment(
+      static_cast<uint32_t>(uart::WriteAvailable(serial_, data)));
   // Don't flush - let TX buffer drain asynchronously
   return pw::OkStatus();
 }
 
+pw::StatusWithSize AsyncUart::ReadBuffered(pw::ByteSpan dest) {
+  if (!running_.load(std::memory_order_acquire)) {
+    return pw::StatusWithSize::FailedPrecondition();
+  }
+  {
+    std::lock_guard lock(lock_);
+    if (has_pending_waker_) {
+      return pw::StatusWithSize::FailedPrecondition();
+    }
+    RecordRxBuffered(hal_usart_available(serial_));
+  }
+  const size_t count = uart::ReadAvailable(serial_, dest);
+  bytes_received_.Increment(static_cast<uint32_t>(count));
+  PublishToTaps(dest.first(count));
+  return pw::StatusWithSize(count);
+}
+
+void AsyncUart::WaitForRx(pw::chrono::SystemClock::time_point deadline) {
+  const auto remaining = deadline - pw::chrono::SystemClock::now();
+#if PB_UART_CONFIG_HAL_EVENTS
+  if (rx_events_) {
+    // The background task may wait on the same event; bounding each wait
+    // keeps an event it consumed from stalling the stream read.
+    const int64_t remaining_ms = std::clamp<int64_t>(
+        std::chrono::ceil<std::chrono::milliseconds>(remaining).count(),
+        1,
+        uart::config::kEventIdleTimeoutMs);
+    hal_usart_pvt_wait_event(serial_,
+                             HAL_USART_PVT_EVENT_READABLE,
+                             static_cast<uint32_t>(remaining_ms));
+    return;
+  }
+#endif  // PB_UART_CONFIG_HAL_EVENTS
+  pw::this_thread::sleep_for(std::min<pw::chrono::SystemClock::duration>(
+      pw::chrono::SystemClock::for_at_least(
+          std::chrono::milliseconds(poll_interval_ms_)),
+      remaining));
+}
+
+pw::Status AsyncUart::WriteAll(pw::ConstByteSpan data) {
+  if (!running_.load(std::memory_order_acquire) || HasPendingWrite()) {
+    return pw::Status::FailedPrecondition();
+  }
+  std::lock_guard tx_lock(tx_lock_);
+  if (!data.empty()) {
+    AssertDirection();
+  }
+  uart::WriteAll(serial_, data);
+  bytes_sent_.Increment(static_cast<uint32_t>(data.size()));
+  return pw::OkStatus();
+}
+
+WriteFuture AsyncUart::WriteAsync(pw::ConstByteSpan data,
+                                  WriteCompletion completion) {
+  return WriteFuture(this, data, completion);
+}
+
+bool AsyncUart::TxBufferEmpty() const {
+  int32_t space = hal_usart_available_data_for_write(serial_);
+  return space >= 0 && static_cast<size_t>(space) >= tx_capacity_;
+}
+
+pw::Status AsyncUart::EnableDirectionControl(
+    pw::digital_io::DigitalOut& direction) {
+  std::lock_guard tx_lock(tx_lock_);
+  if (driving_.load(std::memory_order_acquire)) {
+    return pw::Status::FailedPrecondition();
+  }
+  PW_TRY(direction.SetState(pw::digital_io::State::kInactive));
+  direction_ = &direction;
+  return pw::OkStatus();
+}
+
+void AsyncUart::DisableDirectionControl() {
+  std::lock_guard tx_lock(tx_lock_);
+  if (driving_.load(std::memory_order_acquire)) {
+    hal_usart_flush(serial_);
+    ReleaseDirectionLocked();
+  }
+  direction_ = nullptr;
+}
+
+void AsyncUart::AssertDirection() {
+  if (direction_ == nullptr || driving_.load(std::memory_order_acquire)) {
+    return;
+  }
+  direction_->SetState(pw::digital_io::State::kActive).IgnoreError();
+  driving_.store(true, std::memory_order_release);
+  // The shared task releases the driver once the line is idle. It can't
+  // before this data is queued, since that needs tx_lock_.
+  AsyncUartService::Get().Notify();
+}
+
+void AsyncUart::ReleaseDirection(bool wait) {
+  if (!driving_.load(std::memory_order_acquire)) {
+    return;
+  }
+  std::unique_lock tx_lock(tx_lock_, std::defer_lock);
+  if (wait) {
+    tx_lock.lock();
+  } else if (!tx_lock.try_lock()) {
+    return;  // More data is being queued
+  }
+  if (!driving_.load(std::memory_order_acquire) || !TxBufferEmpty()) {
+    return;  // Released meanwhile, or data still in the ring buffer
+  }
+  // The ring buffer is empty, so this only waits for the last character in
+  // the shift register (the TX complete flag).
+  hal_usart_flush(serial_);
+  ReleaseDirectionLocked();
+}
+
+void AsyncUart::ReleaseDirectionLocked() {
+  if (direction_ != nullptr) {
+    direction_->SetState(pw::digital_io::State::kInactive).IgnoreError();
+  }
+  driving_.store(false, std::memory_order_release);
+}
+
 void AsyncUart::Drain() {
   // Single-pass drain - read all currently available bytes.
   // If caller needs to catch in-flight bytes, they should use async delays.
-  while (hal_usart_available(serial_) > 0) {
-    (void)hal_usart_read(serial_);
+  (void)uart::DiscardAvailable(serial_);
+}
+
+pw::Status AsyncUart::EnableRxTaps(pw::ByteSpan history) {
+  std::lock_guard lock(tap_lock_);
+  for (RxTap* tap : taps_) {
+    if (tap != nullptr) {
+      return pw::Status::FailedPrecondition();
+    }
   }
+  tap_history_ = history;
+  tap_head_ = 0;
+  return pw::OkStatus();
 }
 
-void AsyncUart::PollingTaskLoop() {
-  PW_LOG_INFO("PollingTaskLoop: started");
-  uint32_t polls_since_wake = 0;
-  constexpr uint32_t kWakeIntervalPolls = 10;  // Wake every 10 polls for timeout checks
+pw::Status AsyncUart::AddRxTap(RxTap& tap) {
+  std::lock_guard lock(tap_lock_);
+  if (tap_history_.empty() || tap.uart_ != nullptr) {
+    return pw::Status::FailedPrecondition();
+  }
+  auto slot = std::find(taps_.begin(), taps_.end(), nullptr);
+  if (slot == taps_.end()) {
+    return pw::Status::ResourceExhausted();
+  }
+  *slot = &tap;
+  tap.uart_ = this;
+  tap.cursor_ = tap_head_;
+  tap.dropped_ = 0;
+  return pw::OkStatus();
+}
 
-  while (running_.load(std::memory_order_acquire)) {
-    // Check if data is available
-    int32_t available = hal_usart_available(serial_);
+void AsyncUart::RemoveRxTap(RxTap& tap) {
+  std::lock_guard lock(tap_lock_);
+  auto slot = std::find(taps_.begin(), taps_.end(), &tap);
+  if (slot != taps_.end()) {
+    *slot = nullptr;
+  }
+  tap.uart_ = nullptr;
+  tap.has_waker_ = false;
+}
 
-    // Wake the pending future if:
-    // 1. Data is available, OR
-    // 2. Enough polls have passed (to allow timeout checking)
-    bool should_wake_for_timeout = (++polls_since_wake >= kWakeIntervalPolls);
+void AsyncUart::DisableRxTaps() {
+  std::array<pw::async2::Waker, uart::config::kMaxRxTaps> wakers;
+  {
+    std::lock_guard lock(tap_lock_);
+    for (size_t i = 0; i < taps_.size(); ++i) {
+      if (taps_[i] == nullptr) {
+        continue;
+      }
+      if (taps_[i]->has_waker_) {
+        wakers[i] = std::move(taps_[i]->waker_);
+        taps_[i]->has_waker_ = false;
+      }
+      taps_[i]->uart_ = nullptr;
+      taps_[i] = nullptr;
+    }
+    tap_history_ = {};
+    tap_head_ = 0;
+  }
+  // Detached taps read nothing; PendReadable() returns Ready
+  for (pw::async2::Waker& waker : wakers) {
+    waker.Wake();
+  }
+}
 
-    if (available > 0 || should_wake_for_timeout) {
-      // Copy waker under lock, then wake outside lock to avoid deadlock.
-      // Wake() acquires internal pw_async2 locks, so we must not hold our
-      // spinlock while calling it.
-      pw::async2::Waker waker_copy;
-      bool should_wake = false;
-      {
-        std::lock_guard lock(lock_);
-        if (has_pending_waker_) {
-          waker_copy = std::move(pending_waker_);
-          has_pending_waker_ = false;
-          should_wake = true;
-        }
+void AsyncUart::PublishToTaps(pw::ConstByteSpan data) {
+  std::array<pw::async2::Waker, uart::config::kMaxRxTaps> wakers;
+  {
+    std::lock_guard lock(tap_lock_);
+    if (tap_history_.empty() || data.empty()) {
+      return;
+    }
+    // Only the newest history.size() bytes can be kept
+    const size_t size = tap_history_.size();
+    const uint32_t skipped =
+        static_cast<uint32_t>(data.size() > size ? data.size() - size : 0);
+    tap_head_ += skipped;
+    data = data.subspan(skipped);
+
+    const size_t offset = tap_head_ % size;
+    const size_t first = std::min(data.size(), size - offset);
+    std::memcpy(tap_history_.data() + offset, data.data(), first);
+    std::memcpy(tap_history_.data(), data.data() + first, data.size() - first);
+    tap_head_ += static_cast<uint32_t>(data.size());
+
+    for (size_t i = 0; i < taps_.size(); ++i) {
+      if (taps_[i] != nullptr && taps_[i]->has_waker_) {
+        wakers[i] = std::move(taps_[i]->waker_);
+        taps_[i]->has_waker_ = false;
+      }
+    }
+  }
+  // Wake outside the lock, same as WakePendingReader()
+  for (pw::async2::Waker& waker : wakers) {
+    waker.Wake();
+  }
+}
+
+AsyncUartStats AsyncUart::stats() const {
+  return AsyncUartStats{
+      .bytes_received = bytes_received_.value(),
+      .bytes_sent = bytes_sent_.value(),
+      .reads_completed = reads_completed_.value(),
+      .read_timeouts = read_timeouts_.value(),
+      .rx_peak_buffered = rx_peak_buffered_.value(),
+      .rx_buffer_full = rx_buffer_full_.value(),
+      .wake_latency_last_us = wake_latency_last_us_.value(),
+      .wake_latency_max_us = wake_latency_max_us_.value(),
+  };
+}
+
+void AsyncUart::ResetStats() {
+  bytes_received_.Set(0);
+  bytes_sent_.Set(0);
+  reads_completed_.Set(0);
+  read_timeouts_.Set(0);
+  rx_peak_buffered_.Set(0);
+  rx_buffer_full_.Set(0);
+  wake_latency_last_us_.Set(0);
+  wake_latency_max_us_.Set(0);
+}
+
+void AsyncUart::RecordRxBuffered(int32_t available) {
+  if (available <= 0) {
+    rx_was_full_ = false;
+    return;
+  }
+  const uint32_t buffered = static_cast<uint32_t>(available);
+  if (buffered > rx_peak_buffered_.value()) {
+    rx_peak_buffered_.Set(buffered);
+  }
+  // The HAL ring buffer keeps one slot free; count each time it fills up
+  const bool full = buffered + 1 >= rx_buffer_.size();
+  if (full && !rx_was_full_) {
+    rx_buffer_full_.Increment();
+  }
+  rx_was_full_ = full;
+}
+
+void AsyncUart::RecordWakeLatency() {
+  uint32_t woken_at_us;
+  {
+    std::lock_guard lock(lock_);
+    if (!reader_woken_) {
+      return;
+    }
+    reader_woken_ = false;
+    woken_at_us = reader_woken_at_us_;
+  }
+  const uint32_t latency_us = HAL_Timer_Get_Micro_Seconds() - woken_at_us;
+  wake_latency_last_us_.Set(latency_us);
+  if (latency_us > wake_latency_max_us_.value()) {
+    wake_latency_max_us_.Set(latency_us);
+  }
+}
+
+void AsyncUart::SetBlockReceiver(DoubleBufferedRx* rx) {
+  AsyncUartService::Get().SetBlockReceiver(*this, rx);
+}
+
+void AsyncUart::NotifyService() { AsyncUartService::Get().Notify(); }
+
+bool AsyncUart::Service() {
+  // Turn the bus around first: the peer may answer right after the last
+  // stop bit
+  ReleaseDirection();
+  {
+    // Sampled on every pass, also while only a write or a DoubleBufferedRx
+    // is active. Bytes piling up while the task sleeps keep the ring buffer
+    // at its peak until the next read samples it.
+    std::lock_guard lock(lock_);
+    RecordRxBuffered(hal_usart_available(serial_));
+  }
+  // Keep draining the ring buffer into the free half while the application
+  // processes the other one
+  bool filling = false;
+  if (block_rx_ != nullptr && block_rx_->wants_data()) {
+    block_rx_->Fill();
+    filling = block_rx_->wants_data();
+  }
+  if (!HasPendingFutures()) {
+    return filling;
+  }
+  WakePendingReader();
+  // Wake the pending writer whenever the UART has drained some TX data
+  if (hal_usart_available_data_for_write(serial_) > 0) {
+    WakePendingWriter();
+  }
+  // A woken future re-parks (and notifies the service) if it still waits
+  return filling || HasPendingFutures();
+}
+
+bool AsyncUart::HasPendingFutures() {
+  std::lock_guard lock(lock_);
+  return has_pending_waker_ || has_pending_write_waker_ ||
+         driving_.load(std::memory_order_acquire);
+}
+
+bool AsyncUart::HasPendingWrite() {
+  std::lock_guard lock(lock_);
+  return has_pending_write_waker_;
+}
+
+void AsyncUart::WakePendingReader(bool force) {
+  // Copy waker under lock, then wake outside lock to avoid deadlock.
+  // Wake() acquires internal pw_async2 locks, so we must not hold our
+  // lock while calling it.
+  pw::async2::Waker waker_copy;
+  bool should_wake = false;
+  {
+    std::lock_guard lock(lock_);
+    if (has_pending_waker_) {
+      // Only wake once the future can make progress towards completion, so a
+      // frame read resumes once per frame instead of once per byte.
+      int32_t available = hal_usart_available(serial_);
+      bool data_ready = available > 0 && static_cast<size_t>(available) >=
+                                             pending_read_threshold_;
+      if (data_ready || force) {
+        waker_copy = std::move(pending_waker_);
+        has_pending_waker_ = false;
+        should_wake = true;
+        reader_woken_ = true;
+        reader_woken_at_us_ = HAL_Timer_Get_Micro_Seconds();
       }
-      if (should_wake) {
-        waker_copy.Wake();
-        polls_since_wake = 0;
+    }
+  }
+  if (should_wake) {
+    waker_copy.Wake();
+  }
+}
+
+void AsyncUart::WakePendingWriter() {
+  // Same lock discipline as WakePendingReader().
+  pw::async2::Waker waker_copy;
+  bool should_wake = false;
+  {
+    std::lock_guard lock(lock_);
+    if (has_pending_write_waker_) {
+      waker_copy = std::move(pending_write_waker_);
+      has_pending_write_waker_ = false;
+      should_wake = true;
+    }
+  }
+  if (should_wake) {
+    waker_copy.Wake();
+  }
+}
+
+size_t AsyncUart::BytesStillNeeded(const ReadFuture& future) {
+  size_t needed = 1;
+  switch (future.mode_) {
+    case ReadFuture::Mode::kMinBytes:
+      needed = future.min_bytes_;
+      break;
+    case ReadFuture::Mode::kDelimiter:
+      return 1;
+    case ReadFuture::Mode::kFrame:
+      needed = future.frame_parser_(future.buffer_.first(future.bytes_read_));
+      break;
+  }
+  return needed > future.bytes_read_ ? needed - future.bytes_read_ : 1;
+}
+
+pw::async2::Poll<pw::StatusWithSize> AsyncUart::ReadForMode(
+    ReadFuture& future) {
+  pw::ByteSpan remaining = future.buffer_.subspan(future.bytes_read_);
+
+  switch (future.mode_) {
+    case ReadFuture::Mode::kMinBytes:
+      // Read whatever is available, up to buffer size, in one bulk copy
+      future.bytes_read_ += uart::ReadAvailable(serial_, remaining);
+      if (future.bytes_read_ >= future.min_bytes_) {
+        return pw::async2::Ready(pw::StatusWithSize(future.bytes_read_));
+      }
+      break;
+
+    case ReadFuture::Mode::kDelimiter: {
+      bool found = false;
+      future.bytes_read_ += uart::ReadUntilDelimiter(
+          serial_, remaining, future.delimiter_, found);
+      if (found) {
+        return pw::async2::Ready(pw::StatusWithSize(future.bytes_read_));
+      }
+      if (future.bytes_read_ == future.buffer_.size()) {
+        return pw::async2::Ready(
+            pw::StatusWithSize::ResourceExhausted(future.bytes_read_));
       }
+      break;
     }
 
-    // Sleep for the poll interval
-    HAL_Delay_Milliseconds(poll_interval_ms_);
+    case ReadFuture::Mode::kFrame:
+      // Read exactly up to the length the parser asks for, so bytes of the
+      // next frame stay in the HAL buffer.
+      while (true) {
+        size_t needed =
+            future.frame_parser_(future.buffer_.first(future.bytes_read_));
+        if (needed == 0) {
+          return pw::async2::Ready(
+              pw::StatusWithSize::DataLoss(future.bytes_read_));
+        }
+        if (needed > future.buffer_.size()) {
+          return pw::async2::Ready(
+              pw::StatusWithSize::ResourceExhausted(future.bytes_read_));
+        }
+        if (future.bytes_read_ >= needed) {
+          return pw::async2::Ready(pw::StatusWithSize(future.bytes_read_));
+        }
+        size_t count = uart::ReadAvailable(
+            serial_,
+            future.buffer_.subspan(future.bytes_read_,
+                                   needed - future.bytes_read_));
+        if (count == 0) {
+          break;
+        }
+        future.bytes_read_ += count;
+      }
+      break;
   }
-  PW_LOG_INFO("PollingTaskLoop: exiting");
-  thread_exited_.store(true, std::memory_order_release);
+  return pw::async2::Pending();
 }
 
 pw::async2::Poll<pw::StatusWithSize> AsyncUart::TryRead(
     ReadFuture& future, pw::async2::Context& cx) {
-  // Check available data
-  int32_t available = hal_usart_available(serial_);
-
-  // Read whatever is available, up to buffer size
-  if (available > 0) {
-    size_t remaining_space = future.buffer_.size() - future.bytes_read_;
-    size_t to_read =
-        std::min(remaining_space, static_cast<size_t>(available));
-
-    for (size_t i = 0; i < to_read; ++i) {
-      int32_t byte = hal_usart_read(serial_);
-      if (byte < 0) {
-        // Unexpected - HAL said bytes were available
-        PW_LOG_WARN("TryRead: hal_usart_read returned %d",
-                    static_cast<int>(byte));
-        break;
-      }
-      future.buffer_[future.bytes_read_++] = static_cast<std::byte>(byte);
-    }
+  if (!running_.load(std::memory_order_acquire)) {
+    future.completed_ = true;
+    return pw::async2::Ready(pw::StatusWithSize::FailedPrecondition());
+  }
+  const bool timed = future.timeout_ms_ != ReadFuture::kNoTimeout;
+  RecordWakeLatency();
+  {
+    std::lock_guard lock(lock_);
+    RecordRxBuffered(hal_usart_available(serial_));
   }
 
-  // Check if we have enough data
-  if (future.bytes_read_ >= future.min_bytes_) {
+  const size_t bytes_before = future.bytes_read_;
+  auto result = ReadForMode(future);
+  bytes_received_.Increment(
+      static_cast<uint32_t>(future.bytes_read_ - bytes_before));
+  PublishToTaps(future.buffer_.subspan(bytes_before,
+                                       future.bytes_read_ - bytes_before));
+  if (result.IsReady()) {
     future.completed_ = true;
+    reads_completed_.Increment();
+    if (timed) {
+      read_timer_.Cancel();
+    }
     // Clear pending waker since we're done
     {
       std::lock_guard lock(lock_);
       has_pending_waker_ = false;
     }
-    return pw::async2::Ready(pw::StatusWithSize(future.bytes_read_));
+    return result;
   }
 
-  // Check for timeout (if configured)
-  if (future.timeout_ms_ != ReadFuture::kNoTimeout) {
-    uint32_t elapsed = HAL_Timer_Get_Milli_Seconds() - future.start_time_ms_;
-    if (elapsed >= future.timeout_ms_) {
-      future.completed_ = true;
-      // Clear pending waker since we're done
-      {
-        std::lock_guard lock(lock_);
-        has_pending_waker_ = false;
-      }
-      return pw::async2::Ready(pw::StatusWithSize::DeadlineExceeded());
+  // Check for timeout (if configured). The bytes read so far stay in the
+  // buffer and are reported with the status so the caller can resume.
+  if (timed && pw::chrono::SystemClock::now() >= future.deadline_) {
+    future.completed_ = true;
+    reads_completed_.Increment();
+    read_timeouts_.Increment();
+    read_timer_.Cancel();
+    // Clear pending waker since we're done
+    {
+      std::lock_guard lock(lock_);
+      has_pending_waker_ = false;
     }
+    return pw::async2::Ready(
+        pw::StatusWithSize::DeadlineExceeded(future.bytes_read_));
   }
 
   // Not enough data yet - store waker for background task to wake us
@@ -277,7 +1100,80 @@ pw::async2::Poll<pw::StatusWithSize> AsyncUart::TryRead(
       return pw::async2::Ready(pw::StatusWithSize::FailedPrecondition());
     }
     has_pending_waker_ = true;
+    // Never wait for more than half the ring buffer, so it keeps draining
+    // even when the remaining frame is larger than the HAL buffer.
+    const size_t max_threshold = std::max(rx_buffer_.size() / 2, size_t{1});
+    pending_read_threshold_ =
+        std::clamp(BytesStillNeeded(future), size_t{1}, max_threshold);
+  }
+
+  // The timer wakes the future exactly at its deadline, so neither the
+  // shared task nor the future has to wake up early to check it.
+  if (timed && !future.deadline_armed_) {
+    future.deadline_armed_ = true;
+    read_timer_.InvokeAt(future.deadline_);
+  }
+
+  // Let the shared task know this port has a pending future
+  AsyncUartService::Get().Notify();
+
+  // Data may have arrived after the read above but before the waker was
+  // stored. The RX event for it has already been consumed, so wake ourselves
+  // rather than waiting for the next byte.
+  WakePendingReader();
+
+  return pw::async2::Pending();
+}
+
+pw::async2::Poll<pw::Status> AsyncUart::TryWrite(WriteFuture& future,
+                                                 pw::async2::Context& cx) {
+  if (!running_.load(std::memory_order_acquire)) {
+    future.completed_ = true;
+    return pw::async2::Ready(pw::Status::FailedPrecondition());
   }
+  // Queue as much as currently fits into the TX ring buffer
+  if (future.bytes_written_ < future.data_.size()) {
+    std::lock_guard tx_lock(tx_lock_);
+    AssertDirection();
+    const size_t written = uart::WriteAvailable(
+        serial_, future.data_.subspan(future.bytes_written_));
+    future.bytes_written_ += written;
+    bytes_sent_.Increment(static_cast<uint32_t>(written));
+  }
+
+  if (future.bytes_written_ == future.data_.size()) {
+    bool done = future.completion_ == WriteCompletion::kQueued;
+    if (!done && TxBufferEmpty()) {
+      // The ring buffer is empty, so this only waits for the shift register
+      // (at most one character time).
+      hal_usart_flush(serial_);
+      ReleaseDirection(/*wait=*/true);
+      done = true;
+    }
+    if (done) {
+      future.completed_ = true;
+      {
+        std::lock_guard lock(lock_);
+        has_pending_write_waker_ = false;
+      }
+      return pw::async2::Ready(pw::OkStatus());
+    }
+  }
+
+  // TX buffer full (or still draining) - wait for the background task
+  {
+    std::lock_guard lock(lock_);
+    if (!PW_ASYNC_TRY_STORE_WAKER(
+            cx, pending_write_waker_, "Waiting for UART TX space")) {
+      PW_LOG_ERROR("TryWrite: concurrent write detected (only one allowed)");
+      future.completed_ = true;
+      return pw::async2::Ready(pw::Status::FailedPrecondition());
+    }
+    has_pending_write_waker_ = true;
+  }
+
+  // Let the shared task know this port has a pending future
+  AsyncUartService::Get().Notify();
 
   return pw::async2::Pending();
 }
@@ -0,0 +1,181 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_uart/async_uart_rpc_channel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#include "pw_hdlc/encoded_size.h"
+#include "pw_hdlc/encoder.h"
+#include "pw_hdlc/protocol.h"
+#include "pw_log/log.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pb {
+
+AsyncUartRpcChannel::AsyncUartRpcChannel(AsyncUart& uart,
+                                         uint64_t address,
+                                         pw::ByteSpan frame_buffer,
+                                         pw::ByteSpan tx_buffer)
+    : pw::rpc::ChannelOutput("uart_rpc"),
+      uart_(uart),
+      address_(address),
+      decoder_(frame_buffer),
+      tx_buffer_(tx_buffer) {}
+
+size_t AsyncUartRpcChannel::MaximumTransmissionUnit() {
+  return pw::hdlc::MaxSafePayloadSize(tx_buffer_.size());
+}
+
+pw::Status AsyncUartRpcChannel::Send(pw::span<const std::byte> packet) {
+  pw::async2::Waker waker;
+  {
+    std::lock_guard lock(lock_);
+    pw::stream::MemoryWriter writer(tx_buffer_.subspan(tx_queued_));
+    if (!pw::hdlc::WriteUIFrame(address_, packet, writer).ok()) {
+      ++stats_.packets_dropped;
+      return pw::Status::ResourceExhausted();
+    }
+    tx_queued_ += writer.bytes_written();
+    ++stats_.packets_sent;
+    stats_.tx_peak_queued = std::max(stats_.tx_peak_queued,
+                                     static_cast<uint32_t>(tx_queued_));
+    waker = std::move(tx_waker_);
+  }
+  waker.Wake();
+  return pw::OkStatus();
+}
+
+void AsyncUartRpcChannel::Stop() {
+  pw::async2::Waker waker;
+  {
+    std::lock_guard lock(lock_);
+    stopping_ = true;
+    waker = std::move(tx_waker_);
+  }
+  waker.Wake();
+}
+
+AsyncUartRpcChannelStats AsyncUartRpcChannel::stats() const {
+  std::lock_guard lock(lock_);
+  return stats_;
+}
+
+pw::async2::Poll<> AsyncUartRpcChannel::DoPend(pw::async2::Context& cx) {
+  bool stopping;
+  {
+    std::lock_guard lock(lock_);
+    stopping = stopping_;
+  }
+  if (stopping) {
+    read_ = ReadFuture();  // Cancels the pending read
+    reading_ = false;
+  } else if (!PendReceive(cx)) {
+    stopping = true;
+  }
+
+  // Responses to the frames just processed go out in the same pass
+  const bool sent_all = PendTransmit(cx);
+  if (stopping && sent_all) {
+    return pw::async2::Ready();
+  }
+  return pw::async2::Pending();
+}
+
+bool AsyncUartRpcChannel::PendReceive(pw::async2::Context& cx) {
+  while (true) {
+    if (!reading_) {
+      // Completes at the flag that ends a frame, so one wake-up usually
+      // delivers a whole frame
+      read_ = uart_.ReadUntil(read_chunk_, pw::hdlc::kFlag);
+      reading_ = true;
+    }
+    pw::async2::Poll<pw::StatusWithSize> poll = read_.Pend(cx);
+    if (poll.IsPending()) {
+      return true;
+    }
+    reading_ = false;
+
+    const pw::StatusWithSize result = *poll;
+    // ResourceExhausted: the frame is longer than read_chunk_, read on
+    if (!result.ok() && !result.IsResourceExhausted()) {
+      PW_LOG_WARN("RPC channel read failed: %d",
+                  static_cast<int>(result.status().code()));
+      return false;
+    }
+    for (std::byte byte : pw::span(read_chunk_).first(result.size())) {
+      ProcessByte(byte);
+    }
+  }
+}
+
+void AsyncUartRpcChannel::ProcessByte(std::byte byte) {
+  pw::Result<pw::hdlc::Frame> frame = decoder_.Process(byte);
+  if (frame.status().IsUnavailable()) {
+    return;  // Frame not complete yet
+  }
+  if (!frame.ok()) {
+    std::lock_guard lock(lock_);
+    ++stats_.frames_dropped;
+    return;
+  }
+  if (frame->address() != address_) {
+    std::lock_guard lock(lock_);
+    ++stats_.frames_ignored;
+    return;
+  }
+  {
+    std::lock_guard lock(lock_);
+    ++stats_.frames_received;
+  }
+
+  // Handlers may call Send(), so lock_ must not be held here
+  pw::Status status = pw::Status::FailedPrecondition();
+  if (server_ != nullptr) {
+    status = server_->ProcessPacket(frame->data());
+  }
+  if (client_ != nullptr &&
+      (server_ == nullptr || status.IsInvalidArgument())) {
+    // Not a request: a response for the client
+    status = client_->ProcessPacket(frame->data());
+  }
+  if (!status.ok()) {
+    PW_LOG_DEBUG("RPC packet not processed: %d",
+                 static_cast<int>(status.code()));
+  }
+}
+
+bool AsyncUartRpcChannel::PendTransmit(pw::async2::Context& cx) {
+  while (true) {
+    if (writing_ > 0) {
+      pw::async2::Poll<pw::Status> poll = write_.Pend(cx);
+      if (poll.IsPending()) {
+        return false;
+      }
+      if (!poll->ok()) {
+        PW_LOG_WARN("RPC channel write failed: %d",
+                    static_cast<int>(poll->code()));
+      }
+      // Frames queued while writing move to the front
+      std::lock_guard lock(lock_);
+      std::memmove(tx_buffer_.data(),
+                   tx_buffer_.data() + writing_,
+                   tx_queued_ - writing_);
+      tx_queued_ -= writing_;
+      writing_ = 0;
+    }
+
+    std::lock_guard lock(lock_);
+    if (tx_queued_ == 0) {
+      PW_ASYNC_STORE_WAKER(cx, tx_waker_, "Waiting for RPC packets");
+      return true;
+    }
+    // Send() appends behind the frames being written, which stay in place
+    writing_ = tx_queued_;
+    write_ = uart_.WriteAsync(tx_buffer_.first(writing_));
+  }
+}
+
+}  // namespace pb
@@ -0,0 +1,40 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_uart/async_uart_stream.h"
+
+#include "pw_chrono/system_clock.h"
+#include "pw_status/try.h"
+
+namespace pb {
+
+void AsyncUartStream::Flush() {
+  uart_.FlushTx();
+}
+
+pw::StatusWithSize AsyncUartStream::DoRead(pw::ByteSpan dest) {
+  pw::StatusWithSize result = uart_.ReadBuffered(dest);
+  if (!result.ok() || result.size() > 0 || dest.empty() ||
+      read_timeout_ <= pw::chrono::SystemClock::duration::zero()) {
+    return result;
+  }
+
+  const auto deadline =
+      pw::chrono::SystemClock::TimePointAfterAtLeast(read_timeout_);
+  while (result.ok() && result.size() == 0 &&
+         pw::chrono::SystemClock::now() < deadline) {
+    uart_.WaitForRx(deadline);
+    result = uart_.ReadBuffered(dest);
+  }
+  return result;
+}
+
+pw::Status AsyncUartStream::DoWrite(pw::ConstByteSpan data) {
+  PW_TRY(uart_.WriteAll(data));
+  if (flush_policy_ == FlushPolicy::kAlways) {
+    uart_.FlushTx();
+  }
+  return pw::OkStatus();
+}
+
+}  // namespace pb
@@ -0,0 +1,224 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_uart/double_buffered_rx.h"
+
+#include <chrono>
+#include <mutex>
+
+#include "pb_uart/usart_io.h"
+#include "pw_assert/check.h"
+#include "pw_log/log.h"
+
+namespace pb {
+
+// ---------------------------------------------------------------------------
+// BlockFuture implementation
+// ---------------------------------------------------------------------------
+
+BlockFuture::BlockFuture(DoubleBufferedRx* rx, uint32_t timeout_ms)
+    : rx_(rx), timeout_ms_(timeout_ms) {
+  if (timeout_ms_ != ReadFuture::kNoTimeout) {
+    deadline_ = pw::chrono::SystemClock::TimePointAfterAtLeast(
+        std::chrono::milliseconds(timeout_ms_));
+  }
+}
+
+BlockFuture::BlockFuture(BlockFuture&& other) noexcept
+    : rx_(other.rx_),
+      timeout_ms_(other.timeout_ms_),
+      deadline_(other.deadline_),
+      deadline_armed_(other.deadline_armed_),
+      completed_(other.completed_) {
+  other.rx_ = nullptr;
+  other.completed_ = true;
+}
+
+BlockFuture& BlockFuture::operator=(BlockFuture&& other) noexcept {
+  if (this != &other) {
+    rx_ = other.rx_;
+    timeout_ms_ = other.timeout_ms_;
+    deadline_ = other.deadline_;
+    deadline_armed_ = other.deadline_armed_;
+    completed_ = other.completed_;
+
+    other.rx_ = nullptr;
+    other.completed_ = true;
+  }
+  return *this;
+}
+
+pw::async2::Poll<pw::StatusWithSize> BlockFuture::Pend(
+    pw::async2::Context& cx) {
+  if (rx_ == nullptr || completed_) {
+    return pw::async2::Ready(pw::StatusWithSize::InvalidArgument());
+  }
+  return rx_->PendBlock(*this, cx);
+}
+
+// ---------------------------------------------------------------------------
+// DoubleBufferedRx implementation
+// ---------------------------------------------------------------------------
+
+DoubleBufferedRx::DoubleBufferedRx(AsyncUart& uart,
+                                   pw::ByteSpan first_half,
+                                   pw::ByteSpan second_half)
+    : uart_(uart),
+      halves_{first_half, second_half},
+      timer_([this](pw::chrono::SystemClock::time_point) {
+        // Runs in the timer task: the pending future has reached its deadline
+        WakeFuture();
+      }) {
+  PW_CHECK(!first_half.empty() && !second_half.empty());
+}
+
+DoubleBufferedRx::~DoubleBufferedRx() {
+  if (attached_) {
+    // Returns once no service pass is copying into the halves
+    uart_.SetBlockReceiver(nullptr);
+  }
+  timer_.Cancel();
+}
+
+BlockFuture DoubleBufferedRx::FillNext(uint32_t timeout_ms) {
+  {
+    std::lock_guard lock(lock_);
+    if (current_ != kNone) {
+      // The application is done with it: fill it again once the other half
+      // is full (or right away, if the background task is waiting for one)
+      size_[current_] = 0;
+      if (filling_ == kNone) {
+        filling_ = current_;
+      }
+      current_ = kNone;
+    }
+    wants_data_.store(filling_ != kNone, std::memory_order_release);
+  }
+  current_block_ = {};
+  ++blocks_started_;
+
+  if (!attached_) {
+    // Starts the copying into the first half
+    uart_.SetBlockReceiver(this);
+    attached_ = true;
+  } else {
+    AsyncUart::NotifyService();
+  }
+  return BlockFuture(this, timeout_ms);
+}
+
+void DoubleBufferedRx::Fill() {
+  // Bytes copied by this pass: the rest of one half and the start of the
+  // other at most, since the first one is not free again yet
+  std::array<pw::ConstByteSpan, 2> copied;
+  size_t copies = 0;
+  bool became_ready = false;
+  {
+    std::lock_guard lock(lock_);
+    while (filling_ != kNone && copies < copied.size()) {
+      const size_t index = filling_;
+      const pw::ByteSpan rest = halves_[index].subspan(size_[index]);
+      const size_t count = uart::ReadAvailable(uart_.serial_, rest);
+      copied[copies++] = rest.first(count);
+      size_[index] += count;
+      if (size_[index] < halves_[index].size()) {
+        break;
+      }
+      CompleteFillingLocked();
+      became_ready = true;
+    }
+    wants_data_.store(filling_ != kNone, std::memory_order_release);
+  }
+
+  // Only this task writes to the halves, so the copied bytes stay put
+  for (size_t i = 0; i < copies; ++i) {
+    uart_.bytes_received_.Increment(static_cast<uint32_t>(copied[i].size()));
+    uart_.PublishToTaps(copied[i]);
+  }
+  if (became_ready) {
+    WakeFuture();
+  }
+}
+
+void DoubleBufferedRx::CompleteFillingLocked() {
+  ready_[filling_] = true;
+  const size_t other = filling_ ^ 1;
+  filling_ = !ready_[other] && current_ != other ? other : kNone;
+}
+
+pw::async2::Poll<pw::StatusWithSize> DoubleBufferedRx::PendBlock(
+    BlockFuture& future, pw::async2::Context& cx) {
+  if (!uart_.running_.load(std::memory_order_acquire)) {
+    future.completed_ = true;
+    return pw::async2::Ready(pw::StatusWithSize::FailedPrecondition());
+  }
+  const bool timed = future.timeout_ms_ != ReadFuture::kNoTimeout;
+
+  pw::StatusWithSize result;
+  bool handed_out = false;
+  {
+    std::lock_guard lock(lock_);
+    if (!ready_[next_] && timed &&
+        pw::chrono::SystemClock::now() >= future.deadline_) {
+      // Hand out what has arrived; filling continues in the other half.
+      // next_ is always either ready or being filled.
+      if (filling_ == next_) {
+        CompleteFillingLocked();
+        wants_data_.store(filling_ != kNone, std::memory_order_release);
+      }
+    }
+
+    if (ready_[next_]) {
+      ready_[next_] = false;
+      current_ = next_;
+      next_ ^= 1;
+      current_block_ = halves_[current_];
+      const size_t size = size_[current_];
+      result = size == current_block_.size()
+                   ? pw::StatusWithSize(size)
+                   : pw::StatusWithSize::DeadlineExceeded(size);
+      handed_out = true;
+    } else {
+      if (!PW_ASYNC_TRY_STORE_WAKER(cx, waker_, "Waiting for a UART block")) {
+        PW_LOG_ERROR("FillNext: concurrent future detected (only one allowed)");
+        future.completed_ = true;
+        return pw::async2::Ready(pw::StatusWithSize::FailedPrecondition());
+      }
+      has_waker_ = true;
+    }
+  }
+
+  if (!handed_out) {
+    // The timer wakes the future exactly at its deadline
+    if (timed && !future.deadline_armed_) {
+      future.deadline_armed_ = true;
+      timer_.InvokeAt(future.deadline_);
+    }
+    return pw::async2::Pending();
+  }
+
+  future.completed_ = true;
+  if (timed) {
+    timer_.Cancel();
+  }
+  return pw::async2::Ready(result);
+}
+
+void DoubleBufferedRx::WakeFuture() {
+  pw::async2::Waker waker;
+  bool should_wake = false;
+  {
+    std::lock_guard lock(lock_);
+    if (has_waker_) {
+      waker = std::move(waker_);
+      has_waker_ = false;
+      should_wake = true;
+    }
+  }
+  // Wake outside the lock, same as AsyncUart::WakePendingReader()
+  if (should_wake) {
+    waker.Wake();
+  }
+}
+
+}  // namespace pb
@@ -3,31 +3,50 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
 
+#include "pb_uart/config.h"
 #include "pw_async2/context.h"
 #include "pw_async2/dispatcher.h"
 #include "pw_async2/poll.h"
 #include "pw_async2/waker.h"
 #include "pw_bytes/span.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_chrono/system_timer.h"
+#include "pw_digital_io/digital_io.h"
+#include "pw_metric/metric.h"
 #include "pw_result/result.h"
 #include "pw_status/status.h"
 #include "pw_status/status_with_size.h"
 #include "pw_sync/mutex.h"
-#include "pw_thread/thread.h"
 #include "usart_hal.h"
 
 namespace pb {
 
 class AsyncUart;
+class AsyncUartService;
+class DoubleBufferedRx;
 
-/// Future returned by AsyncUart::Read().
+/// Frame length callback for AsyncUart::ReadFrame().
+///
+/// Called with the bytes of the frame received so far (starting with an empty
+/// span). Returns the total number of bytes the frame needs given what it has
+/// seen: the header size while the header is incomplete, the full frame length
+/// once the header has been parsed, or 0 if the header is invalid.
+///
+/// Parsers must be cheap - they run from ReadFuture::Pend each time data
+/// arrives, not from the application coroutine.
+using FrameLengthParser = size_t (*)(pw::ConstByteSpan received);
+
+/// Future returned by AsyncUart::Read(), ReadUntil() and ReadFrame().
 ///
 /// This future completes when at least `min_bytes` are available in the UART
-/// receive buffer, or when the optional timeout expires. The background polling
-/// task wakes the future when data arrives.
+/// receive buffer (or the delimiter / a full frame has arrived), or when the
+/// optional timeout expires. The background task wakes the future when data
+/// arrives.
 class ReadFuture {
  public:
   using value_type = pw::StatusWithSize;
@@ -53,6 +72,13 @@ class ReadFuture {
  private:
   friend class AsyncUart;
 
+  /// What completes the read.
+  enum class Mode : uint8_t {
+    kMinBytes,   // At least min_bytes_ received
+    kDelimiter,  // delimiter_ received
+    kFrame,      // frame_parser_ reports a complete frame
+  };
+
   /// Private constructor used by AsyncUart.
   ReadFuture(AsyncUart* uart,
              pw::ByteSpan buffer,
@@ -63,17 +89,140 @@ class ReadFuture {
   pw::ByteSpan buffer_;
   size_t min_bytes_ = 0;
   size_t bytes_read_ = 0;
+  Mode mode_ = Mode::kMinBytes;
+  std::byte delimiter_{};
+  FrameLengthParser frame_parser_ = nullptr;
   uint32_t timeout_ms_ = kNoTimeout;
-  uint32_t start_time_ms_ = 0;
+  pw::chrono::SystemClock::time_point deadline_;
+  bool deadline_armed_ = false;  // AsyncUart::read_timer_ set for deadline_
   bool completed_ = false;
 };
 
+/// Snapshot of the runtime counters of an AsyncUart (see AsyncUart::stats()).
+///
+/// Use rx_peak_buffered and rx_buffer_full to size `rx_buffer` and
+/// `poll_interval_ms`: a full ring buffer means the HAL may have dropped
+/// bytes. The HAL does not report UART overrun or framing errors.
+struct AsyncUartStats {
+  uint32_t bytes_received = 0;       ///< Bytes copied out by reads
+  uint32_t bytes_sent = 0;           ///< Bytes queued by Write()/WriteAsync()
+  uint32_t reads_completed = 0;      ///< Reads completed with any status
+  uint32_t read_timeouts = 0;        ///< Reads completed with DeadlineExceeded
+  uint32_t rx_peak_buffered = 0;     ///< Highest RX ring buffer occupancy
+  uint32_t rx_buffer_full = 0;       ///< Times the RX ring buffer filled up
+  uint32_t wake_latency_last_us = 0; ///< Wake-to-read latency, last read
+  uint32_t wake_latency_max_us = 0;  ///< Wake-to-read latency, maximum
+};
+
+/// Selects when a WriteFuture completes.
+enum class WriteCompletion {
+  /// The last byte has been queued in the HAL TX ring buffer.
+  kQueued,
+  /// The last byte has left the UART shift register. Useful before turning
+  /// around a half-duplex bus or changing the baud rate.
+  kTransmitted,
+};
+
+/// Future returned by AsyncUart::WriteAsync().
+///
+/// Hands data to the HAL TX ring buffer as space frees up, so payloads larger
+/// than the TX buffer stream through instead of failing. The background task
+/// wakes the future when the UART has drained some of the TX buffer.
+class WriteFuture {
+ public:
+  using value_type = pw::Status;
+
+  WriteFuture() = default;
+  WriteFuture(WriteFuture&& other) noexcept;
+  WriteFuture& operator=(WriteFuture&& other) noexcept;
+  ~WriteFuture() = default;
+
+  WriteFuture(const WriteFuture&) = delete;
+  WriteFuture& operator=(const WriteFuture&) = delete;
+
+  /// Queues as much data as fits. Completes according to the
+  /// WriteCompletion passed to WriteAsync().
+  pw::async2::Poll<pw::Status> Pend(pw::async2::Context& cx);
+
+  /// Returns true if the future has completed.
+  [[nodiscard]] bool is_complete() const { return completed_; }
+
+  /// Number of bytes queued so far.
+  [[nodiscard]] size_t bytes_written() const { return bytes_written_; }
+
+ private:
+  friend class AsyncUart;
+
+  WriteFuture(AsyncUart* uart,
+              pw::ConstByteSpan data,
+              WriteCompletion completion);
+
+  AsyncUart* uart_ = nullptr;
+  pw::ConstByteSpan data_;
+  size_t bytes_written_ = 0;
+  WriteCompletion completion_ = WriteCompletion::kQueued;
+  bool completed_ = false;
+};
+
+/// Read-only subscriber to the bytes received by an AsyncUart.
+///
+/// Taps observe everything the primary reader consumes (Read(), ReadUntil(),
+/// ReadFrame()) through a history ring shared by all taps of the port (see
+/// AsyncUart::EnableRxTaps()). Each tap has its own cursor into that ring.
+/// Received bytes are copied into the ring once, no matter how many taps
+/// subscribe. A tap that falls behind by more than the ring size loses the
+/// oldest bytes (counted in dropped()); it never stalls the primary reader.
+///
+/// Bytes discarded with AsyncUart::Drain() are not observed.
+class RxTap {
+ public:
+  RxTap() = default;
+  ~RxTap();
+
+  RxTap(const RxTap&) = delete;
+  RxTap& operator=(const RxTap&) = delete;
+
+  /// Copies up to `dest.size()` observed bytes that this tap has not read
+  /// yet. Non-blocking.
+  /// @return Number of bytes copied
+  size_t Read(pw::ByteSpan dest);
+
+  /// Ready once unread bytes are available; otherwise wakes the task when
+  /// the primary reader consumes more data.
+  pw::async2::Poll<> PendReadable(pw::async2::Context& cx);
+
+  /// Bytes this tap missed because it fell behind by more than the ring.
+  [[nodiscard]] uint32_t dropped() const { return dropped_; }
+
+ private:
+  friend class AsyncUart;
+
+  AsyncUart* uart_ = nullptr;
+  uint32_t cursor_ = 0;  // Stream position of the next byte to read
+  uint32_t dropped_ = 0;
+  pw::async2::Waker waker_;
+  bool has_waker_ = false;
+};
+
 /// Async UART implementation with waker support for C++20 coroutines.
 ///
 /// This class provides true async I/O by using a background FreeRTOS task
-/// that polls the UART and wakes pending futures when data arrives. This
-/// allows coroutines to suspend and be resumed when data is available,
-/// rather than busy-waiting.
+/// that waits for UART RX activity and wakes pending futures when data
+/// arrives. This allows coroutines to suspend and be resumed when data is
+/// available, rather than busy-waiting.
+///
+/// For half-duplex buses (RS-485), EnableDirectionControl() hands the
+/// transceiver's driver enable pin to the UART: it is asserted before data
+/// is queued and released once the last stop bit has left.
+///
+/// All initialized AsyncUart instances share a single background task (see
+/// pb::uart::config::kMaxInstances). The task sleeps while no future is
+/// pending on any port and only wakes futures whose port has data.
+///
+/// Where the HAL provides USART events (see PB_UART_CONFIG_HAL_EVENTS) and a
+/// single port has pending futures, the task blocks on that port's RX
+/// interrupt event. With several active ports, or ports without events, it
+/// polls hal_usart_available() every `poll_interval_ms`.
 ///
 /// Usage:
 /// @code
@@ -95,7 +244,10 @@ class AsyncUart {
   /// @param serial HAL UART interface (e.g., HAL_USART_SERIAL2)
   /// @param rx_buffer Receive buffer (must be 32-byte aligned for DMA)
   /// @param tx_buffer Transmit buffer (must be 32-byte aligned for DMA)
-  /// @param poll_interval_ms How often to check for data (default 1ms)
+  /// @param poll_interval_ms How often to check for data when polling
+  ///        (default 1ms). Ignored while the port is serviced from HAL
+  ///        events. The shared task uses the smallest interval of the ports
+  ///        with pending futures.
   ///
   /// @note Buffers must remain valid for the lifetime of the AsyncUart.
   ///       Size should match the largest expected frame (e.g., 265 for PN532).
@@ -111,16 +263,35 @@ class AsyncUart {
   AsyncUart(AsyncUart&&) = delete;
   AsyncUart& operator=(AsyncUart&&) = delete;
 
-  /// Initialize the UART with specified baud rate and start background task.
+  /// Initialize the UART with specified baud rate and register it with the
+  /// shared background task (started on first use).
   /// @param baud_rate Baud rate (default 115200 for PN532)
-  /// @return OkStatus on success
-  pw::Status Init(uint32_t baud_rate = 115200);
+  /// @param config HAL line configuration (SERIAL_8N1, SERIAL_8E1, ...)
+  /// @return OkStatus on success, ResourceExhausted if kMaxInstances UARTs
+  ///         are already initialized, FailedPrecondition if this instance
+  ///         is already initialized
+  pw::Status Init(uint32_t baud_rate = 115200, uint32_t config = SERIAL_8N1);
 
-  /// Shutdown the UART and stop background task.
+  /// Switch the baud rate and line configuration of an initialized UART in
+  /// place, e.g. after negotiating a higher rate (PN532 high-speed mode,
+  /// STM32 bootloader sync).
+  ///
+  /// Waits until queued TX data has been sent at the old rate, then
+  /// restarts the peripheral. Buffered RX data is discarded, since bytes
+  /// received around the switch may be garbled. A pending read keeps
+  /// waiting and receives data at the new rate.
   ///
-  /// @warning Thread cleanup is unreliable on Particle P2. After Deinit(),
-  ///          the instance cannot be re-initialized. Prefer keeping instances
-  ///          alive for the application lifetime.
+  /// @return FailedPrecondition if not initialized or a WriteFuture is
+  ///         pending
+  pw::Status Reconfigure(uint32_t baud_rate, uint32_t config = SERIAL_8N1);
+
+  /// Shutdown the UART and unregister it from the background task.
+  ///
+  /// Pending futures complete with FailedPrecondition. When the last port
+  /// is deinitialized, the background task is stopped and its stack is
+  /// freed. Init() may be called again afterwards, e.g. with a
+  /// different baud rate; the buffers may be reclaimed once the AsyncUart
+  /// is destroyed.
   void Deinit();
 
   /// Start an async read operation.
@@ -140,22 +311,94 @@ class AsyncUart {
   /// Start an async read operation with timeout.
   ///
   /// Same as Read(), but returns DeadlineExceeded if the timeout expires
-  /// before `min_bytes` are received. Any partially received bytes are
-  /// discarded on timeout.
+  /// before `min_bytes` are received. The result size is then the number of
+  /// bytes already copied to the start of `buffer`, so a parser can consume
+  /// them and continue with a read into the rest of the buffer.
   ///
   /// @param buffer Buffer to read into
   /// @param min_bytes Minimum bytes to wait for
   /// @param timeout_ms Timeout in milliseconds
   /// @return A future that completes with StatusWithSize or DeadlineExceeded
+  ///         (with the partial byte count)
   ReadFuture ReadWithTimeout(pw::ByteSpan buffer,
                              size_t min_bytes,
                              uint32_t timeout_ms);
 
+  /// Start an async read that completes once `delimiter` has been received.
+  ///
+  /// The result size includes the delimiter. Bytes following the delimiter
+  /// stay in the receive buffer for the next read. Completes with
+  /// ResourceExhausted (and the bytes read) if `buffer` fills up first.
+  ///
+  /// @param buffer Buffer to read into
+  /// @param delimiter Byte that terminates the frame (e.g. '\n')
+  /// @param timeout_ms Optional timeout in milliseconds
+  /// @return A future that completes with StatusWithSize
+  ReadFuture ReadUntil(pw::ByteSpan buffer,
+                       std::byte delimiter,
+                       uint32_t timeout_ms = ReadFuture::kNoTimeout);
+
+  /// Start an async read that completes once a full frame has arrived.
+  ///
+  /// `parser` is consulted as bytes arrive to determine the frame length (see
+  /// FrameLengthParser). Exactly one frame is consumed; following bytes stay
+  /// in the receive buffer. Completes with DataLoss if the parser rejects the
+  /// header, or ResourceExhausted if the frame does not fit into `buffer`.
+  ///
+  /// On timeout the result is DeadlineExceeded with the partial frame size.
+  /// Pass that size as `received` to a new ReadFrame() on the same buffer to
+  /// resume the frame instead of re-syncing.
+  ///
+  /// @param buffer Buffer to read into
+  /// @param parser Returns the frame length for the bytes received so far
+  /// @param timeout_ms Optional timeout in milliseconds
+  /// @param received Bytes of the frame already at the start of `buffer`
+  /// @return A future that completes with the frame size
+  ReadFuture ReadFrame(pw::ByteSpan buffer,
+                       FrameLengthParser parser,
+                       uint32_t timeout_ms = ReadFuture::kNoTimeout,
+                       size_t received = 0);
+
   /// Synchronous write (TX is already fast via HAL ring buffer).
   /// @param data Data to write
   /// @return OkStatus on success, ResourceExhausted if TX buffer full
   pw::Status Write(pw::ConstByteSpan data);
 
+  /// Start an async write operation.
+  ///
+  /// Returns a future that queues `data` into the TX ring buffer as space
+  /// becomes available, without stalling the dispatcher. `data` may be larger
+  /// than the TX buffer.
+  ///
+  /// @pre Only one write operation may be pending at a time.
+  /// @pre `data` must remain valid until the future completes.
+  ///
+  /// @param data Data to write
+  /// @param completion Complete once queued (default) or once transmitted.
+  ///        kTransmitted blocks in hal_usart_flush() for at most one
+  ///        character time after the ring buffer has drained.
+  /// @return A future that completes with OkStatus
+  WriteFuture WriteAsync(pw::ConstByteSpan data,
+                         WriteCompletion completion = WriteCompletion::kQueued);
+
+  /// Drive the direction (driver enable) pin of a half-duplex transceiver,
+  /// e.g. DE and /RE of an RS-485 transceiver tied together.
+  ///
+  /// Write(), WriteAsync() and stream writes set `direction` to kActive
+  /// before queuing data. The background task sets it back to kInactive as
+  /// soon as the TX ring buffer has drained and the shift register is empty
+  /// (within one event wake-up or `poll_interval_ms`). A kTransmitted
+  /// WriteFuture releases the bus before it completes, so the reply can be
+  /// read right away.
+  ///
+  /// @param direction Enabled output; kActive enables the driver
+  /// @return FailedPrecondition while data is being transmitted
+  pw::Status EnableDirectionControl(pw::digital_io::DigitalOut& direction);
+
+  /// Waits for queued TX data to be transmitted, releases the bus and stops
+  /// driving the direction pin.
+  void DisableDirectionControl();
+
   /// Discard all currently pending receive data (single pass, non-blocking).
   ///
   /// Reads and discards all bytes currently in the HAL receive buffer.
@@ -165,11 +408,137 @@ class AsyncUart {
   /// @warning Do not call while a Read/ReadWithTimeout future is pending.
   void Drain();
 
+  /// Returns a snapshot of the RX/TX counters.
+  ///
+  /// Counters are updated without locking from the dispatcher and the
+  /// background task, so a snapshot taken while I/O is in flight may be
+  /// slightly inconsistent.
+  [[nodiscard]] AsyncUartStats stats() const;
+
+  /// Resets all counters to zero.
+  void ResetStats();
+
+  /// The counters as a pw_metric group ("async_uart"). Add it to an
+  /// application metric group to export it, e.g. over pw_rpc.
+  pw::metric::Group& metrics() { return metrics_; }
+
+  /// Enables RX taps with a history ring shared by all taps of this port.
+  ///
+  /// @param history Ring for the observed bytes. Size it for the longest
+  ///        stall of the slowest tap.
+  /// @return FailedPrecondition if taps are subscribed
+  pw::Status EnableRxTaps(pw::ByteSpan history);
+
+  /// Subscribes `tap` to the bytes received from now on.
+  /// @return FailedPrecondition if EnableRxTaps() was not called or the tap
+  ///         is already subscribed, ResourceExhausted if
+  ///         pb::uart::config::kMaxRxTaps taps are subscribed
+  pw::Status AddRxTap(RxTap& tap);
+
+  /// Unsubscribes `tap`. Also done by the RxTap destructor.
+  void RemoveRxTap(RxTap& tap);
+
+  /// Unsubscribes all taps and releases the history ring. Also done by
+  /// Deinit().
+  void DisableRxTaps();
+
  private:
   friend class ReadFuture;
+  friend class WriteFuture;
+  friend class AsyncUartService;
+  friend class RxTap;
+  friend class AsyncUartStream;
+  friend class DoubleBufferedRx;
+
+  /// Stream read (AsyncUartStream): copies the buffered bytes without
+  /// waiting. FailedPrecondition while a ReadFuture is pending.
+  pw::StatusWithSize ReadBuffered(pw::ByteSpan dest);
+
+  /// Stream read (AsyncUartStream): blocks until RX data may be available
+  /// or `deadline` passes. Sleeps on the HAL RX event when enabled, one
+  /// event wait at most kEventIdleTimeoutMs; otherwise for up to
+  /// poll_interval_ms.
+  void WaitForRx(pw::chrono::SystemClock::time_point deadline);
+
+  /// Stream write (AsyncUartStream): queues all of `data`, blocking while
+  /// the TX buffer is full. FailedPrecondition while a WriteFuture is
+  /// pending.
+  pw::Status WriteAll(pw::ConstByteSpan data);
+
+  /// Waits until the last queued byte has been transmitted.
+  void FlushTx() { hal_usart_flush(serial_); }
+
+  /// Hands the background copying to `rx` (DoubleBufferedRx), or stops it
+  /// with nullptr. Returns once no service pass is using the previous one.
+  void SetBlockReceiver(DoubleBufferedRx* rx);
+
+  /// Runs a service pass soon, e.g. after a DoubleBufferedRx half was freed.
+  static void NotifyService();
 
-  /// Background FreeRTOS task that polls hal_usart_available().
-  void PollingTaskLoop();
+  /// Called by the shared background task. Wakes the pending reader/writer
+  /// if they can make progress and fills the free DoubleBufferedRx half.
+  /// @return true if a read or write is pending on this port, or a half is
+  ///         being filled
+  bool Service();
+
+  /// Returns true if a read or write is pending on this port, or the
+  /// direction pin has to be released once TX is done.
+  bool HasPendingFutures();
+
+  /// Returns true if a write is pending on this port.
+  bool HasPendingWrite();
+
+  /// Wakes the pending reader if enough data for it has been buffered (or
+  /// unconditionally with `force`, e.g. at its deadline). Must be called
+  /// without lock_ held.
+  void WakePendingReader(bool force = false);
+
+  /// Reads into the future's buffer according to its mode.
+  /// @return Ready with the final result, or Pending if more data is needed
+  pw::async2::Poll<pw::StatusWithSize> ReadForMode(ReadFuture& future);
+
+  /// Bytes the pending future still needs before it may complete.
+  static size_t BytesStillNeeded(const ReadFuture& future);
+
+  /// Wakes the pending writer, if any. Must be called without lock_ held.
+  void WakePendingWriter();
+
+  /// Called by WriteFuture::Pend to queue more data.
+  pw::async2::Poll<pw::Status> TryWrite(WriteFuture& future,
+                                        pw::async2::Context& cx);
+
+  /// Returns true if the TX ring buffer is empty.
+  bool TxBufferEmpty() const;
+
+  /// Enables the transceiver driver before data is queued. Must be called
+  /// with tx_lock_ held.
+  void AssertDirection();
+
+  /// Releases the transceiver driver if all queued data has left the
+  /// shift register. Without `wait`, skips (and leaves it to the next
+  /// service pass) while another thread holds tx_lock_.
+  void ReleaseDirection(bool wait = false);
+
+  /// Sets the direction pin to kInactive. Must be called with tx_lock_ held.
+  void ReleaseDirectionLocked();
+
+  /// Hands rx_buffer_/tx_buffer_ to the HAL (hal_usart_init_ex).
+  void ConfigureBuffers();
+
+  /// Updates tx_capacity_ after (re)starting the peripheral.
+  void MeasureTxCapacity();
+
+  /// Appends bytes consumed by the primary reader to the tap history and
+  /// wakes the waiting taps. Must be called without tap_lock_ held.
+  void PublishToTaps(pw::ConstByteSpan data);
+
+  /// Updates the RX occupancy counters with a hal_usart_available() result.
+  /// Must be called with lock_ held.
+  void RecordRxBuffered(int32_t available);
+
+  /// Records the wake-to-read latency if the background task woke the
+  /// pending reader since the last call.
+  void RecordWakeLatency();
 
   /// Called by ReadFuture::Pend to attempt reading data.
   /// @return Ready with bytes read, or Pending if not enough data yet
@@ -183,17 +552,65 @@ class AsyncUart {
   pw::ByteSpan rx_buffer_;
   pw::ByteSpan tx_buffer_;
 
-  // Background polling task
+  // Registered with the shared background task (between Init and Deinit)
   std::atomic<bool> running_{false};
-  std::atomic<bool> thread_exited_{true};  // Starts as true (no thread running)
-  pw::Thread polling_thread_;
+
+  // Ring buffers handed to the HAL (cleared by hal_usart_end in Deinit)
+  bool buffers_configured_ = false;
+
+  // HAL USART events enabled in Init() (PB_UART_CONFIG_HAL_EVENTS)
+  bool rx_events_ = false;
+  bool tx_events_ = false;
 
   // Pending read waker - protected by mutex
-  // When a read is pending, we store the waker here so the polling task
+  // When a read is pending, we store the waker here so the background task
   // can wake the coroutine when data arrives.
   pw::sync::Mutex lock_;
   pw::async2::Waker pending_waker_;
   bool has_pending_waker_ = false;
+  size_t pending_read_threshold_ = 1;  // Buffered bytes worth a wake-up
+
+  // Pending write waker - protected by mutex
+  pw::async2::Waker pending_write_waker_;
+  bool has_pending_write_waker_ = false;
+
+  // Filled by the service pass; protected by the background task's lock
+  DoubleBufferedRx* block_rx_ = nullptr;
+
+  // Free TX space with an empty ring buffer, captured in Init()
+  size_t tx_capacity_ = 0;
+
+  // Half-duplex direction control - protected by tx_lock_, which is held
+  // while data is queued so the driver is never released under it
+  pw::sync::Mutex tx_lock_;
+  pw::digital_io::DigitalOut* direction_ = nullptr;
+  std::atomic<bool> driving_{false};  // direction_ set to kActive
+
+  // Wake-to-read latency and RX full tracking - protected by mutex
+  bool reader_woken_ = false;
+  uint32_t reader_woken_at_us_ = 0;
+  bool rx_was_full_ = false;
+
+  // RX tap history ring and subscribers - protected by tap_lock_
+  pw::sync::Mutex tap_lock_;
+  pw::ByteSpan tap_history_;
+  uint32_t tap_head_ = 0;  // Stream position after the newest byte
+  std::array<RxTap*, uart::config::kMaxRxTaps> taps_{};
+
+  // Runtime counters (see stats())
+  PW_METRIC_GROUP(metrics_, "async_uart");
+  PW_METRIC(metrics_, bytes_received_, "bytes_received", 0u);
+  PW_METRIC(metrics_, bytes_sent_, "bytes_sent", 0u);
+  PW_METRIC(metrics_, reads_completed_, "reads_completed", 0u);
+  PW_METRIC(metrics_, read_timeouts_, "read_timeouts", 0u);
+  PW_METRIC(metrics_, rx_peak_buffered_, "rx_peak_buffered", 0u);
+  PW_METRIC(metrics_, rx_buffer_full_, "rx_buffer_full", 0u);
+  PW_METRIC(metrics_, wake_latency_last_us_, "wake_latency_last_us", 0u);
+  PW_METRIC(metrics_, wake_latency_max_us_, "wake_latency_max_us", 0u);
+
+  // Wakes the pending ReadWithTimeout() future at its deadline. Declared
+  // last so it is cancelled before the state its callback touches goes away.
+  pw::chrono::SystemTimer read_timer_;
 };
 
 }  // namespace pb
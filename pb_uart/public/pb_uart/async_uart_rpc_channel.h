@@ -0,0 +1,136 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pb_uart/async_uart.h"
+#include "pb_uart/config.h"
+#include "pw_async2/context.h"
+#include "pw_async2/poll.h"
+#include "pw_async2/task.h"
+#include "pw_async2/waker.h"
+#include "pw_bytes/span.h"
+#include "pw_hdlc/decoder.h"
+#include "pw_rpc/channel.h"
+#include "pw_rpc/client.h"
+#include "pw_rpc/server.h"
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+#include "pw_sync/mutex.h"
+
+namespace pb {
+
+/// Snapshot of the counters of an AsyncUartRpcChannel.
+struct AsyncUartRpcChannelStats {
+  uint32_t frames_received = 0;  ///< Frames for our address, processed
+  uint32_t frames_ignored = 0;   ///< Valid frames for another address
+  uint32_t frames_dropped = 0;   ///< CRC errors or frames too large
+  uint32_t packets_sent = 0;     ///< Packets queued by Send()
+  uint32_t packets_dropped = 0;  ///< Packets that did not fit tx_buffer
+  uint32_t tx_peak_queued = 0;   ///< Most encoded bytes waiting to be sent
+};
+
+/// pw_rpc channel over HDLC on an AsyncUart, run as a pw_async2 task.
+///
+/// Pigweed's HDLC RPC examples read a pw::stream from a dedicated thread.
+/// This channel needs no thread of its own: the task waits for whole frames
+/// with AsyncUart::ReadUntil() on the HDLC flag and sends with WriteAsync(),
+/// so it sleeps on the dispatcher until the UART's service task reports
+/// data or TX space. Incoming packets go to the server, or to the client if
+/// the server does not take them (see set_server() and set_client()).
+///
+/// Send() (the pw::rpc::ChannelOutput side) may be called from any thread,
+/// including RPC handlers running in the task. It HDLC-encodes the packet
+/// into `tx_buffer` and wakes the task; it fails with ResourceExhausted
+/// when the queued frames do not leave room for the packet.
+///
+/// @code
+///   alignas(32) static std::byte rx_buf[512];
+///   alignas(32) static std::byte tx_buf[512];
+///   static pb::AsyncUart uart(HAL_USART_SERIAL2, rx_buf, tx_buf);
+///   PW_TRY(uart.Init(921600));
+///
+///   static std::byte frame_buffer[256];
+///   static std::byte send_buffer[1024];
+///   static pb::AsyncUartRpcChannel link(
+///       uart, kHdlcAddress, frame_buffer, send_buffer);
+///   static std::array channels{pw::rpc::Channel::Create<1>(&link)};
+///   static pw::rpc::Server server(channels);
+///   link.set_server(server);
+///
+///   dispatcher.Post(link);
+/// @endcode
+class AsyncUartRpcChannel : public pw::rpc::ChannelOutput,
+                            public pw::async2::Task {
+ public:
+  /// @param uart Initialized UART. The channel is its only reader and writer.
+  /// @param address HDLC address of the RPC frames; others are ignored
+  /// @param frame_buffer Holds one decoded frame; limits incoming packets
+  /// @param tx_buffer Encoded frames waiting to be sent; limits outgoing
+  ///        packets (see MaximumTransmissionUnit())
+  AsyncUartRpcChannel(AsyncUart& uart,
+                      uint64_t address,
+                      pw::ByteSpan frame_buffer,
+                      pw::ByteSpan tx_buffer);
+
+  AsyncUartRpcChannel(const AsyncUartRpcChannel&) = delete;
+  AsyncUartRpcChannel& operator=(const AsyncUartRpcChannel&) = delete;
+
+  /// Endpoints for incoming packets: requests go to the server, responses
+  /// to the client. Set before posting the task; the endpoints' channel
+  /// lists usually refer to this channel, so they are constructed after it.
+  void set_server(pw::rpc::Server& server) { server_ = &server; }
+  void set_client(pw::rpc::Client& client) { client_ = &client; }
+
+  /// Largest packet that fits an empty `tx_buffer` once HDLC-encoded.
+  size_t MaximumTransmissionUnit() override;
+
+  /// Queues `packet` as an HDLC UI frame. Thread-safe.
+  pw::Status Send(pw::span<const std::byte> packet) override;
+
+  /// Lets the task finish: it stops reading and completes once the queued
+  /// frames have been sent. Thread-safe.
+  void Stop();
+
+  /// Returns a snapshot of the counters.
+  [[nodiscard]] AsyncUartRpcChannelStats stats() const;
+
+ private:
+  pw::async2::Poll<> DoPend(pw::async2::Context& cx) override;
+
+  /// Reads and processes frames until the UART has no more data.
+  /// @return false if the UART failed (e.g. after Deinit())
+  bool PendReceive(pw::async2::Context& cx);
+
+  /// Writes queued frames until the queue is empty or the UART is busy.
+  /// @return true if nothing is left to send
+  bool PendTransmit(pw::async2::Context& cx);
+
+  void ProcessByte(std::byte byte);
+
+  AsyncUart& uart_;
+  pw::rpc::Server* server_ = nullptr;
+  pw::rpc::Client* client_ = nullptr;
+  const uint64_t address_;
+  pw::hdlc::Decoder decoder_;
+
+  // Only used by the task
+  std::array<std::byte, uart::config::kRpcReadChunkSize> read_chunk_{};
+  ReadFuture read_;
+  bool reading_ = false;
+  WriteFuture write_;
+  size_t writing_ = 0;  // Bytes at the start of tx_buffer_ being written
+
+  mutable pw::sync::Mutex lock_;
+  pw::ByteSpan tx_buffer_;         // Guarded by lock_ beyond writing_
+  size_t tx_queued_ = 0;           // Guarded by lock_
+  pw::async2::Waker tx_waker_;     // Guarded by lock_
+  bool stopping_ = false;          // Guarded by lock_
+  AsyncUartRpcChannelStats stats_; // Guarded by lock_
+};
+
+}  // namespace pb
@@ -0,0 +1,75 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "pb_uart/async_uart.h"
+#include "pb_uart/flush_policy.h"
+#include "pw_bytes/span.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_stream/stream.h"
+
+namespace pb {
+
+/// pw::stream::NonSeekableReaderWriter over an AsyncUart.
+///
+/// Gives pw_stream based code (HDLC, pw_rpc) the AsyncUart driver: the same
+/// HAL ring buffers, bulk copies, statistics and RX taps as the async
+/// futures, instead of a second driver over the same port. Reads are
+/// non-blocking like pb::ParticleUartStream, or wait for the first byte
+/// with set_read_timeout().
+///
+/// Stream calls and futures may be mixed on the same port, but not
+/// concurrently in the same direction: Read() fails with FailedPrecondition
+/// while a ReadFuture is pending, Write() while a WriteFuture is pending.
+///
+/// @code
+///   pb::AsyncUart uart(HAL_USART_SERIAL2, rx_buf, tx_buf);
+///   PW_TRY(uart.Init(115200));
+///   pb::AsyncUartStream stream(uart, pb::FlushPolicy::kOnFlush);
+///   pw::hdlc::WriteUIFrame(kAddress, payload, stream);
+/// @endcode
+class AsyncUartStream : public pw::stream::NonSeekableReaderWriter {
+ public:
+  explicit AsyncUartStream(AsyncUart& uart,
+                           FlushPolicy flush_policy = FlushPolicy::kAlways)
+      : uart_(uart), flush_policy_(flush_policy) {}
+
+  /// Wait for all queued bytes to be transmitted, whatever the FlushPolicy.
+  void Flush();
+
+  /// Changes when writes wait for transmission.
+  void set_flush_policy(FlushPolicy policy) { flush_policy_ = policy; }
+  [[nodiscard]] FlushPolicy flush_policy() const { return flush_policy_; }
+
+  /// Lets Read() wait up to `timeout` for the first byte instead of
+  /// returning 0 at once (zero, the default, disables waiting). Sleeps on
+  /// the HAL RX event when the port has it (PB_UART_CONFIG_HAL_EVENTS),
+  /// otherwise re-checks every poll_interval_ms of the AsyncUart.
+  void set_read_timeout(pw::chrono::SystemClock::duration timeout) {
+    read_timeout_ = timeout;
+  }
+  [[nodiscard]] pw::chrono::SystemClock::duration read_timeout() const {
+    return read_timeout_;
+  }
+
+  /// The underlying driver, e.g. for its futures or stats().
+  AsyncUart& uart() { return uart_; }
+
+ private:
+  /// Read. Returns immediately with the buffered bytes, or waits up to the
+  /// read timeout for the first byte (0 if none arrives).
+  pw::StatusWithSize DoRead(pw::ByteSpan dest) override;
+
+  /// Queues all bytes, blocking only while the TX buffer is full, then
+  /// flushes according to the FlushPolicy.
+  pw::Status DoWrite(pw::ConstByteSpan data) override;
+
+  AsyncUart& uart_;
+  FlushPolicy flush_policy_;
+  pw::chrono::SystemClock::duration read_timeout_{};
+};
+
+}  // namespace pb
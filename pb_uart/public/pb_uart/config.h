@@ -0,0 +1,63 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Configuration options for pb_uart
+
+// Use the HAL USART event group (hal_usart_pvt_wait_event) to wake the
+// background task from the RX interrupt instead of polling. Ports that
+// reject hal_usart_pvt_enable_event() fall back to polling at runtime;
+// set to 0 to always poll (e.g. for Device OS builds that don't export the
+// event API through the HAL dynalib).
+#ifndef PB_UART_CONFIG_HAL_EVENTS
+#if defined(HAL_PLATFORM_RTL872X) && HAL_PLATFORM_RTL872X
+#define PB_UART_CONFIG_HAL_EVENTS 1
+#else
+#define PB_UART_CONFIG_HAL_EVENTS 0
+#endif
+#endif
+
+// Copy RX data out of (and TX data into) the HAL ring buffers with
+// hal_usart_read_buffer()/hal_usart_write_buffer() (two memcpy's per call)
+// instead of one hal_usart_read()/hal_usart_write() dynalib call per byte.
+#ifndef PB_UART_CONFIG_BULK_IO
+#define PB_UART_CONFIG_BULK_IO 1
+#endif
+
+// Stack of the shared background task ("uart_svc"). It only wakes futures
+// and turns half-duplex buses around; size it from a stack report
+// (pb_integration_tests/harness/stack_report.py).
+#ifndef PB_UART_CONFIG_SERVICE_STACK_SIZE
+#define PB_UART_CONFIG_SERVICE_STACK_SIZE 2048
+#endif
+
+namespace pb::uart::config {
+
+// Maximum number of simultaneously initialized AsyncUart instances serviced
+// by the shared background task (P2 exposes Serial1..Serial3).
+inline constexpr size_t kMaxInstances = 3;
+
+// Priority and stack of the shared background task ("uart_svc").
+inline constexpr int kServiceThreadPriority = 3;  // Slightly above default
+inline constexpr size_t kServiceThreadStackSize =
+    PB_UART_CONFIG_SERVICE_STACK_SIZE;
+
+// Upper bound for a single event wait. A thread notification can't end the
+// wait, so this bounds how late the background task notices a WriteFuture or
+// direction pin on the waiting port that started after the wait (only RX
+// wakes it then). Futures on the other initialized ports are noticed within
+// their own poll_interval_ms.
+inline constexpr uint32_t kEventIdleTimeoutMs = 10;
+
+// Maximum number of RxTap subscribers per AsyncUart.
+inline constexpr size_t kMaxRxTaps = 2;
+
+// Bytes AsyncUartRpcChannel reads per ReadUntil(). Frames up to this size
+// are received with one read; longer ones take several.
+inline constexpr size_t kRpcReadChunkSize = 128;
+
+}  // namespace pb::uart::config
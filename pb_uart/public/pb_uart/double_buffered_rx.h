@@ -0,0 +1,154 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "pb_uart/async_uart.h"
+#include "pw_async2/context.h"
+#include "pw_async2/poll.h"
+#include "pw_async2/waker.h"
+#include "pw_bytes/span.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_chrono/system_timer.h"
+#include "pw_status/status_with_size.h"
+#include "pw_sync/mutex.h"
+
+namespace pb {
+
+class DoubleBufferedRx;
+
+/// Future returned by DoubleBufferedRx::FillNext().
+class BlockFuture {
+ public:
+  using value_type = pw::StatusWithSize;
+
+  BlockFuture() = default;
+  BlockFuture(BlockFuture&& other) noexcept;
+  BlockFuture& operator=(BlockFuture&& other) noexcept;
+
+  BlockFuture(const BlockFuture&) = delete;
+  BlockFuture& operator=(const BlockFuture&) = delete;
+
+  /// Ready with the size of the next half once it is full, or with
+  /// DeadlineExceeded and its partial size at the deadline.
+  pw::async2::Poll<pw::StatusWithSize> Pend(pw::async2::Context& cx);
+
+  [[nodiscard]] bool is_complete() const { return completed_; }
+
+ private:
+  friend class DoubleBufferedRx;
+
+  BlockFuture(DoubleBufferedRx* rx, uint32_t timeout_ms);
+
+  DoubleBufferedRx* rx_ = nullptr;
+  uint32_t timeout_ms_ = ReadFuture::kNoTimeout;
+  pw::chrono::SystemClock::time_point deadline_;
+  bool deadline_armed_ = false;
+  bool completed_ = false;
+};
+
+/// Ping-pong block receiver on top of AsyncUart for high-rate streams.
+///
+/// The application owns two halves. The AsyncUart background task copies
+/// received bytes into one half while the application processes the other,
+/// so the HAL ring buffer keeps draining during processing and the stream
+/// can stall for up to a half plus the ring buffer without losing bytes.
+///
+/// Device OS does not let applications own the RX DMA descriptors; the UART
+/// DMA always targets the HAL ring buffer passed to AsyncUart, and each
+/// service pass moves everything buffered into the half with one bulk copy.
+///
+/// Usage:
+/// @code
+///   alignas(32) static std::byte half_a[512];
+///   alignas(32) static std::byte half_b[512];
+///   pb::DoubleBufferedRx rx(uart, half_a, half_b);
+///
+///   // In a coroutine:
+///   while (true) {
+///     auto result = co_await rx.FillNext();
+///     PW_TRY(result.status());
+///     ParseNmea(rx.current().first(result.size()));
+///   }
+/// @endcode
+class DoubleBufferedRx {
+ public:
+  /// @param uart Initialized AsyncUart. No other reads may be issued on it
+  ///        while the DoubleBufferedRx exists, and it must outlive it.
+  /// @param first_half, second_half Application-owned halves (non-empty)
+  DoubleBufferedRx(AsyncUart& uart,
+                   pw::ByteSpan first_half,
+                   pw::ByteSpan second_half);
+
+  /// Stops the background copying.
+  ~DoubleBufferedRx();
+
+  DoubleBufferedRx(const DoubleBufferedRx&) = delete;
+  DoubleBufferedRx& operator=(const DoubleBufferedRx&) = delete;
+
+  /// Hands current() back for filling and waits for the next half.
+  ///
+  /// The first call starts the background copying into the first half. The
+  /// future completes with the half size once the half is full, or with
+  /// DeadlineExceeded and the bytes received so far if `timeout_ms`
+  /// expires; filling then continues in the other half. current() is not
+  /// written to until the next call.
+  BlockFuture FillNext(uint32_t timeout_ms = ReadFuture::kNoTimeout);
+
+  /// The half returned by the most recent FillNext() future.
+  [[nodiscard]] pw::ByteSpan current() const { return current_block_; }
+
+  /// Number of FillNext() calls so far (i.e. halves handed out).
+  [[nodiscard]] uint32_t blocks_started() const { return blocks_started_; }
+
+ private:
+  friend class AsyncUart;
+  friend class BlockFuture;
+
+  static constexpr size_t kNone = 2;
+
+  /// Copies buffered bytes into the half being filled and moves on to the
+  /// other half when it is full. Called from the AsyncUart service pass.
+  void Fill();
+
+  /// True while a half is free for the background task to fill.
+  bool wants_data() const {
+    return wants_data_.load(std::memory_order_acquire);
+  }
+
+  /// Marks the filling half ready and continues in the other half if the
+  /// application has released it. Must be called with lock_ held.
+  void CompleteFillingLocked();
+
+  pw::async2::Poll<pw::StatusWithSize> PendBlock(BlockFuture& future,
+                                                 pw::async2::Context& cx);
+
+  /// Wakes the pending future, if any. Must be called without lock_ held.
+  void WakeFuture();
+
+  AsyncUart& uart_;
+  std::array<pw::ByteSpan, 2> halves_;
+  pw::ByteSpan current_block_;  // Handed to the application (dispatcher)
+  uint32_t blocks_started_ = 0;
+  bool attached_ = false;
+
+  pw::sync::Mutex lock_;
+  std::array<size_t, 2> size_{};     // Protected by lock_
+  std::array<bool, 2> ready_{};      // Protected by lock_
+  size_t filling_ = 0;               // Protected by lock_; kNone if no half
+  size_t next_ = 0;                  // Protected by lock_; half to hand out
+  size_t current_ = kNone;           // Protected by lock_; half handed out
+  pw::async2::Waker waker_;          // Protected by lock_
+  bool has_waker_ = false;           // Protected by lock_
+  std::atomic<bool> wants_data_{false};
+
+  // Wakes the pending future at its deadline
+  pw::chrono::SystemTimer timer_;
+};
+
+}  // namespace pb
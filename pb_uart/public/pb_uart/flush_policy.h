@@ -0,0 +1,21 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+namespace pb {
+
+/// When a UART stream waits for written bytes to leave the UART on its own.
+/// An explicit Flush() always waits.
+enum class FlushPolicy {
+  /// Every Write() waits until the last bit is on the wire. Needed for
+  /// request/response protocols like PN532 that time the response.
+  kAlways,
+  /// Write() returns once the data is queued; Flush() waits.
+  kOnFlush,
+  /// Write() never waits for transmission. For fire-and-forget streams such
+  /// as telemetry, which only call Flush() before e.g. sleeping.
+  kNever,
+};
+
+}  // namespace pb
@@ -0,0 +1,57 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+
+#include "pw_bytes/span.h"
+#include "usart_hal.h"
+
+/// Bulk helpers over the HAL USART ring buffers, shared by pb::AsyncUart and
+/// pb::ParticleUartStream.
+namespace pb::uart {
+
+/// Copies bytes that are already in the HAL receive buffer into `dest`.
+///
+/// Never blocks. With PB_UART_CONFIG_BULK_IO the copy is done in a single
+/// hal_usart_read_buffer() call (contiguous ring buffer regions are
+/// memcpy'd), otherwise one hal_usart_read() per byte.
+///
+/// @return Number of bytes copied (0 if nothing is available)
+size_t ReadAvailable(hal_usart_interface_t serial, pw::ByteSpan dest);
+
+/// Like ReadAvailable(), but stops after the first `delimiter`.
+///
+/// Bytes after the delimiter are left in the HAL receive buffer. With
+/// PB_UART_CONFIG_BULK_IO the buffered bytes are peeked and scanned with
+/// hal_usart_peek_buffer(), then consumed up to the delimiter in one call.
+///
+/// @param found Set to true if the delimiter was copied into `dest`
+/// @return Number of bytes copied, including the delimiter
+size_t ReadUntilDelimiter(hal_usart_interface_t serial,
+                          pw::ByteSpan dest,
+                          std::byte delimiter,
+                          bool& found);
+
+/// Queues as much of `data` as fits into the HAL transmit buffer.
+///
+/// Never blocks. Uses hal_usart_write_buffer() with PB_UART_CONFIG_BULK_IO,
+/// otherwise one hal_usart_write() per byte.
+///
+/// @return Number of bytes queued (0 if the TX buffer is full)
+size_t WriteAvailable(hal_usart_interface_t serial, pw::ConstByteSpan data);
+
+/// Queues all of `data` into the HAL transmit buffer.
+///
+/// Copies in bulk with WriteAvailable() while there is space. When the TX
+/// buffer is full, hands one byte to hal_usart_write(), which blocks until
+/// the UART has drained a slot. Returns once the last byte is queued, not
+/// when it has been transmitted (see hal_usart_flush()).
+void WriteAll(hal_usart_interface_t serial, pw::ConstByteSpan data);
+
+/// Discards all bytes currently in the HAL receive buffer.
+/// @return Number of bytes discarded
+size_t DiscardAvailable(hal_usart_interface_t serial);
+
+}  // namespace pb::uart
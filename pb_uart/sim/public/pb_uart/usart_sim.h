@@ -0,0 +1,72 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file usart_sim.h
+/// @brief Peer end of the host USART simulation (//pb_uart:usart_hal_sim).
+///
+/// Host builds of pb_uart run against a simulated USART HAL: the code under
+/// test uses hal_usart_* (directly or through AsyncUart), while the test
+/// plays the device on the other end of the wire with the functions below.
+///
+/// Bytes take one character time on the line (start, data, parity and stop
+/// bits at the configured baud rate) and land in the RX ring when their
+/// stop bit is done. A full RX ring drops bytes like the UART does (counted
+/// as overruns). The device's TX ring drains at the same rate. Time is host
+/// time (pw::chrono::SystemClock), so parsers and coroutines can be
+/// profiled under a given, reproducible throughput:
+///
+/// @code
+///   alignas(32) std::byte rx_buf[265];
+///   alignas(32) std::byte tx_buf[265];
+///   pb::AsyncUart uart(HAL_USART_SERIAL2, rx_buf, tx_buf);
+///   PW_TRY(uart.Init(921600));
+///
+///   pb::uart::sim::PeerWrite(HAL_USART_SERIAL2, frames);  // Arrives paced
+///   // ... co_await uart.ReadFrame(...) in the code under test ...
+///   pb::uart::sim::Reset();
+/// @endcode
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_chrono/system_clock.h"
+#include "usart_hal.h"
+
+namespace pb::uart::sim {
+
+/// Line counters of a simulated port (see GetStats()).
+struct UsartSimStats {
+  uint32_t bytes_received = 0;     ///< Bytes that reached the RX ring
+  uint32_t bytes_transmitted = 0;  ///< Bytes that left the TX ring
+  uint32_t rx_overruns = 0;        ///< Bytes dropped with a full RX ring
+};
+
+/// Sends `data` to the device, as a peer on its RX line would. The bytes
+/// follow any still on the wire, one character time apart.
+void PeerWrite(hal_usart_interface_t serial, pw::ConstByteSpan data);
+
+/// Copies bytes the device has finished transmitting and the peer has not
+/// read yet. Non-blocking.
+/// @return Number of bytes copied
+size_t PeerRead(hal_usart_interface_t serial, pw::ByteSpan dest);
+
+/// Number of PeerWrite() bytes still on the wire.
+size_t PeerPending(hal_usart_interface_t serial);
+
+/// Time at which the last PeerWrite() byte will have arrived.
+pw::chrono::SystemClock::time_point PeerIdleAt(hal_usart_interface_t serial);
+
+/// Wires the TX line of `serial` to its own RX line (like a D4-D5 jumper).
+/// Transmitted bytes then arrive in the RX ring instead of PeerRead().
+void SetLoopback(hal_usart_interface_t serial, bool enabled);
+
+UsartSimStats GetStats(hal_usart_interface_t serial);
+
+/// Stops every port and clears wires, loopback and counters. Call between
+/// tests, after the code under test has released the ports.
+void Reset();
+
+}  // namespace pb::uart::sim
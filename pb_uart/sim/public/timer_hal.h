@@ -0,0 +1,23 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file timer_hal.h
+/// @brief Host stand-in for the Device OS timer HAL (see usart_hal.h).
+///
+/// Both counters derive from pw::chrono::SystemClock and wrap like their
+/// Device OS counterparts.
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t HAL_Timer_Get_Micro_Seconds(void);
+uint32_t HAL_Timer_Get_Milli_Seconds(void);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
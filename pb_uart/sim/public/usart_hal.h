@@ -0,0 +1,112 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file usart_hal.h
+/// @brief Host simulation of the Device OS USART HAL.
+///
+/// Stands in for Device OS's usart_hal.h in host builds of pb_uart (see
+/// //pb_uart:usart_hal_sim). Declares the subset of the HAL that pb_uart
+/// calls, with the same signatures and ring buffer semantics; bytes move
+/// on the simulated line at the configured baud rate. The peer end of each
+/// port is driven through pb_uart/usart_sim.h.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/// Defined when pb_uart is compiled against the host simulation.
+#define PB_USART_HAL_SIM 1
+
+// Line configuration (same encoding as Device OS)
+#define SERIAL_STOP_BITS ((uint32_t)0b00000011)
+#define SERIAL_STOP_BITS_1 ((uint32_t)0b00000000)
+#define SERIAL_STOP_BITS_2 ((uint32_t)0b00000001)
+#define SERIAL_STOP_BITS_0_5 ((uint32_t)0b00000010)
+#define SERIAL_STOP_BITS_1_5 ((uint32_t)0b00000011)
+
+#define SERIAL_PARITY ((uint32_t)0b00001100)
+#define SERIAL_PARITY_NO ((uint32_t)0b00000000)
+#define SERIAL_PARITY_EVEN ((uint32_t)0b00000100)
+#define SERIAL_PARITY_ODD ((uint32_t)0b00001000)
+
+#define SERIAL_DATA_BITS ((uint32_t)0b00110000)
+#define SERIAL_DATA_BITS_8 ((uint32_t)0b00000000)
+#define SERIAL_DATA_BITS_9 ((uint32_t)0b00010000)
+#define SERIAL_DATA_BITS_7 ((uint32_t)0b00100000)
+
+#define SERIAL_8N1 (SERIAL_STOP_BITS_1 | SERIAL_PARITY_NO | SERIAL_DATA_BITS_8)
+#define SERIAL_8N2 (SERIAL_STOP_BITS_2 | SERIAL_PARITY_NO | SERIAL_DATA_BITS_8)
+#define SERIAL_8E1 (SERIAL_STOP_BITS_1 | SERIAL_PARITY_EVEN | SERIAL_DATA_BITS_8)
+#define SERIAL_8E2 (SERIAL_STOP_BITS_2 | SERIAL_PARITY_EVEN | SERIAL_DATA_BITS_8)
+#define SERIAL_8O1 (SERIAL_STOP_BITS_1 | SERIAL_PARITY_ODD | SERIAL_DATA_BITS_8)
+#define SERIAL_8O2 (SERIAL_STOP_BITS_2 | SERIAL_PARITY_ODD | SERIAL_DATA_BITS_8)
+
+/// Ring buffer size used when no buffers are passed to hal_usart_init_ex().
+#define SERIAL_BUFFER_SIZE 64
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum hal_usart_interface_t {
+  HAL_USART_SERIAL1 = 0,
+  HAL_USART_SERIAL2 = 1,
+  HAL_USART_SERIAL3 = 2,
+} hal_usart_interface_t;
+
+typedef struct hal_usart_buffer_config_t {
+  uint16_t size;
+  void* rx_buffer;
+  uint16_t rx_buffer_size;
+  void* tx_buffer;
+  uint16_t tx_buffer_size;
+} hal_usart_buffer_config_t;
+
+/// Hands the RX/TX ring buffers to the port. One slot of each ring stays
+/// unused, as in the Device OS ring buffers.
+int hal_usart_init_ex(hal_usart_interface_t serial,
+                      const hal_usart_buffer_config_t* config,
+                      void* reserved);
+
+/// Starts the port. Empties both rings; the line runs at `baud` with the
+/// character length given by `config` (start + data + parity + stop bits).
+void hal_usart_begin_config(hal_usart_interface_t serial,
+                            uint32_t baud,
+                            uint32_t config,
+                            void* reserved);
+
+/// Stops the port and releases the ring buffers.
+void hal_usart_end(hal_usart_interface_t serial);
+
+/// Queues one byte, blocking while the TX ring is full.
+uint32_t hal_usart_write(hal_usart_interface_t serial, uint8_t data);
+
+int32_t hal_usart_available(hal_usart_interface_t serial);
+int32_t hal_usart_available_data_for_write(hal_usart_interface_t serial);
+
+/// Returns the next received byte, or -1 if the RX ring is empty.
+int32_t hal_usart_read(hal_usart_interface_t serial);
+int32_t hal_usart_peek(hal_usart_interface_t serial);
+
+/// Blocks until the TX ring has drained and the last byte is on the line.
+void hal_usart_flush(hal_usart_interface_t serial);
+
+/// Bulk ring buffer access. `elementSize` must be 1.
+ssize_t hal_usart_write_buffer(hal_usart_interface_t serial,
+                               const void* buffer,
+                               size_t size,
+                               size_t elementSize);
+ssize_t hal_usart_read_buffer(hal_usart_interface_t serial,
+                              void* buffer,
+                              size_t size,
+                              size_t elementSize);
+ssize_t hal_usart_peek_buffer(hal_usart_interface_t serial,
+                              void* buffer,
+                              size_t size,
+                              size_t elementSize);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
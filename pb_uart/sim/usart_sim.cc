@@ -0,0 +1,486 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_uart/usart_sim.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+#include "pw_sync/mutex.h"
+#include "pw_thread/sleep.h"
+#include "timer_hal.h"
+#include "usart_hal.h"
+
+namespace pb::uart::sim {
+namespace {
+
+using Clock = pw::chrono::SystemClock;
+
+constexpr size_t kPortCount = 3;
+
+/// Byte ring over caller-provided storage. Like the Device OS rings, one
+/// slot stays unused to tell a full ring from an empty one.
+class Ring {
+ public:
+  void Assign(pw::ByteSpan storage) {
+    storage_ = storage;
+    Clear();
+  }
+
+  void Clear() {
+    head_ = 0;
+    tail_ = 0;
+  }
+
+  size_t capacity() const {
+    return storage_.empty() ? 0 : storage_.size() - 1;
+  }
+
+  size_t size() const {
+    return storage_.empty()
+               ? 0
+               : (head_ + storage_.size() - tail_) % storage_.size();
+  }
+
+  bool empty() const { return head_ == tail_; }
+
+  bool Push(std::byte value) {
+    if (size() == capacity()) {
+      return false;
+    }
+    storage_[head_] = value;
+    head_ = (head_ + 1) % storage_.size();
+    return true;
+  }
+
+  size_t Peek(pw::ByteSpan dest) const {
+    const size_t count = std::min(dest.size(), size());
+    for (size_t i = 0; i < count; ++i) {
+      dest[i] = storage_[(tail_ + i) % storage_.size()];
+    }
+    return count;
+  }
+
+  std::byte Pop() {
+    const std::byte value = storage_[tail_];
+    tail_ = (tail_ + 1) % storage_.size();
+    return value;
+  }
+
+  void Drop(size_t count) {
+    if (count > 0) {
+      tail_ = (tail_ + count) % storage_.size();
+    }
+  }
+
+ private:
+  pw::ByteSpan storage_;
+  size_t head_ = 0;
+  size_t tail_ = 0;
+};
+
+struct Port {
+  Ring rx;
+  Ring tx;
+  std::array<std::byte, SERIAL_BUFFER_SIZE> default_rx{};
+  std::array<std::byte, SERIAL_BUFFER_SIZE> default_tx{};
+  bool buffers_assigned = false;
+  bool enabled = false;
+  bool loopback = false;
+
+  Clock::duration char_time{};
+  // While the TX ring is not empty, its first byte is being shifted out
+  // until tx_done
+  Clock::time_point tx_done{};
+  // Bytes on the RX wire with the time their stop bit ends
+  std::deque<std::pair<Clock::time_point, std::byte>> rx_wire;
+  Clock::time_point rx_line_free{};
+  // Transmitted bytes not yet collected with PeerRead()
+  std::deque<std::byte> to_peer;
+
+  UsartSimStats stats;
+};
+
+// All simulated ports - protected by g_lock
+pw::sync::Mutex g_lock;
+std::array<Port, kPortCount> g_ports;
+
+Port* GetPort(hal_usart_interface_t serial) {
+  const auto index = static_cast<size_t>(serial);
+  return index < kPortCount ? &g_ports[index] : nullptr;
+}
+
+Clock::duration CharTime(uint32_t baud, uint32_t config) {
+  if (baud == 0) {
+    return Clock::duration::zero();
+  }
+  uint32_t bits = 1;  // Start bit
+  switch (config & SERIAL_DATA_BITS) {
+    case SERIAL_DATA_BITS_7:
+      bits += 7;
+      break;
+    case SERIAL_DATA_BITS_9:
+      bits += 9;
+      break;
+    default:
+      bits += 8;
+      break;
+  }
+  if ((config & SERIAL_PARITY) != SERIAL_PARITY_NO) {
+    bits += 1;
+  }
+  // 0.5 and 1.5 stop bits round up to whole bit times
+  const uint32_t stop = config & SERIAL_STOP_BITS;
+  bits += (stop == SERIAL_STOP_BITS_2 || stop == SERIAL_STOP_BITS_1_5) ? 2 : 1;
+  return std::chrono::duration_cast<Clock::duration>(
+      std::chrono::nanoseconds(uint64_t{bits} * 1'000'000'000u / baud));
+}
+
+void ToWire(Port& port, Clock::time_point start, std::byte value) {
+  const Clock::time_point arrival =
+      std::max(start, port.rx_line_free) + port.char_time;
+  port.rx_line_free = arrival;
+  port.rx_wire.emplace_back(arrival, value);
+}
+
+/// Moves the line forward to `now`: finishes transmitted bytes and lands
+/// received ones in the RX ring. Must be called with g_lock held.
+void Advance(Port& port, Clock::time_point now) {
+  while (!port.tx.empty() && port.tx_done <= now) {
+    const std::byte value = port.tx.Pop();
+    ++port.stats.bytes_transmitted;
+    if (port.loopback) {
+      // Arrives with its own stop bit, which has just ended
+      ToWire(port, port.tx_done - port.char_time, value);
+    } else {
+      port.to_peer.push_back(value);
+    }
+    if (!port.tx.empty()) {
+      port.tx_done += port.char_time;
+    }
+  }
+
+  while (!port.rx_wire.empty() && port.rx_wire.front().first <= now) {
+    if (port.enabled) {
+      if (port.rx.Push(port.rx_wire.front().second)) {
+        ++port.stats.bytes_received;
+      } else {
+        ++port.stats.rx_overruns;
+      }
+    }
+    port.rx_wire.pop_front();
+  }
+}
+
+/// Queues bytes into the TX ring without blocking. Must be called with
+/// g_lock held, after Advance().
+size_t QueueTx(Port& port, Clock::time_point now, pw::ConstByteSpan data) {
+  size_t queued = 0;
+  for (std::byte value : data) {
+    if (!port.tx.Push(value)) {
+      break;
+    }
+    if (port.tx.size() == 1) {
+      // The line was idle: the byte goes out right away
+      port.tx_done = now + port.char_time;
+    }
+    ++queued;
+  }
+  return queued;
+}
+
+/// Blocks until `done(port)` holds, sleeping until the next TX byte is
+/// out between checks.
+template <typename Predicate>
+void WaitForTx(hal_usart_interface_t serial, Predicate done) {
+  while (true) {
+    Clock::time_point wake;
+    {
+      std::lock_guard lock(g_lock);
+      Port* port = GetPort(serial);
+      if (port == nullptr || !port->enabled) {
+        return;
+      }
+      Advance(*port, Clock::now());
+      if (done(*port)) {
+        return;
+      }
+      wake = port->tx_done;
+    }
+    pw::this_thread::sleep_until(wake);
+  }
+}
+
+}  // namespace
+
+void PeerWrite(hal_usart_interface_t serial, pw::ConstByteSpan data) {
+  std::lock_guard lock(g_lock);
+  Port* port = GetPort(serial);
+  if (port == nullptr) {
+    return;
+  }
+  const Clock::time_point now = Clock::now();
+  Advance(*port, now);
+  for (std::byte value : data) {
+    ToWire(*port, now, value);
+  }
+}
+
+size_t PeerRead(hal_usart_interface_t serial, pw::ByteSpan dest) {
+  std::lock_guard lock(g_lock);
+  Port* port = GetPort(serial);
+  if (port == nullptr) {
+    return 0;
+  }
+  Advance(*port, Clock::now());
+  const size_t count = std::min(dest.size(), port->to_peer.size());
+  std::copy_n(port->to_peer.begin(), count, dest.begin());
+  port->to_peer.erase(port->to_peer.begin(), port->to_peer.begin() + count);
+  return count;
+}
+
+size_t PeerPending(hal_usart_interface_t serial) {
+  std::lock_guard lock(g_lock);
+  Port* port = GetPort(serial);
+  if (port == nullptr) {
+    return 0;
+  }
+  Advance(*port, Clock::now());
+  return port->rx_wire.size();
+}
+
+Clock::time_point PeerIdleAt(hal_usart_interface_t serial) {
+  std::lock_guard lock(g_lock);
+  Port* port = GetPort(serial);
+  return port != nullptr ? port->rx_line_free : Clock::time_point{};
+}
+
+void SetLoopback(hal_usart_interface_t serial, bool enabled) {
+  std::lock_guard lock(g_lock);
+  if (Port* port = GetPort(serial); port != nullptr) {
+    Advance(*port, Clock::now());
+    port->loopback = enabled;
+  }
+}
+
+UsartSimStats GetStats(hal_usart_interface_t serial) {
+  std::lock_guard lock(g_lock);
+  Port* port = GetPort(serial);
+  if (port == nullptr) {
+    return {};
+  }
+  Advance(*port, Clock::now());
+  return port->stats;
+}
+
+void Reset() {
+  std::lock_guard lock(g_lock);
+  for (Port& port : g_ports) {
+    port.rx.Assign({});
+    port.tx.Assign({});
+    port.buffers_assigned = false;
+    port.enabled = false;
+    port.loopback = false;
+    port.char_time = {};
+    port.tx_done = {};
+    port.rx_wire.clear();
+    port.rx_line_free = {};
+    port.to_peer.clear();
+    port.stats = {};
+  }
+}
+
+}  // namespace pb::uart::sim
+
+// ---------------------------------------------------------------------------
+// HAL entry points
+// ---------------------------------------------------------------------------
+
+using pb::uart::sim::Advance;
+using pb::uart::sim::Clock;
+using pb::uart::sim::g_lock;
+using pb::uart::sim::GetPort;
+using pb::uart::sim::Port;
+
+extern "C" {
+
+int hal_usart_init_ex(hal_usart_interface_t serial,
+                      const hal_usart_buffer_config_t* config,
+                      void*) {
+  std::lock_guard lock(g_lock);
+  Port* port = GetPort(serial);
+  if (port == nullptr || config == nullptr) {
+    return -1;
+  }
+  port->rx.Assign(pw::ByteSpan(static_cast<std::byte*>(config->rx_buffer),
+                               config->rx_buffer_size));
+  port->tx.Assign(pw::ByteSpan(static_cast<std::byte*>(config->tx_buffer),
+                               config->tx_buffer_size));
+  port->buffers_assigned = true;
+  return 0;
+}
+
+void hal_usart_begin_config(hal_usart_interface_t serial,
+                            uint32_t baud,
+                            uint32_t config,
+                            void*) {
+  std::lock_guard lock(g_lock);
+  Port* port = GetPort(serial);
+  if (port == nullptr) {
+    return;
+  }
+  if (!port->buffers_assigned) {
+    port->rx.Assign(port->default_rx);
+    port->tx.Assign(port->default_tx);
+    port->buffers_assigned = true;
+  }
+  port->rx.Clear();
+  port->tx.Clear();
+  port->char_time = pb::uart::sim::CharTime(baud, config);
+  port->enabled = true;
+}
+
+void hal_usart_end(hal_usart_interface_t serial) {
+  std::lock_guard lock(g_lock);
+  Port* port = GetPort(serial);
+  if (port == nullptr) {
+    return;
+  }
+  Advance(*port, Clock::now());
+  port->enabled = false;
+  port->rx.Assign({});
+  port->tx.Assign({});
+  port->buffers_assigned = false;
+}
+
+uint32_t hal_usart_write(hal_usart_interface_t serial, uint8_t data) {
+  const std::byte value{data};
+  pb::uart::sim::WaitForTx(serial, [](const Port& port) {
+    return port.tx.size() < port.tx.capacity();
+  });
+  std::lock_guard lock(g_lock);
+  Port* port = GetPort(serial);
+  if (port == nullptr || !port->enabled) {
+    return 0;
+  }
+  const Clock::time_point now = Clock::now();
+  Advance(*port, now);
+  return static_cast<uint32_t>(
+      pb::uart::sim::QueueTx(*port, now, pw::ConstByteSpan(&value, 1)));
+}
+
+int32_t hal_usart_available(hal_usart_interface_t serial) {
+  std::lock_guard lock(g_lock);
+  Port* port = GetPort(serial);
+  if (port == nullptr) {
+    return -1;
+  }
+  Advance(*port, Clock::now());
+  return static_cast<int32_t>(port->rx.size());
+}
+
+int32_t hal_usart_available_data_for_write(hal_usart_interface_t serial) {
+  std::lock_guard lock(g_lock);
+  Port* port = GetPort(serial);
+  if (port == nullptr) {
+    return -1;
+  }
+  if (!port->enabled) {
+    return 0;
+  }
+  Advance(*port, Clock::now());
+  return static_cast<int32_t>(port->tx.capacity() - port->tx.size());
+}
+
+int32_t hal_usart_read(hal_usart_interface_t serial) {
+  std::byte value;
+  return hal_usart_read_buffer(serial, &value, 1, sizeof(uint8_t)) == 1
+             ? static_cast<int32_t>(value)
+             : -1;
+}
+
+int32_t hal_usart_peek(hal_usart_interface_t serial) {
+  std::byte value;
+  return hal_usart_peek_buffer(serial, &value, 1, sizeof(uint8_t)) == 1
+             ? static_cast<int32_t>(value)
+             : -1;
+}
+
+void hal_usart_flush(hal_usart_interface_t serial) {
+  pb::uart::sim::WaitForTx(serial,
+                           [](const Port& port) { return port.tx.empty(); });
+}
+
+ssize_t hal_usart_write_buffer(hal_usart_interface_t serial,
+                               const void* buffer,
+                               size_t size,
+                               size_t elementSize) {
+  if (elementSize != sizeof(uint8_t)) {
+    return -1;
+  }
+  std::lock_guard lock(g_lock);
+  Port* port = GetPort(serial);
+  if (port == nullptr || !port->enabled) {
+    return -1;
+  }
+  const Clock::time_point now = Clock::now();
+  Advance(*port, now);
+  return static_cast<ssize_t>(pb::uart::sim::QueueTx(
+      *port, now, pw::ConstByteSpan(static_cast<const std::byte*>(buffer), size)));
+}
+
+ssize_t hal_usart_read_buffer(hal_usart_interface_t serial,
+                              void* buffer,
+                              size_t size,
+                              size_t elementSize) {
+  if (elementSize != sizeof(uint8_t)) {
+    return -1;
+  }
+  std::lock_guard lock(g_lock);
+  Port* port = GetPort(serial);
+  if (port == nullptr) {
+    return -1;
+  }
+  Advance(*port, Clock::now());
+  const size_t count =
+      port->rx.Peek(pw::ByteSpan(static_cast<std::byte*>(buffer), size));
+  port->rx.Drop(count);
+  return static_cast<ssize_t>(count);
+}
+
+ssize_t hal_usart_peek_buffer(hal_usart_interface_t serial,
+                              void* buffer,
+                              size_t size,
+                              size_t elementSize) {
+  if (elementSize != sizeof(uint8_t)) {
+    return -1;
+  }
+  std::lock_guard lock(g_lock);
+  Port* port = GetPort(serial);
+  if (port == nullptr) {
+    return -1;
+  }
+  Advance(*port, Clock::now());
+  return static_cast<ssize_t>(
+      port->rx.Peek(pw::ByteSpan(static_cast<std::byte*>(buffer), size)));
+}
+
+uint32_t HAL_Timer_Get_Micro_Seconds(void) {
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          Clock::now().time_since_epoch())
+          .count());
+}
+
+uint32_t HAL_Timer_Get_Milli_Seconds(void) {
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          Clock::now().time_since_epoch())
+          .count());
+}
+
+}  // extern "C"
@@ -0,0 +1,159 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Host test of AsyncUartRpcChannel on the simulated USART HAL. With the
+// port in loopback, one channel carries both the client's requests and the
+// server's responses, so the logged call times are two frames on the wire
+// plus the task overhead.
+
+#include "pb_uart/async_uart_rpc_channel.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <string_view>
+
+#include "pb_uart/usart_sim.h"
+#include "pw_async2/basic_dispatcher.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_hdlc/encoder.h"
+#include "pw_log/log.h"
+#include "pw_rpc/client.h"
+#include "pw_rpc/echo.rpc.pwpb.h"
+#include "pw_rpc/echo_service_pwpb.h"
+#include "pw_rpc/server.h"
+#include "pw_stream/memory_stream.h"
+#include "pw_thread/sleep.h"
+#include "pw_unit_test/framework.h"
+
+namespace {
+
+using pw::chrono::SystemClock;
+
+constexpr hal_usart_interface_t kSerial = HAL_USART_SERIAL2;
+constexpr uint32_t kBaudRate = 921600;
+constexpr uint64_t kAddress = 'R';
+constexpr uint32_t kChannelId = 1;
+
+class AsyncUartRpcChannelSimTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    pb::uart::sim::SetLoopback(kSerial, true);
+    ASSERT_EQ(uart_.Init(kBaudRate), pw::OkStatus());
+    link_.set_server(server_);
+    link_.set_client(client_);
+    server_.RegisterService(echo_service_);
+    dispatcher_.Post(link_);
+  }
+
+  void TearDown() override {
+    link_.Stop();
+    dispatcher_.RunToCompletion();
+    uart_.Deinit();
+    pb::uart::sim::Reset();
+  }
+
+  // Runs the dispatcher until `done` or the timeout.
+  template <typename Predicate>
+  bool RunUntil(Predicate done, std::chrono::milliseconds timeout) {
+    const auto deadline = SystemClock::now() + timeout;
+    while (!done()) {
+      if (SystemClock::now() >= deadline) {
+        return false;
+      }
+      dispatcher_.RunUntilStalled();
+      pw::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    return true;
+  }
+
+  alignas(32) std::array<std::byte, 256> rx_buf_{};
+  alignas(32) std::array<std::byte, 256> tx_buf_{};
+  pb::AsyncUart uart_{kSerial, rx_buf_, tx_buf_};
+
+  std::array<std::byte, 256> frame_buffer_{};
+  std::array<std::byte, 512> send_buffer_{};
+  pb::AsyncUartRpcChannel link_{uart_, kAddress, frame_buffer_, send_buffer_};
+
+  std::array<pw::rpc::Channel, 1> server_channels_{
+      pw::rpc::Channel::Create<kChannelId>(&link_)};
+  std::array<pw::rpc::Channel, 1> client_channels_{
+      pw::rpc::Channel::Create<kChannelId>(&link_)};
+  pw::rpc::Server server_{server_channels_};
+  pw::rpc::Client client_{client_channels_};
+  pw::rpc::EchoService echo_service_;
+
+  pw::async2::BasicDispatcher dispatcher_;
+};
+
+TEST_F(AsyncUartRpcChannelSimTest, EchoCalls) {
+  constexpr size_t kCalls = 50;
+  pw::rpc::pw_rpc::pwpb::EchoService::Client echo(client_, kChannelId);
+
+  size_t completed = 0;
+  size_t mismatches = 0;
+  const auto start = SystemClock::now();
+  for (size_t i = 0; i < kCalls; ++i) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "echo %u", static_cast<unsigned>(i));
+    bool done = false;
+    auto call = echo.Echo(
+        {.msg = text},
+        [&](const pw::rpc::EchoMessage::Message& response, pw::Status status) {
+          if (!status.ok() || std::string_view(response.msg) != text) {
+            ++mismatches;
+          }
+          done = true;
+        });
+    ASSERT_TRUE(RunUntil([&] { return done; }, std::chrono::seconds(1)));
+    ++completed;
+  }
+  const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      SystemClock::now() - start);
+
+  const pb::AsyncUartRpcChannelStats stats = link_.stats();
+  PW_LOG_INFO("%u echo calls at %u baud: %u us per call, tx peak %u B",
+              static_cast<unsigned>(completed),
+              static_cast<unsigned>(kBaudRate),
+              static_cast<unsigned>(elapsed.count() / kCalls),
+              static_cast<unsigned>(stats.tx_peak_queued));
+
+  EXPECT_EQ(mismatches, 0u);
+  // One request and one response per call
+  EXPECT_EQ(stats.frames_received, 2 * kCalls);
+  EXPECT_EQ(stats.packets_sent, 2 * kCalls);
+  EXPECT_EQ(stats.frames_dropped, 0u);
+  EXPECT_EQ(pb::uart::sim::GetStats(kSerial).rx_overruns, 0u);
+}
+
+TEST_F(AsyncUartRpcChannelSimTest, SkipsForeignAndCorruptFrames) {
+  std::array<std::byte, 32> frame;
+  pw::stream::MemoryWriter writer(frame);
+  const std::array<std::byte, 4> payload{};
+  ASSERT_EQ(pw::hdlc::WriteUIFrame(kAddress + 1, payload, writer),
+            pw::OkStatus());
+  const size_t size = writer.bytes_written();
+
+  // A frame for another address, then the same frame with a payload byte
+  // flipped (flag, address, control, payload...)
+  std::array<std::byte, 64> wire;
+  std::copy_n(frame.begin(), size, wire.begin());
+  std::copy_n(frame.begin(), size, wire.begin() + size);
+  wire[size + 3] ^= std::byte{0x01};
+  ASSERT_EQ(uart_.Write(pw::ConstByteSpan(wire).first(2 * size)),
+            pw::OkStatus());
+
+  ASSERT_TRUE(RunUntil(
+      [&] {
+        const pb::AsyncUartRpcChannelStats stats = link_.stats();
+        return stats.frames_ignored + stats.frames_dropped >= 2;
+      },
+      std::chrono::seconds(1)));
+  const pb::AsyncUartRpcChannelStats stats = link_.stats();
+  EXPECT_EQ(stats.frames_ignored, 1u);
+  EXPECT_EQ(stats.frames_dropped, 1u);
+  EXPECT_EQ(stats.frames_received, 0u);
+}
+
+}  // namespace
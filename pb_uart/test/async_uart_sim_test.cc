@@ -0,0 +1,304 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Host test of AsyncUart against the simulated USART HAL
+// (//pb_uart:usart_hal_sim). The peer's bytes arrive at the configured baud
+// rate, so the logged times show where the read paths add to the wire time.
+// Run under a profiler (e.g. perf record) to see the cost of parsers and
+// coroutine resumptions at a given throughput.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string_view>
+
+#include "pb_uart/async_uart.h"
+#include "pb_uart/double_buffered_rx.h"
+#include "pb_uart/usart_sim.h"
+#include "pw_allocator/testing.h"
+#include "pw_async2/basic_dispatcher.h"
+#include "pw_async2/coro.h"
+#include "pw_async2/coro_or_else_task.h"
+#include "pw_bytes/span.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_digital_io/digital_io.h"
+#include "pw_log/log.h"
+#include "pw_span/span.h"
+#include "pw_thread/sleep.h"
+#include "pw_unit_test/framework.h"
+
+namespace {
+
+using pw::chrono::SystemClock;
+
+constexpr hal_usart_interface_t kSerial = HAL_USART_SERIAL2;
+constexpr uint32_t kBaudRate = 115200;
+
+// A typical GNSS sentence
+constexpr std::string_view kLine =
+    "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\n";
+
+pw::allocator::test::AllocatorForTest<4096> test_allocator;
+
+uint32_t ElapsedUs(SystemClock::time_point start, SystemClock::time_point end) {
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+          .count());
+}
+
+// RS-485 driver enable pin; records how much of the TX data was on the
+// line when it changed.
+class DirectionPin : public pw::digital_io::DigitalOut {
+ public:
+  std::atomic<bool> active{false};
+  std::atomic<uint32_t> transmitted_at_assert{0};
+  std::atomic<uint32_t> transmitted_at_release{0};
+  std::atomic<SystemClock::time_point> released_at{};
+
+ private:
+  pw::Status DoEnable(bool) override { return pw::OkStatus(); }
+  pw::Status DoSetState(pw::digital_io::State state) override {
+    const uint32_t transmitted =
+        pb::uart::sim::GetStats(kSerial).bytes_transmitted;
+    active = state == pw::digital_io::State::kActive;
+    if (active) {
+      transmitted_at_assert = transmitted;
+    } else {
+      transmitted_at_release = transmitted;
+      released_at = SystemClock::now();
+    }
+    return pw::OkStatus();
+  }
+};
+
+class AsyncUartSimTest : public ::testing::Test {
+ protected:
+  void TearDown() override {
+    uart_.Deinit();
+    pb::uart::sim::Reset();
+  }
+
+  // Runs the coroutine to completion and returns its status.
+  pw::Status Run(pw::async2::Coro<pw::Status>&& coro) {
+    pw::Status result;  // Set by or_else when the coroutine fails
+    pw::async2::CoroOrElseTask task(
+        std::move(coro), [&result](pw::Status status) { result = status; });
+    dispatcher_.Post(task);
+    dispatcher_.RunToCompletion();
+    return result;
+  }
+
+  alignas(32) std::array<std::byte, 128> rx_buf_{};
+  alignas(32) std::array<std::byte, 128> tx_buf_{};
+  pb::AsyncUart uart_{kSerial, rx_buf_, tx_buf_};
+  pw::async2::BasicDispatcher dispatcher_;
+};
+
+TEST_F(AsyncUartSimTest, ReadUntilAtLineRate) {
+  constexpr size_t kLines = 100;
+  ASSERT_EQ(uart_.Init(kBaudRate), pw::OkStatus());
+
+  const auto start = SystemClock::now();
+  for (size_t i = 0; i < kLines; ++i) {
+    pb::uart::sim::PeerWrite(kSerial, pw::as_bytes(pw::span(kLine)));
+  }
+  const auto idle_at = pb::uart::sim::PeerIdleAt(kSerial);
+
+  size_t lines = 0;
+  auto read_lines =
+      [&](pw::async2::CoroContext&) -> pw::async2::Coro<pw::Status> {
+    std::array<std::byte, 96> line;
+    while (lines < kLines) {
+      auto result = co_await uart_.ReadUntil(line, std::byte{'\n'}, 1000);
+      PW_CO_TRY(result.status());
+      if (result.size() != kLine.size()) {
+        co_return pw::Status::DataLoss();
+      }
+      ++lines;
+    }
+    co_return pw::OkStatus();
+  };
+  pw::async2::CoroContext coro_cx(test_allocator);
+  EXPECT_EQ(Run(read_lines(coro_cx)), pw::OkStatus());
+  const auto end = SystemClock::now();
+
+  const pb::AsyncUartStats stats = uart_.stats();
+  PW_LOG_INFO("ReadUntil: %u lines in %u us (wire %u us), wake latency max "
+              "%u us, rx peak %u",
+              static_cast<unsigned>(lines),
+              static_cast<unsigned>(ElapsedUs(start, end)),
+              static_cast<unsigned>(ElapsedUs(start, idle_at)),
+              static_cast<unsigned>(stats.wake_latency_max_us),
+              static_cast<unsigned>(stats.rx_peak_buffered));
+
+  EXPECT_EQ(lines, kLines);
+  EXPECT_EQ(stats.bytes_received, kLines * kLine.size());
+  EXPECT_EQ(pb::uart::sim::GetStats(kSerial).rx_overruns, 0u);
+  // The last line can't be read before its last byte is off the wire
+  EXPECT_TRUE(end >= idle_at);
+}
+
+TEST_F(AsyncUartSimTest, LoopbackStreamsWritesLargerThanTxBuffer) {
+  constexpr size_t kSize = 1000;
+  pb::uart::sim::SetLoopback(kSerial, true);
+  ASSERT_EQ(uart_.Init(kBaudRate), pw::OkStatus());
+
+  std::array<std::byte, kSize> sent;
+  for (size_t i = 0; i < kSize; ++i) {
+    sent[i] = static_cast<std::byte>(i * 7);
+  }
+  std::array<std::byte, kSize> received{};
+
+  auto write = [&](pw::async2::CoroContext&) -> pw::async2::Coro<pw::Status> {
+    co_return co_await uart_.WriteAsync(sent, pb::WriteCompletion::kTransmitted);
+  };
+  size_t total = 0;
+  auto read = [&](pw::async2::CoroContext&) -> pw::async2::Coro<pw::Status> {
+    while (total < kSize) {
+      auto result =
+          co_await uart_.ReadWithTimeout(pw::ByteSpan(received).subspan(total),
+                                         1,
+                                         1000);
+      PW_CO_TRY(result.status());
+      total += result.size();
+    }
+    co_return pw::OkStatus();
+  };
+
+  pw::async2::CoroContext coro_cx(test_allocator);
+  pw::Status write_status;
+  pw::Status read_status;
+  pw::async2::CoroOrElseTask write_task(
+      write(coro_cx), [&](pw::Status status) { write_status = status; });
+  pw::async2::CoroOrElseTask read_task(
+      read(coro_cx), [&](pw::Status status) { read_status = status; });
+
+  const auto start = SystemClock::now();
+  dispatcher_.Post(write_task);
+  dispatcher_.Post(read_task);
+  dispatcher_.RunToCompletion();
+  PW_LOG_INFO("Loopback: %u bytes in %u us",
+              static_cast<unsigned>(total),
+              static_cast<unsigned>(ElapsedUs(start, SystemClock::now())));
+
+  EXPECT_EQ(write_status, pw::OkStatus());
+  EXPECT_EQ(read_status, pw::OkStatus());
+  EXPECT_EQ(total, kSize);
+  EXPECT_TRUE(received == sent);
+  EXPECT_EQ(pb::uart::sim::GetStats(kSerial).rx_overruns, 0u);
+}
+
+TEST_F(AsyncUartSimTest, FullRxRingDropsBytes) {
+  constexpr size_t kSize = 300;
+  ASSERT_EQ(uart_.Init(kBaudRate), pw::OkStatus());
+
+  std::array<std::byte, kSize> data{};
+  pb::uart::sim::PeerWrite(kSerial, data);
+  pw::this_thread::sleep_until(pb::uart::sim::PeerIdleAt(kSerial));
+
+  // One slot of the ring stays unused
+  const pb::uart::sim::UsartSimStats stats = pb::uart::sim::GetStats(kSerial);
+  EXPECT_EQ(stats.bytes_received, rx_buf_.size() - 1);
+  EXPECT_EQ(stats.rx_overruns, kSize - (rx_buf_.size() - 1));
+}
+
+TEST_F(AsyncUartSimTest, DoubleBufferedRxFillsWhileBlockIsProcessed) {
+  constexpr size_t kHalf = 256;  // Twice the ring buffer
+  ASSERT_EQ(uart_.Init(kBaudRate), pw::OkStatus());
+
+  std::array<std::byte, 2 * kHalf> sent;
+  for (size_t i = 0; i < sent.size(); ++i) {
+    sent[i] = static_cast<std::byte>(i * 7);
+  }
+  alignas(32) std::array<std::byte, kHalf> half_a{};
+  alignas(32) std::array<std::byte, kHalf> half_b{};
+  pb::DoubleBufferedRx rx(uart_, half_a, half_b);
+  pb::uart::sim::PeerWrite(kSerial, sent);
+  const auto idle_at = pb::uart::sim::PeerIdleAt(kSerial);
+
+  auto read_blocks =
+      [&](pw::async2::CoroContext&) -> pw::async2::Coro<pw::Status> {
+    auto first = co_await rx.FillNext(1000);
+    PW_CO_TRY(first.status());
+    if (rx.current().data() != half_a.data() || first.size() != kHalf) {
+      co_return pw::Status::DataLoss();
+    }
+    // Processing the first block outlasts the rest of the stream; the ring
+    // buffer alone could not hold it
+    pw::this_thread::sleep_until(idle_at + std::chrono::milliseconds(5));
+
+    auto second = co_await rx.FillNext(1000);
+    PW_CO_TRY(second.status());
+    if (rx.current().data() != half_b.data() || second.size() != kHalf) {
+      co_return pw::Status::DataLoss();
+    }
+    co_return pw::OkStatus();
+  };
+  pw::async2::CoroContext coro_cx(test_allocator);
+  EXPECT_EQ(Run(read_blocks(coro_cx)), pw::OkStatus());
+
+  EXPECT_TRUE(std::equal(half_a.begin(), half_a.end(), sent.begin()));
+  EXPECT_TRUE(std::equal(half_b.begin(), half_b.end(), sent.begin() + kHalf));
+  EXPECT_EQ(rx.blocks_started(), 2u);
+  EXPECT_EQ(pb::uart::sim::GetStats(kSerial).rx_overruns, 0u);
+}
+
+TEST_F(AsyncUartSimTest, DirectionPinReleasedAfterLastByte) {
+  constexpr size_t kSize = 32;
+  ASSERT_EQ(uart_.Init(kBaudRate), pw::OkStatus());
+  DirectionPin direction;
+  ASSERT_EQ(direction.Enable(), pw::OkStatus());
+  ASSERT_EQ(uart_.EnableDirectionControl(direction), pw::OkStatus());
+
+  std::array<std::byte, kSize> request{};
+  const auto start = SystemClock::now();
+  ASSERT_EQ(uart_.Write(request), pw::OkStatus());
+  EXPECT_TRUE(direction.active.load());
+  EXPECT_EQ(direction.transmitted_at_assert.load(), 0u);
+  EXPECT_EQ(uart_.EnableDirectionControl(direction),
+            pw::Status::FailedPrecondition());
+
+  // 8N1: ten bit times per byte
+  const auto wire_time = std::chrono::microseconds(
+      kSize * 10 * 1'000'000 / kBaudRate);
+  pw::this_thread::sleep_until(start + wire_time +
+                               std::chrono::milliseconds(20));
+  EXPECT_FALSE(direction.active.load());
+  EXPECT_EQ(direction.transmitted_at_release.load(), kSize);
+  const auto released_at = direction.released_at.load();
+  EXPECT_TRUE(released_at >= start + wire_time);
+  PW_LOG_INFO("RS-485 turnaround: released %u us after the last stop bit",
+              static_cast<unsigned>(
+                  ElapsedUs(start + wire_time, released_at)));
+  uart_.DisableDirectionControl();
+}
+
+TEST_F(AsyncUartSimTest, TransmittedWriteReleasesDirectionBeforeCompleting) {
+  constexpr size_t kSize = 300;  // Larger than the TX ring
+  ASSERT_EQ(uart_.Init(kBaudRate), pw::OkStatus());
+  DirectionPin direction;
+  ASSERT_EQ(direction.Enable(), pw::OkStatus());
+  ASSERT_EQ(uart_.EnableDirectionControl(direction), pw::OkStatus());
+
+  std::array<std::byte, kSize> request{};
+  bool released_on_completion = false;
+  auto transact =
+      [&](pw::async2::CoroContext&) -> pw::async2::Coro<pw::Status> {
+    PW_CO_TRY(co_await uart_.WriteAsync(request,
+                                        pb::WriteCompletion::kTransmitted));
+    released_on_completion = !direction.active.load();
+    co_return pw::OkStatus();
+  };
+  pw::async2::CoroContext coro_cx(test_allocator);
+  EXPECT_EQ(Run(transact(coro_cx)), pw::OkStatus());
+  EXPECT_TRUE(released_on_completion);
+  EXPECT_EQ(direction.transmitted_at_release.load(), kSize);
+
+  // Without direction control the pin is left alone
+  uart_.DisableDirectionControl();
+  ASSERT_EQ(uart_.Write(pw::ConstByteSpan(request).first(8)), pw::OkStatus());
+  EXPECT_FALSE(direction.active.load());
+}
+
+}  // namespace
@@ -14,6 +14,10 @@
 #include <cstring>
 
 #include "delay_hal.h"
+#include "pb_uart/async_uart_stream.h"
+#include "pb_uart/double_buffered_rx.h"
+#include "pb_uart/usart_io.h"
+#include "timer_hal.h"
 #include "usart_hal.h"
 #include "pw_allocator/testing.h"
 #include "pw_async2/basic_dispatcher.h"
@@ -39,8 +43,8 @@ constexpr auto kTestPattern =
 // Allocator for coroutine frames
 pw::allocator::test::AllocatorForTest<4096> test_allocator;
 
-// Single UART instance shared across all tests.
-// We cannot use per-test Init/Deinit because Deinit hangs (see async_uart.cc).
+// Single UART instance shared across all tests (ReinitAfterDeinit leaves it
+// initialized at kBaudRate).
 pb::AsyncUart& GetUart() {
   // UART buffers (128 bytes is plenty for loopback tests)
   // Must be 32-byte aligned for DMA on RTL872x
@@ -70,7 +74,9 @@ class AsyncUartLoopbackTest : public ::testing::Test {
 
   void TearDown() override {
     PW_LOG_INFO("=== Test TearDown ===");
-    // Note: We don't call Deinit - see GetUart() comment
+    // Note: We don't call Deinit - the instance is shared, see GetUart()
+    // A failed test may leave taps on its stack-local history ring
+    GetUart().DisableRxTaps();
   }
 
   pw::async2::BasicDispatcher dispatcher_;
@@ -504,4 +510,680 @@ TEST_F(AsyncUartLoopbackTest, ReadTimeout) {
   PW_LOG_INFO("Read timeout: PASSED (completed in ~%dms)", iterations);
 }
 
+// Test 6: Async write larger than the TX buffer
+//
+// WriteAsync() must stream a 200-byte payload through the 128-byte TX ring
+// buffer while a concurrent reader drains the 128-byte RX ring buffer.
+TEST_F(AsyncUartLoopbackTest, AsyncWriteLargerThanTxBuffer) {
+  auto& uart = GetUart();
+
+  PW_LOG_INFO("Testing: WriteAsync() with payload larger than TX buffer");
+
+  constexpr size_t kPayloadSize = 200;
+  std::array<std::byte, kPayloadSize> payload;
+  for (size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<std::byte>(i ^ 0x5A);
+  }
+  std::array<std::byte, kPayloadSize> received{};
+  bool reader_done = false;
+  bool writer_done = false;
+
+  auto reader_coro = [&](pw::async2::CoroContext&) -> pw::async2::Coro<pw::Status> {
+    auto result = co_await uart.Read(received, kPayloadSize);
+    if (!result.ok() || result.size() != kPayloadSize) {
+      PW_LOG_ERROR("[Reader] Read failed: status=%d size=%u",
+                   static_cast<int>(result.status().code()),
+                   static_cast<unsigned>(result.size()));
+      co_return pw::Status::DataLoss();
+    }
+    reader_done = true;
+    co_return pw::OkStatus();
+  };
+
+  auto writer_coro = [&](pw::async2::CoroContext&) -> pw::async2::Coro<pw::Status> {
+    auto status =
+        co_await uart.WriteAsync(payload, pb::WriteCompletion::kTransmitted);
+    if (!status.ok()) {
+      PW_LOG_ERROR("[Writer] WriteAsync failed: %d",
+                   static_cast<int>(status.code()));
+      co_return status;
+    }
+    writer_done = true;
+    co_return pw::OkStatus();
+  };
+
+  pw::async2::CoroContext reader_cx(test_allocator);
+  pw::async2::CoroContext writer_cx(test_allocator);
+
+  pw::async2::CoroOrElseTask reader_task(
+      reader_coro(reader_cx), [](pw::Status status) {
+        if (!status.ok()) {
+          PW_LOG_ERROR("[Reader] Failed: %d", static_cast<int>(status.code()));
+        }
+      });
+  pw::async2::CoroOrElseTask writer_task(
+      writer_coro(writer_cx), [](pw::Status status) {
+        if (!status.ok()) {
+          PW_LOG_ERROR("[Writer] Failed: %d", static_cast<int>(status.code()));
+        }
+      });
+
+  dispatcher_.Post(reader_task);
+  dispatcher_.Post(writer_task);
+
+  int iterations = 0;
+  constexpr int kMaxIterations = 1000;  // 200 bytes take ~17ms on the wire
+
+  while ((reader_task.IsRegistered() || writer_task.IsRegistered()) &&
+         iterations++ < kMaxIterations) {
+    dispatcher_.RunUntilStalled();
+    HAL_Delay_Milliseconds(1);
+  }
+
+  ASSERT_LT(iterations, kMaxIterations) << "Test timed out";
+  ASSERT_TRUE(writer_done) << "Writer did not complete";
+  ASSERT_TRUE(reader_done) << "Reader did not complete";
+  ASSERT_EQ(std::memcmp(received.data(), payload.data(), kPayloadSize), 0)
+      << "Received data does not match sent data";
+
+  PW_LOG_INFO("Async write larger than TX buffer: PASSED");
+}
+
+// Test 7: Delimiter and length-prefixed frame reads
+//
+// Sends a newline-terminated line followed by two length-prefixed frames in
+// a single write. Each read must consume exactly one frame and leave the rest
+// buffered for the next read.
+TEST_F(AsyncUartLoopbackTest, ReadUntilAndReadFrame) {
+  auto& uart = GetUart();
+
+  PW_LOG_INFO("Testing: ReadUntil() and ReadFrame()");
+
+  // "OK\n", then frames [len=2, 0xA1, 0xA2] and [len=1, 0xB1]
+  constexpr auto kStream = pw::bytes::Array<'O', 'K', '\n', 0x02, 0xA1, 0xA2,
+                                            0x01, 0xB1>();
+
+  // One length byte followed by that many payload bytes
+  constexpr pb::FrameLengthParser kLengthPrefixed =
+      [](pw::ConstByteSpan received) -> size_t {
+    if (received.empty()) {
+      return 1;
+    }
+    return 1 + static_cast<size_t>(received[0]);
+  };
+
+  bool test_passed = false;
+
+  auto test_coro = [&](pw::async2::CoroContext&) -> pw::async2::Coro<pw::Status> {
+    if (!uart.Write(kStream).ok()) {
+      co_return pw::Status::Internal();
+    }
+
+    std::array<std::byte, 16> line{};
+    auto line_result = co_await uart.ReadUntil(line, std::byte{'\n'}, 500);
+    if (!line_result.ok() || line_result.size() != 3 ||
+        std::memcmp(line.data(), kStream.data(), 3) != 0) {
+      PW_LOG_ERROR("ReadUntil: status=%d size=%u",
+                   static_cast<int>(line_result.status().code()),
+                   static_cast<unsigned>(line_result.size()));
+      co_return pw::Status::DataLoss();
+    }
+
+    std::array<std::byte, 16> frame{};
+    auto first = co_await uart.ReadFrame(frame, kLengthPrefixed, 500);
+    if (!first.ok() || first.size() != 3 ||
+        std::memcmp(frame.data(), kStream.data() + 3, 3) != 0) {
+      PW_LOG_ERROR("ReadFrame 1: status=%d size=%u",
+                   static_cast<int>(first.status().code()),
+                   static_cast<unsigned>(first.size()));
+      co_return pw::Status::DataLoss();
+    }
+
+    auto second = co_await uart.ReadFrame(frame, kLengthPrefixed, 500);
+    if (!second.ok() || second.size() != 2 ||
+        std::memcmp(frame.data(), kStream.data() + 6, 2) != 0) {
+      PW_LOG_ERROR("ReadFrame 2: status=%d size=%u",
+                   static_cast<int>(second.status().code()),
+                   static_cast<unsigned>(second.size()));
+      co_return pw::Status::DataLoss();
+    }
+
+    test_passed = true;
+    co_return pw::OkStatus();
+  };
+
+  pw::async2::CoroContext coro_cx(test_allocator);
+  auto coro = test_coro(coro_cx);
+
+  pw::async2::CoroOrElseTask task(
+      std::move(coro), [](pw::Status status) {
+        if (!status.ok()) {
+          PW_LOG_ERROR("Frame read test failed: %d",
+                       static_cast<int>(status.code()));
+        }
+      });
+
+  dispatcher_.Post(task);
+
+  int iterations = 0;
+  constexpr int kMaxIterations = 1000;
+
+  while (task.IsRegistered() && iterations++ < kMaxIterations) {
+    dispatcher_.RunUntilStalled();
+    HAL_Delay_Milliseconds(1);
+  }
+
+  ASSERT_LT(iterations, kMaxIterations) << "Test timed out";
+  ASSERT_TRUE(test_passed) << "Frame reads failed";
+
+  PW_LOG_INFO("ReadUntil and ReadFrame: PASSED");
+}
+
+// Test 8: Bulk vs. per-byte RX copy (microbenchmark)
+//
+// Fills the HAL RX ring buffer via loopback, then times emptying it with
+// pb::uart::ReadAvailable() against one hal_usart_read() call per byte.
+TEST_F(AsyncUartLoopbackTest, BulkReadBenchmark) {
+  auto& uart = GetUart();
+
+  PW_LOG_INFO("Benchmark: bulk vs. per-byte RX copy");
+
+  constexpr size_t kBenchBytes = 96;  // Fits the 128-byte RX/TX buffers
+  std::array<std::byte, kBenchBytes> pattern;
+  for (size_t i = 0; i < pattern.size(); ++i) {
+    pattern[i] = static_cast<std::byte>(i);
+  }
+  std::array<std::byte, kBenchBytes> rx_buffer{};
+
+  auto fill_rx_buffer = [&]() {
+    ASSERT_TRUE(uart.Write(pattern).ok());
+    // 96 bytes take ~8.3ms on the wire at 115200 baud
+    HAL_Delay_Milliseconds(20);
+    ASSERT_EQ(hal_usart_available(HAL_USART_SERIAL2),
+              static_cast<int32_t>(kBenchBytes));
+  };
+
+  // Bulk copy
+  fill_rx_buffer();
+  uint32_t start_us = HAL_Timer_Get_Micro_Seconds();
+  size_t bulk_count = pb::uart::ReadAvailable(HAL_USART_SERIAL2, rx_buffer);
+  uint32_t bulk_us = HAL_Timer_Get_Micro_Seconds() - start_us;
+
+  ASSERT_EQ(bulk_count, kBenchBytes);
+  ASSERT_EQ(std::memcmp(rx_buffer.data(), pattern.data(), kBenchBytes), 0)
+      << "Bulk read data mismatch";
+
+  // Per-byte copy (the previous TryRead()/DoRead() implementation)
+  rx_buffer = {};
+  fill_rx_buffer();
+  start_us = HAL_Timer_Get_Micro_Seconds();
+  for (size_t i = 0; i < kBenchBytes; ++i) {
+    rx_buffer[i] = static_cast<std::byte>(hal_usart_read(HAL_USART_SERIAL2));
+  }
+  uint32_t per_byte_us = HAL_Timer_Get_Micro_Seconds() - start_us;
+
+  ASSERT_EQ(std::memcmp(rx_buffer.data(), pattern.data(), kBenchBytes), 0)
+      << "Per-byte read data mismatch";
+
+  PW_LOG_INFO("  %u bytes: bulk=%luus per-byte=%luus",
+              static_cast<unsigned>(kBenchBytes),
+              static_cast<unsigned long>(bulk_us),
+              static_cast<unsigned long>(per_byte_us));
+  PW_LOG_INFO("Bulk read benchmark: PASSED");
+}
+
+// Test 9: Partial data on timeout
+//
+// Sends the first half of a length-prefixed frame. The timed ReadFrame() must
+// report DeadlineExceeded with the bytes received so far, and a second
+// ReadFrame() resumes the frame once the rest arrives.
+TEST_F(AsyncUartLoopbackTest, PartialFrameOnTimeout) {
+  auto& uart = GetUart();
+
+  PW_LOG_INFO("Testing: partial data on ReadFrame() timeout");
+
+  // Frame [len=3, 0xC1, 0xC2, 0xC3], sent in two parts
+  constexpr auto kFrame = pw::bytes::Array<0x03, 0xC1, 0xC2, 0xC3>();
+  constexpr size_t kFirstPart = 2;
+
+  constexpr pb::FrameLengthParser kLengthPrefixed =
+      [](pw::ConstByteSpan received) -> size_t {
+    if (received.empty()) {
+      return 1;
+    }
+    return 1 + static_cast<size_t>(received[0]);
+  };
+
+  bool test_passed = false;
+
+  auto test_coro = [&](pw::async2::CoroContext&) -> pw::async2::Coro<pw::Status> {
+    if (!uart.Write(pw::ConstByteSpan(kFrame).first(kFirstPart)).ok()) {
+      co_return pw::Status::Internal();
+    }
+
+    std::array<std::byte, 16> frame{};
+    auto partial = co_await uart.ReadFrame(frame, kLengthPrefixed, 50);
+    if (!partial.status().IsDeadlineExceeded() ||
+        partial.size() != kFirstPart) {
+      PW_LOG_ERROR("Partial read: status=%d size=%u",
+                   static_cast<int>(partial.status().code()),
+                   static_cast<unsigned>(partial.size()));
+      co_return pw::Status::DataLoss();
+    }
+
+    if (!uart.Write(pw::ConstByteSpan(kFrame).subspan(kFirstPart)).ok()) {
+      co_return pw::Status::Internal();
+    }
+
+    auto full =
+        co_await uart.ReadFrame(frame, kLengthPrefixed, 500, partial.size());
+    if (!full.ok() || full.size() != kFrame.size() ||
+        std::memcmp(frame.data(), kFrame.data(), kFrame.size()) != 0) {
+      PW_LOG_ERROR("Resumed read: status=%d size=%u",
+                   static_cast<int>(full.status().code()),
+                   static_cast<unsigned>(full.size()));
+      co_return pw::Status::DataLoss();
+    }
+
+    test_passed = true;
+    co_return pw::OkStatus();
+  };
+
+  pw::async2::CoroContext coro_cx(test_allocator);
+  auto coro = test_coro(coro_cx);
+
+  pw::async2::CoroOrElseTask task(
+      std::move(coro), [](pw::Status status) {
+        if (!status.ok()) {
+          PW_LOG_ERROR("Partial frame test failed: %d",
+                       static_cast<int>(status.code()));
+        }
+      });
+
+  dispatcher_.Post(task);
+
+  int iterations = 0;
+  constexpr int kMaxIterations = 1000;
+
+  while (task.IsRegistered() && iterations++ < kMaxIterations) {
+    dispatcher_.RunUntilStalled();
+    HAL_Delay_Milliseconds(1);
+  }
+
+  ASSERT_LT(iterations, kMaxIterations) << "Test timed out";
+  ASSERT_TRUE(test_passed) << "Partial frame read failed";
+
+  PW_LOG_INFO("Partial frame on timeout: PASSED");
+}
+
+// Test 10: Double-buffered block reads
+//
+// Sends four blocks of pattern data (96 bytes, fits the 128-byte buffers) and
+// checks that DoubleBufferedRx alternates between its halves and fills each
+// one completely.
+TEST_F(AsyncUartLoopbackTest, DoubleBufferedBlocks) {
+  auto& uart = GetUart();
+
+  PW_LOG_INFO("Testing: DoubleBufferedRx block reads");
+
+  constexpr size_t kHalfSize = 24;
+  constexpr size_t kBlocks = 4;
+  alignas(32) std::array<std::byte, kHalfSize> half_a{};
+  alignas(32) std::array<std::byte, kHalfSize> half_b{};
+  pb::DoubleBufferedRx rx(uart, half_a, half_b);
+
+  std::array<std::byte, kHalfSize * kBlocks> payload;
+  for (size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<std::byte>(i * 7);
+  }
+
+  bool test_passed = false;
+
+  auto test_coro = [&](pw::async2::CoroContext&) -> pw::async2::Coro<pw::Status> {
+    if (!uart.Write(payload).ok()) {
+      co_return pw::Status::Internal();
+    }
+    for (size_t block = 0; block < kBlocks; ++block) {
+      auto result = co_await rx.FillNext(500);
+      pw::ByteSpan expected_half = block % 2 == 0 ? pw::ByteSpan(half_a)
+                                                  : pw::ByteSpan(half_b);
+      if (!result.ok() || result.size() != kHalfSize ||
+          rx.current().data() != expected_half.data() ||
+          std::memcmp(rx.current().data(),
+                      payload.data() + block * kHalfSize,
+                      kHalfSize) != 0) {
+        PW_LOG_ERROR("Block %u: status=%d size=%u",
+                     static_cast<unsigned>(block),
+                     static_cast<int>(result.status().code()),
+                     static_cast<unsigned>(result.size()));
+        co_return pw::Status::DataLoss();
+      }
+    }
+    test_passed = true;
+    co_return pw::OkStatus();
+  };
+
+  pw::async2::CoroContext coro_cx(test_allocator);
+  auto coro = test_coro(coro_cx);
+
+  pw::async2::CoroOrElseTask task(
+      std::move(coro), [](pw::Status status) {
+        if (!status.ok()) {
+          PW_LOG_ERROR("Double-buffered test failed: %d",
+                       static_cast<int>(status.code()));
+        }
+      });
+
+  dispatcher_.Post(task);
+
+  int iterations = 0;
+  constexpr int kMaxIterations = 1000;
+
+  while (task.IsRegistered() && iterations++ < kMaxIterations) {
+    dispatcher_.RunUntilStalled();
+    HAL_Delay_Milliseconds(1);
+  }
+
+  ASSERT_LT(iterations, kMaxIterations) << "Test timed out";
+  ASSERT_TRUE(test_passed) << "Double-buffered reads failed";
+  ASSERT_EQ(rx.blocks_started(), kBlocks);
+
+  PW_LOG_INFO("Double-buffered blocks: PASSED");
+}
+
+// Test 11: Runtime statistics
+//
+// One completed read and one timed-out read must show up in the counters.
+TEST_F(AsyncUartLoopbackTest, Stats) {
+  auto& uart = GetUart();
+
+  PW_LOG_INFO("Testing: AsyncUart stats");
+
+  uart.ResetStats();
+  constexpr auto kData = pw::bytes::Array<0x51, 0x52, 0x53, 0x54>();
+
+  auto test_coro = [&](pw::async2::CoroContext&) -> pw::async2::Coro<pw::Status> {
+    if (!uart.Write(kData).ok()) {
+      co_return pw::Status::Internal();
+    }
+    std::array<std::byte, 8> buffer{};
+    auto result = co_await uart.Read(buffer, kData.size());
+    if (!result.ok()) {
+      co_return result.status();
+    }
+    auto timed_out = co_await uart.ReadWithTimeout(buffer, 1, 20);
+    if (!timed_out.status().IsDeadlineExceeded()) {
+      co_return pw::Status::Internal();
+    }
+    co_return pw::OkStatus();
+  };
+
+  pw::async2::CoroContext coro_cx(test_allocator);
+  auto coro = test_coro(coro_cx);
+
+  pw::async2::CoroOrElseTask task(
+      std::move(coro), [](pw::Status status) {
+        if (!status.ok()) {
+          PW_LOG_ERROR("Stats test failed: %d",
+                       static_cast<int>(status.code()));
+        }
+      });
+
+  dispatcher_.Post(task);
+
+  int iterations = 0;
+  constexpr int kMaxIterations = 500;
+
+  while (task.IsRegistered() && iterations++ < kMaxIterations) {
+    dispatcher_.RunUntilStalled();
+    HAL_Delay_Milliseconds(1);
+  }
+  ASSERT_LT(iterations, kMaxIterations) << "Test timed out";
+
+  const pb::AsyncUartStats stats = uart.stats();
+  PW_LOG_INFO("  in=%u out=%u reads=%u timeouts=%u peak=%u latency=%uus",
+              static_cast<unsigned>(stats.bytes_received),
+              static_cast<unsigned>(stats.bytes_sent),
+              static_cast<unsigned>(stats.reads_completed),
+              static_cast<unsigned>(stats.read_timeouts),
+              static_cast<unsigned>(stats.rx_peak_buffered),
+              static_cast<unsigned>(stats.wake_latency_max_us));
+  EXPECT_EQ(stats.bytes_sent, kData.size());
+  EXPECT_EQ(stats.bytes_received, kData.size());
+  EXPECT_EQ(stats.reads_completed, 2u);
+  EXPECT_EQ(stats.read_timeouts, 1u);
+  EXPECT_EQ(stats.rx_buffer_full, 0u);
+
+  PW_LOG_INFO("Stats: PASSED");
+}
+
+// Test 12: RX tap
+//
+// A tap must observe the bytes consumed by the primary reader without
+// affecting what that reader receives.
+TEST_F(AsyncUartLoopbackTest, RxTapObservesReads) {
+  auto& uart = GetUart();
+
+  PW_LOG_INFO("Testing: RxTap");
+
+  std::array<std::byte, 32> history{};
+  ASSERT_EQ(uart.EnableRxTaps(history), pw::OkStatus());
+  pb::RxTap tap;
+  ASSERT_EQ(uart.AddRxTap(tap), pw::OkStatus());
+  ASSERT_EQ(uart.AddRxTap(tap), pw::Status::FailedPrecondition());
+
+  constexpr auto kData = pw::bytes::Array<0x61, 0x62, 0x63, 0x64, 0x65>();
+  bool test_passed = false;
+
+  auto test_coro = [&](pw::async2::CoroContext&) -> pw::async2::Coro<pw::Status> {
+    if (!uart.Write(kData).ok()) {
+      co_return pw::Status::Internal();
+    }
+    std::array<std::byte, 8> buffer{};
+    auto result = co_await uart.Read(buffer, kData.size());
+    if (!result.ok() || result.size() != kData.size()) {
+      co_return pw::Status::DataLoss();
+    }
+    test_passed = true;
+    co_return pw::OkStatus();
+  };
+
+  pw::async2::CoroContext coro_cx(test_allocator);
+  auto coro = test_coro(coro_cx);
+
+  pw::async2::CoroOrElseTask task(
+      std::move(coro), [](pw::Status status) {
+        if (!status.ok()) {
+          PW_LOG_ERROR("RxTap test failed: %d",
+                       static_cast<int>(status.code()));
+        }
+      });
+
+  dispatcher_.Post(task);
+
+  int iterations = 0;
+  constexpr int kMaxIterations = 500;
+
+  while (task.IsRegistered() && iterations++ < kMaxIterations) {
+    dispatcher_.RunUntilStalled();
+    HAL_Delay_Milliseconds(1);
+  }
+  ASSERT_LT(iterations, kMaxIterations) << "Test timed out";
+  ASSERT_TRUE(test_passed) << "Primary read failed";
+
+  std::array<std::byte, 16> observed{};
+  ASSERT_EQ(tap.Read(observed), kData.size());
+  EXPECT_EQ(std::memcmp(observed.data(), kData.data(), kData.size()), 0);
+  EXPECT_EQ(tap.Read(observed), 0u);
+  EXPECT_EQ(tap.dropped(), 0u);
+
+  // `history` lives on this stack frame
+  uart.DisableRxTaps();
+  EXPECT_EQ(uart.AddRxTap(tap), pw::Status::FailedPrecondition());
+
+  PW_LOG_INFO("RxTap: PASSED");
+}
+
+// Test 13: Deinit and re-init at another baud rate
+//
+// With this the only port, Deinit() also stops and detaches the background
+// task; Init() has to start it again.
+TEST_F(AsyncUartLoopbackTest, ReinitAfterDeinit) {
+  auto& uart = GetUart();
+
+  PW_LOG_INFO("Testing: Deinit() and Init() at 57600 baud");
+
+  uart.Deinit();
+  ASSERT_EQ(uart.Init(57600), pw::OkStatus());
+  ASSERT_EQ(uart.Init(57600), pw::Status::FailedPrecondition());
+
+  bool test_passed = false;
+
+  auto test_coro = [&](pw::async2::CoroContext&) -> pw::async2::Coro<pw::Status> {
+    if (!uart.Write(kTestPattern).ok()) {
+      co_return pw::Status::Internal();
+    }
+    std::array<std::byte, 16> buffer{};
+    auto result =
+        co_await uart.ReadWithTimeout(buffer, kTestPattern.size(), 500);
+    if (!result.ok() ||
+        std::memcmp(buffer.data(), kTestPattern.data(), kTestPattern.size()) !=
+            0) {
+      co_return pw::Status::DataLoss();
+    }
+    test_passed = true;
+    co_return pw::OkStatus();
+  };
+
+  pw::async2::CoroContext coro_cx(test_allocator);
+  auto coro = test_coro(coro_cx);
+
+  pw::async2::CoroOrElseTask task(
+      std::move(coro), [](pw::Status status) {
+        if (!status.ok()) {
+          PW_LOG_ERROR("Re-init test failed: %d",
+                       static_cast<int>(status.code()));
+        }
+      });
+
+  dispatcher_.Post(task);
+
+  int iterations = 0;
+  constexpr int kMaxIterations = 1000;
+
+  while (task.IsRegistered() && iterations++ < kMaxIterations) {
+    dispatcher_.RunUntilStalled();
+    HAL_Delay_Milliseconds(1);
+  }
+
+  // Restore the shared instance for the remaining tests
+  uart.Deinit();
+  ASSERT_EQ(uart.Init(kBaudRate), pw::OkStatus());
+
+  ASSERT_LT(iterations, kMaxIterations) << "Test timed out";
+  ASSERT_TRUE(test_passed) << "Loopback after re-init failed";
+
+  PW_LOG_INFO("Re-init after Deinit: PASSED");
+}
+
+// Test 14: Baud rate switch in place
+//
+// Reconfigure() to 460800 baud, loop back a pattern, and switch back.
+TEST_F(AsyncUartLoopbackTest, ReconfigureBaudRate) {
+  auto& uart = GetUart();
+
+  PW_LOG_INFO("Testing: Reconfigure() to 460800 baud");
+
+  ASSERT_EQ(uart.Reconfigure(460800), pw::OkStatus());
+
+  bool test_passed = false;
+
+  auto test_coro = [&](pw::async2::CoroContext&) -> pw::async2::Coro<pw::Status> {
+    if (!uart.Write(kTestPattern).ok()) {
+      co_return pw::Status::Internal();
+    }
+    std::array<std::byte, 16> buffer{};
+    auto result =
+        co_await uart.ReadWithTimeout(buffer, kTestPattern.size(), 500);
+    if (!result.ok() ||
+        std::memcmp(buffer.data(), kTestPattern.data(), kTestPattern.size()) !=
+            0) {
+      co_return pw::Status::DataLoss();
+    }
+    test_passed = true;
+    co_return pw::OkStatus();
+  };
+
+  pw::async2::CoroContext coro_cx(test_allocator);
+  auto coro = test_coro(coro_cx);
+
+  pw::async2::CoroOrElseTask task(
+      std::move(coro), [](pw::Status status) {
+        if (!status.ok()) {
+          PW_LOG_ERROR("Reconfigure test failed: %d",
+                       static_cast<int>(status.code()));
+        }
+      });
+
+  dispatcher_.Post(task);
+
+  int iterations = 0;
+  constexpr int kMaxIterations = 1000;
+
+  while (task.IsRegistered() && iterations++ < kMaxIterations) {
+    dispatcher_.RunUntilStalled();
+    HAL_Delay_Milliseconds(1);
+  }
+
+  ASSERT_EQ(uart.Reconfigure(kBaudRate), pw::OkStatus());
+
+  ASSERT_LT(iterations, kMaxIterations) << "Test timed out";
+  ASSERT_TRUE(test_passed) << "Loopback at 460800 baud failed";
+
+  PW_LOG_INFO("Reconfigure baud rate: PASSED");
+}
+
+// Test 15: pw::stream face of AsyncUart
+//
+// Writes and reads through AsyncUartStream, and checks that a stream read is
+// rejected while a ReadFuture is pending.
+TEST_F(AsyncUartLoopbackTest, StreamInterface) {
+  auto& uart = GetUart();
+  pb::AsyncUartStream stream(uart);
+
+  PW_LOG_INFO("Testing: AsyncUartStream");
+
+  ASSERT_EQ(stream.Write(kTestPattern), pw::OkStatus());
+
+  // kAlways flushed the TX side; give the last byte time to arrive
+  HAL_Delay_Milliseconds(2);
+  std::array<std::byte, 16> buffer{};
+  auto result = stream.Read(buffer);
+  ASSERT_TRUE(result.ok());
+  ASSERT_EQ(result.value().size(), kTestPattern.size());
+  EXPECT_EQ(
+      std::memcmp(buffer.data(), kTestPattern.data(), kTestPattern.size()), 0);
+
+  // Park a read future, then try the stream
+  pw::Status stream_status;
+  auto test_coro = [&](pw::async2::CoroContext&) -> pw::async2::Coro<pw::Status> {
+    co_return (co_await uart.ReadWithTimeout(buffer, 1, 20)).status();
+  };
+  pw::async2::CoroContext coro_cx(test_allocator);
+  auto coro = test_coro(coro_cx);
+  pw::async2::CoroOrElseTask task(std::move(coro), [](pw::Status) {});
+  dispatcher_.Post(task);
+  dispatcher_.RunUntilStalled();
+  stream_status = stream.Read(buffer).status();
+
+  int iterations = 0;
+  while (task.IsRegistered() && iterations++ < 500) {
+    dispatcher_.RunUntilStalled();
+    HAL_Delay_Milliseconds(1);
+  }
+  EXPECT_EQ(stream_status, pw::Status::FailedPrecondition());
+
+  PW_LOG_INFO("AsyncUartStream: PASSED");
+}
+
 }  // namespace
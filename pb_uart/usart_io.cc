@@ -0,0 +1,136 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_uart/usart_io.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "pb_uart/config.h"
+#include "pw_log/log.h"
+
+namespace pb::uart {
+
+size_t ReadAvailable(hal_usart_interface_t serial, pw::ByteSpan dest) {
+  int32_t available = hal_usart_available(serial);
+  if (available <= 0 || dest.empty()) {
+    return 0;
+  }
+  size_t to_read = std::min(dest.size(), static_cast<size_t>(available));
+
+#if PB_UART_CONFIG_BULK_IO
+  ssize_t result =
+      hal_usart_read_buffer(serial, dest.data(), to_read, sizeof(uint8_t));
+  if (result < 0) {
+    // Unexpected - HAL said bytes were available
+    PW_LOG_WARN("ReadAvailable: hal_usart_read_buffer returned %d",
+                static_cast<int>(result));
+    return 0;
+  }
+  return static_cast<size_t>(result);
+#else
+  for (size_t i = 0; i < to_read; ++i) {
+    int32_t byte = hal_usart_read(serial);
+    if (byte < 0) {
+      // Unexpected - HAL said bytes were available
+      PW_LOG_WARN("ReadAvailable: hal_usart_read returned %d at index %u",
+                  static_cast<int>(byte), static_cast<unsigned>(i));
+      return i;
+    }
+    dest[i] = static_cast<std::byte>(byte);
+  }
+  return to_read;
+#endif  // PB_UART_CONFIG_BULK_IO
+}
+
+size_t ReadUntilDelimiter(hal_usart_interface_t serial,
+                          pw::ByteSpan dest,
+                          std::byte delimiter,
+                          bool& found) {
+  found = false;
+  int32_t available = hal_usart_available(serial);
+  if (available <= 0 || dest.empty()) {
+    return 0;
+  }
+  size_t to_read = std::min(dest.size(), static_cast<size_t>(available));
+
+#if PB_UART_CONFIG_BULK_IO
+  ssize_t peeked =
+      hal_usart_peek_buffer(serial, dest.data(), to_read, sizeof(uint8_t));
+  if (peeked <= 0) {
+    return 0;
+  }
+  auto window = dest.first(static_cast<size_t>(peeked));
+  auto it = std::find(window.begin(), window.end(), delimiter);
+  if (it != window.end()) {
+    found = true;
+    to_read = static_cast<size_t>(it - window.begin()) + 1;
+  } else {
+    to_read = window.size();
+  }
+  // Consume exactly what was accepted (re-copies the peeked bytes in place)
+  return ReadAvailable(serial, dest.first(to_read));
+#else
+  for (size_t i = 0; i < to_read; ++i) {
+    int32_t byte = hal_usart_read(serial);
+    if (byte < 0) {
+      return i;
+    }
+    dest[i] = static_cast<std::byte>(byte);
+    if (dest[i] == delimiter) {
+      found = true;
+      return i + 1;
+    }
+  }
+  return to_read;
+#endif  // PB_UART_CONFIG_BULK_IO
+}
+
+size_t WriteAvailable(hal_usart_interface_t serial, pw::ConstByteSpan data) {
+  int32_t space = hal_usart_available_data_for_write(serial);
+  if (space <= 0 || data.empty()) {
+    return 0;
+  }
+  size_t to_write = std::min(data.size(), static_cast<size_t>(space));
+
+#if PB_UART_CONFIG_BULK_IO
+  ssize_t result =
+      hal_usart_write_buffer(serial, data.data(), to_write, sizeof(uint8_t));
+  if (result < 0) {
+    PW_LOG_WARN("WriteAvailable: hal_usart_write_buffer returned %d",
+                static_cast<int>(result));
+    return 0;
+  }
+  return static_cast<size_t>(result);
+#else
+  for (size_t i = 0; i < to_write; ++i) {
+    hal_usart_write(serial, static_cast<uint8_t>(data[i]));
+  }
+  return to_write;
+#endif  // PB_UART_CONFIG_BULK_IO
+}
+
+void WriteAll(hal_usart_interface_t serial, pw::ConstByteSpan data) {
+  while (!data.empty()) {
+    size_t count = WriteAvailable(serial, data);
+    if (count == 0) {
+      // TX buffer full - let the HAL block until a slot frees up
+      hal_usart_write(serial, static_cast<uint8_t>(data.front()));
+      count = 1;
+    }
+    data = data.subspan(count);
+  }
+}
+
+size_t DiscardAvailable(hal_usart_interface_t serial) {
+  std::array<std::byte, 32> scratch;
+  size_t total = 0;
+  size_t count;
+  while ((count = ReadAvailable(serial, scratch)) > 0) {
+    total += count;
+  }
+  return total;
+}
+
+}  // namespace pb::uart
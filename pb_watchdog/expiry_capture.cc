@@ -0,0 +1,99 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_watchdog/expiry_capture.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "concurrent_hal.h"
+#include "logging.h"
+#include "pb_log/retained_crash_log.h"
+#include "timer_hal.h"
+
+namespace pb::watchdog {
+namespace {
+
+constexpr uint32_t kMagic = 0x57445431;  // "WDT1"
+
+// No constructor, so the content survives the reset (see pb_log/crash_log.h)
+struct RetainedCapture {
+  uint32_t magic;
+  ExpiryCapture capture;
+  uint32_t check;
+};
+
+// Same section as Device OS's `retained` keyword; not zeroed at startup
+__attribute__((section(".retained_user"))) RetainedCapture g_retained;
+
+const Supervisor* g_supervisor = nullptr;
+
+uint32_t Check(const ExpiryCapture& capture) {
+  uint32_t check = kMagic;
+  const auto* bytes = reinterpret_cast<const uint8_t*>(&capture);
+  for (size_t i = 0; i < sizeof(capture); ++i) {
+    check = (check << 5) + check + bytes[i];
+  }
+  return check;
+}
+
+uint32_t ProcessStackPointer() {
+  uint32_t psp;
+  __asm volatile("mrs %0, psp" : "=r"(psp));
+  return psp;
+}
+
+// Interrupt context: the watchdog reset follows shortly
+void OnExpired(void*) {
+  ExpiryCapture capture{};
+  capture.uptime_ms = HAL_Timer_Get_Milli_Seconds();
+  capture.thread = reinterpret_cast<uintptr_t>(os_thread_current(nullptr));
+
+  // Threads run on the process stack; the interrupt entry pushed
+  // r0-r3, r12, lr, pc, xpsr there
+  const uint32_t psp = ProcessStackPointer();
+  if (psp != 0) {
+    // NOLINTNEXTLINE(performance-no-int-to-ptr)
+    const auto* frame = reinterpret_cast<const uint32_t*>(psp);
+    capture.lr = frame[5];
+    capture.pc = frame[6];
+    capture.sp = psp;
+  }
+
+  if (g_supervisor != nullptr && g_supervisor->overdue_task() != nullptr) {
+    std::strncpy(capture.overdue_task, g_supervisor->overdue_task()->name(),
+                 sizeof(capture.overdue_task) - 1);
+  }
+
+  g_retained.capture = capture;
+  g_retained.check = Check(capture);
+  g_retained.magic = kMagic;
+
+  char line[96];
+  std::snprintf(line, sizeof(line),
+                "expired thread=%08x pc=%08lx lr=%08lx overdue=%s",
+                static_cast<unsigned>(capture.thread),
+                static_cast<unsigned long>(capture.pc),
+                static_cast<unsigned long>(capture.lr),
+                capture.overdue_task);
+  pb::log::RecordCrashLog(LOG_LEVEL_PANIC, "wdt", line);
+}
+
+}  // namespace
+
+pw::Status EnableExpiryCapture(Watchdog& watchdog,
+                               const Supervisor* supervisor) {
+  g_supervisor = supervisor;
+  return watchdog.SetExpiredCallback(OnExpired, nullptr);
+}
+
+std::optional<ExpiryCapture> TakeExpiryCapture() {
+  if (g_retained.magic != kMagic ||
+      g_retained.check != Check(g_retained.capture)) {
+    return std::nullopt;
+  }
+  g_retained.magic = 0;
+  return g_retained.capture;
+}
+
+}  // namespace pb::watchdog
@@ -0,0 +1,45 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Record what was running when the watchdog expired, across the reset
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "pb_watchdog/supervisor.h"
+#include "pb_watchdog/watchdog.h"
+#include "pw_status/status.h"
+
+namespace pb::watchdog {
+
+// State captured in the watchdog's expired interrupt, kept in retained RAM.
+// No member initializers, so the retained copy is not zeroed at startup.
+struct ExpiryCapture {
+  static constexpr size_t kMaxTaskName = 16;
+
+  uint32_t uptime_ms;
+  // Thread that was running (os_thread_t), 0 if unknown
+  uintptr_t thread;
+  // Where that thread was, from its exception frame on the process stack
+  uint32_t pc;
+  uint32_t lr;
+  uint32_t sp;
+  // Supervisor::overdue_task() at the time, empty without a supervisor
+  char overdue_task[kMaxTaskName];
+};
+
+// Install the expired callback on `watchdog`; call before Enable(). When
+// the watchdog expires, the callback stores an ExpiryCapture in retained
+// RAM and appends it to the retained crash log (pb_log), next to the last
+// log lines. Pass the supervisor, if any, to record the overdue task.
+pw::Status EnableExpiryCapture(Watchdog& watchdog,
+                               const Supervisor* supervisor = nullptr);
+
+// The capture from before the last reset, if the watchdog caused it.
+// Returns it once; later calls return nullopt until the next expiry.
+std::optional<ExpiryCapture> TakeExpiryCapture();
+
+}  // namespace pb::watchdog
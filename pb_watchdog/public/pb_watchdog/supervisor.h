@@ -0,0 +1,103 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Liveness supervision of several threads through one hardware watchdog
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "pb_watchdog/watchdog.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+
+// Maximum number of tasks one Supervisor tracks.
+#ifndef PB_WATCHDOG_MAX_SUPERVISED_TASKS
+#define PB_WATCHDOG_MAX_SUPERVISED_TASKS 8
+#endif
+
+namespace pb::watchdog {
+
+class Supervisor;
+
+// A supervised task. The owning thread calls CheckIn() at least once per
+// deadline; the call is a single relaxed atomic store.
+class SupervisedTask {
+ public:
+  SupervisedTask(const SupervisedTask&) = delete;
+  SupervisedTask& operator=(const SupervisedTask&) = delete;
+
+  void CheckIn();
+
+  const char* name() const { return name_; }
+
+ private:
+  friend class Supervisor;
+
+  SupervisedTask() = default;
+
+  const char* name_ = nullptr;
+  uint32_t deadline_ms_ = 0;
+  std::atomic<uint32_t> last_check_in_ms_{0};
+  std::atomic<bool> active_{false};
+};
+
+// Feeds the hardware watchdog only while every registered task checks in
+// within its deadline.
+//
+// Usage:
+//   Watchdog wdt;
+//   Supervisor supervisor(wdt);
+//
+//   // At startup
+//   SupervisedTask& uart = *supervisor.Register("uart", 500ms);
+//   wdt.Enable(std::chrono::seconds(2));
+//
+//   // In the UART thread's loop
+//   uart.CheckIn();
+//
+//   // Periodically, well within the watchdog timeout (e.g. every 250 ms)
+//   supervisor.Check();
+//
+// When a task misses its deadline, Check() stops feeding and the watchdog
+// resets the device one watchdog timeout later. Whatever calls Check() is
+// implicitly supervised too: if it stalls, nothing feeds.
+class Supervisor {
+ public:
+  static constexpr size_t kMaxTasks = PB_WATCHDOG_MAX_SUPERVISED_TASKS;
+
+  explicit Supervisor(Watchdog& watchdog) : watchdog_(watchdog) {}
+
+  Supervisor(const Supervisor&) = delete;
+  Supervisor& operator=(const Supervisor&) = delete;
+
+  // Register a task that must check in at least every `deadline`. The task
+  // counts as checked in at registration. `name` must outlive the task.
+  // ResourceExhausted if kMaxTasks are registered.
+  pw::Result<SupervisedTask*> Register(
+      const char* name, pw::chrono::SystemClock::duration deadline);
+
+  // Stop supervising a task, e.g. before its thread exits.
+  void Unregister(SupervisedTask& task);
+
+  // Feed the watchdog if every task is within its deadline.
+  //
+  // Returns OkStatus after feeding, DeadlineExceeded (and logs the task)
+  // if a task missed its deadline, or the Feed() error.
+  pw::Status Check();
+
+  // The first task found overdue by Check(), or nullptr. Useful from the
+  // watchdog's expired callback to record the culprit.
+  const SupervisedTask* overdue_task() const { return overdue_task_; }
+
+ private:
+  Watchdog& watchdog_;
+  std::array<SupervisedTask, kMaxTasks> tasks_;
+  const SupervisedTask* overdue_task_ = nullptr;
+};
+
+}  // namespace pb::watchdog
@@ -51,6 +51,7 @@ class Watchdog {
 
   // Set a callback to be called when watchdog is about to expire
   // Note: Callback runs in interrupt context, keep it short!
+  // Set it before Enable(), which then also enables the early interrupt
   pw::Status SetExpiredCallback(ExpiredCallback callback, void* context);
 
   // Check if watchdog is currently enabled
@@ -61,6 +62,7 @@ class Watchdog {
 
  private:
   bool enabled_ = false;
+  bool has_expired_callback_ = false;
   uint32_t timeout_ms_ = 0;
 };
 
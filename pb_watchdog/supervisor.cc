@@ -0,0 +1,70 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#define PW_LOG_MODULE_NAME "pb_wdt"
+
+#include "pb_watchdog/supervisor.h"
+
+#include <chrono>
+
+#include "hal_irq_flag.h"
+#include "pw_log/log.h"
+#include "timer_hal.h"
+
+namespace pb::watchdog {
+
+void SupervisedTask::CheckIn() {
+  last_check_in_ms_.store(HAL_Timer_Get_Milli_Seconds(),
+                          std::memory_order_relaxed);
+}
+
+pw::Result<SupervisedTask*> Supervisor::Register(
+    const char* name, pw::chrono::SystemClock::duration deadline) {
+  const auto deadline_ms =
+      std::chrono::ceil<std::chrono::milliseconds>(deadline).count();
+
+  // Registration is rare; a critical section keeps two threads from
+  // claiming the same slot
+  const int32_t state = HAL_disable_irq();
+  for (SupervisedTask& task : tasks_) {
+    if (!task.active_.load(std::memory_order_relaxed)) {
+      task.name_ = name;
+      task.deadline_ms_ = static_cast<uint32_t>(deadline_ms);
+      task.CheckIn();
+      task.active_.store(true, std::memory_order_release);
+      HAL_enable_irq(state);
+      return &task;
+    }
+  }
+  HAL_enable_irq(state);
+  return pw::Status::ResourceExhausted();
+}
+
+void Supervisor::Unregister(SupervisedTask& task) {
+  task.active_.store(false, std::memory_order_release);
+}
+
+pw::Status Supervisor::Check() {
+  const uint32_t now = HAL_Timer_Get_Milli_Seconds();
+  for (const SupervisedTask& task : tasks_) {
+    if (!task.active_.load(std::memory_order_acquire)) {
+      continue;
+    }
+    const uint32_t since =
+        now - task.last_check_in_ms_.load(std::memory_order_relaxed);
+    if (since > task.deadline_ms_) {
+      if (overdue_task_ == nullptr) {
+        PW_LOG_ERROR("Task %s missed its check-in (%u ms > %u ms)",
+                     task.name_,
+                     static_cast<unsigned>(since),
+                     static_cast<unsigned>(task.deadline_ms_));
+        overdue_task_ = &task;
+      }
+      return pw::Status::DeadlineExceeded();
+    }
+  }
+  overdue_task_ = nullptr;
+  return watchdog_.Feed();
+}
+
+}  // namespace pb::watchdog
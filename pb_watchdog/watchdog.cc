@@ -26,6 +26,10 @@ pw::Status Watchdog::Enable(uint32_t timeout_ms) {
   config.version = HAL_WATCHDOG_VERSION;
   config.timeout_ms = timeout_ms;
   config.enable_caps = HAL_WATCHDOG_CAPS_RESET;
+  if (has_expired_callback_) {
+    // The callback needs the interrupt before the reset
+    config.enable_caps |= HAL_WATCHDOG_CAPS_INT;
+  }
 
   int result = hal_watchdog_set_config(HAL_WATCHDOG_INSTANCE1, &config, nullptr);
   if (result != 0) {
@@ -76,6 +80,7 @@ pw::Status Watchdog::SetExpiredCallback(ExpiredCallback callback, void* context)
     return pw::Status::Internal();
   }
 
+  has_expired_callback_ = callback != nullptr;
   return pw::OkStatus();
 }
 
@@ -0,0 +1,28 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+
+// Configuration options for pb_work_queue
+
+// Maximum number of worker threads of one WorkQueue. Each is a pw::Thread
+// handle in the queue object; the stacks are only allocated by Start().
+#ifndef PB_WORK_QUEUE_MAX_THREADS
+#define PB_WORK_QUEUE_MAX_THREADS 4
+#endif  // PB_WORK_QUEUE_MAX_THREADS
+
+// Suggested worker stack: enough for flash, ledger and socket calls into
+// Device OS. Work that formats large buffers on the stack needs more.
+#ifndef PB_WORK_QUEUE_DEFAULT_STACK_SIZE
+#define PB_WORK_QUEUE_DEFAULT_STACK_SIZE 3072
+#endif  // PB_WORK_QUEUE_DEFAULT_STACK_SIZE
+
+namespace pb::work_queue::config {
+
+inline constexpr size_t kMaxThreads = PB_WORK_QUEUE_MAX_THREADS;
+
+inline constexpr size_t kDefaultStackSize = PB_WORK_QUEUE_DEFAULT_STACK_SIZE;
+
+}  // namespace pb::work_queue::config
@@ -0,0 +1,121 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file work_queue.h
+/// @brief Bounded work queue served by a few shared worker threads.
+///
+/// Blocking Device OS calls (flash, ledger, network) must not run on the
+/// async dispatcher. Instead of a thread and stack per subsystem, queue the
+/// blocking work here; a small number of workers run it in FIFO order.
+///
+/// Usage:
+/// @code
+/// pb::WorkQueueWithBuffer<8> work_queue;
+/// work_queue.Start(2, pw::thread::particle::Options()
+///                         .set_name("work")
+///                         .set_priority(3)
+///                         .set_stack_size(
+///                             pb::work_queue::config::kDefaultStackSize));
+///
+/// // Anywhere
+/// PW_CHECK_OK(work_queue.PushWork([&] { result = flash.Erase(sector); }));
+/// @endcode
+///
+/// To complete async tasks, resolve a pw::async2::ValueProvider from the
+/// work item. With more than one worker, items may finish out of order;
+/// work that must stay ordered belongs on a queue with one worker.
+
+#include <array>
+#include <cstddef>
+
+#include "pb_work_queue/config.h"
+#include "pw_function/function.h"
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+#include "pw_sync/counting_semaphore.h"
+#include "pw_sync/mutex.h"
+#include "pw_thread/options.h"
+#include "pw_thread/thread.h"
+
+namespace pb {
+
+/// Work queue over caller-provided item storage. See WorkQueueWithBuffer.
+class WorkQueue {
+ public:
+  using WorkItem = pw::Function<void()>;
+
+  explicit WorkQueue(pw::span<WorkItem> queue) : queue_(queue) {}
+
+  /// Stops the workers; queued items are dropped without running.
+  ~WorkQueue();
+
+  WorkQueue(const WorkQueue&) = delete;
+  WorkQueue& operator=(const WorkQueue&) = delete;
+
+  /// Start `thread_count` workers, each created with `options`.
+  ///
+  /// The options must not carry a static context: every worker gets its
+  /// own stack of the configured size.
+  ///
+  /// @return OkStatus, FailedPrecondition if already started, or
+  ///         InvalidArgument for 0 or more than config::kMaxThreads threads
+  pw::Status Start(size_t thread_count, const pw::thread::Options& options);
+
+  /// Stop the workers after the items they are running; items still
+  /// queued are dropped without running.
+  void Stop();
+
+  /// Queue `work` to run on a worker.
+  ///
+  /// @return OkStatus, ResourceExhausted if the queue is full, or
+  ///         FailedPrecondition after Stop() until the next Start()
+  pw::Status PushWork(WorkItem&& work);
+
+  /// Run the queued items on the calling thread.
+  ///
+  /// Used by the workers; host tests call it instead of Start().
+  ///
+  /// @return Number of items run
+  size_t RunPending();
+
+  /// Number of items waiting for a worker.
+  size_t size();
+
+  /// Largest number of items that were waiting at once, to size the queue.
+  size_t max_size();
+
+ private:
+  // Take the oldest item, or an empty function if none
+  WorkItem Pop();
+
+  void Run();
+
+  pw::span<WorkItem> queue_;
+
+  pw::sync::Mutex lock_;
+  size_t head_ = 0;       // Protected by lock_
+  size_t count_ = 0;      // Protected by lock_
+  size_t max_count_ = 0;  // Protected by lock_
+  bool stop_ = false;     // Protected by lock_
+
+  // One release per queued item, plus one per worker on Stop()
+  pw::sync::CountingSemaphore work_available_;
+  std::array<pw::Thread, work_queue::config::kMaxThreads> threads_;
+  size_t thread_count_ = 0;
+};
+
+/// WorkQueue with storage for kCapacity queued items.
+template <size_t kCapacity>
+class WorkQueueWithBuffer : public WorkQueue {
+ public:
+  static_assert(kCapacity > 0);
+
+  WorkQueueWithBuffer() : WorkQueue(storage_) {}
+
+ private:
+  std::array<WorkItem, kCapacity> storage_;
+};
+
+}  // namespace pb
@@ -0,0 +1,130 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#define PW_LOG_MODULE_NAME "pb_work"
+
+#include "pb_work_queue/work_queue.h"
+
+#include <mutex>
+#include <utility>
+
+#include "pw_log/log.h"
+
+namespace pb {
+
+WorkQueue::~WorkQueue() { Stop(); }
+
+pw::Status WorkQueue::Start(size_t thread_count,
+                            const pw::thread::Options& options) {
+  if (thread_count_ != 0) {
+    return pw::Status::FailedPrecondition();
+  }
+  if (thread_count == 0 || thread_count > threads_.size()) {
+    return pw::Status::InvalidArgument();
+  }
+  {
+    std::lock_guard lock(lock_);
+    stop_ = false;
+  }
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads_[i] = pw::Thread(options, [this]() { Run(); });
+  }
+  thread_count_ = thread_count;
+  return pw::OkStatus();
+}
+
+void WorkQueue::Stop() {
+  if (thread_count_ != 0) {
+    {
+      std::lock_guard lock(lock_);
+      stop_ = true;
+    }
+    for (size_t i = 0; i < thread_count_; ++i) {
+      work_available_.release();
+    }
+    for (size_t i = 0; i < thread_count_; ++i) {
+      threads_[i].join();
+    }
+    thread_count_ = 0;
+  }
+
+  std::lock_guard lock(lock_);
+  while (count_ > 0) {
+    queue_[head_] = nullptr;
+    head_ = (head_ + 1) % queue_.size();
+    --count_;
+  }
+  // Drain releases nobody will acquire any more
+  while (work_available_.try_acquire()) {
+  }
+}
+
+pw::Status WorkQueue::PushWork(WorkItem&& work) {
+  {
+    std::lock_guard lock(lock_);
+    if (stop_) {
+      // No worker would ever take it
+      return pw::Status::FailedPrecondition();
+    }
+    if (count_ >= queue_.size()) {
+      PW_LOG_WARN("WorkQueue: queue full");
+      return pw::Status::ResourceExhausted();
+    }
+    queue_[(head_ + count_) % queue_.size()] = std::move(work);
+    ++count_;
+    if (count_ > max_count_) {
+      max_count_ = count_;
+    }
+  }
+  work_available_.release();
+  return pw::OkStatus();
+}
+
+size_t WorkQueue::RunPending() {
+  size_t ran = 0;
+  while (WorkItem work = Pop()) {
+    work();
+    ++ran;
+  }
+  return ran;
+}
+
+size_t WorkQueue::size() {
+  std::lock_guard lock(lock_);
+  return count_;
+}
+
+size_t WorkQueue::max_size() {
+  std::lock_guard lock(lock_);
+  return max_count_;
+}
+
+WorkQueue::WorkItem WorkQueue::Pop() {
+  std::lock_guard lock(lock_);
+  if (count_ == 0 || stop_) {
+    return nullptr;
+  }
+  WorkItem work = std::move(queue_[head_]);
+  queue_[head_] = nullptr;
+  head_ = (head_ + 1) % queue_.size();
+  --count_;
+  return work;
+}
+
+void WorkQueue::Run() {
+  while (true) {
+    work_available_.acquire();
+    {
+      std::lock_guard lock(lock_);
+      if (stop_) {
+        break;
+      }
+    }
+    // The release may belong to an item another worker already took
+    if (WorkItem work = Pop()) {
+      work();
+    }
+  }
+}
+
+}  // namespace pb
@@ -0,0 +1,72 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_work_queue/work_queue.h"
+
+#include <array>
+
+#include "pw_unit_test/framework.h"
+
+namespace pb {
+namespace {
+
+TEST(WorkQueue, RunsItemsInOrder) {
+  WorkQueueWithBuffer<4> work_queue;
+  std::array<int, 3> order{};
+  size_t next = 0;
+
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(work_queue.PushWork([&, i] { order[next++] = i; }),
+              pw::OkStatus());
+  }
+  EXPECT_EQ(next, 0u);
+
+  EXPECT_EQ(work_queue.RunPending(), 3u);
+  EXPECT_EQ(order, (std::array<int, 3>{0, 1, 2}));
+  EXPECT_EQ(work_queue.RunPending(), 0u);
+}
+
+TEST(WorkQueue, FullQueueRejectsWork) {
+  WorkQueueWithBuffer<2> work_queue;
+  int ran = 0;
+
+  EXPECT_EQ(work_queue.PushWork([&] { ++ran; }), pw::OkStatus());
+  EXPECT_EQ(work_queue.PushWork([&] { ++ran; }), pw::OkStatus());
+  EXPECT_EQ(work_queue.PushWork([&] { ++ran; }),
+            pw::Status::ResourceExhausted());
+  EXPECT_EQ(work_queue.size(), 2u);
+
+  EXPECT_EQ(work_queue.RunPending(), 2u);
+  EXPECT_EQ(ran, 2);
+  EXPECT_EQ(work_queue.max_size(), 2u);
+
+  // Slots are reused after the wrap
+  EXPECT_EQ(work_queue.PushWork([&] { ++ran; }), pw::OkStatus());
+  EXPECT_EQ(work_queue.RunPending(), 1u);
+  EXPECT_EQ(ran, 3);
+}
+
+TEST(WorkQueue, StopDropsQueuedWork) {
+  WorkQueueWithBuffer<2> work_queue;
+  int ran = 0;
+
+  EXPECT_EQ(work_queue.PushWork([&] { ++ran; }), pw::OkStatus());
+  work_queue.Stop();
+
+  EXPECT_EQ(work_queue.size(), 0u);
+  EXPECT_EQ(work_queue.RunPending(), 0u);
+  EXPECT_EQ(ran, 0);
+}
+
+TEST(WorkQueue, StartRejectsInvalidThreadCount) {
+  WorkQueueWithBuffer<2> work_queue;
+  struct : pw::thread::Options {
+  } options;
+
+  EXPECT_EQ(work_queue.Start(0, options), pw::Status::InvalidArgument());
+  EXPECT_EQ(work_queue.Start(work_queue::config::kMaxThreads + 1, options),
+            pw::Status::InvalidArgument());
+}
+
+}  // namespace
+}  // namespace pb
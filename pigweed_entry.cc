@@ -16,6 +16,10 @@
 // - Proper handling of cloud reconnection (subscriptions resent automatically)
 // Without this, Pigweed apps in AUTOMATIC mode would never send subscriptions
 // to the cloud because the APPLICATION_SETUP_DONE check would fail.
+//
+// Each entry point marks a boot milestone (pb_boot/boot_timeline.h).
+
+#include "pb_boot/boot_timeline.h"
 
 extern "C" {
 
@@ -24,18 +28,21 @@ int main();
 
 // Called once during user module initialization.
 void module_user_init_hook() {
-    // No-op - Pigweed handles its own initialization in main().
+    // Pigweed handles its own initialization in main().
+    pb::boot::MarkBootMilestone("module_user_init_hook");
 }
 
 // Called once after device initialization.
 // Returns immediately so Device OS can mark APPLICATION_SETUP_DONE=true.
 void setup() {
-    // No-op - actual initialization happens in loop() -> main()
+    // Actual initialization happens in loop() -> main()
+    pb::boot::MarkBootMilestone("setup");
 }
 
 // Called repeatedly after setup().
 // We call main() here which never returns for pw_system based apps.
 void loop() {
+    pb::boot::MarkBootMilestone("main");
     main();
     // main() should never return for pw_system based apps.
 }
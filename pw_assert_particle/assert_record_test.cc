@@ -0,0 +1,56 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pw_assert_particle/assert_record.h"
+
+#include <cstring>
+
+#include "pw_unit_test/framework.h"
+
+namespace pw::assert::particle {
+namespace {
+
+constexpr AssertInfo kInfo = {
+    .kind = AssertKind::kCheck,
+    .token = 0x1234abcd,
+    .line = 42,
+    .return_address = 0x08061234,
+};
+
+TEST(AssertRecord, GarbageHoldsNoRecord) {
+  AssertRecord record;
+  std::memset(static_cast<void*>(&record), 0xa5, sizeof(record));
+  EXPECT_FALSE(record.Load().has_value());
+}
+
+TEST(AssertRecord, KeepsStoredFailure) {
+  AssertRecord record;
+  record.Clear();
+  record.Store(kInfo);
+
+  // Same memory after a reset
+  const std::optional<AssertInfo> loaded = record.Load();
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_EQ(loaded->kind, AssertKind::kCheck);
+  EXPECT_EQ(loaded->token, kInfo.token);
+  EXPECT_EQ(loaded->line, kInfo.line);
+  EXPECT_EQ(loaded->return_address, kInfo.return_address);
+}
+
+TEST(AssertRecord, DamagedRecordIsDropped) {
+  AssertRecord record;
+  record.Store(kInfo);
+  // Flip one bit of the stored line
+  reinterpret_cast<uint32_t*>(&record)[3] ^= 0x10;
+  EXPECT_FALSE(record.Load().has_value());
+}
+
+TEST(AssertRecord, ClearDropsRecord) {
+  AssertRecord record;
+  record.Store(kInfo);
+  record.Clear();
+  EXPECT_FALSE(record.Load().has_value());
+}
+
+}  // namespace
+}  // namespace pw::assert::particle
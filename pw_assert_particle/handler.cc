@@ -2,7 +2,8 @@
 // SPDX-License-Identifier: MIT
 //
 // pw_assert_basic handler for Particle P2 firmware.
-// Logs assertion failure and enters safe mode.
+// Logs assertion failure, records it in the retained crash log and enters
+// safe mode.
 //
 // Note: PW_ASSERT does not provide location info. Use PW_CHECK for
 // file/line/function details in assert output.
@@ -14,6 +15,8 @@
 
 #include "core_hal.h"
 #include "delay_hal.h"
+#include "logging.h"
+#include "pb_log/retained_crash_log.h"
 #include "pw_log/log.h"
 #include "usb_hal.h"
 
@@ -35,11 +38,15 @@ void pw_assert_basic_HandleFailure(
 
   // Print location if available (PW_CHECK provides this, PW_ASSERT does not)
   if (file_name != nullptr && line_number >= 0) {
+    char location[96];
     if (function_name != nullptr) {
-      PW_LOG_CRITICAL("%s:%d in %s()", file_name, line_number, function_name);
+      snprintf(location, sizeof(location), "%s:%d in %s()", file_name,
+               line_number, function_name);
     } else {
-      PW_LOG_CRITICAL("%s:%d", file_name, line_number);
+      snprintf(location, sizeof(location), "%s:%d", file_name, line_number);
     }
+    PW_LOG_CRITICAL("%s", location);
+    pb::log::RecordCrashLog(LOG_LEVEL_PANIC, "assert", location);
   }
 
   // Print formatted message if provided
@@ -50,6 +57,7 @@ void pw_assert_basic_HandleFailure(
     vsnprintf(msg_buffer, sizeof(msg_buffer), format, args);
     va_end(args);
     PW_LOG_CRITICAL("%s", msg_buffer);
+    pb::log::RecordCrashLog(LOG_LEVEL_PANIC, "assert", msg_buffer);
   }
 
   PW_LOG_CRITICAL("Entering safe mode...");
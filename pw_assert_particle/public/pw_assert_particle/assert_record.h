@@ -0,0 +1,71 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file assert_record.h
+/// @brief Compact assert failure record that survives a reset when placed
+/// in retained RAM.
+///
+/// The tokenized handler stores what pw_assert_tokenized passes it (a
+/// token and a line) plus the caller's address: 16 bytes, no strings. The
+/// host decodes the token with the firmware's token database and the
+/// address with addr2line.
+///
+/// Like pb::log::CrashLog, the class has no constructor and no member
+/// initializers, so an instance in a retained section keeps its content
+/// across a reset. The magic word is written last: a reset in the middle
+/// of Store() leaves no record rather than a torn one.
+
+#include <cstdint>
+#include <optional>
+
+namespace pw::assert::particle {
+
+enum class AssertKind : uint32_t {
+  kAssert = 1,  // PW_ASSERT: the token is the file name
+  kCheck = 2,   // PW_CHECK: the token is the file name and message
+};
+
+struct AssertInfo {
+  AssertKind kind;
+  uint32_t token;
+  uint32_t line;
+  uint32_t return_address;  // Address after the failing check's call
+};
+
+class AssertRecord {
+ public:
+  void Store(const AssertInfo& info) {
+    magic_ = 0;
+    info_ = info;
+    check_ = Check();
+    magic_ = kMagic;
+  }
+
+  /// The stored failure, or nullopt if none or the record is damaged.
+  std::optional<AssertInfo> Load() const {
+    if (magic_ != kMagic || check_ != Check()) {
+      return std::nullopt;
+    }
+    return info_;
+  }
+
+  void Clear() { magic_ = 0; }
+
+ private:
+  static constexpr uint32_t kMagic = 0x50424131;  // "PBA1"
+
+  uint32_t Check() const {
+    return ~(kMagic ^ static_cast<uint32_t>(info_.kind) ^
+             (info_.token * 0x9e3779b1u) ^ info_.line ^
+             info_.return_address);
+  }
+
+  // No initializers: see the file comment
+  uint32_t magic_;
+  AssertInfo info_;
+  uint32_t check_;
+};
+
+}  // namespace pw::assert::particle
@@ -0,0 +1,26 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Assert record in retained RAM: the tokenized assert failure that caused
+// the last reset, for post-mortem retrieval (see assert_record.h).
+
+#pragma once
+
+#include <optional>
+
+#include "pw_assert_particle/assert_record.h"
+
+namespace pw::assert::particle {
+
+// Store `info`, replacing the previous record. Called by the tokenized
+// handler; safe from interrupts.
+void RecordAssert(const AssertInfo& info);
+
+// The stored failure, if any. It stays until ClearLastAssert(), also
+// across further resets.
+std::optional<AssertInfo> LastAssert();
+
+// Drop the record, e.g. after it was published.
+void ClearLastAssert();
+
+}  // namespace pw::assert::particle
@@ -0,0 +1,24 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// AssertRecord instance in Device OS retained RAM (.retained_user).
+
+#include "pw_assert_particle/retained_assert_record.h"
+
+namespace pw::assert::particle {
+namespace {
+
+// Same section as Device OS's `retained` keyword; not zeroed at startup
+__attribute__((section(".retained_user"))) AssertRecord g_assert_record;
+
+}  // namespace
+
+// No lock: the record is written once, on the way into safe mode, and
+// read after the reset
+void RecordAssert(const AssertInfo& info) { g_assert_record.Store(info); }
+
+std::optional<AssertInfo> LastAssert() { return g_assert_record.Load(); }
+
+void ClearLastAssert() { g_assert_record.Clear(); }
+
+}  // namespace pw::assert::particle
@@ -0,0 +1,83 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// pw_assert_tokenized handler for Particle P2 firmware.
+// Stores the failure in the retained assert record, logs it and records it
+// in the retained crash log as a prefixed Base64 token, then enters safe
+// mode. File names and check messages exist only in the token database, so
+// no assert string is compiled into flash and the failure path formats
+// nothing but the token.
+
+#define PW_LOG_MODULE_NAME "assert"
+
+#include <cstdint>
+#include <string_view>
+
+#include "core_hal.h"
+#include "delay_hal.h"
+#include "logging.h"
+#include "pb_log/retained_crash_log.h"
+#include "pw_assert_particle/retained_assert_record.h"
+#include "pw_assert_tokenized/handler.h"
+#include "pw_log/log.h"
+#include "pw_span/span.h"
+#include "pw_string/string_builder.h"
+#include "pw_tokenizer/base64.h"
+
+namespace {
+
+using pw::assert::particle::AssertInfo;
+using pw::assert::particle::AssertKind;
+
+[[noreturn]] void HandleFailure(AssertKind kind, uint32_t token,
+                                int line_number, void* return_address) {
+  // The record first: it is the part that must survive
+  const AssertInfo info = {
+      .kind = kind,
+      .token = token,
+      .line = static_cast<uint32_t>(line_number),
+      // Clear the Thumb bit so addr2line takes the address as is
+      .return_address =
+          static_cast<uint32_t>(reinterpret_cast<uintptr_t>(return_address)) &
+          ~1u,
+  };
+  pw::assert::particle::RecordAssert(info);
+
+  // "$<token> line <n> pc <address>"; detokenizes like a tokenized log
+  char encoded[pw::tokenizer::Base64EncodedBufferSize(sizeof(token))];
+  const size_t encoded_size = pw::tokenizer::PrefixedBase64Encode(
+      pw::as_bytes(pw::span(&token, 1)), encoded);
+  pw::StringBuffer<48> message;
+  message << std::string_view(encoded, encoded_size) << " line "
+          << info.line << " pc ";
+  message.Format("0x%08x", static_cast<unsigned>(info.return_address));
+
+  PW_LOG_CRITICAL("%s failed: %s",
+                  kind == AssertKind::kCheck ? "Check" : "Assert",
+                  message.c_str());
+  pb::log::RecordCrashLog(LOG_LEVEL_PANIC, "assert", message.view());
+
+  // Long enough for the log drain to send the line, not to watch it
+  HAL_Delay_Milliseconds(100);
+  HAL_Core_Enter_Safe_Mode(nullptr);
+  while (true) {
+  }
+}
+
+}  // namespace
+
+extern "C" {
+
+void pw_assert_tokenized_HandleAssertFailure(uint32_t tokenized_file_name,
+                                             int line_number) {
+  HandleFailure(AssertKind::kAssert, tokenized_file_name, line_number,
+                __builtin_return_address(0));
+}
+
+void pw_assert_tokenized_HandleCheckFailure(uint32_t tokenized_message,
+                                            int line_number) {
+  HandleFailure(AssertKind::kCheck, tokenized_message, line_number,
+                __builtin_return_address(0));
+}
+
+}  // extern "C"
@@ -0,0 +1,98 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pw_chrono_particle/cycle_clock.h"
+
+#include <initializer_list>
+
+#include "hal_irq_flag.h"
+#include "pw_chrono_particle/cycle_timer.h"
+
+namespace pw::chrono::particle {
+namespace {
+
+constexpr uintptr_t kDemcr = 0xE000EDFC;
+constexpr uintptr_t kDwtCtrl = 0xE0001000;
+
+volatile uint32_t& Register(uintptr_t address) {
+  // NOLINTNEXTLINE(performance-no-int-to-ptr)
+  return *reinterpret_cast<volatile uint32_t*>(address);
+}
+
+// 64-bit extension of the counter; only touched with interrupts disabled
+uint32_t g_last_cycles = 0;
+uint32_t g_wraps = 0;
+
+}  // namespace
+
+void EnableCycleCounter() {
+  if ((Register(kDwtCtrl) & 1u) == 0) {
+    Register(kDemcr) = Register(kDemcr) | (1u << 24);  // TRCENA
+    Register(kDwtCtrl) = Register(kDwtCtrl) | 1u;      // CYCCNTENA
+  }
+}
+
+CycleClock::time_point CycleClock::now() {
+  const int32_t state = HAL_disable_irq();
+  const uint32_t cycles = ReadCycles();
+  if (cycles < g_last_cycles) {
+    ++g_wraps;
+  }
+  g_last_cycles = cycles;
+  const uint64_t count = (uint64_t{g_wraps} << 32) | cycles;
+  HAL_enable_irq(state);
+  return time_point(duration(static_cast<rep>(count)));
+}
+
+// CycleHistogram implementation
+
+size_t CycleHistogram::Bucket(uint32_t cycles) {
+  size_t bucket = 0;
+  uint32_t limit = 64;
+  while (bucket < kBuckets - 1 && cycles >= limit) {
+    limit *= 4;
+    ++bucket;
+  }
+  return bucket;
+}
+
+void CycleHistogram::Record(uint32_t cycles) {
+  pw::metric::TypedMetric<uint32_t>* const buckets[kBuckets] = {
+      &bucket_0_, &bucket_1_, &bucket_2_, &bucket_3_,
+      &bucket_4_, &bucket_5_, &bucket_6_, &bucket_7_};
+
+  const int32_t state = HAL_disable_irq();
+  if (count_.value() == 0 || cycles < min_.value()) {
+    min_.Set(cycles);
+  }
+  if (cycles > max_.value()) {
+    max_.Set(cycles);
+  }
+  count_.Increment();
+  total_remainder_ += cycles % 64;
+  total_64_.Increment(cycles / 64 + total_remainder_ / 64);
+  total_remainder_ %= 64;
+  buckets[Bucket(cycles)]->Increment();
+  HAL_enable_irq(state);
+}
+
+void CycleHistogram::Reset() {
+  const int32_t state = HAL_disable_irq();
+  for (auto* metric : {&count_, &min_, &max_, &total_64_, &bucket_0_,
+                       &bucket_1_, &bucket_2_, &bucket_3_, &bucket_4_,
+                       &bucket_5_, &bucket_6_, &bucket_7_}) {
+    metric->Set(0u);
+  }
+  total_remainder_ = 0;
+  HAL_enable_irq(state);
+}
+
+uint32_t CycleHistogram::mean_cycles() const {
+  if (count_.value() == 0) {
+    return 0;
+  }
+  const uint64_t total = uint64_t{total_64_.value()} * 64 + total_remainder_;
+  return static_cast<uint32_t>(total / count_.value());
+}
+
+}  // namespace pw::chrono::particle
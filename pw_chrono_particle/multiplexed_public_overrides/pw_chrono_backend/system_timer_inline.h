@@ -0,0 +1,6 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "pw_chrono_particle/system_timer_inline.h"
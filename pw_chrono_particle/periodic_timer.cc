@@ -0,0 +1,66 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pw_chrono_particle/periodic_timer.h"
+
+#include <chrono>
+#include <utility>
+
+#include "pw_assert/check.h"
+
+namespace pw::chrono::particle {
+
+PeriodicTimer::PeriodicTimer(Callback&& callback)
+    : callback_(std::move(callback)) {
+  // Auto-reload; the period is set by Start()
+  const int result =
+      os_timer_create(&timer_, 1, OnExpired, this, false, nullptr);
+  PW_CHECK_INT_EQ(result, 0, "Failed to create timer");
+}
+
+PeriodicTimer::~PeriodicTimer() {
+  Stop();
+  // Wait for the stop to be processed and a running callback to finish
+  while (os_timer_is_active(timer_, nullptr)) {
+    os_thread_yield();
+  }
+  os_timer_destroy(timer_, nullptr);
+}
+
+Status PeriodicTimer::Start(SystemClock::duration period) {
+  const auto period_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(period);
+  if (period_ms.count() < 1 || period_ms != period ||
+      period_ms.count() >= CONCURRENT_WAIT_FOREVER) {
+    return Status::InvalidArgument();
+  }
+  Stop();
+  period_ = period;
+  next_ = SystemClock::now() + period;
+
+  // Changing the period starts the timer (xTimerChangePeriod)
+  os_timer_change(timer_, OS_TIMER_CHANGE_PERIOD, false,
+                  static_cast<unsigned>(period_ms.count()), 0, nullptr);
+  return OkStatus();
+}
+
+void PeriodicTimer::Stop() {
+  os_timer_change(timer_, OS_TIMER_CHANGE_STOP, false, 0, 0, nullptr);
+}
+
+void PeriodicTimer::OnExpired(os_timer_t timer) {
+  void* timer_id = nullptr;
+  os_timer_get_id(timer, &timer_id);
+  if (timer_id == nullptr) {
+    return;
+  }
+  PeriodicTimer& self = *static_cast<PeriodicTimer*>(timer_id);
+
+  // Advance by whole periods from Start(), never from "now", so callback
+  // latency does not accumulate
+  const SystemClock::time_point scheduled = self.next_;
+  self.next_ += self.period_;
+  self.callback_(scheduled);
+}
+
+}  // namespace pw::chrono::particle
@@ -0,0 +1,54 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// CPU cycle clock for benchmarking hot paths.
+//
+// Backed by the Cortex-M33 DWT cycle counter, which counts at the core
+// clock (5 ns at 200 MHz). Meant for microbenchmarks and profiling, not for
+// timeouts: the counter stops while the core sleeps.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ratio>
+
+// Core clock the DWT counter runs at. 200 MHz for the RTL872x KM4 (P2).
+#ifndef PW_CHRONO_PARTICLE_CPU_HZ
+#define PW_CHRONO_PARTICLE_CPU_HZ 200000000
+#endif
+
+namespace pw::chrono::particle {
+
+/// std::chrono clock counting CPU cycles.
+///
+/// now() extends the 32-bit counter to 64 bits, which needs a call at least
+/// every 2^32 cycles (21 s at 200 MHz) to see every wrap. For spans shorter
+/// than that, ReadCycles() differences are cheaper and wrap correctly.
+struct CycleClock {
+  using rep = int64_t;
+  using period = std::ratio<1, PW_CHRONO_PARTICLE_CPU_HZ>;
+  using duration = std::chrono::duration<rep, period>;
+  using time_point = std::chrono::time_point<CycleClock>;
+  static constexpr bool is_steady = true;
+
+  static time_point now();
+};
+
+/// Start the DWT cycle counter if it is not running. now() and
+/// ReadCycles() users call this once before measuring.
+void EnableCycleCounter();
+
+/// The raw 32-bit cycle count. Differences of two reads are correct across
+/// one wrap.
+inline uint32_t ReadCycles() {
+  // NOLINTNEXTLINE(performance-no-int-to-ptr)
+  return *reinterpret_cast<volatile uint32_t*>(0xE0001004);  // DWT_CYCCNT
+}
+
+/// Convert a cycle count to nanoseconds.
+constexpr uint64_t CyclesToNanoseconds(uint64_t cycles) {
+  return cycles * 1'000'000'000 / PW_CHRONO_PARTICLE_CPU_HZ;
+}
+
+}  // namespace pw::chrono::particle
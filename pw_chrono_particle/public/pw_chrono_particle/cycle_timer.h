@@ -0,0 +1,92 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Scoped cycle timers recording into pw_metric.
+//
+//   pw::chrono::particle::CycleHistogram encode_cycles(
+//       PW_TOKENIZE_STRING("cbor_encode"));
+//
+//   void Encode() {
+//     pw::chrono::particle::ScopedCycleTimer timer(encode_cycles);
+//     ...
+//   }
+//
+// Add encode_cycles.metrics() to a pw_metric group (or dump it with
+// pw::metric::Group::Dump()) to read the results.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_chrono_particle/cycle_clock.h"
+#include "pw_metric/metric.h"
+#include "pw_tokenizer/tokenize.h"
+
+namespace pw::chrono::particle {
+
+/// Distribution of measured cycle counts as pw_metric values.
+///
+/// Bucket i counts samples below 64 * 4^i cycles (the last bucket takes
+/// the rest): < 64, < 256, < 1k, < 4k, < 16k, < 64k, < 256k, >= 256k.
+class CycleHistogram {
+ public:
+  static constexpr size_t kBuckets = 8;
+
+  explicit CycleHistogram(pw::tokenizer::Token name) : metrics_(name) {}
+
+  CycleHistogram(const CycleHistogram&) = delete;
+  CycleHistogram& operator=(const CycleHistogram&) = delete;
+
+  /// Add one sample. Safe from any thread and from interrupts.
+  void Record(uint32_t cycles);
+
+  /// Clear all samples.
+  void Reset();
+
+  uint32_t count() const { return count_.value(); }
+  uint32_t min_cycles() const { return min_.value(); }
+  uint32_t max_cycles() const { return max_.value(); }
+  // Mean in cycles, 0 without samples
+  uint32_t mean_cycles() const;
+
+  pw::metric::Group& metrics() { return metrics_; }
+
+ private:
+  static size_t Bucket(uint32_t cycles);
+
+  pw::metric::Group metrics_;
+  PW_METRIC(metrics_, count_, "count", 0u);
+  PW_METRIC(metrics_, min_, "min_cycles", 0u);
+  PW_METRIC(metrics_, max_, "max_cycles", 0u);
+  // Sum in units of 64 cycles, so a uint32_t lasts 275 billion cycles
+  PW_METRIC(metrics_, total_64_, "total_cycles_64", 0u);
+  PW_METRIC(metrics_, bucket_0_, "lt_64", 0u);
+  PW_METRIC(metrics_, bucket_1_, "lt_256", 0u);
+  PW_METRIC(metrics_, bucket_2_, "lt_1k", 0u);
+  PW_METRIC(metrics_, bucket_3_, "lt_4k", 0u);
+  PW_METRIC(metrics_, bucket_4_, "lt_16k", 0u);
+  PW_METRIC(metrics_, bucket_5_, "lt_64k", 0u);
+  PW_METRIC(metrics_, bucket_6_, "lt_256k", 0u);
+  PW_METRIC(metrics_, bucket_7_, "ge_256k", 0u);
+  uint32_t total_remainder_ = 0;  // Cycles not yet in total_64_
+};
+
+/// Records the cycles from construction to destruction into a histogram.
+/// Spans must be shorter than 2^32 cycles (21 s at 200 MHz).
+class ScopedCycleTimer {
+ public:
+  explicit ScopedCycleTimer(CycleHistogram& histogram)
+      : histogram_(histogram), start_(ReadCycles()) {}
+
+  ~ScopedCycleTimer() { histogram_.Record(ReadCycles() - start_); }
+
+  ScopedCycleTimer(const ScopedCycleTimer&) = delete;
+  ScopedCycleTimer& operator=(const ScopedCycleTimer&) = delete;
+
+ private:
+  CycleHistogram& histogram_;
+  const uint32_t start_;
+};
+
+}  // namespace pw::chrono::particle
@@ -0,0 +1,19 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Earliest armed SystemTimer deadline, for tickless idle (pb_power)
+
+#pragma once
+
+#include "pw_chrono/system_clock.h"
+#include "pw_result/result.h"
+
+namespace pw::chrono::particle {
+
+// Earliest deadline of an armed SystemTimer, time_point::max() if none is
+// armed. Only :system_timer_multiplexed keeps its timers in one list; with
+// :system_timer each timer is its own os_timer and this returns
+// Unimplemented.
+Result<SystemClock::time_point> NextTimerDeadline();
+
+}  // namespace pw::chrono::particle
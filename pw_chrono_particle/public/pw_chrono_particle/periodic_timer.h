@@ -0,0 +1,61 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "concurrent_hal.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_function/function.h"
+#include "pw_status/status.h"
+
+namespace pw::chrono::particle {
+
+/// Calls back at a fixed period on an auto-reload os_timer.
+///
+/// A SystemTimer that re-arms itself from its callback pays a timer task
+/// command per period and drifts by the callback latency. Here FreeRTOS
+/// reloads the timer from the previous expiry time, so the schedule stays
+/// locked to Start() with no OS call per period:
+///
+/// @code
+///   pw::chrono::particle::PeriodicTimer sampler(
+///       [](pw::chrono::SystemClock::time_point scheduled) { Sample(); });
+///   sampler.Start(std::chrono::milliseconds(1));
+/// @endcode
+///
+/// The callback gets the time it was scheduled for (Start() time plus n
+/// periods), not the time it ran. It runs in the Device OS timer task, like
+/// SystemTimer callbacks; if it is delayed past a period, the missed calls
+/// follow back to back.
+class PeriodicTimer {
+ public:
+  using Callback = Function<void(SystemClock::time_point scheduled)>;
+
+  explicit PeriodicTimer(Callback&& callback);
+
+  /// Stops the timer and waits for a running callback.
+  ~PeriodicTimer();
+
+  PeriodicTimer(const PeriodicTimer&) = delete;
+  PeriodicTimer& operator=(const PeriodicTimer&) = delete;
+
+  /// (Re)start with the first call one `period` from now.
+  ///
+  /// @return OkStatus, or InvalidArgument unless `period` is a whole
+  ///         number of milliseconds of at least 1 ms (the timer task tick)
+  Status Start(SystemClock::duration period);
+
+  /// Stop calling back. May be called from the callback.
+  void Stop();
+
+ private:
+  static void OnExpired(os_timer_t timer);
+
+  os_timer_t timer_ = nullptr;
+  Callback callback_;
+  SystemClock::duration period_{};
+  // Deadline of the next call; only touched by the timer task after Start()
+  SystemClock::time_point next_;
+};
+
+}  // namespace pw::chrono::particle
@@ -7,10 +7,23 @@
 
 #include "pw_chrono/epoch.h"
 
-// System clock period: 1 millisecond (1/1000 second)
-// hal_timer_millis() returns milliseconds since boot
+// Tick the system clock in microseconds instead of milliseconds.
+// 0: hal_timer_millis(), 1 ms period (default)
+// 1: hal_timer_micros(), 1 us period. Timeouts and sleeps still wait in
+//    whole milliseconds (rounded up), but time stamps and measured
+//    durations resolve to the microsecond.
+// Set it for the whole build (e.g. a copt), since the tick period is part
+// of every SystemClock::duration.
+#ifndef PW_CHRONO_PARTICLE_SYSTEM_CLOCK_MICROS
+#define PW_CHRONO_PARTICLE_SYSTEM_CLOCK_MICROS 0
+#endif
+
 #define PW_CHRONO_SYSTEM_CLOCK_PERIOD_SECONDS_NUMERATOR 1
+#if PW_CHRONO_PARTICLE_SYSTEM_CLOCK_MICROS
+#define PW_CHRONO_SYSTEM_CLOCK_PERIOD_SECONDS_DENOMINATOR 1000000
+#else
 #define PW_CHRONO_SYSTEM_CLOCK_PERIOD_SECONDS_DENOMINATOR 1000
+#endif
 
 namespace pw::chrono::backend {
 
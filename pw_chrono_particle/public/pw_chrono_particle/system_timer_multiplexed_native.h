@@ -0,0 +1,30 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// pw_chrono system_timer backend native type for the multiplexed timer:
+// all SystemTimers share one Device OS timer (system_timer_multiplexed.cc).
+
+#pragma once
+
+#include "pw_chrono/system_clock.h"
+#include "pw_function/function.h"
+
+namespace pw::chrono::backend {
+
+struct NativeSystemTimer {
+  enum class State {
+    // Timer is not scheduled.
+    kCancelled = 0,
+    // Timer is in the deadline list.
+    kScheduled = 1,
+  };
+  // Links in the deadline list, earliest first
+  NativeSystemTimer* next;
+  NativeSystemTimer* prev;
+  State state;
+  SystemClock::time_point expiry_deadline;
+  Function<void(SystemClock::time_point expired_deadline)> user_callback;
+};
+using NativeSystemTimerHandle = NativeSystemTimer&;
+
+}  // namespace pw::chrono::backend
@@ -0,0 +1,24 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Configuration of the multiplexed system_timer backend
+
+#pragma once
+
+// Run SystemTimer callbacks on a dedicated thread instead of the Device OS
+// timer task. Callbacks then no longer wait behind unrelated os_timer
+// callbacks (and vice versa); the thread costs its stack.
+#ifndef PW_CHRONO_PARTICLE_TIMER_DISPATCH_THREAD
+#define PW_CHRONO_PARTICLE_TIMER_DISPATCH_THREAD 0
+#endif
+
+// Priority of the dispatch thread (Device OS scale, 0-9). Above the
+// application threads, so deadlines are met while they are busy.
+#ifndef PW_CHRONO_PARTICLE_TIMER_THREAD_PRIORITY
+#define PW_CHRONO_PARTICLE_TIMER_THREAD_PRIORITY 7
+#endif
+
+// Stack size of the dispatch thread; callbacks run on it.
+#ifndef PW_CHRONO_PARTICLE_TIMER_THREAD_STACK_SIZE
+#define PW_CHRONO_PARTICLE_TIMER_THREAD_STACK_SIZE 2048
+#endif
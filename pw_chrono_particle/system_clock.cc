@@ -10,9 +10,13 @@
 namespace pw::chrono::backend {
 
 int64_t GetSystemClockTickCount() {
-  // hal_timer_millis returns milliseconds since boot as 64-bit value
-  // Our tick period is 1ms, so we can return it directly
+  // Both return a 64-bit count since boot in the configured tick period, so
+  // neither wraps
+#if PW_CHRONO_PARTICLE_SYSTEM_CLOCK_MICROS
+  return static_cast<int64_t>(hal_timer_micros(nullptr));
+#else
   return static_cast<int64_t>(hal_timer_millis(nullptr));
+#endif
 }
 
 }  // namespace pw::chrono::backend
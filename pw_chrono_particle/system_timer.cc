@@ -7,6 +7,7 @@
 
 #include "concurrent_hal.h"
 #include "pw_assert/check.h"
+#include "pw_chrono_particle/next_timer_deadline.h"
 
 namespace pw::chrono {
 namespace {
@@ -40,18 +41,18 @@ void HandleTimerCallback(os_timer_t timer) {
     native_type->user_callback(native_type->expiry_deadline);
   } else {
     // Not yet at deadline, reschedule.
+    // Round up: with the microsecond clock a fraction of a millisecond
+    // may remain
     const int64_t remaining_ms =
-        std::chrono::duration_cast<std::chrono::milliseconds>(
-            time_until_deadline)
+        std::chrono::ceil<std::chrono::milliseconds>(time_until_deadline)
             .count();
     const unsigned period_ms =
         static_cast<unsigned>(std::min(static_cast<int64_t>(kMaxPeriodMs),
                                        std::max(static_cast<int64_t>(1),
                                                 remaining_ms)));
+    // Changing the period also (re)starts the timer
     os_timer_change(native_type->timer, OS_TIMER_CHANGE_PERIOD, false,
                     period_ms, 0, nullptr);
-    os_timer_change(native_type->timer, OS_TIMER_CHANGE_START, false,
-                    0, 0, nullptr);
   }
 }
 
@@ -88,8 +89,7 @@ void SystemTimer::InvokeAt(SystemClock::time_point timestamp) {
   const SystemClock::duration time_until_deadline =
       timestamp - SystemClock::now();
   const int64_t delay_ms =
-      std::chrono::duration_cast<std::chrono::milliseconds>(time_until_deadline)
-          .count();
+      std::chrono::ceil<std::chrono::milliseconds>(time_until_deadline).count();
 
   // Calculate period, clamping to valid range (minimum 1ms).
   const unsigned period_ms =
@@ -97,15 +97,11 @@ void SystemTimer::InvokeAt(SystemClock::time_point timestamp) {
                                      std::max(static_cast<int64_t>(1),
                                               delay_ms)));
 
-  // Update timer period and start.
+  // Update the timer period, which also starts it (xTimerChangePeriod), so
+  // rescheduling is one timer task command.
+  native_type_.state = State::kScheduled;
   os_timer_change(native_type_.timer, OS_TIMER_CHANGE_PERIOD, false,
                   period_ms, 0, nullptr);
-
-  if (native_type_.state == State::kCancelled) {
-    os_timer_change(native_type_.timer, OS_TIMER_CHANGE_START, false,
-                    0, 0, nullptr);
-    native_type_.state = State::kScheduled;
-  }
 }
 
 void SystemTimer::Cancel() {
@@ -116,4 +112,13 @@ void SystemTimer::Cancel() {
   }
 }
 
+namespace particle {
+
+// The os_timers are only known to the timer task
+Result<SystemClock::time_point> NextTimerDeadline() {
+  return Status::Unimplemented();
+}
+
+}  // namespace particle
+
 }  // namespace pw::chrono
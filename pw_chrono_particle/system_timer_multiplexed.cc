@@ -0,0 +1,272 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// SystemTimer backend that multiplexes all timers onto one os_timer.
+//
+// Armed timers sit in a deadline list, earliest first. The os_timer is
+// only reprogrammed when the earliest deadline changes, and one expiry
+// runs every callback that is due. Arming searches from the latest
+// deadline, so the usual case - a timeout further out than all others - is
+// O(1); cancelling unlinks in O(1).
+//
+// With PW_CHRONO_PARTICLE_TIMER_DISPATCH_THREAD, a dedicated thread takes
+// the place of the os_timer and the timer task.
+
+#include <algorithm>
+#include <mutex>
+
+#include "concurrent_hal.h"
+#include "hal_irq_flag.h"
+#include "pw_assert/check.h"
+#include "pw_chrono/system_timer.h"
+#include "pw_chrono_particle/next_timer_deadline.h"
+#include "pw_chrono_particle/timer_config.h"
+#include "pw_sync/mutex.h"
+
+namespace pw::chrono {
+namespace {
+
+using backend::NativeSystemTimer;
+using State = NativeSystemTimer::State;
+
+// Maximum timer period in milliseconds (leave room for safety).
+constexpr unsigned kMaxPeriodMs = CONCURRENT_WAIT_FOREVER - 1;
+
+#if PW_CHRONO_PARTICLE_TIMER_DISPATCH_THREAD
+constexpr os_thread_prio_t kDispatchThreadPriority =
+    PW_CHRONO_PARTICLE_TIMER_THREAD_PRIORITY;
+constexpr size_t kDispatchThreadStackSize =
+    PW_CHRONO_PARTICLE_TIMER_THREAD_STACK_SIZE;
+#endif
+
+// Deadline list; only touched with interrupts disabled, which keeps the
+// critical sections to a few pointer updates
+NativeSystemTimer* g_head = nullptr;
+NativeSystemTimer* g_tail = nullptr;
+
+// Timer whose callback is running (dispatcher only)
+NativeSystemTimer* volatile g_running = nullptr;
+
+struct Shared {
+  // Serializes reprogramming the dispatcher
+  sync::Mutex lock;
+#if PW_CHRONO_PARTICLE_TIMER_DISPATCH_THREAD
+  os_thread_t thread = nullptr;
+  os_semaphore_t wake = nullptr;
+#else
+  os_timer_t timer = nullptr;
+#endif
+  // Deadline the dispatcher is waiting for; max() when idle
+  SystemClock::time_point programmed = SystemClock::time_point::max();
+};
+
+Shared& shared() {
+  static Shared instance;
+  return instance;
+}
+
+void Link(NativeSystemTimer& timer) {
+  NativeSystemTimer* after = g_tail;
+  while (after != nullptr && after->expiry_deadline > timer.expiry_deadline) {
+    after = after->prev;
+  }
+  timer.prev = after;
+  timer.next = after != nullptr ? after->next : g_head;
+  if (timer.next != nullptr) {
+    timer.next->prev = &timer;
+  } else {
+    g_tail = &timer;
+  }
+  if (after != nullptr) {
+    after->next = &timer;
+  } else {
+    g_head = &timer;
+  }
+  timer.state = State::kScheduled;
+}
+
+void Unlink(NativeSystemTimer& timer) {
+  if (timer.state != State::kScheduled) {
+    return;
+  }
+  if (timer.prev != nullptr) {
+    timer.prev->next = timer.next;
+  } else {
+    g_head = timer.next;
+  }
+  if (timer.next != nullptr) {
+    timer.next->prev = timer.prev;
+  } else {
+    g_tail = timer.prev;
+  }
+  timer.next = nullptr;
+  timer.prev = nullptr;
+  timer.state = State::kCancelled;
+}
+
+SystemClock::time_point EarliestDeadline() {
+  const int32_t state = HAL_disable_irq();
+  const SystemClock::time_point deadline =
+      g_head != nullptr ? g_head->expiry_deadline
+                        : SystemClock::time_point::max();
+  HAL_enable_irq(state);
+  return deadline;
+}
+
+// Run everything that is due, one at a time so callbacks may arm and
+// cancel timers (including their own)
+void RunDue() {
+  while (true) {
+    const int32_t state = HAL_disable_irq();
+    NativeSystemTimer* timer = g_head;
+    if (timer == nullptr || timer->expiry_deadline > SystemClock::now()) {
+      HAL_enable_irq(state);
+      break;
+    }
+    Unlink(*timer);
+    g_running = timer;
+    HAL_enable_irq(state);
+
+    timer->user_callback(timer->expiry_deadline);
+    g_running = nullptr;
+  }
+}
+
+// Milliseconds until `deadline`, at least 1, at most kMaxPeriodMs
+unsigned DelayMs(SystemClock::time_point deadline) {
+  const int64_t delay_ms =
+      std::chrono::ceil<std::chrono::milliseconds>(deadline -
+                                                   SystemClock::now())
+          .count();
+  return static_cast<unsigned>(std::min(
+      static_cast<int64_t>(kMaxPeriodMs),
+      std::max(static_cast<int64_t>(1), delay_ms)));
+}
+
+#if PW_CHRONO_PARTICLE_TIMER_DISPATCH_THREAD
+
+// The dispatch thread sleeps on `wake` until the earliest deadline;
+// Reprogram() wakes it when an earlier deadline is armed.
+
+void DispatchThread(void*) {
+  Shared& s = shared();
+  while (true) {
+    unsigned wait_ms = CONCURRENT_WAIT_FOREVER;
+    {
+      std::lock_guard lock(s.lock);
+      s.programmed = EarliestDeadline();
+      if (s.programmed != SystemClock::time_point::max()) {
+        wait_ms = DelayMs(s.programmed);
+      }
+    }
+    os_semaphore_take(s.wake, wait_ms, false);
+    {
+      std::lock_guard lock(s.lock);
+      s.programmed = SystemClock::time_point::max();
+    }
+    RunDue();
+  }
+}
+
+void Reprogram() {
+  Shared& s = shared();
+  std::lock_guard lock(s.lock);
+  if (s.thread == nullptr) {
+    PW_CHECK_INT_EQ(os_semaphore_create(&s.wake, 1, 0), 0);
+    const int result = os_thread_create(&s.thread,
+                                        "timer_dispatch",
+                                        kDispatchThreadPriority,
+                                        DispatchThread,
+                                        nullptr,
+                                        kDispatchThreadStackSize);
+    PW_CHECK_INT_EQ(result, 0, "Failed to create timer dispatch thread");
+  }
+  if (EarliestDeadline() < s.programmed) {
+    // A full semaphore already has the thread recompute; ignore failure
+    os_semaphore_give(s.wake, false);
+  }
+}
+
+#else
+
+void Reprogram();
+
+void HandleTimerCallback(os_timer_t) {
+  {
+    std::lock_guard lock(shared().lock);
+    shared().programmed = SystemClock::time_point::max();
+  }
+  RunDue();
+  Reprogram();
+}
+
+// Point the os_timer at the earliest deadline if it changed
+void Reprogram() {
+  Shared& s = shared();
+  std::lock_guard lock(s.lock);
+  const SystemClock::time_point deadline = EarliestDeadline();
+  if (deadline == s.programmed) {
+    return;
+  }
+  if (deadline == SystemClock::time_point::max()) {
+    // Nothing armed: let a pending expiry find an empty list rather than
+    // spending a command on stopping it
+    return;
+  }
+  if (s.timer == nullptr) {
+    const int result =
+        os_timer_create(&s.timer, 1, HandleTimerCallback, nullptr, true,
+                        nullptr);
+    PW_CHECK_INT_EQ(result, 0, "Failed to create timer");
+  }
+
+  // Changing the period also starts a stopped timer; if the deadline is
+  // beyond kMaxPeriodMs the expiry finds nothing due and reprograms
+  os_timer_change(s.timer, OS_TIMER_CHANGE_PERIOD, false, DelayMs(deadline),
+                  0, nullptr);
+  s.programmed = deadline;
+}
+
+#endif  // PW_CHRONO_PARTICLE_TIMER_DISPATCH_THREAD
+
+}  // namespace
+
+SystemTimer::SystemTimer(ExpiryCallback&& callback)
+    : native_type_{.next = nullptr,
+                   .prev = nullptr,
+                   .state = State::kCancelled,
+                   .expiry_deadline = SystemClock::time_point(),
+                   .user_callback = std::move(callback)} {}
+
+SystemTimer::~SystemTimer() {
+  Cancel();
+  // Wait for a callback that is already running
+  while (g_running == &native_type_) {
+    os_thread_yield();
+  }
+}
+
+void SystemTimer::InvokeAt(SystemClock::time_point timestamp) {
+  const int32_t state = HAL_disable_irq();
+  Unlink(native_type_);
+  native_type_.expiry_deadline = timestamp;
+  Link(native_type_);
+  HAL_enable_irq(state);
+  Reprogram();
+}
+
+void SystemTimer::Cancel() {
+  const int32_t state = HAL_disable_irq();
+  Unlink(native_type_);
+  HAL_enable_irq(state);
+}
+
+namespace particle {
+
+Result<SystemClock::time_point> NextTimerDeadline() {
+  return EarliestDeadline();
+}
+
+}  // namespace particle
+
+}  // namespace pw::chrono
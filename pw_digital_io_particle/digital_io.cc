@@ -3,11 +3,16 @@
 
 #include "pb_digital_io/digital_io.h"
 
+#include <utility>
+
 #include "gpio_hal.h"
+#include "interrupts_hal.h"
 #include "pw_assert/check.h"
 
 namespace pb {
 
+using ::pw::digital_io::InterruptHandler;
+using ::pw::digital_io::InterruptTrigger;
 using ::pw::digital_io::State;
 
 // ParticleDigitalIn implementation
@@ -79,4 +84,88 @@ pw::Status ParticleDigitalInOut::DoSetState(State state) {
   return pw::OkStatus();
 }
 
+// ParticleDigitalInInterrupt implementation
+
+ParticleDigitalInInterrupt::~ParticleDigitalInInterrupt() {
+  // The HAL keeps a pointer to this object while attached
+  DoEnableInterruptHandler(false).IgnoreError();
+}
+
+pw::Status ParticleDigitalInInterrupt::DoEnable(bool enable) {
+  PW_CHECK(pin_ < 100, "UNIQUE_STRING_PARTICLE_GPIO_PIN_OUT_OF_RANGE");
+  if (enable && !enabled_) {
+    hal_gpio_mode(pin_, static_cast<PinMode>(mode_));
+    enabled_ = true;
+  } else if (!enable) {
+    DoEnableInterruptHandler(false).IgnoreError();
+    enabled_ = false;
+  }
+  return pw::OkStatus();
+}
+
+pw::Result<State> ParticleDigitalInInterrupt::DoGetState() {
+  if (!enabled_) {
+    return pw::Status::FailedPrecondition();
+  }
+  const int32_t value = hal_gpio_read(pin_);
+  return value != 0 ? State::kActive : State::kInactive;
+}
+
+pw::Status ParticleDigitalInInterrupt::DoSetInterruptHandler(
+    InterruptTrigger trigger, InterruptHandler&& handler) {
+  // The handler runs from the ISR; don't swap it underneath
+  if (attached_) {
+    return pw::Status::FailedPrecondition();
+  }
+  trigger_ = trigger;
+  handler_ = std::move(handler);
+  return pw::OkStatus();
+}
+
+pw::Status ParticleDigitalInInterrupt::DoEnableInterruptHandler(bool enable) {
+  if (!enable) {
+    if (attached_) {
+      hal_interrupt_detach(pin_);
+      attached_ = false;
+    }
+    return pw::OkStatus();
+  }
+  if (!enabled_ || handler_ == nullptr) {
+    return pw::Status::FailedPrecondition();
+  }
+  if (attached_) {
+    return pw::OkStatus();
+  }
+  InterruptMode mode = CHANGE;
+  if (trigger_ == InterruptTrigger::kActivatingEdge) {
+    mode = RISING;
+  } else if (trigger_ == InterruptTrigger::kDeactivatingEdge) {
+    mode = FALLING;
+  }
+  if (hal_interrupt_attach(pin_, &OnInterrupt, this, mode, nullptr) != 0) {
+    return pw::Status::Unavailable();
+  }
+  attached_ = true;
+  return pw::OkStatus();
+}
+
+void ParticleDigitalInInterrupt::OnInterrupt(void* context) {
+  auto& self = *static_cast<ParticleDigitalInInterrupt*>(context);
+  State state;
+  switch (self.trigger_) {
+    case InterruptTrigger::kActivatingEdge:
+      state = State::kActive;
+      break;
+    case InterruptTrigger::kDeactivatingEdge:
+      state = State::kInactive;
+      break;
+    case InterruptTrigger::kBothEdges:
+    default:
+      state = hal_gpio_read(self.pin_) != 0 ? State::kActive
+                                            : State::kInactive;
+      break;
+  }
+  self.handler_(state);
+}
+
 }  // namespace pb
@@ -0,0 +1,162 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_digital_io/edge_waiter.h"
+
+#include <chrono>
+#include <mutex>
+#include <utility>
+
+namespace pb {
+
+using ::pw::digital_io::InterruptTrigger;
+using ::pw::digital_io::State;
+
+// ---------------------------------------------------------------------------
+// EdgeWaiter implementation
+// ---------------------------------------------------------------------------
+
+EdgeWaiter::EdgeWaiter(pw::digital_io::DigitalInInterrupt& line)
+    : line_(line),
+      timer_([this](pw::chrono::SystemClock::time_point) { OnTimeout(); }) {}
+
+EdgeWaiter::~EdgeWaiter() { Finish(); }
+
+EdgeFuture EdgeWaiter::WaitForEdge(InterruptTrigger trigger,
+                                   uint32_t timeout_ms) {
+  {
+    std::lock_guard lock(lock_);
+    if (waiting_) {
+      return EdgeFuture(nullptr, pw::Status::FailedPrecondition());
+    }
+    waiting_ = true;
+    edge_seen_ = false;
+    timed_out_ = false;
+  }
+
+  // Backends only accept a new handler while the current one is disabled
+  line_.DisableInterruptHandler().IgnoreError();
+  pw::Status status = line_.SetInterruptHandler(
+      trigger, [this](State state) { OnEdge(state); });
+  if (status.ok()) {
+    status = line_.EnableInterruptHandler();
+  }
+  if (!status.ok()) {
+    Finish();
+    return EdgeFuture(nullptr, status);
+  }
+
+  if (timeout_ms != EdgeFuture::kNoTimeout) {
+    timer_.InvokeAfter(std::chrono::milliseconds(timeout_ms));
+  }
+  return EdgeFuture(this, pw::OkStatus());
+}
+
+void EdgeWaiter::OnEdge(State state) {
+  pw::async2::Waker waker;
+  {
+    std::lock_guard lock(lock_);
+    if (!waiting_ || edge_seen_) {
+      return;  // Only the first edge counts
+    }
+    edge_seen_ = true;
+    state_ = state;
+    waker = std::move(waker_);
+  }
+  waker.Wake();
+}
+
+void EdgeWaiter::OnTimeout() {
+  pw::async2::Waker waker;
+  {
+    std::lock_guard lock(lock_);
+    if (!waiting_ || edge_seen_) {
+      return;
+    }
+    timed_out_ = true;
+    waker = std::move(waker_);
+  }
+  waker.Wake();
+}
+
+pw::async2::Poll<EdgeFuture::value_type> EdgeWaiter::PendEdge(
+    pw::async2::Context& cx) {
+  EdgeFuture::value_type result = pw::Status::DeadlineExceeded();
+  {
+    std::lock_guard lock(lock_);
+    if (edge_seen_) {
+      result = state_;
+    } else if (!timed_out_) {
+      PW_ASYNC_STORE_WAKER(cx, waker_, "Waiting for GPIO edge");
+      return pw::async2::Pending();
+    }
+  }
+  Finish();
+  return pw::async2::Ready(result);
+}
+
+void EdgeWaiter::Finish() {
+  {
+    std::lock_guard lock(lock_);
+    if (!waiting_) {
+      return;
+    }
+  }
+  timer_.Cancel();
+  line_.DisableInterruptHandler().IgnoreError();
+  std::lock_guard lock(lock_);
+  waiting_ = false;
+  waker_ = pw::async2::Waker();
+}
+
+// ---------------------------------------------------------------------------
+// EdgeFuture implementation
+// ---------------------------------------------------------------------------
+
+EdgeFuture::EdgeFuture(EdgeFuture&& other) noexcept
+    : waiter_(other.waiter_),
+      start_status_(other.start_status_),
+      completed_(other.completed_) {
+  other.waiter_ = nullptr;
+  other.completed_ = true;
+}
+
+EdgeFuture& EdgeFuture::operator=(EdgeFuture&& other) noexcept {
+  if (this != &other) {
+    if (waiter_ != nullptr) {
+      waiter_->Finish();
+    }
+    waiter_ = other.waiter_;
+    start_status_ = other.start_status_;
+    completed_ = other.completed_;
+
+    other.waiter_ = nullptr;
+    other.completed_ = true;
+  }
+  return *this;
+}
+
+EdgeFuture::~EdgeFuture() {
+  if (waiter_ != nullptr) {
+    waiter_->Finish();
+  }
+}
+
+pw::async2::Poll<EdgeFuture::value_type> EdgeFuture::Pend(
+    pw::async2::Context& cx) {
+  if (completed_) {
+    return pw::async2::Ready(pw::Status::FailedPrecondition());
+  }
+  if (waiter_ == nullptr) {
+    completed_ = true;
+    return pw::async2::Ready(start_status_);
+  }
+  pw::async2::Poll<value_type> result = waiter_->PendEdge(cx);
+  if (result.IsReady()) {
+    waiter_ = nullptr;
+    completed_ = true;
+  }
+  return result;
+}
+
+}  // namespace pb
@@ -0,0 +1,165 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_digital_io/fast_gpio.h"
+
+#include "gpio_hal.h"
+#include "pinmap_hal.h"
+
+namespace pb {
+namespace internal {
+namespace {
+
+// RTL872x GPIO block (rtl8721d_gpio.h): per port a data register, a
+// direction register and a control register (12 bytes), then the external
+// (input) port registers from offset 0x50. hal_gpio_mode() has already set
+// direction and pin function, so only data and input are touched here.
+constexpr uintptr_t kGpioBase = 0x48014000;
+constexpr uintptr_t kPortStride = 0x0C;
+constexpr uintptr_t kExtPortOffset = 0x50;
+constexpr uint8_t kPortCount = 2;  // RTL_PORT_A, RTL_PORT_B
+
+volatile uint32_t* Register(uintptr_t address) {
+  // NOLINTNEXTLINE(performance-no-int-to-ptr)
+  return reinterpret_cast<volatile uint32_t*>(address);
+}
+
+struct PortBit {
+  uint8_t port;
+  uint8_t bit;
+};
+
+pw::Result<PortBit> Lookup(hal_pin_t pin) {
+  if (pin >= TOTAL_PINS) {
+    return pw::Status::InvalidArgument();
+  }
+  const hal_pin_info_t& info = hal_pin_map()[pin];
+  if (info.gpio_port >= kPortCount || info.gpio_pin >= 32) {
+    return pw::Status::InvalidArgument();
+  }
+  return PortBit{info.gpio_port, info.gpio_pin};
+}
+
+FastGpio PortRegisters(uint8_t port) {
+  FastGpio gpio;
+  gpio.data = Register(kGpioBase + port * kPortStride);
+  gpio.input = Register(kGpioBase + kExtPortOffset + port * 4);
+  return gpio;
+}
+
+}  // namespace
+
+pw::Result<FastGpio> ResolveFastGpio(hal_pin_t pin) {
+  const pw::Result<PortBit> location = Lookup(pin);
+  if (!location.ok()) {
+    return location.status();
+  }
+  FastGpio gpio = PortRegisters(location->port);
+  gpio.mask = 1u << location->bit;
+  return gpio;
+}
+
+pw::Status ResolveFastGpioPort(pw::span<const hal_pin_t> pins,
+                               pw::span<uint32_t> masks, FastGpio& gpio) {
+  if (pins.empty() || masks.size() < pins.size()) {
+    return pw::Status::InvalidArgument();
+  }
+  uint8_t port = 0;
+  uint32_t port_mask = 0;
+  for (size_t i = 0; i < pins.size(); ++i) {
+    const pw::Result<PortBit> location = Lookup(pins[i]);
+    if (!location.ok()) {
+      return location.status();
+    }
+    if (i == 0) {
+      port = location->port;
+    } else if (location->port != port) {
+      return pw::Status::InvalidArgument();
+    }
+    masks[i] = 1u << location->bit;
+    port_mask |= masks[i];
+  }
+  for (const hal_pin_t pin : pins) {
+    hal_gpio_mode(pin, OUTPUT);
+  }
+  gpio = PortRegisters(port);
+  gpio.mask = port_mask;
+  return pw::OkStatus();
+}
+
+}  // namespace internal
+
+using ::pw::digital_io::State;
+
+namespace {
+
+// Shared Enable() logic: set the mode through the HAL once, then cache the
+// registers for the fast accessors
+pw::Status EnablePin(hal_pin_t pin, PinMode mode, FastGpio& gpio,
+                     bool& enabled, bool enable) {
+  if (enable && !enabled) {
+    const pw::Result<FastGpio> resolved = internal::ResolveFastGpio(pin);
+    if (!resolved.ok()) {
+      return resolved.status();
+    }
+    hal_gpio_mode(pin, mode);
+    gpio = *resolved;
+    enabled = true;
+  } else if (!enable) {
+    enabled = false;
+  }
+  return pw::OkStatus();
+}
+
+}  // namespace
+
+// ParticleFastDigitalOut implementation
+
+pw::Status ParticleFastDigitalOut::DoEnable(bool enable) {
+  return EnablePin(pin_, OUTPUT, gpio_, enabled_, enable);
+}
+
+pw::Status ParticleFastDigitalOut::DoSetState(State state) {
+  if (!enabled_) {
+    return pw::Status::FailedPrecondition();
+  }
+  gpio_.Write(state == State::kActive);
+  return pw::OkStatus();
+}
+
+// ParticleFastDigitalIn implementation
+
+pw::Status ParticleFastDigitalIn::DoEnable(bool enable) {
+  return EnablePin(pin_, static_cast<PinMode>(mode_), gpio_, enabled_,
+                   enable);
+}
+
+pw::Result<State> ParticleFastDigitalIn::DoGetState() {
+  if (!enabled_) {
+    return pw::Status::FailedPrecondition();
+  }
+  return gpio_.Read() ? State::kActive : State::kInactive;
+}
+
+// ParticleFastDigitalInOut implementation
+
+pw::Status ParticleFastDigitalInOut::DoEnable(bool enable) {
+  return EnablePin(pin_, OUTPUT, gpio_, enabled_, enable);
+}
+
+pw::Result<State> ParticleFastDigitalInOut::DoGetState() {
+  if (!enabled_) {
+    return pw::Status::FailedPrecondition();
+  }
+  return gpio_.Read() ? State::kActive : State::kInactive;
+}
+
+pw::Status ParticleFastDigitalInOut::DoSetState(State state) {
+  if (!enabled_) {
+    return pw::Status::FailedPrecondition();
+  }
+  gpio_.Write(state == State::kActive);
+  return pw::OkStatus();
+}
+
+}  // namespace pb
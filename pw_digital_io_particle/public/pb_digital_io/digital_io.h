@@ -66,4 +66,40 @@ class ParticleDigitalInOut : public pw::digital_io::DigitalInOut {
   bool enabled_ = false;
 };
 
+// Pigweed DigitalInInterrupt backend for Particle.
+// Reads like ParticleDigitalIn; the handler is attached with
+// hal_interrupt_attach() while the interrupt handler is enabled.
+//
+// The handler runs in interrupt context and receives the state implied by
+// the edge (kActive for a rising edge, kInactive for a falling edge; the
+// pin is sampled for kBothEdges). Keep it short, e.g. release a
+// ThreadNotification or wake an async2 task.
+class ParticleDigitalInInterrupt : public pw::digital_io::DigitalInInterrupt {
+ public:
+  using Mode = ParticleDigitalIn::Mode;
+
+  ParticleDigitalInInterrupt(hal_pin_t pin, Mode mode = Mode::kInput)
+      : pin_(pin), mode_(mode) {}
+
+  ~ParticleDigitalInInterrupt() override;
+
+ private:
+  pw::Status DoEnable(bool enable) override;
+  pw::Result<pw::digital_io::State> DoGetState() override;
+  pw::Status DoSetInterruptHandler(
+      pw::digital_io::InterruptTrigger trigger,
+      pw::digital_io::InterruptHandler&& handler) override;
+  pw::Status DoEnableInterruptHandler(bool enable) override;
+
+  static void OnInterrupt(void* context);
+
+  hal_pin_t pin_;
+  Mode mode_;
+  bool enabled_ = false;
+  bool attached_ = false;
+  pw::digital_io::InterruptTrigger trigger_ =
+      pw::digital_io::InterruptTrigger::kBothEdges;
+  pw::digital_io::InterruptHandler handler_;
+};
+
 }  // namespace pb
@@ -0,0 +1,113 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstdint>
+
+#include "pw_async2/context.h"
+#include "pw_async2/poll.h"
+#include "pw_async2/waker.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_chrono/system_timer.h"
+#include "pw_digital_io/digital_io.h"
+#include "pw_result/result.h"
+#include "pw_sync/interrupt_spin_lock.h"
+
+namespace pb {
+
+class EdgeWaiter;
+
+/// Future returned by EdgeWaiter::WaitForEdge().
+///
+/// Completes with the state after the edge (see
+/// pw::digital_io::InterruptHandler), DeadlineExceeded when the timeout
+/// expires first, or FailedPrecondition if the wait could not start.
+/// Destroying the future stops waiting.
+class EdgeFuture {
+ public:
+  using value_type = pw::Result<pw::digital_io::State>;
+
+  /// No timeout (wait indefinitely)
+  static constexpr uint32_t kNoTimeout = 0;
+
+  EdgeFuture() = default;
+  EdgeFuture(EdgeFuture&& other) noexcept;
+  EdgeFuture& operator=(EdgeFuture&& other) noexcept;
+  ~EdgeFuture();
+
+  EdgeFuture(const EdgeFuture&) = delete;
+  EdgeFuture& operator=(const EdgeFuture&) = delete;
+
+  pw::async2::Poll<value_type> Pend(pw::async2::Context& cx);
+
+  /// Returns true if the future has completed.
+  [[nodiscard]] bool is_complete() const { return completed_; }
+
+ private:
+  friend class EdgeWaiter;
+
+  EdgeFuture(EdgeWaiter* waiter, pw::Status start_status)
+      : waiter_(waiter), start_status_(start_status) {}
+
+  EdgeWaiter* waiter_ = nullptr;  // Set while waiting
+  pw::Status start_status_;
+  bool completed_ = false;
+};
+
+/// Awaits edges of an interrupt-capable input from pw_async2 tasks.
+///
+/// Takes over the interrupt handler of `line` while a wait is pending, so
+/// e.g. a PN532 IRQ or an accelerometer INT pin can be awaited next to
+/// AsyncUart reads instead of polling GetState():
+///
+/// @code
+///   pb::ParticleDigitalInInterrupt irq(D4);
+///   pb::EdgeWaiter irq_waiter(irq);
+///
+///   irq.Enable();
+///   auto edge = co_await irq_waiter.WaitForEdge(
+///       pw::digital_io::InterruptTrigger::kDeactivatingEdge, 100);
+/// @endcode
+///
+/// The interrupt is armed when WaitForEdge() returns, so an edge between
+/// creating the future and the first Pend() is not missed. One wait at a
+/// time. `line` must be enabled and outlive the waiter.
+class EdgeWaiter {
+ public:
+  explicit EdgeWaiter(pw::digital_io::DigitalInInterrupt& line);
+  ~EdgeWaiter();
+
+  EdgeWaiter(const EdgeWaiter&) = delete;
+  EdgeWaiter& operator=(const EdgeWaiter&) = delete;
+
+  /// Wait for the next `trigger` edge.
+  ///
+  /// @param timeout_ms Timeout in milliseconds, or EdgeFuture::kNoTimeout
+  EdgeFuture WaitForEdge(pw::digital_io::InterruptTrigger trigger,
+                         uint32_t timeout_ms = EdgeFuture::kNoTimeout);
+
+ private:
+  friend class EdgeFuture;
+
+  void OnEdge(pw::digital_io::State state);  // Interrupt context
+  void OnTimeout();                          // Timer context
+  pw::async2::Poll<EdgeFuture::value_type> PendEdge(pw::async2::Context& cx);
+  void Finish();
+
+  pw::digital_io::DigitalInInterrupt& line_;
+
+  // Shared with the interrupt and the timer - protected by lock_
+  pw::sync::InterruptSpinLock lock_;
+  bool waiting_ = false;
+  bool edge_seen_ = false;
+  bool timed_out_ = false;
+  pw::digital_io::State state_ = pw::digital_io::State::kInactive;
+  pw::async2::Waker waker_;
+
+  // Declared last so it is cancelled before the state its callback touches
+  // goes away.
+  pw::chrono::SystemTimer timer_;
+};
+
+}  // namespace pb
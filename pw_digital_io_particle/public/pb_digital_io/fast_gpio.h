@@ -0,0 +1,184 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/// @file fast_gpio.h
+/// @brief GPIO with direct register access for bit-banging.
+///
+/// hal_gpio_write() and hal_gpio_read() are dynalib calls that look the pin
+/// up and check its mode on every access. The classes here resolve the pin
+/// to its port registers and bit once in Enable(); after that a write is a
+/// read-modify-write of the port data register and a read is one load.
+///
+/// The read-modify-write is not atomic: an interrupt that writes another
+/// pin of the same port in between can be lost. Keep pins shared with
+/// interrupt handlers on a different port, or use the hal_gpio classes in
+/// digital_io.h for them.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_digital_io/digital_io.h"
+#include "pw_result/result.h"
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+
+// Forward declarations for Particle types (avoid including full headers)
+typedef uint16_t hal_pin_t;
+
+namespace pb {
+
+/// Registers and bit of one resolved pin.
+struct FastGpio {
+  volatile uint32_t* data = nullptr;   // Output data register
+  volatile uint32_t* input = nullptr;  // External port (input) register
+  uint32_t mask = 0;
+
+  void Set() const { *data = *data | mask; }
+  void Clear() const { *data = *data & ~mask; }
+  void Write(bool high) const { high ? Set() : Clear(); }
+  void Toggle() const { *data = *data ^ mask; }
+  bool Read() const { return (*input & mask) != 0; }
+};
+
+namespace internal {
+
+/// Resolve `pin` to its port registers and bit. InvalidArgument for a pin
+/// without GPIO function.
+pw::Result<FastGpio> ResolveFastGpio(hal_pin_t pin);
+
+/// Configure `pins` as outputs and resolve them into one port: `gpio`
+/// gets the port's registers and the mask of all pins, `masks[i]` the bit
+/// of `pins[i]`. InvalidArgument if the pins are not all on one port.
+pw::Status ResolveFastGpioPort(pw::span<const hal_pin_t> pins,
+                               pw::span<uint32_t> masks, FastGpio& gpio);
+
+}  // namespace internal
+
+/// Like ParticleDigitalOut, with register writes.
+///
+/// Set(), Clear() and Toggle() are inline and skip the enabled check and
+/// the virtual call; use them in tight loops after Enable().
+class ParticleFastDigitalOut : public pw::digital_io::DigitalOut {
+ public:
+  explicit ParticleFastDigitalOut(hal_pin_t pin) : pin_(pin) {}
+
+  void Set() { gpio_.Set(); }
+  void Clear() { gpio_.Clear(); }
+  void Toggle() { gpio_.Toggle(); }
+
+ private:
+  pw::Status DoEnable(bool enable) override;
+  pw::Status DoSetState(pw::digital_io::State state) override;
+
+  hal_pin_t pin_;
+  FastGpio gpio_;
+  bool enabled_ = false;
+};
+
+/// Like ParticleDigitalIn, with register reads.
+class ParticleFastDigitalIn : public pw::digital_io::DigitalIn {
+ public:
+  // Pin modes from Particle SDK
+  enum class Mode : uint8_t {
+    kInput = 0,          // INPUT
+    kInputPullup = 2,    // INPUT_PULLUP
+    kInputPulldown = 3,  // INPUT_PULLDOWN
+  };
+
+  ParticleFastDigitalIn(hal_pin_t pin, Mode mode = Mode::kInput)
+      : pin_(pin), mode_(mode) {}
+
+  /// Unchecked read; call after Enable().
+  bool Read() const { return gpio_.Read(); }
+
+ private:
+  pw::Status DoEnable(bool enable) override;
+  pw::Result<pw::digital_io::State> DoGetState() override;
+
+  hal_pin_t pin_;
+  Mode mode_;
+  FastGpio gpio_;
+  bool enabled_ = false;
+};
+
+/// Like ParticleDigitalInOut, with register access.
+class ParticleFastDigitalInOut : public pw::digital_io::DigitalInOut {
+ public:
+  explicit ParticleFastDigitalInOut(hal_pin_t pin) : pin_(pin) {}
+
+  void Set() { gpio_.Set(); }
+  void Clear() { gpio_.Clear(); }
+  void Toggle() { gpio_.Toggle(); }
+  bool Read() const { return gpio_.Read(); }
+
+ private:
+  pw::Status DoEnable(bool enable) override;
+  pw::Result<pw::digital_io::State> DoGetState() override;
+  pw::Status DoSetState(pw::digital_io::State state) override;
+
+  hal_pin_t pin_;
+  FastGpio gpio_;
+  bool enabled_ = false;
+};
+
+/// Up to 32 output pins of one GPIO port, written together.
+///
+/// Write() changes all pins with a single store to the port data register,
+/// so e.g. the data lines of a parallel bus or an LED matrix row change at
+/// the same instant. Bit i of the value drives `pins[i]`.
+template <size_t kPins>
+class ParticleDigitalPortOut {
+ public:
+  static_assert(kPins > 0 && kPins <= 32);
+
+  explicit ParticleDigitalPortOut(const std::array<hal_pin_t, kPins>& pins)
+      : pins_(pins) {}
+
+  /// Configure the pins as outputs. InvalidArgument if they are not all on
+  /// one port.
+  pw::Status Enable() {
+    const pw::Status status =
+        internal::ResolveFastGpioPort(pins_, masks_, gpio_);
+    enabled_ = status.ok();
+    return status;
+  }
+
+  /// Drive pin i to bit i of `values`. Unchecked; call after Enable().
+  void Write(uint32_t values) {
+    uint32_t set = 0;
+    for (size_t i = 0; i < kPins; ++i) {
+      if ((values >> i) & 1u) {
+        set |= masks_[i];
+      }
+    }
+    *gpio_.data = (*gpio_.data & ~gpio_.mask) | set;
+  }
+
+  /// Drive the pins whose bit is set in `pins` high (Set) or low (Clear);
+  /// the others keep their level.
+  void Set(uint32_t pins) { *gpio_.data = *gpio_.data | PortMask(pins); }
+  void Clear(uint32_t pins) { *gpio_.data = *gpio_.data & ~PortMask(pins); }
+
+  bool enabled() const { return enabled_; }
+
+ private:
+  uint32_t PortMask(uint32_t pins) const {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kPins; ++i) {
+      if ((pins >> i) & 1u) {
+        mask |= masks_[i];
+      }
+    }
+    return mask;
+  }
+
+  std::array<hal_pin_t, kPins> pins_;
+  std::array<uint32_t, kPins> masks_{};
+  FastGpio gpio_;
+  bool enabled_ = false;
+};
+
+}  // namespace pb
@@ -0,0 +1,31 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pb_spi/chip_selector.h"
+
+#include "fast_pin.h"
+#include "gpio_hal.h"
+
+namespace pb {
+
+pw::Status ParticleChipSelector::Enable() {
+  if (!enabled_) {
+    hal_gpio_mode(pin_, OUTPUT);
+    enabled_ = true;
+  }
+  return SetActive(false);
+}
+
+pw::Status ParticleChipSelector::SetActive(bool active) {
+  if (!enabled_) {
+    return pw::Status::FailedPrecondition();
+  }
+  if (active != active_low_) {
+    pinSetFast(pin_);
+  } else {
+    pinResetFast(pin_);
+  }
+  return pw::OkStatus();
+}
+
+}  // namespace pb
@@ -3,6 +3,11 @@
 
 #include "pb_spi/initiator.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+
+#include "pb_spi/config.h"
 #include "pw_assert/check.h"
 #include "pw_log/log.h"
 #include "spi_hal.h"
@@ -48,6 +53,10 @@ size_t InterfaceIndex(ParticleSpiInitiator::Interface interface) {
   return static_cast<size_t>(interface);
 }
 
+bool IsDmaAligned(const std::byte* data) {
+  return reinterpret_cast<uintptr_t>(data) % kSpiDmaAlignment == 0;
+}
+
 }  // namespace
 
 // Static DMA completion callbacks - route to the registered instance.
@@ -56,19 +65,19 @@ size_t InterfaceIndex(ParticleSpiInitiator::Interface interface) {
 // from the class-static registry.
 void ParticleSpiInitiator::DmaCallback0() {
   if (active_instances_[0] != nullptr) {
-    active_instances_[0]->dma_complete_.release();
+    active_instances_[0]->OnDmaComplete();
   }
 }
 
 void ParticleSpiInitiator::DmaCallback1() {
   if (active_instances_[1] != nullptr) {
-    active_instances_[1]->dma_complete_.release();
+    active_instances_[1]->OnDmaComplete();
   }
 }
 
 void ParticleSpiInitiator::DmaCallback2() {
   if (active_instances_[2] != nullptr) {
-    active_instances_[2]->dma_complete_.release();
+    active_instances_[2]->OnDmaComplete();
   }
 }
 
@@ -84,6 +93,26 @@ void (*ParticleSpiInitiator::GetDmaCallback(Interface interface))() {
   PW_UNREACHABLE;
 }
 
+void ParticleSpiInitiator::OnDmaComplete() {
+  pw::async2::Waker waker;
+  {
+    std::lock_guard lock(async_lock_);
+    if (!queue_.empty()) {
+      FinishTransaction(queue_[queue_index_++]);
+      if (StartNextTransaction()) {
+        return;  // Next entry already on the wire
+      }
+    }
+    if (!async_active_) {
+      dma_complete_.release();
+      return;
+    }
+    async_done_ = true;
+    waker = std::move(async_waker_);
+  }
+  waker.Wake();
+}
+
 ParticleSpiInitiator::ParticleSpiInitiator(
     Interface interface, uint32_t clock_hz, SpiFlags flags
 )
@@ -131,15 +160,18 @@ pw::Status ParticleSpiInitiator::DoConfigure(const pw::spi::Config& config) {
     initialized_ = true;
   }
 
-  // Calculate clock divider from target frequency
-  const int divider =
-      hal_spi_get_clock_divider(hal_interface, clock_hz_, nullptr);
-  if (divider < 0) {
-    PW_LOG_ERROR(
-        "Failed to calculate SPI clock divider for %u Hz",
-        static_cast<unsigned>(clock_hz_)
-    );
-    return pw::Status::InvalidArgument();
+  // Calculate clock divider from target frequency. clock_hz_ is fixed, so
+  // this is done once.
+  if (clock_divider_ < 0) {
+    clock_divider_ =
+        hal_spi_get_clock_divider(hal_interface, clock_hz_, nullptr);
+    if (clock_divider_ < 0) {
+      PW_LOG_ERROR(
+          "Failed to calculate SPI clock divider for %u Hz",
+          static_cast<unsigned>(clock_hz_)
+      );
+      return pw::Status::InvalidArgument();
+    }
   }
 
   // Convert config to HAL parameters
@@ -147,11 +179,18 @@ pw::Status ParticleSpiInitiator::DoConfigure(const pw::spi::Config& config) {
       (config.bit_order == pw::spi::BitOrder::kMsbFirst) ? MSBFIRST : LSBFIRST;
   const uint8_t spi_mode = ToHalSpiMode(config.polarity, config.phase);
 
+  // pw::spi::Device configures before every transaction; devices sharing
+  // a bus usually agree, so skip the HAL call when nothing changed
+  if (settings_applied_ && bit_order == applied_bit_order_ &&
+      spi_mode == applied_mode_) {
+    return pw::OkStatus();
+  }
+
   // Apply settings (set_default=0 means apply immediately)
   const int32_t result = hal_spi_set_settings(
       hal_interface,
       /*set_default=*/0,
-      static_cast<uint8_t>(divider),
+      static_cast<uint8_t>(clock_divider_),
       bit_order,
       spi_mode,
       nullptr
@@ -161,38 +200,106 @@ pw::Status ParticleSpiInitiator::DoConfigure(const pw::spi::Config& config) {
     PW_LOG_ERROR(
         "hal_spi_set_settings failed with %d", static_cast<int>(result)
     );
+    settings_applied_ = false;
     return pw::Status::Internal();
   }
 
+  settings_applied_ = true;
+  applied_bit_order_ = bit_order;
+  applied_mode_ = spi_mode;
   return pw::OkStatus();
 }
 
-pw::Status ParticleSpiInitiator::DoWriteRead(
+void ParticleSpiInitiator::TransferPolled(
     pw::ConstByteSpan write_buffer, pw::ByteSpan read_buffer
 ) {
-  if (!initialized_) {
-    return pw::Status::FailedPrecondition();
-  }
-
   const hal_spi_interface_t hal_interface = ToHalInterface(interface_);
+  const size_t transfer_len = std::max(write_buffer.size(), read_buffer.size());
+  for (size_t i = 0; i < transfer_len; ++i) {
+    // Same padding as DMA: 0x00 once the write buffer is exhausted
+    const uint16_t out =
+        i < write_buffer.size() ? static_cast<uint8_t>(write_buffer[i]) : 0;
+    const uint16_t in = hal_spi_transfer(hal_interface, out);
+    if (i < read_buffer.size()) {
+      read_buffer[i] = static_cast<std::byte>(in);
+    }
+  }
+}
 
+bool ParticleSpiInitiator::StartDma(
+    pw::ConstByteSpan write_buffer, pw::ByteSpan read_buffer
+) {
   // Determine transfer length (max of write and read)
   const size_t transfer_len = std::max(write_buffer.size(), read_buffer.size());
 
   if (transfer_len == 0) {
-    return pw::OkStatus();
+    return false;
+  }
+
+  const std::byte* tx = write_buffer.empty() ? nullptr : write_buffer.data();
+  std::byte* rx = read_buffer.empty() ? nullptr : read_buffer.data();
+
+  if (tx != nullptr && !IsDmaAligned(tx)) {
+    if (write_buffer.size() <= bounce_write_.size()) {
+      std::copy(write_buffer.begin(), write_buffer.end(),
+                bounce_write_.begin());
+      tx = bounce_write_.data();
+      ++bounce_stats_.bounced_writes;
+    } else {
+      ++bounce_stats_.unbounced;
+    }
+  }
+  // The cache is invalidated in whole lines, so a read also needs a
+  // length that is a multiple of the line size
+  if (rx != nullptr &&
+      (!IsDmaAligned(rx) || read_buffer.size() % kSpiDmaAlignment != 0)) {
+    if (read_buffer.size() <= bounce_read_.size()) {
+      bounced_read_target_ = read_buffer;
+      rx = bounce_read_.data();
+      ++bounce_stats_.bounced_reads;
+    } else {
+      ++bounce_stats_.unbounced;
+    }
   }
 
   // Start DMA transfer
   // Note: For write-only transfers (display), rx_buffer is nullptr
   // For read-only transfers, tx_buffer can be nullptr (will send 0x00)
   hal_spi_transfer_dma(
-      hal_interface,
-      write_buffer.empty() ? nullptr : write_buffer.data(),
-      read_buffer.empty() ? nullptr : read_buffer.data(),
+      ToHalInterface(interface_),
+      tx,
+      rx,
       static_cast<uint32_t>(transfer_len),
       GetDmaCallback(interface_)
   );
+  return true;
+}
+
+void ParticleSpiInitiator::CompleteDma() {
+  if (!bounced_read_target_.empty()) {
+    std::copy_n(bounce_read_.begin(), bounced_read_target_.size(),
+                bounced_read_target_.begin());
+    bounced_read_target_ = {};
+  }
+}
+
+pw::Status ParticleSpiInitiator::DoWriteRead(
+    pw::ConstByteSpan write_buffer, pw::ByteSpan read_buffer
+) {
+  if (!initialized_ || busy_.exchange(true, std::memory_order_acquire)) {
+    return pw::Status::FailedPrecondition();
+  }
+
+  const size_t transfer_len = std::max(write_buffer.size(), read_buffer.size());
+  if (transfer_len <= spi::config::kPolledTransferMaxBytes) {
+    TransferPolled(write_buffer, read_buffer);
+    busy_.store(false, std::memory_order_release);
+    return pw::OkStatus();
+  }
+  if (!StartDma(write_buffer, read_buffer)) {
+    busy_.store(false, std::memory_order_release);
+    return pw::OkStatus();
+  }
 
   // Calculate timeout based on transfer size and clock frequency.
   // Time = (bytes * 8 bits) / clock_hz, with 2x margin + 10ms minimum overhead.
@@ -204,18 +311,228 @@ pw::Status ParticleSpiInitiator::DoWriteRead(
       std::chrono::milliseconds(timeout_ms)
   );
 
+  pw::Status status = pw::OkStatus();
   if (!dma_complete_.try_acquire_for(dma_timeout)) {
     PW_LOG_ERROR("SPI DMA transfer timed out");
-    hal_spi_transfer_dma_cancel(hal_interface);
+    hal_spi_transfer_dma_cancel(ToHalInterface(interface_));
 
     // Drain any stale semaphore releases from previous timed-out transfers.
     dma_complete_.try_acquire();
 
     // Late callback will be drained at start of next transfer
-    return pw::Status::DeadlineExceeded();
+    status = pw::Status::DeadlineExceeded();
+    bounced_read_target_ = {};
+  } else {
+    CompleteDma();
   }
 
-  return pw::OkStatus();
+  busy_.store(false, std::memory_order_release);
+  return status;
+}
+
+SpiTransferFuture ParticleSpiInitiator::WriteReadAsync(
+    pw::ConstByteSpan write_buffer, pw::ByteSpan read_buffer
+) {
+  if (!initialized_ || busy_.exchange(true, std::memory_order_acquire)) {
+    return SpiTransferFuture(nullptr, pw::Status::FailedPrecondition());
+  }
+  {
+    std::lock_guard lock(async_lock_);
+    async_active_ = true;
+    async_done_ = false;
+  }
+  if (!StartDma(write_buffer, read_buffer)) {
+    CancelAsync();
+    return SpiTransferFuture(nullptr, pw::OkStatus());
+  }
+  return SpiTransferFuture(this, pw::OkStatus());
+}
+
+pw::async2::Poll<pw::Status> ParticleSpiInitiator::PendAsync(
+    pw::async2::Context& cx
+) {
+  {
+    std::lock_guard lock(async_lock_);
+    if (!async_done_) {
+      PW_ASYNC_STORE_WAKER(cx, async_waker_, "Waiting for SPI DMA");
+      return pw::async2::Pending();
+    }
+    async_active_ = false;
+  }
+  CompleteDma();
+  busy_.store(false, std::memory_order_release);
+  return pw::async2::Ready(pw::OkStatus());
+}
+
+void ParticleSpiInitiator::CancelAsync() {
+  bool in_flight;
+  {
+    std::lock_guard lock(async_lock_);
+    in_flight = async_active_ && !async_done_;
+    AbortQueue();
+    async_active_ = false;
+    async_waker_ = pw::async2::Waker();
+  }
+  if (in_flight) {
+    hal_spi_transfer_dma_cancel(ToHalInterface(interface_));
+  }
+  busy_.store(false, std::memory_order_release);
+}
+
+bool ParticleSpiInitiator::StartNextTransaction() {
+  while (queue_index_ < queue_.size()) {
+    SpiTransaction& transaction = queue_[queue_index_];
+    if (transaction.chip_select != nullptr) {
+      transaction.chip_select->Activate().IgnoreError();
+    }
+    if (StartDma(transaction.write_buffer, transaction.read_buffer)) {
+      return true;
+    }
+    FinishTransaction(transaction);
+    ++queue_index_;
+  }
+  queue_ = {};
+  return false;
+}
+
+void ParticleSpiInitiator::FinishTransaction(SpiTransaction& transaction) {
+  CompleteDma();
+  if (transaction.chip_select != nullptr && !transaction.keep_selected) {
+    transaction.chip_select->Deactivate().IgnoreError();
+  }
+  if (transaction.on_complete != nullptr) {
+    transaction.on_complete(transaction.context);
+  }
+}
+
+void ParticleSpiInitiator::AbortQueue() {
+  if (queue_index_ < queue_.size() &&
+      queue_[queue_index_].chip_select != nullptr) {
+    queue_[queue_index_].chip_select->Deactivate().IgnoreError();
+  }
+  queue_ = {};
+  bounced_read_target_ = {};
+}
+
+pw::Status ParticleSpiInitiator::Transfer(
+    pw::span<SpiTransaction> transactions
+) {
+  if (!initialized_ || busy_.exchange(true, std::memory_order_acquire)) {
+    return pw::Status::FailedPrecondition();
+  }
+
+  size_t total_len = 0;
+  for (const SpiTransaction& transaction : transactions) {
+    total_len += std::max(transaction.write_buffer.size(),
+                          transaction.read_buffer.size());
+  }
+
+  bool started;
+  {
+    std::lock_guard lock(async_lock_);
+    queue_ = transactions;
+    queue_index_ = 0;
+    started = StartNextTransaction();
+  }
+  if (!started) {
+    busy_.store(false, std::memory_order_release);
+    return pw::OkStatus();
+  }
+
+  // Same budget as DoWriteRead(), over all entries, plus 1 ms per entry
+  const uint32_t transfer_time_us =
+      static_cast<uint32_t>((total_len * 8 * 1'000'000) / clock_hz_);
+  const uint32_t timeout_ms = std::max<uint32_t>(
+      transfer_time_us / 500 + transactions.size(), 10);
+  const auto dma_timeout = pw::chrono::SystemClock::for_at_least(
+      std::chrono::milliseconds(timeout_ms)
+  );
+
+  pw::Status status = pw::OkStatus();
+  if (!dma_complete_.try_acquire_for(dma_timeout)) {
+    PW_LOG_ERROR("SPI transaction queue timed out");
+    {
+      std::lock_guard lock(async_lock_);
+      AbortQueue();
+    }
+    hal_spi_transfer_dma_cancel(ToHalInterface(interface_));
+    dma_complete_.try_acquire();
+    status = pw::Status::DeadlineExceeded();
+  }
+
+  busy_.store(false, std::memory_order_release);
+  return status;
+}
+
+SpiTransferFuture ParticleSpiInitiator::TransferAsync(
+    pw::span<SpiTransaction> transactions
+) {
+  if (!initialized_ || busy_.exchange(true, std::memory_order_acquire)) {
+    return SpiTransferFuture(nullptr, pw::Status::FailedPrecondition());
+  }
+  bool started;
+  {
+    std::lock_guard lock(async_lock_);
+    async_active_ = true;
+    async_done_ = false;
+    queue_ = transactions;
+    queue_index_ = 0;
+    started = StartNextTransaction();
+  }
+  if (!started) {
+    CancelAsync();
+    return SpiTransferFuture(nullptr, pw::OkStatus());
+  }
+  return SpiTransferFuture(this, pw::OkStatus());
+}
+
+SpiTransferFuture::SpiTransferFuture(SpiTransferFuture&& other) noexcept
+    : initiator_(other.initiator_),
+      start_status_(other.start_status_),
+      completed_(other.completed_) {
+  other.initiator_ = nullptr;
+  other.completed_ = true;
+}
+
+SpiTransferFuture& SpiTransferFuture::operator=(
+    SpiTransferFuture&& other
+) noexcept {
+  if (this != &other) {
+    if (initiator_ != nullptr) {
+      initiator_->CancelAsync();
+    }
+    initiator_ = other.initiator_;
+    start_status_ = other.start_status_;
+    completed_ = other.completed_;
+
+    other.initiator_ = nullptr;
+    other.completed_ = true;
+  }
+  return *this;
+}
+
+SpiTransferFuture::~SpiTransferFuture() {
+  if (initiator_ != nullptr) {
+    initiator_->CancelAsync();
+  }
+}
+
+pw::async2::Poll<pw::Status> SpiTransferFuture::Pend(
+    pw::async2::Context& cx
+) {
+  if (completed_) {
+    return pw::async2::Ready(pw::Status::FailedPrecondition());
+  }
+  if (initiator_ == nullptr) {
+    completed_ = true;
+    return pw::async2::Ready(start_status_);
+  }
+  pw::async2::Poll<pw::Status> result = initiator_->PendAsync(cx);
+  if (result.IsReady()) {
+    initiator_ = nullptr;
+    completed_ = true;
+  }
+  return result;
 }
 
 }  // namespace pb
@@ -0,0 +1,65 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "pb_spi/initiator.h"
+#include "pw_spi/chip_selector.h"
+#include "pw_spi/device.h"
+#include "pw_spi/initiator.h"
+#include "pw_sync/borrow.h"
+#include "pw_sync/mutex.h"
+#include "pw_sync/virtual_basic_lockable.h"
+
+namespace pb {
+
+/// One SPI interface shared by several devices.
+///
+/// Owns the ParticleSpiInitiator and the mutex that arbitrates it, and
+/// hands out pw::spi::Device handles. A device borrows the bus for each
+/// transaction (or pw::spi::Device::StartTransaction() scope), applies its
+/// configuration and drives its own chip select; ParticleSpiInitiator
+/// skips the HAL reconfiguration when consecutive devices agree, so a
+/// handover costs a mutex acquisition.
+///
+/// @code
+///   pb::ParticleSpiBus bus(pb::ParticleSpiInitiator::Interface::kSpi1,
+///                          8'000'000);
+///   pb::ParticleChipSelector imu_cs(D5);
+///   pb::ParticleChipSelector flash_cs(D6);
+///   pw::spi::Device imu = bus.MakeDevice(kImuConfig, imu_cs);
+///   pw::spi::Device flash = bus.MakeDevice(kFlashConfig, flash_cs);
+/// @endcode
+class ParticleSpiBus {
+ public:
+  ParticleSpiBus(ParticleSpiInitiator::Interface interface, uint32_t clock_hz,
+                 SpiFlags flags = SpiFlags::kNone)
+      : initiator_(interface, clock_hz, flags),
+        borrowable_(initiator_, mutex_) {}
+
+  ParticleSpiBus(const ParticleSpiBus&) = delete;
+  ParticleSpiBus& operator=(const ParticleSpiBus&) = delete;
+
+  /// Handle for one device on the bus. `chip_selector` must outlive it.
+  pw::spi::Device MakeDevice(const pw::spi::Config& config,
+                             pw::spi::ChipSelector& chip_selector) {
+    return pw::spi::Device(borrowable_, config, chip_selector);
+  }
+
+  /// Exclusive access for DMA queues and async transfers, which bypass
+  /// pw::spi::Device (see ParticleSpiInitiator::Transfer()).
+  pw::sync::BorrowedPointer<ParticleSpiInitiator,
+                            pw::sync::VirtualBasicLockable>
+  Acquire() {
+    return particle_borrowable_.acquire();
+  }
+
+ private:
+  ParticleSpiInitiator initiator_;
+  pw::sync::VirtualMutex mutex_;
+  pw::sync::Borrowable<pw::spi::Initiator> borrowable_;
+  pw::sync::Borrowable<ParticleSpiInitiator> particle_borrowable_{initiator_,
+                                                                 mutex_};
+};
+
+}  // namespace pb
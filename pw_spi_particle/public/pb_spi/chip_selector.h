@@ -0,0 +1,42 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstdint>
+
+#include "pw_spi/chip_selector.h"
+#include "pw_status/status.h"
+
+// Forward declarations for Particle types (avoid including full headers)
+typedef uint16_t hal_pin_t;
+
+namespace pb {
+
+/// pw::spi::ChipSelector on a Particle GPIO pin.
+///
+/// Toggles the pin with Device OS's pinSetFast()/pinResetFast(), which
+/// write the GPIO data register directly instead of going through the
+/// hal_gpio_write() dynalib call, so the edges sit tight around the
+/// transfer. Use it with pw::spi::Device (see ParticleSpiBus) or as the
+/// chip select of a SpiTransaction.
+class ParticleChipSelector : public pw::spi::ChipSelector {
+ public:
+  /// @param pin GPIO pin driving CS
+  /// @param active_low True for the usual active-low CS
+  explicit ParticleChipSelector(hal_pin_t pin, bool active_low = true)
+      : pin_(pin), active_low_(active_low) {}
+
+  /// Configure the pin as output and deselect. Call once (e.g. in setup())
+  /// before the first transfer.
+  pw::Status Enable();
+
+  pw::Status SetActive(bool active) override;
+
+ private:
+  hal_pin_t pin_;
+  bool active_low_;
+  bool enabled_ = false;
+};
+
+}  // namespace pb
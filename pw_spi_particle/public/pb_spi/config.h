@@ -0,0 +1,18 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+
+// Configuration options for pw_spi_particle
+
+namespace pb::spi::config {
+
+// Blocking transfers up to this many bytes are clocked out with polled
+// hal_spi_transfer() calls on the calling thread instead of DMA. At these
+// sizes the transfer takes microseconds, less than the DMA setup and the
+// semaphore wake-up. 0 always uses DMA.
+inline constexpr size_t kPolledTransferMaxBytes = 8;
+
+}  // namespace pb::spi::config
@@ -4,11 +4,19 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cstdint>
 
+#include "pw_async2/context.h"
+#include "pw_async2/poll.h"
+#include "pw_async2/waker.h"
+#include "pw_bytes/span.h"
+#include "pw_span/span.h"
+#include "pw_spi/chip_selector.h"
 #include "pw_spi/initiator.h"
 #include "pw_status/status.h"
 #include "pw_sync/binary_semaphore.h"
+#include "pw_sync/interrupt_spin_lock.h"
 
 namespace pb {
 
@@ -31,11 +39,89 @@ constexpr bool operator&(SpiFlags a, SpiFlags b) {
   return (static_cast<uint32_t>(a) & static_cast<uint32_t>(b)) != 0;
 }
 
+class ParticleSpiInitiator;
+
+/// Alignment the RTL872x DMA and data cache need for transfer buffers.
+inline constexpr size_t kSpiDmaAlignment = 32;
+
+/// Aligned storage for ParticleSpiInitiator::SetBounceBuffers(). kSize is
+/// the largest transfer that can be bounced; a multiple of 32.
+template <size_t kSize>
+struct SpiBounceBuffers {
+  static_assert(kSize > 0 && kSize % kSpiDmaAlignment == 0,
+                "Bounce buffer size must be a multiple of 32 bytes");
+  alignas(kSpiDmaAlignment) std::array<std::byte, kSize> write;
+  alignas(kSpiDmaAlignment) std::array<std::byte, kSize> read;
+};
+
+/// How often DMA transfers went through the bounce buffers (see
+/// ParticleSpiInitiator::bounce_stats()).
+struct SpiBounceStats {
+  uint32_t bounced_writes = 0;  ///< Misaligned write buffers copied
+  uint32_t bounced_reads = 0;   ///< Misaligned read buffers copied back
+  uint32_t unbounced = 0;       ///< Misaligned buffers too large to bounce
+};
+
+/// One entry of a transaction queue (ParticleSpiInitiator::Transfer()).
+///
+/// The initiator selects `chip_select` (if set) before the transfer and
+/// deselects it afterwards unless `keep_selected` is set, e.g. for a
+/// command and its data sent as two entries. `on_complete` runs from the
+/// DMA interrupt after the entry, before the next one starts: keep it short
+/// and interrupt safe.
+struct SpiTransaction {
+  pw::ConstByteSpan write_buffer;
+  pw::ByteSpan read_buffer;
+  pw::spi::ChipSelector* chip_select = nullptr;
+  bool keep_selected = false;
+  void (*on_complete)(void* context) = nullptr;
+  void* context = nullptr;
+};
+
+/// Future returned by ParticleSpiInitiator::WriteReadAsync() and
+/// TransferAsync().
+///
+/// The DMA transfer starts when the future is created, so the caller can do
+/// other work (e.g. render the next framebuffer slice) before awaiting it.
+/// Completes from the DMA interrupt. Destroying the future before it
+/// completes cancels the transfer, so the buffers may be released then.
+class SpiTransferFuture {
+ public:
+  using value_type = pw::Status;
+
+  SpiTransferFuture() = default;
+  SpiTransferFuture(SpiTransferFuture&& other) noexcept;
+  SpiTransferFuture& operator=(SpiTransferFuture&& other) noexcept;
+  ~SpiTransferFuture();
+
+  SpiTransferFuture(const SpiTransferFuture&) = delete;
+  SpiTransferFuture& operator=(const SpiTransferFuture&) = delete;
+
+  /// Ready with OkStatus once the DMA transfer has finished, or
+  /// FailedPrecondition if it could not start (initiator not configured or
+  /// busy).
+  pw::async2::Poll<pw::Status> Pend(pw::async2::Context& cx);
+
+  /// Returns true if the future has completed.
+  [[nodiscard]] bool is_complete() const { return completed_; }
+
+ private:
+  friend class ParticleSpiInitiator;
+
+  SpiTransferFuture(ParticleSpiInitiator* initiator, pw::Status start_status)
+      : initiator_(initiator), start_status_(start_status) {}
+
+  ParticleSpiInitiator* initiator_ = nullptr;  // Set while DMA is in flight
+  pw::Status start_status_;
+  bool completed_ = false;
+};
+
 /// Pigweed SPI Initiator backend for Particle using HAL SPI API.
 /// Wraps hal_spi_* functions from spi_hal.h.
 ///
 /// Note: This initiator does NOT manage chip select (CS). Use
-/// pw::spi::DigitalOutChipSelector or manual GPIO control for CS.
+/// ParticleChipSelector (pb_spi/chip_selector.h), ParticleSpiBus or manual
+/// GPIO control for CS.
 class ParticleSpiInitiator : public pw::spi::Initiator {
  public:
   /// SPI interface selection (maps to HAL_SPI_INTERFACE1/2/3)
@@ -61,7 +147,49 @@ class ParticleSpiInitiator : public pw::spi::Initiator {
   ParticleSpiInitiator(ParticleSpiInitiator&&) = delete;
   ParticleSpiInitiator& operator=(ParticleSpiInitiator&&) = delete;
 
+  /// Start a DMA transfer and return a future that completes when it is
+  /// done, without blocking a thread. Call Configure() first. Unlike
+  /// pw::spi::Device, this does not drive chip select: assert it before
+  /// and release it after awaiting the future. One transfer at a time per
+  /// initiator, async or blocking; the buffers must outlive the future.
+  SpiTransferFuture WriteReadAsync(pw::ConstByteSpan write_buffer,
+                                   pw::ByteSpan read_buffer);
+
+  /// Let DMA transfers with misaligned buffers go through `buffers`.
+  ///
+  /// A write buffer whose address is not 32-byte aligned is copied into
+  /// the bounce buffer first; a read buffer whose address or size is not a
+  /// multiple of 32 receives the data in the bounce buffer, and it is
+  /// copied out when the transfer completes. Aligned buffers stay
+  /// zero-copy, and buffers larger than kSize are used as-is (counted in
+  /// SpiBounceStats::unbounced). `buffers` must outlive the initiator.
+  /// Call before the first transfer.
+  template <size_t kSize>
+  void SetBounceBuffers(SpiBounceBuffers<kSize>& buffers) {
+    bounce_write_ = buffers.write;
+    bounce_read_ = buffers.read;
+  }
+
+  /// Bounce buffer use since construction.
+  SpiBounceStats bounce_stats() const { return bounce_stats_; }
+
+  /// Run `transactions` back to back: the DMA interrupt starts each next
+  /// entry directly, so the bus only idles for the interrupt latency. Call
+  /// Configure() first; all entries use that configuration. Blocks until
+  /// the last entry is done.
+  ///
+  /// @return DeadlineExceeded if the queue did not finish in time (the
+  ///         current entry is cancelled and its chip select released),
+  ///         FailedPrecondition if not configured or busy
+  pw::Status Transfer(pw::span<SpiTransaction> transactions);
+
+  /// Like Transfer(), but returns a future that completes after the last
+  /// entry. `transactions` and their buffers must outlive the future.
+  SpiTransferFuture TransferAsync(pw::span<SpiTransaction> transactions);
+
  private:
+  friend class SpiTransferFuture;
+
   pw::Status DoConfigure(const pw::spi::Config& config) override;
   pw::Status DoWriteRead(pw::ConstByteSpan write_buffer,
                          pw::ByteSpan read_buffer) override;
@@ -74,6 +202,29 @@ class ParticleSpiInitiator : public pw::spi::Initiator {
   static void DmaCallback2();
   static void (*GetDmaCallback(Interface interface))();
 
+  // Called from the DMA interrupt
+  void OnDmaComplete();
+
+  // Clocks a short transfer byte by byte on the calling thread
+  void TransferPolled(pw::ConstByteSpan write_buffer, pw::ByteSpan read_buffer);
+
+  // Starts hal_spi_transfer_dma(); false if transfer_len is 0. Swaps in
+  // the bounce buffers for misaligned ones.
+  bool StartDma(pw::ConstByteSpan write_buffer, pw::ByteSpan read_buffer);
+
+  // Copies bounced read data to the caller's buffer after a DMA transfer
+  void CompleteDma();
+
+  pw::async2::Poll<pw::Status> PendAsync(pw::async2::Context& cx);
+  void CancelAsync();
+
+  // Start the next queued entry that transfers any bytes, finishing empty
+  // ones on the way. False once the queue is done. Caller holds
+  // async_lock_ (or owns the queue before the first DMA).
+  bool StartNextTransaction();
+  void FinishTransaction(SpiTransaction& transaction);
+  void AbortQueue();
+
   // Registry of active instances per interface. Only one initiator can use
   // each SPI interface at a time. This is a class-scoped static, not a global.
   static constexpr size_t kMaxInterfaces = 3;
@@ -84,6 +235,32 @@ class ParticleSpiInitiator : public pw::spi::Initiator {
   SpiFlags flags_;
   pw::sync::BinarySemaphore dma_complete_;
   bool initialized_ = false;
+
+  // Last settings handed to hal_spi_set_settings()
+  int clock_divider_ = -1;
+  bool settings_applied_ = false;
+  uint8_t applied_bit_order_ = 0;
+  uint8_t applied_mode_ = 0;
+
+  // A transfer (blocking or async) is in flight
+  std::atomic<bool> busy_{false};
+
+  // Async transfer state, shared with the DMA interrupt
+  pw::sync::InterruptSpinLock async_lock_;
+  bool async_active_ = false;
+  bool async_done_ = false;
+  pw::async2::Waker async_waker_;
+
+  // Optional bounce buffers, and the caller's read buffer while a bounced
+  // read is in flight
+  pw::ByteSpan bounce_write_;
+  pw::ByteSpan bounce_read_;
+  pw::ByteSpan bounced_read_target_;
+  SpiBounceStats bounce_stats_;
+
+  // Transaction queue in progress, advanced from the DMA interrupt
+  pw::span<SpiTransaction> queue_;
+  size_t queue_index_ = 0;
 };
 
 }  // namespace pb
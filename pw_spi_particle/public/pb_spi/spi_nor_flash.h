@@ -0,0 +1,135 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pb_spi/bus.h"
+#include "pb_spi/initiator.h"
+#include "pw_bytes/span.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_spi/chip_selector.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+
+namespace pb {
+
+/// Program page of common SPI NOR flash (W25Q, MX25, GD25, IS25).
+inline constexpr size_t kSpiNorPageSize = 256;
+
+/// Smallest erasable unit (4 KiB sector erase, command 0x20).
+inline constexpr size_t kSpiNorSectorSize = 4096;
+
+/// Configuration of a SpiNorFlash.
+struct SpiNorFlashConfig {
+  /// Number of 4 KiB sectors used, from address 0; at most 4096 (16 MiB,
+  /// the limit of 3-byte addresses)
+  size_t sector_count = 0;
+  /// Longest sector or 64 KiB block erase before Erase() gives up
+  uint32_t erase_timeout_ms = 2000;
+  /// Longest page program before Write() gives up
+  uint32_t program_timeout_ms = 10;
+  /// Wait between status polls during an erase; the bus is free meanwhile
+  uint32_t erase_poll_interval_ms = 1;
+};
+
+/// External SPI NOR flash as a pw::kvs::FlashMemory, e.g. for
+/// pw::kvs::KeyValueStore or a log store too large for a ledger.
+///
+/// Reads use Fast Read (0x0B) as one DMA transaction queue: the command
+/// entry keeps the chip selected and the data entry reads straight into the
+/// caller's buffer when it is 32-byte aligned with a size that is a
+/// multiple of 32, otherwise through a page-sized aligned buffer. A page
+/// program sends Write Enable, the command and the page as one queue.
+///
+/// Erase() and Write() poll the status register until the chip is done.
+/// Each poll borrows the bus briefly, and erase polls sleep in between, so
+/// other devices on the bus and other threads run during the tens of
+/// milliseconds a sector erase takes. Aligned runs of 16 sectors use the
+/// 64 KiB block erase.
+///
+/// @code
+///   pb::ParticleSpiBus bus(pb::ParticleSpiInitiator::Interface::kSpi1,
+///                          40'000'000);
+///   pb::ParticleChipSelector flash_cs(D5);
+///   pb::SpiNorFlash flash(bus, flash_cs, {.sector_count = 1024});  // 4 MiB
+///
+///   PW_TRY(flash_cs.Enable());
+///   PW_TRY(flash.Enable());
+///   pw::kvs::FlashPartition partition(&flash, 0, flash.sector_count());
+/// @endcode
+///
+/// Thread Safety: operations on one SpiNorFlash must not overlap; the bus
+/// may be shared with other devices.
+class SpiNorFlash : public pw::kvs::FlashMemory {
+ public:
+  /// @param bus Bus the flash is on; its clock sets the read speed
+  /// @param chip_select Chip select of the flash, enabled by the caller
+  /// @param config Size and timeouts
+  SpiNorFlash(ParticleSpiBus& bus,
+              pw::spi::ChipSelector& chip_select,
+              const SpiNorFlashConfig& config);
+
+  SpiNorFlash(const SpiNorFlash&) = delete;
+  SpiNorFlash& operator=(const SpiNorFlash&) = delete;
+
+  /// Wakes the chip from deep power-down and checks its JEDEC ID.
+  /// @return OkStatus, NotFound if no chip answers (ID 0x000000 or
+  ///         0xFFFFFF), OutOfRange if it is smaller than configured
+  pw::Status Enable() override;
+
+  /// Puts the chip into deep power-down (about 1 uA).
+  pw::Status Disable() override;
+
+  bool IsEnabled() const override { return enabled_; }
+
+  /// Erases `num_sectors` sectors from the sector-aligned `address`.
+  /// @return OkStatus, InvalidArgument if not aligned, OutOfRange beyond
+  ///         the end, DeadlineExceeded if the chip stayed busy
+  pw::Status Erase(Address address, size_t num_sectors) override;
+
+  /// @return Bytes read, or OutOfRange beyond the end
+  pw::StatusWithSize Read(Address address, pw::ByteSpan output) override;
+
+  /// Programs `data` page by page; the range must be erased.
+  /// @return Bytes written, OutOfRange beyond the end, or DeadlineExceeded
+  ///         if a page program did not finish
+  pw::StatusWithSize Write(Address address, pw::ConstByteSpan data) override;
+
+  /// Manufacturer, memory type and capacity bytes read by Enable().
+  uint32_t jedec_id() const { return jedec_id_; }
+
+ private:
+  // Sends `command` and reads `response` in one polled transfer.
+  pw::Status Command(pw::ConstByteSpan command, pw::ByteSpan response = {});
+
+  pw::StatusWithSize ReadChunk(Address address, pw::ByteSpan output);
+  pw::Status ProgramPage(Address address, pw::ConstByteSpan data);
+  pw::Status EraseUnit(uint8_t opcode, Address address);
+
+  // Polls the status register until the write in progress bit clears.
+  pw::Status WaitReady(uint32_t timeout_ms, uint32_t poll_interval_ms);
+
+  // Command byte and 3-byte address in command_.
+  pw::ConstByteSpan SetCommand(uint8_t opcode,
+                               Address address,
+                               size_t dummy_bytes = 0);
+
+  ParticleSpiBus& bus_;
+  pw::spi::ChipSelector& chip_select_;
+  const SpiNorFlashConfig config_;
+  bool enabled_ = false;
+  uint32_t jedec_id_ = 0;
+
+  // DMA buffers (see kSpiDmaAlignment)
+  alignas(kSpiDmaAlignment) std::array<std::byte, kSpiDmaAlignment> command_{};
+  alignas(kSpiDmaAlignment) std::array<std::byte, kSpiDmaAlignment>
+      write_enable_{};
+  alignas(kSpiDmaAlignment) std::array<std::byte, kSpiNorPageSize> page_{};
+};
+
+}  // namespace pb
@@ -0,0 +1,288 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#define PW_LOG_MODULE_NAME "spi_nor"
+
+#include "pb_spi/spi_nor_flash.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "pw_log/log.h"
+#include "pw_status/try.h"
+#include "pw_thread/sleep.h"
+
+namespace pb {
+
+namespace {
+
+using pw::chrono::SystemClock;
+
+constexpr pw::spi::Config kConfig = {
+    .polarity = pw::spi::ClockPolarity::kActiveHigh,
+    .phase = pw::spi::ClockPhase::kRisingEdge,
+    .bits_per_word = pw::spi::BitsPerWord(8),
+    .bit_order = pw::spi::BitOrder::kMsbFirst,
+};
+
+// JEDEC commands shared by the common 3-byte-address SPI NOR parts
+constexpr uint8_t kWriteEnable = 0x06;
+constexpr uint8_t kReadStatus = 0x05;
+constexpr uint8_t kFastRead = 0x0B;
+constexpr uint8_t kPageProgram = 0x02;
+constexpr uint8_t kSectorErase = 0x20;
+constexpr uint8_t kBlockErase = 0xD8;
+constexpr uint8_t kReadJedecId = 0x9F;
+constexpr uint8_t kPowerDown = 0xB9;
+constexpr uint8_t kReleasePowerDown = 0xAB;
+
+constexpr std::byte kStatusBusy{0x01};
+
+constexpr size_t kBlockSize = 64 * 1024;
+constexpr size_t kSectorsPerBlock = kBlockSize / kSpiNorSectorSize;
+constexpr size_t kMaxSectors = (size_t{1} << 24) / kSpiNorSectorSize;
+
+// tRES1: time from release power-down to the next command
+constexpr auto kWakeUpTime = std::chrono::microseconds(30);
+
+bool IsDirectReadable(pw::ByteSpan buffer) {
+  return reinterpret_cast<uintptr_t>(buffer.data()) % kSpiDmaAlignment == 0 &&
+         buffer.size() % kSpiDmaAlignment == 0;
+}
+
+}  // namespace
+
+SpiNorFlash::SpiNorFlash(ParticleSpiBus& bus,
+                         pw::spi::ChipSelector& chip_select,
+                         const SpiNorFlashConfig& config)
+    : pw::kvs::FlashMemory(kSpiNorSectorSize,
+                           std::min(config.sector_count, kMaxSectors),
+                           /*alignment=*/1),
+      bus_(bus),
+      chip_select_(chip_select),
+      config_(config) {
+  write_enable_[0] = std::byte{kWriteEnable};
+}
+
+pw::Status SpiNorFlash::Command(pw::ConstByteSpan command,
+                                pw::ByteSpan response) {
+  auto initiator = bus_.Acquire();
+  PW_TRY(initiator->Configure(kConfig));
+  // Command and response are clocked in one transfer; response bytes
+  // start after the command
+  std::array<std::byte, 8> rx{};
+  const size_t size = command.size() + response.size();
+  if (size > rx.size()) {
+    return pw::Status::InvalidArgument();
+  }
+  std::array<std::byte, 8> tx{};
+  std::copy(command.begin(), command.end(), tx.begin());
+
+  PW_TRY(chip_select_.Activate());
+  const pw::Status status = initiator->WriteRead(
+      pw::ConstByteSpan(tx).first(size), pw::ByteSpan(rx).first(size));
+  chip_select_.Deactivate().IgnoreError();
+  PW_TRY(status);
+  std::copy_n(rx.begin() + command.size(), response.size(), response.begin());
+  return pw::OkStatus();
+}
+
+pw::ConstByteSpan SpiNorFlash::SetCommand(uint8_t opcode,
+                                          Address address,
+                                          size_t dummy_bytes) {
+  command_[0] = std::byte{opcode};
+  command_[1] = static_cast<std::byte>((address >> 16) & 0xff);
+  command_[2] = static_cast<std::byte>((address >> 8) & 0xff);
+  command_[3] = static_cast<std::byte>(address & 0xff);
+  std::fill_n(command_.begin() + 4, dummy_bytes, std::byte{0});
+  return pw::ConstByteSpan(command_).first(4 + dummy_bytes);
+}
+
+pw::Status SpiNorFlash::Enable() {
+  const std::array<std::byte, 1> release{std::byte{kReleasePowerDown}};
+  PW_TRY(Command(release));
+  pw::this_thread::sleep_for(SystemClock::for_at_least(kWakeUpTime));
+
+  const std::array<std::byte, 1> read_id{std::byte{kReadJedecId}};
+  std::array<std::byte, 3> id{};
+  PW_TRY(Command(read_id, id));
+  jedec_id_ = (static_cast<uint32_t>(id[0]) << 16) |
+              (static_cast<uint32_t>(id[1]) << 8) |
+              static_cast<uint32_t>(id[2]);
+  if (jedec_id_ == 0 || jedec_id_ == 0xffffff) {
+    PW_LOG_ERROR("No SPI NOR flash found");
+    return pw::Status::NotFound();
+  }
+
+  // The capacity byte is log2 of the size in bytes on most parts
+  const uint32_t capacity_log2 = static_cast<uint32_t>(id[2]);
+  if (config_.sector_count > kMaxSectors ||
+      (capacity_log2 < 32 &&
+       (size_t{1} << capacity_log2) < size_bytes())) {
+    PW_LOG_ERROR("SPI NOR flash %06x is smaller than %u sectors",
+                 static_cast<unsigned>(jedec_id_),
+                 static_cast<unsigned>(config_.sector_count));
+    return pw::Status::OutOfRange();
+  }
+
+  PW_LOG_INFO("SPI NOR flash %06x, %u KiB used",
+              static_cast<unsigned>(jedec_id_),
+              static_cast<unsigned>(size_bytes() / 1024));
+  enabled_ = true;
+  return pw::OkStatus();
+}
+
+pw::Status SpiNorFlash::Disable() {
+  const std::array<std::byte, 1> power_down{std::byte{kPowerDown}};
+  PW_TRY(Command(power_down));
+  enabled_ = false;
+  return pw::OkStatus();
+}
+
+pw::Status SpiNorFlash::WaitReady(uint32_t timeout_ms,
+                                  uint32_t poll_interval_ms) {
+  const std::array<std::byte, 1> read_status{std::byte{kReadStatus}};
+  const SystemClock::time_point deadline =
+      SystemClock::now() +
+      SystemClock::for_at_least(std::chrono::milliseconds(timeout_ms));
+  while (true) {
+    std::array<std::byte, 1> status{};
+    PW_TRY(Command(read_status, status));
+    if ((status[0] & kStatusBusy) == std::byte{0}) {
+      return pw::OkStatus();
+    }
+    if (SystemClock::now() >= deadline) {
+      PW_LOG_ERROR("SPI NOR flash still busy after %u ms",
+                   static_cast<unsigned>(timeout_ms));
+      return pw::Status::DeadlineExceeded();
+    }
+    if (poll_interval_ms > 0) {
+      pw::this_thread::sleep_for(SystemClock::for_at_least(
+          std::chrono::milliseconds(poll_interval_ms)));
+    }
+  }
+}
+
+pw::Status SpiNorFlash::EraseUnit(uint8_t opcode, Address address) {
+  {
+    auto initiator = bus_.Acquire();
+    PW_TRY(initiator->Configure(kConfig));
+    std::array<SpiTransaction, 2> queue = {{
+        {.write_buffer = pw::ConstByteSpan(write_enable_).first(1),
+         .chip_select = &chip_select_},
+        {.write_buffer = SetCommand(opcode, address),
+         .chip_select = &chip_select_},
+    }};
+    PW_TRY(initiator->Transfer(queue));
+  }
+  return WaitReady(config_.erase_timeout_ms, config_.erase_poll_interval_ms);
+}
+
+pw::Status SpiNorFlash::Erase(Address address, size_t num_sectors) {
+  if (address % kSpiNorSectorSize != 0) {
+    return pw::Status::InvalidArgument();
+  }
+  if (address / kSpiNorSectorSize + num_sectors > sector_count()) {
+    return pw::Status::OutOfRange();
+  }
+  while (num_sectors > 0) {
+    if (address % kBlockSize == 0 && num_sectors >= kSectorsPerBlock) {
+      PW_TRY(EraseUnit(kBlockErase, address));
+      address += kBlockSize;
+      num_sectors -= kSectorsPerBlock;
+    } else {
+      PW_TRY(EraseUnit(kSectorErase, address));
+      address += kSpiNorSectorSize;
+      --num_sectors;
+    }
+  }
+  return pw::OkStatus();
+}
+
+pw::StatusWithSize SpiNorFlash::ReadChunk(Address address,
+                                          pw::ByteSpan output) {
+  auto initiator = bus_.Acquire();
+  if (pw::Status status = initiator->Configure(kConfig); !status.ok()) {
+    return pw::StatusWithSize(status, 0);
+  }
+  std::array<SpiTransaction, 2> queue = {{
+      {.write_buffer = SetCommand(kFastRead, address, /*dummy_bytes=*/1),
+       .chip_select = &chip_select_,
+       .keep_selected = true},
+      {.read_buffer = output, .chip_select = &chip_select_},
+  }};
+  if (pw::Status status = initiator->Transfer(queue); !status.ok()) {
+    return pw::StatusWithSize(status, 0);
+  }
+  return pw::StatusWithSize(output.size());
+}
+
+pw::StatusWithSize SpiNorFlash::Read(Address address, pw::ByteSpan output) {
+  if (address + output.size() > size_bytes()) {
+    return pw::StatusWithSize::OutOfRange();
+  }
+  if (IsDirectReadable(output)) {
+    return ReadChunk(address, output);
+  }
+
+  size_t done = 0;
+  while (done < output.size()) {
+    const size_t size = std::min(output.size() - done, page_.size());
+    // Whole DMA lines, so the cache invalidation stays inside page_
+    const size_t padded =
+        (size + kSpiDmaAlignment - 1) / kSpiDmaAlignment * kSpiDmaAlignment;
+    pw::StatusWithSize result =
+        ReadChunk(address + done, pw::ByteSpan(page_).first(padded));
+    if (!result.ok()) {
+      return pw::StatusWithSize(result.status(), done);
+    }
+    std::memcpy(output.data() + done, page_.data(), size);
+    done += size;
+  }
+  return pw::StatusWithSize(done);
+}
+
+pw::Status SpiNorFlash::ProgramPage(Address address, pw::ConstByteSpan data) {
+  std::memcpy(page_.data(), data.data(), data.size());
+  {
+    auto initiator = bus_.Acquire();
+    PW_TRY(initiator->Configure(kConfig));
+    std::array<SpiTransaction, 3> queue = {{
+        {.write_buffer = pw::ConstByteSpan(write_enable_).first(1),
+         .chip_select = &chip_select_},
+        {.write_buffer = SetCommand(kPageProgram, address),
+         .chip_select = &chip_select_,
+         .keep_selected = true},
+        {.write_buffer = pw::ConstByteSpan(page_).first(data.size()),
+         .chip_select = &chip_select_},
+    }};
+    PW_TRY(initiator->Transfer(queue));
+  }
+  // A page takes well under a millisecond: poll without sleeping
+  return WaitReady(config_.program_timeout_ms, /*poll_interval_ms=*/0);
+}
+
+pw::StatusWithSize SpiNorFlash::Write(Address address,
+                                      pw::ConstByteSpan data) {
+  if (address + data.size() > size_bytes()) {
+    return pw::StatusWithSize::OutOfRange();
+  }
+  size_t done = 0;
+  while (done < data.size()) {
+    // A program wraps around within its page, so stop at the page end
+    const Address page_address = address + done;
+    const size_t size =
+        std::min(data.size() - done,
+                 kSpiNorPageSize - page_address % kSpiNorPageSize);
+    if (pw::Status status =
+            ProgramPage(page_address, data.subspan(done, size));
+        !status.ok()) {
+      return pw::StatusWithSize(status, done);
+    }
+    done += size;
+  }
+  return pw::StatusWithSize(done);
+}
+
+}  // namespace pb
@@ -0,0 +1,180 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+// On-device SPI throughput and latency benchmark for ParticleSpiInitiator.
+//
+// HARDWARE SETUP REQUIRED (same as loopback_test):
+// Connect MOSI to MISO on SPI1 (HAL_SPI_INTERFACE2):
+//   D3 (MOSI) -> D2 (MISO)
+//
+// For each clock rate and transfer size, three paths are timed:
+// - auto:   WriteRead(), which polls up to kPolledTransferMaxBytes and uses
+//           DMA above that (what drivers get today)
+// - dma:    a single-entry Transfer(), which always uses DMA
+// - polled: hal_spi_transfer() byte by byte, as a reference for moving the
+//           polled threshold (small sizes only)
+//
+// Results are logged as one line per measurement:
+//   spi_bench clock_hz=8000000 size=64 path=dma transfers_per_s=... ...
+// overhead_us is the measured time per transfer minus the time the bits
+// take on the wire; timeout_margin is the WriteRead() DMA timeout divided by
+// the measured time, so a value near 1 means the timeout is too tight.
+
+#define PW_LOG_MODULE_NAME "spi_bench"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+
+#include "pb_spi/config.h"
+#include "pb_spi/initiator.h"
+#include "pw_log/log.h"
+#include "pw_unit_test/framework.h"
+#include "spi_hal.h"
+#include "timer_hal.h"
+
+namespace pb {
+namespace {
+
+constexpr uint32_t kMinIterations = 8;
+constexpr uint32_t kMinDurationUs = 100'000;
+constexpr size_t kMaxPolledSize = 64;
+
+constexpr std::array<uint32_t, 3> kClocks = {1'000'000, 8'000'000,
+                                             25'000'000};
+constexpr std::array<size_t, 10> kSizes = {1,  2,   4,    8,    16,
+                                           32, 64, 256, 1024, 4096};
+
+constexpr pw::spi::Config kConfig = {
+    .polarity = pw::spi::ClockPolarity::kActiveHigh,
+    .phase = pw::spi::ClockPhase::kRisingEdge,
+    .bits_per_word = pw::spi::BitsPerWord(8),
+    .bit_order = pw::spi::BitOrder::kMsbFirst,
+};
+
+struct Scratch {
+  alignas(kSpiDmaAlignment) std::array<std::byte, 4096> tx;
+  alignas(kSpiDmaAlignment) std::array<std::byte, 4096> rx;
+};
+
+Scratch scratch;
+
+struct Measurement {
+  uint32_t iterations = 0;
+  uint32_t elapsed_us = 0;
+  bool ok = true;
+
+  uint32_t us_per_transfer() const { return elapsed_us / iterations; }
+};
+
+// Run `transfer` until both minimums are reached; checks the loopback data
+// after every transfer so a marginal clock shows up as a failure rather
+// than as a fast result.
+template <typename Transfer>
+Measurement Measure(size_t size, Transfer&& transfer) {
+  Measurement result;
+  const uint32_t start = HAL_Timer_Get_Micro_Seconds();
+  do {
+    std::memset(scratch.rx.data(), 0, size);
+    result.ok &= transfer().ok();
+    result.ok &= std::memcmp(scratch.tx.data(), scratch.rx.data(), size) == 0;
+    ++result.iterations;
+    result.elapsed_us = HAL_Timer_Get_Micro_Seconds() - start;
+  } while (result.iterations < kMinIterations ||
+           result.elapsed_us < kMinDurationUs);
+  return result;
+}
+
+uint32_t WireTimeUs(size_t size, uint32_t clock_hz) {
+  return static_cast<uint32_t>((uint64_t{size} * 8 * 1'000'000) / clock_hz);
+}
+
+// Mirrors the timeout DoWriteRead() uses for DMA transfers
+uint32_t DmaTimeoutUs(size_t size, uint32_t clock_hz) {
+  return std::max<uint32_t>(WireTimeUs(size, clock_hz) / 500, 10) * 1000;
+}
+
+void Report(uint32_t clock_hz, size_t size, const char* path,
+            const Measurement& m) {
+  const uint32_t us = std::max<uint32_t>(m.us_per_transfer(), 1);
+  const uint32_t wire_us = WireTimeUs(size, clock_hz);
+  const uint64_t bytes = uint64_t{size} * m.iterations;
+  PW_LOG_INFO(
+      "spi_bench clock_hz=%u size=%u path=%s transfers_per_s=%u "
+      "kbyte_per_s=%u us_per_transfer=%u wire_us=%u overhead_us=%u "
+      "timeout_margin=%u ok=%d",
+      static_cast<unsigned>(clock_hz),
+      static_cast<unsigned>(size),
+      path,
+      static_cast<unsigned>(uint64_t{m.iterations} * 1'000'000 / m.elapsed_us),
+      static_cast<unsigned>(bytes * 1'000 / m.elapsed_us),
+      static_cast<unsigned>(us),
+      static_cast<unsigned>(wire_us),
+      static_cast<unsigned>(us > wire_us ? us - wire_us : 0),
+      static_cast<unsigned>(DmaTimeoutUs(size, clock_hz) / us),
+      m.ok ? 1 : 0);
+}
+
+class SpiBenchmarkTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    for (size_t i = 0; i < scratch.tx.size(); ++i) {
+      scratch.tx[i] = static_cast<std::byte>((i * 37 + 11) & 0xFF);
+    }
+  }
+};
+
+TEST_F(SpiBenchmarkTest, ThroughputAndLatency) {
+  for (const uint32_t clock_hz : kClocks) {
+    auto spi = std::make_unique<ParticleSpiInitiator>(
+        ParticleSpiInitiator::Interface::kSpi1, clock_hz);
+    ASSERT_EQ(spi->Configure(kConfig), pw::OkStatus());
+
+    size_t crossover = 0;
+    for (const size_t size : kSizes) {
+      const pw::ConstByteSpan tx(scratch.tx.data(), size);
+      const pw::ByteSpan rx(scratch.rx.data(), size);
+
+      const Measurement automatic =
+          Measure(size, [&] { return spi->WriteRead(tx, rx); });
+      Report(clock_hz, size, "auto", automatic);
+      EXPECT_TRUE(automatic.ok) << "clock " << clock_hz << " size " << size;
+
+      std::array<SpiTransaction, 1> queue = {
+          SpiTransaction{.write_buffer = tx, .read_buffer = rx}};
+      const Measurement dma =
+          Measure(size, [&] { return spi->Transfer(queue); });
+      Report(clock_hz, size, "dma", dma);
+      EXPECT_TRUE(dma.ok) << "clock " << clock_hz << " size " << size;
+
+      if (size > kMaxPolledSize) {
+        continue;
+      }
+      // The initiator has applied the clock and mode above; drive the same
+      // peripheral directly
+      const Measurement polled = Measure(size, [&] {
+        for (size_t i = 0; i < size; ++i) {
+          scratch.rx[i] = static_cast<std::byte>(hal_spi_transfer(
+              HAL_SPI_INTERFACE2, static_cast<uint8_t>(scratch.tx[i])));
+        }
+        return pw::OkStatus();
+      });
+      Report(clock_hz, size, "polled", polled);
+      EXPECT_TRUE(polled.ok) << "clock " << clock_hz << " size " << size;
+
+      if (crossover == 0 &&
+          dma.us_per_transfer() < polled.us_per_transfer()) {
+        crossover = size;
+      }
+    }
+    PW_LOG_INFO(
+        "spi_bench clock_hz=%u dma_faster_from=%u polled_max_bytes=%u",
+        static_cast<unsigned>(clock_hz),
+        static_cast<unsigned>(crossover),
+        static_cast<unsigned>(spi::config::kPolledTransferMaxBytes));
+  }
+}
+
+}  // namespace
+}  // namespace pb
@@ -0,0 +1,110 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+// On-device test of SpiNorFlash.
+//
+// HARDWARE SETUP REQUIRED:
+// A SPI NOR flash (e.g. W25Q32) on SPI1 (HAL_SPI_INTERFACE2):
+//   D4 (SCK), D3 (MISO) -> DO, D2 (MOSI) -> DI, D5 -> /CS
+// /WP and /HOLD tied high.
+//
+// The last 64 KiB of the configured range are erased and rewritten. Read
+// and program throughput is logged as one "spi_nor" line.
+
+#include "pb_spi/spi_nor_flash.h"
+
+#include <array>
+#include <cstring>
+
+#include "pb_spi/bus.h"
+#include "pb_spi/chip_selector.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_unit_test/framework.h"
+
+namespace pb {
+namespace {
+
+using pw::chrono::SystemClock;
+
+constexpr hal_pin_t kFlashCsPin = 5;  // D5
+constexpr size_t kSectorCount = 1024;  // 4 MiB, the smallest common part
+constexpr uint32_t kTestAddress = (kSectorCount - 16) * kSpiNorSectorSize;
+constexpr size_t kTestSize = 16 * kSpiNorSectorSize;
+
+ParticleSpiBus bus(ParticleSpiInitiator::Interface::kSpi1, 40'000'000);
+ParticleChipSelector flash_cs(kFlashCsPin);
+SpiNorFlash flash(bus, flash_cs, {.sector_count = kSectorCount});
+
+alignas(kSpiDmaAlignment) std::array<std::byte, 4096> buffer;
+
+uint32_t ElapsedUs(SystemClock::time_point start) {
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          SystemClock::now() - start)
+          .count());
+}
+
+class SpiNorFlashTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(flash_cs.Enable(), pw::OkStatus());
+    ASSERT_EQ(flash.Enable(), pw::OkStatus());
+  }
+};
+
+TEST_F(SpiNorFlashTest, ErasedRangeReadsAsOnes) {
+  ASSERT_EQ(flash.Erase(kTestAddress, kTestSize / kSpiNorSectorSize),
+            pw::OkStatus());
+  ASSERT_EQ(flash.Read(kTestAddress, buffer).status(), pw::OkStatus());
+  for (std::byte byte : buffer) {
+    ASSERT_EQ(byte, std::byte{0xff});
+  }
+}
+
+TEST_F(SpiNorFlashTest, WriteAcrossPagesReadsBack) {
+  ASSERT_EQ(flash.Erase(kTestAddress, 1), pw::OkStatus());
+
+  // Starts mid-page and ends mid-page; read back into a misaligned buffer
+  std::array<std::byte, 600> data;
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<std::byte>(i * 31);
+  }
+  const uint32_t address = kTestAddress + 100;
+  ASSERT_EQ(flash.Write(address, data).size(), data.size());
+
+  std::array<std::byte, 601> read_back{};
+  pw::StatusWithSize result =
+      flash.Read(address, pw::ByteSpan(read_back).subspan(1));
+  ASSERT_EQ(result.status(), pw::OkStatus());
+  EXPECT_EQ(std::memcmp(read_back.data() + 1, data.data(), data.size()), 0);
+}
+
+TEST_F(SpiNorFlashTest, Throughput) {
+  ASSERT_EQ(flash.Erase(kTestAddress, 1), pw::OkStatus());
+  for (size_t i = 0; i < buffer.size(); ++i) {
+    buffer[i] = static_cast<std::byte>(i);
+  }
+
+  SystemClock::time_point start = SystemClock::now();
+  ASSERT_EQ(flash.Write(kTestAddress, buffer).status(), pw::OkStatus());
+  const uint32_t program_us = ElapsedUs(start);
+
+  start = SystemClock::now();
+  ASSERT_EQ(flash.Read(kTestAddress, buffer).status(), pw::OkStatus());
+  const uint32_t read_us = ElapsedUs(start);
+
+  start = SystemClock::now();
+  ASSERT_EQ(flash.Erase(kTestAddress, 1), pw::OkStatus());
+  const uint32_t erase_us = ElapsedUs(start);
+
+  PW_LOG_INFO("spi_nor jedec_id=%06x read_kbyte_per_s=%u "
+              "program_kbyte_per_s=%u sector_erase_ms=%u",
+              static_cast<unsigned>(flash.jedec_id()),
+              static_cast<unsigned>(buffer.size() * 1000 / read_us),
+              static_cast<unsigned>(buffer.size() * 1000 / program_us),
+              static_cast<unsigned>(erase_us / 1000));
+}
+
+}  // namespace
+}  // namespace pb
@@ -3,16 +3,29 @@
 
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pb_uart/flush_policy.h"
+#include "pw_bytes/span.h"
+#include "pw_chrono/system_clock.h"
 #include "pw_stream/stream.h"
 #include "usart_hal.h"
 
 namespace pb {
 
-/// Non-blocking UART stream wrapper using Particle HAL.
+/// Non-blocking UART stream wrapper using Particle HAL, over caller-provided
+/// ring buffers.
 ///
 /// This class wraps the Particle HAL UART as a pw::stream::NonSeekableReaderWriter.
 /// The key semantic is **non-blocking reads**: Read() returns immediately with
 /// available bytes (0 if none), which enables polling-based async I/O patterns.
+/// With set_read_timeout(), Read() instead parks the calling thread until
+/// data arrives or the timeout expires.
+///
+/// Most code uses ParticleUartStream (64-byte buffers) or
+/// ParticleUartStreamWithBuffers<kRx, kTx>, which own their buffers.
 ///
 /// Usage:
 /// @code
@@ -24,13 +37,20 @@ namespace pb {
 /// @endcode
 ///
 /// @note Must call Init() before use.
-class ParticleUartStream : public pw::stream::NonSeekableReaderWriter {
+class BasicParticleUartStream : public pw::stream::NonSeekableReaderWriter {
  public:
   /// Construct a UART stream wrapper.
   /// @param serial HAL UART interface (e.g., HAL_USART_SERIAL1)
+  /// @param rx_buffer Receive ring buffer (32-byte aligned for RTL872x DMA,
+  ///        at most 65535 bytes)
+  /// @param tx_buffer Transmit ring buffer (same requirements)
+  /// @param flush_policy When writes wait for transmission (see FlushPolicy)
   /// Note: Constructor initializes buffers (like Wiring's USARTSerial constructor).
   /// Call Init() to configure baud rate and start communication.
-  explicit ParticleUartStream(hal_usart_interface_t serial);
+  BasicParticleUartStream(hal_usart_interface_t serial,
+                          pw::ByteSpan rx_buffer,
+                          pw::ByteSpan tx_buffer,
+                          FlushPolicy flush_policy = FlushPolicy::kAlways);
 
   /// Initialize the UART with specified baud rate.
   /// @param baud_rate Baud rate (default 115200 for PN532)
@@ -40,26 +60,94 @@ class ParticleUartStream : public pw::stream::NonSeekableReaderWriter {
   /// Shutdown the UART.
   void Deinit();
 
-  /// Flush TX buffer - wait for all bytes to be transmitted.
+  /// Flush TX buffer - wait for all bytes to be transmitted, whatever the
+  /// FlushPolicy.
   void Flush();
 
+  /// Changes when writes wait for transmission.
+  void set_flush_policy(FlushPolicy policy) { flush_policy_ = policy; }
+  [[nodiscard]] FlushPolicy flush_policy() const { return flush_policy_; }
+
+  /// Makes Read() wait up to `timeout` for the first byte when nothing is
+  /// buffered. Zero (the default) keeps reads non-blocking.
+  ///
+  /// The thread waits on the HAL RX event where the port supports it (see
+  /// PB_UART_CONFIG_HAL_EVENTS), so it wakes on data instead of on a sleep
+  /// interval; other ports are re-checked every millisecond.
+  void set_read_timeout(pw::chrono::SystemClock::duration timeout) {
+    read_timeout_ = timeout;
+  }
+  [[nodiscard]] pw::chrono::SystemClock::duration read_timeout() const {
+    return read_timeout_;
+  }
+
  private:
-  /// Non-blocking read. Returns immediately with available bytes.
+  /// Read. Returns immediately with available bytes, or waits up to the read
+  /// timeout for the first byte.
   /// @param dest Buffer to read into
-  /// @return Number of bytes read (0 if nothing available)
+  /// @return Number of bytes read (0 if nothing available / timed out)
   pw::StatusWithSize DoRead(pw::ByteSpan dest) override;
 
-  /// Write data to UART. Writes all bytes.
+  /// Blocks until RX data may be available or `deadline` passes.
+  void WaitForRx(pw::chrono::SystemClock::time_point deadline);
+
+  /// Write data to UART. Queues all bytes in bulk, blocking only while the
+  /// TX buffer is full, then flushes according to the FlushPolicy.
   /// @param data Data to write
   /// @return OkStatus on success
   pw::Status DoWrite(pw::ConstByteSpan data) override;
 
   hal_usart_interface_t serial_;
+  FlushPolicy flush_policy_;
+  pw::chrono::SystemClock::duration read_timeout_{};
+  bool rx_events_ = false;  // HAL RX event enabled in Init()
+};
+
+namespace internal {
+
+// Storage base of ParticleUartStreamWithBuffers. Inherited before
+// BasicParticleUartStream so the buffers exist when the HAL is handed them.
+template <size_t kRxBufferSize, size_t kTxBufferSize>
+struct UartStreamBuffers {
+  alignas(32) std::array<std::byte, kRxBufferSize> rx_storage{};
+  alignas(32) std::array<std::byte, kTxBufferSize> tx_storage{};
+};
 
-  // Buffer storage - sized to match SERIAL_BUFFER_SIZE (64 on P2)
-  static constexpr size_t kBufferSize = 64;
-  uint8_t rx_buffer_[kBufferSize]{};
-  uint8_t tx_buffer_[kBufferSize]{};
+}  // namespace internal
+
+/// BasicParticleUartStream with inline, DMA-aligned RX/TX ring buffers.
+///
+/// Size the RX buffer for the longest time the consuming thread may be
+/// preempted: at 115200 baud, 1 KiB bridges ~89 ms.
+///
+/// @code
+///   // Bursty 115200 baud sensor: large RX, small TX
+///   pb::ParticleUartStreamWithBuffers<1024, 64> sensor(HAL_USART_SERIAL1);
+/// @endcode
+template <size_t kRxBufferSize, size_t kTxBufferSize = kRxBufferSize>
+class ParticleUartStreamWithBuffers
+    : private internal::UartStreamBuffers<kRxBufferSize, kTxBufferSize>,
+      public BasicParticleUartStream {
+  static_assert(kRxBufferSize > 0 && kRxBufferSize <= UINT16_MAX,
+                "HAL ring buffer sizes are 16 bit");
+  static_assert(kTxBufferSize > 0 && kTxBufferSize <= UINT16_MAX,
+                "HAL ring buffer sizes are 16 bit");
+  static_assert(kRxBufferSize % 32 == 0 && kTxBufferSize % 32 == 0,
+                "Buffer sizes must be multiples of the 32-byte DMA/cache line");
+
+  using Buffers = internal::UartStreamBuffers<kRxBufferSize, kTxBufferSize>;
+
+ public:
+  explicit ParticleUartStreamWithBuffers(
+      hal_usart_interface_t serial,
+      FlushPolicy flush_policy = FlushPolicy::kAlways)
+      : BasicParticleUartStream(serial,
+                                Buffers::rx_storage,
+                                Buffers::tx_storage,
+                                flush_policy) {}
 };
 
+/// UART stream with 64-byte buffers (Device OS SERIAL_BUFFER_SIZE on P2).
+using ParticleUartStream = ParticleUartStreamWithBuffers<64>;
+
 }  // namespace pb
@@ -12,7 +12,10 @@
 
 #include "pb_stream/uart_stream.h"
 
+#include <chrono>
+
 #include "delay_hal.h"
+#include "timer_hal.h"
 #include "pw_bytes/array.h"
 #include "pw_log/log.h"
 #include "pw_unit_test/framework.h"
@@ -40,7 +43,7 @@ class UartLoopbackTest : public ::testing::Test {
   }
 
   // Helper to drain any garbage from RX buffer
-  void DrainRx(pb::ParticleUartStream& serial) {
+  void DrainRx(pb::BasicParticleUartStream& serial) {
     std::array<std::byte, 64> discard{};
     while (true) {
       auto result = serial.Read(discard);
@@ -223,4 +226,113 @@ TEST_F(UartLoopbackTest, Bidirectional_Simultaneous) {
   PW_LOG_INFO("Bidirectional: PASSED");
 }
 
+TEST_F(UartLoopbackTest, OnFlushPolicy_WriteReturnsBeforeTransmission) {
+  ASSERT_TRUE(serial1_.Init(kBaudRate).ok());
+  ASSERT_TRUE(serial2_.Init(kBaudRate).ok());
+  serial1_.set_flush_policy(pb::FlushPolicy::kOnFlush);
+
+  DrainRx(serial2_);
+
+  PW_LOG_INFO("Testing: kOnFlush write returns once queued");
+
+  // 48 bytes take ~4.2ms on the wire at 115200 baud
+  std::array<std::byte, 48> payload;
+  for (size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<std::byte>(0x80 + i);
+  }
+
+  uint32_t start_us = HAL_Timer_Get_Micro_Seconds();
+  ASSERT_TRUE(serial1_.Write(payload).ok());
+  uint32_t write_us = HAL_Timer_Get_Micro_Seconds() - start_us;
+  serial1_.Flush();
+  uint32_t flush_us = HAL_Timer_Get_Micro_Seconds() - start_us;
+
+  PW_LOG_INFO("Write returned after %luus, Flush after %luus",
+              static_cast<unsigned long>(write_us),
+              static_cast<unsigned long>(flush_us));
+  EXPECT_LT(write_us, 1000u);
+  EXPECT_GT(flush_us, 3000u);
+
+  HAL_Delay_Milliseconds(5);
+  std::array<std::byte, 64> rx{};
+  size_t received = 0;
+  for (int attempt = 0; attempt < 10 && received < payload.size(); ++attempt) {
+    auto r = serial2_.Read(pw::ByteSpan(rx).subspan(received));
+    if (r.ok()) received += r.value().size();
+    HAL_Delay_Milliseconds(2);
+  }
+  ASSERT_EQ(received, payload.size());
+  for (size_t i = 0; i < payload.size(); ++i) {
+    EXPECT_EQ(rx[i], payload[i]) << "Mismatch at byte " << i;
+  }
+
+  serial1_.set_flush_policy(pb::FlushPolicy::kAlways);
+  PW_LOG_INFO("kOnFlush policy: PASSED");
+}
+
+TEST_F(UartLoopbackTest, LargeRxBuffer_AbsorbsBurst) {
+  // Replace the default 64-byte Serial2 with a 256-byte RX buffer
+  serial2_.Deinit();
+  pb::ParticleUartStreamWithBuffers<256, 64> big_rx(HAL_USART_SERIAL2);
+  ASSERT_TRUE(serial1_.Init(kBaudRate).ok());
+  ASSERT_TRUE(big_rx.Init(kBaudRate).ok());
+  DrainRx(big_rx);
+
+  PW_LOG_INFO("Testing: 200-byte burst into a 256-byte RX buffer");
+
+  std::array<std::byte, 200> payload;
+  for (size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<std::byte>(i ^ 0x5A);
+  }
+  ASSERT_TRUE(serial1_.Write(payload).ok());
+
+  // Write() waited for transmission and nobody read; all of it must be
+  // buffered
+  HAL_Delay_Milliseconds(5);
+  std::array<std::byte, 256> rx{};
+  auto result = big_rx.Read(rx);
+  ASSERT_TRUE(result.ok());
+  ASSERT_EQ(result.value().size(), payload.size());
+  for (size_t i = 0; i < payload.size(); ++i) {
+    EXPECT_EQ(rx[i], payload[i]) << "Mismatch at byte " << i;
+  }
+
+  big_rx.Deinit();
+  PW_LOG_INFO("Large RX buffer: PASSED");
+}
+
+TEST_F(UartLoopbackTest, ReadTimeout_WaitsForData) {
+  ASSERT_TRUE(serial1_.Init(kBaudRate).ok());
+  ASSERT_TRUE(serial2_.Init(kBaudRate).ok());
+  DrainRx(serial2_);
+  serial2_.set_read_timeout(std::chrono::milliseconds(50));
+
+  PW_LOG_INFO("Testing: Read() with a 50 ms timeout");
+
+  // Nothing sent: Read() returns empty after the timeout
+  std::array<std::byte, 16> rx{};
+  uint32_t start_ms = HAL_Timer_Get_Milli_Seconds();
+  auto empty = serial2_.Read(rx);
+  uint32_t waited_ms = HAL_Timer_Get_Milli_Seconds() - start_ms;
+  ASSERT_TRUE(empty.ok());
+  EXPECT_EQ(empty.value().size(), 0u);
+  EXPECT_GE(waited_ms, 50u);
+  EXPECT_LT(waited_ms, 70u);
+
+  // Data sent: Read() returns it without waiting for the full timeout
+  serial1_.set_flush_policy(pb::FlushPolicy::kOnFlush);
+  ASSERT_TRUE(serial1_.Write(kTestPattern).ok());
+  start_ms = HAL_Timer_Get_Milli_Seconds();
+  auto data = serial2_.Read(rx);
+  waited_ms = HAL_Timer_Get_Milli_Seconds() - start_ms;
+  ASSERT_TRUE(data.ok());
+  EXPECT_GT(data.value().size(), 0u);
+  EXPECT_LT(waited_ms, 20u);
+  EXPECT_EQ(rx[0], kTestPattern[0]);
+
+  serial1_.set_flush_policy(pb::FlushPolicy::kAlways);
+  PW_LOG_INFO("Read timeout: PASSED (data read waited %lums)",
+              static_cast<unsigned long>(waited_ms));
+}
+
 }  // namespace
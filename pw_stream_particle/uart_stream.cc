@@ -4,66 +4,107 @@
 #include "pb_stream/uart_stream.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
 
-#include "pw_log/log.h"
+#include "pb_uart/config.h"
+#include "pb_uart/usart_io.h"
+#include "pw_assert/check.h"
+#include "pw_thread/sleep.h"
 
 namespace pb {
 
-ParticleUartStream::ParticleUartStream(hal_usart_interface_t serial)
-    : serial_(serial) {
+BasicParticleUartStream::BasicParticleUartStream(hal_usart_interface_t serial,
+                                                 pw::ByteSpan rx_buffer,
+                                                 pw::ByteSpan tx_buffer,
+                                                 FlushPolicy flush_policy)
+    : serial_(serial), flush_policy_(flush_policy) {
+  PW_CHECK(!rx_buffer.empty() && rx_buffer.size() <= UINT16_MAX);
+  PW_CHECK(!tx_buffer.empty() && tx_buffer.size() <= UINT16_MAX);
+  PW_CHECK_UINT_EQ(reinterpret_cast<uintptr_t>(rx_buffer.data()) % 32, 0);
+  PW_CHECK_UINT_EQ(reinterpret_cast<uintptr_t>(tx_buffer.data()) % 32, 0);
+
   // Initialize buffers in constructor (matching Wiring's USARTSerial constructor)
   hal_usart_buffer_config_t config = {
       .size = sizeof(hal_usart_buffer_config_t),
-      .rx_buffer = rx_buffer_,
-      .rx_buffer_size = kBufferSize,
-      .tx_buffer = tx_buffer_,
-      .tx_buffer_size = kBufferSize,
+      .rx_buffer = reinterpret_cast<uint8_t*>(rx_buffer.data()),
+      .rx_buffer_size = static_cast<uint16_t>(rx_buffer.size()),
+      .tx_buffer = reinterpret_cast<uint8_t*>(tx_buffer.data()),
+      .tx_buffer_size = static_cast<uint16_t>(tx_buffer.size()),
   };
   hal_usart_init_ex(serial_, &config, nullptr);
 }
 
-pw::Status ParticleUartStream::Init(uint32_t baud_rate) {
+pw::Status BasicParticleUartStream::Init(uint32_t baud_rate) {
   // Configure baud rate and start (matching Wiring's begin())
   hal_usart_begin_config(serial_, baud_rate, SERIAL_8N1, nullptr);
+#if PB_UART_CONFIG_HAL_EVENTS
+  // Lets timed reads sleep on the RX interrupt; ports without events poll
+  rx_events_ =
+      hal_usart_pvt_enable_event(serial_, HAL_USART_PVT_EVENT_READABLE) == 0;
+#endif  // PB_UART_CONFIG_HAL_EVENTS
   return pw::OkStatus();
 }
 
-void ParticleUartStream::Deinit() { hal_usart_end(serial_); }
+void BasicParticleUartStream::Deinit() {
+#if PB_UART_CONFIG_HAL_EVENTS
+  if (rx_events_) {
+    hal_usart_pvt_disable_event(serial_, HAL_USART_PVT_EVENT_READABLE);
+    rx_events_ = false;
+  }
+#endif  // PB_UART_CONFIG_HAL_EVENTS
+  hal_usart_end(serial_);
+}
 
-void ParticleUartStream::Flush() { hal_usart_flush(serial_); }
+void BasicParticleUartStream::Flush() {
+  hal_usart_flush(serial_);
+}
 
-pw::StatusWithSize ParticleUartStream::DoRead(pw::ByteSpan dest) {
-  int32_t available = hal_usart_available(serial_);
-  if (available <= 0) {
-    // No data available - return immediately (non-blocking)
-    return pw::StatusWithSize(0);
+pw::StatusWithSize BasicParticleUartStream::DoRead(pw::ByteSpan dest) {
+  // Copies whatever is buffered (0 if nothing available)
+  size_t count = pb::uart::ReadAvailable(serial_, dest);
+  if (count > 0 || dest.empty() ||
+      read_timeout_ <= pw::chrono::SystemClock::duration::zero()) {
+    return pw::StatusWithSize(count);
   }
 
-  size_t to_read = std::min(dest.size(), static_cast<size_t>(available));
-  for (size_t i = 0; i < to_read; ++i) {
-    int32_t byte = hal_usart_read(serial_);
-    if (byte < 0) {
-      // Should not happen since we checked available(), but handle gracefully
-      PW_LOG_WARN("DoRead: hal_usart_read returned %d at index %u",
-                  static_cast<int>(byte), static_cast<unsigned>(i));
-      return pw::StatusWithSize(i);
-    }
-    dest[i] = static_cast<std::byte>(byte);
+  const auto deadline =
+      pw::chrono::SystemClock::TimePointAfterAtLeast(read_timeout_);
+  while (count == 0 && pw::chrono::SystemClock::now() < deadline) {
+    WaitForRx(deadline);
+    count = pb::uart::ReadAvailable(serial_, dest);
   }
-  return pw::StatusWithSize(to_read);
+  return pw::StatusWithSize(count);
 }
 
-pw::Status ParticleUartStream::DoWrite(pw::ConstByteSpan data) {
-
-
+void BasicParticleUartStream::WaitForRx(
+    pw::chrono::SystemClock::time_point deadline) {
+#if PB_UART_CONFIG_HAL_EVENTS
+  if (rx_events_) {
+    const auto remaining = deadline - pw::chrono::SystemClock::now();
+    const int64_t remaining_ms = std::max<int64_t>(
+        1,
+        std::chrono::ceil<std::chrono::milliseconds>(remaining).count());
+    hal_usart_pvt_wait_event(serial_,
+                             HAL_USART_PVT_EVENT_READABLE,
+                             static_cast<uint32_t>(remaining_ms));
+    return;
+  }
+#endif  // PB_UART_CONFIG_HAL_EVENTS
+  pw::this_thread::sleep_for(
+      std::min<pw::chrono::SystemClock::duration>(
+          pw::chrono::SystemClock::for_at_least(std::chrono::milliseconds(1)),
+          deadline - pw::chrono::SystemClock::now()));
+}
 
-  for (auto b : data) {
-    hal_usart_write(serial_, static_cast<uint8_t>(b));
+pw::Status BasicParticleUartStream::DoWrite(pw::ConstByteSpan data) {
+  pb::uart::WriteAll(serial_, data);
+  if (flush_policy_ == FlushPolicy::kAlways) {
+    // Ensure bytes are actually transmitted before returning. This is
+    // critical for request/response protocols like PN532 where we need
+    // to wait for a response after sending.
+    hal_usart_flush(serial_);
   }
-  // Flush TX buffer to ensure bytes are actually transmitted
-  // before returning. This is critical for request/response protocols
-  // like PN532 where we need to wait for a response after sending.
-  hal_usart_flush(serial_);
   return pw::OkStatus();
 }
 
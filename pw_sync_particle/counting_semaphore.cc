@@ -6,15 +6,17 @@
 #include "concurrent_hal.h"
 #include "pw_assert/check.h"
 #include "pw_chrono/system_clock.h"
+#include "pw_sync_particle/interrupt_context.h"
 
 using pw::chrono::SystemClock;
 
 namespace pw::sync {
 
 void CountingSemaphore::release(ptrdiff_t update) {
-  // Release (give) the semaphore 'update' times.
+  // Release (give) the semaphore 'update' times, from a thread or an
+  // interrupt handler.
   for (; update > 0; --update) {
-    int result = os_semaphore_give(native_type_, false);
+    int result = backend::GiveSemaphore(native_type_);
     PW_DCHECK_INT_EQ(result, 0, "Overflowed counting semaphore.");
   }
 }
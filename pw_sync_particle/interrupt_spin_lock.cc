@@ -3,14 +3,85 @@
 
 #include "pw_sync/interrupt_spin_lock.h"
 
+#include <algorithm>
+#include <array>
+
 #include "hal_irq_flag.h"
+#include "pw_assert/assert.h"
+#include "pw_sync_particle/config.h"
+#include "pw_sync_particle/irq_profile.h"
 
 namespace pw::sync {
+namespace {
+
+#if PW_SYNC_PARTICLE_IRQ_PROFILING
+
+// DWT cycle counter (ARMv8-M)
+constexpr uintptr_t kDemcr = 0xE000EDFC;
+constexpr uintptr_t kDwtCtrl = 0xE0001000;
+constexpr uintptr_t kDwtCyccnt = 0xE0001004;
+
+volatile uint32_t& Register(uintptr_t address) {
+  // NOLINTNEXTLINE(performance-no-int-to-ptr)
+  return *reinterpret_cast<volatile uint32_t*>(address);
+}
+
+uint32_t Cycles() {
+  if ((Register(kDwtCtrl) & 1u) == 0) {
+    Register(kDemcr) = Register(kDemcr) | (1u << 24);  // TRCENA
+    Register(kDwtCtrl) = Register(kDwtCtrl) | 1u;      // CYCCNTENA
+  }
+  return Register(kDwtCyccnt);
+}
+
+// Only touched with interrupts disabled (inside a held lock)
+std::array<backend::IrqSiteStats, backend::config::kIrqProfileSites + 1>
+    g_sites;
+
+void Record(const void* site, uint32_t cycles) {
+  backend::IrqSiteStats* entry = &g_sites.back();  // Overflow bucket
+  for (size_t i = 0; i < backend::config::kIrqProfileSites; ++i) {
+    if (g_sites[i].site == site || g_sites[i].site == nullptr) {
+      entry = &g_sites[i];
+      break;
+    }
+  }
+  if (entry != &g_sites.back()) {
+    entry->site = site;
+  }
+  ++entry->count;
+  entry->max_cycles = std::max(entry->max_cycles, cycles);
+  entry->total_cycles += cycles;
+}
+
+#endif  // PW_SYNC_PARTICLE_IRQ_PROFILING
+
+void OnLocked([[maybe_unused]] backend::NativeInterruptSpinLock& native,
+              [[maybe_unused]] const void* site) {
+#if PW_SYNC_PARTICLE_IRQ_PROFILING
+  native.site = site;
+  native.locked_at = Cycles();
+#endif  // PW_SYNC_PARTICLE_IRQ_PROFILING
+}
+
+void OnUnlocking([[maybe_unused]] backend::NativeInterruptSpinLock& native) {
+#if PW_SYNC_PARTICLE_IRQ_PROFILING
+  Record(native.site, Cycles() - native.locked_at);
+#endif  // PW_SYNC_PARTICLE_IRQ_PROFILING
+}
+
+}  // namespace
 
 void InterruptSpinLock::lock() {
   // Save the current interrupt state and disable interrupts.
-  native_type_.saved_state = HAL_disable_irq();
+  const int saved = HAL_disable_irq();
+  // Single core with interrupts off: a held lock here means this context
+  // (or the code it interrupted) already holds it. Overwriting saved_state
+  // would lose the outer interrupt state.
+  PW_ASSERT(!native_type_.locked);
+  native_type_.saved_state = saved;
   native_type_.locked = true;
+  OnLocked(native_type_, __builtin_return_address(0));
 }
 
 bool InterruptSpinLock::try_lock() {
@@ -26,13 +97,47 @@ bool InterruptSpinLock::try_lock() {
   // Not locked, acquire the lock.
   native_type_.saved_state = saved;
   native_type_.locked = true;
+  OnLocked(native_type_, __builtin_return_address(0));
   return true;
 }
 
 void InterruptSpinLock::unlock() {
+  PW_ASSERT(native_type_.locked);
+  OnUnlocking(native_type_);
   native_type_.locked = false;
   // Restore the previous interrupt state.
   HAL_enable_irq(native_type_.saved_state);
 }
 
+namespace backend {
+
+size_t ReadIrqProfile([[maybe_unused]] span<IrqSiteStats> out) {
+#if PW_SYNC_PARTICLE_IRQ_PROFILING
+  const int saved = HAL_disable_irq();
+  size_t count = 0;
+  for (const IrqSiteStats& entry : g_sites) {
+    if (entry.count > 0 && count < out.size()) {
+      out[count++] = entry;
+    }
+  }
+  HAL_enable_irq(saved);
+  std::sort(out.begin(), out.begin() + count,
+            [](const IrqSiteStats& a, const IrqSiteStats& b) {
+              return a.max_cycles > b.max_cycles;
+            });
+  return count;
+#else
+  return 0;
+#endif  // PW_SYNC_PARTICLE_IRQ_PROFILING
+}
+
+void ResetIrqProfile() {
+#if PW_SYNC_PARTICLE_IRQ_PROFILING
+  const int saved = HAL_disable_irq();
+  g_sites = {};
+  HAL_enable_irq(saved);
+#endif  // PW_SYNC_PARTICLE_IRQ_PROFILING
+}
+
+}  // namespace backend
 }  // namespace pw::sync
@@ -0,0 +1,133 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pw_sync_particle/mutex_profile.h"
+
+#include <algorithm>
+
+#include "concurrent_hal.h"
+#include "hal_irq_flag.h"
+#include "pw_sync_particle/config.h"
+#include "timer_hal.h"
+
+namespace pw::sync::backend {
+
+#if PW_SYNC_PARTICLE_MUTEX_PROFILING
+
+namespace {
+
+// Registry of live mutexes. Guarded by masking interrupts: the mutexes
+// themselves can't be used to lock it.
+NativeMutex* g_mutexes = nullptr;
+
+MutexProfile ToProfile(const NativeMutex& mutex, const void* address) {
+  return MutexProfile{
+      .name = mutex.name,
+      .mutex = address,
+      .acquisitions = mutex.stats.acquisitions,
+      .contended = mutex.stats.contended,
+      .timeouts = mutex.stats.timeouts,
+      .total_wait_us = mutex.stats.total_wait_us,
+      .max_wait_us = mutex.stats.max_wait_us,
+      .max_hold_us = mutex.stats.max_hold_us,
+  };
+}
+
+}  // namespace
+
+void RegisterMutex(NativeMutex& mutex) {
+  const int saved = HAL_disable_irq();
+  mutex.next = g_mutexes;
+  g_mutexes = &mutex;
+  HAL_enable_irq(saved);
+}
+
+void UnregisterMutex(NativeMutex& mutex) {
+  const int saved = HAL_disable_irq();
+  for (NativeMutex** link = &g_mutexes; *link != nullptr;
+       link = &(*link)->next) {
+    if (*link == &mutex) {
+      *link = mutex.next;
+      break;
+    }
+  }
+  HAL_enable_irq(saved);
+}
+
+void ProfiledLock(NativeMutex& mutex) {
+  if (os_mutex_trylock(mutex.handle) == 0) {
+    OnMutexAcquired(mutex, /*contended=*/false, 0);
+    return;
+  }
+  const uint32_t start = HAL_Timer_Get_Micro_Seconds();
+  os_mutex_lock(mutex.handle);
+  OnMutexAcquired(
+      mutex, /*contended=*/true, HAL_Timer_Get_Micro_Seconds() - start);
+}
+
+void OnMutexAcquired(NativeMutex& mutex, bool contended, uint32_t wait_us) {
+  MutexStats& stats = mutex.stats;
+  ++stats.acquisitions;
+  if (contended) {
+    ++stats.contended;
+    stats.total_wait_us += wait_us;
+    stats.max_wait_us = std::max(stats.max_wait_us, wait_us);
+  }
+  mutex.acquired_at_us = HAL_Timer_Get_Micro_Seconds();
+}
+
+void OnMutexReleasing(NativeMutex& mutex) {
+  const uint32_t held_us = HAL_Timer_Get_Micro_Seconds() - mutex.acquired_at_us;
+  mutex.stats.max_hold_us = std::max(mutex.stats.max_hold_us, held_us);
+}
+
+void NameMutex(Mutex& mutex, const char* name) {
+  mutex.native_handle().name = name;
+}
+
+size_t ReadMutexProfiles(span<MutexProfile> out) {
+  const auto longer_wait = [](const MutexProfile& a, const MutexProfile& b) {
+    return a.total_wait_us > b.total_wait_us;
+  };
+  size_t count = 0;
+  const int saved = HAL_disable_irq();
+  for (const NativeMutex* mutex = g_mutexes; mutex != nullptr;
+       mutex = mutex->next) {
+    if (mutex->stats.acquisitions == 0 || out.empty()) {
+      continue;
+    }
+    // The pw::sync::Mutex holds the native type as its only member
+    const MutexProfile profile = ToProfile(*mutex, mutex);
+    if (count < out.size()) {
+      out[count++] = profile;
+    } else if (longer_wait(profile, out[count - 1])) {
+      out[count - 1] = profile;
+    } else {
+      continue;
+    }
+    // Keep the kept entries sorted so the last one is the one to replace
+    std::sort(out.begin(), out.begin() + count, longer_wait);
+  }
+  HAL_enable_irq(saved);
+  return count;
+}
+
+void ResetMutexProfiles() {
+  const int saved = HAL_disable_irq();
+  for (NativeMutex* mutex = g_mutexes; mutex != nullptr; mutex = mutex->next) {
+    mutex->stats = MutexStats{};
+  }
+  HAL_enable_irq(saved);
+}
+
+#else
+
+void NameMutex(Mutex&, const char*) {}
+
+size_t ReadMutexProfiles(span<MutexProfile>) { return 0; }
+
+void ResetMutexProfiles() {}
+
+#endif  // PW_SYNC_PARTICLE_MUTEX_PROFILING
+
+}  // namespace pw::sync::backend
@@ -9,28 +9,29 @@
 #include "pw_assert/assert.h"
 #include "pw_chrono/system_clock.h"
 #include "pw_sync/binary_semaphore.h"
+#include "pw_sync_particle/interrupt_context.h"
+#include "pw_sync_particle/semaphore_pool.h"
 
 namespace pw::sync {
 
-inline BinarySemaphore::BinarySemaphore() : native_type_(nullptr) {
-  // Create a binary semaphore: max_count=1, initial_count=0 (starts empty)
-  int result = os_semaphore_create(&native_type_, 1, 0);
-  PW_DASSERT(result == 0);
+inline BinarySemaphore::BinarySemaphore()
+    : native_type_(backend::AcquirePooledBinarySemaphore()) {
+  // Binary semaphore: max_count=1, initial_count=0 (starts empty)
+  PW_DASSERT(native_type_ != nullptr);
 }
 
 inline BinarySemaphore::~BinarySemaphore() {
-  if (native_type_ != nullptr) {
-    os_semaphore_destroy(native_type_);
-  }
+  backend::ReleasePooledBinarySemaphore(native_type_);
 }
 
 inline void BinarySemaphore::release() {
-  // Give (post) the semaphore. The reserved parameter is not used.
-  // It's fine if the semaphore already has a count of 1.
-  os_semaphore_give(native_type_, false);
+  // Thread or interrupt context. It's fine if the semaphore already has a
+  // count of 1.
+  backend::GiveSemaphore(native_type_);
 }
 
 inline void BinarySemaphore::acquire() {
+  PW_DASSERT(!backend::InInterruptContext());
   // Take (wait) the semaphore indefinitely.
   // CONCURRENT_WAIT_FOREVER is (system_tick_t)-1
   int result = os_semaphore_take(native_type_, CONCURRENT_WAIT_FOREVER, false);
@@ -0,0 +1,39 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+
+// Configuration options for pw_sync_particle.
+
+// Released binary semaphores kept for reuse by BinarySemaphore and
+// ThreadNotification (see semaphore_pool.h). 0 disables pooling.
+#ifndef PW_SYNC_PARTICLE_SEMAPHORE_POOL_SIZE
+#define PW_SYNC_PARTICLE_SEMAPHORE_POOL_SIZE 16
+#endif
+
+// Record how long each InterruptSpinLock call site keeps interrupts
+// disabled, using the DWT cycle counter (see irq_profile.h). Adds a few
+// cycles to every lock()/unlock(); meant for profiling builds.
+#ifndef PW_SYNC_PARTICLE_IRQ_PROFILING
+#define PW_SYNC_PARTICLE_IRQ_PROFILING 0
+#endif
+
+// Record acquisitions, contention, wait and hold times per Mutex and
+// TimedMutex (see mutex_profile.h). Adds a timer read to every lock and
+// unlock; meant for profiling builds.
+#ifndef PW_SYNC_PARTICLE_MUTEX_PROFILING
+#define PW_SYNC_PARTICLE_MUTEX_PROFILING 0
+#endif
+
+namespace pw::sync::backend::config {
+
+inline constexpr size_t kSemaphorePoolSize =
+    PW_SYNC_PARTICLE_SEMAPHORE_POOL_SIZE;
+
+// Distinct InterruptSpinLock call sites tracked with IRQ profiling; later
+// sites are counted together under a null site.
+inline constexpr size_t kIrqProfileSites = 16;
+
+}  // namespace pw::sync::backend::config
@@ -9,6 +9,7 @@
 #include "pw_assert/assert.h"
 #include "pw_chrono/system_clock.h"
 #include "pw_sync/counting_semaphore.h"
+#include "pw_sync_particle/interrupt_context.h"
 
 namespace pw::sync {
 
@@ -29,6 +30,7 @@ inline CountingSemaphore::~CountingSemaphore() {
 }
 
 inline void CountingSemaphore::acquire() {
+  PW_DASSERT(!backend::InInterruptContext());
   // Take (wait) the semaphore indefinitely.
   int result = os_semaphore_take(native_type_, CONCURRENT_WAIT_FOREVER, false);
   PW_DASSERT(result == 0);
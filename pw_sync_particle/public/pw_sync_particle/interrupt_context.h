@@ -0,0 +1,35 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Interrupt context helpers shared by the pw_sync_particle backends.
+//
+// Pigweed allows release() of semaphores and thread notifications from
+// interrupts. Device OS's os_semaphore_give() checks the execution context
+// itself: in a handler it uses xSemaphoreGiveFromISR() and requests a
+// context switch (portYIELD_FROM_ISR) when the give woke a higher-priority
+// thread, so the waiter runs as soon as the handler returns. Its bool
+// argument is reserved and ignored. GiveSemaphore() is the one place that
+// relies on this; the blocking paths assert they are not in a handler.
+
+#pragma once
+
+#include <cstdint>
+
+#include "concurrent_hal.h"
+
+namespace pw::sync::backend {
+
+// True while an exception or interrupt handler runs (IPSR != 0).
+inline bool InInterruptContext() {
+  uint32_t ipsr;
+  asm volatile("mrs %0, ipsr" : "=r"(ipsr));
+  return ipsr != 0;
+}
+
+// Give `semaphore` from a thread or an interrupt handler. Returns 0 on
+// success, non-zero if the count is already at its maximum.
+inline int GiveSemaphore(os_semaphore_t semaphore) {
+  return os_semaphore_give(semaphore, /*reserved=*/false);
+}
+
+}  // namespace pw::sync::backend
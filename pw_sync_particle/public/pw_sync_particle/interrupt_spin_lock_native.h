@@ -5,6 +5,8 @@
 
 #include <cstdint>
 
+#include "pw_sync_particle/config.h"
+
 namespace pw::sync::backend {
 
 // Native interrupt spin lock state for Particle Device OS.
@@ -12,6 +14,10 @@ namespace pw::sync::backend {
 struct NativeInterruptSpinLock {
   volatile bool locked = false;
   int32_t saved_state = 0;
+#if PW_SYNC_PARTICLE_IRQ_PROFILING
+  uint32_t locked_at = 0;      // DWT cycle count when locked
+  const void* site = nullptr;  // Return address of the lock() call
+#endif  // PW_SYNC_PARTICLE_IRQ_PROFILING
 };
 
 using NativeInterruptSpinLockHandle = NativeInterruptSpinLock&;
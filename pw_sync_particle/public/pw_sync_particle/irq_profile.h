@@ -0,0 +1,35 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Interrupt-disabled time per InterruptSpinLock call site.
+//
+// With PW_SYNC_PARTICLE_IRQ_PROFILING=1, every InterruptSpinLock records,
+// per call site, how often it was taken and how many CPU cycles interrupts
+// stayed disabled. A site is the return address of the lock() call, i.e.
+// the function holding the lock; resolve it with addr2line against the
+// firmware ELF. Without the flag, ReadIrqProfile() returns nothing.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_span/span.h"
+
+namespace pw::sync::backend {
+
+struct IrqSiteStats {
+  const void* site = nullptr;  // nullptr: sites beyond the table
+  uint32_t count = 0;          // Lock acquisitions
+  uint32_t max_cycles = 0;     // Longest interrupts-disabled section
+  uint64_t total_cycles = 0;   // Sum over all acquisitions
+};
+
+// Copy the recorded sites into `out`, longest max_cycles first. Returns the
+// number of entries written.
+size_t ReadIrqProfile(span<IrqSiteStats> out);
+
+// Forget all recorded sites.
+void ResetIrqProfile();
+
+}  // namespace pw::sync::backend
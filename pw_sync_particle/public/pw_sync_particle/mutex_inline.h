@@ -3,44 +3,63 @@
 //
 // pw_sync mutex backend inline implementations for Particle Device OS.
 //
-// Implementation note: Uses a binary semaphore (max=1, initial=1) instead of
-// os_mutex_t to enable TimedMutex to use os_semaphore_take with timeout.
-// Trade-off: Binary semaphores lack priority inheritance that mutexes provide.
+// Implementation note: Uses os_mutex_t, a FreeRTOS mutex with priority
+// inheritance: a low-priority holder is boosted while a higher-priority
+// thread waits, so medium-priority work cannot starve the waiter. FreeRTOS
+// mutexes are semaphore handles, which lets TimedMutex wait with
+// os_semaphore_take and a timeout on the same handle.
 
 #pragma once
 
 #include "concurrent_hal.h"
 #include "pw_assert/assert.h"
 #include "pw_sync/mutex.h"
+#include "pw_sync_particle/config.h"
 
 namespace pw::sync {
 
-inline Mutex::Mutex() : native_type_(nullptr) {
-  // Create a binary semaphore: max_count=1, initial_count=1 (starts unlocked)
-  int result = os_semaphore_create(&native_type_, 1, 1);
+inline Mutex::Mutex() : native_type_{} {
+  int result = os_mutex_create(&backend::OsMutex(native_type_));
   PW_DASSERT(result == 0);
+#if PW_SYNC_PARTICLE_MUTEX_PROFILING
+  backend::RegisterMutex(native_type_);
+#endif  // PW_SYNC_PARTICLE_MUTEX_PROFILING
 }
 
 inline Mutex::~Mutex() {
-  if (native_type_ != nullptr) {
-    os_semaphore_destroy(native_type_);
+#if PW_SYNC_PARTICLE_MUTEX_PROFILING
+  backend::UnregisterMutex(native_type_);
+#endif  // PW_SYNC_PARTICLE_MUTEX_PROFILING
+  if (backend::OsMutex(native_type_) != nullptr) {
+    os_mutex_destroy(backend::OsMutex(native_type_));
   }
 }
 
 inline void Mutex::lock() {
-  // Take the semaphore indefinitely.
-  int result = os_semaphore_take(native_type_, CONCURRENT_WAIT_FOREVER, false);
+#if PW_SYNC_PARTICLE_MUTEX_PROFILING
+  backend::ProfiledLock(native_type_);
+#else
+  int result = os_mutex_lock(native_type_);
   PW_DASSERT(result == 0);
+#endif  // PW_SYNC_PARTICLE_MUTEX_PROFILING
 }
 
 inline bool Mutex::try_lock() {
-  // Try to take with zero timeout (non-blocking).
-  return os_semaphore_take(native_type_, 0, false) == 0;
+  // Non-blocking attempt.
+  const bool locked = os_mutex_trylock(backend::OsMutex(native_type_)) == 0;
+#if PW_SYNC_PARTICLE_MUTEX_PROFILING
+  if (locked) {
+    backend::OnMutexAcquired(native_type_, /*contended=*/false, 0);
+  }
+#endif  // PW_SYNC_PARTICLE_MUTEX_PROFILING
+  return locked;
 }
 
 inline void Mutex::unlock() {
-  // Give the semaphore.
-  int result = os_semaphore_give(native_type_, false);
+#if PW_SYNC_PARTICLE_MUTEX_PROFILING
+  backend::OnMutexReleasing(native_type_);
+#endif  // PW_SYNC_PARTICLE_MUTEX_PROFILING
+  int result = os_mutex_unlock(backend::OsMutex(native_type_));
   PW_ASSERT(result == 0);
 }
 
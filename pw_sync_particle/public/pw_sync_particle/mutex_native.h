@@ -3,17 +3,57 @@
 //
 // pw_sync mutex backend native type for Particle Device OS.
 //
-// Implementation note: Uses a binary semaphore (max=1, initial=1) instead of
-// os_mutex_t to enable TimedMutex to use os_semaphore_take with timeout.
-// Trade-off: Binary semaphores lack priority inheritance that mutexes provide.
+// Implementation note: Uses os_mutex_t (FreeRTOS mutex with priority
+// inheritance). See mutex_inline.h.
 
 #pragma once
 
+#include <cstdint>
+
+#include "pw_sync_particle/config.h"
+
 namespace pw::sync::backend {
 
-// os_semaphore_t in Device OS is void* (handle to FreeRTOS semaphore).
-// We use a binary semaphore configured as mutex (max=1, initial=1).
+#if PW_SYNC_PARTICLE_MUTEX_PROFILING
+
+// Counters of one mutex. Updated by the thread holding the mutex, so they
+// need no lock of their own.
+struct MutexStats {
+  uint32_t acquisitions = 0;   // Successful lock()/try_lock*()
+  uint32_t contended = 0;      // Acquisitions that had to wait
+  uint32_t timeouts = 0;       // Timed locks that gave up
+  uint64_t total_wait_us = 0;  // Time spent waiting in contended locks
+  uint32_t max_wait_us = 0;
+  uint32_t max_hold_us = 0;
+};
+
+struct NativeMutex {
+  void* handle = nullptr;  // os_mutex_t
+  const char* name = nullptr;
+  NativeMutex* next = nullptr;  // Registry of live mutexes
+  uint32_t acquired_at_us = 0;
+  MutexStats stats;
+};
+
+inline void*& OsMutex(NativeMutex& mutex) { return mutex.handle; }
+
+// Profiling hooks (mutex_profile.cc)
+void RegisterMutex(NativeMutex& mutex);
+void UnregisterMutex(NativeMutex& mutex);
+void ProfiledLock(NativeMutex& mutex);
+void OnMutexAcquired(NativeMutex& mutex, bool contended, uint32_t wait_us);
+void OnMutexReleasing(NativeMutex& mutex);
+
+#else
+
+// os_mutex_t in Device OS is void* (handle to a FreeRTOS mutex, which is a
+// semaphore handle and can be taken with os_semaphore_take).
 using NativeMutex = void*;
+
+inline void*& OsMutex(NativeMutex& mutex) { return mutex; }
+
+#endif  // PW_SYNC_PARTICLE_MUTEX_PROFILING
+
 using NativeMutexHandle = NativeMutex&;
 
 }  // namespace pw::sync::backend
@@ -0,0 +1,45 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Contention statistics of Mutex and TimedMutex.
+//
+// With PW_SYNC_PARTICLE_MUTEX_PROFILING=1, every mutex counts its
+// acquisitions, contended acquisitions and timed-out attempts, and tracks
+// total and maximum wait time and maximum hold time. Mutexes are found
+// through a registry of all live instances; NameMutex() labels the ones
+// worth finding. Without the flag, NameMutex() does nothing and
+// ReadMutexProfiles() returns nothing.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_span/span.h"
+#include "pw_sync/mutex.h"
+
+namespace pw::sync::backend {
+
+struct MutexProfile {
+  const char* name = nullptr;   // As set by NameMutex(), else nullptr
+  const void* mutex = nullptr;  // Address of the pw::sync::Mutex
+  uint32_t acquisitions = 0;
+  uint32_t contended = 0;
+  uint32_t timeouts = 0;
+  uint64_t total_wait_us = 0;
+  uint32_t max_wait_us = 0;
+  uint32_t max_hold_us = 0;
+};
+
+// Label `mutex` in profiles. `name` must outlive the mutex.
+void NameMutex(Mutex& mutex, const char* name);
+
+// Copy the profiles of live mutexes that were acquired at least once into
+// `out`, longest total wait first. Returns the number written. Counters
+// of a mutex held meanwhile may be mid-update.
+size_t ReadMutexProfiles(span<MutexProfile> out);
+
+// Zero the counters of all live mutexes.
+void ResetMutexProfiles();
+
+}  // namespace pw::sync::backend
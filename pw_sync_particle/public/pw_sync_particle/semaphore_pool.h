@@ -0,0 +1,33 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Recycles binary semaphores for BinarySemaphore and ThreadNotification.
+//
+// Device OS only creates semaphores on its heap (xSemaphoreCreate*Static is
+// not exported through the dynalib), so primitives cannot own static
+// storage. Instead, a destroyed primitive returns its semaphore to a free
+// list and the next one takes it from there: the heap is only touched when
+// more semaphores are alive than ever before. Call
+// ReserveBinarySemaphores() at startup to move even that out of runtime.
+
+#pragma once
+
+#include <cstddef>
+
+#include "concurrent_hal.h"
+
+namespace pw::sync::backend {
+
+// A binary semaphore (max 1, initially empty): from the pool, or newly
+// created if the pool is empty. nullptr if creation failed.
+os_semaphore_t AcquirePooledBinarySemaphore();
+
+// Return a semaphore from AcquirePooledBinarySemaphore(). It is drained and
+// pooled, or destroyed if the pool is full. Not from interrupts.
+void ReleasePooledBinarySemaphore(os_semaphore_t semaphore);
+
+// Create semaphores until the pool holds `count` (at most the pool size).
+// Returns the number pooled.
+size_t ReserveBinarySemaphores(size_t count);
+
+}  // namespace pw::sync::backend
@@ -7,32 +7,25 @@
 
 #include "concurrent_hal.h"
 #include "pw_sync/thread_notification.h"
+#include "pw_sync_particle/semaphore_pool.h"
 
 namespace pw::sync {
 
 inline ThreadNotification::ThreadNotification()
     : native_type_{
           .semaphore = nullptr,
-          .initialized = false,
+          .state = backend::kNotificationIdle,
       } {}
 
 inline ThreadNotification::~ThreadNotification() {
-  if (native_type_.initialized && native_type_.semaphore != nullptr) {
-    os_semaphore_destroy(native_type_.semaphore);
-  }
+  backend::ReleasePooledBinarySemaphore(native_type_.semaphore);
 }
 
 inline bool ThreadNotification::try_acquire() {
-  // Lazy init if needed (can't do in constexpr constructor)
-  if (!native_type_.initialized) {
-    int result = os_semaphore_create(&native_type_.semaphore, 1, 0);
-    if (result != 0) {
-      return false;
-    }
-    native_type_.initialized = true;
-  }
-  // Try to take with zero timeout (non-blocking)
-  return os_semaphore_take(native_type_.semaphore, 0, false) == 0;
+  // No kernel call: a pending notification is just a state change
+  uint8_t expected = backend::kNotificationPending;
+  return native_type_.state.compare_exchange_strong(
+      expected, backend::kNotificationIdle, std::memory_order_acquire);
 }
 
 inline ThreadNotification::native_handle_type
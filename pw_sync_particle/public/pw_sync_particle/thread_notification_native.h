@@ -5,16 +5,34 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+
 #include "concurrent_hal.h"
 
 namespace pw::sync::backend {
 
-// Use a binary semaphore for thread notification.
-// os_thread_wait/notify are not available in dynalib, but os_semaphore_* are.
+// FreeRTOS task notifications (os_thread_wait/notify) are not available in
+// dynalib, so blocking still goes through a binary semaphore. The state
+// word keeps it off the common paths: a release() with nobody waiting and
+// an acquire() of a pending notification are one atomic operation each,
+// and the semaphore is only obtained once a thread actually blocks.
+enum NotificationState : uint8_t {
+  kNotificationIdle = 0,     // Not notified, nobody blocked
+  kNotificationPending = 1,  // Notified, not yet acquired
+  kNotificationWaiting = 2,  // The waiting thread blocks on the semaphore
+};
+
 struct NativeThreadNotification {
-  os_semaphore_t semaphore;
-  bool initialized;
+  os_semaphore_t semaphore;  // From the pool on the first blocking wait
+  std::atomic<uint8_t> state;
 };
 using NativeThreadNotificationHandle = NativeThreadNotification&;
 
+// Shared by ThreadNotification and TimedThreadNotification (see
+// thread_notification.cc)
+bool EnsureSemaphore(NativeThreadNotification& native_type);
+bool BeginWait(NativeThreadNotification& native_type);
+bool CancelWait(NativeThreadNotification& native_type);
+
 }  // namespace pw::sync::backend
@@ -0,0 +1,87 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pw_sync_particle/semaphore_pool.h"
+
+#include <algorithm>
+#include <array>
+
+#include "hal_irq_flag.h"
+#include "pw_sync_particle/config.h"
+
+namespace pw::sync::backend {
+namespace {
+
+// Plain storage plus an interrupt-masked section: the pool is used by the
+// sync primitives themselves, so it cannot lock with them.
+std::array<os_semaphore_t, std::max<size_t>(config::kSemaphorePoolSize, 1)>
+    g_pool;
+size_t g_pooled = 0;
+
+os_semaphore_t Pop() {
+  const int saved = HAL_disable_irq();
+  os_semaphore_t semaphore = nullptr;
+  if (g_pooled > 0) {
+    semaphore = g_pool[--g_pooled];
+  }
+  HAL_enable_irq(saved);
+  return semaphore;
+}
+
+bool Push(os_semaphore_t semaphore) {
+  const int saved = HAL_disable_irq();
+  const bool pooled = g_pooled < config::kSemaphorePoolSize;
+  if (pooled) {
+    g_pool[g_pooled++] = semaphore;
+  }
+  HAL_enable_irq(saved);
+  return pooled;
+}
+
+os_semaphore_t Create() {
+  os_semaphore_t semaphore = nullptr;
+  if (os_semaphore_create(&semaphore, 1, 0) != 0) {
+    return nullptr;
+  }
+  return semaphore;
+}
+
+}  // namespace
+
+os_semaphore_t AcquirePooledBinarySemaphore() {
+  os_semaphore_t semaphore = Pop();
+  return semaphore != nullptr ? semaphore : Create();
+}
+
+void ReleasePooledBinarySemaphore(os_semaphore_t semaphore) {
+  if (semaphore == nullptr) {
+    return;
+  }
+  // A released but never acquired count would leak into the next owner
+  os_semaphore_take(semaphore, 0, false);
+  if (!Push(semaphore)) {
+    os_semaphore_destroy(semaphore);
+  }
+}
+
+size_t ReserveBinarySemaphores(size_t count) {
+  count = std::min(count, config::kSemaphorePoolSize);
+  while (true) {
+    const int saved = HAL_disable_irq();
+    const size_t pooled = g_pooled;
+    HAL_enable_irq(saved);
+    if (pooled >= count) {
+      return pooled;
+    }
+    os_semaphore_t semaphore = Create();
+    if (semaphore == nullptr) {
+      return pooled;
+    }
+    if (!Push(semaphore)) {
+      os_semaphore_destroy(semaphore);
+      return config::kSemaphorePoolSize;
+    }
+  }
+}
+
+}  // namespace pw::sync::backend
@@ -3,38 +3,93 @@
 
 #include "pw_sync/thread_notification.h"
 
+#include <atomic>
+
 #include "concurrent_hal.h"
 #include "pw_assert/check.h"
+#include "pw_sync_particle/interrupt_context.h"
+#include "pw_sync_particle/semaphore_pool.h"
 
 namespace pw::sync {
+namespace backend {
 
-// Lazy initialization of the semaphore.
-// We can't initialize in the constructor because it's constexpr.
-static void EnsureInitialized(backend::NativeThreadNotification& native_type) {
-  if (!native_type.initialized) {
-    // Create a binary semaphore with max_count=1, initial_count=0
-    int result = os_semaphore_create(&native_type.semaphore, 1, 0);
-    PW_CHECK(result == 0, "Failed to create semaphore");
-    native_type.initialized = true;
+// Only the single waiting thread calls this, before it publishes
+// kNotificationWaiting, so release() never sees a missing semaphore.
+bool EnsureSemaphore(NativeThreadNotification& native_type) {
+  if (native_type.semaphore == nullptr) {
+    native_type.semaphore = AcquirePooledBinarySemaphore();
   }
+  return native_type.semaphore != nullptr;
 }
 
-void ThreadNotification::acquire() {
-  EnsureInitialized(native_type_);
+// Consume a pending notification (true), or announce that the caller is
+// about to block on the semaphore (false). Call EnsureSemaphore() first.
+bool BeginWait(NativeThreadNotification& native_type) {
+  while (true) {
+    uint8_t expected = kNotificationIdle;
+    if (native_type.state.compare_exchange_strong(
+            expected, kNotificationWaiting, std::memory_order_acq_rel)) {
+      return false;
+    }
+    // Only release() moves away from kNotificationIdle: it is pending now
+    // (unless the pending notification is consumed concurrently, which
+    // would be a second waiter and is not allowed)
+    if (expected == kNotificationPending &&
+        native_type.state.compare_exchange_strong(
+            expected, kNotificationIdle, std::memory_order_acquire)) {
+      return true;
+    }
+  }
+}
+
+// Withdraw after a timed wait expired. False if release() got there first;
+// it has then given (or is about to give) the semaphore.
+bool CancelWait(NativeThreadNotification& native_type) {
+  uint8_t expected = kNotificationWaiting;
+  return native_type.state.compare_exchange_strong(
+      expected, kNotificationIdle, std::memory_order_acq_rel);
+}
+
+}  // namespace backend
 
-  // Wait indefinitely for the semaphore
+void ThreadNotification::acquire() {
+  if (try_acquire()) {
+    return;
+  }
+  PW_DCHECK(!backend::InInterruptContext(), "acquire() in an interrupt");
+  PW_CHECK(backend::EnsureSemaphore(native_type_),
+           "Failed to create semaphore");
+  if (backend::BeginWait(native_type_)) {
+    return;
+  }
+  // Wait indefinitely for release()
   int result = os_semaphore_take(native_type_.semaphore,
-                                  CONCURRENT_WAIT_FOREVER,
-                                  false);  // not from ISR
+                                 CONCURRENT_WAIT_FOREVER,
+                                 false);  // not from ISR
   PW_CHECK(result == 0, "Semaphore take failed");
 }
 
+// Safe from interrupt handlers: one compare-and-swap, plus an ISR-aware
+// give when the waiter is blocked
 void ThreadNotification::release() {
-  EnsureInitialized(native_type_);
-
-  // Give the semaphore (signal the waiting thread).
-  // Note: Returns non-zero if semaphore is already at max (1), which is fine.
-  os_semaphore_give(native_type_.semaphore, false);  // not from ISR
+  uint8_t state = native_type_.state.load(std::memory_order_relaxed);
+  while (true) {
+    if (state == backend::kNotificationPending) {
+      return;  // Already notified; the count saturates at 1
+    }
+    const uint8_t next = state == backend::kNotificationWaiting
+                             ? backend::kNotificationIdle
+                             : backend::kNotificationPending;
+    if (native_type_.state.compare_exchange_weak(
+            state, next, std::memory_order_acq_rel)) {
+      break;
+    }
+  }
+  if (state == backend::kNotificationWaiting) {
+    // The waiter blocks on the semaphore; hand the notification over there.
+    // From an interrupt, this switches to the waiter on return.
+    backend::GiveSemaphore(native_type_.semaphore);
+  }
 }
 
 }  // namespace pw::sync
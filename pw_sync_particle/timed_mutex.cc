@@ -5,10 +5,39 @@
 
 #include "concurrent_hal.h"
 #include "pw_chrono/system_clock.h"
+#include "pw_sync_particle/config.h"
+#include "timer_hal.h"
 
 using pw::chrono::SystemClock;
 
 namespace pw::sync {
+namespace {
+
+bool TakeFor(backend::NativeMutex& native, int64_t timeout_ms) {
+  // native is a FreeRTOS mutex; os_semaphore_take on it is a timed
+  // xSemaphoreTake, which keeps the priority inheritance.
+  void* const handle = backend::OsMutex(native);
+
+  // Handle timeouts that exceed the max value for system_tick_t.
+  // CONCURRENT_WAIT_FOREVER is (system_tick_t)-1, so we need to stay below that.
+  constexpr int64_t kMaxTimeoutMs =
+      static_cast<int64_t>(CONCURRENT_WAIT_FOREVER) - 1;
+
+  // For very long timeouts, we loop with max timeout chunks.
+  while (timeout_ms > kMaxTimeoutMs) {
+    if (os_semaphore_take(handle,
+                          static_cast<system_tick_t>(kMaxTimeoutMs),
+                          false) == 0) {
+      return true;
+    }
+    timeout_ms -= kMaxTimeoutMs;
+  }
+  return os_semaphore_take(handle,
+                           static_cast<system_tick_t>(timeout_ms),
+                           false) == 0;
+}
+
+}  // namespace
 
 bool TimedMutex::try_lock_for(SystemClock::duration timeout) {
   // Use non-blocking try_lock for negative and zero length durations.
@@ -22,30 +51,22 @@ bool TimedMutex::try_lock_for(SystemClock::duration timeout) {
   const int64_t timeout_ms =
       std::chrono::ceil<std::chrono::milliseconds>(timeout).count();
 
-  // Handle timeouts that exceed the max value for system_tick_t.
-  // CONCURRENT_WAIT_FOREVER is (system_tick_t)-1, so we need to stay below that.
-  constexpr int64_t kMaxTimeoutMs =
-      static_cast<int64_t>(CONCURRENT_WAIT_FOREVER) - 1;
-
-  if (timeout_ms > kMaxTimeoutMs) {
-    // For very long timeouts, we loop with max timeout chunks.
-    int64_t remaining_ms = timeout_ms;
-    while (remaining_ms > kMaxTimeoutMs) {
-      if (os_semaphore_take(native_handle(),
-                            static_cast<system_tick_t>(kMaxTimeoutMs),
-                            false) == 0) {
-        return true;
-      }
-      remaining_ms -= kMaxTimeoutMs;
-    }
-    return os_semaphore_take(native_handle(),
-                             static_cast<system_tick_t>(remaining_ms),
-                             false) == 0;
+#if PW_SYNC_PARTICLE_MUTEX_PROFILING
+  if (try_lock()) {
+    return true;
   }
-
-  return os_semaphore_take(native_handle(),
-                           static_cast<system_tick_t>(timeout_ms),
-                           false) == 0;
+  const uint32_t start = HAL_Timer_Get_Micro_Seconds();
+  if (!TakeFor(native_handle(), timeout_ms)) {
+    ++native_handle().stats.timeouts;  // Racy by design: diagnostics only
+    return false;
+  }
+  backend::OnMutexAcquired(native_handle(),
+                           /*contended=*/true,
+                           HAL_Timer_Get_Micro_Seconds() - start);
+  return true;
+#else
+  return TakeFor(native_handle(), timeout_ms);
+#endif  // PW_SYNC_PARTICLE_MUTEX_PROFILING
 }
 
 }  // namespace pw::sync
@@ -8,31 +8,30 @@
 #include "concurrent_hal.h"
 #include "pw_assert/check.h"
 #include "pw_chrono/system_clock.h"
+#include "pw_sync_particle/interrupt_context.h"
 
 using pw::chrono::SystemClock;
 
 namespace pw::sync {
 
-// Lazy initialization of the semaphore (same as thread_notification.cc)
-static void EnsureInitialized(backend::NativeThreadNotification& native_type) {
-  if (!native_type.initialized) {
-    // Create a binary semaphore with max_count=1, initial_count=0
-    int result = os_semaphore_create(&native_type.semaphore, 1, 0);
-    PW_CHECK(result == 0, "Failed to create semaphore");
-    native_type.initialized = true;
-  }
-}
-
 bool TimedThreadNotification::try_acquire_until(
     const SystemClock::time_point deadline) {
-  EnsureInitialized(native_handle());
+  // A pending notification needs no kernel call
+  if (try_acquire()) {
+    return true;
+  }
 
   // Check if deadline already passed
   SystemClock::time_point now = SystemClock::now();
   if (now >= deadline) {
-    // Try to acquire without blocking
-    int result = os_semaphore_take(native_handle().semaphore, 0, false);
-    return result == 0;
+    return false;
+  }
+
+  PW_DCHECK(!backend::InInterruptContext(), "blocking wait in an interrupt");
+  backend::NativeThreadNotification& native_type = native_handle();
+  PW_CHECK(backend::EnsureSemaphore(native_type), "Failed to create semaphore");
+  if (backend::BeginWait(native_type)) {
+    return true;
   }
 
   // Calculate timeout in milliseconds, rounding UP to ensure we wait at least
@@ -48,8 +47,16 @@ bool TimedThreadNotification::try_acquire_until(
       static_cast<system_tick_t>(std::min(timeout_ms, kMaxTimeoutMs));
 
   // Wait for semaphore with timeout
-  int result = os_semaphore_take(native_handle().semaphore, wait_ms, false);
-  return result == 0;
+  if (os_semaphore_take(native_type.semaphore, wait_ms, false) == 0) {
+    return true;
+  }
+  if (backend::CancelWait(native_type)) {
+    return false;
+  }
+  // release() claimed the wait just as it timed out; its give is imminent.
+  // Take it so it does not satisfy a later wait by mistake.
+  os_semaphore_take(native_type.semaphore, CONCURRENT_WAIT_FOREVER, false);
+  return true;
 }
 
 }  // namespace pw::sync
@@ -0,0 +1,34 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Configuration options for the UART and TCP socket sys_io backends
+// (//pw_sys_io_particle:sys_io_uart, :sys_io_socket). The USB backend
+// (:sys_io) has no options.
+
+// Hardware UART used by :sys_io_uart (hal_usart_interface_t). P2: Serial1
+// is HAL_USART_SERIAL1 on TX/RX.
+#ifndef PW_SYS_IO_PARTICLE_UART
+#define PW_SYS_IO_PARTICLE_UART HAL_USART_SERIAL1
+#endif
+
+#ifndef PW_SYS_IO_PARTICLE_UART_BAUD_RATE
+#define PW_SYS_IO_PARTICLE_UART_BAUD_RATE 921600
+#endif
+
+namespace pw::sys_io::particle::config {
+
+// HAL ring buffers of :sys_io_uart. Sized for an HDLC-framed RPC packet
+// in each direction.
+inline constexpr size_t kUartRxBufferSize = 1024;
+inline constexpr size_t kUartTxBufferSize = 1024;
+
+// How often :sys_io_socket polls for input (and for a connection, before
+// one is attached).
+inline constexpr uint32_t kSocketPollIntervalMs = 5;
+
+}  // namespace pw::sys_io::particle::config
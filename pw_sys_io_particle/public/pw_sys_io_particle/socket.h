@@ -0,0 +1,18 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "pb_socket/tcp_socket.h"
+
+namespace pw::sys_io::particle {
+
+// Route pw_sys_io through `socket` (//pw_sys_io_particle:sys_io_socket).
+// The application creates and connects the socket, e.g. once the network
+// is up, and may reconnect it at any time; nullptr detaches it.
+//
+// Until a connected socket is attached, reads wait and writes fail with
+// FailedPrecondition (log lines written then are lost).
+void SetSocket(pb::socket::TcpSocket* socket);
+
+}  // namespace pw::sys_io::particle
@@ -8,11 +8,16 @@
 // - ReadBytes: Blocks for first byte, then returns all available data.
 //   This is critical for pw_system:async which expects stream-like behavior.
 // - WriteLine: Protected by mutex for atomic log lines.
-// - Thread yields during blocking reads to avoid starving other RTOS threads.
+// - Blocking reads poll with a backoff sleep, so an idle reader does not
+//   starve other RTOS threads, and rarely while no USB host is attached.
 
 #include "pw_sys_io/sys_io.h"
 
+#include <algorithm>
+#include <cstddef>
+
 #include "concurrent_hal.h"
+#include "delay_hal.h"
 #include "usb_hal.h"
 
 namespace {
@@ -32,11 +37,67 @@ void EnsureInitialized() {
   }
 }
 
+// The USB HAL has no RX notification for user code, so poll: yield a few
+// times for low latency while data is streaming in, then sleep with an
+// interval that doubles up to kMaxPollIntervalMs. An idle reader thread
+// is then blocked nearly all the time instead of always runnable.
+constexpr int kYieldPolls = 8;
+constexpr uint32_t kMaxPollIntervalMs = 8;
+
+// Without a USB host nothing can arrive; check for one at this interval
+// so a field unit's reader doesn't wake the CPU every few milliseconds.
+constexpr uint32_t kDisconnectedPollIntervalMs = 250;
+
+void WaitForData() {
+  int polls = 0;
+  uint32_t interval_ms = 1;
+  while (HAL_USB_USART_Available_Data(kSerial) <= 0) {
+    if (!HAL_USB_USART_Is_Connected(kSerial)) {
+      HAL_Delay_Milliseconds(kDisconnectedPollIntervalMs);
+      polls = 0;
+      interval_ms = 1;
+      continue;
+    }
+    if (polls < kYieldPolls) {
+      ++polls;
+      os_thread_yield();
+      continue;
+    }
+    HAL_Delay_Milliseconds(interval_ms);
+    interval_ms = std::min(interval_ms * 2, kMaxPollIntervalMs);
+  }
+}
+
 // Write a byte directly - caller must hold mutex if atomicity needed
 inline void WriteByteUnsafe(uint8_t b) {
   HAL_USB_USART_Send_Data(kSerial, b);
 }
 
+// The HAL dynalib has no multi-byte CDC send, so bytes still go through
+// HAL_USB_USART_Send_Data one at a time. What this saves: the free space
+// is queried once per chunk, and a full TX buffer yields the CPU instead
+// of spinning inside Send_Data. Without a host (negative space), the HAL
+// decides what to do with each byte, as before. Caller holds the mutex.
+void WriteBytesUnsafe(const std::byte* data, size_t size) {
+  while (size > 0) {
+    const int32_t space = HAL_USB_USART_Available_Data_For_Write(kSerial);
+    size_t chunk;
+    if (space < 0) {
+      chunk = size;
+    } else if (space == 0) {
+      os_thread_yield();
+      continue;
+    } else {
+      chunk = std::min(size, static_cast<size_t>(space));
+    }
+    for (size_t i = 0; i < chunk; ++i) {
+      WriteByteUnsafe(static_cast<uint8_t>(data[i]));
+    }
+    data += chunk;
+    size -= chunk;
+  }
+}
+
 }  // namespace
 
 namespace pw::sys_io {
@@ -44,11 +105,7 @@ namespace pw::sys_io {
 Status ReadByte(std::byte* dest) {
   EnsureInitialized();
 
-  while (HAL_USB_USART_Available_Data(kSerial) <= 0) {
-    // Yield to allow other threads to run while waiting for data.
-    // Without this, busy-wait can starve other RTOS threads.
-    os_thread_yield();
-  }
+  WaitForData();
 
   int32_t data = HAL_USB_USART_Receive_Data(kSerial, 0);
   if (data < 0) {
@@ -93,9 +150,7 @@ StatusWithSize WriteLine(std::string_view s) {
   os_mutex_recursive_lock(g_write_mutex);
 
   // Write string content
-  for (char c : s) {
-    WriteByteUnsafe(static_cast<uint8_t>(c));
-  }
+  WriteBytesUnsafe(reinterpret_cast<const std::byte*>(s.data()), s.size());
 
   // Write CRLF
   WriteByteUnsafe('\r');
@@ -117,14 +172,19 @@ StatusWithSize ReadBytes(ByteSpan dest) {
     return StatusWithSize(result, 0);
   }
 
-  // Then read as many more bytes as available (non-blocking)
+  // Then drain what the HAL already holds, asking for the count once
   size_t bytes_read = 1;
-  while (bytes_read < dest.size_bytes()) {
-    result = TryReadByte(&dest[bytes_read]);
-    if (!result.ok()) {
-      break;  // No more data available right now
+  const int32_t available = HAL_USB_USART_Available_Data(kSerial);
+  if (available > 0) {
+    const size_t count = std::min(dest.size_bytes() - bytes_read,
+                                  static_cast<size_t>(available));
+    for (size_t i = 0; i < count; ++i) {
+      const int32_t data = HAL_USB_USART_Receive_Data(kSerial, 0);
+      if (data < 0) {
+        break;
+      }
+      dest[bytes_read++] = static_cast<std::byte>(data);
     }
-    ++bytes_read;
   }
 
   return StatusWithSize(bytes_read);
@@ -136,9 +196,7 @@ StatusWithSize WriteBytes(ConstByteSpan src) {
   // Lock for entire buffer - ensures atomic output
   os_mutex_recursive_lock(g_write_mutex);
 
-  for (size_t i = 0; i < src.size_bytes(); ++i) {
-    WriteByteUnsafe(static_cast<uint8_t>(src[i]));
-  }
+  WriteBytesUnsafe(src.data(), src.size_bytes());
 
   os_mutex_recursive_unlock(g_write_mutex);
 
@@ -0,0 +1,122 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// pw_sys_io backend for Particle Device OS over a TCP socket, for pw_system
+// RPC and logs on deployed devices without USB. The application supplies
+// the connected socket with SetSocket() (pw_sys_io_particle/socket.h).
+//
+// Key behaviors:
+// - ReadBytes: Blocks for first byte, then returns what one socket read
+//   delivers. The socket is read non-blocking and polled every
+//   config::kSocketPollIntervalMs.
+// - WriteLine/WriteBytes: Protected by mutex; a line and its CRLF go out
+//   in one WriteV call.
+
+#include <atomic>
+#include <cstddef>
+
+#include "concurrent_hal.h"
+#include "delay_hal.h"
+#include "pw_sys_io/sys_io.h"
+#include "pw_sys_io_particle/config.h"
+#include "pw_sys_io_particle/socket.h"
+
+namespace {
+
+namespace config = pw::sys_io::particle::config;
+
+std::atomic<pb::socket::TcpSocket*> g_socket{nullptr};
+bool g_initialized = false;
+os_mutex_recursive_t g_write_mutex = nullptr;
+
+void EnsureInitialized() {
+  if (!g_initialized) {
+    os_mutex_recursive_create(&g_write_mutex);
+    g_initialized = true;
+  }
+}
+
+// Connected socket, or nullptr
+pb::socket::TcpSocket* Connected() {
+  pb::socket::TcpSocket* socket = g_socket.load(std::memory_order_acquire);
+  return socket != nullptr && socket->IsConnected() ? socket : nullptr;
+}
+
+pw::Status Write(pw::span<const pw::ConstByteSpan> chunks) {
+  EnsureInitialized();
+  os_mutex_recursive_lock(g_write_mutex);
+  pb::socket::TcpSocket* socket = Connected();
+  const pw::Status status = socket != nullptr
+                                ? socket->WriteV(chunks)
+                                : pw::Status::FailedPrecondition();
+  os_mutex_recursive_unlock(g_write_mutex);
+  return status;
+}
+
+}  // namespace
+
+namespace pw::sys_io {
+
+namespace particle {
+
+void SetSocket(pb::socket::TcpSocket* socket) {
+  g_socket.store(socket, std::memory_order_release);
+}
+
+}  // namespace particle
+
+Status ReadByte(std::byte* dest) {
+  StatusWithSize result = ReadBytes(ByteSpan(dest, 1));
+  return result.status();
+}
+
+Status TryReadByte(std::byte* dest) {
+  pb::socket::TcpSocket* socket = Connected();
+  if (socket == nullptr) {
+    return Status::Unavailable();
+  }
+  StatusWithSize result = socket->Read(ByteSpan(dest, 1));
+  if (!result.ok()) {
+    return result.status();
+  }
+  return result.size() == 1 ? OkStatus() : Status::Unavailable();
+}
+
+Status WriteByte(std::byte b) {
+  const ConstByteSpan chunks[] = {ConstByteSpan(&b, 1)};
+  return Write(chunks);
+}
+
+StatusWithSize WriteLine(std::string_view s) {
+  static constexpr std::byte kNewline[] = {std::byte{'\r'}, std::byte{'\n'}};
+  const ConstByteSpan chunks[] = {as_bytes(span(s)), kNewline};
+  const Status status = Write(chunks);
+  return StatusWithSize(status, status.ok() ? s.size() + 2 : 0);
+}
+
+StatusWithSize ReadBytes(ByteSpan dest) {
+  if (dest.empty()) {
+    return StatusWithSize(0);
+  }
+
+  // Block for at least one byte. Errors (peer closed, not connected) mean
+  // waiting for the application to reconnect, not failing the reader.
+  while (true) {
+    pb::socket::TcpSocket* socket = Connected();
+    if (socket != nullptr) {
+      StatusWithSize result = socket->Read(dest);
+      if (result.ok() && result.size() > 0) {
+        return result;
+      }
+    }
+    HAL_Delay_Milliseconds(config::kSocketPollIntervalMs);
+  }
+}
+
+StatusWithSize WriteBytes(ConstByteSpan src) {
+  const ConstByteSpan chunks[] = {src};
+  const Status status = Write(chunks);
+  return StatusWithSize(status, status.ok() ? src.size_bytes() : 0);
+}
+
+}  // namespace pw::sys_io
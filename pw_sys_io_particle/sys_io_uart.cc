@@ -0,0 +1,144 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// pw_sys_io backend for Particle Device OS using a hardware UART, for
+// deployed devices without USB. Uses the pb_uart bulk helpers over the HAL
+// ring buffers, the same ones AsyncUart and ParticleUartStream use.
+//
+// Key behaviors match the USB backend (sys_io.cc):
+// - ReadBytes: Blocks for first byte, then returns all available data.
+// - WriteLine/WriteBytes: Protected by mutex for atomic log lines.
+// - Blocking reads sleep on the RX interrupt event where the port has one.
+//
+// The UART must not be used by anything else (Serial1 in Wiring, AsyncUart).
+
+#include <algorithm>
+#include <cstddef>
+
+#include "concurrent_hal.h"
+#include "delay_hal.h"
+#include "pb_uart/config.h"
+#include "pb_uart/usart_io.h"
+#include "pw_sys_io/sys_io.h"
+#include "pw_sys_io_particle/config.h"
+#include "usart_hal.h"
+
+namespace {
+
+namespace config = pw::sys_io::particle::config;
+
+constexpr hal_usart_interface_t kSerial = PW_SYS_IO_PARTICLE_UART;
+constexpr uint32_t kIdleWaitMs = 100;
+
+// The HAL DMA engine wants 32-byte aligned ring buffers
+alignas(32) std::byte g_rx_buffer[config::kUartRxBufferSize];
+alignas(32) std::byte g_tx_buffer[config::kUartTxBufferSize];
+
+bool g_initialized = false;
+bool g_rx_events = false;
+os_mutex_recursive_t g_write_mutex = nullptr;
+
+void EnsureInitialized() {
+  if (g_initialized) {
+    return;
+  }
+  hal_usart_buffer_config_t buffers = {
+      .size = sizeof(hal_usart_buffer_config_t),
+      .rx_buffer = reinterpret_cast<uint8_t*>(g_rx_buffer),
+      .rx_buffer_size = static_cast<uint16_t>(sizeof(g_rx_buffer)),
+      .tx_buffer = reinterpret_cast<uint8_t*>(g_tx_buffer),
+      .tx_buffer_size = static_cast<uint16_t>(sizeof(g_tx_buffer)),
+  };
+  hal_usart_init_ex(kSerial, &buffers, nullptr);
+  hal_usart_begin_config(kSerial, PW_SYS_IO_PARTICLE_UART_BAUD_RATE,
+                         SERIAL_8N1, nullptr);
+#if PB_UART_CONFIG_HAL_EVENTS
+  g_rx_events =
+      hal_usart_pvt_enable_event(kSerial, HAL_USART_PVT_EVENT_READABLE) == 0;
+#endif  // PB_UART_CONFIG_HAL_EVENTS
+  os_mutex_recursive_create(&g_write_mutex);
+  g_initialized = true;
+}
+
+// Sleep until the RX interrupt fires, or poll where the port has no events
+void WaitForData() {
+  while (hal_usart_available(kSerial) <= 0) {
+#if PB_UART_CONFIG_HAL_EVENTS
+    if (g_rx_events) {
+      hal_usart_pvt_wait_event(kSerial, HAL_USART_PVT_EVENT_READABLE,
+                               kIdleWaitMs);
+      continue;
+    }
+#endif  // PB_UART_CONFIG_HAL_EVENTS
+    HAL_Delay_Milliseconds(1);
+  }
+}
+
+}  // namespace
+
+namespace pw::sys_io {
+
+Status ReadByte(std::byte* dest) {
+  EnsureInitialized();
+  while (pb::uart::ReadAvailable(kSerial, ByteSpan(dest, 1)) == 0) {
+    WaitForData();
+  }
+  return OkStatus();
+}
+
+Status TryReadByte(std::byte* dest) {
+  EnsureInitialized();
+  if (pb::uart::ReadAvailable(kSerial, ByteSpan(dest, 1)) == 0) {
+    return Status::Unavailable();
+  }
+  return OkStatus();
+}
+
+Status WriteByte(std::byte b) {
+  EnsureInitialized();
+  os_mutex_recursive_lock(g_write_mutex);
+  pb::uart::WriteAll(kSerial, ConstByteSpan(&b, 1));
+  os_mutex_recursive_unlock(g_write_mutex);
+  return OkStatus();
+}
+
+StatusWithSize WriteLine(std::string_view s) {
+  EnsureInitialized();
+  static constexpr std::byte kNewline[] = {std::byte{'\r'}, std::byte{'\n'}};
+
+  // Lock for entire line - ensures atomic log output
+  os_mutex_recursive_lock(g_write_mutex);
+  pb::uart::WriteAll(kSerial, as_bytes(span(s)));
+  pb::uart::WriteAll(kSerial, kNewline);
+  os_mutex_recursive_unlock(g_write_mutex);
+
+  return StatusWithSize(s.size() + 2);
+}
+
+StatusWithSize ReadBytes(ByteSpan dest) {
+  if (dest.empty()) {
+    return StatusWithSize(0);
+  }
+  EnsureInitialized();
+
+  // Block for at least one byte, then return everything buffered
+  size_t count = pb::uart::ReadAvailable(kSerial, dest);
+  while (count == 0) {
+    WaitForData();
+    count = pb::uart::ReadAvailable(kSerial, dest);
+  }
+  return StatusWithSize(count);
+}
+
+StatusWithSize WriteBytes(ConstByteSpan src) {
+  EnsureInitialized();
+
+  // Lock for entire buffer - ensures atomic output
+  os_mutex_recursive_lock(g_write_mutex);
+  pb::uart::WriteAll(kSerial, src);
+  os_mutex_recursive_unlock(g_write_mutex);
+
+  return StatusWithSize(src.size_bytes());
+}
+
+}  // namespace pw::sys_io
@@ -0,0 +1,26 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Use the Device OS application thread after pw_system has started.
+
+#pragma once
+
+#include "pw_function/function.h"
+
+namespace pw::system::particle {
+
+// Run `routine` on the Device OS application thread (the one that called
+// main()) when pw::system::StartAndClobberTheStack() hands over, instead
+// of parking it. The thread and its stack stay allocated either way, so
+// work moved here saves a thread of its own:
+//
+//   pw::system::particle::SetApplicationThreadRoutine([] {
+//     app_dispatcher.RunToCompletion();
+//   });
+//   pw::system::StartAndClobberTheStack(channel);
+//
+// Call before StartAndClobberTheStack(). If the routine returns, the thread
+// parks as without one.
+void SetApplicationThreadRoutine(Function<void()>&& routine);
+
+}  // namespace pw::system::particle
@@ -0,0 +1,66 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Static pools the Particle backends use instead of the Device OS heap.
+//
+// A deterministic build sizes the pools so that nothing after startup
+// allocates:
+//
+//   PW_THREAD_PARTICLE_CONTEXT_POOL_SIZE   contexts of pw::Thread without a
+//                                          static context
+//   PW_SYNC_PARTICLE_SEMAPHORE_POOL_SIZE   binary semaphores, filled at
+//                                          startup by ReserveBinarySemaphores()
+//   PB_CLOUD_NO_HEAP_VARIABLES=1           caller-owned cloud variables only
+//
+// Thread stacks and kernel objects remain Device OS heap allocations (the
+// dynalib has no static variants); they happen when threads and primitives
+// are created, i.e. at startup.
+//
+// Define PW_SYSTEM_PARTICLE_STATIC_MEMORY_BUDGET (bytes) to fail the build
+// when the pools grow beyond it.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "concurrent_hal.h"
+#include "pw_sync_particle/config.h"
+#include "pw_thread_particle/config.h"
+#include "pw_thread_particle/context.h"
+
+namespace pw::system::particle {
+
+struct StaticMemoryPool {
+  const char* name;
+  size_t count;
+  size_t bytes;
+};
+
+inline constexpr std::array<StaticMemoryPool, 2> kStaticMemoryPools = {{
+    {"thread_contexts",
+     thread::particle::config::kContextPoolSize,
+     thread::particle::config::kContextPoolSize *
+         sizeof(thread::particle::Context)},
+    {"binary_semaphores",
+     sync::backend::config::kSemaphorePoolSize,
+     sync::backend::config::kSemaphorePoolSize * sizeof(os_semaphore_t)},
+}};
+
+inline constexpr size_t kStaticMemoryBytes = [] {
+  size_t total = 0;
+  for (const StaticMemoryPool& pool : kStaticMemoryPools) {
+    total += pool.bytes;
+  }
+  return total;
+}();
+
+#ifdef PW_SYSTEM_PARTICLE_STATIC_MEMORY_BUDGET
+static_assert(kStaticMemoryBytes <= PW_SYSTEM_PARTICLE_STATIC_MEMORY_BUDGET,
+              "Static pools exceed PW_SYSTEM_PARTICLE_STATIC_MEMORY_BUDGET");
+#endif  // PW_SYSTEM_PARTICLE_STATIC_MEMORY_BUDGET
+
+// Log each pool and the total, e.g. from the init callback.
+void LogStaticMemory();
+
+}  // namespace pw::system::particle
@@ -0,0 +1,23 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#define PW_LOG_MODULE_NAME "pw_system_particle"
+
+#include "pw_system_particle/static_memory.h"
+
+#include "pw_log/log.h"
+
+namespace pw::system::particle {
+
+void LogStaticMemory() {
+  for (const StaticMemoryPool& pool : kStaticMemoryPools) {
+    PW_LOG_INFO("Static pool %s: %u entries, %u bytes",
+                pool.name,
+                static_cast<unsigned>(pool.count),
+                static_cast<unsigned>(pool.bytes));
+  }
+  PW_LOG_INFO("Static pools total: %u bytes",
+              static_cast<unsigned>(kStaticMemoryBytes));
+}
+
+}  // namespace pw::system::particle
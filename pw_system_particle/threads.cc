@@ -3,21 +3,42 @@
 //
 // Particle Device OS replacement for pw_system's scheduler startup.
 // On Particle, the scheduler is already running when user code starts,
-// so we just need to sleep forever instead of calling vTaskStartScheduler().
+// so instead of calling vTaskStartScheduler() the calling thread runs the
+// application thread routine, if any, and then blocks forever.
 
-#include <chrono>
+#include <utility>
 
-#include "pw_thread/sleep.h"
+#include "pw_sync/thread_notification.h"
+#include "pw_system_particle/application_thread.h"
 
 namespace pw::system {
+namespace particle {
+namespace {
+
+Function<void()> application_thread_routine;
+
+}  // namespace
+
+void SetApplicationThreadRoutine(Function<void()>&& routine) {
+  application_thread_routine = std::move(routine);
+}
+
+}  // namespace particle
 
 // This replaces the FreeRTOS version in pw_system/threads.cc
 // On Particle Device OS, the scheduler is already running.
 [[noreturn]] void StartSchedulerAndClobberTheStack() {
-  // Just keep the calling thread alive. The pw_system threads are already
-  // running since they were created before this call.
+  // The pw_system threads are already running since they were created
+  // before this call; put the application thread to use or keep it alive.
+  if (particle::application_thread_routine != nullptr) {
+    particle::application_thread_routine();
+  }
+  // An untimed wait: unlike a long sleep_for(), the thread never becomes
+  // due, so it adds no wake-ups and no deadline the idle thread
+  // (pb_power) has to honour
+  sync::ThreadNotification never_released;
   while (true) {
-    pw::this_thread::sleep_for(std::chrono::hours(24));
+    never_released.acquire();
   }
 }
 
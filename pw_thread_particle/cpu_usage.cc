@@ -0,0 +1,184 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pw_thread_particle/cpu_usage.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "concurrent_hal.h"
+#include "hal_irq_flag.h"
+#include "pw_thread_particle/config.h"
+
+namespace pw::thread::particle {
+namespace {
+
+// System control block and DWT cycle counter (ARMv8-M)
+constexpr uintptr_t kScbVtor = 0xE000ED08;
+constexpr uintptr_t kDemcr = 0xE000EDFC;
+constexpr uintptr_t kDwtCtrl = 0xE0001000;
+constexpr uintptr_t kDwtCyccnt = 0xE0001004;
+
+constexpr size_t kSysTickVector = 15;
+
+// RTL872x KM4 SRAM, where the Realtek startup code relocates the vector
+// table. Anywhere else (XIP flash) the table cannot be patched.
+constexpr uintptr_t kSramStart = 0x10000000;
+constexpr uintptr_t kSramEnd = 0x10080000;
+
+using Handler = void (*)();
+
+volatile uint32_t& Register(uintptr_t address) {
+  // NOLINTNEXTLINE(performance-no-int-to-ptr)
+  return *reinterpret_cast<volatile uint32_t*>(address);
+}
+
+uint32_t Cycles() { return Register(kDwtCyccnt); }
+
+void EnableCycleCounter() {
+  if ((Register(kDwtCtrl) & 1u) == 0) {
+    Register(kDemcr) = Register(kDemcr) | (1u << 24);  // TRCENA
+    Register(kDwtCtrl) = Register(kDwtCtrl) | 1u;      // CYCCNTENA
+  }
+}
+
+Handler* SysTickSlot() {
+  const uintptr_t table = Register(kScbVtor);
+  if (table < kSramStart || table >= kSramEnd) {
+    return nullptr;
+  }
+  // NOLINTNEXTLINE(performance-no-int-to-ptr)
+  return reinterpret_cast<Handler*>(table) + kSysTickVector;
+}
+
+struct Slot {
+  os_thread_t thread = nullptr;
+  uint32_t samples = 0;
+  uint64_t cycles = 0;
+};
+
+// Written by the SysTick handler; read and cleared with interrupts disabled
+std::array<Slot, config::kCpuUsageMaxThreads + 1> g_slots;  // + overflow
+uint64_t g_window_cycles = 0;
+uint32_t g_last_cycles = 0;
+Handler g_previous_handler = nullptr;
+
+void SampleTick() {
+  const uint32_t now = Cycles();
+  const uint32_t elapsed = now - g_last_cycles;
+  g_last_cycles = now;
+
+  // The tick interrupted this thread; the switch to the next one happens
+  // later, in PendSV
+  const os_thread_t current = os_thread_current(nullptr);
+  Slot* slot = &g_slots.back();
+  for (size_t i = 0; i < config::kCpuUsageMaxThreads; ++i) {
+    if (g_slots[i].thread == current || g_slots[i].thread == nullptr) {
+      slot = &g_slots[i];
+      break;
+    }
+  }
+  if (slot != &g_slots.back()) {
+    slot->thread = current;
+  }
+  ++slot->samples;
+  slot->cycles += elapsed;
+  g_window_cycles += elapsed;
+
+  g_previous_handler();
+}
+
+void ClearWindow() {
+  g_slots.fill(Slot{});
+  g_window_cycles = 0;
+}
+
+struct NameLookup {
+  span<ThreadCpuUsage> entries;
+};
+
+os_result_t CopyName(os_thread_dump_info_t* info, void* context) {
+  NameLookup& lookup = *static_cast<NameLookup*>(context);
+  if (info->name == nullptr) {
+    return 0;
+  }
+  for (ThreadCpuUsage& entry : lookup.entries) {
+    if (entry.thread != nullptr && entry.thread == info->thread) {
+      std::strncpy(entry.name, info->name, sizeof(entry.name) - 1);
+      break;
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+Status StartCpuSampling() {
+  Handler* slot = SysTickSlot();
+  if (slot == nullptr) {
+    return Status::Unavailable();
+  }
+  EnableCycleCounter();
+
+  const int32_t state = HAL_disable_irq();
+  if (*slot != &SampleTick) {
+    ClearWindow();
+    g_last_cycles = Cycles();
+    g_previous_handler = *slot;
+    *slot = &SampleTick;
+    __asm volatile("dsb\n\tisb" ::: "memory");
+  }
+  HAL_enable_irq(state);
+  return OkStatus();
+}
+
+void StopCpuSampling() {
+  Handler* slot = SysTickSlot();
+  if (slot == nullptr) {
+    return;
+  }
+  const int32_t state = HAL_disable_irq();
+  if (*slot == &SampleTick) {
+    *slot = g_previous_handler;
+    __asm volatile("dsb\n\tisb" ::: "memory");
+  }
+  HAL_enable_irq(state);
+}
+
+size_t SnapshotCpuUsage(span<ThreadCpuUsage> out) {
+  std::array<Slot, config::kCpuUsageMaxThreads + 1> slots;
+  const int32_t state = HAL_disable_irq();
+  slots = g_slots;
+  const uint64_t window_cycles = g_window_cycles;
+  ClearWindow();
+  HAL_enable_irq(state);
+
+  std::sort(slots.begin(), slots.end(), [](const Slot& a, const Slot& b) {
+    return a.cycles > b.cycles;
+  });
+
+  size_t count = 0;
+  for (const Slot& slot : slots) {
+    if (count == out.size() || slot.samples == 0) {
+      break;
+    }
+    ThreadCpuUsage& entry = out[count++];
+    entry = ThreadCpuUsage{};
+    entry.thread = slot.thread;
+    entry.samples = slot.samples;
+    entry.cycles = slot.cycles;
+    entry.cpu_hundredths =
+        static_cast<uint16_t>(slot.cycles * 10000 / window_cycles);
+  }
+
+  // Names only for threads that still exist; a handle of an exited thread
+  // is not dereferenced
+  NameLookup lookup{out.first(count)};
+  os_thread_scheduling(false, nullptr);
+  os_thread_dump(nullptr, CopyName, &lookup);
+  os_thread_scheduling(true, nullptr);
+  return count;
+}
+
+}  // namespace pw::thread::particle
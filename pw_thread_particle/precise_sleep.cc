@@ -0,0 +1,35 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+
+#include "pw_thread_particle/precise_sleep.h"
+
+#include "delay_hal.h"
+#include "pw_thread_particle/config.h"
+#include "timer_hal.h"
+
+namespace pw::thread::particle {
+namespace {
+
+// Microseconds left until `deadline_us`, negative once it passed
+int32_t Remaining(uint32_t deadline_us) {
+  return static_cast<int32_t>(deadline_us - HAL_Timer_Get_Micro_Seconds());
+}
+
+}  // namespace
+
+void SleepForMicros(uint32_t duration_us) {
+  SleepUntilMicros(HAL_Timer_Get_Micro_Seconds() + duration_us);
+}
+
+void SleepUntilMicros(uint32_t deadline_us) {
+  const int32_t remaining = Remaining(deadline_us);
+  const int32_t block_ms =
+      (remaining - static_cast<int32_t>(config::kSleepSpinUs)) / 1000;
+  if (block_ms > 0) {
+    HAL_Delay_Milliseconds(static_cast<uint32_t>(block_ms));
+  }
+  while (Remaining(deadline_us) > 0) {
+  }
+}
+
+}  // namespace pw::thread::particle
@@ -8,10 +8,16 @@
 
 // Configuration options for pw_thread_particle
 
+// Default stack size in bytes for threads created without an explicit
+// size (pw::thread::Options, pw::ThreadAttrs, StaticContextWithStack<>).
+#ifndef PW_THREAD_PARTICLE_DEFAULT_STACK_SIZE
+#define PW_THREAD_PARTICLE_DEFAULT_STACK_SIZE 4096
+#endif
+
 namespace pw::thread::particle::config {
 
-// Default stack size in bytes for dynamically allocated threads.
-inline constexpr size_t kDefaultStackSizeBytes = 4096;
+inline constexpr size_t kDefaultStackSizeBytes =
+    PW_THREAD_PARTICLE_DEFAULT_STACK_SIZE;
 
 // Device OS priorities typically range from 0-9 (OS_THREAD_PRIORITY_LOWEST
 // to OS_THREAD_PRIORITY_CRITICAL), with higher numbers being higher priority.
@@ -24,6 +30,39 @@ inline constexpr size_t kMinimumStackSizeBytes = 1024;
 
 }  // namespace pw::thread::particle::config
 
+// Number of threads the CPU usage sampler tracks per window (cpu_usage.h).
+// Further threads are counted in one overflow entry.
+#ifndef PW_THREAD_PARTICLE_CPU_USAGE_MAX_THREADS
+#define PW_THREAD_PARTICLE_CPU_USAGE_MAX_THREADS 24
+#endif
+
+// Microsecond sleeps (precise_sleep.h) block in whole milliseconds until
+// this much time is left, then busy-wait on the microsecond timer. A
+// millisecond delay ends on a kernel tick, up to 1 ms before the requested
+// time; the margin absorbs that plus the wake-up latency.
+#ifndef PW_THREAD_PARTICLE_SLEEP_SPIN_US
+#define PW_THREAD_PARTICLE_SLEEP_SPIN_US 1500
+#endif
+
+// Contexts for threads created without a static context. 0 allocates each
+// one with new; otherwise they come from a static pool of this many, and
+// creating a thread while all are in use fails a PW_CHECK instead of
+// touching the heap.
+#ifndef PW_THREAD_PARTICLE_CONTEXT_POOL_SIZE
+#define PW_THREAD_PARTICLE_CONTEXT_POOL_SIZE 0
+#endif
+
+namespace pw::thread::particle::config {
+
+inline constexpr size_t kContextPoolSize = PW_THREAD_PARTICLE_CONTEXT_POOL_SIZE;
+
+inline constexpr uint32_t kSleepSpinUs = PW_THREAD_PARTICLE_SLEEP_SPIN_US;
+
+inline constexpr size_t kCpuUsageMaxThreads =
+    PW_THREAD_PARTICLE_CPU_USAGE_MAX_THREADS;
+
+}  // namespace pw::thread::particle::config
+
 // Enable joining by default since Device OS supports os_thread_join.
 #ifndef PW_THREAD_JOINING_ENABLED
 #define PW_THREAD_JOINING_ENABLED 1
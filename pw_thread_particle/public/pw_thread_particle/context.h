@@ -65,17 +65,21 @@ class Context {
   bool thread_done_ = false;
   bool dynamically_allocated_ = false;
 
-  // Stack storage for static contexts
-  uint8_t* stack_storage_ = nullptr;
+  // Stack size requested by a static context; 0 uses Options
   size_t stack_size_ = 0;
 };
 
-// Static thread context with pre-allocated stack.
+// Static thread context: the Context object itself lives in caller storage.
+//
+// Device OS creates every thread stack on its own heap: the dynalib exports
+// neither os_thread_create_with_stack nor xTaskCreateStatic. A static
+// context therefore only sets the stack size; it holds no stack memory, so
+// the stack is not paid for twice.
 class StaticContext : public Context {
  public:
-  explicit constexpr StaticContext(span<uint8_t> stack_span)
-      : stack_span_(stack_span) {
-    stack_storage_ = stack_span.data();
+  // Deprecated form: only the size of `stack_span` is used, the memory is
+  // not. Prefer StaticContextWithStack<kStackSizeBytes>.
+  explicit constexpr StaticContext(span<uint8_t> stack_span) {
     stack_size_ = stack_span.size();
   }
 
@@ -85,26 +89,24 @@ class StaticContext : public Context {
   template <size_t>
   friend class ::pw::ThreadContext;
 
-  constexpr StaticContext() = default;
-
-  span<uint8_t> stack() { return stack_span_; }
+  template <size_t>
+  friend class StaticContextWithStack;
 
-  span<uint8_t> stack_span_;
+  constexpr StaticContext() = default;
 };
 
-// Static thread context with embedded stack storage.
+// Static thread context for a kStackSizeBytes stack. The stack itself is
+// allocated by Device OS when the thread starts (see StaticContext).
 template <size_t kStackSizeBytes = config::kDefaultStackSizeBytes>
 class StaticContextWithStack final : public StaticContext {
  public:
-  StaticContextWithStack() : StaticContext(stack_storage_) {}
+  constexpr StaticContextWithStack() { stack_size_ = kStackSizeBytes; }
 
   // Constexpr constructor for static initialization.
-  constexpr StaticContextWithStack(ConstexprTag)
-      : StaticContext(stack_storage_), stack_storage_{} {}
+  constexpr StaticContextWithStack(ConstexprTag) : StaticContextWithStack() {}
 
  private:
   static_assert(kStackSizeBytes >= config::kMinimumStackSizeBytes);
-  uint8_t stack_storage_[kStackSizeBytes];
 };
 
 }  // namespace particle
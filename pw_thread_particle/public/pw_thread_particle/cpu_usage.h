@@ -0,0 +1,59 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Per-thread CPU usage.
+//
+// Device OS builds FreeRTOS without run-time stats and exports no
+// context-switch hook, so usage is sampled instead: StartCpuSampling()
+// chains a handler in front of the SysTick handler that, on every kernel
+// tick, charges the DWT cycles since the previous tick to the thread that
+// was running. At the 1 kHz tick this resolves threads that run for a few
+// milliseconds per second; shorter bursts average out over longer windows.
+//
+//   pw::thread::particle::StartCpuSampling();
+//   ...
+//   std::array<pw::thread::particle::ThreadCpuUsage, 16> usage;
+//   for (const auto& t : span(usage).first(SnapshotCpuUsage(usage))) {
+//     PW_LOG_INFO("%s %u.%02u%%", t.name, t.cpu_hundredths / 100,
+//                 t.cpu_hundredths % 100);
+//   }
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+
+// Forward declaration of Device OS types
+typedef void* os_thread_t;
+
+namespace pw::thread::particle {
+
+struct ThreadCpuUsage {
+  static constexpr size_t kMaxNameLength = 16;
+
+  // nullptr: threads beyond config::kCpuUsageMaxThreads
+  os_thread_t thread = nullptr;
+  // Empty if the thread exited during the window
+  char name[kMaxNameLength] = {};
+  uint32_t samples = 0;         // Ticks the thread was running
+  uint64_t cycles = 0;          // CPU cycles charged to the thread
+  uint16_t cpu_hundredths = 0;  // Share of the window, 0..10000
+};
+
+// Install the SysTick sampler. Unavailable if the vector table is not in
+// RAM and cannot be patched. Calling it again is a no-op.
+Status StartCpuSampling();
+
+// Restore the original SysTick handler.
+void StopCpuSampling();
+
+// Copy the usage since the previous snapshot (or since StartCpuSampling())
+// into `out`, busiest first, and start a new window. Call it periodically,
+// e.g. from a logging task or an RPC handler, to get a running view. Returns
+// the number of entries written.
+size_t SnapshotCpuUsage(span<ThreadCpuUsage> out);
+
+}  // namespace pw::thread::particle
@@ -0,0 +1,37 @@
+// Copyright Offene Werkstatt Wädenswil
+// SPDX-License-Identifier: MIT
+//
+// Microsecond sleeps.
+//
+// pw::this_thread::sleep_for() takes pw::chrono::SystemClock durations,
+// which tick in milliseconds. These sleep to the microsecond: the bulk of
+// the wait blocks (other threads run), the last
+// PW_THREAD_PARTICLE_SLEEP_SPIN_US busy-wait on the microsecond timer.
+// Waits shorter than that spin entirely, so keep them short on high
+// priority threads.
+//
+// For periodic work, advance a deadline instead of sleeping a period, so
+// the loop does not drift by the time the work takes:
+//
+//   uint32_t next = HAL_Timer_Get_Micro_Seconds();
+//   while (true) {
+//     SampleSensor();
+//     next += 250;
+//     pw::thread::particle::SleepUntilMicros(next);
+//   }
+
+#pragma once
+
+#include <cstdint>
+
+namespace pw::thread::particle {
+
+// Sleep for at least `duration_us` microseconds.
+void SleepForMicros(uint32_t duration_us);
+
+// Sleep until HAL_Timer_Get_Micro_Seconds() reaches `deadline_us`. Returns
+// at once if the deadline has passed. The timer wraps after ~71 minutes;
+// deadlines must be within 35 minutes of now.
+void SleepUntilMicros(uint32_t deadline_us);
+
+}  // namespace pw::thread::particle
@@ -20,8 +20,9 @@ void sleep_for(SystemClock::duration sleep_duration) {
     return;
   }
 
-  // Convert duration to milliseconds
-  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(sleep_duration);
+  // Convert duration to milliseconds, rounding up so a microsecond
+  // SystemClock never sleeps shorter than requested
+  auto ms = std::chrono::ceil<std::chrono::milliseconds>(sleep_duration);
 
   // HAL_Delay_Milliseconds takes uint32_t, so handle very long sleeps
   constexpr uint32_t kMaxDelayMs = 0xFFFFFFFFU;
@@ -3,6 +3,8 @@
 
 #include "pw_thread/thread.h"
 
+#include <array>
+
 #include "concurrent_hal.h"
 #include "pw_assert/check.h"
 #include "pw_preprocessor/compiler.h"
@@ -13,6 +15,48 @@
 using pw::thread::particle::Context;
 
 namespace pw::thread {
+namespace {
+
+#if PW_THREAD_PARTICLE_CONTEXT_POOL_SIZE > 0
+// Slots are claimed and returned with the scheduler suspended, like the
+// detach/exit handshake below.
+std::array<Context, particle::config::kContextPoolSize> context_pool;
+std::array<bool, particle::config::kContextPoolSize> context_in_use{};
+#endif  // PW_THREAD_PARTICLE_CONTEXT_POOL_SIZE > 0
+
+Context* AllocateContext() {
+#if PW_THREAD_PARTICLE_CONTEXT_POOL_SIZE > 0
+  Context* context = nullptr;
+  os_thread_scheduling(false, nullptr);
+  for (size_t i = 0; i < context_pool.size(); ++i) {
+    if (!context_in_use[i]) {
+      context_in_use[i] = true;
+      context = &context_pool[i];
+      break;
+    }
+  }
+  os_thread_scheduling(true, nullptr);
+  PW_CHECK_NOTNULL(context,
+                   "All %u pooled thread contexts in use",
+                   static_cast<unsigned>(context_pool.size()));
+  return context;
+#else
+  return new Context();
+#endif  // PW_THREAD_PARTICLE_CONTEXT_POOL_SIZE > 0
+}
+
+void FreeContext(Context* context) {
+#if PW_THREAD_PARTICLE_CONTEXT_POOL_SIZE > 0
+  const size_t index = static_cast<size_t>(context - context_pool.data());
+  os_thread_scheduling(false, nullptr);
+  context_in_use[index] = false;
+  os_thread_scheduling(true, nullptr);
+#else
+  delete context;
+#endif  // PW_THREAD_PARTICLE_CONTEXT_POOL_SIZE > 0
+}
+
+}  // namespace
 
 void Context::ThreadEntryPoint(void* void_context_ptr) {
   Context& context = *static_cast<Context*>(void_context_ptr);
@@ -35,7 +79,7 @@ void Context::ThreadEntryPoint(void* void_context_ptr) {
     os_thread_scheduling(true, nullptr);
 
     if (context.dynamically_allocated_) {
-      delete &context;
+      FreeContext(&context);
     }
 
     // Exit the thread. This never returns.
@@ -60,7 +104,7 @@ void Context::TerminateThread(Context& context) {
   }
 
   if (context.dynamically_allocated_) {
-    delete &context;
+    FreeContext(&context);
   }
 }
 
@@ -68,10 +112,11 @@ void Context::CreateThread(const particle::Options& options,
                            Function<void()>&& thread_fn,
                            Context*& native_type_out) {
   os_thread_t thread_handle = nullptr;
+  size_t stack_size_bytes = options.stack_size_bytes();
 
-  // Always use dynamic allocation and os_thread_create.
-  // Note: os_thread_create_with_stack is not available in dynalib.
-  // Static contexts are stored but we still use os_thread_create for the stack.
+  // Device OS always allocates the stack itself (os_thread_create); neither
+  // os_thread_create_with_stack nor xTaskCreateStatic is in the dynalib. A
+  // static context supplies the Context object and the stack size.
   if (options.static_context() != nullptr) {
     // Use the statically allocated context for the Context object.
     native_type_out = options.static_context();
@@ -84,9 +129,12 @@ void Context::CreateThread(const particle::Options& options,
     native_type_out->dynamically_allocated_ = false;
 
     native_type_out->set_thread_routine(std::move(thread_fn));
+    if (native_type_out->stack_size_ != 0) {
+      stack_size_bytes = native_type_out->stack_size_;
+    }
   } else {
-    // Dynamically allocate the context.
-    native_type_out = new pw::thread::particle::Context();
+    // Allocate the context, from the pool if configured.
+    native_type_out = AllocateContext();
     native_type_out->dynamically_allocated_ = true;
     native_type_out->set_detached(false);
     native_type_out->set_thread_done(false);
@@ -94,15 +142,14 @@ void Context::CreateThread(const particle::Options& options,
     native_type_out->set_thread_routine(std::move(thread_fn));
   }
 
-  // Create thread with dynamically allocated stack (os_thread_create).
-  // The stack_size from options is used regardless of static/dynamic context.
+  // Create thread with a Device OS allocated stack (os_thread_create).
   const os_result_t result = os_thread_create(
       &thread_handle,
       options.name(),
       options.priority(),
       Context::ThreadEntryPoint,
       native_type_out,
-      options.stack_size_bytes());
+      stack_size_bytes);
 
   PW_CHECK(result == 0, "Failed to create thread");
   PW_CHECK(thread_handle != nullptr, "Thread handle is null after creation");
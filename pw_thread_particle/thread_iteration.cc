@@ -50,11 +50,12 @@ os_result_t ThreadDumpCallback(os_thread_dump_info_t* info, void* context) {
 
   // Calculate peak usage if high watermark is available.
   if (info->stack_high_watermark > 0 && info->stack_base != nullptr) {
-    // High watermark is the max free stack memory recorded.
-    // Peak usage = stack_size - high_watermark.
+    // High watermark is the least free stack memory recorded. The stack
+    // grows down, so the deepest address reached is that far above the
+    // base, and peak usage = stack_high_addr - stack_peak_addr.
     thread_info.set_stack_peak_addr(
         reinterpret_cast<uintptr_t>(info->stack_base) +
-        (info->stack_size - info->stack_high_watermark));
+        info->stack_high_watermark);
   }
 
   // Call the user's callback.
@@ -0,0 +1,112 @@
+# Copyright Offene Werkstatt Wädenswil
+# SPDX-License-Identifier: MIT
+
+"""Bazel rules for Particle on-device benchmarks using pb_benchmark."""
+
+load("@rules_cc//cc:defs.bzl", "cc_library")
+load("//rules:particle_firmware.bzl", "particle_cc_binary", "particle_firmware_binary")
+
+def particle_benchmark(
+        name,
+        srcs,
+        deps = [],
+        copts = [],
+        defines = [],
+        baseline = None,
+        tolerance_percent = 10,
+        speed_paths = [],
+        lto = False,
+        platform = "@particle_bazel//platforms/p2:particle_p2",
+        **kwargs):
+    """Creates on-device benchmark firmware for Particle devices.
+
+    Like particle_cc_test, with pb_benchmark's runner main: the firmware
+    runs every PB_BENCHMARK in `srcs` and streams the results over USB
+    serial.
+
+    Creates:
+    - {name}.lib: Benchmark library (alwayslink=1)
+    - {name}.elf: Flashable ELF with benchmarks + main
+    - {name}.bin: Flashable binary with CRC
+    - {name}_run: Flashes, collects the results and compares them against
+      `baseline`; exits non-zero on a regression
+
+    Args:
+        name: Target name.
+        srcs: Benchmark source files.
+        deps: Benchmark dependencies.
+        copts: Additional compiler flags.
+        defines: Additional preprocessor defines.
+        baseline: Optional JSON file with stored results to compare against.
+            Regenerate it with `bazel run :{name}_run -- --write-baseline
+            <workspace-relative path>`.
+        tolerance_percent: Allowed slowdown of a benchmark's mean before
+            it counts as a regression.
+        speed_paths: Optimization profile (see particle_cc_binary), so the
+            same benchmarks can be built once per profile and compared.
+        lto: Link-time optimization for speed_paths.
+        platform: Platform label (default: P2).
+        **kwargs: Additional arguments (visibility, tags, etc.).
+    """
+    common_kwargs = {k: v for k, v in kwargs.items()
+                     if k in ["visibility", "tags"]}
+
+    cc_library(
+        name = name + ".lib",
+        srcs = srcs,
+        deps = deps + ["@particle_bazel//pb_benchmark:benchmark"],
+        copts = copts,
+        defines = defines,
+        testonly = True,
+        alwayslink = True,
+        target_compatible_with = [
+            "@pigweed//pw_build/constraints/arm:cortex-m33",
+        ],
+        **common_kwargs
+    )
+
+    particle_cc_binary(
+        name = name + ".elf",
+        deps = [
+            ":" + name + ".lib",
+            "@particle_bazel//pb_benchmark:main",
+        ],
+        platform = platform,
+        speed_paths = speed_paths,
+        lto = lto,
+        testonly = True,
+        **common_kwargs
+    )
+
+    particle_firmware_binary(
+        name = name,
+        elf = ":" + name + ".elf",
+        testonly = True,
+        **common_kwargs
+    )
+
+    firmware = ":" + name + ".bin"
+    data = [firmware]
+    args = [
+        "$(location " + firmware + ")",
+        "--tolerance-percent=" + str(tolerance_percent),
+    ]
+    if baseline:
+        data.append(baseline)
+        args.append("--baseline=$(location " + baseline + ")")
+
+    native.py_binary(
+        name = name + "_run",
+        srcs = ["@particle_bazel//tools:scripts/run_benchmark.py"],
+        main = "@particle_bazel//tools:scripts/run_benchmark.py",
+        data = data,
+        deps = [
+            "@particle_bazel//tools:particle_benchmark_results",
+            "@particle_bazel//tools:particle_cli_wrapper",
+            "@particle_bazel//tools:particle_usb",
+        ],
+        args = args,
+        testonly = True,
+        tags = ["local"],  # Bypass sandbox to access USB devices
+        **{k: v for k, v in kwargs.items() if k == "visibility"}
+    )
@@ -71,17 +71,58 @@ PARTICLE_BASE_LINKOPTS = [
     "-lstdc++",
 ]
 
-# Platform transition for building under a specific platform
+# Optimization profile: everything at -Os, sources under the speed paths
+# at -O2 (plus LTO objects when lto is set)
+PARTICLE_SIZE_COPTS = ["-Os"]
+PARTICLE_SPEED_COPTS = ["-O2"]
+PARTICLE_LTO_COPTS = ["-flto", "-ffat-lto-objects"]
+
+def _speed_path_regex(path):
+    """per_file_copt regex for a repository-relative path prefix.
+
+    Matches both in the main repository and under external/<repo>/.
+    """
+    return "(.*/)?" + path + ".*"
+
+# Platform transition for building under a specific platform, with the
+# optimization profile applied to every dependency
 def _particle_platform_transition_impl(settings, attr):
-    """Transition to build deps under the specified platform."""
+    """Transition to build deps under the specified platform and profile."""
+    platforms = settings["//command_line_option:platforms"]
     if hasattr(attr, "platform") and attr.platform:
-        return {"//command_line_option:platforms": str(attr.platform)}
-    return {}
+        platforms = str(attr.platform)
+
+    copt = settings["//command_line_option:copt"]
+    per_file_copt = settings["//command_line_option:per_file_copt"]
+    speed_paths = getattr(attr, "speed_paths", [])
+    if speed_paths:
+        speed_copts = PARTICLE_SPEED_COPTS
+        if getattr(attr, "lto", False):
+            speed_copts = speed_copts + PARTICLE_LTO_COPTS
+        copt = copt + PARTICLE_SIZE_COPTS
+        per_file_copt = per_file_copt + [
+            ",".join([_speed_path_regex(p) for p in speed_paths]) + "@" +
+            ",".join(speed_copts),
+        ]
+
+    return {
+        "//command_line_option:platforms": platforms,
+        "//command_line_option:copt": copt,
+        "//command_line_option:per_file_copt": per_file_copt,
+    }
 
 _particle_platform_transition = transition(
     implementation = _particle_platform_transition_impl,
-    inputs = [],
-    outputs = ["//command_line_option:platforms"],
+    inputs = [
+        "//command_line_option:platforms",
+        "//command_line_option:copt",
+        "//command_line_option:per_file_copt",
+    ],
+    outputs = [
+        "//command_line_option:platforms",
+        "//command_line_option:copt",
+        "//command_line_option:per_file_copt",
+    ],
 )
 
 def _particle_two_pass_binary_impl(ctx):
@@ -89,6 +130,7 @@ def _particle_two_pass_binary_impl(ctx):
 
     Pass 1: Link with conservative defaults to create intermediate ELF
     Pass 2: Extract sizes, generate precise linker script, re-link final ELF
+            with a map file, then attribute the sizes to libraries
     """
     # Get toolchain from the transitioned _cc_toolchain attribute
     # This resolves the toolchain in the target (ARM) configuration, not exec (host)
@@ -153,6 +195,8 @@ def _particle_two_pass_binary_impl(ctx):
     # Put in subdirectory so we can add it first in -L search path
     precise_ld = ctx.actions.declare_file(ctx.attr.name + "_generated/memory_platform_user.ld")
     final_elf = ctx.actions.declare_file(ctx.attr.name)
+    link_map = ctx.actions.declare_file(ctx.attr.name + ".map")
+    size_report = ctx.actions.declare_file(ctx.attr.name + "_size_report.json")
 
     # Build linker flags for first pass (with defaults from memory_platform_user.ld)
     base_linkopts = PARTICLE_BASE_LINKOPTS
@@ -160,7 +204,10 @@ def _particle_two_pass_binary_impl(ctx):
 
     # Pass 2 flags: put generated memory_platform_user.ld directory FIRST
     # so it overrides the defaults when linker.ld does INCLUDE memory_platform_user.ld
-    pass2_linkopts = ["-L" + precise_ld.dirname] + PARTICLE_BASE_LINKOPTS
+    pass2_linkopts = [
+        "-L" + precise_ld.dirname,
+        "-Wl,-Map=" + link_map.path,
+    ] + PARTICLE_BASE_LINKOPTS
 
     # Build library flags using full paths (avoids -L/-l: search path issues)
     # Use --whole-archive for alwayslink libs to ensure all symbols are included
@@ -173,10 +220,22 @@ def _particle_two_pass_binary_impl(ctx):
     regular_flags = [l.path for l in regular_libs]
     library_flags = " ".join(alwayslink_flags + regular_flags)
 
+    # LTO profile: link-time optimization of the objects compiled with -flto
+    if ctx.attr.lto:
+        lto_linkopts = ["-flto", "-O2"]
+        base_linkopts = [o for o in base_linkopts if o != "-fno-lto"] + lto_linkopts
+        pass2_linkopts = [o for o in pass2_linkopts if o != "-fno-lto"] + lto_linkopts
+
     # Combine all linker flags (base + user-specified + deps' user_link_flags)
     all_linkopts = base_linkopts + user_linkopts + user_link_flags
     all_linkopts_pass2 = pass2_linkopts + user_linkopts + user_link_flags
 
+    # Record the profile in the size report so reports can be compared
+    profile_flags = " ".join(
+        ["--speed-path=" + p for p in ctx.attr.speed_paths] +
+        (["--lto"] if ctx.attr.lto else []),
+    )
+
     # Create the two-pass linking script
     # We use run_shell because we need to execute two linking steps with
     # dynamic generation of the linker script between them
@@ -199,6 +258,11 @@ python3 {extract_script} \
 echo "Pass 2: Re-linking with precise memory values..."
 {linker} {linker_flags_pass2} {libraries} -o {final_elf}
 
+# === Attribute sizes to libraries from the map file ===
+python3 {size_report_script} \
+    --map {link_map} \
+    --output-json {size_report} {profile_flags}
+
 echo "Two-pass linking complete."
 """.format(
         linker = linker_path,
@@ -211,12 +275,23 @@ echo "Two-pass linking complete."
         sizes_json = sizes_json.path,
         precise_ld = precise_ld.path,
         final_elf = final_elf.path,
+        size_report_script = ctx.file._size_report.path,
+        link_map = link_map.path,
+        size_report = size_report.path,
+        profile_flags = profile_flags,
     )
 
     ctx.actions.run_shell(
-        outputs = [intermediate_elf, sizes_json, precise_ld, final_elf],
+        outputs = [
+            intermediate_elf,
+            sizes_json,
+            precise_ld,
+            final_elf,
+            link_map,
+            size_report,
+        ],
         inputs = depset(
-            direct = linker_inputs + linker_script_files + list(additional_linker_inputs) + [ctx.file._extract_sizes],
+            direct = linker_inputs + linker_script_files + list(additional_linker_inputs) + [ctx.file._extract_sizes, ctx.file._size_report],
             transitive = [cc_toolchain.all_files],
         ),
         command = script,
@@ -227,9 +302,13 @@ echo "Two-pass linking complete."
 
     return [
         DefaultInfo(
-            files = depset([final_elf, sizes_json]),
+            files = depset([final_elf, sizes_json, size_report]),
             executable = final_elf,
         ),
+        OutputGroupInfo(
+            link_map = depset([link_map]),
+            size_report = depset([size_report]),
+        ),
     ]
 
 _particle_two_pass_binary = rule(
@@ -240,7 +319,9 @@ _particle_two_pass_binary = rule(
             cfg = _particle_platform_transition,  # Apply platform transition to deps
         ),
         "linkopts": attr.string_list(default = []),
+        "lto": attr.bool(default = False),  # Read by the transition too
         "platform": attr.label(),  # Platform for transition
+        "speed_paths": attr.string_list(default = []),  # Read by the transition
         "_linker_scripts": attr.label(
             default = "@particle_bazel//:linker_scripts",
         ),
@@ -248,6 +329,10 @@ _particle_two_pass_binary = rule(
             default = "@particle_bazel//tools:extract_elf_sizes.py",
             allow_single_file = True,
         ),
+        "_size_report": attr.label(
+            default = "@particle_bazel//tools:size_report.py",
+            allow_single_file = True,
+        ),
         "_cc_toolchain": attr.label(
             default = "@bazel_tools//tools/cpp:current_cc_toolchain",
             cfg = _particle_platform_transition,  # Get toolchain from target platform
@@ -270,6 +355,8 @@ def particle_cc_binary(
         linkopts = [],
         platform = None,
         two_pass = True,
+        speed_paths = [],
+        lto = False,
         **kwargs):
     """Creates a Particle P2 firmware binary.
 
@@ -288,8 +375,20 @@ def particle_cc_binary(
         platform: Platform label for transition (e.g., "@particle_bazel//platforms/p2:particle_p2").
         two_pass: If True (default), use two-pass linking for precise memory.
                   If False, use single-pass with static defaults.
+        speed_paths: Optimization profile. Source path prefixes relative to
+                  their repository (e.g. "pb_crypto/", "pb_cloud/cbor")
+                  compiled at -O2; everything else, including all
+                  dependencies, is compiled at -Os. Empty (default) keeps
+                  the toolchain's optimization level. Requires two_pass.
+        lto: With speed_paths, also compile the speed paths with -flto and
+                  link with link-time optimization.
         **kwargs: Additional arguments passed to the underlying rules.
     """
+    if (speed_paths or lto) and not two_pass:
+        fail("speed_paths and lto require two_pass = True")
+    if lto and not speed_paths:
+        fail("lto applies to speed_paths; set speed_paths as well")
+
     # Create a library with the firmware sources
     lib_name = name + "_lib"
     cc_library(
@@ -315,6 +414,8 @@ def particle_cc_binary(
             deps = [":" + lib_name],
             linkopts = linkopts,
             platform = platform,
+            speed_paths = speed_paths,
+            lto = lto,
             **{k: v for k, v in kwargs.items() if k in ["visibility", "tags", "testonly"]}
         )
     else:
@@ -395,6 +496,56 @@ def particle_flash_binary(
         **{k: v for k, v in kwargs.items() if k in ["visibility", "testonly"]}
     )
 
+def particle_size_diff_test(
+        name,
+        elf,
+        baseline,
+        max_flash_growth = 0,
+        max_ram_growth = 0,
+        **kwargs):
+    """Fails when firmware grows beyond a stored size baseline.
+
+    Compares the per-module size report of a two-pass `elf` against
+    `baseline` (a checked-in copy of an earlier report) and lists every
+    module whose flash (text + data) or RAM (data + bss) changed.
+
+    Usage:
+        bazel test //path/to:{name}
+        bazel run //path/to:{name} -- --write-baseline  # accept new sizes
+
+    Args:
+        name: Target name.
+        elf: Label of a particle_cc_binary or particle_firmware ELF.
+        baseline: Baseline size report JSON file.
+        max_flash_growth: Allowed total flash growth in bytes.
+        max_ram_growth: Allowed total RAM growth in bytes.
+        **kwargs: Additional arguments (visibility, tags).
+    """
+    report = name + "_report"
+    native.filegroup(
+        name = report,
+        srcs = [elf],
+        output_group = "size_report",
+        testonly = True,
+    )
+
+    native.py_test(
+        name = name,
+        srcs = ["@particle_bazel//tools:size_diff.py"],
+        main = "@particle_bazel//tools:size_diff.py",
+        data = [":" + report, baseline],
+        args = [
+            "--report=$(rootpath :" + report + ")",
+            "--baseline=$(rootpath " + baseline + ")",
+            "--max-flash-growth=" + str(max_flash_growth),
+            "--max-ram-growth=" + str(max_ram_growth),
+        ],
+        target_compatible_with = [
+            "@pigweed//pw_build/constraints/arm:cortex-m33",
+        ],
+        **{k: v for k, v in kwargs.items() if k in ["visibility", "tags"]}
+    )
+
 def particle_firmware(
         name,
         srcs = [],
@@ -404,6 +555,8 @@ def particle_firmware(
         linkopts = [],
         platform = None,
         two_pass = True,
+        speed_paths = [],
+        lto = False,
         **kwargs):
     """Creates a complete Particle firmware with ELF and flashable .bin.
 
@@ -423,6 +576,9 @@ def particle_firmware(
         linkopts: Additional linker flags.
         platform: Platform label for transition (e.g., "@particle_bazel//platforms/p2:particle_p2").
         two_pass: If True (default), use two-pass linking for precise memory.
+        speed_paths: Paths compiled at -O2 with the rest at -Os (see
+                  particle_cc_binary).
+        lto: Link-time optimization for speed_paths.
         **kwargs: Additional arguments passed to underlying rules.
     """
     # Create the ELF binary as the default target
@@ -435,6 +591,8 @@ def particle_firmware(
         linkopts = linkopts,
         platform = platform,
         two_pass = two_pass,
+        speed_paths = speed_paths,
+        lto = lto,
         **{k: v for k, v in kwargs.items() if k not in ["visibility"]}
     )
 
@@ -0,0 +1,24 @@
+# Copyright Offene Werkstatt Wädenswil
+# SPDX-License-Identifier: MIT
+
+"""Benchmark result parsing and baseline comparison."""
+
+from .results import (
+    BenchmarkResult,
+    Comparison,
+    compare,
+    load_baseline,
+    parse_done,
+    parse_line,
+    write_baseline,
+)
+
+__all__ = [
+    "BenchmarkResult",
+    "Comparison",
+    "compare",
+    "load_baseline",
+    "parse_done",
+    "parse_line",
+    "write_baseline",
+]
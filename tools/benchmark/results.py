@@ -0,0 +1,130 @@
+# Copyright Offene Werkstatt Wädenswil
+# SPDX-License-Identifier: MIT
+
+"""Parse pb_benchmark output and compare it against stored baselines.
+
+The benchmark firmware prints one line per result:
+
+    PB_BENCH {"name":"Crc.Crc32Of1k","warmup":8,"iterations":100,
+              "min_cycles":..,"mean_cycles":..,"max_cycles":..,"mean_ns":..}
+
+followed by ``PB_BENCH_DONE {"count":N}``. A baseline file is a JSON object
+mapping benchmark names to the same result objects.
+"""
+
+import json
+from dataclasses import asdict, dataclass
+from pathlib import Path
+from typing import Optional
+
+RESULT_PREFIX = "PB_BENCH "
+DONE_PREFIX = "PB_BENCH_DONE "
+
+
+@dataclass
+class BenchmarkResult:
+    """Timing of one benchmark, in CPU cycles."""
+
+    name: str
+    warmup: int
+    iterations: int
+    min_cycles: int
+    mean_cycles: int
+    max_cycles: int
+    mean_ns: int
+
+    @classmethod
+    def from_dict(cls, data: dict) -> "BenchmarkResult":
+        fields = cls.__dataclass_fields__
+        return cls(**{field: data[field] for field in fields})
+
+
+@dataclass
+class Comparison:
+    """A result compared against its baseline."""
+
+    name: str
+    baseline_cycles: Optional[int]
+    current_cycles: int
+    tolerance_percent: float
+
+    @property
+    def change_percent(self) -> Optional[float]:
+        if not self.baseline_cycles:
+            return None
+        return (
+            (self.current_cycles - self.baseline_cycles)
+            * 100.0
+            / self.baseline_cycles
+        )
+
+    @property
+    def regressed(self) -> bool:
+        change = self.change_percent
+        return change is not None and change > self.tolerance_percent
+
+
+def parse_line(line: str) -> Optional[BenchmarkResult]:
+    """Parse a PB_BENCH result line. None for any other line.
+
+    The prefix may follow other output on the same line (e.g. log
+    decoration), so it is searched rather than matched at the start.
+    """
+    index = line.find(RESULT_PREFIX)
+    if index < 0:
+        return None
+    try:
+        data = json.loads(line[index + len(RESULT_PREFIX):])
+        return BenchmarkResult.from_dict(data)
+    except (json.JSONDecodeError, KeyError, TypeError):
+        return None
+
+
+def parse_done(line: str) -> Optional[int]:
+    """Benchmark count from a PB_BENCH_DONE line. None for any other line."""
+    index = line.find(DONE_PREFIX)
+    if index < 0:
+        return None
+    try:
+        return int(json.loads(line[index + len(DONE_PREFIX):])["count"])
+    except (json.JSONDecodeError, KeyError, TypeError, ValueError):
+        return None
+
+
+def load_baseline(path: Path) -> dict[str, BenchmarkResult]:
+    """Load a baseline file written by write_baseline()."""
+    data = json.loads(Path(path).read_text())
+    return {
+        name: BenchmarkResult.from_dict(value)
+        for name, value in data.items()
+    }
+
+
+def write_baseline(path: Path, results: list[BenchmarkResult]) -> None:
+    """Store `results` as a baseline file, sorted by name."""
+    data = {result.name: asdict(result) for result in results}
+    Path(path).write_text(json.dumps(data, indent=2, sort_keys=True) + "\n")
+
+
+def compare(
+    results: list[BenchmarkResult],
+    baseline: dict[str, BenchmarkResult],
+    tolerance_percent: float,
+) -> list[Comparison]:
+    """Compare each result's mean cycles against its baseline.
+
+    Benchmarks missing from the baseline are reported without a change and
+    never count as regressions.
+    """
+    comparisons = []
+    for result in results:
+        reference = baseline.get(result.name)
+        comparisons.append(
+            Comparison(
+                name=result.name,
+                baseline_cycles=reference.mean_cycles if reference else None,
+                current_cycles=result.mean_cycles,
+                tolerance_percent=tolerance_percent,
+            )
+        )
+    return comparisons
@@ -22,6 +22,12 @@ _LOG = logging.getLogger(__name__)
 # ANSI escape code pattern for stripping terminal formatting
 _ANSI_ESCAPE = re.compile(r"\x1b\[[0-9;]*[a-zA-Z]|\[[0-9;]*[a-zA-Z]")
 
+# User module line of `particle serial inspect`, e.g.
+# "User module #1 - Version: 6, UUID: 6E2C...1F"
+_USER_MODULE_UUID = re.compile(
+    r"User module.*UUID:\s*(?P<uuid>[0-9a-fA-F]{64})"
+)
+
 
 class ParticleCliError(Exception):
     """Raised when a particle-cli command fails."""
@@ -55,6 +61,12 @@ def strip_ansi(text: str) -> str:
     return _ANSI_ESCAPE.sub("", text)
 
 
+def parse_user_module_hash(text: str) -> Optional[str]:
+    """Extract the user module SHA256 from `particle serial inspect` output."""
+    match = _USER_MODULE_UUID.search(strip_ansi(text))
+    return match.group("uuid").lower() if match else None
+
+
 class ParticleCli:
     """Wrapper for particle-cli with hermetic Bazel integration.
 
@@ -257,18 +269,24 @@ class ParticleCli:
         self,
         firmware_path: str,
         timeout: float = 120.0,
+        device: Optional[str] = None,
     ) -> CliResult:
         """Flash firmware to a locally connected device via USB.
 
         Args:
             firmware_path: Path to firmware binary (.bin).
             timeout: Flash timeout in seconds.
+            device: Optional device ID or name, required when several
+                devices are attached.
 
         Returns:
             CliResult with flash output.
         """
+        args = ["flash", "--local"]
+        if device:
+            args.append(device)
         return self.run(
-            ["flash", "--local", firmware_path],
+            args + [firmware_path],
             timeout=timeout,
             check=True,
         )
@@ -322,6 +340,33 @@ class ParticleCli:
             args.append(device)
         return self.run(args, timeout=30.0, check=True)
 
+    def user_module_hash(
+        self,
+        timeout: float = 30.0,
+        port: Optional[str] = None,
+    ) -> Optional[str]:
+        """SHA256 of the user firmware on a USB-connected device.
+
+        Runs `particle serial inspect` and returns the UUID of the user
+        module, which is the SHA256 from its suffix (see particle_crc.py).
+
+        Args:
+            timeout: Command timeout in seconds.
+            port: Optional serial port, required when several devices are
+                attached.
+
+        Returns:
+            Lowercase hex hash, or None if the device reports no user module
+            or the inspect command fails.
+        """
+        args = ["serial", "inspect"]
+        if port:
+            args += ["--port", port]
+        result = self.run(args, timeout=timeout)
+        if not result.success:
+            return None
+        return parse_user_module_hash(result.stdout)
+
     def serial_list(self) -> list[str]:
         """List serial ports with Particle devices.
 
@@ -4,7 +4,13 @@
 """Particle Cloud API module for REST API operations."""
 
 from .client import ParticleCloudClient, ParticleCloudError, Device
-from .events import EventSubscription, CloudEvent
+from .events import (
+    CloudEvent,
+    EventSubscription,
+    LatencySummary,
+    SubscriptionStats,
+    summarize_latencies,
+)
 from .ledger import LedgerClient, ledger_get, ledger_set, ledger_delete
 
 __all__ = [
@@ -13,6 +19,9 @@ __all__ = [
     "Device",
     "EventSubscription",
     "CloudEvent",
+    "LatencySummary",
+    "SubscriptionStats",
+    "summarize_latencies",
     "LedgerClient",
     "ledger_get",
     "ledger_set",
@@ -5,16 +5,25 @@
 
 Provides a context manager for subscribing to Particle Cloud events
 with background thread processing.
+
+The stream is parsed in bulk (SseParser) and events are filtered before
+they are queued, so a subscription keeps up with devices publishing
+hundreds of events per second. The queue is bounded: when the consumer
+falls behind, the oldest events are dropped (and counted), or with
+block_when_full the stream is no longer read until there is room, which
+pushes back on the cloud connection instead of losing events.
 """
 
 import json
 import logging
 import os
+import statistics
 import threading
 import time
-from dataclasses import dataclass
-from queue import Empty, Queue
-from typing import Iterator, Optional
+from dataclasses import dataclass, field
+from datetime import datetime
+from queue import Empty, Full, Queue
+from typing import Callable, Iterable, Iterator, Optional
 
 import requests
 
@@ -33,10 +42,136 @@ class CloudEvent:
     published_at: Optional[str] = None
     device_id: Optional[str] = None
     ttl: Optional[int] = None
+    # Host time (time.time()) when the event was read from the stream
+    received_at: Optional[float] = field(default=None, compare=False)
 
     def __str__(self) -> str:
         return f"CloudEvent({self.name}={self.data!r})"
 
+    @property
+    def published_timestamp(self) -> Optional[float]:
+        """published_at (set by the cloud) as seconds since the epoch."""
+        if not self.published_at:
+            return None
+        try:
+            return datetime.fromisoformat(
+                self.published_at.replace("Z", "+00:00")
+            ).timestamp()
+        except ValueError:
+            return None
+
+    @property
+    def cloud_latency(self) -> Optional[float]:
+        """Seconds from the cloud accepting the event to its receipt here."""
+        published = self.published_timestamp
+        if published is None or self.received_at is None:
+            return None
+        return self.received_at - published
+
+    def device_latency(self, key: str = "t") -> Optional[float]:
+        """Seconds from the device publishing the event to its receipt here.
+
+        Needs the device's clock (Time.now() after cloud sync, in
+        milliseconds since the epoch) under `key` of a JSON object payload,
+        e.g. {"t": 1718000000123, ...}.
+        """
+        if self.received_at is None:
+            return None
+        try:
+            payload = json.loads(self.data)
+            device_ms = float(payload[key])
+        except (ValueError, TypeError, KeyError):
+            return None
+        return self.received_at - device_ms / 1000.0
+
+
+@dataclass
+class LatencySummary:
+    """Distribution of event latencies, in seconds."""
+
+    count: int
+    min: float
+    median: float
+    p90: float
+    p99: float
+    max: float
+
+    def __str__(self) -> str:
+        return (
+            f"n={self.count} min={self.min * 1000:.0f}ms "
+            f"median={self.median * 1000:.0f}ms p90={self.p90 * 1000:.0f}ms "
+            f"p99={self.p99 * 1000:.0f}ms max={self.max * 1000:.0f}ms"
+        )
+
+
+def summarize_latencies(
+    latencies: Iterable[Optional[float]],
+) -> Optional[LatencySummary]:
+    """Summarize latencies, skipping None. Returns None if there are none."""
+    values = sorted(v for v in latencies if v is not None)
+    if not values:
+        return None
+    if len(values) == 1:
+        quantiles = values * 99
+    else:
+        quantiles = statistics.quantiles(values, n=100, method="inclusive")
+    return LatencySummary(
+        count=len(values),
+        min=values[0],
+        median=statistics.median(values),
+        p90=quantiles[89],
+        p99=quantiles[98],
+        max=values[-1],
+    )
+
+
+@dataclass
+class SubscriptionStats:
+    """Counters of an EventSubscription (see EventSubscription.stats())."""
+
+    received: int = 0  # Events parsed from the stream
+    filtered: int = 0  # Events rejected by the event filter
+    dropped: int = 0  # Oldest events dropped because the queue was full
+    queued: int = 0  # Events currently queued
+    peak_queued: int = 0  # Highest queue occupancy
+    blocked_s: float = 0.0  # Time the reader waited for queue space
+
+
+class SseParser:
+    """Incremental parser for a Server-Sent Events byte stream.
+
+    Feed it the stream in arbitrary chunks; it returns (event, data) pairs
+    for the events completed by each chunk. Only the data field is decoded.
+    """
+
+    def __init__(self):
+        self._partial = b""
+        self._event = ""
+        self._data: list[bytes] = []
+
+    def feed(self, chunk: bytes) -> list[tuple[str, str]]:
+        """Parse the next chunk of the stream."""
+        lines = (self._partial + chunk).split(b"\n")
+        self._partial = lines.pop()
+        events = []
+        for line in lines:
+            if line.endswith(b"\r"):
+                line = line[:-1]
+            if not line:
+                # Empty line = end of event
+                if self._data:
+                    events.append(
+                        (self._event, b"\n".join(self._data).decode("utf-8"))
+                    )
+                self._event = ""
+                self._data = []
+            elif line.startswith(b"data:"):
+                self._data.append(line[5:].strip())
+            elif line.startswith(b"event:"):
+                self._event = line[6:].strip().decode("utf-8")
+            # Comments (":ok" keep-alives) and other fields are ignored
+        return events
+
 
 class EventSubscription:
     """Context manager for subscribing to Particle Cloud events via SSE.
@@ -57,6 +192,9 @@ class EventSubscription:
         prefix: str,
         device: Optional[str] = None,
         access_token: Optional[str] = None,
+        max_queue: int = 10000,
+        block_when_full: bool = False,
+        event_filter: Optional[Callable[[CloudEvent], bool]] = None,
     ):
         """Initialize subscription.
 
@@ -65,6 +203,13 @@ class EventSubscription:
             device: Optional device name/ID to filter events.
             access_token: API access token. If None, reads from
                 PARTICLE_ACCESS_TOKEN environment variable.
+            max_queue: Maximum number of queued events (0 = unbounded).
+            block_when_full: With a full queue, stop reading the stream
+                until the consumer catches up instead of dropping the
+                oldest event. The cloud may close a connection that stalls
+                for too long.
+            event_filter: Called in the reader thread for each event; only
+                events it returns True for are queued.
         """
         self._prefix = prefix
         self._device = device
@@ -76,7 +221,11 @@ class EventSubscription:
                 "variable or pass access_token parameter."
             )
 
-        self._events: Queue[CloudEvent] = Queue()
+        self._events: Queue[CloudEvent] = Queue(maxsize=max_queue)
+        self._block_when_full = block_when_full
+        self._event_filter = event_filter
+        self._stats = SubscriptionStats()
+        self._stats_lock = threading.Lock()
         self._running = False
         self._thread: Optional[threading.Thread] = None
         self._response: Optional[requests.Response] = None
@@ -143,28 +292,15 @@ class EventSubscription:
             )
             self._response.raise_for_status()
 
-            event_name = ""
-            event_data = ""
-
-            for line in self._response.iter_lines(decode_unicode=True):
+            parser = SseParser()
+            # The SSE response is chunked: iter_content() yields each HTTP
+            # chunk as it arrives, up to chunk_size bytes.
+            for chunk in self._response.iter_content(chunk_size=65536):
                 if not self._running:
                     break
-
-                if line is None:
-                    continue
-
-                line = line.strip()
-
-                # SSE format: event: <name>\ndata: <json>
-                if line.startswith("event:"):
-                    event_name = line[6:].strip()
-                elif line.startswith("data:"):
-                    event_data = line[5:].strip()
-                elif not line and event_data:
-                    # Empty line = end of event
-                    self._process_event(event_name, event_data)
-                    event_name = ""
-                    event_data = ""
+                received_at = time.time()
+                for event_name, event_data in parser.feed(chunk):
+                    self._process_event(event_name, event_data, received_at)
 
         except requests.exceptions.RequestException as e:
             if self._running:
@@ -172,7 +308,12 @@ class EventSubscription:
         finally:
             self._running = False
 
-    def _process_event(self, event_name: str, event_data: str) -> None:
+    def _process_event(
+        self,
+        event_name: str,
+        event_data: str,
+        received_at: Optional[float] = None,
+    ) -> None:
         """Process a received SSE event."""
         try:
             data = json.loads(event_data)
@@ -182,11 +323,56 @@ class EventSubscription:
                 published_at=data.get("published_at"),
                 device_id=data.get("coreid"),
                 ttl=data.get("ttl"),
+                received_at=received_at or time.time(),
             )
-            _LOG.debug("Received event: %s", event)
-            self._events.put(event)
         except json.JSONDecodeError as e:
             _LOG.warning("Failed to parse event data: %s - %s", event_data, e)
+            return
+
+        with self._stats_lock:
+            self._stats.received += 1
+        if self._event_filter and not self._event_filter(event):
+            with self._stats_lock:
+                self._stats.filtered += 1
+            return
+        _LOG.debug("Received event: %s", event)
+        self._enqueue(event)
+
+    def _enqueue(self, event: CloudEvent) -> None:
+        """Queue an event, applying the full-queue policy."""
+        if self._block_when_full:
+            start = time.monotonic()
+            while self._running:
+                try:
+                    self._events.put(event, timeout=0.5)
+                    break
+                except Full:
+                    continue
+            with self._stats_lock:
+                self._stats.blocked_s += time.monotonic() - start
+        else:
+            while True:
+                try:
+                    self._events.put_nowait(event)
+                    break
+                except Full:
+                    try:
+                        self._events.get_nowait()
+                        with self._stats_lock:
+                            self._stats.dropped += 1
+                    except Empty:
+                        pass
+        with self._stats_lock:
+            self._stats.peak_queued = max(
+                self._stats.peak_queued, self._events.qsize()
+            )
+
+    def stats(self) -> SubscriptionStats:
+        """Snapshot of the subscription counters."""
+        with self._stats_lock:
+            stats = SubscriptionStats(**vars(self._stats))
+        stats.queued = self._events.qsize()
+        return stats
 
     def wait_for_event(
         self,
@@ -219,14 +405,17 @@ class EventSubscription:
 
         return None
 
-    def get_events(self) -> list[CloudEvent]:
-        """Get all currently queued events.
+    def get_events(self, max_events: int = 0) -> list[CloudEvent]:
+        """Get the currently queued events.
+
+        Args:
+            max_events: Maximum number of events to return (0 = all).
 
         Returns:
-            List of all events in the queue (empties the queue).
+            List of queued events, oldest first (removed from the queue).
         """
         events = []
-        while True:
+        while not max_events or len(events) < max_events:
             try:
                 events.append(self._events.get_nowait())
             except Empty:
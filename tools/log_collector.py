@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+# Copyright Offene Werkstatt Wädenswil
+# SPDX-License-Identifier: MIT
+"""Receive the log stream of a pb_log NetworkLogSink.
+
+Listens for device connections and prints every entry, detokenized when
+the firmware ELF is given. Frames are little endian:
+
+    magic (2, "PL") | length (2) | sequence (4) | dropped (4) | entries
+
+and each entry is size (1) | metadata (4) | tokenized message (size). The
+metadata uses pw_log_tokenized's default layout: level in bits 0-2, line in
+bits 3-13, flags in bits 14-15 and the module token in bits 16-31.
+
+Usage:
+    bazel run @particle_bazel//tools:log_collector -- --port 5140 \\
+        --elf bazel-bin/app/firmware.elf
+"""
+
+import argparse
+import socket
+import struct
+import sys
+from dataclasses import dataclass, field
+from datetime import datetime
+
+FRAME_MAGIC = 0x4C50  # "PL"
+FRAME_HEADER = struct.Struct("<HHII")
+ENTRY_HEADER_SIZE = 5
+
+LEVELS = {
+    1: "DBG",
+    2: "INF",
+    3: "WRN",
+    4: "ERR",
+    5: "CRT",
+    7: "FTL",
+}
+
+
+@dataclass
+class Entry:
+    metadata: int
+    message: bytes
+
+    @property
+    def level(self) -> int:
+        return self.metadata & 0x7
+
+    @property
+    def line(self) -> int:
+        return (self.metadata >> 3) & 0x7FF
+
+    @property
+    def flags(self) -> int:
+        return (self.metadata >> 14) & 0x3
+
+    @property
+    def module(self) -> int:
+        return self.metadata >> 16
+
+
+@dataclass
+class Frame:
+    sequence: int
+    dropped: int
+    entries: list[Entry] = field(default_factory=list)
+
+
+def parse_entries(payload: bytes) -> list[Entry]:
+    """Entries of a frame payload; a truncated last entry is ignored."""
+    entries = []
+    offset = 0
+    while offset + ENTRY_HEADER_SIZE <= len(payload):
+        size = payload[offset]
+        (metadata,) = struct.unpack_from("<I", payload, offset + 1)
+        start = offset + ENTRY_HEADER_SIZE
+        if start + size > len(payload):
+            break
+        entries.append(Entry(metadata, payload[start:start + size]))
+        offset = start + size
+    return entries
+
+
+def parse_frames(data: bytes) -> tuple[list[Frame], bytes, int]:
+    """Split a received stream into frames.
+
+    Returns the complete frames, the bytes of an incomplete last frame to
+    prepend to the next read, and the number of bytes skipped to find a
+    frame magic.
+    """
+    frames = []
+    skipped = 0
+    offset = 0
+    while len(data) - offset >= FRAME_HEADER.size:
+        magic, length, sequence, dropped = FRAME_HEADER.unpack_from(data, offset)
+        if magic != FRAME_MAGIC:
+            offset += 1
+            skipped += 1
+            continue
+        end = offset + FRAME_HEADER.size + length
+        if end > len(data):
+            break
+        payload = data[offset + FRAME_HEADER.size:end]
+        frames.append(Frame(sequence, dropped, parse_entries(payload)))
+        offset = end
+    return frames, data[offset:], skipped
+
+
+def format_entry(entry: Entry, detokenizer=None) -> str:
+    level = LEVELS.get(entry.level, str(entry.level))
+    if detokenizer is not None:
+        text = str(detokenizer.detokenize(entry.message))
+    else:
+        text = "$" + entry.message.hex()
+    return f"{level} [{entry.module:04x}] {text} (line {entry.line})"
+
+
+def serve(port: int, detokenizer=None) -> None:
+    with socket.create_server(("", port)) as server:
+        print(f"=== Listening on port {port} ===", flush=True)
+        while True:
+            connection, address = server.accept()
+            with connection:
+                print(f"=== {address[0]} connected ===", flush=True)
+                receive(connection, detokenizer)
+                print(f"=== {address[0]} disconnected ===", flush=True)
+
+
+def receive(connection: socket.socket, detokenizer=None) -> None:
+    pending = b""
+    expected = None
+    while True:
+        data = connection.recv(4096)
+        if not data:
+            return
+        frames, pending, skipped = parse_frames(pending + data)
+        if skipped:
+            print(f"!!! skipped {skipped} bytes", flush=True)
+        for frame in frames:
+            # The device restarts at 0 after a reboot
+            if expected is not None and frame.sequence not in (expected, 0):
+                print(f"!!! frames {expected}..{frame.sequence - 1} missing")
+            expected = frame.sequence + 1
+            if frame.dropped:
+                print(f"!!! {frame.dropped} entries dropped on the device")
+            timestamp = datetime.now().strftime("%H:%M:%S.%f")[:-3]
+            for entry in frame.entries:
+                print(f"{timestamp} {format_entry(entry, detokenizer)}")
+        sys.stdout.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Receive and print pb_log network log streams"
+    )
+    parser.add_argument("--port", type=int, default=5140,
+                        help="TCP port to listen on (default: 5140)")
+    parser.add_argument("--elf",
+                        help="Firmware ELF with the token database")
+    args = parser.parse_args()
+
+    detokenizer = None
+    if args.elf:
+        from pw_tokenizer import detokenize
+
+        detokenizer = detokenize.AutoUpdatingDetokenizer(args.elf + "#.*")
+
+    try:
+        serve(args.port, detokenizer)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -24,6 +24,25 @@ def crc32(data: bytes) -> int:
     return binascii.crc32(data) & 0xFFFFFFFF
 
 
+def image_hash(data: bytes) -> str:
+    """SHA256 (hex) recorded in the suffix of a patched firmware image.
+
+    Device OS reports this hash as the UUID of the user module, so equal
+    hashes mean the device already runs this image.
+
+    Raises:
+        ValueError: If the image is too small or the recorded hash does not
+            match its contents (not patched by patch_firmware).
+    """
+    size = len(data)
+    if size < CRC_BLOCK_LEN:
+        raise ValueError(f"Binary too small: {size} bytes (need at least {CRC_BLOCK_LEN})")
+    recorded = data[size - CRC_BLOCK_LEN:size - CRC_BLOCK_LEN + 32]
+    if recorded != hashlib.sha256(data[:size - CRC_BLOCK_LEN]).digest():
+        raise ValueError("SHA256 in the firmware suffix does not match the image")
+    return recorded.hex()
+
+
 def patch_firmware(bin_path: str) -> None:
     """Patch SHA256 and CRC32 into firmware binary."""
     with open(bin_path, 'r+b') as f:
@@ -58,6 +58,11 @@ def main():
         default=0,
         help="Number of retry attempts on failure (default: 0)",
     )
+    parser.add_argument(
+        "--skip-unchanged",
+        action="store_true",
+        help="Skip flashing if the device already runs this image",
+    )
     parser.add_argument(
         "--device-name",
         help="Device name for cloud operations",
@@ -101,6 +106,7 @@ def main():
                 max_retries=args.retry,
                 device_timeout=args.device_timeout,
                 flash_timeout=args.flash_timeout,
+                skip_unchanged=args.skip_unchanged,
             )
         elif args.wait_for_cloud:
             device = flasher.flash_and_verify(
@@ -109,12 +115,14 @@ def main():
                 cloud_timeout=args.cloud_timeout,
                 device_timeout=args.device_timeout,
                 flash_timeout=args.flash_timeout,
+                skip_unchanged=args.skip_unchanged,
             )
         else:
             device = flasher.flash_local(
                 firmware_path,
                 device_timeout=args.device_timeout,
                 flash_timeout=args.flash_timeout,
+                skip_unchanged=args.skip_unchanged,
             )
 
         print("=== Flash successful ===")
@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+# Copyright Offene Werkstatt Wädenswil
+# SPDX-License-Identifier: MIT
+
+"""Measure end-to-end publish latency of events from a device.
+
+Subscribes to an event prefix and reports how long events took from the
+cloud (published_at) and, if the device puts its clock into the payload,
+from the device (e.g. ParticleCloudBackend::Publish with {"t": <ms>}) to
+this host. Keep the host clock NTP-synced.
+
+Usage:
+    bazel run @particle_bazel//tools:publish_latency -- bench/ \\
+        --device my-device --count 1000 --timestamp-key t
+"""
+
+import argparse
+import logging
+import sys
+import time
+
+from tools.cloud.events import EventSubscription, summarize_latencies
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Measure publish latency of cloud events"
+    )
+    parser.add_argument("prefix", help="Event name prefix to subscribe to")
+    parser.add_argument("--device", help="Only events of this device")
+    parser.add_argument(
+        "--count",
+        type=int,
+        default=100,
+        help="Number of events to measure (default: 100)",
+    )
+    parser.add_argument(
+        "--duration",
+        type=float,
+        default=300.0,
+        help="Maximum measurement time in seconds (default: 300)",
+    )
+    parser.add_argument(
+        "--timestamp-key",
+        help="JSON payload key holding the device time in epoch ms",
+    )
+    parser.add_argument(
+        "--max-queue",
+        type=int,
+        default=10000,
+        help="Maximum queued events before the oldest are dropped",
+    )
+    parser.add_argument(
+        "-v", "--verbose",
+        action="store_true",
+        help="Enable verbose logging",
+    )
+
+    args = parser.parse_args()
+
+    logging.basicConfig(
+        level=logging.DEBUG if args.verbose else logging.INFO,
+        format="%(message)s",
+    )
+
+    events = []
+    with EventSubscription(
+        args.prefix,
+        device=args.device,
+        max_queue=args.max_queue,
+    ) as sub:
+        print(f"Waiting for {args.count} '{args.prefix}' events...")
+        deadline = time.time() + args.duration
+        while len(events) < args.count and time.time() < deadline:
+            event = sub.wait_for_event(timeout=min(1.0, deadline - time.time()))
+            if event:
+                events.append(event)
+        stats = sub.stats()
+
+    print(
+        f"Received {stats.received} events, measured {len(events)}, "
+        f"dropped {stats.dropped}, peak queue {stats.peak_queued}"
+    )
+    if not events:
+        sys.exit(1)
+
+    elapsed = events[-1].received_at - events[0].received_at
+    if elapsed > 0:
+        print(f"Rate: {(len(events) - 1) / elapsed:.1f} events/s")
+
+    cloud = summarize_latencies(e.cloud_latency for e in events)
+    if cloud:
+        print(f"Cloud to host:  {cloud}")
+    if args.timestamp_key:
+        device = summarize_latencies(
+            e.device_latency(args.timestamp_key) for e in events
+        )
+        if device:
+            print(f"Device to host: {device}")
+        else:
+            print(f"No events carry '{args.timestamp_key}'")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+# Copyright Offene Werkstatt Wädenswil
+# SPDX-License-Identifier: MIT
+
+"""Flash benchmark firmware, collect its results and check for regressions.
+
+Usage:
+    bazel run //path/to:my_benchmark_run
+    bazel run //path/to:my_benchmark_run -- --write-baseline path/baseline.json
+
+Exits with status 1 if a benchmark's mean is slower than its baseline by
+more than the tolerance, or if the run did not complete.
+"""
+
+import argparse
+import logging
+import os
+import sys
+import time
+
+import serial
+
+from tools.benchmark.results import (
+    compare,
+    load_baseline,
+    parse_done,
+    parse_line,
+    write_baseline,
+)
+from tools.cli.wrapper import ParticleCli, ParticleCliError
+from tools.usb.flash import FlashError, ParticleFlasher
+from tools.usb.serial_port import wait_for_serial_port
+
+
+def _resolve_runfile(path):
+    runfiles = os.environ.get("RUNFILES_DIR")
+    if runfiles and not os.path.isabs(path):
+        runfiles_path = os.path.join(runfiles, "_main", path)
+        if os.path.exists(runfiles_path):
+            return runfiles_path
+    return path
+
+
+def collect_results(port, baud, timeout):
+    """Read PB_BENCH lines until PB_BENCH_DONE. Returns (results, done)."""
+    results = []
+    deadline = time.time() + timeout
+    with serial.Serial(port, baud, timeout=1) as ser:
+        while time.time() < deadline:
+            raw = ser.readline()
+            if not raw:
+                continue
+            line = raw.decode("utf-8", errors="replace").rstrip()
+            print(line)
+            result = parse_line(line)
+            if result is not None:
+                results.append(result)
+                continue
+            count = parse_done(line)
+            if count is not None:
+                return results, count == len(results)
+    return results, False
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Run on-device benchmarks and compare against a baseline"
+    )
+    parser.add_argument(
+        "firmware",
+        help="Path to benchmark firmware binary (.bin)",
+    )
+    parser.add_argument(
+        "--baseline",
+        help="Baseline JSON file to compare against",
+    )
+    parser.add_argument(
+        "--write-baseline",
+        help="Write the results to this baseline file instead of comparing",
+    )
+    parser.add_argument(
+        "--tolerance-percent",
+        type=float,
+        default=10.0,
+        help="Allowed slowdown of a mean before failing (default: 10)",
+    )
+    parser.add_argument(
+        "--timeout",
+        type=float,
+        default=300.0,
+        help="Timeout for the benchmark run (default: 300s)",
+    )
+    parser.add_argument(
+        "--skip-flash",
+        action="store_true",
+        help="Collect from already flashed firmware (reset it first)",
+    )
+    parser.add_argument(
+        "--baud",
+        type=int,
+        default=115200,
+        help="Baud rate (default: 115200)",
+    )
+    parser.add_argument(
+        "-v", "--verbose",
+        action="store_true",
+        help="Enable verbose logging",
+    )
+
+    args = parser.parse_args()
+
+    logging.basicConfig(
+        level=logging.DEBUG if args.verbose else logging.INFO,
+        format="%(levelname)s: %(message)s",
+    )
+
+    try:
+        if not args.skip_flash:
+            firmware_path = _resolve_runfile(args.firmware)
+            print(f"=== Flashing benchmark firmware: {firmware_path} ===")
+            ParticleFlasher(cli=ParticleCli()).flash_local(firmware_path)
+    except (FlashError, ParticleCliError) as e:
+        print(f"Error: {e}", file=sys.stderr)
+        sys.exit(1)
+
+    port = wait_for_serial_port(timeout=30.0)
+    if not port:
+        print("Error: No Particle device found", file=sys.stderr)
+        sys.exit(1)
+
+    print(f"=== Collecting results from {port} ===")
+    try:
+        results, complete = collect_results(port, args.baud, args.timeout)
+    except serial.SerialException as e:
+        print(f"Error: {e}", file=sys.stderr)
+        sys.exit(1)
+    except KeyboardInterrupt:
+        print("\nAborted", file=sys.stderr)
+        sys.exit(130)
+
+    if not complete:
+        print("Error: Benchmark run did not complete", file=sys.stderr)
+        sys.exit(1)
+
+    if args.write_baseline:
+        # Relative to the workspace under `bazel run`, not the runfiles
+        path = os.path.join(
+            os.environ.get("BUILD_WORKSPACE_DIRECTORY", ""),
+            args.write_baseline,
+        )
+        write_baseline(path, results)
+        print(f"=== Wrote {len(results)} results to {path} ===")
+        return
+
+    if not args.baseline:
+        return
+
+    baseline = load_baseline(_resolve_runfile(args.baseline))
+    comparisons = compare(results, baseline, args.tolerance_percent)
+    regressions = [c for c in comparisons if c.regressed]
+
+    print("")
+    print(f"{'benchmark':40} {'baseline':>12} {'current':>12} {'change':>8}")
+    for c in comparisons:
+        change = c.change_percent
+        change_text = "new" if change is None else f"{change:+.1f}%"
+        baseline_text = "-" if c.baseline_cycles is None else c.baseline_cycles
+        marker = "  REGRESSION" if c.regressed else ""
+        print(
+            f"{c.name:40} {baseline_text:>12} {c.current_cycles:>12} "
+            f"{change_text:>8}{marker}"
+        )
+
+    if regressions:
+        print(
+            f"\n=== {len(regressions)} benchmark(s) slower than "
+            f"{args.tolerance_percent:g}% over baseline ===",
+            file=sys.stderr,
+        )
+        sys.exit(1)
+    print("\n=== No regressions ===")
+
+
+if __name__ == "__main__":
+    main()
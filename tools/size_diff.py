@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+# Copyright Offene Werkstatt Wädenswil
+# SPDX-License-Identifier: MIT
+"""Compare a firmware size report against a stored baseline.
+
+Both files are size_report.py output. Flash is text + data and RAM is
+data + bss. Fails (exit status 1) when the total flash or RAM grows by more
+than the allowed bytes, listing every module that changed.
+
+Usage:
+    bazel test //path/to:firmware_size_diff
+    bazel run //path/to:firmware_size_diff -- --write-baseline
+"""
+
+import argparse
+import json
+import os
+import shutil
+import sys
+from pathlib import Path
+
+
+def flash(sizes: dict) -> int:
+    return sizes["text"] + sizes["data"]
+
+
+def ram(sizes: dict) -> int:
+    return sizes["data"] + sizes["bss"]
+
+
+def diff(report: dict, baseline: dict) -> list[tuple[str, int, int]]:
+    """(module, flash delta, RAM delta) of every module that changed."""
+    empty = {"text": 0, "data": 0, "bss": 0}
+    current = report["modules"]
+    previous = baseline["modules"]
+    changes = []
+    for module in sorted(set(current) | set(previous)):
+        now = current.get(module, empty)
+        before = previous.get(module, empty)
+        flash_delta = flash(now) - flash(before)
+        ram_delta = ram(now) - ram(before)
+        if flash_delta or ram_delta:
+            changes.append((module, flash_delta, ram_delta))
+    return changes
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Compare a firmware size report against a baseline"
+    )
+    parser.add_argument("--report", required=True,
+                        help="Size report JSON of the current build")
+    parser.add_argument("--baseline", required=True,
+                        help="Baseline size report JSON")
+    parser.add_argument("--max-flash-growth", type=int, default=0,
+                        help="Allowed flash growth in bytes (default: 0)")
+    parser.add_argument("--max-ram-growth", type=int, default=0,
+                        help="Allowed RAM growth in bytes (default: 0)")
+    parser.add_argument("--write-baseline", action="store_true",
+                        help="Replace the baseline with the current report")
+    args = parser.parse_args()
+
+    report = json.loads(Path(args.report).read_text())
+
+    if args.write_baseline:
+        # Under `bazel run`, write to the workspace, not the runfiles
+        workspace = os.environ.get("BUILD_WORKSPACE_DIRECTORY", "")
+        target = Path(workspace) / args.baseline
+        shutil.copyfile(args.report, target)
+        print(f"=== Wrote size baseline {target} ===")
+        return
+
+    baseline = json.loads(Path(args.baseline).read_text())
+    if report.get("profile") != baseline.get("profile"):
+        print(f"Note: optimization profile changed from "
+              f"{baseline.get('profile')} to {report.get('profile')}")
+    changes = diff(report, baseline)
+    total_flash = sum(change[1] for change in changes)
+    total_ram = sum(change[2] for change in changes)
+
+    if changes:
+        width = max(len(change[0]) for change in changes + [("module",)])
+        print(f"{'module':{width}} {'flash':>9} {'ram':>9}")
+        for module, flash_delta, ram_delta in changes:
+            print(f"{module:{width}} {flash_delta:>+9,} {ram_delta:>+9,}")
+        print(f"{'total':{width}} {total_flash:>+9,} {total_ram:>+9,}")
+    else:
+        print("=== Size unchanged ===")
+
+    failed = False
+    if total_flash > args.max_flash_growth:
+        print(f"Error: flash grew by {total_flash:,} bytes "
+              f"(allowed: {args.max_flash_growth:,})", file=sys.stderr)
+        failed = True
+    if total_ram > args.max_ram_growth:
+        print(f"Error: RAM grew by {total_ram:,} bytes "
+              f"(allowed: {args.max_ram_growth:,})", file=sys.stderr)
+        failed = True
+    if failed:
+        print("Update the baseline with --write-baseline if intended",
+              file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+# Copyright Offene Werkstatt Wädenswil
+# SPDX-License-Identifier: MIT
+"""Attribute firmware flash and RAM to the libraries that use it.
+
+Reads the GNU ld map file of the final link and sums the input sections of
+each archive into text (code and constants in flash), data (initialized
+RAM, also stored in flash) and bss (zeroed RAM). Archives are grouped by
+Bazel package, so pb_log/liblog_bridge.a counts towards "pb_log"; code from
+other repositories is grouped per repository (e.g. "@pigweed") and
+toolchain libraries under "toolchain". Functions placed in SRAM with
+PB_RAMFUNC (pb_ramfunc) are part of data and also listed per library
+under "ramfunc".
+
+Run by the two-pass link in rules/particle_firmware.bzl; see size_diff.py
+for comparing a report against a baseline.
+"""
+
+import argparse
+import json
+import re
+import sys
+from pathlib import Path
+
+# Input section: name, address, size, origin. Long names put the rest on
+# the following line.
+_INPUT_SECTION = re.compile(
+    r"^ (?P<name>\S+)\s+0x(?P<address>[0-9a-fA-F]+)\s+"
+    r"0x(?P<size>[0-9a-fA-F]+)\s+(?P<origin>\S.*)$"
+)
+_OUTPUT_SECTION = re.compile(r"^(?P<name>[.\w/][^\s]*)")
+_ARCHIVE = re.compile(r"^(?P<archive>.+?\.a)\((?P<member>[^)]+)\)$")
+
+_MAP_START = "Linker script and memory map"
+
+# Input section prefix of PB_RAMFUNC functions
+_RAMFUNC_PREFIX = ".data.ramfunc"
+
+# Output sections that take no space in the module
+_IGNORED_PREFIXES = (
+    ".debug",
+    ".comment",
+    ".ARM.attributes",
+    "/DISCARD/",
+    ".stab",
+)
+
+
+def classify(output_section: str) -> str:
+    """Category of an output section: text, data, bss or "" to ignore."""
+    if output_section.startswith(_IGNORED_PREFIXES):
+        return ""
+    if output_section.startswith(".bss"):
+        return "bss"
+    if output_section.startswith(".data"):
+        return "data"
+    return "text"
+
+
+def module_of(origin: str) -> tuple[str, str]:
+    """(module, library) an input section's origin belongs to.
+
+    `origin` is an archive member ("path/libfoo.a(foo.o)") or an object.
+    """
+    match = _ARCHIVE.match(origin)
+    path = match.group("archive") if match else origin
+    if "/bin/" not in path:
+        return "toolchain", Path(path).name
+    relative = path.split("/bin/", 1)[1]
+    parts = relative.split("/")
+    repository = ""
+    if parts[0] == "external" and len(parts) > 1:
+        repository = parts[1].rstrip("+")
+        parts = parts[2:]
+    # Our own repository is particle_bazel when used as a module
+    if repository in ("", "particle_bazel"):
+        module = parts[0] if len(parts) > 1 else "//"
+    else:
+        module = "@" + repository
+    name = Path(parts[-1]).name
+    if match and name.startswith("lib") and name.endswith(".a"):
+        name = name[len("lib"):-len(".a")]
+    label = "/".join(parts[:-1]) + ":" + name
+    if module.startswith("@"):
+        label = f"{module}//{label}"
+    return module, label
+
+
+def parse_map(text: str) -> dict:
+    """Sizes per module and per library from the contents of a map file."""
+    modules: dict[str, dict[str, int]] = {}
+    libraries: dict[str, dict[str, int]] = {}
+    ramfunc: dict[str, int] = {}
+    output_section = ""
+    pending = ""
+    in_map = False
+
+    def add(table, key, category, size):
+        entry = table.setdefault(key, {"text": 0, "data": 0, "bss": 0})
+        entry[category] += size
+
+    for line in text.splitlines():
+        if not in_map:
+            in_map = line.startswith(_MAP_START)
+            continue
+        if pending:
+            line = pending + " " + line.strip()
+            pending = ""
+        if not line.startswith(" "):
+            match = _OUTPUT_SECTION.match(line)
+            if match:
+                output_section = match.group("name")
+            continue
+        fields = line.split()
+        if len(fields) == 1 and line.startswith(" ."):
+            # Input section name alone; address, size and origin follow
+            pending = line.rstrip()
+            continue
+        match = _INPUT_SECTION.match(line)
+        if not match or match.group("name") == "*fill*":
+            continue
+        category = classify(output_section)
+        size = int(match.group("size"), 16)
+        if not category or size == 0:
+            continue
+        module, library = module_of(match.group("origin").strip())
+        add(modules, module, category, size)
+        add(libraries, library, category, size)
+        if match.group("name").startswith(_RAMFUNC_PREFIX):
+            ramfunc[library] = ramfunc.get(library, 0) + size
+
+    return {"modules": modules, "libraries": libraries, "ramfunc": ramfunc}
+
+
+def format_report(report: dict, section: str = "modules") -> str:
+    """Table of `report[section]`, largest flash user first."""
+    rows = sorted(
+        report[section].items(),
+        key=lambda item: item[1]["text"] + item[1]["data"],
+        reverse=True,
+    )
+    header = "module" if section == "modules" else "library"
+    width = max([len(name) for name, _ in rows] + [len(header)])
+    lines = [f"{header:{width}} {'text':>9} {'data':>9} {'bss':>9}"]
+    for name, sizes in rows:
+        lines.append(
+            f"{name:{width}} {sizes['text']:>9,} {sizes['data']:>9,} "
+            f"{sizes['bss']:>9,}"
+        )
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Per-library size report from a linker map file"
+    )
+    parser.add_argument("--map", required=True,
+                        help="Path to the linker map file")
+    parser.add_argument("--output-json", required=True,
+                        help="Path to output JSON report")
+    parser.add_argument("--speed-path", action="append", default=[],
+                        help="Path compiled for speed (recorded in the report)")
+    parser.add_argument("--lto", action="store_true",
+                        help="Link-time optimization was used (recorded)")
+    args = parser.parse_args()
+
+    if not Path(args.map).exists():
+        print(f"Error: Map file not found: {args.map}", file=sys.stderr)
+        sys.exit(1)
+
+    report = parse_map(Path(args.map).read_text(errors="replace"))
+    report["profile"] = {"speed_paths": args.speed_path, "lto": args.lto}
+    with open(args.output_json, "w") as f:
+        json.dump(report, f, indent=2, sort_keys=True)
+
+    print(f"\n{'='*60}")
+    print("SIZE BY MODULE (text = flash, data = flash + RAM, bss = RAM)")
+    if args.speed_path:
+        lto = " with LTO" if args.lto else ""
+        print(f"Profile: -O2{lto} for {', '.join(args.speed_path)}; -Os else")
+    print(f"{'='*60}")
+    print(format_report(report))
+    if report["ramfunc"]:
+        print("\nSRAM functions (PB_RAMFUNC, included in data):")
+        for library, size in sorted(report["ramfunc"].items()):
+            print(f"  {library}: {size:,}")
+    print(f"{'='*60}\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,91 @@
+# Copyright Offene Werkstatt Wädenswil
+# SPDX-License-Identifier: MIT
+
+"""Unit tests for benchmark result parsing and baseline comparison."""
+
+import tempfile
+import unittest
+from pathlib import Path
+
+from tools.benchmark.results import (
+    BenchmarkResult,
+    compare,
+    load_baseline,
+    parse_done,
+    parse_line,
+    write_baseline,
+)
+
+LINE = (
+    'PB_BENCH {"name":"Crc.Crc32","warmup":8,"iterations":100,'
+    '"min_cycles":900,"mean_cycles":1000,"max_cycles":1400,"mean_ns":5000}'
+)
+
+
+def _result(name, mean_cycles):
+    return BenchmarkResult(
+        name=name,
+        warmup=8,
+        iterations=100,
+        min_cycles=mean_cycles,
+        mean_cycles=mean_cycles,
+        max_cycles=mean_cycles,
+        mean_ns=mean_cycles * 5,
+    )
+
+
+class TestParse(unittest.TestCase):
+    """Tests for parsing firmware output."""
+
+    def test_parse_result(self):
+        """Test parsing a result line."""
+        result = parse_line(LINE)
+        self.assertEqual(result.name, "Crc.Crc32")
+        self.assertEqual(result.mean_cycles, 1000)
+        self.assertEqual(result.mean_ns, 5000)
+
+    def test_parse_result_with_leading_output(self):
+        """Test that the prefix is found after other output."""
+        result = parse_line("\x1b[0m" + LINE)
+        self.assertEqual(result.name, "Crc.Crc32")
+
+    def test_parse_other_lines(self):
+        """Test that unrelated and truncated lines are ignored."""
+        self.assertIsNone(parse_line("INF booting"))
+        self.assertIsNone(parse_line(LINE[:40]))
+
+    def test_parse_done(self):
+        """Test parsing the completion line."""
+        self.assertEqual(parse_done('PB_BENCH_DONE {"count":3}'), 3)
+        self.assertIsNone(parse_done(LINE))
+
+
+class TestBaseline(unittest.TestCase):
+    """Tests for baseline storage and comparison."""
+
+    def test_round_trip(self):
+        """Test that a written baseline loads back."""
+        with tempfile.TemporaryDirectory() as tmp:
+            path = Path(tmp) / "baseline.json"
+            write_baseline(path, [_result("A", 100), _result("B", 200)])
+            baseline = load_baseline(path)
+        self.assertEqual(baseline["B"], _result("B", 200))
+
+    def test_compare(self):
+        """Test regressions beyond the tolerance."""
+        baseline = {"A": _result("A", 100), "B": _result("B", 100)}
+        comparisons = compare(
+            [_result("A", 105), _result("B", 120), _result("C", 50)],
+            baseline,
+            tolerance_percent=10,
+        )
+        by_name = {c.name: c for c in comparisons}
+        self.assertFalse(by_name["A"].regressed)
+        self.assertTrue(by_name["B"].regressed)
+        self.assertAlmostEqual(by_name["B"].change_percent, 20.0)
+        self.assertIsNone(by_name["C"].change_percent)
+        self.assertFalse(by_name["C"].regressed)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,132 @@
+# Copyright Offene Werkstatt Wädenswil
+# SPDX-License-Identifier: MIT
+
+"""Unit tests for the Particle Cloud event subscription."""
+
+import json
+import os
+import unittest
+
+# Set up environment before imports
+os.environ.setdefault("PARTICLE_ACCESS_TOKEN", "test-token")
+
+from tools.cloud.events import (
+    CloudEvent,
+    EventSubscription,
+    SseParser,
+    summarize_latencies,
+)
+
+
+def _payload(name: str, data: str, published_at: str = None) -> str:
+    return json.dumps(
+        {"name": name, "data": data, "published_at": published_at,
+         "coreid": "e00fce68deadbeef12345678"}
+    )
+
+
+class TestSseParser(unittest.TestCase):
+    """Tests for SseParser."""
+
+    def test_event_split_across_chunks(self):
+        parser = SseParser()
+        self.assertEqual(parser.feed(b"event: test/a\ndata: {\"na"), [])
+        self.assertEqual(
+            parser.feed(b"me\": 1}\n\n"),
+            [("test/a", '{"name": 1}')],
+        )
+
+    def test_several_events_per_chunk(self):
+        parser = SseParser()
+        events = parser.feed(
+            b":ok\n\nevent: a\ndata: 1\n\nevent: b\r\ndata: 2\r\n\r\n"
+        )
+        self.assertEqual(events, [("a", "1"), ("b", "2")])
+
+    def test_multiline_data(self):
+        parser = SseParser()
+        events = parser.feed(b"data: x\ndata: y\n\n")
+        self.assertEqual(events, [("", "x\ny")])
+
+
+class TestCloudEvent(unittest.TestCase):
+    """Tests for CloudEvent latency helpers."""
+
+    def test_cloud_latency(self):
+        event = CloudEvent(
+            name="a",
+            data="",
+            published_at="2024-01-01T00:00:00.000Z",
+            received_at=1704067200.25,
+        )
+        self.assertAlmostEqual(event.cloud_latency, 0.25)
+
+    def test_device_latency(self):
+        event = CloudEvent(
+            name="a", data='{"t": 1704067200000}', received_at=1704067200.5
+        )
+        self.assertAlmostEqual(event.device_latency(), 0.5)
+        self.assertIsNone(event.device_latency("missing"))
+
+    def test_device_latency_without_json(self):
+        event = CloudEvent(name="a", data="plain", received_at=1.0)
+        self.assertIsNone(event.device_latency())
+
+
+class TestSummarizeLatencies(unittest.TestCase):
+    """Tests for summarize_latencies()."""
+
+    def test_summary(self):
+        summary = summarize_latencies([i / 100 for i in range(1, 101)] + [None])
+        self.assertEqual(summary.count, 100)
+        self.assertAlmostEqual(summary.min, 0.01)
+        self.assertAlmostEqual(summary.max, 1.0)
+        self.assertAlmostEqual(summary.median, 0.505)
+        self.assertAlmostEqual(summary.p99, 0.9901, places=3)
+
+    def test_empty(self):
+        self.assertIsNone(summarize_latencies([None]))
+
+
+class TestEventSubscriptionQueue(unittest.TestCase):
+    """Tests for the bounded, filtered event queue (no network)."""
+
+    def test_full_queue_drops_oldest(self):
+        sub = EventSubscription("test/", max_queue=2)
+        for i in range(5):
+            sub._process_event("test/x", _payload("test/x", str(i)))
+
+        self.assertEqual([e.data for e in sub.get_events()], ["3", "4"])
+        stats = sub.stats()
+        self.assertEqual(stats.received, 5)
+        self.assertEqual(stats.dropped, 3)
+        self.assertEqual(stats.peak_queued, 2)
+
+    def test_filter_runs_before_queueing(self):
+        sub = EventSubscription(
+            "test/", max_queue=1, event_filter=lambda e: e.name == "test/keep"
+        )
+        sub._process_event("test/skip", _payload("test/skip", "0"))
+        sub._process_event("test/keep", _payload("test/keep", "1"))
+        sub._process_event("test/skip", _payload("test/skip", "2"))
+
+        self.assertEqual([e.data for e in sub.get_events()], ["1"])
+        stats = sub.stats()
+        self.assertEqual(stats.filtered, 2)
+        self.assertEqual(stats.dropped, 0)
+
+    def test_get_events_limit(self):
+        sub = EventSubscription("test/")
+        for i in range(3):
+            sub._process_event("test/x", _payload("test/x", str(i)))
+        self.assertEqual(len(sub.get_events(max_events=2)), 2)
+        self.assertEqual(len(sub.get_events()), 1)
+
+    def test_received_at_is_set(self):
+        sub = EventSubscription("test/")
+        sub._process_event("test/x", _payload("test/x", "1"), received_at=42.0)
+        self.assertEqual(sub.get_events()[0].received_at, 42.0)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,99 @@
+# Copyright Offene Werkstatt Wädenswil
+# SPDX-License-Identifier: MIT
+
+"""Unit tests for leasing devices to concurrent test processes."""
+
+import json
+import os
+import tempfile
+import unittest
+from unittest.mock import patch
+
+from tools.usb.device_pool import DevicePool, DevicePoolError
+from tools.usb.serial_port import ParticlePort
+
+
+def _port(serial_number: str, device_type: str = "P2") -> ParticlePort:
+    return ParticlePort(
+        port=f"/dev/tty-{serial_number}",
+        vid=0x2B04,
+        pid=0xC020,
+        serial_number=serial_number,
+        device_type=device_type,
+    )
+
+
+@patch("tools.usb.device_pool.list_particle_ports")
+class TestDevicePool(unittest.TestCase):
+    """Tests for DevicePool and DeviceLease."""
+
+    def setUp(self):
+        self._tmp = tempfile.TemporaryDirectory()
+        self.lock_dir = self._tmp.name
+
+    def tearDown(self):
+        self._tmp.cleanup()
+
+    def test_leases_distinct_devices(self, mock_ports):
+        """Test that concurrent leases get different devices."""
+        mock_ports.return_value = [_port("aa"), _port("bb")]
+        pool = DevicePool(lock_dir=self.lock_dir)
+
+        first = pool.try_acquire()
+        second = DevicePool(lock_dir=self.lock_dir).try_acquire()
+
+        self.assertEqual(first.serial_number, "aa")
+        self.assertEqual(second.serial_number, "bb")
+        self.assertEqual(second.port, "/dev/tty-bb")
+        self.assertIsNone(pool.try_acquire())
+
+        first.release()
+        third = pool.try_acquire()
+        self.assertEqual(third.serial_number, "aa")
+        second.release()
+        third.release()
+
+    def test_filters_devices(self, mock_ports):
+        """Test device type filtering and explicit serial numbers."""
+        mock_ports.return_value = [_port("aa", "Boron"), _port("bb")]
+        self.assertEqual(
+            DevicePool(lock_dir=self.lock_dir).candidates(),
+            {"bb": "/dev/tty-bb"},
+        )
+        self.assertEqual(
+            DevicePool(serial_numbers=["aa"], lock_dir=self.lock_dir)
+            .candidates(),
+            {"aa": "/dev/tty-aa"},
+        )
+
+    @patch.dict(os.environ, {"PB_DEVICE_POOL": "bb, cc"})
+    def test_pool_from_environment(self, mock_ports):
+        """Test restricting the pool with PB_DEVICE_POOL."""
+        mock_ports.return_value = [_port("aa"), _port("bb")]
+        pool = DevicePool(lock_dir=self.lock_dir)
+        self.assertEqual(pool.candidates(), {"bb": "/dev/tty-bb"})
+
+    @patch("time.sleep")
+    def test_acquire_timeout(self, mock_sleep, mock_ports):
+        """Test that waiting for a busy pool times out."""
+        mock_ports.return_value = [_port("aa")]
+        pool = DevicePool(lock_dir=self.lock_dir)
+        with pool.acquire() as lease:
+            self.assertEqual(lease.serial_number, "aa")
+            with self.assertRaises(DevicePoolError):
+                pool.acquire(timeout=0.0)
+        self.assertIsNotNone(pool.try_acquire())
+
+    def test_write_record(self, mock_ports):
+        """Test recording the device in the test outputs."""
+        mock_ports.return_value = [_port("aa")]
+        with DevicePool(lock_dir=self.lock_dir).acquire() as lease:
+            lease.write_record(self.lock_dir)
+        with open(os.path.join(self.lock_dir, "device.json")) as f:
+            record = json.load(f)
+        self.assertEqual(record["serial_number"], "aa")
+        self.assertEqual(record["port"], "/dev/tty-aa")
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,109 @@
+# Copyright Offene Werkstatt Wädenswil
+# SPDX-License-Identifier: MIT
+
+"""Unit tests for skipping unchanged firmware images."""
+
+import contextlib
+import hashlib
+import io
+import os
+import tempfile
+import unittest
+from unittest.mock import MagicMock, patch
+
+from tools.cli.wrapper import ParticleCliError, parse_user_module_hash
+from tools.particle_crc import CRC_BLOCK_LEN, image_hash, patch_firmware
+from tools.usb.flash import ParticleFlasher
+
+INSPECT = """\
+Platform: 32 - P2
+Modules
+  Bootloader module #0 - Version 3000, Main location, 49152 bytes max size
+  System module #1 - Version 6000, Main location, 1572864 bytes max size
+  User module #1 - Version: 6, UUID: {uuid}
+    Main location, 1572864 bytes max size
+"""
+
+
+def _write_image(path: str, body: bytes) -> str:
+    """Write `body` with a placeholder suffix, patch it, return its hash."""
+    suffix = bytes(range(1, 33)) + b"\x26\x00" + b"\x78\x56\x34\x12"
+    with open(path, "wb") as f:
+        f.write(body + suffix)
+    with contextlib.redirect_stdout(io.StringIO()):
+        patch_firmware(path)
+    return hashlib.sha256(body).hexdigest()
+
+
+class TestImageHash(unittest.TestCase):
+    """Tests for reading the suffix hash."""
+
+    def test_patched_image(self):
+        """Test the hash recorded by patch_firmware."""
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "firmware.bin")
+            expected = _write_image(path, b"\xaa" * 64)
+            with open(path, "rb") as f:
+                self.assertEqual(image_hash(f.read()), expected)
+
+    def test_unpatched_image(self):
+        """Test that a placeholder suffix is rejected."""
+        with self.assertRaises(ValueError):
+            image_hash(b"\xaa" * 64 + bytes(range(1, CRC_BLOCK_LEN + 1)))
+
+    def test_parse_inspect(self):
+        """Test extracting the user module hash from serial inspect."""
+        uuid = "AB" * 32
+        self.assertEqual(
+            parse_user_module_hash(INSPECT.format(uuid=uuid)), uuid.lower()
+        )
+        self.assertIsNone(parse_user_module_hash("Platform: 32 - P2\n"))
+
+
+class TestSkipUnchanged(unittest.TestCase):
+    """Tests for ParticleFlasher with skip_unchanged."""
+
+    def setUp(self):
+        self._tmp = tempfile.TemporaryDirectory()
+        self.path = os.path.join(self._tmp.name, "firmware.bin")
+        self.hash = _write_image(self.path, b"\x55" * 128)
+        self.cli = MagicMock()
+
+    def tearDown(self):
+        self._tmp.cleanup()
+
+    @patch("tools.usb.flash.wait_for_serial_port")
+    def test_unchanged_skips_flash(self, mock_wait):
+        """Test that a matching device hash skips the flash."""
+        mock_wait.return_value = "/dev/ttyACM0"
+        self.cli.user_module_hash.return_value = self.hash
+
+        ParticleFlasher(cli=self.cli).flash_local(
+            self.path, skip_unchanged=True
+        )
+
+        self.cli.flash_local.assert_not_called()
+
+    @patch("tools.usb.flash.wait_for_serial_port")
+    def test_changed_flashes(self, mock_wait):
+        """Test that a different device hash flashes the image."""
+        mock_wait.return_value = "/dev/ttyACM0"
+        self.cli.user_module_hash.return_value = "00" * 32
+
+        ParticleFlasher(cli=self.cli).flash_local(
+            self.path, skip_unchanged=True
+        )
+
+        self.cli.flash_local.assert_called_once()
+
+    def test_unknown_device_hash_is_out_of_date(self):
+        """Test that failing to read the device hash means flashing."""
+        self.cli.user_module_hash.side_effect = ParticleCliError("timeout")
+        self.assertFalse(ParticleFlasher(cli=self.cli).is_up_to_date(self.path))
+        self.cli.user_module_hash.side_effect = None
+        self.cli.user_module_hash.return_value = None
+        self.assertFalse(ParticleFlasher(cli=self.cli).is_up_to_date(self.path))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,70 @@
+# Copyright Offene Werkstatt Wädenswil
+# SPDX-License-Identifier: MIT
+
+"""Unit tests for the network log stream parser."""
+
+import struct
+import unittest
+
+from tools.log_collector import FRAME_MAGIC, format_entry, parse_frames
+
+
+def entry(metadata: int, message: bytes) -> bytes:
+    return bytes([len(message)]) + struct.pack("<I", metadata) + message
+
+
+def frame(sequence: int, dropped: int, *entries: bytes) -> bytes:
+    payload = b"".join(entries)
+    header = struct.pack("<HHII", FRAME_MAGIC, len(payload), sequence, dropped)
+    return header + payload
+
+
+# Level INFO (2), line 42, module token 0xabcd
+METADATA = 2 | (42 << 3) | (0xABCD << 16)
+
+
+class TestParseFrames(unittest.TestCase):
+
+    def test_parses_entries(self):
+        data = frame(7, 0, entry(METADATA, b"\x01\x02\x03\x04"),
+                     entry(METADATA, b"\x05"))
+        frames, rest, skipped = parse_frames(data)
+        self.assertEqual(len(frames), 1)
+        self.assertEqual(frames[0].sequence, 7)
+        self.assertEqual(rest, b"")
+        self.assertEqual(skipped, 0)
+        entries = frames[0].entries
+        self.assertEqual([e.message for e in entries],
+                         [b"\x01\x02\x03\x04", b"\x05"])
+        self.assertEqual(entries[0].level, 2)
+        self.assertEqual(entries[0].line, 42)
+        self.assertEqual(entries[0].module, 0xABCD)
+
+    def test_keeps_incomplete_frame(self):
+        data = frame(0, 0, entry(METADATA, b"\x01")) + frame(
+            1, 0, entry(METADATA, b"\x02"))
+        frames, rest, _ = parse_frames(data[:-3])
+        self.assertEqual([f.sequence for f in frames], [0])
+        frames, rest, _ = parse_frames(rest + data[-3:])
+        self.assertEqual([f.sequence for f in frames], [1])
+        self.assertEqual(rest, b"")
+
+    def test_resyncs_on_magic(self):
+        data = b"\x00\x01\x02" + frame(3, 5)
+        frames, rest, skipped = parse_frames(data)
+        self.assertEqual(skipped, 3)
+        self.assertEqual(len(frames), 1)
+        self.assertEqual(frames[0].dropped, 5)
+        self.assertEqual(frames[0].entries, [])
+
+
+class TestFormatEntry(unittest.TestCase):
+
+    def test_without_detokenizer(self):
+        frames, _, _ = parse_frames(frame(0, 0, entry(METADATA, b"\xaa\xbb")))
+        self.assertEqual(format_entry(frames[0].entries[0]),
+                         "INF [abcd] $aabb (line 42)")
+
+
+if __name__ == "__main__":
+    unittest.main()
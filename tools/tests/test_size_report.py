@@ -0,0 +1,104 @@
+# Copyright Offene Werkstatt Wädenswil
+# SPDX-License-Identifier: MIT
+
+"""Unit tests for the per-module size report and size diff."""
+
+import unittest
+
+from tools.size_diff import diff
+from tools.size_report import module_of, parse_map
+
+BIN = "bazel-out/arm-fastbuild/bin"
+
+MAP = f"""\
+Discarded input sections
+
+ .text.unused   0x00000000       0x40 {BIN}/pb_log/liblog_bridge.a(log_bridge.o)
+
+Linker script and memory map
+
+LOAD {BIN}/pb_log/liblog_bridge.a
+.text           0x08600000     0x1000
+ *(.text*)
+ .text._ZN2pb3log10InitializeEv
+                0x08600000       0x2c {BIN}/pb_log/liblog_bridge.a(log_bridge.o)
+                0x08600000                pb::log::Initialize()
+ .text          0x0860002c       0x10 {BIN}/external/pigweed+/pw_log/liblog.a(log.o)
+ *fill*         0x0860003c        0x4
+ .text          0x08600040       0x20 /opt/arm/lib/libc_nano.a(lib_a-memcpy.o)
+.data           0x10000000       0x20
+ .data.x        0x10000000        0x4 {BIN}/pb_log/liblog_bridge.a(log_bridge.o)
+ .data.ramfunc.161
+                0x10000004       0x1c {BIN}/pb_crypto/libpb_crypto_ascon_armv8m.a(ascon_permutation_armv8m.o)
+.bss            0x10000020      0x100
+ COMMON         0x10000020      0x100 {BIN}/pb_log/liblog_bridge.a(log_bridge.o)
+.debug_info     0x00000000     0x5000
+ .debug_info    0x00000000     0x5000 {BIN}/pb_log/liblog_bridge.a(log_bridge.o)
+"""
+
+
+class TestSizeReport(unittest.TestCase):
+    """Tests for map file attribution."""
+
+    def test_module_of(self):
+        """Test grouping archives by package and repository."""
+        self.assertEqual(
+            module_of(f"{BIN}/pb_log/liblog_bridge.a(log_bridge.o)"),
+            ("pb_log", "pb_log:log_bridge"),
+        )
+        self.assertEqual(
+            module_of(
+                f"{BIN}/external/particle_bazel+/pb_watchdog/"
+                "libwatchdog.a(watchdog.o)"
+            ),
+            ("pb_watchdog", "pb_watchdog:watchdog"),
+        )
+        self.assertEqual(
+            module_of(f"{BIN}/external/pigweed+/pw_log/liblog.a(log.o)"),
+            ("@pigweed", "@pigweed//pw_log:log"),
+        )
+        self.assertEqual(
+            module_of("/opt/arm/lib/libc_nano.a(lib_a-memcpy.o)"),
+            ("toolchain", "libc_nano.a"),
+        )
+
+    def test_parse_map(self):
+        """Test summing sections, skipping discarded and debug ones."""
+        report = parse_map(MAP)
+        self.assertEqual(
+            report["modules"]["pb_log"], {"text": 0x2c, "data": 4, "bss": 256}
+        )
+        self.assertEqual(report["modules"]["@pigweed"]["text"], 0x10)
+        self.assertEqual(report["modules"]["toolchain"]["text"], 0x20)
+        self.assertEqual(
+            report["libraries"]["pb_log:log_bridge"]["bss"], 256
+        )
+
+    def test_ramfunc(self):
+        """Test listing PB_RAMFUNC sections, which also count as data."""
+        report = parse_map(MAP)
+        self.assertEqual(report["modules"]["pb_crypto"]["data"], 0x1c)
+        self.assertEqual(report["ramfunc"], {"pb_crypto:pb_crypto_ascon_armv8m": 0x1c})
+
+
+class TestSizeDiff(unittest.TestCase):
+    """Tests for comparing reports."""
+
+    def test_diff(self):
+        """Test flash and RAM deltas, including added and removed modules."""
+        baseline = {"modules": {
+            "pb_log": {"text": 100, "data": 4, "bss": 10},
+            "pb_old": {"text": 50, "data": 0, "bss": 8},
+        }}
+        report = {"modules": {
+            "pb_log": {"text": 120, "data": 4, "bss": 10},
+            "pb_new": {"text": 10, "data": 2, "bss": 0},
+        }}
+        self.assertEqual(
+            diff(report, baseline),
+            [("pb_log", 20, 0), ("pb_new", 12, 2), ("pb_old", -50, -8)],
+        )
+
+
+if __name__ == "__main__":
+    unittest.main()
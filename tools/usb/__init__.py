@@ -5,11 +5,15 @@
 
 from .serial_port import list_particle_ports, wait_for_serial_port
 from .device import ParticleDevice
+from .device_pool import DeviceLease, DevicePool, DevicePoolError
 from .flash import ParticleFlasher
 
 __all__ = [
     "list_particle_ports",
     "wait_for_serial_port",
+    "DeviceLease",
+    "DevicePool",
+    "DevicePoolError",
     "ParticleDevice",
     "ParticleFlasher",
 ]
@@ -0,0 +1,197 @@
+# Copyright Offene Werkstatt Wädenswil
+# SPDX-License-Identifier: MIT
+
+"""Share the Particle devices attached to a host between test processes.
+
+Each integration test runs in its own process (one Bazel test target), so
+devices are leased through lock files rather than in memory: a lease holds
+an exclusive flock on <lock_dir>/<serial_number>.lock, which the kernel
+releases when the process exits, even after a crash or a Bazel timeout.
+
+With N devices attached, run up to N device tests at once:
+
+    bazel test --local_test_jobs=4 //path/to:all_integration_tests
+
+Environment:
+    PB_DEVICE_POOL: Comma-separated serial numbers to use (default: every
+        attached device of a supported type).
+    PB_DEVICE_POOL_DIR: Directory for the lock files (default:
+        <tmp>/pb_device_pool). Must be shared by all test processes, which
+        holds for tests tagged "local".
+"""
+
+import fcntl
+import json
+import logging
+import os
+import tempfile
+import time
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Iterable, Optional
+
+from .serial_port import list_particle_ports
+
+_LOG = logging.getLogger(__name__)
+
+# Device types the integration firmware is built for
+DEFAULT_DEVICE_TYPES = ("P2", "Photon 2", "M SoM")
+
+
+class DevicePoolError(Exception):
+    """Raised when no device can be leased."""
+
+    pass
+
+
+@dataclass
+class DeviceLease:
+    """An attached device reserved for one test process.
+
+    Attributes:
+        serial_number: USB serial number (the Particle device ID).
+        port: Serial port at the time the lease was taken. Re-resolve it
+            by serial number after a flash or reset.
+        wait_s: Time spent waiting for a free device.
+    """
+
+    serial_number: str
+    port: str
+    wait_s: float
+    _lock_file: Optional[object] = field(default=None, repr=False)
+
+    def release(self) -> None:
+        """Release the device. Safe to call more than once."""
+        if self._lock_file is not None:
+            fcntl.flock(self._lock_file, fcntl.LOCK_UN)
+            self._lock_file.close()
+            self._lock_file = None
+            _LOG.info("Released device %s", self.serial_number)
+
+    def write_record(self, directory: Optional[str] = None) -> None:
+        """Record which device ran the test.
+
+        Writes device.json to `directory`, by default the Bazel undeclared
+        outputs directory, so per-target results can be traced back to a
+        device in the rack. No-op outside of `bazel test`.
+        """
+        directory = directory or os.environ.get("TEST_UNDECLARED_OUTPUTS_DIR")
+        if not directory:
+            return
+        record = {
+            "serial_number": self.serial_number,
+            "port": self.port,
+            "wait_s": round(self.wait_s, 1),
+        }
+        with open(os.path.join(directory, "device.json"), "w") as f:
+            json.dump(record, f, indent=2)
+
+    def __enter__(self) -> "DeviceLease":
+        return self
+
+    def __exit__(self, exc_type, exc_val, exc_tb) -> None:
+        self.release()
+
+
+class DevicePool:
+    """Leases attached Particle devices to concurrent test processes.
+
+    Usage:
+        pool = DevicePool()
+        with pool.acquire(timeout=600.0) as lease:
+            flasher = ParticleFlasher(serial_number=lease.serial_number)
+            ...
+    """
+
+    def __init__(
+        self,
+        serial_numbers: Optional[Iterable[str]] = None,
+        device_types: Iterable[str] = DEFAULT_DEVICE_TYPES,
+        lock_dir: Optional[str] = None,
+    ):
+        """Initialize the pool.
+
+        Args:
+            serial_numbers: Devices to use. Defaults to PB_DEVICE_POOL, or
+                every attached device of `device_types`.
+            device_types: Device types to consider when discovering.
+            lock_dir: Lock file directory. Defaults to PB_DEVICE_POOL_DIR.
+        """
+        if serial_numbers is None:
+            env = os.environ.get("PB_DEVICE_POOL", "")
+            serial_numbers = [s.strip() for s in env.split(",") if s.strip()]
+        self._serial_numbers = list(serial_numbers)
+        self._device_types = tuple(device_types)
+        self._lock_dir = Path(
+            lock_dir
+            or os.environ.get("PB_DEVICE_POOL_DIR")
+            or os.path.join(tempfile.gettempdir(), "pb_device_pool")
+        )
+
+    def candidates(self) -> dict[str, str]:
+        """Attached pool devices, serial number to port."""
+        found = {}
+        for port in list_particle_ports():
+            if not port.serial_number:
+                continue
+            if self._serial_numbers:
+                if port.serial_number not in self._serial_numbers:
+                    continue
+            elif port.device_type not in self._device_types:
+                continue
+            found[port.serial_number] = port.port
+        return found
+
+    def try_acquire(self) -> Optional[DeviceLease]:
+        """Lease a free attached device without waiting.
+
+        Returns:
+            The lease, or None if every pool device is in use or none is
+            attached.
+        """
+        self._lock_dir.mkdir(parents=True, exist_ok=True)
+        for serial_number, port in sorted(self.candidates().items()):
+            lock_file = open(self._lock_dir / f"{serial_number}.lock", "w")
+            try:
+                fcntl.flock(lock_file, fcntl.LOCK_EX | fcntl.LOCK_NB)
+            except BlockingIOError:
+                lock_file.close()
+                continue
+            return DeviceLease(serial_number, port, 0.0, lock_file)
+        return None
+
+    def acquire(
+        self,
+        timeout: float = 600.0,
+        poll_interval: float = 1.0,
+    ) -> DeviceLease:
+        """Lease a device, waiting until one is free.
+
+        Args:
+            timeout: Maximum time to wait in seconds.
+            poll_interval: Time between attempts in seconds.
+
+        Returns:
+            The lease; release it (or use it as a context manager) when done.
+
+        Raises:
+            DevicePoolError: If no device became free within `timeout`.
+        """
+        start = time.time()
+        while True:
+            lease = self.try_acquire()
+            if lease:
+                lease.wait_s = time.time() - start
+                _LOG.info(
+                    "Leased device %s at %s (waited %.0fs)",
+                    lease.serial_number,
+                    lease.port,
+                    lease.wait_s,
+                )
+                return lease
+            if time.time() - start >= timeout:
+                raise DevicePoolError(
+                    f"No free device within {timeout:.0f}s "
+                    f"(pool: {sorted(self.candidates()) or 'no devices'})"
+                )
+            time.sleep(poll_interval)
@@ -4,7 +4,8 @@
 """Particle firmware flashing utilities.
 
 Provides a ParticleFlasher class for reliable firmware flashing
-with device detection and retry logic.
+with device detection and retry logic. With skip_unchanged, an image the
+device already runs is not flashed again.
 """
 
 import logging
@@ -13,6 +14,7 @@ from pathlib import Path
 from typing import Optional
 
 from ..cli.wrapper import ParticleCli, ParticleCliError
+from ..particle_crc import image_hash
 from .device import ParticleDevice
 from .serial_port import wait_for_serial_port
 
@@ -39,21 +41,60 @@ class ParticleFlasher:
 
         # Flash with cloud connection wait
         flasher.flash_and_verify("firmware.bin", wait_for_cloud=True)
+
+        # Dev loop / test rack: skip the flash if the image is unchanged
+        flasher.flash_local("firmware.bin", skip_unchanged=True)
     """
 
     def __init__(
         self,
         cli: Optional[ParticleCli] = None,
         device_name: Optional[str] = None,
+        serial_number: Optional[str] = None,
     ):
         """Initialize the flasher.
 
         Args:
             cli: ParticleCli instance (creates one if not provided).
             device_name: Optional device name for cloud operations.
+            serial_number: Optional USB serial number (device ID) of the
+                device to flash, e.g. from a DevicePool lease. Defaults to
+                the first attached device.
         """
         self._cli = cli or ParticleCli()
         self._device_name = device_name
+        self._serial_number = serial_number
+
+    def is_up_to_date(
+        self,
+        firmware_path: str,
+        port: Optional[str] = None,
+    ) -> bool:
+        """Check whether the connected device already runs this image.
+
+        Compares the SHA256 in the image suffix (patched by particle_crc)
+        with the hash the device reports for its user module. Any failure
+        to read either hash counts as out of date.
+
+        Args:
+            firmware_path: Path to firmware binary (.bin).
+            port: Serial port of the device, if known.
+
+        Returns:
+            True if the device runs exactly this image.
+        """
+        try:
+            local = image_hash(Path(firmware_path).read_bytes())
+        except (OSError, ValueError) as e:
+            _LOG.debug("No image hash for %s: %s", firmware_path, e)
+            return False
+        try:
+            remote = self._cli.user_module_hash(port=port)
+        except ParticleCliError as e:
+            _LOG.debug("Could not read firmware hash from device: %s", e)
+            return False
+        _LOG.debug("Image %s, device %s", local, remote)
+        return remote == local
 
     def flash_local(
         self,
@@ -61,6 +102,7 @@ class ParticleFlasher:
         wait_for_device: bool = True,
         device_timeout: float = 20.0,
         flash_timeout: float = 120.0,
+        skip_unchanged: bool = False,
     ) -> ParticleDevice:
         """Flash firmware to a locally connected device via USB.
 
@@ -69,6 +111,9 @@ class ParticleFlasher:
             wait_for_device: If True, wait for device before flashing.
             device_timeout: Time to wait for device in seconds.
             flash_timeout: Flash operation timeout in seconds.
+            skip_unchanged: If True, skip flashing when the device already
+                runs this image (see is_up_to_date). The device is not
+                reset in that case.
 
         Returns:
             ParticleDevice representing the flashed device.
@@ -83,7 +128,9 @@ class ParticleFlasher:
         # Wait for device to be present
         if wait_for_device:
             _LOG.info("Waiting for device...")
-            port = wait_for_serial_port(timeout=device_timeout)
+            port = wait_for_serial_port(
+                timeout=device_timeout, serial_number=self._serial_number
+            )
             if not port:
                 raise FlashError(
                     f"No Particle device found within {device_timeout}s"
@@ -92,14 +139,20 @@ class ParticleFlasher:
         else:
             port = None
 
-        # Flash firmware
-        _LOG.info("Flashing %s...", firmware.name)
-        try:
-            self._cli.flash_local(str(firmware), timeout=flash_timeout)
-        except ParticleCliError as e:
-            raise FlashError(f"Flash failed: {e}") from e
+        if skip_unchanged and self.is_up_to_date(str(firmware), port):
+            _LOG.info("%s already on device, skipping flash", firmware.name)
+        else:
+            _LOG.info("Flashing %s...", firmware.name)
+            try:
+                self._cli.flash_local(
+                    str(firmware),
+                    timeout=flash_timeout,
+                    device=self._serial_number,
+                )
+            except ParticleCliError as e:
+                raise FlashError(f"Flash failed: {e}") from e
 
-        _LOG.info("Flash complete")
+            _LOG.info("Flash complete")
 
         # Return device reference
         return ParticleDevice(
@@ -116,6 +169,7 @@ class ParticleFlasher:
         device_timeout: float = 20.0,
         flash_timeout: float = 120.0,
         reconnect_timeout: float = 30.0,
+        skip_unchanged: bool = False,
     ) -> ParticleDevice:
         """Flash firmware and verify device operation.
 
@@ -126,6 +180,8 @@ class ParticleFlasher:
             device_timeout: Time to wait for initial device in seconds.
             flash_timeout: Flash operation timeout in seconds.
             reconnect_timeout: Time to wait for device to reconnect after flash.
+            skip_unchanged: If True, skip flashing when the device already
+                runs this image.
 
         Returns:
             ParticleDevice representing the flashed and verified device.
@@ -139,11 +195,14 @@ class ParticleFlasher:
             wait_for_device=True,
             device_timeout=device_timeout,
             flash_timeout=flash_timeout,
+            skip_unchanged=skip_unchanged,
         )
 
         # Wait for device to reconnect after flash
         _LOG.info("Waiting for device to reconnect...")
-        port = wait_for_serial_port(timeout=reconnect_timeout)
+        port = wait_for_serial_port(
+            timeout=reconnect_timeout, serial_number=self._serial_number
+        )
         if not port:
             raise FlashError(
                 f"Device did not reconnect within {reconnect_timeout}s"